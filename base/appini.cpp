@@ -31,8 +31,71 @@
 
 #include <string.h>
 #include "rdos.h"
+#include "section.h"
 #include "appini.h"
 
+class TAppIniCacheEntry
+{
+public:
+    TAppIniCacheEntry(const char *Name);
+
+    TString FName;
+    unsigned long FMsb;
+    unsigned long FLsb;
+    long long FSize;
+    TAppIniData *FData;
+    TAppIniCacheEntry *FNext;
+};
+
+static TSection CacheSection("AppIni.Cache");
+static TAppIniCacheEntry *CacheList = 0;
+
+/*##########################################################################
+#
+#   Name       : HashName
+#
+#   Purpose....: Calculate hash of section or variable name
+#
+#   In params..: Name
+#   Out params.: *
+#   Returns....: hash
+#
+##########################################################################*/
+static unsigned int HashName(const char *Name)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*Name)
+    {
+        hash ^= (unsigned char)*Name;
+        hash *= 16777619u;
+        Name++;
+    }
+
+    return hash;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniCacheEntry::TAppIniCacheEntry
+#
+#   Purpose....: Constructor for parsed ini-file cache entry
+#
+#   In params..: filename
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TAppIniCacheEntry::TAppIniCacheEntry(const char *Name)
+  : FName(Name)
+{
+    FMsb = 0;
+    FLsb = 0;
+    FSize = 0;
+    FData = 0;
+    FNext = 0;
+}
+
 /*##########################################################################
 #
 #   Name       : TAppIniVar::TAppIniVar
@@ -48,7 +111,10 @@ TAppIniVar::TAppIniVar(const char *Name, const char *Val)
   : FName(Name),
     FVal(Val)
 {
+    FHash = 0;
+    FDirty = false;
     FNextVar = 0;
+    FHashNext = 0;
 }
 
 /*##########################################################################
@@ -195,9 +261,50 @@ char *TAppIniVar::Format(char *buf)
 TAppIniSection::TAppIniSection(const char *Name)
  : FName(Name)
 {
+    FHash = 0;
+    FDirty = false;
+    FVarList = 0;
+    FLastVar = 0;
+    FCurrVar = 0;
+    FVarHash = 0;
+    FHashSize = 0;
+    FVarCount = 0;
+    FNextSection = 0;
+    FHashNext = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniSection::TAppIniSection
+#
+#   Purpose....: Copy constructor for TAppIniSection
+#
+#   In params..: section to copy
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TAppIniSection::TAppIniSection(const TAppIniSection &src)
+ : FName(src.FName)
+{
+    TAppIniVar *var = src.FVarList;
+
+    FHash = 0;
+    FDirty = false;
     FVarList = 0;
+    FLastVar = 0;
     FCurrVar = 0;
+    FVarHash = 0;
+    FHashSize = 0;
+    FVarCount = 0;
     FNextSection = 0;
+    FHashNext = 0;
+
+    while (var)
+    {
+        AddVar(var->GetName(), var->GetData());
+        var = var->FNextVar;
+    }
 }
 
 /*##########################################################################
@@ -239,6 +346,91 @@ void TAppIniSection::ClearVars()
         delete FVarList;
         FVarList = var;
     }
+
+    if (FVarHash)
+        delete FVarHash;
+
+    FLastVar = 0;
+    FVarHash = 0;
+    FHashSize = 0;
+    FVarCount = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniSection::GrowHash
+#
+#   Purpose....: Grow variable hash table and rehash variables
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniSection::GrowHash()
+{
+    TAppIniVar *var;
+    int size;
+    int i;
+
+    if (FVarHash)
+        delete FVarHash;
+
+    if (FHashSize)
+        size = 2 * FHashSize;
+    else
+        size = 8;
+
+    FVarHash = new TAppIniVar *[size];
+    FHashSize = size;
+
+    for (i = 0; i < size; i++)
+        FVarHash[i] = 0;
+
+    var = FVarList;
+    while (var)
+    {
+        i = var->FHash & (size - 1);
+        var->FHashNext = FVarHash[i];
+        FVarHash[i] = var;
+        var = var->FNextVar;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniSection::LinkVar
+#
+#   Purpose....: Link new variable last in list and into hash table
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniSection::LinkVar(TAppIniVar *var)
+{
+    int i;
+
+    var->FHash = HashName(var->GetName());
+    var->FNextVar = 0;
+
+    if (FLastVar)
+        FLastVar->FNextVar = var;
+    else
+        FVarList = var;
+
+    FLastVar = var;
+    FVarCount++;
+
+    if (FVarCount > FHashSize)
+        GrowHash();
+    else
+    {
+        i = var->FHash & (FHashSize - 1);
+        var->FHashNext = FVarHash[i];
+        FVarHash[i] = var;
+    }
 }
 
 /*##########################################################################
@@ -330,6 +522,115 @@ char *TAppIniSection::Format(char *buf)
     return ptr;
 }
 
+/*##########################################################################
+#
+#   Name       : TAppIniSection::GetDirtySize
+#
+#   Purpose....: Get size of modified variables when printed
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TAppIniSection::GetDirtySize()
+{
+    int size;
+    TAppIniVar *var = FVarList;
+
+    if (!FDirty)
+        return 0;
+
+    size = FName.GetSize() + 6;
+
+    while (var)
+    {
+        if (var->FDirty)
+            size += var->GetSize();
+
+        var = var->FNextVar;
+    }
+
+    return size;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniSection::FormatDirty
+#
+#   Purpose....: Format section with modified variables
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+char *TAppIniSection::FormatDirty(char *buf)
+{
+    char *ptr = buf;
+    TAppIniVar *var = FVarList;
+
+    if (!FDirty)
+        return ptr;
+
+    *ptr = '[';
+    ptr++;
+
+    strcpy(ptr, FName.GetData());
+    ptr += FName.GetSize();
+
+    *ptr = ']';
+    ptr++;
+
+    *ptr = 0xd;
+    ptr++;
+
+    *ptr = 0xa;
+    ptr++;
+
+    while (var)
+    {
+        if (var->FDirty)
+            ptr = var->Format(ptr);
+
+        var = var->FNextVar;
+    }
+
+    *ptr = 0xd;
+    ptr++;
+
+    *ptr = 0xa;
+    ptr++;
+
+    *ptr = 0;
+
+    return ptr;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniSection::ClearDirty
+#
+#   Purpose....: Clear modified flags
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniSection::ClearDirty()
+{
+    TAppIniVar *var = FVarList;
+
+    while (var)
+    {
+        var->FDirty = false;
+        var = var->FNextVar;
+    }
+
+    FDirty = false;
+}
+
 /*##########################################################################
 #
 #   Name       : TAppIniSection::FindVar
@@ -343,14 +644,21 @@ char *TAppIniSection::Format(char *buf)
 ##########################################################################*/
 TAppIniVar *TAppIniSection::FindVar(const char *Name)
 {
-    TAppIniVar *var = FVarList;
+    TAppIniVar *var;
+    unsigned int hash;
+
+    if (!FHashSize)
+        return 0;
+
+    hash = HashName(Name);
+    var = FVarHash[hash & (FHashSize - 1)];
 
     while (var)
     {
-        if (var->IsMatch(Name))
+        if (var->FHash == hash && var->IsMatch(Name))
             break;
 
-        var = var->FNextVar;
+        var = var->FHashNext;
     }
 
     return var;
@@ -369,28 +677,12 @@ TAppIniVar *TAppIniSection::FindVar(const char *Name)
 ##########################################################################*/
 void TAppIniSection::AddVar(const char *Name, const char *Val)
 {
-    TAppIniVar *ins;
     TAppIniVar *var = FindVar(Name);
 
     if (var)
         var->SetData(Val);
     else
-    {
-        var = new TAppIniVar(Name, Val);
-        var->FNextVar = 0;
-
-        if (FVarList)
-        {
-            ins = FVarList;
-
-            while (ins->FNextVar)
-                ins = ins->FNextVar;
-
-            ins->FNextVar = var;
-        }
-        else
-            FVarList = var;
-    }
+        LinkVar(new TAppIniVar(Name, Val));
 }
 
 /*##########################################################################
@@ -406,27 +698,38 @@ void TAppIniSection::AddVar(const char *Name, const char *Val)
 ##########################################################################*/
 bool TAppIniSection::DeleteVar(const char *name)
 {
-    TAppIniVar *var = FVarList;
-    TAppIniVar *prev = 0;
+    TAppIniVar *var = FindVar(name);
+    TAppIniVar *prev;
+    TAppIniVar **link;
 
-    while (var)
-    {
-        if (var->IsMatch(name))
-        {
-            if (prev)
-                prev->FNextVar = var->FNextVar;
-            else
-                FVarList = var->FNextVar;
+    if (!var)
+        return false;
 
-            delete var;
-            return true;
-        }
+    link = &FVarHash[var->FHash & (FHashSize - 1)];
+    while (*link != var)
+        link = &(*link)->FHashNext;
+    *link = var->FHashNext;
 
-        prev = var;
-        var = var->FNextVar;
+    prev = 0;
+    if (FVarList == var)
+        FVarList = var->FNextVar;
+    else
+    {
+        prev = FVarList;
+        while (prev->FNextVar != var)
+            prev = prev->FNextVar;
+        prev->FNextVar = var->FNextVar;
     }
 
-    return false;
+    if (FLastVar == var)
+        FLastVar = prev;
+
+    if (FCurrVar == var)
+        FCurrVar = 0;
+
+    FVarCount--;
+    delete var;
+    return true;
 }
 
 /*##########################################################################
@@ -586,80 +889,725 @@ void TAppIniSection::Parse(char *ptr)
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::TAppIniFile
+#   Name       : TAppIniData::TAppIniData
 #
-#   Purpose....: Constructor for TAppIniFile
+#   Purpose....: Constructor for parsed ini-file contents
 #
-#   In params..: filename
+#   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TAppIniFile::TAppIniFile(const char *IniName)
-  : FName(IniName)
+TAppIniData::TAppIniData()
 {
-    int FileHandle;
-    long long FileSize = 0;
-    char *buf;
-    int size;
-
-    FModified = false;
-    FCurrSection = 0;
-    FCurrVar = 0;
+    FRefCount = 1;
     FSectionList = 0;
-
-    FileHandle = RdosOpenHandle(IniName, O_RDWR);
-
-    if (FileHandle > 0)
-        FileSize = RdosGetHandleSize(FileHandle);
-
-    if (FileSize > 0x10000000)
-        size = 0x10000000;
-    else
-        size = (int)FileSize;
-
-    if (size)
-    {
-        buf = new char[size + 2];
-        RdosReadHandle(FileHandle, buf, size);
-        buf[size] = 0;
-        buf[size + 1] = 0;
-        Parse(buf);
-        delete buf;
-    }
-
-    if (FileHandle)
-        RdosCloseHandle(FileHandle);
+    FLastSection = 0;
+    FSectionHash = 0;
+    FHashSize = 0;
+    FSectionCount = 0;
 }
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::TAppIniFile
+#   Name       : TAppIniData::TAppIniData
 #
-#   Purpose....: Copy constructor for TAppIniFile
+#   Purpose....: Copy constructor for parsed ini-file contents
 #
-#   In params..: infile to duplicate handle on
+#   In params..: contents to copy
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TAppIniFile::TAppIniFile(const TAppIniFile &ini)
-  : FName(ini.FName)
+TAppIniData::TAppIniData(const TAppIniData &src)
+{
+    TAppIniSection *sect = src.FSectionList;
+
+    FRefCount = 1;
+    FSectionList = 0;
+    FLastSection = 0;
+    FSectionHash = 0;
+    FHashSize = 0;
+    FSectionCount = 0;
+
+    while (sect)
+    {
+        LinkSection(new TAppIniSection(*sect));
+        sect = sect->FNextSection;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::~TAppIniData
+#
+#   Purpose....: Destructor for parsed ini-file contents
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TAppIniData::~TAppIniData()
+{
+    ClearSections();
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::ClearSections
+#
+#   Purpose....: Clear sections
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniData::ClearSections()
+{
+    TAppIniSection *sect;
+
+    while (FSectionList)
+    {
+        sect = FSectionList->FNextSection;
+        delete FSectionList;
+        FSectionList = sect;
+    }
+
+    if (FSectionHash)
+        delete FSectionHash;
+
+    FLastSection = 0;
+    FSectionHash = 0;
+    FHashSize = 0;
+    FSectionCount = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::GrowHash
+#
+#   Purpose....: Grow section hash table and rehash sections
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniData::GrowHash()
+{
+    TAppIniSection *sect;
+    int size;
+    int i;
+
+    if (FSectionHash)
+        delete FSectionHash;
+
+    if (FHashSize)
+        size = 2 * FHashSize;
+    else
+        size = 16;
+
+    FSectionHash = new TAppIniSection *[size];
+    FHashSize = size;
+
+    for (i = 0; i < size; i++)
+        FSectionHash[i] = 0;
+
+    sect = FSectionList;
+    while (sect)
+    {
+        i = sect->FHash & (size - 1);
+        sect->FHashNext = FSectionHash[i];
+        FSectionHash[i] = sect;
+        sect = sect->FNextSection;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::LinkSection
+#
+#   Purpose....: Link new section last in list and into hash table
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniData::LinkSection(TAppIniSection *sect)
+{
+    int i;
+
+    sect->FHash = HashName(sect->FName.GetData());
+    sect->FNextSection = 0;
+
+    if (FLastSection)
+        FLastSection->FNextSection = sect;
+    else
+        FSectionList = sect;
+
+    FLastSection = sect;
+    FSectionCount++;
+
+    if (FSectionCount > FHashSize)
+        GrowHash();
+    else
+    {
+        i = sect->FHash & (FHashSize - 1);
+        sect->FHashNext = FSectionHash[i];
+        FSectionHash[i] = sect;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::FindSection
+#
+#   Purpose....: Find section
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TAppIniSection *TAppIniData::FindSection(const char *Name)
+{
+    TAppIniSection *sect;
+    unsigned int hash;
+
+    if (!FHashSize)
+        return 0;
+
+    hash = HashName(Name);
+    sect = FSectionHash[hash & (FHashSize - 1)];
+
+    while (sect)
+    {
+        if (sect->FHash == hash && sect->IsMatch(Name))
+            break;
+
+        sect = sect->FHashNext;
+    }
+
+    return sect;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::AddSection
+#
+#   Purpose....: Add section
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TAppIniSection *TAppIniData::AddSection(const char *Name)
+{
+    TAppIniSection *sect = FindSection(Name);
+
+    if (!sect)
+    {
+        sect = new TAppIniSection(Name);
+        LinkSection(sect);
+    }
+
+    return sect;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::DeleteSection
+#
+#   Purpose....: Delete section
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TAppIniData::DeleteSection(const char *Name)
+{
+    TAppIniSection *sect = FindSection(Name);
+    TAppIniSection *prev;
+    TAppIniSection **link;
+
+    if (!sect)
+        return false;
+
+    link = &FSectionHash[sect->FHash & (FHashSize - 1)];
+    while (*link != sect)
+        link = &(*link)->FHashNext;
+    *link = sect->FHashNext;
+
+    prev = 0;
+    if (FSectionList == sect)
+        FSectionList = sect->FNextSection;
+    else
+    {
+        prev = FSectionList;
+        while (prev->FNextSection != sect)
+            prev = prev->FNextSection;
+        prev->FNextSection = sect->FNextSection;
+    }
+
+    if (FLastSection == sect)
+        FLastSection = prev;
+
+    FSectionCount--;
+    delete sect;
+    return true;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::GetSize
+#
+#   Purpose....: Get size of contents when printed
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TAppIniData::GetSize()
+{
+    int size = 0;
+    TAppIniSection *sect = FSectionList;
+
+    while (sect)
+    {
+        size += sect->GetSize();
+        sect = sect->FNextSection;
+    }
+
+    return size;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::Format
+#
+#   Purpose....: Format contents
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+char *TAppIniData::Format(char *buf)
+{
+    char *ptr = buf;
+    TAppIniSection *sect = FSectionList;
+
+    while (sect)
+    {
+        ptr = sect->Format(ptr);
+        sect = sect->FNextSection;
+    }
+
+    return ptr;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::GetDirtySize
+#
+#   Purpose....: Get size of modified variables when printed
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TAppIniData::GetDirtySize()
+{
+    int size = 0;
+    TAppIniSection *sect = FSectionList;
+
+    while (sect)
+    {
+        size += sect->GetDirtySize();
+        sect = sect->FNextSection;
+    }
+
+    return size;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::FormatDirty
+#
+#   Purpose....: Format modified variables as sections
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+char *TAppIniData::FormatDirty(char *buf)
+{
+    char *ptr = buf;
+    TAppIniSection *sect = FSectionList;
+
+    while (sect)
+    {
+        ptr = sect->FormatDirty(ptr);
+        sect = sect->FNextSection;
+    }
+
+    return ptr;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::ClearDirty
+#
+#   Purpose....: Clear modified flags
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniData::ClearDirty()
+{
+    TAppIniSection *sect = FSectionList;
+
+    while (sect)
+    {
+        sect->ClearDirty();
+        sect = sect->FNextSection;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::FindSectionStart
+#
+#   Purpose....: Find first section in string
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+char *TAppIniData::FindSectionStart(char *ptr)
+{
+    while (*ptr)
+    {
+        while (*ptr == 0xd || *ptr == 0xa)
+            ptr++;
+
+        if (*ptr == '[')
+            return ptr;
+        else
+        {
+            while (*ptr && *ptr != 0xd && *ptr != 0xa)
+                ptr++;
+        }
+    }
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::DecodeSection
+#
+#   Purpose....: Decode a single section
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniData::DecodeSection(char *ptr)
+{
+    TAppIniSection *sect;
+    char *name = ptr;
+
+    while (*ptr)
+    {
+        if (*ptr == 0 || *ptr == 0xd || *ptr == 0xa)
+            break;
+
+        if (*ptr == ']')
+            break;
+
+        ptr++;
+    }
+
+    if (*ptr == ']')
+    {
+        *ptr = 0;
+        ptr++;
+
+        sect = AddSection(name);
+        sect->Parse(ptr);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniData::Parse
+#
+#   Purpose....: Parse ini file into components
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniData::Parse(char *ptr)
+{
+    char *prev_sec = 0;
+    char *curr_sec = 0;
+
+    while (ptr)
+    {
+        curr_sec = FindSectionStart(ptr);
+
+        if (curr_sec)
+        {
+            *curr_sec = 0;
+            curr_sec++;
+
+            if (prev_sec)
+                DecodeSection(prev_sec);
+
+            prev_sec = curr_sec;
+            ptr = curr_sec;
+        }
+        else
+        {
+            if (prev_sec)
+                DecodeSection(prev_sec);
+
+            ptr = 0;
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniFile::GetCached
+#
+#   Purpose....: Get parsed contents from cache if file is unchanged
+#
+#   In params..: filename, modify time, size
+#   Out params.: *
+#   Returns....: contents or 0
+#
+##########################################################################*/
+TAppIniData *TAppIniFile::GetCached(const char *Name, unsigned long msb, unsigned long lsb, long long size)
+{
+    TAppIniCacheEntry *entry;
+    TAppIniData *data = 0;
+
+    CacheSection.Enter();
+
+    entry = CacheList;
+    while (entry)
+    {
+        if (entry->FName == Name)
+        {
+            if (entry->FMsb == msb && entry->FLsb == lsb && entry->FSize == size)
+            {
+                data = entry->FData;
+                data->FRefCount++;
+            }
+            break;
+        }
+        entry = entry->FNext;
+    }
+
+    CacheSection.Leave();
+
+    return data;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniFile::SetCached
+#
+#   Purpose....: Add parsed contents to cache
+#
+#   In params..: filename, modify time, size, contents
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniFile::SetCached(const char *Name, unsigned long msb, unsigned long lsb, long long size, TAppIniData *data)
+{
+    TAppIniCacheEntry *entry;
+    TAppIniData *old = 0;
+
+    CacheSection.Enter();
+
+    entry = CacheList;
+    while (entry)
+    {
+        if (entry->FName == Name)
+            break;
+
+        entry = entry->FNext;
+    }
+
+    if (entry)
+        old = entry->FData;
+    else
+    {
+        entry = new TAppIniCacheEntry(Name);
+        entry->FNext = CacheList;
+        CacheList = entry;
+    }
+
+    entry->FMsb = msb;
+    entry->FLsb = lsb;
+    entry->FSize = size;
+    entry->FData = data;
+    data->FRefCount++;
+
+    CacheSection.Leave();
+
+    if (old)
+        ReleaseData(old);
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniFile::RemoveCached
+#
+#   Purpose....: Remove file from cache
+#
+#   In params..: filename
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniFile::RemoveCached(const char *Name)
+{
+    TAppIniCacheEntry *entry;
+    TAppIniCacheEntry *prev = 0;
+
+    CacheSection.Enter();
+
+    entry = CacheList;
+    while (entry)
+    {
+        if (entry->FName == Name)
+        {
+            if (prev)
+                prev->FNext = entry->FNext;
+            else
+                CacheList = entry->FNext;
+            break;
+        }
+        prev = entry;
+        entry = entry->FNext;
+    }
+
+    CacheSection.Leave();
+
+    if (entry)
+    {
+        ReleaseData(entry->FData);
+        delete entry;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniFile::FlushCache
+#
+#   Purpose....: Remove all files from cache
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniFile::FlushCache()
+{
+    TAppIniCacheEntry *entry;
+
+    CacheSection.Enter();
+    entry = CacheList;
+    CacheList = 0;
+    CacheSection.Leave();
+
+    while (entry)
+    {
+        CacheList = entry->FNext;
+        ReleaseData(entry->FData);
+        delete entry;
+        entry = CacheList;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniFile::ReleaseData
+#
+#   Purpose....: Release reference to parsed contents
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniFile::ReleaseData(TAppIniData *data)
+{
+    int count;
+
+    CacheSection.Enter();
+    data->FRefCount--;
+    count = data->FRefCount;
+    CacheSection.Leave();
+
+    if (count == 0)
+        delete data;
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniFile::Load
+#
+#   Purpose....: Load contents from cache or parse file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TAppIniFile::Load()
 {
     int FileHandle;
     long long FileSize = 0;
+    unsigned long msb = 0;
+    unsigned long lsb = 0;
     char *buf;
     int size;
 
-    FModified = false;
-    FCurrSection = 0;
-    FCurrVar = 0;
-    FSectionList = 0;
-
-    FileHandle = RdosOpenHandle(ini.FName.GetData(), O_RDWR);
+    FileHandle = RdosOpenHandle(FName.GetData(), O_RDWR);
 
     if (FileHandle > 0)
+    {
         FileSize = RdosGetHandleSize(FileHandle);
+        RdosGetHandleModifyTime(FileHandle, &msb, &lsb);
+
+        FData = GetCached(FName.GetData(), msb, lsb, FileSize);
+        if (FData)
+        {
+            RdosCloseHandle(FileHandle);
+            return;
+        }
+    }
+
+    FData = new TAppIniData;
 
     if (FileSize > 0x10000000)
         size = 0x10000000;
@@ -672,208 +1620,228 @@ TAppIniFile::TAppIniFile(const TAppIniFile &ini)
         RdosReadHandle(FileHandle, buf, size);
         buf[size] = 0;
         buf[size + 1] = 0;
-        Parse(buf);
+        FData->Parse(buf);
         delete buf;
     }
 
-    if (FileHandle)
+    if (FileHandle > 0)
+    {
+        SetCached(FName.GetData(), msb, lsb, FileSize, FData);
         RdosCloseHandle(FileHandle);
+    }
 }
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::~TAppIniFile
+#   Name       : TAppIniFile::TAppIniFile
 #
-#   Purpose....: Destructor for TAppIniFile
+#   Purpose....: Constructor for TAppIniFile
 #
-#   In params..: *
+#   In params..: filename
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TAppIniFile::~TAppIniFile()
+TAppIniFile::TAppIniFile(const char *IniName)
+  : FName(IniName)
 {
-    if (FModified)
-        Update();
+    FModified = false;
+    FRewrite = false;
+    FCurrSection = 0;
+    FCurrVar = 0;
+    FData = 0;
 
-    ClearSections();
+    Load();
 }
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::FindSectionStart
+#   Name       : TAppIniFile::TAppIniFile
+#
+#   Purpose....: Copy constructor for TAppIniFile
 #
-#   Purpose....: Find first section in string
+#   In params..: infile to duplicate handle on
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TAppIniFile::TAppIniFile(const TAppIniFile &ini)
+  : FName(ini.FName)
+{
+    FModified = false;
+    FRewrite = false;
+    FCurrSection = 0;
+    FCurrVar = 0;
+    FData = 0;
+
+    Load();
+}
+
+/*##########################################################################
+#
+#   Name       : TAppIniFile::~TAppIniFile
+#
+#   Purpose....: Destructor for TAppIniFile
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-char *TAppIniFile::FindSectionStart(char *ptr)
+TAppIniFile::~TAppIniFile()
 {
-    while (*ptr)
-    {
-        while (*ptr == 0xd || *ptr == 0xa)
-            ptr++;
+    if (FModified)
+        Update();
 
-        if (*ptr == '[')
-            return ptr;
-        else
-        {
-            while (*ptr && *ptr != 0xd && *ptr != 0xa)
-                ptr++;
-        }
-    }
-    return 0;
+    Release();
 }
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::FindSection
+#   Name       : TAppIniFile::Release
 #
-#   Purpose....: Find section
+#   Purpose....: Release contents
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TAppIniSection *TAppIniFile::FindSection(const char *Name)
+void TAppIniFile::Release()
 {
-    TAppIniSection *sect = FSectionList;
+    FCurrSection = 0;
+    FCurrVar = 0;
 
-    while (sect)
+    if (FData)
     {
-        if (sect->IsMatch(Name))
-            break;
-
-        sect = sect->FNextSection;
+        ReleaseData(FData);
+        FData = 0;
     }
-
-    return sect;
 }
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::AddSection
+#   Name       : TAppIniFile::MakeWritable
 #
-#   Purpose....: Add section
+#   Purpose....: Make a private copy of contents shared with the cache
+#                or other instances before modifying them
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TAppIniSection *TAppIniFile::AddSection(const char *Name)
+void TAppIniFile::MakeWritable()
 {
-    TAppIniSection *ins;
-    TAppIniSection *sect = FindSection(Name);
+    TAppIniData *data;
+    TString var;
 
-    if (!sect)
-    {
-        sect = new TAppIniSection(Name);
-        sect->FNextSection = 0;
+    if (FData->FRefCount == 1)
+        return;
 
-        if (FSectionList)
-        {
-            ins = FSectionList;
+    if (FCurrVar)
+        var = FCurrVar->GetName();
 
-            while (ins->FNextSection)
-                ins = ins->FNextSection;
+    data = new TAppIniData(*FData);
+    ReleaseData(FData);
+    FData = data;
 
-            ins->FNextSection = sect;
-        }
-        else
-            FSectionList = sect;
-    }
+    if (FCurrSection)
+        FCurrSection = FData->FindSection(FSection.GetData());
 
-    return sect;
+    if (FCurrSection && FCurrVar)
+        FCurrVar = FCurrSection->FindVar(var.GetData());
+    else
+        FCurrVar = 0;
 }
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::DecodeSection
+#   Name       : TAppIniFile::Rewrite
 #
-#   Purpose....: Decode a single section
+#   Purpose....: Write whole ini-file from in-memory contents
 #
-#   In params..: *
+#   In params..: handle, original file size
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TAppIniFile::DecodeSection(char *ptr)
+void TAppIniFile::Rewrite(int handle, long long orgsize)
 {
-    TAppIniSection *sect;
-    char *name = ptr;
-
-    while (*ptr)
-    {
-        if (*ptr == 0 || *ptr == 0xd || *ptr == 0xa)
-            break;
+    int size;
+    char *buf;
 
-        if (*ptr == ']')
-            break;
+    size = FData->GetSize();
+    buf = new char[size + 2];
+    FData->Format(buf);
 
-        ptr++;
-    }
+    RdosSetHandlePos(handle, 0);
+    RdosWriteHandle(handle, buf, size);
 
-    if (*ptr == ']')
-    {
-        *ptr = 0;
-        ptr++;
+    delete buf;
 
-        sect = AddSection(name);
-        sect->Parse(ptr);
-    }
+    if (orgsize > size)
+        RdosSetHandleSize(handle, size);
 }
 
 /*##########################################################################
 #
-#   Name       : TAppIniFile::Parse
+#   Name       : TAppIniFile::Append
 #
-#   Purpose....: Parse ini file into components
+#   Purpose....: Append modified variables to end of ini-file. A later
+#                section with the same name overrides earlier values
+#                when the file is parsed
 #
-#   In params..: *
+#   In params..: handle, original file size
 #   Out params.: *
-#   Returns....: *
+#   Returns....: false if file should be rewritten instead
 #
 ##########################################################################*/
-void TAppIniFile::Parse(char *ptr)
+bool TAppIniFile::Append(int handle, long long orgsize)
 {
-    char *prev_sec = 0;
-    char *curr_sec = 0;
+    int size;
+    char *buf;
+    char *ptr;
+    char ch = 0xa;
 
-    while (ptr)
-    {
-        curr_sec = FindSectionStart(ptr);
+    size = FData->GetDirtySize();
+    if (orgsize + size > 2 * (long long)FData->GetSize() + 0x1000)
+        return false;
 
-        if (curr_sec)
-        {
-            *curr_sec = 0;
-            curr_sec++;
+    if (size == 0)
+        return true;
 
-            if (prev_sec)
-                DecodeSection(prev_sec);
+    RdosSetHandlePos(handle, orgsize - 1);
+    RdosReadHandle(handle, &ch, 1);
 
-            prev_sec = curr_sec;
-            ptr = curr_sec;
-        }
-        else
-        {
-            if (prev_sec)
-                DecodeSection(prev_sec);
+    buf = new char[size + 4];
+    ptr = buf;
 
-            ptr = 0;
-        }
+    if (ch != 0xa)
+    {
+        *ptr = 0xd;
+        ptr++;
+
+        *ptr = 0xa;
+        ptr++;
     }
+
+    ptr = FData->FormatDirty(ptr);
+
+    RdosSetHandlePos(handle, orgsize);
+    RdosWriteHandle(handle, buf, ptr - buf);
+
+    delete buf;
+    return true;
 }
 
 /*##########################################################################
 #
 #   Name       : TAppIniFile::Update
 #
-#   Purpose....: Write ini-file from in-memory contents
+#   Purpose....: Write ini-file from in-memory contents. Only appends
+#                modified variables unless variables or sections were
+#                deleted, or the file grew too large
 #
 #   In params..: *
 #   Out params.: *
@@ -883,11 +1851,8 @@ void TAppIniFile::Parse(char *ptr)
 void TAppIniFile::Update()
 {
     int handle;
-    TAppIniSection *sect;
-    int size;
     long long orgsize;
-    char *buf;
-    char *ptr;
+    bool done = false;
 
     handle = RdosOpenHandle(FName.GetData(), O_RDWR);
     if (handle <= 0)
@@ -896,39 +1861,20 @@ void TAppIniFile::Update()
     if (handle > 0)
     {
         orgsize = RdosGetHandleSize(handle);
-        RdosSetHandlePos(handle, 0);
 
-        size = 0;
-        sect = FSectionList;
+        if (!FRewrite && orgsize > 0)
+            done = Append(handle, orgsize);
 
-        while (sect)
-        {
-            size += sect->GetSize();
-            sect = sect->FNextSection;
-        }
-
-        buf = new char[size + 2];
-
-        ptr = buf;
-        sect = FSectionList;
-
-        while (sect)
-        {
-            ptr = sect->Format(ptr);
-            sect = sect->FNextSection;
-        }
-
-        RdosWriteHandle(handle, buf, size);
-
-        delete buf;
-
-        if (orgsize > size)
-            RdosSetHandleSize(handle, size);
+        if (!done)
+            Rewrite(handle, orgsize);
 
         RdosCloseHandle(handle);
+        RemoveCached(FName.GetData());
     }
 
+    FData->ClearDirty();
     FModified = false;
+    FRewrite = false;
 }
 
 /*##########################################################################
@@ -944,7 +1890,7 @@ void TAppIniFile::Update()
 ##########################################################################*/
 bool TAppIniFile::GotoSection(const char *name)
 {
-    FCurrSection = FindSection(name);
+    FCurrSection = FData->FindSection(name);
     FSection = name;
     FCurrVar = 0;
 
@@ -967,31 +1913,21 @@ bool TAppIniFile::GotoSection(const char *name)
 ##########################################################################*/
 bool TAppIniFile::DeleteSection(const char *name)
 {
-    TAppIniSection *sect = FSectionList;
-    TAppIniSection *prev = 0;
-
-    while (sect)
-    {
-        if (sect->IsMatch(name))
-        {
-            if (prev)
-                prev->FNextSection = sect->FNextSection;
-            else
-                FSectionList = sect->FNextSection;
-
-            if (sect == FCurrSection)
-                FCurrSection = 0;
+    if (!FData->FindSection(name))
+        return false;
 
-            delete sect;
-            FModified = true;
-            return true;
-        }
+    MakeWritable();
 
-        prev = sect;
-        sect = sect->FNextSection;
+    if (FCurrSection && FCurrSection->IsMatch(name))
+    {
+        FCurrSection = 0;
+        FCurrVar = 0;
     }
 
-    return false;
+    FData->DeleteSection(name);
+    FModified = true;
+    FRewrite = true;
+    return true;
 }
 
 /*##########################################################################
@@ -1025,7 +1961,8 @@ bool TAppIniFile::ReadVar(const char *var, char *str, int maxsize)
 #
 #   Name       : TAppIniFile::WriteVar
 #
-#   Purpose....: Write variable in current section
+#   Purpose....: Write variable in current section. Writing the value
+#                a variable already has leaves the file untouched
 #
 #   In params..: var, buffer, maxsize
 #   Out params.: *
@@ -1036,8 +1973,16 @@ bool TAppIniFile::WriteVar(const char *var, const char *str)
 {
     TAppIniVar *varobj = 0;
 
+    if (FCurrSection)
+        varobj = FCurrSection->FindVar(var);
+
+    if (varobj && !strcmp(varobj->GetData(), str))
+        return true;
+
+    MakeWritable();
+
     if (!FCurrSection)
-        FCurrSection = AddSection(FSection.GetData());
+        FCurrSection = FData->AddSection(FSection.GetData());
 
     if (FCurrSection)
     {
@@ -1046,8 +1991,13 @@ bool TAppIniFile::WriteVar(const char *var, const char *str)
         if (varobj)
             varobj->SetData(str);
         else
+        {
             FCurrSection->AddVar(var, str);
+            varobj = FCurrSection->FindVar(var);
+        }
 
+        varobj->FDirty = true;
+        FCurrSection->FDirty = true;
         FModified = true;
         return true;
     }
@@ -1068,44 +2018,27 @@ bool TAppIniFile::WriteVar(const char *var, const char *str)
 ##########################################################################*/
 bool TAppIniFile::DeleteVar(const char *var)
 {
-    bool ok;
+    bool ok = false;
+
+    if (FCurrSection && FCurrSection->FindVar(var))
+    {
+        MakeWritable();
+
+        if (FCurrVar && FCurrVar->IsMatch(var))
+            FCurrVar = 0;
 
-    if (FCurrSection)
         ok = FCurrSection->DeleteVar(var);
-    else
-        ok = false;
+    }
 
     if (ok)
+    {
         FModified = true;
+        FRewrite = true;
+    }
 
     return ok;
 }
 
-/*##########################################################################
-#
-#   Name       : TAppIniFile::ClearSections
-#
-#   Purpose....: Clear sections
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-void TAppIniFile::ClearSections()
-{
-    TAppIniSection *sect;
-
-    FCurrSection = 0;
-	
-    while (FSectionList)
-    {
-        sect = FSectionList->FNextSection;
-        delete FSectionList;
-        FSectionList = sect;
-    }
-}
-
 /*##########################################################################
 #
 #   Name       : TAppIniFile::GotoFirstVar
@@ -37,6 +37,7 @@
 class TAppIniVar
 {
     friend class TAppIniSection;
+    friend class TAppIniData;
     friend class TAppIniFile;
 public:
     TAppIniVar(const char *Name, const char *Val);
@@ -53,20 +54,28 @@ public:
 protected:
     TString FName;
     TString FVal;
+    unsigned int FHash;
+    bool FDirty;
     TAppIniVar *FNextVar;
+    TAppIniVar *FHashNext;
 };
 
 class TAppIniSection
 {
+    friend class TAppIniData;
     friend class TAppIniFile;
 public:
     TAppIniSection(const char *Name);
+    TAppIniSection(const TAppIniSection &src);
     ~TAppIniSection();
 
     bool IsMatch(const char *Name);
 
     int GetSize();
     char *Format(char *buf);
+    int GetDirtySize();
+    char *FormatDirty(char *buf);
+    void ClearDirty();
 
     TAppIniVar *FindVar(const char *Name);
     void AddVar(const char *Name, const char *Val);
@@ -74,6 +83,8 @@ public:
 
 protected:
     void ClearVars();
+    void LinkVar(TAppIniVar *var);
+    void GrowHash();
     bool CheckDelim(char ch);
     char *Trim(char *str);
     char *FindStartOfLine(char *ptr);
@@ -81,9 +92,51 @@ protected:
     void Parse(char *ptr);
 
     TString FName;
+    unsigned int FHash;
+    bool FDirty;
     TAppIniVar *FCurrVar;
     TAppIniVar *FVarList;
+    TAppIniVar *FLastVar;
+    TAppIniVar **FVarHash;
+    int FHashSize;
+    int FVarCount;
     TAppIniSection *FNextSection;
+    TAppIniSection *FHashNext;
+};
+
+class TAppIniData
+{
+    friend class TAppIniFile;
+public:
+    TAppIniData();
+    TAppIniData(const TAppIniData &src);
+    ~TAppIniData();
+
+    TAppIniSection *FindSection(const char *Name);
+    TAppIniSection *AddSection(const char *Name);
+    bool DeleteSection(const char *Name);
+
+    int GetSize();
+    char *Format(char *buf);
+    int GetDirtySize();
+    char *FormatDirty(char *buf);
+    void ClearDirty();
+
+    void Parse(char *ptr);
+
+protected:
+    void ClearSections();
+    void LinkSection(TAppIniSection *sect);
+    void GrowHash();
+    char *FindSectionStart(char *ptr);
+    void DecodeSection(char *ptr);
+
+    int FRefCount;
+    TAppIniSection *FSectionList;
+    TAppIniSection *FLastSection;
+    TAppIniSection **FSectionHash;
+    int FHashSize;
+    int FSectionCount;
 };
 
 class TAppIniFile
@@ -106,19 +159,25 @@ public:
 
     void Update();
 
+    static void FlushCache();
+
 protected:
-    void ClearSections();
-    TAppIniSection *FindSection(const char *Name);
-    TAppIniSection *AddSection(const char *Name);
+    void Load();
+    void Release();
+    void MakeWritable();
+    void Rewrite(int handle, long long orgsize);
+    bool Append(int handle, long long orgsize);
 
-    char *FindSectionStart(char *ptr);
-    void DecodeSection(char *ptr);
-    void Parse(char *ptr);
+    static TAppIniData *GetCached(const char *Name, unsigned long msb, unsigned long lsb, long long size);
+    static void SetCached(const char *Name, unsigned long msb, unsigned long lsb, long long size, TAppIniData *data);
+    static void RemoveCached(const char *Name);
+    static void ReleaseData(TAppIniData *data);
 
     TString FName;
     TString FSection;
     bool FModified;
-    TAppIniSection *FSectionList;
+    bool FRewrite;
+    TAppIniData *FData;
     TAppIniSection *FCurrSection;
     TAppIniVar *FCurrVar;
 };
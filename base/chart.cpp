@@ -29,6 +29,8 @@
 #
 ########################################################################*/
 
+#include <string.h>
+
 #include "chart.h"
 
 #define     FALSE	0
@@ -625,449 +627,1192 @@ int TChartList::Replace(int pos, TChartCoord *coord)
 
 /*##########################################################################
 #
-#   Name       : TChart::TChart
+#   Name       : TChartCurve::TChartCurve
 #
-#   Purpose....: Constructor for TChart
+#   Purpose....: Constructor for curve storage
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TChart::TChart(TGraphicDevice *dev, TXAxis *x, TYAxis *y)
+TChartCurve::TChartCurve()
 {
-    int i;
-
-    for (i = 0; i < MAX_CURVES; i++)
-    {
-        FList[i] = 0;
-    	FR[i] = 255;
-	    FG[i] = 255;
-    	FB[i] = 255;
-    }
-    
-	FDev = dev;
-	FXAxis = x;
-	FYAxis = y;
-	x->Define(dev);
-	y->Define(dev);
-	SetWindow(0, 0, dev->GetWidth(), dev->GetHeight());
-
-	FRBack = 0;
-	FGBack = 0;
-	FBBack = 0;
-
-	FXAxisFixed = FALSE;
-	FYAxisFixed = FALSE;
-
-	FNewLimits = TRUE;
+    FArr = 0;
+    FSize = 0;
+    FStart = 0;
+    FCount = 0;
+    FSorted = TRUE;
+    FDrawn = 0;
+    FLimitsValid = FALSE;
+
+    FCol = 0;
+    FColSize = 0;
+    FColValid = FALSE;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::~TChart
+#   Name       : TChartCurve::~TChartCurve
 #
-#   Purpose....: Destructor for TChart
+#   Purpose....: Destructor for curve storage
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TChart::~TChart()
+TChartCurve::~TChartCurve()
 {
-    int i;
+    if (FArr)
+        delete[] FArr;
 
-    for (i = 0; i < MAX_CURVES; i++)
-        if (FList[i])
-            delete FList[i];
+    if (FCol)
+        delete[] FCol;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::SetXAxis
+#   Name       : TChartCurve::GetCount
 #
-#   Purpose....: Set fixed x-axis
+#   Purpose....: Get number of points
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::SetXAxis(long double xmin, long double xmax)
+int TChartCurve::GetCount() const
 {
-	FNewLimits = TRUE;
-    FXAxisFixed = TRUE;
-    FXAxisMin = xmin;
-    FXAxisMax = xmax;
+    return FCount;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::SetYAxis
+#   Name       : TChartCurve::Get
 #
-#   Purpose....: Set fixed y-axis
+#   Purpose....: Get point
 #
-#   In params..: *
+#   In params..: index
 #   Out params.: *
-#   Returns....: *
+#   Returns....: coordinate or 0
 #
 ##########################################################################*/
-void TChart::SetYAxis(long double ymin, long double ymax)
+TChartCoord *TChartCurve::Get(int index) const
 {
-	FNewLimits = TRUE;
-    FYAxisFixed = TRUE;
-    FYAxisMin = ymin;
-    FYAxisMax = ymax;
+    if (index >= 0 && index < FCount)
+        return FArr + FStart + index;
+    else
+        return 0;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::SetWindow
+#   Name       : TChartCurve::IsSorted
 #
-#   Purpose....: Set chart window
+#   Purpose....: Check if x-values are non-decreasing
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::SetWindow(int xmin, int ymin, int xmax, int ymax)
+int TChartCurve::IsSorted() const
 {
-	FXMin = xmin;
-	FYMin = ymin;
-	FXMax = xmax;
-	FYMax = ymax;
-	FXAxis->SetWindow(xmin, 0, xmax, 0);
-	FYAxis->SetWindow(0, ymin, 0, ymax);
+    return FSorted;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::SetLineColor
+#   Name       : TChartCurve::Grow
 #
-#   Purpose....: Set line-color
+#   Purpose....: Make room for another point at the end.
+#                Compacts if more than half the buffer is removed points,
+#                else doubles the buffer
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::SetLineColor(int line, int r, int g, int b)
+void TChartCurve::Grow()
 {
-    if (line >= 0 && line < MAX_CURVES)
+    TChartCoord *arr;
+    int size;
+
+    if (FStart && FStart >= FSize / 2)
     {
-		FR[line] = r;
-		FG[line] = g;
-		FB[line] = b;
+        memmove(FArr, FArr + FStart, FCount * sizeof(TChartCoord));
+        FStart = 0;
+    }
+    else
+    {
+        if (FSize)
+            size = 2 * FSize;
+        else
+            size = 64;
 
-		if (!FList[line])
-			FList[line] = new TChartList;
+        arr = new TChartCoord[size];
+        if (FCount)
+            memcpy(arr, FArr + FStart, FCount * sizeof(TChartCoord));
 
-	 }
+        if (FArr)
+            delete[] FArr;
+
+        FArr = arr;
+        FSize = size;
+        FStart = 0;
+    }
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::SetBackColor
+#   Name       : TChartCurve::Add
 #
-#   Purpose....: Set back-color
+#   Purpose....: Append point
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::SetBackColor(int r, int g, int b)
+void TChartCurve::Add(long double x, long double y)
 {
-	FRBack = r;
-	FGBack = g;
-	FBBack = b;
+    TChartCoord *coord;
+
+    if (FStart + FCount == FSize)
+        Grow();
+
+    if (FCount && FArr[FStart + FCount - 1].x > x)
+        FSorted = FALSE;
+
+    coord = FArr + FStart + FCount;
+    coord->x = x;
+    coord->y = y;
+
+    if (FCount == 0)
+    {
+        FXMin = x;
+        FXMax = x;
+        FYMin = y;
+        FYMax = y;
+        FLimitsValid = TRUE;
+    }
+    else
+    {
+        if (FLimitsValid)
+        {
+            if (FXMin > x)
+                FXMin = x;
+
+            if (FXMax < x)
+                FXMax = x;
+
+            if (FYMin > y)
+                FYMin = y;
+
+            if (FYMax < y)
+                FYMax = y;
+        }
+    }
+
+    FCount++;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::Add
+#   Name       : TChartCurve::RemoveFirst
 #
-#   Purpose....: Add point
+#   Purpose....: Remove oldest point
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::Add(int line, long double x, long double y)
+void TChartCurve::RemoveFirst()
 {
-	TChartCoord coord;
+    TChartCoord *coord;
 
-	if (line >= 0 && line < MAX_CURVES)
-	{
-    	FNewLimits = TRUE;
-    	
-		coord.x = x;
-		coord.y = y;
+    if (FCount)
+    {
+        coord = FArr + FStart;
 
-		if (!FList[line])
-			FList[line] = new TChartList;
+        if (coord->x == FXMin || coord->x == FXMax || coord->y == FYMin || coord->y == FYMax)
+            FLimitsValid = FALSE;
 
-		FList[line]->AddLast(&coord);
-	}
+        FStart++;
+        FCount--;
+
+        if (FDrawn)
+            FDrawn--;
+
+        if (FCount == 0)
+        {
+            FStart = 0;
+            FSorted = TRUE;
+        }
+    }
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::Remove
+#   Name       : TChartCurve::Clear
 #
-#   Purpose....: Remove point
+#   Purpose....: Remove all points
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::Remove(int line)
+void TChartCurve::Clear()
 {
-	if (line >= 0 && line < MAX_CURVES)
-	{
-        if (FList[line])
-		{
-            FNewLimits = TRUE;
-			FList[line]->RemoveFirst();
-		}
-    }
+    FStart = 0;
+    FCount = 0;
+    FSorted = TRUE;
+    FDrawn = 0;
+    FLimitsValid = FALSE;
+    FColValid = FALSE;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::Clear
+#   Name       : TChartCurve::ScanLimits
 #
-#   Purpose....: Clear
+#   Purpose....: Recalculate limits from all points
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::Clear(int line)
+void TChartCurve::ScanLimits()
 {
-	if (line >= 0 && line < MAX_CURVES)
-	{
-        if (FList[line])
-		{
-        	FNewLimits = TRUE;
-			FList[line]->Clear();
-	    }
-	}
+    TChartCoord *coord;
+    int i;
+
+    if (FCount)
+    {
+        coord = FArr + FStart;
+        FXMin = coord->x;
+        FXMax = coord->x;
+        FYMin = coord->y;
+        FYMax = coord->y;
+
+        for (i = 1; i < FCount; i++)
+        {
+            coord++;
+
+            if (FXMin > coord->x)
+                FXMin = coord->x;
+
+            if (FXMax < coord->x)
+                FXMax = coord->x;
+
+            if (FYMin > coord->y)
+                FYMin = coord->y;
+
+            if (FYMax < coord->y)
+                FYMax = coord->y;
+        }
+        FLimitsValid = TRUE;
+    }
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::Clear
+#   Name       : TChartCurve::GetLimits
 #
-#   Purpose....: Clear
+#   Purpose....: Get curve limits. Only rescans points after a limit
+#                point was removed
 #
 #   In params..: *
+#   Out params.: xmin, xmax, ymin, ymax
+#   Returns....: TRUE if curve has points
+#
+##########################################################################*/
+int TChartCurve::GetLimits(long double *xmin, long double *xmax, long double *ymin, long double *ymax)
+{
+    if (FCount == 0)
+        return FALSE;
+
+    if (!FLimitsValid)
+        ScanLimits();
+
+    *xmin = FXMin;
+    *xmax = FXMax;
+    *ymin = FYMin;
+    *ymax = FYMax;
+    return TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TChartCurve::HasColumns
+#
+#   Purpose....: Check if column cache matches x-axis mapping
+#
+#   In params..: vmin, vmax     x-axis value range
+#                pmin, pmax     x-axis pixel range
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::Clear()
+int TChartCurve::HasColumns(long double vmin, long double vmax, int pmin, int pmax) const
 {
-    int i;
+    if (!FColValid)
+        return FALSE;
 
-	FNewLimits = TRUE;
+    if (FColValMin != vmin || FColValMax != vmax)
+        return FALSE;
 
-	for (i = 0; i < MAX_CURVES; i++)
-        if (FList[i])
-		    FList[i]->Clear();
+    if (FColPixMin != pmin || FColPixMax != pmax)
+        return FALSE;
+
+    return TRUE;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::CalcLimits
+#   Name       : TChartCurve::ResetColumns
 #
-#   Purpose....: Calculate limits
+#   Purpose....: Define an empty column cache for x-axis mapping
 #
-#   In params..: *
+#   In params..: vmin, vmax     x-axis value range
+#                pmin, pmax     x-axis pixel range
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TChart::CalcLimits()
+void TChartCurve::ResetColumns(long double vmin, long double vmax, int pmin, int pmax)
 {
-    int i;
-	TChartCoord *coord;
-    int ok;
-    
-    if (FXAxisFixed && FYAxisFixed)
-        return TRUE;
-
-    if (!FNewLimits)
-        return TRUE;
+    int size;
 
-    ok = FALSE;
+    size = pmax - pmin + 1;
+    if (size < 1)
+        size = 1;
 
-    for (i = 0; i < MAX_CURVES; i++)
+    if (size > FColSize)
     {
-        if (FList[i])
-        {        
-            if (FList[i]->GotoFirst())
-            {
-                coord = FList[i]->Get();
-                if (!ok)
-                {
-                    if (!FXAxisFixed)
-                    {
-                        FXAxisMin = coord->x;
-                        FXAxisMax = coord->x;
-                    }
-
-                    if (!FYAxisFixed)
-                    {
-                        FYAxisMin = coord->y;
-                        FYAxisMax = coord->y;
-                    }
-                    
-                    ok = TRUE;
-                }
-                else
-                {
-                    if (!FXAxisFixed)
-                    {
-                        if (FXAxisMin > coord->x)
-                            FXAxisMin = coord->x;
-        
-                        if (FXAxisMax < coord->x)
-                            FXAxisMax = coord->x;
-                    }
-
-                    if (!FYAxisFixed)
-                    {
-                        if (FYAxisMin > coord->y)
-                            FYAxisMin = coord->y;
-
-                        if (FYAxisMax < coord->y)
-                            FYAxisMax = coord->y;
-                    }
-                }
-                    
-                while (FList[i]->GotoNext())
-                {
-                    coord = FList[i]->Get();
-                    if (coord)
-                    {
-                        if (!FXAxisFixed)
-                        {
-                            if (FXAxisMin > coord->x)
-                                FXAxisMin = coord->x;
-
-                            if (FXAxisMax < coord->x)
-                                FXAxisMax = coord->x;
-                        }
-
-                        if (!FYAxisFixed)
-                        {
-                            if (FYAxisMin > coord->y)
-                                FYAxisMin = coord->y;
-    
-                            if (FYAxisMax < coord->y)
-                                FYAxisMax = coord->y;
-                        }
-                    }
-                }
-            }
-        }
+        if (FCol)
+            delete[] FCol;
+
+        FCol = new TChartColumn[size];
+        FColSize = size;
     }
 
-    if (ok)
-        FNewLimits = FALSE;
+    memset(FCol, 0, size * sizeof(TChartColumn));
 
-    return ok;
+    FColValMin = vmin;
+    FColValMax = vmax;
+    FColPixMin = pmin;
+    FColPixMax = pmax;
+    FColValid = TRUE;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::GetXAxis
+#   Name       : TChartCurve::InvalidateColumns
 #
-#   Purpose....: Get X-axis limits
+#   Purpose....: Invalidate column cache
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::GetXAxis(long double *xmin, long double *xmax)
+void TChartCurve::InvalidateColumns()
 {
-    if (CalcLimits())
-    {
-        *xmin = FXAxisMin;
-        *xmax = FXAxisMax;
-    }
-    else
-    {
-        *xmin = 0.0;
-        *xmax = 0.0;
-    }
+    FColValid = FALSE;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::GetYAxis
+#   Name       : TChartCurve::AddColumn
 #
-#   Purpose....: Get Y-axis limits
+#   Purpose....: Add y-value to pixel column
 #
-#   In params..: *
+#   In params..: pixel          x-axis pixel
+#                y              y value
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::GetYAxis(long double *ymin, long double *ymax)
+void TChartCurve::AddColumn(int pixel, long double y)
 {
-    if (CalcLimits())
+    TChartColumn *col;
+
+    if (!FColValid)
+        return;
+
+    if (pixel < FColPixMin || pixel > FColPixMax)
+        return;
+
+    col = FCol + pixel - FColPixMin;
+
+    if (col->count)
     {
-        *ymin = FYAxisMin;
-        *ymax = FYAxisMax;
+        if (col->ymin > y)
+            col->ymin = y;
+
+        if (col->ymax < y)
+            col->ymax = y;
     }
     else
     {
-        *ymin = 0.0;
-        *ymax = 0.0;
+        col->ymin = y;
+        col->ymax = y;
+        col->yfirst = y;
     }
+
+    col->ylast = y;
+    col->count++;
 }
 
 /*##########################################################################
 #
-#   Name       : TChart::Draw
+#   Name       : TChartCurve::RemoveColumn
 #
-#   Purpose....: Draw chart
+#   Purpose....: Remove oldest point from its pixel column. Must be called
+#                before RemoveFirst. The other points of the column are
+#                the ones that follow it, so only they are rescanned, and
+#                only if the removed point was the column min or max
 #
-#   In params..: *
+#   In params..: pixel          x-axis pixel of oldest point
+#                y              y value of oldest point
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TChart::Draw()
+void TChartCurve::RemoveColumn(int pixel, long double y)
 {
-	TChartCoord *coord;
-	int height;
-    int width;
-    int x;
-    int y;
-    int xprev;
-    int yprev;
+    TChartColumn *col;
+    TChartCoord *coord;
     int i;
 
-    CalcLimits();
+    if (!FColValid)
+        return;
 
-    FXAxis->SetMin(FXAxisMin);
-    FXAxis->SetMax(FXAxisMax);
-    FYAxis->SetMin(FYAxisMin);
-    FYAxis->SetMax(FYAxisMax);
+    if (!FSorted)
+    {
+        FColValid = FALSE;
+        return;
+    }
 
-	height = FXAxis->RequiredHeight();  
+    if (pixel < FColPixMin || pixel > FColPixMax)
+        return;
 
-    y = FYMax - height;
-    if (y <= FYMin)
+    col = FCol + pixel - FColPixMin;
+
+    if (col->count == 0)
+        return;
+
+    col->count--;
+
+    if (col->count == 0)
+    {
+        memset(col, 0, sizeof(TChartColumn));
+        return;
+    }
+
+    coord = FArr + FStart + 1;
+    col->yfirst = coord->y;
+
+    if (y == col->ymin || y == col->ymax)
+    {
+        col->ymin = coord->y;
+        col->ymax = coord->y;
+
+        for (i = 1; i < col->count; i++)
+        {
+            coord++;
+
+            if (col->ymin > coord->y)
+                col->ymin = coord->y;
+
+            if (col->ymax < coord->y)
+                col->ymax = coord->y;
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TChartCurve::GetColumn
+#
+#   Purpose....: Get pixel column
+#
+#   In params..: pixel          x-axis pixel
+#   Out params.: *
+#   Returns....: column or 0
+#
+##########################################################################*/
+TChartColumn *TChartCurve::GetColumn(int pixel) const
+{
+    if (FColValid && pixel >= FColPixMin && pixel <= FColPixMax)
+        return FCol + pixel - FColPixMin;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TChartCurve::GetDrawn
+#
+#   Purpose....: Get number of points already drawn
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TChartCurve::GetDrawn() const
+{
+    return FDrawn;
+}
+
+/*##########################################################################
+#
+#   Name       : TChartCurve::SetDrawn
+#
+#   Purpose....: Set number of points already drawn
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChartCurve::SetDrawn(int count)
+{
+    FDrawn = count;
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::TChart
+#
+#   Purpose....: Constructor for TChart
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TChart::TChart(TGraphicDevice *dev, TXAxis *x, TYAxis *y)
+{
+    int i;
+
+    for (i = 0; i < MAX_CURVES; i++)
+    {
+        FList[i] = 0;
+    	FR[i] = 255;
+	    FG[i] = 255;
+    	FB[i] = 255;
+    }
+    
+	FDev = dev;
+	FXAxis = x;
+	FYAxis = y;
+	x->Define(dev);
+	y->Define(dev);
+	SetWindow(0, 0, dev->GetWidth(), dev->GetHeight());
+
+	FRBack = 0;
+	FGBack = 0;
+	FBBack = 0;
+
+	FXAxisFixed = FALSE;
+	FYAxisFixed = FALSE;
+
+	FNewLimits = TRUE;
+	FDrawValid = FALSE;
+	FDirty = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::~TChart
+#
+#   Purpose....: Destructor for TChart
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TChart::~TChart()
+{
+    int i;
+
+    for (i = 0; i < MAX_CURVES; i++)
+        if (FList[i])
+            delete FList[i];
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::SetXAxis
+#
+#   Purpose....: Set fixed x-axis
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::SetXAxis(long double xmin, long double xmax)
+{
+	FNewLimits = TRUE;
+	FDrawValid = FALSE;
+    FXAxisFixed = TRUE;
+    FXAxisMin = xmin;
+    FXAxisMax = xmax;
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::SetYAxis
+#
+#   Purpose....: Set fixed y-axis
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::SetYAxis(long double ymin, long double ymax)
+{
+	FNewLimits = TRUE;
+	FDrawValid = FALSE;
+    FYAxisFixed = TRUE;
+    FYAxisMin = ymin;
+    FYAxisMax = ymax;
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::SetWindow
+#
+#   Purpose....: Set chart window
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::SetWindow(int xmin, int ymin, int xmax, int ymax)
+{
+    int i;
+
+    for (i = 0; i < MAX_CURVES; i++)
+        if (FList[i])
+            FList[i]->InvalidateColumns();
+
+	FXMin = xmin;
+	FYMin = ymin;
+	FXMax = xmax;
+	FYMax = ymax;
+	FXAxis->SetWindow(xmin, 0, xmax, 0);
+	FYAxis->SetWindow(0, ymin, 0, ymax);
+	FDrawValid = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::SetLineColor
+#
+#   Purpose....: Set line-color
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::SetLineColor(int line, int r, int g, int b)
+{
+    if (line >= 0 && line < MAX_CURVES)
+    {
+		FR[line] = r;
+		FG[line] = g;
+		FB[line] = b;
+		FDrawValid = FALSE;
+
+		if (!FList[line])
+			FList[line] = new TChartCurve;
+
+	 }
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::SetBackColor
+#
+#   Purpose....: Set back-color
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::SetBackColor(int r, int g, int b)
+{
+	FRBack = r;
+	FGBack = g;
+	FBBack = b;
+	FDrawValid = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::Add
+#
+#   Purpose....: Add point
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::Add(int line, long double x, long double y)
+{
+	if (line >= 0 && line < MAX_CURVES)
+	{
+    	FNewLimits = TRUE;
+
+		if (!FList[line])
+			FList[line] = new TChartCurve;
+
+		FList[line]->Add(x, y);
+		FList[line]->AddColumn(FXAxis->PhysToPixel(x), y);
+	}
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::Remove
+#
+#   Purpose....: Remove oldest point. The column cache is kept, and for
+#                sorted curves only the pixel columns between the removed
+#                point and the new first point are redrawn by Update
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::Remove(int line)
+{
+    TChartCurve *curve;
+    TChartCoord *coord;
+    int pixel;
+    int next;
+
+	if (line >= 0 && line < MAX_CURVES)
+	{
+        curve = FList[line];
+        if (curve && curve->GetCount())
+		{
+            FNewLimits = TRUE;
+
+            coord = curve->Get(0);
+            pixel = FXAxis->PhysToPixel(coord->x);
+            curve->RemoveColumn(pixel, coord->y);
+
+            if (FDrawValid && curve->IsSorted())
+            {
+                coord = curve->Get(1);
+                if (coord)
+                    next = FXAxis->PhysToPixel(coord->x);
+                else
+                    next = pixel;
+
+                if (!FDirty || FDirtyMin > pixel)
+                    FDirtyMin = pixel;
+
+                if (!FDirty || FDirtyMax < next)
+                    FDirtyMax = next;
+
+                FDirty = TRUE;
+
+                if (curve->GetCount() == 2 * (FPlotXMax - FPlotXMin + 1) + 1)
+                    FDrawValid = FALSE;
+            }
+            else
+                FDrawValid = FALSE;
+
+			curve->RemoveFirst();
+		}
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::Clear
+#
+#   Purpose....: Clear
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::Clear(int line)
+{
+	if (line >= 0 && line < MAX_CURVES)
+	{
+        if (FList[line])
+		{
+        	FNewLimits = TRUE;
+        	FDrawValid = FALSE;
+			FList[line]->Clear();
+	    }
+	}
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::Clear
+#
+#   Purpose....: Clear
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::Clear()
+{
+    int i;
+
+	FNewLimits = TRUE;
+	FDrawValid = FALSE;
+
+	for (i = 0; i < MAX_CURVES; i++)
+        if (FList[i])
+		    FList[i]->Clear();
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::CalcLimits
+#
+#   Purpose....: Calculate limits from cached curve limits
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TChart::CalcLimits()
+{
+    int i;
+    long double xmin;
+    long double xmax;
+    long double ymin;
+    long double ymax;
+    int ok;
+    
+    if (FXAxisFixed && FYAxisFixed)
+        return TRUE;
+
+    if (!FNewLimits)
+        return TRUE;
+
+    ok = FALSE;
+
+    for (i = 0; i < MAX_CURVES; i++)
+    {
+        if (FList[i] && FList[i]->GetLimits(&xmin, &xmax, &ymin, &ymax))
+        {        
+            if (!ok)
+            {
+                if (!FXAxisFixed)
+                {
+                    FXAxisMin = xmin;
+                    FXAxisMax = xmax;
+                }
+
+                if (!FYAxisFixed)
+                {
+                    FYAxisMin = ymin;
+                    FYAxisMax = ymax;
+                }
+                    
+                ok = TRUE;
+            }
+            else
+            {
+                if (!FXAxisFixed)
+                {
+                    if (FXAxisMin > xmin)
+                        FXAxisMin = xmin;
+        
+                    if (FXAxisMax < xmax)
+                        FXAxisMax = xmax;
+                }
+
+                if (!FYAxisFixed)
+                {
+                    if (FYAxisMin > ymin)
+                        FYAxisMin = ymin;
+
+                    if (FYAxisMax < ymax)
+                        FYAxisMax = ymax;
+                }
+            }
+        }
+    }
+
+    if (ok)
+        FNewLimits = FALSE;
+
+    return ok;
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::GetXAxis
+#
+#   Purpose....: Get X-axis limits
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::GetXAxis(long double *xmin, long double *xmax)
+{
+    if (CalcLimits())
+    {
+        *xmin = FXAxisMin;
+        *xmax = FXAxisMax;
+    }
+    else
+    {
+        *xmin = 0.0;
+        *xmax = 0.0;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::GetYAxis
+#
+#   Purpose....: Get Y-axis limits
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::GetYAxis(long double *ymin, long double *ymax)
+{
+    if (CalcLimits())
+    {
+        *ymin = FYAxisMin;
+        *ymax = FYAxisMax;
+    }
+    else
+    {
+        *ymin = 0.0;
+        *ymax = 0.0;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::BuildColumns
+#
+#   Purpose....: Rebuild min/max column cache of curve for current x-axis
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::BuildColumns(TChartCurve *curve)
+{
+    TChartCoord *coord;
+    int count;
+    int i;
+
+    curve->ResetColumns(FXAxisMin, FXAxisMax, FPlotXMin, FPlotXMax);
+
+    count = curve->GetCount();
+    for (i = 0; i < count; i++)
+    {
+        coord = curve->Get(i);
+        curve->AddColumn(FXAxis->PhysToPixel(coord->x), coord->y);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::DrawPoints
+#
+#   Purpose....: Draw curve point by point
+#
+#   In params..: curve          curve
+#                start          first point to draw
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::DrawPoints(TChartCurve *curve, int start)
+{
+    TChartCoord *coord;
+    int count;
+    int x;
+    int y;
+    int xprev;
+    int yprev;
+    int i;
+
+    count = curve->GetCount();
+
+    if (start <= 0)
+    {
+        coord = curve->Get(0);
+
+        xprev = FXAxis->PhysToPixel(coord->x);
+        yprev = FYAxis->PhysToPixel(coord->y);
+
+        FDev->SetPixel(xprev, yprev);
+        start = 1;
+    }
+    else
+    {
+        coord = curve->Get(start - 1);
+
+        xprev = FXAxis->PhysToPixel(coord->x);
+        yprev = FYAxis->PhysToPixel(coord->y);
+    }
+
+    for (i = start; i < count; i++)
+    {
+        coord = curve->Get(i);
+
+        x = FXAxis->PhysToPixel(coord->x);
+        y = FYAxis->PhysToPixel(coord->y);
+        FDev->DrawLine(xprev, yprev, x, y);
+        xprev = x;
+        yprev = y;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::DrawColumns
+#
+#   Purpose....: Draw curve from min/max column cache. Each pixel column
+#                is drawn as a vertical min/max line, connected to its
+#                neighbours by the first and last value
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::DrawColumns(TChartCurve *curve)
+{
+    TChartColumn *col;
+    int x;
+    int xprev;
+    int yprev;
+    int started;
+
+    started = FALSE;
+    xprev = 0;
+    yprev = 0;
+
+    for (x = FPlotXMin; x <= FPlotXMax; x++)
+    {
+        col = curve->GetColumn(x);
+        if (col && col->count)
+        {
+            if (started)
+                FDev->DrawLine(xprev, yprev, x, FYAxis->PhysToPixel(col->yfirst));
+            else
+                FDev->SetPixel(x, FYAxis->PhysToPixel(col->yfirst));
+
+            if (col->ymin != col->ymax)
+                FDev->DrawLine(x, FYAxis->PhysToPixel(col->ymin), x, FYAxis->PhysToPixel(col->ymax));
+
+            xprev = x;
+            yprev = FYAxis->PhysToPixel(col->ylast);
+            started = TRUE;
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::DrawCurve
+#
+#   Purpose....: Draw a curve. Sorted curves with more points than
+#                pixel columns are decimated
+#
+#   In params..: line           curve number
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::DrawCurve(int line)
+{
+    TChartCurve *curve = FList[line];
+    int count;
+
+    count = curve->GetCount();
+    if (count)
+    {
+        FDev->SetDrawColor(FR[line], FG[line], FB[line]);
+
+        if (curve->IsSorted() && count > 2 * (FPlotXMax - FPlotXMin + 1))
+        {
+            if (!curve->HasColumns(FXAxisMin, FXAxisMax, FPlotXMin, FPlotXMax))
+                BuildColumns(curve);
+
+            DrawColumns(curve);
+        }
+        else
+            DrawPoints(curve, 0);
+    }
+    curve->SetDrawn(count);
+}
+
+/*##########################################################################
+#
+#   Name       : TChart::Draw
+#
+#   Purpose....: Draw chart
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::Draw()
+{
+	int height;
+    int width;
+    int x;
+    int y;
+    int i;
+
+    CalcLimits();
+
+    FXAxis->SetMin(FXAxisMin);
+    FXAxis->SetMax(FXAxisMax);
+    FYAxis->SetMin(FYAxisMin);
+    FYAxis->SetMax(FYAxisMax);
+
+    FDrawValid = FALSE;
+
+	height = FXAxis->RequiredHeight();  
+
+    y = FYMax - height;
+    if (y <= FYMin)
         return; 
 
     FYAxis->SetWindow(FXMin, FYMin, FXMin, y);
@@ -1089,40 +1834,118 @@ void TChart::Draw()
 
     FXAxis->SetAxisOffset(width);
 
+    FPlotXMin = x;
+    FPlotYMin = FYMin;
+    FPlotXMax = FXMax;
+    FPlotYMax = y;
+
 	for (i = 0; i < MAX_CURVES; i++)
-	{
 	    if (FList[i])
-	    {
-            if (FList[i]->GotoFirst())
-            {
-            	FDev->SetDrawColor(FR[i], FG[i], FB[i]);
-        
-                coord = FList[i]->Get();
+            DrawCurve(i);
 
-            	x = FXAxis->PhysToPixel(coord->x);
-            	y = FYAxis->PhysToPixel(coord->y);
+	FXAxis->Draw();
+	FYAxis->Draw();
 
-            	FDev->SetPixel(x, y);
+    FDrawXMin = FXAxisMin;
+    FDrawXMax = FXAxisMax;
+    FDrawYMin = FYAxisMin;
+    FDrawYMax = FYAxisMax;
+    FDrawValid = TRUE;
+    FDirty = FALSE;
+}
 
-            	xprev = x;
-            	yprev = y;
-	
-                while (FList[i]->GotoNext())
-                {
-                    coord = FList[i]->Get();
-                    if (coord)
-                    {
-                    	x = FXAxis->PhysToPixel(coord->x);
-                    	y = FYAxis->PhysToPixel(coord->y);
-                		FDev->DrawLine(xprev, yprev, x, y);
-                    	xprev = x;
-                    	yprev = y;
-                    }
-                }
-            }
-        }
-    }
+/*##########################################################################
+#
+#   Name       : TChart::DrawStrip
+#
+#   Purpose....: Redraw the plot between two x pixels, then the axes
+#
+#   In params..: xmin, xmax     pixel range
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::DrawStrip(int xmin, int xmax)
+{
+    int i;
+
+    if (xmin < FPlotXMin)
+        xmin = FPlotXMin;
+
+    if (xmax > FPlotXMax)
+        xmax = FPlotXMax;
+
+    if (xmin > xmax)
+        return;
+
+	FDev->SetClipRect(xmin, FPlotYMin, xmax, FPlotYMax);
+	FDev->SetLgopNone();
+	FDev->SetDrawColor(FRBack, FGBack, FBBack);
+	FDev->SetFilledStyle();
+	FDev->DrawRect(xmin, FPlotYMin, xmax, FPlotYMax);
+
+	for (i = 0; i < MAX_CURVES; i++)
+	    if (FList[i])
+            DrawCurve(i);
 
 	FXAxis->Draw();
 	FYAxis->Draw();
 }
+
+/*##########################################################################
+#
+#   Name       : TChart::Update
+#
+#   Purpose....: Draw points added since last draw, and redraw the pixel
+#                columns that removed points covered. Does a full Draw
+#                if the axes, window or colors changed, or if points were
+#                removed from an unsorted curve. Requires that the device
+#                still has the last drawn chart
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TChart::Update()
+{
+    TChartCurve *curve;
+    int i;
+
+    if (FDrawValid)
+    {
+        CalcLimits();
+
+        if (FDrawXMin != FXAxisMin || FDrawXMax != FXAxisMax)
+            FDrawValid = FALSE;
+
+        if (FDrawYMin != FYAxisMin || FDrawYMax != FYAxisMax)
+            FDrawValid = FALSE;
+    }
+
+    if (!FDrawValid)
+    {
+        Draw();
+        return;
+    }
+
+	FDev->SetClipRect(FPlotXMin, FPlotYMin, FPlotXMax, FPlotYMax);
+	FDev->SetLgopNone();
+
+	for (i = 0; i < MAX_CURVES; i++)
+	{
+	    curve = FList[i];
+	    if (curve && curve->GetDrawn() < curve->GetCount())
+	    {
+            FDev->SetDrawColor(FR[i], FG[i], FB[i]);
+            DrawPoints(curve, curve->GetDrawn());
+            curve->SetDrawn(curve->GetCount());
+        }
+    }
+
+    if (FDirty)
+    {
+        DrawStrip(FDirtyMin, FDirtyMax);
+        FDirty = FALSE;
+    }
+}
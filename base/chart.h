@@ -98,6 +98,67 @@ protected:
 
 };
 
+struct TChartColumn
+{
+    long double ymin;
+    long double ymax;
+    long double yfirst;
+    long double ylast;
+    int count;
+};
+
+class TChartCurve
+{
+public:
+	TChartCurve();
+	virtual ~TChartCurve();
+
+	int GetCount() const;
+	TChartCoord *Get(int index) const;
+	int IsSorted() const;
+
+	void Add(long double x, long double y);
+	void RemoveFirst();
+	void Clear();
+
+	int GetLimits(long double *xmin, long double *xmax, long double *ymin, long double *ymax);
+
+	int HasColumns(long double vmin, long double vmax, int pmin, int pmax) const;
+	void ResetColumns(long double vmin, long double vmax, int pmin, int pmax);
+	void InvalidateColumns();
+	void AddColumn(int pixel, long double y);
+	void RemoveColumn(int pixel, long double y);
+	TChartColumn *GetColumn(int pixel) const;
+
+	int GetDrawn() const;
+	void SetDrawn(int count);
+
+protected:
+	void Grow();
+	void ScanLimits();
+
+	TChartCoord *FArr;
+	int FSize;
+	int FStart;
+	int FCount;
+	int FSorted;
+	int FDrawn;
+
+	int FLimitsValid;
+	long double FXMin;
+	long double FXMax;
+	long double FYMin;
+	long double FYMax;
+
+	TChartColumn *FCol;
+	int FColSize;
+	int FColValid;
+	long double FColValMin;
+	long double FColValMax;
+	int FColPixMin;
+	int FColPixMax;
+};
+
 class TChart
 {
 public:
@@ -121,14 +182,20 @@ public:
     void GetYAxis(long double *ymin, long double *ymax);
 
     void Draw();
+    void Update();
 
 protected:
     int CalcLimits();
+    void BuildColumns(TChartCurve *curve);
+    void DrawCurve(int line);
+    void DrawColumns(TChartCurve *curve);
+    void DrawPoints(TChartCurve *curve, int start);
+    void DrawStrip(int xmin, int xmax);
 
 	TGraphicDevice *FDev;
 	TXAxis *FXAxis;
     TYAxis *FYAxis;
-    TChartList *FList[MAX_CURVES];
+    TChartCurve *FList[MAX_CURVES];
 	int FR[MAX_CURVES];
 	int FG[MAX_CURVES];
 	int FB[MAX_CURVES];
@@ -150,6 +217,20 @@ protected:
 
 	int FNewLimits;
 
+	int FDrawValid;
+	int FPlotXMin;
+	int FPlotYMin;
+	int FPlotXMax;
+	int FPlotYMax;
+	long double FDrawXMin;
+	long double FDrawXMax;
+	long double FDrawYMin;
+	long double FDrawYMax;
+
+	int FDirty;
+	int FDirtyMin;
+	int FDirtyMax;
+
 private:
 };
 
@@ -426,6 +426,8 @@ void TControl::Init()
     FTransBitmap = 0;
     FTransChanged = TRUE;
 
+    FOpaque = FALSE;
+
     IdSection.Enter();
     ControlId = CurrId;
     CurrId++;
@@ -597,7 +599,7 @@ int TControl::HasParent()
 #
 #   Name       : TControl::RedrawParent
 #
-#   Purpose....: Redraw parent control
+#   Purpose....: Redraw parent control below this control
 #
 #   In params..: *
 #   Out params.: *
@@ -607,7 +609,7 @@ int TControl::HasParent()
 void TControl::RedrawParent()
 {
     if (FParent)
-        FParent->Redraw();
+        Invalidate();
 }
 
 /*##########################################################################
@@ -656,7 +658,7 @@ void TControl::Add(TControl *control)
     TControl *curr;
     TControl *prev;
 
-    control->FDev = FDev;
+    control->SetControlThread(FDev);
 
     control->FNext = 0;
 
@@ -683,6 +685,31 @@ void TControl::Add(TControl *control)
     NotifyChildChange();
 }
 
+/*##########################################################################
+#
+#   Name       : TControl::SetControlThread
+#
+#   Purpose....: Set control thread for control and all its children
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControl::SetControlThread(TControlThread *dev)
+{
+    TControl *curr;
+
+    FDev = dev;
+
+    curr = FControlList;
+    while (curr)
+    {
+        curr->SetControlThread(dev);
+        curr = curr->FNext;
+    }
+}
+
 /*##########################################################################
 #
 #   Name       : TControl::Delete
@@ -868,6 +895,93 @@ int TControl::IsTransparent()
     return FTransparent;
 }
 
+/*##########################################################################
+#
+#   Name       : TControl::SetOpaque
+#
+#   Purpose....: Declare that Paint covers every pixel of the control,
+#                so controls below it can be skipped
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControl::SetOpaque()
+{
+    FOpaque = TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TControl::ClearOpaque
+#
+#   Purpose....: Declare that Paint might not cover every pixel
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControl::ClearOpaque()
+{
+    FOpaque = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TControl::IsOpaque
+#
+#   Purpose....: Check if control is opaque
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TControl::IsOpaque()
+{
+    return FOpaque && !FTransparent;
+}
+
+/*##########################################################################
+#
+#   Name       : TControl::Invalidate
+#
+#   Purpose....: Add area of control to damage region, so it is repainted
+#                together with everything below it
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControl::Invalidate()
+{
+    int x, y;
+
+    GetAbsPos(&x, &y);
+    InvalidateRect(x, y, x + FWidth - 1, y + FHeight - 1);
+}
+
+/*##########################################################################
+#
+#   Name       : TControl::InvalidateRect
+#
+#   Purpose....: Add an area to damage region
+#
+#   In params..: xmin, ymin     upper left corner (absolute)
+#                xmax, ymax     lower right corner (absolute)
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControl::InvalidateRect(int xmin, int ymin, int xmax, int ymax)
+{
+    if (FDev)
+        FDev->AddDamage(xmin, ymin, xmax, ymax);
+}
+
 /*##########################################################################
 #
 #   Name       : TControl::Set
@@ -1124,9 +1238,7 @@ void TControl::Hide()
         Unprotect();
 
         NotifyChildChange();
-
-        if (FParent)
-           FParent->Redraw();
+        Invalidate();
     }
 }
 
@@ -1225,6 +1337,9 @@ void TControl::Resize(int xsize, int ysize)
         
         if (FTransparent && FVisible)
             RestoreBackground();
+
+        if (FVisible)
+            Invalidate();
     
         FWidth = xsize;
         FHeight = ysize;
@@ -1239,11 +1354,7 @@ void TControl::Resize(int xsize, int ysize)
         if (FVisible)
         {
             NotifyChildChange();
-
-            if (FParent)
-                FParent->Redraw();
-            else
-                Redraw();
+            Invalidate();
         }
     }
 }
@@ -1267,6 +1378,9 @@ void TControl::Move(int xstart, int ystart)
         
         if (FTransparent && FVisible)
             RestoreBackground();
+
+        if (FVisible)
+            Invalidate();
     
         FXMin = xstart;
         FYMin = ystart;
@@ -1279,11 +1393,7 @@ void TControl::Move(int xstart, int ystart)
         if (FVisible)
         {
             NotifyChildChange();
-
-            if (FParent)
-                FParent->Redraw();
-            else
-                Redraw();
+            Invalidate();
         }
     }
 }
@@ -1915,8 +2025,13 @@ void TControl::SetClipRect(TGraphicDevice *dev, int xmin, int ymin, int xmax, in
                 xmin, ymin,
                 xmax, ymax);        
     else
+    {
+        if (FDev)
+            FDev->ClipPaint(&xmin, &ymin, &xmax, &ymax);
+
         dev->SetClipRect(   xmin, ymin,
                 xmax, ymax);
+    }
 
 }
 
@@ -2013,13 +2128,17 @@ void TControl::RedrawChildren(TGraphicDevice *dev, int xmin, int ymin, int width
                 xstart = xmin + control->FXMin;
                 ystart = ymin + control->FYMin;
 
-                SetClipRect(    dev, xstart, ystart,
-                        xstart + control->FWidth - 1,
-                        ystart + control->FHeight - 1);
-
                 control->ResetDirty();
-                control->Paint(dev, xstart, ystart, control->FWidth, control->FHeight);
-                control->RedrawChildren(dev, xstart, ystart, control->FWidth, control->FHeight);
+
+                if (!control->IsOccluded(control->FXMin, control->FYMin, control->FXMin + control->FWidth - 1, control->FYMin + control->FHeight - 1))
+                {
+                    SetClipRect(    dev, xstart, ystart,
+                            xstart + control->FWidth - 1,
+                            ystart + control->FHeight - 1);
+
+                    control->PaintControl(dev, xstart, ystart, control->FWidth, control->FHeight);
+                    control->RedrawChildren(dev, xstart, ystart, control->FWidth, control->FHeight);
+                }
             }            
 
             control = control->FNext;
@@ -2059,18 +2178,23 @@ void TControl::UpdateChildren(TGraphicDevice *dev, int xmin, int ymin, int width
                 xstart = xmin + control->FXMin;
                 ystart = ymin + control->FYMin;
 
-                SetClipRect(    dev, xstart, ystart,
-                        xstart + control->FWidth - 1,
-                        ystart + control->FHeight - 1);
-
-                if (control->IsDirty())
-                {
+                if (control->IsOccluded(control->FXMin, control->FYMin, control->FXMin + control->FWidth - 1, control->FYMin + control->FHeight - 1))
                     control->ResetDirty();
-                    control->Paint(dev, xstart, ystart, control->FWidth, control->FHeight);
-                    control->RedrawChildren(dev, xstart, ystart, control->FWidth, control->FHeight);
-                }                    
                 else
-                    control->UpdateChildren(dev, xstart, ystart, control->FWidth, control->FHeight);
+                {
+                    SetClipRect(    dev, xstart, ystart,
+                            xstart + control->FWidth - 1,
+                            ystart + control->FHeight - 1);
+
+                    if (control->IsDirty())
+                    {
+                        control->ResetDirty();
+                        control->PaintControl(dev, xstart, ystart, control->FWidth, control->FHeight);
+                        control->RedrawChildren(dev, xstart, ystart, control->FWidth, control->FHeight);
+                    }                    
+                    else
+                        control->UpdateChildren(dev, xstart, ystart, control->FWidth, control->FHeight);
+                }
             }            
 
             control = control->FNext;
@@ -2080,6 +2204,131 @@ void TControl::UpdateChildren(TGraphicDevice *dev, int xmin, int ymin, int width
     Unprotect();
 }
 
+/*##########################################################################
+#
+#   Name       : TControl::IsOccluded
+#
+#   Purpose....: Check if an area is covered by an opaque sibling that
+#                is painted after this control
+#
+#   In params..: xmin, ymin     upper left corner (relative to parent)
+#                xmax, ymax     lower right corner (relative to parent)
+#   Out params.: *
+#   Returns....: TRUE if area is covered
+#
+##########################################################################*/
+int TControl::IsOccluded(int xmin, int ymin, int xmax, int ymax)
+{
+    TControl *control;
+
+    control = FNext;
+
+    while (control)
+    {
+        if (control->FVisible && control->IsOpaque())
+        {
+            if (control->FXMin <= xmin && control->FYMin <= ymin &&
+                control->FXMin + control->FWidth - 1 >= xmax &&
+                control->FYMin + control->FHeight - 1 >= ymax)
+                return TRUE;
+        }
+        control = control->FNext;
+    }
+    return FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TControl::PaintControl
+#
+#   Purpose....: Paint control, and record paint time when enabled
+#
+#   In params..: dev            graphic device
+#                xmin, ymin     upper left corner (absolute)
+#                width, height  size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControl::PaintControl(TGraphicDevice *dev, int xmin, int ymin, int width, int height)
+{
+    TTimeStamp start;
+    TTimeStamp end;
+
+    if (FDev && FDev->FPaintStats)
+    {
+        start.SetCurrent();
+        Paint(dev, xmin, ymin, width, height);
+        end.SetCurrent();
+
+        FDev->AddPaintStat(ControlType.GetData(), end.GetDiffMicro(start));
+    }
+    else
+        Paint(dev, xmin, ymin, width, height);
+}
+
+/*##########################################################################
+#
+#   Name       : TControl::PaintDamage
+#
+#   Purpose....: Repaint the part of the control and its children that
+#                is inside a damaged area
+#
+#   In params..: dev            graphic device
+#                xorg, yorg     absolute position of parent
+#                xmin, ymin     upper left corner of damage (absolute)
+#                xmax, ymax     lower right corner of damage (absolute)
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControl::PaintDamage(TGraphicDevice *dev, int xorg, int yorg, int xmin, int ymin, int xmax, int ymax)
+{
+    TControl *control;
+    int xstart;
+    int ystart;
+
+    Protect();
+
+    xstart = xorg + FXMin;
+    ystart = yorg + FYMin;
+
+    if (xstart > xmin)
+        xmin = xstart;
+
+    if (ystart > ymin)
+        ymin = ystart;
+
+    if (xstart + FWidth - 1 < xmax)
+        xmax = xstart + FWidth - 1;
+
+    if (ystart + FHeight - 1 < ymax)
+        ymax = ystart + FHeight - 1;
+
+    if (xmin <= xmax && ymin <= ymax && !IsOccluded(xmin - xorg, ymin - yorg, xmax - xorg, ymax - yorg))
+    {
+        if (xmin == xstart && ymin == ystart && xmax == xstart + FWidth - 1 && ymax == ystart + FHeight - 1)
+            ResetDirty();
+
+        ChildChange();
+
+        SetClipRect(dev, xmin, ymin, xmax, ymax);
+        PaintControl(dev, xstart, ystart, FWidth, FHeight);
+
+        control = FControlList;
+
+        while (control)
+        {
+            if (control->IsVisible())
+                control->PaintDamage(dev, xstart, ystart, xmin, ymin, xmax, ymax);
+
+            control = control->FNext;
+        }
+    }
+
+    Unprotect();
+}
+
 /*##########################################################################
 #
 #   Name       : TControl::OnKeyPressed
@@ -2314,6 +2563,26 @@ int TControl::OnRightDown(int x, int y, int ButtonState, int KeyState)
     return handled;
 }
 
+/*##########################################################################
+#
+#   Name       : TControlPaintStat::TControlPaintStat
+#
+#   Purpose....: Constructor for paint statistics entry
+#
+#   In params..: Type           control type
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TControlPaintStat::TControlPaintStat(const char *Type)
+  : ControlType(Type)
+{
+    Count = 0;
+    TotalMicro = 0;
+    MaxMicro = 0;
+    FNext = 0;
+}
+
 /*##########################################################################
 #
 #   Name       : TControlThread::TControlThread
@@ -2327,8 +2596,10 @@ int TControl::OnRightDown(int x, int y, int ButtonState, int KeyState)
 ##########################################################################*/
 TControlThread::TControlThread()
  : FListSection("Control.List"),
-   FPaintSection("Control.Paint")
+   FPaintSection("Control.Paint"),
+   FDamageSection("Control.Damage")
 {
+    FVbe = 0;
     FGraphic = 0;
     Init();
 }
@@ -2346,7 +2617,8 @@ TControlThread::TControlThread()
 ##########################################################################*/
 TControlThread::TControlThread(TGraphicDevice *dev)
  : FListSection("Control.List"),
-   FPaintSection("Control.Paint")
+   FPaintSection("Control.Paint"),
+   FDamageSection("Control.Damage")
 {
     FVbe = dev;
     FGraphic = new TGraphicDevice(*dev);
@@ -2387,6 +2659,8 @@ TControlThread::~TControlThread()
 
     if (FBackground)
         delete FBackground;
+
+    ResetPaintStats();
 }
 
 /*##########################################################################
@@ -2404,6 +2678,16 @@ void TControlThread::Init()
 {
     FControlList = 0;
     FBackground = 0;
+
+    FPaintXMin = 0;
+    FPaintYMin = 0;
+    FPaintXMax = 0x7FFFFFFF;
+    FPaintYMax = 0x7FFFFFFF;
+
+    FPaintStats = FALSE;
+    FStatList = 0;
+    FLastFrameMicro = 0;
+    FMaxFrameMicro = 0;
 }
 
 /*##########################################################################
@@ -2694,6 +2978,8 @@ void TControlThread::Update(TControl *control)
     int ymin;
     TControl *parent;
     int visible;
+    TTimeStamp start;
+    TTimeStamp end;
 
     xmin = control->FXMin;
     ymin = control->FYMin;
@@ -2717,6 +3003,10 @@ void TControlThread::Update(TControl *control)
         control->ClearRedraw();
 
         FPaintSection.Enter();
+
+        if (FPaintStats)
+            start.SetCurrent();
+
         FGraphic->SetClipRect(   xmin, ymin,
                 xmin + control->FWidth - 1,
                 ymin + control->FHeight - 1);
@@ -2724,16 +3014,337 @@ void TControlThread::Update(TControl *control)
         if (control->IsDirty())
         {
             control->ResetDirty();
-            control->Paint(FGraphic, xmin, ymin, control->FWidth, control->FHeight);
+            control->PaintControl(FGraphic, xmin, ymin, control->FWidth, control->FHeight);
             control->RedrawChildren(FGraphic, xmin, ymin, control->FWidth, control->FHeight);
         }            
         else
             control->UpdateChildren(FGraphic, xmin, ymin, control->FWidth, control->FHeight);
 
+        if (FPaintStats)
+        {
+            end.SetCurrent();
+            AddFrameStat(end.GetDiffMicro(start));
+        }
+
         FPaintSection.Leave();
     }
 }
 
+/*##########################################################################
+#
+#   Name       : TControlThread::AddDamage
+#
+#   Purpose....: Add an area to the damage region
+#
+#   In params..: xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::AddDamage(int xmin, int ymin, int xmax, int ymax)
+{
+    FDamageSection.Enter();
+    FDamage.Add(xmin, ymin, xmax, ymax);
+    FDamageSection.Leave();
+
+    Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::ClipPaint
+#
+#   Purpose....: Limit a clip rectangle to the area currently being repainted
+#
+#   In params..: xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Out params.: xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::ClipPaint(int *xmin, int *ymin, int *xmax, int *ymax)
+{
+    if (*xmin < FPaintXMin)
+        *xmin = FPaintXMin;
+
+    if (*ymin < FPaintYMin)
+        *ymin = FPaintYMin;
+
+    if (*xmax > FPaintXMax)
+        *xmax = FPaintXMax;
+
+    if (*ymax > FPaintYMax)
+        *ymax = FPaintYMax;
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::PaintDamage
+#
+#   Purpose....: Repaint damaged areas, clipped to each area
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::PaintDamage()
+{
+    TDamageRegion damage;
+    TControl *control;
+    TTimeStamp start;
+    TTimeStamp end;
+    int xmin, ymin, xmax, ymax;
+    int i;
+
+    FDamageSection.Enter();
+    damage.Add(FDamage);
+    FDamage.Clear();
+    FDamageSection.Leave();
+
+    if (damage.IsEmpty() || !FGraphic)
+        return;
+
+    Protect();
+    FPaintSection.Enter();
+
+    if (FPaintStats)
+        start.SetCurrent();
+
+    for (i = 0; damage.Get(i, &xmin, &ymin, &xmax, &ymax); i++)
+    {
+        FPaintXMin = xmin;
+        FPaintYMin = ymin;
+        FPaintXMax = xmax;
+        FPaintYMax = ymax;
+
+        if (FBackground)
+        {
+            FGraphic->SetClipRect(xmin, ymin, xmax, ymax);
+            FGraphic->Blit(FBackground, xmin, ymin, xmin, ymin, xmax - xmin + 1, ymax - ymin + 1);
+        }
+
+        control = FControlList;
+
+        while (control)
+        {
+            if (control->IsVisible())
+                control->PaintDamage(FGraphic, 0, 0, xmin, ymin, xmax, ymax);
+
+            control = control->FNext;
+        }
+    }
+
+    FPaintXMin = 0;
+    FPaintYMin = 0;
+    FPaintXMax = 0x7FFFFFFF;
+    FPaintYMax = 0x7FFFFFFF;
+
+    if (FPaintStats)
+    {
+        end.SetCurrent();
+        AddFrameStat(end.GetDiffMicro(start));
+    }
+
+    FPaintSection.Leave();
+    Unprotect();
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::EnablePaintStats
+#
+#   Purpose....: Start recording paint time per control type
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::EnablePaintStats()
+{
+    FPaintStats = TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::DisablePaintStats
+#
+#   Purpose....: Stop recording paint time
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::DisablePaintStats()
+{
+    FPaintStats = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::ResetPaintStats
+#
+#   Purpose....: Remove all recorded paint times
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::ResetPaintStats()
+{
+    TControlPaintStat *stat;
+
+    FPaintSection.Enter();
+
+    while (FStatList)
+    {
+        stat = FStatList;
+        FStatList = stat->FNext;
+        delete stat;
+    }
+
+    FLastFrameMicro = 0;
+    FMaxFrameMicro = 0;
+
+    FPaintSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::AddPaintStat
+#
+#   Purpose....: Record paint time for a control type
+#
+#   In params..: ControlType    control type
+#                Micro          paint time in microseconds
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::AddPaintStat(const char *ControlType, long long Micro)
+{
+    TControlPaintStat *stat;
+
+    stat = FStatList;
+
+    while (stat)
+    {
+        if (!strcmp(stat->ControlType.GetData(), ControlType))
+            break;
+
+        stat = stat->FNext;
+    }
+
+    if (!stat)
+    {
+        stat = new TControlPaintStat(ControlType);
+        stat->FNext = FStatList;
+        FStatList = stat;
+    }
+
+    stat->Count++;
+    stat->TotalMicro += Micro;
+    if (Micro > stat->MaxMicro)
+        stat->MaxMicro = Micro;
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::AddFrameStat
+#
+#   Purpose....: Record time of a complete update
+#
+#   In params..: Micro          update time in microseconds
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TControlThread::AddFrameStat(long long Micro)
+{
+    FLastFrameMicro = Micro;
+    if (Micro > FMaxFrameMicro)
+        FMaxFrameMicro = Micro;
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::GetPaintStats
+#
+#   Purpose....: Get recorded paint time for a control type
+#
+#   In params..: Index          entry number
+#   Out params.: ControlType    control type
+#                Count          number of paints
+#                TotalMicro     total paint time in microseconds
+#                MaxMicro       longest paint time in microseconds
+#   Returns....: TRUE if entry exists
+#
+##########################################################################*/
+int TControlThread::GetPaintStats(int Index, TString *ControlType, int *Count, long long *TotalMicro, long long *MaxMicro)
+{
+    TControlPaintStat *stat;
+    int i;
+
+    FPaintSection.Enter();
+
+    stat = FStatList;
+
+    for (i = 0; i < Index && stat; i++)
+        stat = stat->FNext;
+
+    if (stat)
+    {
+        *ControlType = stat->ControlType;
+        *Count = stat->Count;
+        *TotalMicro = stat->TotalMicro;
+        *MaxMicro = stat->MaxMicro;
+    }
+
+    FPaintSection.Leave();
+
+    if (stat)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::GetLastFrameMicro
+#
+#   Purpose....: Get time of last update
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: update time in microseconds
+#
+##########################################################################*/
+long long TControlThread::GetLastFrameMicro()
+{
+    return FLastFrameMicro;
+}
+
+/*##########################################################################
+#
+#   Name       : TControlThread::GetMaxFrameMicro
+#
+#   Purpose....: Get time of longest update
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: update time in microseconds
+#
+##########################################################################*/
+long long TControlThread::GetMaxFrameMicro()
+{
+    return FMaxFrameMicro;
+}
+
 /*##########################################################################
 #
 #   Name       : TControlThread::DefaultRedraw
@@ -3529,6 +4140,8 @@ void TDisplayControlThread::HandleUpdate()
     }
 
     Unprotect();
+
+    PaintDamage();
 }
 
 /*##########################################################################
@@ -40,6 +40,7 @@
 #include "sprite.h"
 #include "str.h"
 #include "appini.h"
+#include "damage.h"
 
 class TControlThread;
 
@@ -92,6 +93,12 @@ public:
     void ClearTransparent();
     int IsTransparent();
 
+    void SetOpaque();
+    void ClearOpaque();
+    int IsOpaque();
+
+    void Invalidate();
+
     void EnumerateControls(void *Data, void (*CallBack)(void *Data, TControl *Control));
     TControl *GetControl(int ControlId);
 
@@ -139,6 +146,11 @@ protected:
     void UpdateChildren(TGraphicDevice *dev, int xmin, int ymin, int width, int height);
     void RedrawChildren(TGraphicDevice *dev, int xmin, int ymin, int width, int height);
 
+    void InvalidateRect(int xmin, int ymin, int xmax, int ymax);
+    void PaintControl(TGraphicDevice *dev, int xmin, int ymin, int width, int height);
+    void PaintDamage(TGraphicDevice *dev, int xorg, int yorg, int xmin, int ymin, int xmax, int ymax);
+    int IsOccluded(int xmin, int ymin, int xmax, int ymax);
+
     int HasParent();
     void RedrawParent();
 
@@ -158,6 +170,7 @@ private:
     void Init();
     void Add(TControl *Control);
     void Delete(TControl *Control);
+    void SetControlThread(TControlThread *dev);
     TDateTime GetRedrawTime();
 
     TDateTime *FDelay;
@@ -173,6 +186,7 @@ private:
     int FDirty;
 
     int FTransparent;
+    int FOpaque;
 
     TControlThread *FDev;    
     TControl *FNext;    
@@ -180,6 +194,19 @@ private:
     TControl *FParent;
 };
 
+class TControlPaintStat
+{
+public:
+    TControlPaintStat(const char *Type);
+
+    TString ControlType;
+    int Count;
+    long long TotalMicro;
+    long long MaxMicro;
+
+    TControlPaintStat *FNext;
+};
+
 class TControlThread : public TThread
 {
 friend class TControl;
@@ -200,10 +227,23 @@ public:
     void EnumerateControls(void *Data, void (*CallBack)(void *Data, TControl *Control));
     TControl *GetControl(int ControlId);
 
+    void EnablePaintStats();
+    void DisablePaintStats();
+    void ResetPaintStats();
+    int GetPaintStats(int Index, TString *ControlType, int *Count, long long *TotalMicro, long long *MaxMicro);
+    long long GetLastFrameMicro();
+    long long GetMaxFrameMicro();
+
 protected:
     virtual void Protect();
     virtual void Unprotect();
 
+    void AddDamage(int xmin, int ymin, int xmax, int ymax);
+    void PaintDamage();
+    void ClipPaint(int *xmin, int *ymin, int *xmax, int *ymax);
+    void AddPaintStat(const char *ControlType, long long Micro);
+    void AddFrameStat(long long Micro);
+
     void CreateBackground();
     void SaveBackground(TBitmapGraphicDevice *bitmap, int x, int y, int width, int height);
     void RestoreBackground(TBitmapGraphicDevice *bitmap, int x, int y, int width, int height);
@@ -227,6 +267,19 @@ protected:
     TSection FPaintSection;
     TControl *FControlList;
 
+    TSection FDamageSection;
+    TDamageRegion FDamage;
+
+    int FPaintXMin;
+    int FPaintYMin;
+    int FPaintXMax;
+    int FPaintYMax;
+
+    int FPaintStats;
+    TControlPaintStat *FStatList;
+    long long FLastFrameMicro;
+    long long FMaxFrameMicro;
+
 private:
     void Init();
 };
@@ -0,0 +1,342 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# damage.cpp
+# Damage region
+#
+########################################################################*/
+
+#include "damage.h"
+
+#define FALSE   0
+#define TRUE    !FALSE
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::TDamageRegion
+#
+#   Purpose....: Constructor for damage region
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDamageRegion::TDamageRegion()
+{
+    FCount = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::~TDamageRegion
+#
+#   Purpose....: Destructor for damage region
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDamageRegion::~TDamageRegion()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::Clear
+#
+#   Purpose....: Remove all rectangles
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDamageRegion::Clear()
+{
+    FCount = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::IsEmpty
+#
+#   Purpose....: Check if region is empty
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: TRUE if empty
+#
+##########################################################################*/
+int TDamageRegion::IsEmpty() const
+{
+    return FCount == 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::GetCount
+#
+#   Purpose....: Get number of rectangles
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: rectangle count
+#
+##########################################################################*/
+int TDamageRegion::GetCount() const
+{
+    return FCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::Get
+#
+#   Purpose....: Get a rectangle
+#
+#   In params..: index          rectangle index
+#   Out params.: xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Returns....: TRUE if index is valid
+#
+##########################################################################*/
+int TDamageRegion::Get(int index, int *xmin, int *ymin, int *xmax, int *ymax) const
+{
+    if (index < 0 || index >= FCount)
+        return FALSE;
+
+    *xmin = FXMin[index];
+    *ymin = FYMin[index];
+    *xmax = FXMax[index];
+    *ymax = FYMax[index];
+    return TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::Remove
+#
+#   Purpose....: Remove a rectangle
+#
+#   In params..: index          rectangle index
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDamageRegion::Remove(int index)
+{
+    FCount--;
+
+    FXMin[index] = FXMin[FCount];
+    FYMin[index] = FYMin[FCount];
+    FXMax[index] = FXMax[FCount];
+    FYMax[index] = FYMax[FCount];
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::Area
+#
+#   Purpose....: Get area of a rectangle
+#
+#   In params..: index          rectangle index
+#   Out params.: *
+#   Returns....: area in pixels
+#
+##########################################################################*/
+long TDamageRegion::Area(int index) const
+{
+    return (long)(FXMax[index] - FXMin[index] + 1) * (long)(FYMax[index] - FYMin[index] + 1);
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::UnionArea
+#
+#   Purpose....: Get area of the bounding box of a rectangle and another rectangle
+#
+#   In params..: index          rectangle index
+#                xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Out params.: *
+#   Returns....: area in pixels
+#
+##########################################################################*/
+long TDamageRegion::UnionArea(int index, int xmin, int ymin, int xmax, int ymax) const
+{
+    if (FXMin[index] < xmin)
+        xmin = FXMin[index];
+
+    if (FYMin[index] < ymin)
+        ymin = FYMin[index];
+
+    if (FXMax[index] > xmax)
+        xmax = FXMax[index];
+
+    if (FYMax[index] > ymax)
+        ymax = FYMax[index];
+
+    return (long)(xmax - xmin + 1) * (long)(ymax - ymin + 1);
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::Add
+#
+#   Purpose....: Add a rectangle. Rectangles are merged when the bounding
+#                box is no larger than the two parts, or when the list is full
+#
+#   In params..: xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDamageRegion::Add(int xmin, int ymin, int xmax, int ymax)
+{
+    long area;
+    long cost;
+    long best;
+    int merge;
+    int i;
+
+    if (xmin > xmax || ymin > ymax)
+        return;
+
+    area = (long)(xmax - xmin + 1) * (long)(ymax - ymin + 1);
+
+    for (i = 0; i < FCount; i++)
+    {
+        if (FXMin[i] <= xmin && FYMin[i] <= ymin && FXMax[i] >= xmax && FYMax[i] >= ymax)
+            return;
+    }
+
+    i = 0;
+    while (i < FCount)
+    {
+        if (xmin <= FXMin[i] && ymin <= FYMin[i] && xmax >= FXMax[i] && ymax >= FYMax[i])
+            Remove(i);
+        else
+            i++;
+    }
+
+    merge = -1;
+    best = 0;
+
+    for (i = 0; i < FCount; i++)
+    {
+        cost = UnionArea(i, xmin, ymin, xmax, ymax) - Area(i) - area;
+        if (cost <= 0 && (merge < 0 || cost < best))
+        {
+            merge = i;
+            best = cost;
+        }
+    }
+
+    if (merge < 0 && FCount == DAMAGE_MAX_RECTS)
+    {
+        for (i = 0; i < FCount; i++)
+        {
+            cost = UnionArea(i, xmin, ymin, xmax, ymax) - Area(i);
+            if (merge < 0 || cost < best)
+            {
+                merge = i;
+                best = cost;
+            }
+        }
+    }
+
+    if (merge >= 0)
+    {
+        if (FXMin[merge] < xmin)
+            xmin = FXMin[merge];
+
+        if (FYMin[merge] < ymin)
+            ymin = FYMin[merge];
+
+        if (FXMax[merge] > xmax)
+            xmax = FXMax[merge];
+
+        if (FYMax[merge] > ymax)
+            ymax = FYMax[merge];
+
+        Remove(merge);
+        Add(xmin, ymin, xmax, ymax);
+    }
+    else
+    {
+        FXMin[FCount] = xmin;
+        FYMin[FCount] = ymin;
+        FXMax[FCount] = xmax;
+        FYMax[FCount] = ymax;
+        FCount++;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::Add
+#
+#   Purpose....: Add all rectangles of another region
+#
+#   In params..: region         region to add
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDamageRegion::Add(const TDamageRegion &region)
+{
+    int i;
+
+    for (i = 0; i < region.FCount; i++)
+        Add(region.FXMin[i], region.FYMin[i], region.FXMax[i], region.FYMax[i]);
+}
+
+/*##########################################################################
+#
+#   Name       : TDamageRegion::Intersects
+#
+#   Purpose....: Check if a rectangle intersects the region
+#
+#   In params..: xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Out params.: *
+#   Returns....: TRUE if any part is damaged
+#
+##########################################################################*/
+int TDamageRegion::Intersects(int xmin, int ymin, int xmax, int ymax) const
+{
+    int i;
+
+    for (i = 0; i < FCount; i++)
+    {
+        if (FXMin[i] <= xmax && FXMax[i] >= xmin && FYMin[i] <= ymax && FYMax[i] >= ymin)
+            return TRUE;
+    }
+    return FALSE;
+}
@@ -0,0 +1,64 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# damage.h
+# Damage region
+#
+########################################################################*/
+
+#ifndef _DAMAGE_H
+#define _DAMAGE_H
+
+#define DAMAGE_MAX_RECTS    16
+
+class TDamageRegion
+{
+public:
+    TDamageRegion();
+    ~TDamageRegion();
+
+    void Clear();
+    int IsEmpty() const;
+    int GetCount() const;
+    int Get(int index, int *xmin, int *ymin, int *xmax, int *ymax) const;
+
+    void Add(int xmin, int ymin, int xmax, int ymax);
+    void Add(const TDamageRegion &region);
+    int Intersects(int xmin, int ymin, int xmax, int ymax) const;
+
+protected:
+    void Remove(int index);
+    long UnionArea(int index, int xmin, int ymin, int xmax, int ymax) const;
+    long Area(int index) const;
+
+    int FCount;
+    int FXMin[DAMAGE_MAX_RECTS];
+    int FYMin[DAMAGE_MAX_RECTS];
+    int FXMax[DAMAGE_MAX_RECTS];
+    int FYMax[DAMAGE_MAX_RECTS];
+};
+
+#endif
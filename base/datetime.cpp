@@ -111,33 +111,6 @@ static int time_diff = 0;
  * no difference in time.
  */
 long DiffTime = 0;
-/**
- * @brief Array representing the number of days in each month of a non-leap year.
- *
- * DaysInMonth is a constant array containing the number of days in each month
- * of the Gregorian calendar for a standard non-leap year. The array follows
- * a zero-based index where the first element (index 0) represents January and
- * the last element (index 11) represents December.
- *
- * The values are as follows:
- * - January: 31 days
- * - February: 28 days
- * - March: 31 days
- * - April: 30 days
- * - May: 31 days
- * - June: 30 days
- * - July: 31 days
- * - August: 31 days
- * - September: 30 days
- * - October: 31 days
- * - November: 30 days
- * - December: 31 days
- *
- * Note: Leap year calculations are not included in this array. For leap years,
- * the number of days in February should be adjusted to 29 days.
- */
-const int DaysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-
 #ifndef __RDOS__
 /**
  * @brief Retrieves the current local time with time zone adjustments accounted for.
@@ -213,47 +186,43 @@ void SetLocalTime(long time)
 /**
  * Calculates the total number of days passed since January 1, 1970, given a specific date.
  *
+ * Uses the proleptic Gregorian calendar. The year is shifted so that it starts
+ * in March, which puts the leap day last and makes the day of year a linear
+ * function of the month. The calculation runs in constant time.
+ *
  * @param year The year of the date.
  * @param month The month of the date (1-based, e.g., 1 for January, 12 for December).
  * @param day The day of the date.
  * @return The total number of days that have passed since January 1, 1970, up to the specified date.
+ *         Dates before 1970 give a negative value.
  */
 long PassedDays(int year, int month, int day)
 {
-    int i;
-    long days = 0;
+    long y;
+    long era;
+    long yoe;
+    long doy;
+    long doe;
+
+    y = year;
+    if (month <= 2)
+        y--;
+
+    if (y >= 0)
+        era = y / 400;
+    else
+        era = (y - 399) / 400;
 
-    if (year >= 1970)
-    {
-        for (i = 1970; i < year; i++)
-            if (i % 4)
-                days += 365;
-            else
-                days += 366;
-    }
+    yoe = y - era * 400;
+
+    if (month > 2)
+        doy = (153 * (month - 3) + 2) / 5 + day - 1;
     else
-    {
-        for (i = 0; i < year; i++)
-            if (i % 4)
-                days += 365;
-            else
-                days += 366;
-    }
+        doy = (153 * (month + 9) + 2) / 5 + day - 1;
 
-    for (i = 1; i < month; i++) {
-        if (i == 2)
-        {
-            if (year % 4)
-                days += 28;
-            else
-                days += 29;
-        }
-        else
-            days += DaysInMonth[i - 1];
-    }
-    days += day - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
 
-    return days;
+    return era * 146097 + doe - 719468;
 }
 
 /**
@@ -293,50 +262,48 @@ long TimeToBinary(int year, int month, int day, int hour, int min, int sec)
  */
 void BinaryToTime(long time, int *year, int *month, int *day, int *hour, int *min, int *sec)
 {
-    *sec = (int)(time % 60L);
-    time = time / 60L;
-    *min = (int)(time % 60L);
-    time = time / 60L;
-    *hour = (int)(time % 24L);
-    time = time / 24L;
-    *year = (int)(1970L + time / 365L);     // based on 1/1 1970 05.00
-    time -= PassedDays(*year, 1, 1);
-    while (time < 0)
+    long days;
+    long secs;
+    long era;
+    long doe;
+    long yoe;
+    long doy;
+    long mp;
+
+    days = time / 86400L;
+    secs = time % 86400L;
+    if (secs < 0)
     {
-        (*year)--;
-        if ((*year) % 4)
-            time += 365L;
-        else
-            time += 366L;
+        secs += 86400L;
+        days--;
     }
 
-    *month = 1;
-    while (time >= 0)
-    {
-        if (*month == 2)
-        {
-            if ((*year) % 4)
-                time -= 28L;
-            else
-                time -= 29L;
-        }
-        else
-            time -= DaysInMonth[(*month) - 1];
-        (*month)++;
-    }
+    *sec = (int)(secs % 60L);
+    secs = secs / 60L;
+    *min = (int)(secs % 60L);
+    *hour = (int)(secs / 60L);
 
-    (*month)--;
-    if (*month == 2)
-    {
-        if ((*year) % 4)
-            time += 28L;
-        else
-            time += 29L;
-    }
+    days += 719468;
+    if (days >= 0)
+        era = days / 146097;
     else
-        time += DaysInMonth[(*month) - 1];
+        era = (days - 146096) / 146097;
+
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
 
-    *day = (int)time + 1;
+    *day = (int)(doy - (153 * mp + 2) / 5 + 1);
+
+    if (mp < 10)
+        *month = (int)(mp + 3);
+    else
+        *month = (int)(mp - 9);
+
+    *year = (int)(yoe + era * 400);
+    if (*month <= 2)
+        (*year)++;
 }
 
 /**
@@ -474,8 +441,8 @@ static void LinuxToRdos(const struct timespec ts, unsigned long *msb, unsigned l
 
     usec = ts.tv_nsec / 1000;
 
-    usec += sec * 1000000;
-    usec += min * 60000000;
+    usec += (u_int64_t)sec * 1000000;
+    usec += (u_int64_t)min * 60000000;
 
     l = (usec << 32) / 3600000000;
     if (l >= 0x100000000)
@@ -533,7 +500,7 @@ TDateTime::TDateTime()
 #else
     GetLocalTime(&FTs);
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -541,7 +508,8 @@ TDateTime::TDateTime()
  *
  * This constructor initializes the TDateTime instance by copying the internal
  * representation from another TDateTime object. It ensures the internal data is
- * correctly transferred depending on the platform and converts it into a usable record format.
+ * correctly transferred depending on the platform. Calendar fields are only copied
+ * when the source has already decoded them.
  *
  * @param source The TDateTime object to copy from.
  * @return A new TDateTime instance initialized with values copied from the source object.
@@ -554,7 +522,9 @@ TDateTime::TDateTime(const TDateTime &source)
 #else
     memcpy(&FTs, &source.FTs, sizeof(struct timespec));
 #endif
-    RawToRecord();
+    FDecoded = source.FDecoded;
+    if (FDecoded)
+        CopyRecord(source);
 }
 
 /**
@@ -575,7 +545,7 @@ TDateTime::TDateTime(unsigned long Msb, unsigned long Lsb)
 #else
     RdosToLinux(Msb, Lsb, &FTs);
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -606,7 +576,7 @@ TDateTime::TDateTime(unsigned long long Raw)
 
     RdosToLinux(msb, lsb, &FTs);
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -628,7 +598,7 @@ TDateTime::TDateTime(long double real)
 
     RdosToLinux(msb, lsb, &FTs);
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -711,14 +681,9 @@ TDateTime::TDateTime(int Year, int Month, int Day, int Hour, int Min, int Sec, i
  */
 const TDateTime &TDateTime::operator=(const TDateTime &src)
 {
-    FYear = src.FYear;
-    FMonth = src.FMonth;
-    FDay = src.FDay;
-    FHour = src.FHour;
-    FMin = src.FMin;
-    FSec = src.FSec;
-    FMilli = src.FMilli;
-    FMicro = src.FMicro;
+    FDecoded = src.FDecoded;
+    if (FDecoded)
+        CopyRecord(src);
 #ifdef __RDOS__
     FMsb = src.FMsb;
     FLsb = src.FLsb;
@@ -789,7 +754,7 @@ void TDateTime::SetLinuxTimestamp(long long val)
     FTs.tv_nsec = 0;
 
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -826,7 +791,7 @@ void TDateTime::SetLinuxMilliTimestamp(long long val)
     FTs.tv_sec = val / 10000000;
     FTs.tv_nsec = (val % 10000000) * 1000;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -840,8 +805,7 @@ void TDateTime::SetLinuxMilliTimestamp(long long val)
  * and updates internal variables FMsb and FLsb. For other platforms,
  * it retrieves the time using GetLocalTime and updates the FTs structure.
  *
- * Once the raw time is retrieved, the method converts it into the
- * internal record format by calling RawToRecord.
+ * The calendar fields are decoded on first access.
  *
  * @note Behavior may vary depending on the operating system and platform.
  */
@@ -852,7 +816,7 @@ void TDateTime::SetCurrent()
 #else
     GetLocalTime(&FTs);
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -873,7 +837,7 @@ void TDateTime::SetRaw(unsigned long Msb, unsigned long Lsb)
 #else
     RdosToLinux(Msb, Lsb, &FTs);
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -917,6 +881,28 @@ unsigned long TDateTime::GetLsb() const
 #endif
 }
 
+/**
+ * Retrieves the raw 64-bit timestamp, with the MSB in the upper 32 bits and
+ * the LSB in the lower 32 bits. This is the same format that is accepted by
+ * the TDateTime(unsigned long long) constructor.
+ *
+ * On non-RDOS systems only a single conversion is done, rather than the
+ * two that separate GetMsb and GetLsb calls require.
+ *
+ * @return The raw timestamp as an unsigned long long.
+ */
+unsigned long long TDateTime::GetRaw() const
+{
+#ifdef __RDOS__
+    return ((unsigned long long)FMsb << 32) | (unsigned long long)FLsb;
+#else
+    unsigned long msb, lsb;
+
+    LinuxToRdos(FTs, &msb, &lsb);
+    return ((unsigned long long)msb << 32) | (unsigned long long)lsb;
+#endif
+}
+
 /**
  * @brief Determines whether the current instance of the object has expired
  *        based on the current time and its stored expiration time.
@@ -1008,6 +994,9 @@ void TDateTime::WaitUntilExpired() const
 int TDateTime::GetDayOfWeek() const
 {
 #ifdef __RDOS__
+    if (!FDecoded)
+        RawToRecord();
+
     return RdosDayOfWeek(FYear, FMonth, FDay);
 #else
     struct tm tm;
@@ -1024,6 +1013,9 @@ int TDateTime::GetDayOfWeek() const
  */
 int TDateTime::GetYear() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FYear;
 }
 
@@ -1034,6 +1026,9 @@ int TDateTime::GetYear() const
  */
 int TDateTime::GetMonth() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FMonth;
 }
 
@@ -1044,6 +1039,9 @@ int TDateTime::GetMonth() const
  */
 int TDateTime::GetDay() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FDay;
 }
 
@@ -1054,6 +1052,9 @@ int TDateTime::GetDay() const
  */
 int TDateTime::GetHour() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FHour;
 }
 
@@ -1064,6 +1065,9 @@ int TDateTime::GetHour() const
  */
 int TDateTime::GetMin() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FMin;
 }
 
@@ -1074,6 +1078,9 @@ int TDateTime::GetMin() const
  */
 int TDateTime::GetSec() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FSec;
 }
 
@@ -1084,6 +1091,9 @@ int TDateTime::GetSec() const
  */
 int TDateTime::GetMilliSec() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FMilli;
 }
 
@@ -1094,6 +1104,9 @@ int TDateTime::GetMilliSec() const
  */
 int TDateTime::GetMicroSec() const
 {
+    if (!FDecoded)
+        RawToRecord();
+
     return FMicro;
 }
 
@@ -1110,14 +1123,13 @@ int TDateTime::GetMicroSec() const
 long long TDateTime::GetLinuxTimestamp() const
 {
 #ifdef __RDOS__
-    int ival;
+    long long ival;
     long long val;
 
-    ival = FMin;
-    ival = 60 * ival + FSec;
+    ival = (long long)(((unsigned long long)FLsb * 3600) >> 32);
 
     val = (long long)FMsb - 17269032;
-    val = 3600 * val + (long long)ival;
+    val = 3600 * val + ival;
 
     return val;
 #else
@@ -1137,15 +1149,13 @@ long long TDateTime::GetLinuxTimestamp() const
 long long TDateTime::GetLinuxMilliTimestamp() const
 {
 #ifdef __RDOS__
-    int ival;
+    long long ival;
     long long val;
 
-    ival = FMin;
-    ival = 60 * ival + FSec;
-    ival = 1000 * ival + FMilli;
+    ival = (long long)(((unsigned long long)FLsb * 3600000) >> 32);
 
     val = (long long)FMsb - 17269032;
-    val = 3600 * 1000 * val + (long long)ival;
+    val = 3600 * 1000 * val + ival;
 
     return val;
 #else
@@ -1190,17 +1200,34 @@ void TDateTime::Set()
  * Platform-specific behavior:
  * - RDOS: Relies on MSB and LSB decoding functions.
  * - Non-RDOS: Works with binary time and nanosecond data.
+ *
+ * The record is decoded into locals and stored before FDecoded is set, so a
+ * thread that sees FDecoded set also sees the fields. Two threads that decode
+ * the same object at once store identical values.
  */
-void TDateTime::RawToRecord()
+void TDateTime::RawToRecord() const
 {
+    int year, month, day, hour;
+    int min, sec, milli, micro;
+
 #ifdef __RDOS__
-    RdosDecodeMsbTics(FMsb, &FYear, &FMonth, &FDay, &FHour);
-    RdosDecodeLsbTics(FLsb, &FMin, &FSec, &FMilli, &FMicro);
+    RdosDecodeMsbTics(FMsb, &year, &month, &day, &hour);
+    RdosDecodeLsbTics(FLsb, &min, &sec, &milli, &micro);
 #else
-    BinaryToTime(FTs.tv_sec, &FYear, &FMonth, &FDay, &FHour, &FMin, &FSec);
-    FMilli = FTs.tv_nsec / 1000000;
-    FMicro = FTs.tv_nsec / 1000 - (FMilli * 1000);
+    BinaryToTime(FTs.tv_sec, &year, &month, &day, &hour, &min, &sec);
+    milli = FTs.tv_nsec / 1000000;
+    micro = FTs.tv_nsec / 1000 - (milli * 1000);
 #endif
+
+    FYear = year;
+    FMonth = month;
+    FDay = day;
+    FHour = hour;
+    FMin = min;
+    FSec = sec;
+    FMilli = milli;
+    FMicro = micro;
+    FDecoded = true;
 }
 
 /**
@@ -1232,6 +1259,27 @@ void TDateTime::RecordToRaw()
     FTs.tv_sec = TimeToBinary(FYear, FMonth, FDay, FHour, FMin, FSec);
     FTs.tv_nsec = (FMilli * 1000000) + (FMicro * 1000);
 #endif
+    FDecoded = true;
+}
+
+/**
+ * @brief Copies the decoded calendar fields from another TDateTime.
+ *
+ * Used by copy construction and assignment when the source has already
+ * decoded its record, so the copy does not need to decode it again.
+ *
+ * @param src The TDateTime object to copy the fields from.
+ */
+void TDateTime::CopyRecord(const TDateTime &src)
+{
+    FYear = src.FYear;
+    FMonth = src.FMonth;
+    FDay = src.FDay;
+    FHour = src.FHour;
+    FMin = src.FMin;
+    FSec = src.FSec;
+    FMilli = src.FMilli;
+    FMicro = src.FMicro;
 }
 
 /**
@@ -1253,7 +1301,7 @@ void TDateTime::AddTics(long tics)
     FTs.tv_sec += FTs.tv_nsec / 1000000000;
     FTs.tv_nsec %= 1000000000;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -1274,7 +1322,7 @@ void TDateTime::AddMilli(long ms)
     FTs.tv_sec += FTs.tv_nsec / 1000000000;
     FTs.tv_nsec %= 1000000000;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -1297,7 +1345,7 @@ void TDateTime::AddMicro(long us)
     FTs.tv_sec += FTs.tv_nsec / 1000000000;
     FTs.tv_nsec %= 1000000000;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -1316,7 +1364,7 @@ void TDateTime::AddSec(long sec)
 #else
     FTs.tv_sec += sec;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -1331,7 +1379,7 @@ void TDateTime::AddMin(long min)
 #else
     FTs.tv_sec += 60 * min;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -1350,7 +1398,7 @@ void TDateTime::AddHour(long hour)
 #else
     FTs.tv_sec += 60 * 60 * hour;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -1369,7 +1417,7 @@ void TDateTime::AddDay(long day)
 #else
     FTs.tv_sec += 60 * 60 * 24 * day;
 #endif
-    RawToRecord();
+    FDecoded = false;
 }
 
 /**
@@ -1385,6 +1433,9 @@ void TDateTime::AddDay(long day)
  */
 void TDateTime::AddMonth(long month)
 {
+    if (!FDecoded)
+        RawToRecord();
+
     FMonth += month;
 
     if (month > 0)
@@ -1418,6 +1469,9 @@ void TDateTime::AddMonth(long month)
  */
 void TDateTime::AddYear(long year)
 {
+    if (!FDecoded)
+        RawToRecord();
+
     FYear += year;
     RecordToRaw();
 }
@@ -1434,6 +1488,9 @@ void TDateTime::AddYear(long year)
  */
 void TDateTime::NextDay()
 {
+    if (!FDecoded)
+        RawToRecord();
+
     FHour = 0;
     FMin = 0;
     FSec = 0;
@@ -1442,3 +1499,175 @@ void TDateTime::NextDay()
     RecordToRaw();
     AddDay(1);
 }
+
+/**
+ * @brief Constructs a TTimeStamp from a TDateTime.
+ *
+ * Only the raw timestamp is stored, so no calendar fields are decoded.
+ *
+ * @param time The date and time to store.
+ */
+TTimeStamp::TTimeStamp(const TDateTime &time)
+{
+    FRaw = time.GetRaw();
+}
+
+/**
+ * @brief Constructs a TTimeStamp from raw MSB and LSB values.
+ *
+ * @param Msb The most significant bits of the raw timestamp (hours).
+ * @param Lsb The least significant bits of the raw timestamp (fraction of an hour).
+ */
+TTimeStamp::TTimeStamp(unsigned long Msb, unsigned long Lsb)
+{
+    FRaw = ((unsigned long long)Msb << 32) | (unsigned long long)Lsb;
+}
+
+/**
+ * @brief Converts the stored timestamp to a TDateTime.
+ *
+ * @return A TDateTime representing the stored timestamp.
+ */
+TDateTime TTimeStamp::Get() const
+{
+    return TDateTime(FRaw);
+}
+
+/**
+ * @brief Stores a new date and time.
+ *
+ * @param time The date and time to store.
+ */
+void TTimeStamp::Set(const TDateTime &time)
+{
+    FRaw = time.GetRaw();
+}
+
+/**
+ * @brief Stores the current date and time.
+ */
+void TTimeStamp::SetCurrent()
+{
+#ifdef __RDOS__
+    unsigned long msb, lsb;
+
+    RdosGetTime(&msb, &lsb);
+    FRaw = ((unsigned long long)msb << 32) | (unsigned long long)lsb;
+#else
+    struct timespec ts;
+    unsigned long msb, lsb;
+
+    GetLocalTime(&ts);
+    LinuxToRdos(ts, &msb, &lsb);
+    FRaw = ((unsigned long long)msb << 32) | (unsigned long long)lsb;
+#endif
+}
+
+/**
+ * @brief Retrieves the raw 64-bit timestamp.
+ *
+ * @return The raw timestamp, in the same format as TDateTime::GetRaw.
+ */
+unsigned long long TTimeStamp::GetRaw() const
+{
+    return FRaw;
+}
+
+/**
+ * @brief Retrieves the most significant bits (hours) of the timestamp.
+ *
+ * @return The MSB of the raw timestamp.
+ */
+unsigned long TTimeStamp::GetMsb() const
+{
+    return (unsigned long)(FRaw >> 32);
+}
+
+/**
+ * @brief Retrieves the least significant bits (fraction of an hour) of the timestamp.
+ *
+ * @return The LSB of the raw timestamp.
+ */
+unsigned long TTimeStamp::GetLsb() const
+{
+    return (unsigned long)(FRaw & 0xFFFFFFFF);
+}
+
+/**
+ * @brief Calculates the number of microseconds from another timestamp to this one.
+ *
+ * The whole hours and the fraction of an hour are scaled separately so
+ * that the multiplication cannot overflow.
+ *
+ * @param start The timestamp to measure from.
+ * @return The difference in microseconds. Negative if start is later than this timestamp.
+ */
+long long TTimeStamp::GetDiffMicro(const TTimeStamp &start) const
+{
+    unsigned long long diff;
+    unsigned long long us;
+    bool neg;
+
+    if (FRaw >= start.FRaw)
+    {
+        diff = FRaw - start.FRaw;
+        neg = false;
+    }
+    else
+    {
+        diff = start.FRaw - FRaw;
+        neg = true;
+    }
+
+    us = (diff >> 32) * 3600000000ULL;
+    us += ((diff & 0xFFFFFFFF) * 3600000000ULL) >> 32;
+
+    if (neg)
+        return -(long long)us;
+    else
+        return (long long)us;
+}
+
+/**
+ * @brief Compares two timestamps for equality.
+ *
+ * @param src The timestamp to compare with.
+ * @return true if both timestamps are equal.
+ */
+bool TTimeStamp::operator==(const TTimeStamp &src) const
+{
+    return FRaw == src.FRaw;
+}
+
+/**
+ * @brief Compares two timestamps for inequality.
+ *
+ * @param src The timestamp to compare with.
+ * @return true if the timestamps differ.
+ */
+bool TTimeStamp::operator!=(const TTimeStamp &src) const
+{
+    return FRaw != src.FRaw;
+}
+
+/**
+ * @brief Checks if this timestamp is earlier than another.
+ *
+ * @param src The timestamp to compare with.
+ * @return true if this timestamp is earlier than src.
+ */
+bool TTimeStamp::operator<(const TTimeStamp &src) const
+{
+    return FRaw < src.FRaw;
+}
+
+/**
+ * @brief Checks if this timestamp is later than another.
+ *
+ * @param src The timestamp to compare with.
+ * @return true if this timestamp is later than src.
+ */
+bool TTimeStamp::operator>(const TTimeStamp &src) const
+{
+    return FRaw > src.FRaw;
+}
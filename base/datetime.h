@@ -138,6 +138,7 @@ public:
     void SetCurrent();
     unsigned long GetMsb() const;
     unsigned long GetLsb() const;
+    unsigned long long GetRaw() const;
     void SetRaw(unsigned long Msb, unsigned long Lsb);
     bool HasExpired() const;
     void WaitUntilExpired() const;
@@ -176,8 +177,12 @@ protected:
      * On RDOS platforms, it uses Rdos-specific decoding of the MSB and LSB values.
      * On non-RDOS platforms, it uses the BinaryToTime method and additional
      * calculations to derive time components.
+     *
+     * The fields are decoded lazily: constructors and methods that only change
+     * the raw time clear FDecoded, and the getters call this method on first
+     * access. The fields are published before FDecoded is set.
      */
-    void RawToRecord();
+    void RawToRecord() const;
 
     /**
      * Updates the raw time representation of the TDateTime object based on its
@@ -198,6 +203,11 @@ protected:
      */
     void RecordToRaw();
 
+    /**
+     * Copies the decoded date and time fields from another TDateTime object.
+     */
+    void CopyRecord(const TDateTime &src);
+
 private:
 #ifdef __RDOS__
     /**
@@ -242,7 +252,7 @@ private:
      * in conjunction with other date and time components to define a complete
      * date-time representation.
      */
-    int FYear;
+    mutable volatile int FYear;
     /**
      * Represents the month component of a date within the TDateTime class.
      *
@@ -252,7 +262,7 @@ private:
      * It is used in various operations and methods within the TDateTime class to
      * handle and manipulate date information.
      */
-    int FMonth;
+    mutable volatile int FMonth;
     /**
      * Represents the day of the month in a date.
      *
@@ -261,7 +271,7 @@ private:
      * 31, depending on the month and year, and is used in the internal
      * representation and manipulation of dates within the TDateTime class.
      */
-    int FDay;
+    mutable volatile int FDay;
     /**
      * Holds the hour component of a date and time, represented as an integer
      * in the range from 0 to 23.
@@ -271,7 +281,7 @@ private:
      * during the construction of a `TDateTime` object or updated when related
      * operations are performed on the instance.
      */
-    int FHour;
+    mutable volatile int FHour;
     /**
      * Stores the minute component of a date and time.
      *
@@ -280,13 +290,13 @@ private:
      * throughout the class's operations, such as construction, assignment, and
      * date/time calculations.
      */
-    int FMin;
+    mutable volatile int FMin;
     /**
      * Represents the second component of a time value in the context of a
      * TDateTime object. It typically ranges from 0 to 59 and is used to store
      * the number of seconds in a given time representation.
      */
-    int FSec;
+    mutable volatile int FSec;
     /**
      * Stores the millisecond component of a timestamp in the TDateTime class.
      *
@@ -295,7 +305,7 @@ private:
      * the other components (year, month, day, hour, minute, second, and microseconds)
      * to construct and manipulate a complete timestamp.
      */
-    int FMilli;
+    mutable volatile int FMilli;
     /**
      * Stores the microsecond component of a datetime value. This represents the
      * fractional part of a second at the microsecond precision level.
@@ -308,7 +318,57 @@ private:
      * The range of FMicro is 0 to 999,999, corresponding to the valid range of
      * microseconds within one second.
      */
-    int FMicro;
+    mutable volatile int FMicro;
+    /**
+     * Indicates whether the date and time fields (FYear to FMicro) hold the
+     * decoded value of the raw time. When false, the fields are stale and
+     * are decoded by RawToRecord on first access.
+     *
+     * The flag and the fields are volatile so the compiler keeps the field
+     * stores before the flag store in RawToRecord, and the flag load before
+     * the field loads in the getters. x86 does not reorder stores with
+     * stores or loads with loads, so a const TDateTime can be read from
+     * several threads.
+     */
+    mutable volatile bool FDecoded;
+};
+
+/**
+ * Compact timestamp for bulk storage, such as samples, logs and charts.
+ *
+ * Holds only the raw 64-bit time (hours in the upper 32 bits and the fraction
+ * of an hour in the lower 32 bits), so it is 8 bytes and can be copied with
+ * memcpy. No copy constructor, assignment operator or destructor is declared
+ * so the type stays trivially copyable. Calendar fields are only decoded when
+ * converting back to TDateTime with Get.
+ */
+class TTimeStamp
+{
+public:
+    TTimeStamp() {}
+    TTimeStamp(const TDateTime &time);
+    TTimeStamp(unsigned long Msb, unsigned long Lsb);
+
+    TDateTime Get() const;
+    void Set(const TDateTime &time);
+    void SetCurrent();
+
+    unsigned long long GetRaw() const;
+    unsigned long GetMsb() const;
+    unsigned long GetLsb() const;
+
+    long long GetDiffMicro(const TTimeStamp &start) const;
+
+    bool operator==(const TTimeStamp &src) const;
+    bool operator!=(const TTimeStamp &src) const;
+    bool operator<(const TTimeStamp &src) const;
+    bool operator>(const TTimeStamp &src) const;
+
+private:
+    /**
+     * The raw 64-bit timestamp.
+     */
+    unsigned long long FRaw;
 };
 
 #endif
@@ -32,67 +32,446 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <memory.h>
 
 #include "iso8583.h"
 
 #define     FALSE	0
 #define     TRUE	!FALSE
 
-static int ElemDigits[] = {
-                              0,   0,  -2,   6,  16,   		    // 0 - 4
-                             16,  16,  10,  12,   8,                // 5 - 9
-                              8,  12,  14,   6,   4,                // 10 - 14
-                              8,   4,   4,  -3,   3,                // 15 - 19
-                              3,  22,  16,   3,   3,                // 20 - 24
-                              4,   4,  27,   8,   3,                // 25 - 29
-                             32,  23,  -2,  -2,  -4,                // 30 - 34
-                             -2,  -3,  12,   6,   4,                // 35 - 39
-                              3,  16,  -2,  -4   -4,                // 40 - 44
-                             -2,  -3,  -3,  -3,  -4,                // 45 - 49
-                             -3,  -3,   8,  -2,  -3,                // 50 - 54
-                             -4,  -2,   3,  -2,  -3,                // 55 - 59
-                             -3,  -3,  -3,  -3,   4,                // 60 - 64
-                              8,  -3,   2,   9,  40,                // 65 - 69
-                             18,  -4,  -4,   8, 156,                // 70 - 74
-                             90,  -4,  -4,  -4,  -4,                // 75 - 79
-                             -4,  -4,  -4,  -4,  -4,                // 80 - 84
-                             -4,  -4,  -4,  -4,  -4,                // 85 - 89
-                             -4,  -4,  -4,  -2,  -2,                // 90 - 94
-                             -2,  -3,  21,  25,  -2,                // 95 - 99
-                             -2,  -2,  -2,  -2,  -4,                // 100 - 104
-                             -4,  -4,  -4,  -4,  -3,                // 105 - 109
-                             -3,  -4,  -4,  -4,  -4,                // 110 - 114
-                             -4,  -4,  -4,  -4,  -4,                // 115 - 119
-                             -4,  -4,  -4,  -4,  -4,                // 120 - 124
-                             -4,  -4,  -4,   4,   0,                // 125 - 129
-                              0,   0,   0,   0,   0,                // 130 - 134
-                              0,   0,   0,   0,   0,                // 135 - 139
-                              0,   0,   0,   0,   0,                // 140 - 144
-                              0,   0,   0,   0,   0,                // 145 - 149
-                              0,   0,   0,   0,   0,                // 150 - 154
-                              0,   0,   0,   0,   0,                // 155 - 159
-                              0,   0,   0,   0,   0,                // 160 - 164
-                              0,   0,   0,   0,   0,                // 165 - 169
-                              0,   0,   0,   0,   0,                // 170 - 174
-                              0,   0,   0,   0,   0,                // 175 - 179
-                              0,   0,   0,   0,   0,                // 180 - 184
-                              0,   0,   0,   0,   0,                // 185 - 189
-                              0,   0,   0                           // 190 - 192
-                           };
+static TIso8583Field DefaultFields[ISO8583_MAX_ID + 1] =
+{
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 0
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 1
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 2
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    6},   // 3
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   16},   // 4
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   16},   // 5
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   16},   // 6
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   10},   // 7
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   12},   // 8
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    8},   // 9
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    8},   // 10
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   12},   // 11
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   14},   // 12
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    6},   // 13
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 14
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    8},   // 15
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 16
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 17
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 18
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    3},   // 19
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    3},   // 20
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   22},   // 21
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   16},   // 22
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    3},   // 23
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    3},   // 24
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 25
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 26
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   27},   // 27
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    8},   // 28
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    3},   // 29
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   32},   // 30
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   23},   // 31
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 32
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 33
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 34
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 35
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 36
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   12},   // 37
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    6},   // 38
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 39
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    3},   // 40
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   16},   // 41
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 42
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 43
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 44
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 45
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 46
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 47
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 48
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 49
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 50
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 51
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    8},   // 52
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 53
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 54
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 55
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 56
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    3},   // 57
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 58
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 59
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 60
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 61
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 62
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 63
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 64
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    8},   // 65
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 66
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    2},   // 67
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    9},   // 68
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   40},   // 69
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   18},   // 70
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 71
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 72
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    8},   // 73
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,  156},   // 74
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   90},   // 75
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 76
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 77
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 78
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 79
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 80
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 81
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 82
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 83
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 84
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 85
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 86
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 87
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 88
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 89
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 90
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 91
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 92
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 93
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 94
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 95
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 96
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   21},   // 97
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,   25},   // 98
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 99
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 100
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 101
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 102
+    {ISO8583_LLVAR,   ISO8583_ASCII, ISO8583_ASCII,   99},   // 103
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 104
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 105
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 106
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 107
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 108
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 109
+    {ISO8583_LLLVAR,  ISO8583_ASCII, ISO8583_ASCII,  999},   // 110
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 111
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 112
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 113
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 114
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 115
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 116
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 117
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 118
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 119
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 120
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 121
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 122
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 123
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 124
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 125
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 126
+    {ISO8583_LLLLVAR, ISO8583_ASCII, ISO8583_ASCII, 9999},   // 127
+    {ISO8583_FIXED,   ISO8583_ASCII, ISO8583_ASCII,    4},   // 128
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 129
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 130
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 131
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 132
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 133
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 134
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 135
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 136
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 137
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 138
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 139
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 140
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 141
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 142
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 143
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 144
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 145
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 146
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 147
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 148
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 149
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 150
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 151
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 152
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 153
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 154
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 155
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 156
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 157
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 158
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 159
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 160
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 161
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 162
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 163
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 164
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 165
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 166
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 167
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 168
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 169
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 170
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 171
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 172
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 173
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 174
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 175
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 176
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 177
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 178
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 179
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 180
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 181
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 182
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 183
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 184
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 185
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 186
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 187
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 188
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 189
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 190
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0},   // 191
+    {ISO8583_NONE,    ISO8583_ASCII, ISO8583_ASCII,    0}    // 192
+};
+
+/*##########################################################################
+#
+#   Name       : PrefixDigits
+#
+#   Purpose....: Get number of length digits for field type
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static int PrefixDigits(const TIso8583Field *field)
+{
+    switch (field->Type)
+    {
+        case ISO8583_LLVAR:
+            return 2;
+
+        case ISO8583_LLLVAR:
+            return 3;
+
+        case ISO8583_LLLLVAR:
+            return 4;
+
+        default:
+            return 0;
+    }
+}
 
 
 /*##########################################################################
 #
-#   Name       : TIso8583Element::TIso8583Element
+#   Name       : ByteCount
+#
+#   Purpose....: Get wire size of field data
+#
+#   In params..: encoding       field encoding
+#                len            length in digits, characters or bytes
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static int ByteCount(int encoding, int len)
+{
+    if (encoding == ISO8583_BCD)
+        return (len + 1) / 2;
+    else
+        return len;
+}
+
+
+/*##########################################################################
+#
+#   Name       : PackBcd
+#
+#   Purpose....: Pack digits as right-aligned BCD
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static void PackBcd(char *dest, const char *str, int len)
+{
+    int odd = len & 1;
+    int i;
+    int pos;
+    char nibble;
+
+    memset(dest, 0, (len + 1) / 2);
+
+    for (i = 0; i < len; i++)
+    {
+        nibble = str[i] & 0xF;
+        pos = i + odd;
+
+        if (pos & 1)
+            dest[pos >> 1] |= nibble;
+        else
+            dest[pos >> 1] |= nibble << 4;
+    }
+}
+
+
+/*##########################################################################
+#
+#   Name       : PackBcdPad
+#
+#   Purpose....: Pack digits as right-aligned BCD, padded to size digits
+#                with fill, before the digits if right is set
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static void PackBcdPad(char *dest, const char *str, int len, int size, char fill, int right)
+{
+    int odd = size & 1;
+    int pad = size - len;
+    int i;
+    int pos;
+    char ch;
+    char nibble;
+
+    memset(dest, 0, (size + 1) / 2);
+
+    for (i = 0; i < size; i++)
+    {
+        if (right)
+        {
+            if (i < pad)
+                ch = fill;
+            else
+                ch = str[i - pad];
+        }
+        else
+        {
+            if (i < len)
+                ch = str[i];
+            else
+                ch = fill;
+        }
+
+        nibble = ch & 0xF;
+        pos = i + odd;
+
+        if (pos & 1)
+            dest[pos >> 1] |= nibble;
+        else
+            dest[pos >> 1] |= nibble << 4;
+    }
+}
+
+
+/*##########################################################################
 #
-#   Purpose....: Constructor for TIso8583Element
+#   Name       : UnpackBcd
+#
+#   Purpose....: Unpack right-aligned BCD to digits
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
+static void UnpackBcd(char *str, const char *src, int len)
+{
+    int odd = len & 1;
+    int i;
+    int pos;
+    int nibble;
+
+    for (i = 0; i < len; i++)
+    {
+        pos = i + odd;
+
+        if (pos & 1)
+            nibble = src[pos >> 1] & 0xF;
+        else
+            nibble = (src[pos >> 1] >> 4) & 0xF;
+
+        if (nibble < 10)
+            str[i] = (char)('0' + nibble);
+        else
+            str[i] = (char)('A' + nibble - 10);
+    }
+}
+
+
+/*##########################################################################
+#
+#   Name       : FormatNumber
+#
+#   Purpose....: Format number with leading zeros
+#
+#   In params..: val            value
+#                width          minimum width, at most 23
+#   Out params.: str            formatted number
+#   Returns....: length
+#
+##########################################################################*/
+static int FormatNumber(char *str, long long val, int width)
+{
+    char digits[24];
+    unsigned long long uval;
+    int count;
+    int len;
+
+    if (val < 0)
+        uval = (unsigned long long)(-(val + 1)) + 1;
+    else
+        uval = (unsigned long long)val;
+
+    count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + uval % 10);
+        uval /= 10;
+    }
+    while (uval);
+
+    len = 0;
+    if (val < 0)
+    {
+        str[len++] = '-';
+        width--;
+    }
+
+    while (width > count && len < 23 - count)
+    {
+        str[len++] = '0';
+        width--;
+    }
+
+    while (count)
+        str[len++] = digits[--count];
+
+    str[len] = 0;
+    return len;
+}
+
+
+/*##########################################################################
+#
+#   Name       : TIso8583Element::TIso8583Element
+#
+#   Purpose....: Constructor for TIso8583Element. Standalone field codec
+#                kept for callers of the old per-field API. TIso8583 and
+#                TIso8583Bitmap no longer use it
+#
+#   In params..: Id             field id
+#                DigitTable     digits per id, negative for variable size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
 TIso8583Element::TIso8583Element(int Id, int *DigitTable)
 {
     int digits = 0;
@@ -141,7 +520,7 @@ TIso8583Element::TIso8583Element(int Id, int *DigitTable)
 TIso8583Element::~TIso8583Element()
 {
     if (FBuf)
-        delete FBuf;
+        delete[] FBuf;
 }
 
 /*##########################################################################
@@ -177,7 +556,7 @@ char *TIso8583Element::Decode(char *buf, int *remsize)
 
     if (FBuf)
     {
-        delete FBuf;
+        delete[] FBuf;
         FBuf = 0;
     }
 
@@ -308,7 +687,7 @@ void TIso8583Element::SetInt(int val)
 
     if (FBuf)
     {
-        delete FBuf;
+        delete[] FBuf;
         FBuf = 0;
     }
 
@@ -345,7 +724,7 @@ void TIso8583Element::SetLong(long long val)
 
     if (FBuf)
     {
-        delete FBuf;
+        delete[] FBuf;
         FBuf = 0;
     }
 
@@ -398,7 +777,7 @@ void TIso8583Element::SetString(const char *str)
 
     if (FBuf)
     {
-        delete FBuf;
+        delete[] FBuf;
         FBuf = 0;
     }
 
@@ -574,7 +953,7 @@ void TIso8583Element::SetBinary(const char *data, int size)
 
     if (FBuf)
     {
-        delete FBuf;
+        delete[] FBuf;
         FBuf = 0;
     }
 
@@ -603,60 +982,48 @@ void TIso8583Element::SetBinary(const char *data, int size)
 
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::TIso8583Bitmap
+#   Name       : TIso8583Message::TIso8583Message
 #
-#   Purpose....: Constructor for TIso8583Bitmap
+#   Purpose....: Constructor for TIso8583Message
 #
-#   In params..: *
+#   In params..: Fields         field definitions, indexed by id
+#                MaxId          highest field id
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TIso8583Bitmap::TIso8583Bitmap(int *DigitTable)
+TIso8583Message::TIso8583Message(const TIso8583Field *Fields, int MaxId)
 {
-    FDigitTable = DigitTable;
+    FFields = Fields;
 
-    Init();
-}
+    if (MaxId > ISO8583_MAX_ID)
+        FMaxId = ISO8583_MAX_ID;
+    else
+        FMaxId = MaxId;
 
-/*##########################################################################
-#
-#   Name       : TIso8583Bitmap::~TIso8583Bitmap
-#
-#   Purpose....: Destructor for TIso8583Bitmap
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TIso8583Bitmap::~TIso8583Bitmap()
-{
     Reset();
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::Init
+#   Name       : TIso8583Message::~TIso8583Message
 #
-#   Purpose....: Init elements
+#   Purpose....: Destructor for TIso8583Message
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583Bitmap::Init()
+TIso8583Message::~TIso8583Message()
 {
-    int i;
-
-    for (i = 0; i <= 63; i++)
-        FIsoArr[i] = 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::Reset
+#   Name       : TIso8583Message::Reset
 #
 #   Purpose....: Reset elements
 #
@@ -665,1022 +1032,1211 @@ void TIso8583Bitmap::Init()
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583Bitmap::Reset()
+void TIso8583Message::Reset()
 {
     int i;
 
-    for (i = 0; i <= 63; i++)
+    for (i = 0; i <= FMaxId; i++)
     {
-        if (FIsoArr[i])
-        {
-            delete FIsoArr[i];
-            FIsoArr[i] = 0;
-        }
+        FPtr[i] = 0;
+        FLen[i] = 0;
+        FStr[i] = 0;
+        FSlot[i] = 0;
+        FSlotSize[i] = 0;
+        FStrSlot[i] = 0;
+        FStrSlotSize[i] = 0;
     }
+
+    FBufUsed = 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::GetElem
+#   Name       : TIso8583Message::IsBitmap
 #
-#   Purpose....: Get element
+#   Purpose....: Check if id is reserved for a bitmap
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TIso8583Element *TIso8583Bitmap::GetElem(int Id)
+int TIso8583Message::IsBitmap(int Id)
 {
-    return FIsoArr[Id];
+    return FALSE;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::AddElem
+#   Name       : TIso8583Message::GetField
 #
-#   Purpose....: Add element using ID
+#   Purpose....: Get field definition
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: definition or 0 if field is not defined
 #
 ##########################################################################*/
-TIso8583Element *TIso8583Bitmap::AddElem(int Id)
+const TIso8583Field *TIso8583Message::GetField(int Id)
 {
-    int digits = 0;
+    const TIso8583Field *field;
 
-    if (Id > 0 && Id <= 63)
-    {
-        digits = FDigitTable[Id];
-        if (digits)
-        {
-            if (FIsoArr[Id] == 0)
-                FIsoArr[Id] = new TIso8583Element(Id, FDigitTable);
+    if (Id < 0 || Id > FMaxId || IsBitmap(Id))
+        return 0;
 
-            return FIsoArr[Id];
-        }
-    }
-    return 0;
+    field = FFields + Id;
+    if (field->Type == ISO8583_NONE)
+        return 0;
+
+    return field;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::AddElem
+#   Name       : TIso8583Message::Alloc
 #
-#   Purpose....: Add element from used array
+#   Purpose....: Allocate from message buffer
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: buffer or 0 if message buffer is full
 #
 ##########################################################################*/
-TIso8583Element *TIso8583Bitmap::AddElem()
+char *TIso8583Message::Alloc(int size)
 {
-    int digits = 0;
-    int Id;
+    char *ptr;
 
-    for (Id = 1; Id <= 63; Id++)
-    {
-        if (FUsedArr[Id])
-        {
-            FUsedArr[Id] = 0;
-            break;
-        }
-    }
- 
-    if (Id > 0 && Id <= 63)
-    {
-        digits = FDigitTable[Id];
-        if (digits)
-        {
-            if (FIsoArr[Id] == 0)
-                FIsoArr[Id] = new TIso8583Element(Id, FDigitTable);
+    if (size < 0 || FBufUsed + size > ISO8583_BUF_SIZE)
+        return 0;
 
-            return FIsoArr[Id];
-        }
-    }
-    return 0;
+    ptr = FBuf + FBufUsed;
+    FBufUsed += size;
+    return ptr;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::IsValid
+#   Name       : TIso8583Message::AllocSlot
 #
-#   Purpose....: Check if id is valid
+#   Purpose....: Allocate a field slot from message buffer. The current
+#                slot is reused when large enough, or grown in place
+#                when it is the last allocation
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: Slot, SlotSize current slot
+#                size           required size
+#   Out params.: Slot, SlotSize new slot
+#   Returns....: buffer or 0 if message buffer is full
 #
 ##########################################################################*/
-int TIso8583Bitmap::IsValid(int Id)
+char *TIso8583Message::AllocSlot(char **Slot, int *SlotSize, int size)
 {
-    TIso8583Element *elem = GetElem(Id);
+    char *ptr;
 
-    if (elem)
-        return TRUE;
+    if (*Slot && *SlotSize >= size)
+        return *Slot;
+
+    if (*Slot && *Slot + *SlotSize == FBuf + FBufUsed)
+        FBufUsed -= *SlotSize;
+
+    ptr = Alloc(size);
+
+    if (ptr)
+        *SlotSize = size;
     else
-        return FALSE;
+        *SlotSize = 0;
+
+    *Slot = ptr;
+    return ptr;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::GetInt
+#   Name       : TIso8583Message::SetText
 #
-#   Purpose....: Get int element
+#   Purpose....: Set field from text or binary data. Data shorter than a
+#                fixed length is padded with fill, after the data or
+#                before the data if right is set. Longer data is
+#                truncated
 #
-#   In params..: *
+#   In params..: Id             field id
+#                str, len       data
+#                fill           pad character
+#                right          right-align data
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if set, FALSE if field is not defined or message
+#                buffer is full. The field is cleared on failure
 #
 ##########################################################################*/
-int TIso8583Bitmap::GetInt(int Id)
+int TIso8583Message::SetText(int Id, const char *str, int len, char fill, int right)
 {
-    TIso8583Element *elem = GetElem(Id);
+    const TIso8583Field *field = GetField(Id);
+    char *ptr;
+    int size;
+    int pad;
+
+    if (!field)
+        return FALSE;
 
-    if (elem)
-        return elem->GetInt();
+    if (field->Type == ISO8583_FIXED)
+        size = field->Length;
     else
-        return 0;
+    {
+        size = len;
+        if (field->Length && size > field->Length)
+            size = field->Length;
+    }
+
+    if (len > size)
+        len = size;
+
+    pad = size - len;
+
+    FStr[Id] = 0;
+
+    ptr = AllocSlot(&FSlot[Id], &FSlotSize[Id], ByteCount(field->Encoding, size));
+    if (!ptr)
+    {
+        FPtr[Id] = 0;
+        FLen[Id] = 0;
+        return FALSE;
+    }
+
+    if (field->Encoding == ISO8583_BCD)
+        PackBcdPad(ptr, str, len, size, fill, right);
+    else
+    {
+        if (right)
+        {
+            memset(ptr, fill, pad);
+            memcpy(ptr + pad, str, len);
+        }
+        else
+        {
+            memcpy(ptr, str, len);
+            memset(ptr + len, fill, pad);
+        }
+    }
+
+    FPtr[Id] = ptr;
+    FLen[Id] = size;
+    return TRUE;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::GetLong
+#   Name       : TIso8583Message::SetNumber
 #
-#   Purpose....: Get long long element
+#   Purpose....: Set field from number
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if set
 #
 ##########################################################################*/
-long long TIso8583Bitmap::GetLong(int Id)
+int TIso8583Message::SetNumber(int Id, long long val)
 {
-    TIso8583Element *elem = GetElem(Id);
+    const TIso8583Field *field = GetField(Id);
+    char str[24];
+    int width;
+    int len;
+
+    if (field)
+    {
+        if (field->Type == ISO8583_FIXED && field->Length < 23)
+            width = field->Length;
+        else
+            width = 0;
 
-    if (elem)
-        return elem->GetInt();
+        len = FormatNumber(str, val, width);
+        return SetText(Id, str, len, '0', TRUE);
+    }
     else
-        return 0;
+        return FALSE;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::GetString
+#   Name       : TIso8583Message::GetDigits
 #
-#   Purpose....: Get string element
+#   Purpose....: Get field data as text
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: Id             field id
+#                size           size of str
+#   Out params.: str            text
+#   Returns....: length of text
 #
 ##########################################################################*/
-const char *TIso8583Bitmap::GetString(int Id)
+int TIso8583Message::GetDigits(int Id, char *str, int size)
 {
-    TIso8583Element *elem = GetElem(Id);
+    const TIso8583Field *field = GetField(Id);
+    int len;
 
-    if (elem)
-        return elem->GetString();
-    else
+    if (!field || !FPtr[Id] || size <= 0)
+    {
+        if (size > 0)
+            *str = 0;
         return 0;
+    }
+
+    len = FLen[Id];
+    if (len >= size)
+        len = size - 1;
+
+    if (field->Encoding == ISO8583_BCD)
+    {
+        if (len == FLen[Id])
+            UnpackBcd(str, FPtr[Id], len);
+        else
+            len = 0;
+    }
+    else
+        memcpy(str, FPtr[Id], len);
+
+    str[len] = 0;
+    return len;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::GetTime
+#   Name       : TIso8583Message::EncodeField
 #
-#   Purpose....: Get time element
+#   Purpose....: Encode field
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: Id             field id
+#                buf            output position
+#                RemSize        remaining size
+#   Out params.: RemSize        remaining size
+#   Returns....: next output position or 0 on error
 #
 ##########################################################################*/
-TDateTime TIso8583Bitmap::GetTime(int Id)
+char *TIso8583Message::EncodeField(int Id, char *buf, int *remsize)
 {
-    TIso8583Element *elem = GetElem(Id);
+    const TIso8583Field *field = GetField(Id);
+    int len;
+    int bytes;
+    int digits;
+    int prefix;
+    int i;
+    char str[8];
 
-    if (elem)
-        return elem->GetTime();
-    else
-        return TDateTime();
-}
+    if (!field || !FPtr[Id])
+        return 0;
 
-/*##########################################################################
-#
-#   Name       : TIso8583Bitmap::GetBinarySize
-#
-#   Purpose....: Get binary element
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-int TIso8583Bitmap::GetBinarySize(int Id)
-{
-    TIso8583Element *elem = GetElem(Id);
+    len = FLen[Id];
+    bytes = ByteCount(field->Encoding, len);
+    digits = PrefixDigits(field);
 
-    if (elem)
-        return elem->GetBinarySize();
-    else
+    if (digits)
+    {
+        if (field->LenEncoding == ISO8583_ASCII)
+            prefix = digits;
+        else
+            prefix = (digits + 1) / 2;
+
+        if (prefix > *remsize)
+            return 0;
+
+        switch (field->LenEncoding)
+        {
+            case ISO8583_ASCII:
+                for (i = digits - 1; i >= 0; i--)
+                {
+                    buf[i] = (char)('0' + len % 10);
+                    len /= 10;
+                }
+                break;
+
+            case ISO8583_BCD:
+                for (i = digits - 1; i >= 0; i--)
+                {
+                    str[i] = (char)('0' + len % 10);
+                    len /= 10;
+                }
+                PackBcd(buf, str, digits);
+                break;
+
+            default:
+                for (i = prefix - 1; i >= 0; i--)
+                {
+                    buf[i] = (char)(len & 0xFF);
+                    len = len >> 8;
+                }
+                break;
+        }
+
+        if (len)
+            return 0;
+
+        buf += prefix;
+        *remsize -= prefix;
+    }
+
+    if (bytes > *remsize)
         return 0;
+
+    memcpy(buf, FPtr[Id], bytes);
+    buf += bytes;
+    *remsize -= bytes;
+    return buf;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::GetBinaryData
+#   Name       : TIso8583Message::DecodeField
 #
-#   Purpose....: Get binary element
+#   Purpose....: Decode field in place. The field refers to buf
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: Id             field id
+#                buf            input position
+#                RemSize        remaining size
+#   Out params.: RemSize        remaining size
+#   Returns....: next input position or 0 on error
 #
 ##########################################################################*/
-const char *TIso8583Bitmap::GetBinaryData(int Id)
+char *TIso8583Message::DecodeField(int Id, char *buf, int *remsize)
 {
-    TIso8583Element *elem = GetElem(Id);
+    const TIso8583Field *field = GetField(Id);
+    int len;
+    int bytes;
+    int digits;
+    int prefix;
+    int i;
+    int nibble;
+
+    if (!field)
+        return 0;
 
-    if (elem)
-        return elem->GetBinaryData();
+    digits = PrefixDigits(field);
+
+    if (digits)
+    {
+        if (field->LenEncoding == ISO8583_ASCII)
+            prefix = digits;
+        else
+            prefix = (digits + 1) / 2;
+
+        if (prefix > *remsize)
+            return 0;
+
+        len = 0;
+
+        switch (field->LenEncoding)
+        {
+            case ISO8583_ASCII:
+                for (i = 0; i < digits; i++)
+                {
+                    if (buf[i] < '0' || buf[i] > '9')
+                        return 0;
+                    len = 10 * len + buf[i] - '0';
+                }
+                break;
+
+            case ISO8583_BCD:
+                for (i = digits & 1; i < 2 * prefix; i++)
+                {
+                    if (i & 1)
+                        nibble = buf[i >> 1] & 0xF;
+                    else
+                        nibble = (buf[i >> 1] >> 4) & 0xF;
+
+                    if (nibble > 9)
+                        return 0;
+                    len = 10 * len + nibble;
+                }
+                break;
+
+            default:
+                for (i = 0; i < prefix; i++)
+                    len = (len << 8) | (buf[i] & 0xFF);
+                break;
+        }
+
+        if (field->Length && len > field->Length)
+            return 0;
+
+        buf += prefix;
+        *remsize -= prefix;
+    }
     else
+        len = field->Length;
+
+    bytes = ByteCount(field->Encoding, len);
+    if (bytes > *remsize)
         return 0;
-}
 
-/*##########################################################################
-#
-#   Name       : TIso8583Bitmap::AddInt
-#
-#   Purpose....: Add int element
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-void TIso8583Bitmap::AddInt(int Id, int val)
-{
-    TIso8583Element *elem = AddElem(Id);
+    FPtr[Id] = buf;
+    FLen[Id] = len;
+    FStr[Id] = 0;
 
-    if (elem)
-        elem->SetInt(val);
+    buf += bytes;
+    *remsize -= bytes;
+    return buf;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::AddLong
+#   Name       : TIso8583Message::EncodeBitmap
 #
-#   Purpose....: Add long element
+#   Purpose....: Encode a 64-bit bitmap
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: First          id of first bit
+#                Ext            set first bit to signal another bitmap
+#                buf            output position
+#                RemSize        remaining size
+#   Out params.: RemSize        remaining size
+#   Returns....: next output position or 0 on error
 #
 ##########################################################################*/
-void TIso8583Bitmap::AddLong(int Id, long long val)
+char *TIso8583Message::EncodeBitmap(int first, int ext, char *buf, int *remsize)
 {
-    TIso8583Element *elem = AddElem(Id);
+    int i, j;
+    int elem;
+    char mask;
+    char ch;
+
+    if (*remsize < 8)
+        return 0;
+
+    for (i = 0; i < 8; i++)
+    {
+        elem = first + 8 * i;
+        mask = (char)0x80;
+
+        if (i == 0 && ext)
+            ch = mask;
+        else
+            ch = 0;
+
+        for (j = 0; j < 8; j++)
+        {
+            if (elem <= FMaxId && FPtr[elem])
+                ch |= mask;
 
-    if (elem)
-        elem->SetLong(val);
+            mask = (mask >> 1) & 0x7F;
+            elem++;
+        }
+        buf[i] = ch;
+    }
+    *remsize -= 8;
+    return buf + 8;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::AddString
+#   Name       : TIso8583Message::DecodeBitmap
 #
-#   Purpose....: Add string element
+#   Purpose....: Decode a 64-bit bitmap
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: First          id of first bit
+#                buf            input position
+#                RemSize        remaining size
+#   Out params.: Used           flags for present ids
+#                RemSize        remaining size
+#   Returns....: next input position or 0 on error
 #
 ##########################################################################*/
-void TIso8583Bitmap::AddString(int Id, const char *str)
+char *TIso8583Message::DecodeBitmap(int first, char *used, char *buf, int *remsize)
 {
-    TIso8583Element *elem = AddElem(Id);
+    int i, j;
+    int elem;
+    char mask;
+    char ch;
+
+    if (*remsize < 8)
+        return 0;
+
+    for (i = 0; i < 8; i++)
+    {
+        elem = first + 8 * i;
+        mask = (char)0x80;
+        ch = buf[i];
 
-    if (elem)
-        elem->SetString(str);
+        for (j = 0; j < 8; j++)
+        {
+            if ((ch & mask) && elem <= FMaxId)
+                used[elem] = TRUE;
+
+            mask = (mask >> 1) & 0x7F;
+            elem++;
+        }
+    }
+    *remsize -= 8;
+    return buf + 8;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::AddTime
+#   Name       : TIso8583Message::IsValid
 #
-#   Purpose....: Add time element
+#   Purpose....: Check if id is valid
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583Bitmap::AddTime(int Id, TDateTime &time)
+int TIso8583Message::IsValid(int Id)
 {
-    TIso8583Element *elem = AddElem(Id);
-
-    if (elem)
-        elem->SetTime(time);
+    if (Id >= 0 && Id <= FMaxId && FPtr[Id])
+        return TRUE;
+    else
+        return FALSE;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::AddBinary
+#   Name       : TIso8583Message::GetInt
 #
-#   Purpose....: Add binary element
+#   Purpose....: Get int element
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583Bitmap::AddBinary(int Id, const char *data, int size)
+int TIso8583Message::GetInt(int Id)
 {
-    TIso8583Element *elem = AddElem(Id);
-
-    if (elem)
-        elem->SetBinary(data, size);
+    return (int)GetLong(Id);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::EncodeBitmap
+#   Name       : TIso8583Message::GetLong
 #
-#   Purpose....: Encode primary bitmap
+#   Purpose....: Get long long element. Parses the field data directly
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-char *TIso8583Bitmap::EncodeBitmap(char *buf, int *remsize)
+long long TIso8583Message::GetLong(int Id)
 {
-    int i, j;
-    int elem;
-    char mask;
-    char ch;
-    char *ptr = buf;
+    const TIso8583Field *field = GetField(Id);
+    const char *ptr;
+    int len;
+    int i;
+    int nibble;
+    int neg;
+    long long val;
+
+    if (!field || !FPtr[Id])
+        return 0;
 
-    if (*remsize >= 8)
+    ptr = FPtr[Id];
+    len = FLen[Id];
+    val = 0;
+
+    if (field->Encoding == ISO8583_BCD)
     {
-        for (i = 0; i < 8; i++)
+        for (i = len & 1; i < len + (len & 1); i++)
         {
-            elem = 8 * i + 1;
-            mask = 0x80;
-            ch = 0;
-
-            for (j = 0; j < 8; j++)
-            {
-                if (FIsoArr[elem])
-                    ch |= mask;
+            if (i & 1)
+                nibble = ptr[i >> 1] & 0xF;
+            else
+                nibble = (ptr[i >> 1] >> 4) & 0xF;
 
-                mask = mask >> 1;
-                elem++;
-            }
-            ptr[i] = ch;
+            if (nibble > 9)
+                break;
+            val = 10 * val + nibble;
         }
-        *remsize -= 8;
-        ptr += 8;
+        return val;
     }
-    else
-        return 0;
 
-    return ptr;
-}
-
-/*##########################################################################
-#
-#   Name       : TIso8583Bitmap::Encode
-#
-#   Purpose....: Encode message
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-int TIso8583Bitmap::Encode(char *buf, int size)
-{
-    int remsize;
-    char *ptr;
-    int elem;
+    i = 0;
+    while (i < len && ptr[i] == ' ')
+        i++;
 
-    if (size > 8)
+    neg = FALSE;
+    if (i < len && (ptr[i] == '-' || ptr[i] == '+'))
     {
-        ptr = buf;
-        remsize = size;
-
-        ptr = EncodeBitmap(ptr, &remsize);
-
-        for (elem = 1; elem <= 63 && ptr; elem++)
-            if (FIsoArr[elem])
-                ptr = FIsoArr[elem]->Encode(ptr, &remsize);
-
-        return size - remsize;
+        neg = ptr[i] == '-';
+        i++;
+    }
 
+    while (i < len && ptr[i] >= '0' && ptr[i] <= '9')
+    {
+        val = 10 * val + ptr[i] - '0';
+        i++;
     }
-    return 0;
+
+    if (neg)
+        return -val;
+    else
+        return val;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::DecodeBitmap
+#   Name       : TIso8583Message::GetString
 #
-#   Purpose....: Decode primary bitmap
+#   Purpose....: Get string element. The string is kept in the message
+#                buffer until next Reset
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-char *TIso8583Bitmap::DecodeBitmap(char *buf, int *remsize)
+const char *TIso8583Message::GetString(int Id)
 {
-    int i, j;
-    int elem;
-    char mask;
-    char *ptr = buf;
-    char ch;
+    char *str;
+    int len;
 
-    for (i = 0; i <= 63; i++)
-        FUsedArr[i] = FALSE;
+    if (!IsValid(Id))
+        return 0;
 
-    if (*remsize >= 8)
+    if (!FStr[Id])
     {
-        for (i = 0; i < 8; i++)
+        len = FLen[Id];
+        str = AllocSlot(&FStrSlot[Id], &FStrSlotSize[Id], len + 1);
+        if (str)
         {
-            elem = 8 * i + 1;
-            mask = 0x80;
-            ch = ptr[i];
-
-            for (j = 0; j < 8; j++)
-            {
-                if (ch & mask)
-                    FUsedArr[elem] = TRUE;
-
-                mask = mask >> 1;
-                elem++;
-            }
+            GetDigits(Id, str, len + 1);
+            FStr[Id] = str;
         }
-        *remsize -= 8;
-        ptr += 8;
     }
-    else
-        return 0;
-
-    return ptr;
+    return FStr[Id];
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Bitmap::Decode
+#   Name       : TIso8583Message::GetTime
 #
-#   Purpose....: Decode message
+#   Purpose....: Get time element
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TIso8583Bitmap::Decode(char *buf, int size)
+TDateTime TIso8583Message::GetTime(int Id)
 {
-    int remsize;
-    char *ptr;
-    TIso8583Element *e;
+    char str[20];
+    int year, month, day;
+    int hour, min, sec;
 
-    if (size > 8)
-    {
-        ptr = buf;
-        remsize = size;
+    if (!IsValid(Id))
+        return TDateTime();
 
-        ptr = DecodeBitmap(ptr, &remsize);
+    year = 0;
+    month = 1;
+    day = 1;
+    hour = 0;
+    min = 0;
+    sec = 0;
 
-        while (ptr)
-        {
-            e = AddElem();
-            if (e)
-                ptr = e->Decode(ptr, &remsize);
-            else
-                ptr = 0;
-        }
+    switch (GetDigits(Id, str, sizeof(str)))
+    {
+        case 10:
+            sscanf(str, "%02d%02d%02d%02d%02d", &month, &day, &hour, &min, &sec);
+            break;
 
-        return size - remsize;
+        case 12:
+            sscanf(str, "%02d%02d%02d%02d%02d%02d", &year, &month, &day, &hour, &min, &sec);
+            break;
 
+        case 14:
+            sscanf(str, "%04d%02d%02d%02d%02d%02d", &year, &month, &day, &hour, &min, &sec);
+            break;
+    
+        case 6:
+            sscanf(str, "%02d%02d%02d", &year, &month, &day);
+            break;
+
+        case 4:
+            sscanf(str, "%02d%02d", &year, &month);
+            break;
     }
-    return 0;
-}
 
-/*##########################################################################
-#
-#   Name       : TIso8583::TIso8583
-#
-#   Purpose....: Constructor for TIso8583
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TIso8583::TIso8583()
-{
-    FDigitTable = ElemDigits;
+    if (year && year < 100)
+        year += 2000;
 
-    Init();
+    return TDateTime(year, month, day, hour, min, sec);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::~TIso8583
+#   Name       : TIso8583Message::GetBinarySize
 #
-#   Purpose....: Destructor for TIso8583
+#   Purpose....: Get binary size
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TIso8583::~TIso8583()
+int TIso8583Message::GetBinarySize(int Id)
 {
-    Reset();
+    const TIso8583Field *field = GetField(Id);
+
+    if (field && FPtr[Id])
+        return ByteCount(field->Encoding, FLen[Id]);
+    else
+        return 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::Init
+#   Name       : TIso8583Message::GetBinaryData
 #
-#   Purpose....: Init elements
+#   Purpose....: Get binary element
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583::Init()
+const char *TIso8583Message::GetBinaryData(int Id)
 {
-    int i;
-
-    for (i = 0; i <= 192; i++)
-        FIsoArr[i] = 0;
-
-    FMsgType = 0;
+    if (IsValid(Id))
+        return FPtr[Id];
+    else
+        return 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::Reset
+#   Name       : TIso8583Message::GetData
 #
-#   Purpose....: Reset elements
+#   Purpose....: Get encoded field data without copying
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: Id             field id
+#   Out params.: len            length in digits, characters or bytes
+#   Returns....: field data or 0
 #
 ##########################################################################*/
-void TIso8583::Reset()
+const char *TIso8583Message::GetData(int Id, int *len)
 {
-    int i;
-
-    for (i = 0; i <= 192; i++)
+    if (IsValid(Id))
     {
-        if (FIsoArr[i])
-        {
-            delete FIsoArr[i];
-            FIsoArr[i] = 0;
-        }
+        *len = FLen[Id];
+        return FPtr[Id];
+    }
+    else
+    {
+        *len = 0;
+        return 0;
     }
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::Create
+#   Name       : TIso8583Message::AddInt
 #
-#   Purpose....: create a new msg
+#   Purpose....: Add int element
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if added, FALSE if field is not defined or
+#                message buffer is full
 #
 ##########################################################################*/
-void TIso8583::Create(int MsgType)
+int TIso8583Message::AddInt(int Id, int val)
 {
-    Reset();
-    FMsgType = MsgType;
+    return SetNumber(Id, val);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::GetElem
+#   Name       : TIso8583Message::AddLong
 #
-#   Purpose....: Get element
+#   Purpose....: Add long element
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if added, FALSE if field is not defined or
+#                message buffer is full
 #
 ##########################################################################*/
-TIso8583Element *TIso8583::GetElem(int Id)
+int TIso8583Message::AddLong(int Id, long long val)
 {
-    return FIsoArr[Id];
+    return SetNumber(Id, val);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::AddElem
+#   Name       : TIso8583Message::AddString
 #
-#   Purpose....: Add element using ID
+#   Purpose....: Add string element
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if added, FALSE if field is not defined or
+#                message buffer is full
 #
 ##########################################################################*/
-TIso8583Element *TIso8583::AddElem(int Id)
+int TIso8583Message::AddString(int Id, const char *str)
 {
-    int digits = 0;
-
-    if (Id > 0 && Id <= 192)
-    {
-        digits = FDigitTable[Id];
-        if (digits)
-        {
-            if (FIsoArr[Id] == 0)
-                FIsoArr[Id] = new TIso8583Element(Id, FDigitTable);
-
-            return FIsoArr[Id];
-        }
-    }
-    return 0;
+    return SetText(Id, str, strlen(str), ' ', FALSE);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::AddElem
+#   Name       : TIso8583Message::AddTime
 #
-#   Purpose....: Add element from used array
+#   Purpose....: Add time element
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if added, FALSE if field is not defined or
+#                message buffer is full
 #
 ##########################################################################*/
-TIso8583Element *TIso8583::AddElem()
+int TIso8583Message::AddTime(int Id, TDateTime &time)
 {
-    int digits = 0;
-    int Id;
+    const TIso8583Field *field = GetField(Id);
+    char str[20];
 
-    for (Id = 1; Id <= 192; Id++)
+    if (!field)
+        return FALSE;
+
+    switch (field->Length)
     {
-        if (FUsedArr[Id])
-        {
-            FUsedArr[Id] = 0;
+        case 10:
+            sprintf(str, "%02d%02d%02d%02d%02d", time.GetMonth(), time.GetDay(), time.GetHour(), time.GetMin(), time.GetSec());
             break;
-        }
-    }
- 
-    if (Id > 0 && Id <= 192)
-    {
-        digits = FDigitTable[Id];
-        if (digits)
-        {
-            if (FIsoArr[Id] == 0)
-                FIsoArr[Id] = new TIso8583Element(Id, FDigitTable);
 
-            return FIsoArr[Id];
-        }
+        case 12:
+            sprintf(str, "%02d%02d%02d%02d%02d%02d", time.GetYear() - 2000, time.GetMonth(), time.GetDay(), time.GetHour(), time.GetMin(), time.GetSec());
+            break;
+
+        case 14:
+            sprintf(str, "%04d%02d%02d%02d%02d%02d", time.GetYear(), time.GetMonth(), time.GetDay(), time.GetHour(), time.GetMin(), time.GetSec());
+            break;
+    
+        case 6:
+            sprintf(str, "%02d%02d%02d", time.GetYear() - 2000, time.GetMonth(), time.GetDay());
+            break;
+
+        case 4:
+            sprintf(str, "%02d%02d", time.GetYear() - 2000, time.GetMonth());
+            break;
+
+        default:
+            str[0] = 0;
     }
-    return 0;
+
+    return AddString(Id, str);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::IsValid
+#   Name       : TIso8583Message::AddBinary
 #
-#   Purpose....: Check if id is valid
+#   Purpose....: Add binary element
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if added, FALSE if field is not defined or
+#                message buffer is full
 #
 ##########################################################################*/
-int TIso8583::IsValid(int Id)
+int TIso8583Message::AddBinary(int Id, const char *data, int size)
 {
-    TIso8583Element *elem = GetElem(Id);
-
-    if (elem)
-        return TRUE;
-    else
-        return FALSE;
+    return SetText(Id, data, size, 0, FALSE);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::GetInt
+#   Name       : TIso8583Bitmap::TIso8583Bitmap
 #
-#   Purpose....: Get int element
+#   Purpose....: Constructor for TIso8583Bitmap from digit table.
+#                Positive entries are fixed sizes, negative entries are
+#                number of length digits
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TIso8583::GetInt(int Id)
+TIso8583Bitmap::TIso8583Bitmap(int *DigitTable)
+  : TIso8583Message(FDigitFields, 63)
 {
-    TIso8583Element *elem = GetElem(Id);
+    int i;
+    int digits;
+    TIso8583Field *field;
 
-    if (elem)
-        return elem->GetInt();
-    else
-        return 0;
-}
+    for (i = 0; i <= 63; i++)
+    {
+        digits = DigitTable[i];
+        field = FDigitFields + i;
 
-/*##########################################################################
-#
-#   Name       : TIso8583::GetLong
-#
-#   Purpose....: Get long long element
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-long long TIso8583::GetLong(int Id)
-{
-    TIso8583Element *elem = GetElem(Id);
+        field->Encoding = ISO8583_ASCII;
+        field->LenEncoding = ISO8583_ASCII;
 
-    if (elem)
-        return elem->GetInt();
-    else
-        return 0;
+        switch (digits)
+        {
+            case 0:
+                field->Type = ISO8583_NONE;
+                field->Length = 0;
+                break;
+
+            case -2:
+                field->Type = ISO8583_LLVAR;
+                field->Length = 99;
+                break;
+
+            case -3:
+                field->Type = ISO8583_LLLVAR;
+                field->Length = 999;
+                break;
+
+            case -4:
+                field->Type = ISO8583_LLLLVAR;
+                field->Length = 9999;
+                break;
+
+            default:
+                if (digits > 0)
+                {
+                    field->Type = ISO8583_FIXED;
+                    field->Length = digits;
+                }
+                else
+                {
+                    field->Type = ISO8583_NONE;
+                    field->Length = 0;
+                }
+                break;
+        }
+    }
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::GetString
+#   Name       : TIso8583Bitmap::TIso8583Bitmap
 #
-#   Purpose....: Get string element
+#   Purpose....: Constructor for TIso8583Bitmap from field table
 #
-#   In params..: *
+#   In params..: Fields         64 field definitions
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-const char *TIso8583::GetString(int Id)
+TIso8583Bitmap::TIso8583Bitmap(const TIso8583Field *Fields)
+  : TIso8583Message(Fields, 63)
 {
-    TIso8583Element *elem = GetElem(Id);
-
-    if (elem)
-        return elem->GetString();
-    else
-        return 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::GetTime
+#   Name       : TIso8583Bitmap::~TIso8583Bitmap
 #
-#   Purpose....: Get time element
+#   Purpose....: Destructor for TIso8583Bitmap
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TDateTime TIso8583::GetTime(int Id)
+TIso8583Bitmap::~TIso8583Bitmap()
 {
-    TIso8583Element *elem = GetElem(Id);
-
-    if (elem)
-        return elem->GetTime();
-    else
-        return TDateTime();
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::GetBinarySize
+#   Name       : TIso8583Bitmap::Encode
 #
-#   Purpose....: Get binary element
+#   Purpose....: Encode message
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: encoded size or 0 on error
 #
 ##########################################################################*/
-int TIso8583::GetBinarySize(int Id)
+int TIso8583Bitmap::Encode(char *buf, int size)
 {
-    TIso8583Element *elem = GetElem(Id);
+    int remsize;
+    char *ptr;
+    int elem;
+
+    remsize = size;
+
+    ptr = EncodeBitmap(1, FALSE, buf, &remsize);
 
-    if (elem)
-        return elem->GetBinarySize();
+    for (elem = 1; elem <= 63 && ptr; elem++)
+        if (FPtr[elem])
+            ptr = EncodeField(elem, ptr, &remsize);
+
+    if (ptr)
+        return size - remsize;
     else
         return 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::GetBinaryData
+#   Name       : TIso8583Bitmap::Decode
 #
-#   Purpose....: Get binary element
+#   Purpose....: Decode message in place. Fields refer to buf, which must
+#                be kept until next Decode or Reset
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: decoded size or 0 on error
 #
 ##########################################################################*/
-const char *TIso8583::GetBinaryData(int Id)
+int TIso8583Bitmap::Decode(char *buf, int size)
 {
-    TIso8583Element *elem = GetElem(Id);
+    int remsize;
+    char *ptr;
+    int elem;
+    char used[64];
 
-    if (elem)
-        return elem->GetBinaryData();
+    Reset();
+    memset(used, 0, sizeof(used));
+
+    remsize = size;
+
+    ptr = DecodeBitmap(1, used, buf, &remsize);
+
+    for (elem = 1; elem <= 63 && ptr; elem++)
+        if (used[elem])
+            ptr = DecodeField(elem, ptr, &remsize);
+
+    if (ptr)
+        return size - remsize;
     else
         return 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::AddInt
+#   Name       : TIso8583::TIso8583
 #
-#   Purpose....: Add int element
+#   Purpose....: Constructor for TIso8583 with default field table
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583::AddInt(int Id, int val)
+TIso8583::TIso8583()
+  : TIso8583Message(DefaultFields, ISO8583_MAX_ID)
 {
-    TIso8583Element *elem = AddElem(Id);
-
-    if (elem)
-        elem->SetInt(val);
+    FMsgType = 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::AddLong
+#   Name       : TIso8583::TIso8583
 #
-#   Purpose....: Add long element
+#   Purpose....: Constructor for TIso8583 with field table
 #
-#   In params..: *
+#   In params..: Fields         ISO8583_MAX_ID + 1 field definitions. Entry 0 is the
+#                message type
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583::AddLong(int Id, long long val)
+TIso8583::TIso8583(const TIso8583Field *Fields)
+  : TIso8583Message(Fields, ISO8583_MAX_ID)
 {
-    TIso8583Element *elem = AddElem(Id);
-
-    if (elem)
-        elem->SetLong(val);
+    FMsgType = 0;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::AddString
+#   Name       : TIso8583::~TIso8583
 #
-#   Purpose....: Add string element
+#   Purpose....: Destructor for TIso8583
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583::AddString(int Id, const char *str)
+TIso8583::~TIso8583()
 {
-    TIso8583Element *elem = AddElem(Id);
-
-    if (elem)
-        elem->SetString(str);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::AddTime
+#   Name       : TIso8583::IsBitmap
 #
-#   Purpose....: Add time element
+#   Purpose....: Check if id is reserved for a bitmap
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583::AddTime(int Id, TDateTime &time)
+int TIso8583::IsBitmap(int Id)
 {
-    TIso8583Element *elem = AddElem(Id);
-
-    if (elem)
-        elem->SetTime(time);
+    return Id == 1 || Id == 65;
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583::AddBinary
+#   Name       : TIso8583::Create
 #
-#   Purpose....: Add binary element
+#   Purpose....: Create new message
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TIso8583::AddBinary(int Id, const char *data, int size)
+void TIso8583::Create(int MsgType)
 {
-    TIso8583Element *elem = AddElem(Id);
-
-    if (elem)
-        elem->SetBinary(data, size);
+    Reset();
+    FMsgType = MsgType;
+    SetNumber(0, MsgType);
 }
 
+
 /*##########################################################################
 #
-#   Name       : TIso8583Element::EncodeBitmap1
+#   Name       : TIso8583::GetMsgType
 #
-#   Purpose....: Encode primary bitmap
+#   Purpose....: Get message type
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-char *TIso8583::EncodeBitmap1(char *buf, int *remsize)
+int TIso8583::GetMsgType()
 {
-    int i, j;
-    int elem;
-    char mask;
-    char ch;
-    char *ptr = buf;
-    int Has2 = FALSE;
-    int Has3 = FALSE;
-
-    for (i = 65; i <= 192; i++)
-        if (FIsoArr[i])
-            Has2 = TRUE;
-
-    for (i = 129; i <= 192; i++)
-        if (FIsoArr[i])
-            Has3 = TRUE;
-
-    if (*remsize >= 8)
-    {
-        for (i = 0; i < 8; i++)
-        {
-            elem = 8 * i + 1;
-            mask = 0x80;
-
-            if (i == 0 && Has2)
-                ch = 0x80;
-            else
-                ch = 0;
-
-            for (j = 0; j < 8; j++)
-            {
-                if (FIsoArr[elem])
-                    ch |= mask;
-
-                mask = mask >> 1;
-                elem++;
-            }
-            ptr[i] = ch;
-        }
-        *remsize -= 8;
-        ptr += 8;
-    }
-    else
-        return 0;
-
-    if (Has2 && *remsize >= 8)
-    {
-        for (i = 0; i < 8; i++)
-        {
-            elem = 64 + 8 * i + 1;
-            mask = 0x80;
-
-            if (i == 0 && Has3)
-                ch = 0x80;
-            else
-                ch = 0;
-
-            for (j = 0; j < 8; j++)
-            {
-                if (FIsoArr[elem])
-                    ch |= mask;
-
-                mask = mask >> 1;
-                elem++;
-            }
-            ptr[i] = ch;
-        }
-        *remsize -= 8;
-        ptr += 8;
-    }
-
-    return ptr;
+    return FMsgType;
 }
 
+
 /*##########################################################################
 #
 #   Name       : TIso8583::Encode
@@ -1689,7 +2245,7 @@ char *TIso8583::EncodeBitmap1(char *buf, int *remsize)
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: encoded size or 0 on error
 #
 ##########################################################################*/
 int TIso8583::Encode(char *buf, int size)
@@ -1697,137 +2253,88 @@ int TIso8583::Encode(char *buf, int size)
     int remsize;
     char *ptr;
     int elem;
+    int Has2 = FALSE;
+    int Has3 = FALSE;
 
-    if (size > 8)
-    {
-        sprintf(buf, "%04d", FMsgType);
+    if (!FPtr[0])
+        SetNumber(0, FMsgType);
 
-        remsize = size - 4;
-        ptr = buf + 4;
+    for (elem = 66; elem <= ISO8583_MAX_ID && !Has2; elem++)
+        if (FPtr[elem])
+            Has2 = TRUE;
 
-        ptr = EncodeBitmap1(ptr, &remsize);
+    for (elem = 129; elem <= ISO8583_MAX_ID && !Has3; elem++)
+        if (FPtr[elem])
+            Has3 = TRUE;
 
-        for (elem = 2; elem <= 64 && ptr; elem++)
-            if (FIsoArr[elem])
-                ptr = FIsoArr[elem]->Encode(ptr, &remsize);
+    remsize = size;
 
-        return size - remsize;
+    ptr = EncodeField(0, buf, &remsize);
 
-    }
-    return 0;
-}
+    if (ptr)
+        ptr = EncodeBitmap(1, Has2, ptr, &remsize);
 
-/*##########################################################################
-#
-#   Name       : TIso8583Element::DncodeBitmap1
-#
-#   Purpose....: Decode primary bitmap
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-char *TIso8583::DecodeBitmap1(char *buf, int *remsize)
-{
-    int i, j;
-    int elem;
-    char mask;
-    char *ptr = buf;
-    char ch;
+    if (ptr && Has2)
+        ptr = EncodeBitmap(65, Has3, ptr, &remsize);
 
-    for (i = 0; i <= 192; i++)
-        FUsedArr[i] = FALSE;
+    if (ptr && Has3)
+        ptr = EncodeBitmap(129, FALSE, ptr, &remsize);
 
-    if (*remsize >= 8)
-    {
-        for (i = 0; i < 8; i++)
-        {
-            elem = 8 * i + 1;
-            mask = 0x80;
-            ch = ptr[i];
-
-            for (j = 0; j < 8; j++)
-            {
-                if (ch & mask)
-                    FUsedArr[elem] = TRUE;
-
-                mask = mask >> 1;
-                elem++;
-            }
-        }
-        *remsize -= 8;
-        ptr += 8;
-    }
+    for (elem = 2; elem <= ISO8583_MAX_ID && ptr; elem++)
+        if (FPtr[elem])
+            ptr = EncodeField(elem, ptr, &remsize);
+
+    if (ptr)
+        return size - remsize;
     else
         return 0;
-
-    if (FUsedArr[1] && *remsize >= 8)
-    {
-        FUsedArr[1] = FALSE;
-
-        for (i = 0; i < 8; i++)
-        {
-            elem = 64 + 8 * i + 1;
-            mask = 0x80;
-            ch = ptr[i];
-
-            for (j = 0; j < 8; j++)
-            {
-                if (ch & mask)
-                    FUsedArr[elem] = TRUE;
-
-                mask = mask >> 1;
-                elem++;
-            }
-        }
-        *remsize -= 8;
-        ptr += 8;
-    }
-
-    return ptr;
 }
 
+
 /*##########################################################################
 #
 #   Name       : TIso8583::Decode
 #
-#   Purpose....: Decode message
+#   Purpose....: Decode message in place. Fields refer to buf, which must
+#                be kept until next Decode or Reset
 #
 #   In params..: *
 #   Out params.: *
-#   Returns....: *
+#   Returns....: decoded size or 0 on error
 #
 ##########################################################################*/
 int TIso8583::Decode(char *buf, int size)
 {
     int remsize;
     char *ptr;
-    char str[10];
-    TIso8583Element *e;
+    int elem;
+    char used[ISO8583_MAX_ID + 1];
 
-    if (size > 8)
-    {
-        memcpy(str, buf, 4);
-        str[4] = 0;
-        FMsgType = atoi(str);
+    Reset();
+    memset(used, 0, sizeof(used));
 
-        remsize = size - 4;
-        ptr = buf + 4;
+    remsize = size;
 
-        ptr = DecodeBitmap1(ptr, &remsize);
+    ptr = DecodeField(0, buf, &remsize);
+    if (ptr)
+        FMsgType = GetInt(0);
 
-        while (ptr)
-        {
-            e = AddElem();
-            if (e)
-                ptr = e->Decode(ptr, &remsize);
-            else
-                ptr = 0;
-        }
+    if (ptr)
+        ptr = DecodeBitmap(1, used, ptr, &remsize);
 
-        return size - remsize;
+    if (ptr && used[1])
+        ptr = DecodeBitmap(65, used, ptr, &remsize);
 
-    }
-    return 0;
+    if (ptr && used[65])
+        ptr = DecodeBitmap(129, used, ptr, &remsize);
+
+    for (elem = 2; elem <= ISO8583_MAX_ID && ptr; elem++)
+        if (used[elem] && !IsBitmap(elem))
+            ptr = DecodeField(elem, ptr, &remsize);
+
+    if (ptr)
+        return size - remsize;
+    else
+        return 0;
 }
+
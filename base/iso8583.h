@@ -29,11 +29,33 @@
 #
 ########################################################################*/
 
+
 #ifndef _ISO8583_H
 #define _ISO8583_H
 
 #include "datetime.h"
 
+#define ISO8583_MAX_ID      192
+#define ISO8583_BUF_SIZE    2048
+
+#define ISO8583_NONE        0
+#define ISO8583_FIXED       1
+#define ISO8583_LLVAR       2
+#define ISO8583_LLLVAR      3
+#define ISO8583_LLLLVAR     4
+
+#define ISO8583_ASCII       0
+#define ISO8583_BCD         1
+#define ISO8583_BINARY      2
+
+struct TIso8583Field
+{
+    int Type;
+    int Encoding;
+    int LenEncoding;
+    int Length;
+};
+
 class TIso8583Element
 {
 public:
@@ -69,17 +91,17 @@ protected:
     int FSizeDigits;
 };
 
-class TIso8583Bitmap
+class TIso8583Message
 {
 public:
-    TIso8583Bitmap(int *DigitTable);
-    virtual ~TIso8583Bitmap();
+    TIso8583Message(const TIso8583Field *Fields, int MaxId);
+    virtual ~TIso8583Message();
 
-    void AddInt(int Id, int val);
-    void AddLong(int Id, long long val);
-    void AddString(int Id, const char *str);
-    void AddTime(int Id, TDateTime &time);
-    void AddBinary(int Id, const char *data, int size);
+    int AddInt(int Id, int val);
+    int AddLong(int Id, long long val);
+    int AddString(int Id, const char *str);
+    int AddTime(int Id, TDateTime &time);
+    int AddBinary(int Id, const char *data, int size);
 
     int IsValid(int Id);
     int GetInt(int Id);
@@ -88,70 +110,72 @@ public:
     TDateTime GetTime(int Id);
     int GetBinarySize(int Id);
     const char *GetBinaryData(int Id);
+    const char *GetData(int Id, int *len);
 
     void Reset();
-    int Encode(char *buf, int size);
-    int Decode(char *buf, int size);
 
 protected:
-    void Init();
-    TIso8583Element *GetElem(int Id);
-    TIso8583Element *AddElem(int Id);
-    TIso8583Element *AddElem();
-    char *EncodeBitmap(char *buf, int *RemSize);
+    virtual int IsBitmap(int Id);
+
+    const TIso8583Field *GetField(int Id);
+    char *Alloc(int size);
+    char *AllocSlot(char **Slot, int *SlotSize, int size);
+    int GetDigits(int Id, char *str, int size);
+    int SetText(int Id, const char *str, int len, char fill, int right);
+    int SetNumber(int Id, long long val);
+
+    char *EncodeField(int Id, char *buf, int *RemSize);
+    char *DecodeField(int Id, char *buf, int *RemSize);
+    char *EncodeBitmap(int First, int Ext, char *buf, int *RemSize);
+    char *DecodeBitmap(int First, char *Used, char *buf, int *RemSize);
+
+    const TIso8583Field *FFields;
+    int FMaxId;
+
+    const char *FPtr[ISO8583_MAX_ID + 1];
+    int FLen[ISO8583_MAX_ID + 1];
+    char *FStr[ISO8583_MAX_ID + 1];
+
+    char *FSlot[ISO8583_MAX_ID + 1];
+    int FSlotSize[ISO8583_MAX_ID + 1];
+    char *FStrSlot[ISO8583_MAX_ID + 1];
+    int FStrSlotSize[ISO8583_MAX_ID + 1];
+
+    char FBuf[ISO8583_BUF_SIZE];
+    int FBufUsed;
+};
 
-    char *DecodeBitmap(char *buf, int *RemSize);
+class TIso8583Bitmap : public TIso8583Message
+{
+public:
+    TIso8583Bitmap(int *DigitTable);
+    TIso8583Bitmap(const TIso8583Field *Fields);
+    virtual ~TIso8583Bitmap();
 
-    int *FDigitTable;
-    TIso8583Element *FIsoArr[64];
+    int Encode(char *buf, int size);
+    int Decode(char *buf, int size);
 
-private:
-    int FUsedArr[64];
+protected:
+    TIso8583Field FDigitFields[64];
 };
 
-
-class TIso8583
+class TIso8583 : public TIso8583Message
 {
 public:
     TIso8583();
+    TIso8583(const TIso8583Field *Fields);
     virtual ~TIso8583();
 
     void Create(int MsgType);
-    
-    void AddInt(int Id, int val);
-    void AddLong(int Id, long long val);
-    void AddString(int Id, const char *str);
-    void AddTime(int Id, TDateTime &time);
-    void AddBinary(int Id, const char *data, int size);
-
-    int IsValid(int Id);
-    int GetInt(int Id);
-    long long GetLong(int Id);
-    const char *GetString(int Id);
-    TDateTime GetTime(int Id);
-    int GetBinarySize(int Id);
-    const char *GetBinaryData(int Id);
+    int GetMsgType();
 
-    void Reset();
     int Encode(char *buf, int size);
     int Decode(char *buf, int size);
 
 protected:
-    void Init();
-    TIso8583Element *GetElem(int Id);
-    TIso8583Element *AddElem(int Id);
-    TIso8583Element *AddElem();
-    char *EncodeBitmap1(char *buf, int *RemSize);
-
-    char *DecodeBitmap1(char *buf, int *RemSize);
+    virtual int IsBitmap(int Id);
 
-    int *FDigitTable;
     int FMsgType;
-    TIso8583Element *FIsoArr[193];
-
-private:
-    int FUsedArr[193];
 };
 
-
 #endif
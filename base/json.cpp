@@ -37,6 +37,7 @@
 #include <math.h>
 
 #include "json.h"
+#include "mapfile.h"
 #include "sockobj.h"
 #include "rdos.h"
 
@@ -1269,6 +1270,22 @@ void TJsonObject::Write(TJsonDocument *doc, int indent, TString &str)
     str += EscStr;
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonObject::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonObject::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    return w->AddNode(JSON_NODE_STRING, FFieldName, FText, 0, 0, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonArrayObject::TJsonArrayObject
@@ -1694,6 +1711,42 @@ void TJsonBooleanArray::Write(TJsonDocument *doc, int indent, TString &str)
     str += "]";
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonBooleanArray::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonBooleanArray::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int i;
+    int data = 0;
+    char *arr;
+
+    if (FArrayCount)
+    {
+        arr = new char[FArrayCount];
+
+        for (i = 0; i < FArrayCount; i++)
+        {
+            if (FArr[i])
+                arr[i] = 1;
+            else
+                arr[i] = 0;
+        }
+
+        data = w->Add(arr, FArrayCount);
+        delete arr;
+    }
+
+    return w->AddNode(JSON_NODE_BOOLEAN_ARRAY, FFieldName, 0, FArrayCount, data, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonIntArray::TJsonIntArray
@@ -1959,6 +2012,27 @@ void TJsonIntArray::Write(TJsonDocument *doc, int indent, TString &str)
     str += "]";
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonIntArray::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonIntArray::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int data = 0;
+
+    if (FArrayCount)
+        data = w->Add(FArr, FArrayCount * sizeof(long long));
+
+    return w->AddNode(JSON_NODE_INT_ARRAY, FFieldName, 0, FArrayCount, data, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonDoubleArray::TJsonDoubleArray
@@ -2280,6 +2354,37 @@ void TJsonDoubleArray::Write(TJsonDocument *doc, int indent, TString &str)
     str += "]";
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonDoubleArray::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonDoubleArray::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int i;
+    int data = 0;
+    double *arr;
+
+    if (FArrayCount)
+    {
+        arr = new double[FArrayCount];
+
+        for (i = 0; i < FArrayCount; i++)
+            arr[i] = (double)FArr[i];
+
+        data = w->Add(arr, FArrayCount * sizeof(double));
+        delete arr;
+    }
+
+    return w->AddNode(JSON_NODE_DOUBLE_ARRAY, FFieldName, 0, FArrayCount, data, FDecimals);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonStringArray::TJsonStringArray
@@ -2564,6 +2669,37 @@ void TJsonStringArray::Write(TJsonDocument *doc, int indent, TString &str)
     str += "]";
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonStringArray::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonStringArray::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int i;
+    int data = 0;
+    int *arr;
+
+    if (FArrayCount)
+    {
+        arr = new int[FArrayCount];
+
+        for (i = 0; i < FArrayCount; i++)
+            arr[i] = w->AddString(FArr[i]);
+
+        data = w->Add(arr, FArrayCount * sizeof(int));
+        delete arr;
+    }
+
+    return w->AddNode(JSON_NODE_STRING_ARRAY, FFieldName, 0, FArrayCount, data, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonCollectionData::TJsonCollectionData
@@ -3602,6 +3738,40 @@ void TJsonSingleCollection::Write(TJsonDocument *doc, int indent, TString &str)
     str += "}";
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonSingleCollection::WriteSnapshot
+#
+#   Purpose....: Write collection to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSingleCollection::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int i;
+    int size;
+    int data = 0;
+    int *arr;
+
+    size = FData.FObjArrayCount;
+
+    if (size)
+    {
+        arr = new int[size];
+
+        for (i = 0; i < size; i++)
+            arr[i] = FData.FObjArr[i]->WriteSnapshot(w);
+
+        data = w->Add(arr, size * sizeof(int));
+        delete arr;
+    }
+
+    return w->AddNode(JSON_NODE_COLLECTION, FFieldName, 0, size, data, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonSingleCollection::GetArrayCount
@@ -4041,6 +4211,56 @@ void TJsonArrayCollection::Write(TJsonDocument *doc, int indent, TString &str)
     str += "]";
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonArrayCollection::WriteSnapshot
+#
+#   Purpose....: Write collection to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonArrayCollection::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int a;
+    int i;
+    int size;
+    int data = 0;
+    int *list;
+    int *arr;
+
+    if (FArrayCount)
+    {
+        list = new int[2 * FArrayCount];
+
+        for (a = 0; a < FArrayCount; a++)
+        {
+            size = FArray[a]->FObjArrayCount;
+
+            list[2 * a] = size;
+            list[2 * a + 1] = 0;
+
+            if (size)
+            {
+                arr = new int[size];
+
+                for (i = 0; i < size; i++)
+                    arr[i] = FArray[a]->FObjArr[i]->WriteSnapshot(w);
+
+                list[2 * a + 1] = w->Add(arr, size * sizeof(int));
+                delete arr;
+            }
+        }
+
+        data = w->Add(list, 2 * FArrayCount * sizeof(int));
+        delete list;
+    }
+
+    return w->AddNode(JSON_NODE_ARRAY_COLLECTION, FFieldName, 0, FArrayCount, data, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonArrayCollection::SelectArray
@@ -4284,6 +4504,24 @@ TJsonInt *TJsonInt::Clone(TJsonAlloc *Alloc)
     return (TJsonInt *)CloneObj(Alloc);
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonInt::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonInt::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int data = w->Add(&Val, sizeof(long long));
+
+    return w->AddNode(JSON_NODE_INT, FFieldName, FText, 0, data, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonInt::SetValue
@@ -4575,6 +4813,25 @@ TJsonDouble *TJsonDouble::Clone(TJsonAlloc *Alloc)
     return (TJsonDouble *)CloneObj(Alloc);
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonDouble::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonDouble::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    double v = (double)Val;
+    int data = w->Add(&v, sizeof(double));
+
+    return w->AddNode(JSON_NODE_DOUBLE, FFieldName, FText, 0, data, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonDouble::SetValue
@@ -4859,6 +5116,29 @@ TJsonBoolean *TJsonBoolean::Clone(TJsonAlloc *Alloc)
     return (TJsonBoolean *)CloneObj(Alloc);
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonBoolean::WriteSnapshot
+#
+#   Purpose....: Write object to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonBoolean::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int count;
+
+    if (Val)
+        count = 1;
+    else
+        count = 0;
+
+    return w->AddNode(JSON_NODE_BOOLEAN, FFieldName, FText, count, 0, 0);
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonBoolean::SetValue
@@ -7071,6 +7351,1650 @@ void TJsonDocument::AddIndent(int indent, TString &str)
             str += "  ";
 }
 
+/*##########################################################################
+#
+#   Name       : TJsonDocument::WriteSnapshot
+#
+#   Purpose....: Write document to snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TJsonDocument::WriteSnapshot(TJsonSnapshotWriter *w)
+{
+    int root = 0;
+
+    if (FRootCollection)
+        root = FRootCollection->WriteSnapshot(w);
+
+    w->SetRoot(root);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonDocument::SaveSnapshot
+#
+#   Purpose....: Save document as snapshot file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonDocument::SaveSnapshot(const char *FileName)
+{
+    TJsonSnapshotWriter w;
+
+    WriteSnapshot(&w);
+
+    if (TMappedFile::Create(FileName, w.GetData(), w.GetSize()))
+        return true;
+    else
+        return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonDocument::ImportSnapshot
+#
+#   Purpose....: Build document from snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonDocument::ImportSnapshot(TJsonSnapshot *snap)
+{
+    TJsonSnapshotHeader header;
+    TJsonSnapshotNode root;
+
+    Reset();
+
+    if (!snap->IsValid())
+        return false;
+
+    memcpy(&header, snap->GetData(), sizeof(header));
+    if (header.Root == 0)
+        return true;
+
+    root = snap->GetRoot();
+    if (!root.IsCollection())
+        return false;
+
+    FRootCollection = (TJsonCollection *)root.Materialize(&FAlloc);
+
+    if (FRootCollection)
+        return true;
+    else
+        return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonDocument::LoadSnapshot
+#
+#   Purpose....: Load document from snapshot file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonDocument::LoadSnapshot(const char *FileName)
+{
+    TJsonSnapshot snap(FileName);
+
+    return ImportSnapshot(&snap);
+}
+
+/*##########################################################################
+#
+#   Name       : SnapshotHash
+#
+#   Purpose....: Hash string for snapshot string table
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static unsigned int SnapshotHash(const char *str, int len)
+{
+    unsigned int h = 2166136261U;
+    int i;
+
+    for (i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)str[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::TJsonSnapshotWriter
+#
+#   Purpose....: Constructor for snapshot writer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotWriter::TJsonSnapshotWriter()
+{
+    TJsonSnapshotHeader header;
+
+    FData = 0;
+    FSize = 0;
+    FAllocSize = 0;
+
+    FStrArr = 0;
+    FStrSize = 0;
+    FStrCount = 0;
+
+    memset(&header, 0, sizeof(header));
+    Add(&header, sizeof(header));
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::~TJsonSnapshotWriter
+#
+#   Purpose....: Destructor for snapshot writer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotWriter::~TJsonSnapshotWriter()
+{
+    if (FData)
+        delete FData;
+
+    if (FStrArr)
+        delete FStrArr;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::Take
+#
+#   Purpose....: Reserve zero-filled, 4-byte aligned space
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+char *TJsonSnapshotWriter::Take(int Size, int *Offset)
+{
+    int AlignedSize = (Size + 3) & ~3;
+    int NewSize;
+    char *NewData;
+
+    if (FSize + AlignedSize > FAllocSize)
+    {
+        NewSize = 2 * FAllocSize;
+        if (NewSize < 0x1000)
+            NewSize = 0x1000;
+
+        while (NewSize < FSize + AlignedSize)
+            NewSize = 2 * NewSize;
+
+        NewData = new char[NewSize];
+
+        if (FData)
+        {
+            memcpy(NewData, FData, FSize);
+            delete FData;
+        }
+
+        FData = NewData;
+        FAllocSize = NewSize;
+    }
+
+    *Offset = FSize;
+    memset(FData + FSize, 0, AlignedSize);
+    FSize += AlignedSize;
+
+    return FData + *Offset;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::Add
+#
+#   Purpose....: Add data, returns offset
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotWriter::Add(const void *Data, int Size)
+{
+    int Offset;
+    char *ptr = Take(Size, &Offset);
+
+    if (Size)
+        memcpy(ptr, Data, Size);
+
+    return Offset;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::GrowStrings
+#
+#   Purpose....: Grow string hash table
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TJsonSnapshotWriter::GrowStrings()
+{
+    int i;
+    int n;
+    int len;
+    int NewSize;
+    int *NewArr;
+
+    if (FStrSize)
+        NewSize = 2 * FStrSize;
+    else
+        NewSize = 256;
+
+    NewArr = new int[NewSize];
+
+    for (i = 0; i < NewSize; i++)
+        NewArr[i] = 0;
+
+    for (i = 0; i < FStrSize; i++)
+    {
+        if (FStrArr[i])
+        {
+            memcpy(&len, FData + FStrArr[i] - 4, 4);
+            n = SnapshotHash(FData + FStrArr[i], len) & (NewSize - 1);
+
+            while (NewArr[n])
+                n = (n + 1) & (NewSize - 1);
+
+            NewArr[n] = FStrArr[i];
+        }
+    }
+
+    if (FStrArr)
+        delete FStrArr;
+
+    FStrArr = NewArr;
+    FStrSize = NewSize;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::AddString
+#
+#   Purpose....: Add string once, returns offset of characters
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotWriter::AddString(const char *Str)
+{
+    int i;
+    int len;
+    int StrLen;
+    int Offset;
+    char *ptr;
+
+    if (!Str)
+        return 0;
+
+    len = strlen(Str);
+
+    if (2 * (FStrCount + 1) > FStrSize)
+        GrowStrings();
+
+    i = SnapshotHash(Str, len) & (FStrSize - 1);
+
+    while (FStrArr[i])
+    {
+        memcpy(&StrLen, FData + FStrArr[i] - 4, 4);
+        if (StrLen == len && !memcmp(FData + FStrArr[i], Str, len))
+            return FStrArr[i];
+
+        i = (i + 1) & (FStrSize - 1);
+    }
+
+    ptr = Take(len + 5, &Offset);
+    memcpy(ptr, &len, 4);
+    memcpy(ptr + 4, Str, len);
+
+    FStrArr[i] = Offset + 4;
+    FStrCount++;
+
+    return Offset + 4;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::AddNode
+#
+#   Purpose....: Add node, returns offset
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotWriter::AddNode(int Type, const char *FieldName, const char *Text, int Count, int Data, int Decimals)
+{
+    TJsonSnapshotEntry entry;
+
+    entry.Type = Type;
+    entry.Decimals = Decimals;
+    entry.Name = AddString(FieldName);
+    entry.Text = AddString(Text);
+    entry.Count = Count;
+    entry.Data = Data;
+
+    return Add(&entry, sizeof(entry));
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::SetRoot
+#
+#   Purpose....: Set root node and complete header
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TJsonSnapshotWriter::SetRoot(int Root)
+{
+    TJsonSnapshotHeader header;
+
+    header.Magic = JSON_SNAPSHOT_MAGIC;
+    header.Version = JSON_SNAPSHOT_VERSION;
+    header.Size = FSize;
+    header.Root = Root;
+
+    memcpy(FData, &header, sizeof(header));
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::GetData
+#
+#   Purpose....: Get snapshot data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *TJsonSnapshotWriter::GetData()
+{
+    return FData;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotWriter::GetSize
+#
+#   Purpose....: Get snapshot size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotWriter::GetSize()
+{
+    return FSize;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::TJsonSnapshotNode
+#
+#   Purpose....: Constructor for invalid node
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotNode::TJsonSnapshotNode()
+{
+    FData = 0;
+    FSize = 0;
+    FOffset = 0;
+    FCurrInd = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::TJsonSnapshotNode
+#
+#   Purpose....: Constructor for node at offset
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotNode::TJsonSnapshotNode(const char *Data, int Size, int Offset)
+{
+    FData = Data;
+    FSize = Size;
+    FOffset = Offset;
+    FCurrInd = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::Entry
+#
+#   Purpose....: Get bounds checked node record
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const TJsonSnapshotEntry *TJsonSnapshotNode::Entry()
+{
+    if (!FData || FOffset < (int)sizeof(TJsonSnapshotHeader) || (FOffset & 3))
+        return 0;
+
+    if (FOffset > FSize - (int)sizeof(TJsonSnapshotEntry))
+        return 0;
+
+    return (const TJsonSnapshotEntry *)(FData + FOffset);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::String
+#
+#   Purpose....: Get bounds checked string
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *TJsonSnapshotNode::String(int Offset)
+{
+    int len;
+
+    if (!FData || Offset < (int)sizeof(TJsonSnapshotHeader) + 4 || (Offset & 3) || Offset >= FSize)
+        return 0;
+
+    memcpy(&len, FData + Offset - 4, 4);
+
+    if (len < 0 || len >= FSize - Offset || FData[Offset + len])
+        return 0;
+
+    return FData + Offset;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::List
+#
+#   Purpose....: Get bounds checked list
+#
+#   In params..: Offset      List offset
+#                Count       Number of entries
+#                Size        Entry size
+#                Limit       Offset of record that refers to the list
+#   Out params.: *
+#   Returns....: List or 0
+#
+##########################################################################*/
+const void *TJsonSnapshotNode::List(int Offset, int Count, int Size, int Limit)
+{
+    // lists are written before the records that refer to them
+    if (Count <= 0 || Offset < (int)sizeof(TJsonSnapshotHeader) || (Offset & 3) || Offset > Limit)
+        return 0;
+
+    if (Count > (Limit - Offset) / Size)
+        return 0;
+
+    return FData + Offset;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::IsValid
+#
+#   Purpose....: Check if node is valid
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshotNode::IsValid()
+{
+    if (Entry())
+        return true;
+    else
+        return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetType
+#
+#   Purpose....: Get node type
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotNode::GetType()
+{
+    const TJsonSnapshotEntry *e = Entry();
+
+    if (e)
+        return e->Type;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::IsCollection
+#
+#   Purpose....: Is collection?
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshotNode::IsCollection()
+{
+    int type = GetType();
+
+    if (type == JSON_NODE_COLLECTION || type == JSON_NODE_ARRAY_COLLECTION)
+        return true;
+    else
+        return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::IsArray
+#
+#   Purpose....: Is array collection?
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshotNode::IsArray()
+{
+    if (GetType() == JSON_NODE_ARRAY_COLLECTION)
+        return true;
+    else
+        return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::IsArrayObject
+#
+#   Purpose....: Is array object?
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshotNode::IsArrayObject()
+{
+    int type = GetType();
+
+    if (type >= JSON_NODE_BOOLEAN_ARRAY && type <= JSON_NODE_STRING_ARRAY)
+        return true;
+    else
+        return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetFieldName
+#
+#   Purpose....: Get field name
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *TJsonSnapshotNode::GetFieldName()
+{
+    const TJsonSnapshotEntry *e = Entry();
+    const char *str = 0;
+
+    if (e)
+        str = String(e->Name);
+
+    if (str)
+        return str;
+    else
+        return "";
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetText
+#
+#   Purpose....: Get text
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *TJsonSnapshotNode::GetText()
+{
+    const TJsonSnapshotEntry *e = Entry();
+    const char *str = 0;
+
+    if (e)
+        str = String(e->Text);
+
+    if (str)
+        return str;
+    else
+        return "";
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetBoolean
+#
+#   Purpose....: Get boolean
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshotNode::GetBoolean()
+{
+    const TJsonSnapshotEntry *e = Entry();
+    const char *text;
+
+    if (!e)
+        return false;
+
+    switch (e->Type)
+    {
+        case JSON_NODE_BOOLEAN:
+            return e->Count != 0;
+
+        case JSON_NODE_INT:
+            return GetInt() != 0;
+
+        case JSON_NODE_DOUBLE:
+            return GetDouble() > 0;
+    }
+
+    text = GetText();
+
+    if (!strcmp(text, "true"))
+        return true;
+
+    if (!strcmp(text, "false") || text[0] == 0 || !strcmp(text, "0"))
+        return false;
+    else
+        return true;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetInt
+#
+#   Purpose....: Get int
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TJsonSnapshotNode::GetInt()
+{
+    const TJsonSnapshotEntry *e = Entry();
+    long long val;
+    long double v;
+    char *end;
+
+    if (!e)
+        return 0;
+
+    switch (e->Type)
+    {
+        case JSON_NODE_INT:
+            if (!List(e->Data, 1, sizeof(long long), FOffset))
+                return 0;
+
+            memcpy(&val, FData + e->Data, sizeof(long long));
+            return val;
+
+        case JSON_NODE_DOUBLE:
+            v = GetDouble();
+            if (v >= 0.0)
+                return (long long)(v + 0.5);
+            else
+                return (long long)(v - 0.5);
+
+        case JSON_NODE_BOOLEAN:
+            if (e->Count)
+                return 1;
+            else
+                return 0;
+    }
+
+    return strtoll(GetText(), &end, 10);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetDouble
+#
+#   Purpose....: Get double
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long double TJsonSnapshotNode::GetDouble()
+{
+    const TJsonSnapshotEntry *e = Entry();
+    double val;
+    char *end;
+
+    if (!e)
+        return 0.0;
+
+    switch (e->Type)
+    {
+        case JSON_NODE_DOUBLE:
+            if (!List(e->Data, 1, sizeof(double), FOffset))
+                return 0.0;
+
+            memcpy(&val, FData + e->Data, sizeof(double));
+            return val;
+
+        case JSON_NODE_INT:
+            return (long double)GetInt();
+
+        case JSON_NODE_BOOLEAN:
+            if (e->Count)
+                return 1.0;
+            else
+                return 0.0;
+    }
+
+    return strtold(GetText(), &end);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::Count
+#
+#   Purpose....: Get number of entries in array object
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotNode::Count()
+{
+    const TJsonSnapshotEntry *e = Entry();
+    int size;
+
+    if (!e)
+        return 0;
+
+    switch (e->Type)
+    {
+        case JSON_NODE_BOOLEAN_ARRAY:
+            size = 1;
+            break;
+
+        case JSON_NODE_INT_ARRAY:
+            size = sizeof(long long);
+            break;
+
+        case JSON_NODE_DOUBLE_ARRAY:
+            size = sizeof(double);
+            break;
+
+        case JSON_NODE_STRING_ARRAY:
+            size = sizeof(int);
+            break;
+
+        default:
+            return 0;
+    }
+
+    if (List(e->Data, e->Count, size, FOffset))
+        return e->Count;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetArrayBoolean
+#
+#   Purpose....: Get boolean array entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshotNode::GetArrayBoolean(int Pos)
+{
+    if (GetType() != JSON_NODE_BOOLEAN_ARRAY || Pos < 0 || Pos >= Count())
+        return false;
+
+    return FData[Entry()->Data + Pos] != 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetArrayInt
+#
+#   Purpose....: Get int array entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TJsonSnapshotNode::GetArrayInt(int Pos)
+{
+    long long val;
+
+    if (GetType() != JSON_NODE_INT_ARRAY || Pos < 0 || Pos >= Count())
+        return 0;
+
+    memcpy(&val, FData + Entry()->Data + Pos * sizeof(long long), sizeof(long long));
+    return val;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetArrayDouble
+#
+#   Purpose....: Get double array entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long double TJsonSnapshotNode::GetArrayDouble(int Pos)
+{
+    double val;
+
+    if (GetType() != JSON_NODE_DOUBLE_ARRAY || Pos < 0 || Pos >= Count())
+        return 0.0;
+
+    memcpy(&val, FData + Entry()->Data + Pos * sizeof(double), sizeof(double));
+    return val;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetArrayText
+#
+#   Purpose....: Get string array entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *TJsonSnapshotNode::GetArrayText(int Pos)
+{
+    int offset;
+    const char *str;
+
+    if (GetType() != JSON_NODE_STRING_ARRAY || Pos < 0 || Pos >= Count())
+        return "";
+
+    memcpy(&offset, FData + Entry()->Data + Pos * sizeof(int), sizeof(int));
+    str = String(offset);
+
+    if (str)
+        return str;
+    else
+        return "";
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::ObjList
+#
+#   Purpose....: Get object list of selected array
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const int *TJsonSnapshotNode::ObjList(int *Count)
+{
+    const TJsonSnapshotEntry *e = Entry();
+    const int *list = 0;
+    const int *pair;
+
+    *Count = 0;
+
+    if (!e)
+        return 0;
+
+    if (e->Type == JSON_NODE_COLLECTION)
+    {
+        list = (const int *)List(e->Data, e->Count, sizeof(int), FOffset);
+        if (list)
+            *Count = e->Count;
+    }
+
+    if (e->Type == JSON_NODE_ARRAY_COLLECTION)
+    {
+        pair = (const int *)List(e->Data, e->Count, 2 * sizeof(int), FOffset);
+
+        if (pair && FCurrInd < e->Count)
+        {
+            pair += 2 * FCurrInd;
+            list = (const int *)List(pair[1], pair[0], sizeof(int), e->Data);
+            if (list)
+                *Count = pair[0];
+        }
+    }
+
+    return list;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetArrayCount
+#
+#   Purpose....: Get number of arrays
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotNode::GetArrayCount()
+{
+    const TJsonSnapshotEntry *e = Entry();
+
+    if (!e)
+        return 0;
+
+    if (e->Type == JSON_NODE_COLLECTION)
+        return 1;
+
+    if (e->Type == JSON_NODE_ARRAY_COLLECTION)
+        if (List(e->Data, e->Count, 2 * sizeof(int), FOffset))
+            return e->Count;
+
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::SelectArray
+#
+#   Purpose....: Select array
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TJsonSnapshotNode::SelectArray(int n)
+{
+    if (n >= 0 && n < GetArrayCount())
+        FCurrInd = n;
+    else
+        FCurrInd = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetObjCount
+#
+#   Purpose....: Get number of objects
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshotNode::GetObjCount()
+{
+    int count;
+
+    ObjList(&count);
+    return count;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetObj
+#
+#   Purpose....: Get object by position
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotNode TJsonSnapshotNode::GetObj(int n)
+{
+    int count;
+    int offset;
+    const int *list = ObjList(&count);
+
+    if (list && n >= 0 && n < count)
+    {
+        // nodes are written before the list that refers to them
+        offset = list[n];
+        if (offset <= (const char *)list - FData - (int)sizeof(TJsonSnapshotEntry))
+            return TJsonSnapshotNode(FData, FSize, offset);
+    }
+
+    return TJsonSnapshotNode();
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetObj
+#
+#   Purpose....: Get object by name
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotNode TJsonSnapshotNode::GetObj(const char *FieldName)
+{
+    int n;
+    int count = GetObjCount();
+    TJsonSnapshotNode obj;
+
+    for (n = 0; n < count; n++)
+    {
+        obj = GetObj(n);
+        if (obj.IsValid() && !obj.IsCollection())
+            if (!strcmp(obj.GetFieldName(), FieldName))
+                return obj;
+    }
+
+    return TJsonSnapshotNode();
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetCollection
+#
+#   Purpose....: Get collection by name
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotNode TJsonSnapshotNode::GetCollection(const char *FieldName)
+{
+    int n;
+    int count = GetObjCount();
+    TJsonSnapshotNode obj;
+
+    for (n = 0; n < count; n++)
+    {
+        obj = GetObj(n);
+        if (obj.IsCollection())
+            if (!strcmp(obj.GetFieldName(), FieldName))
+                return obj;
+    }
+
+    return TJsonSnapshotNode();
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetBoolean
+#
+#   Purpose....: Get boolean
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshotNode::GetBoolean(const char *FieldName, bool Default)
+{
+    TJsonSnapshotNode obj = GetObj(FieldName);
+
+    if (obj.IsValid())
+        return obj.GetBoolean();
+    else
+        return Default;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetInt
+#
+#   Purpose....: Get int
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TJsonSnapshotNode::GetInt(const char *FieldName, long long Default)
+{
+    TJsonSnapshotNode obj = GetObj(FieldName);
+
+    if (obj.IsValid())
+        return obj.GetInt();
+    else
+        return Default;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetDouble
+#
+#   Purpose....: Get double
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long double TJsonSnapshotNode::GetDouble(const char *FieldName, long double Default)
+{
+    TJsonSnapshotNode obj = GetObj(FieldName);
+
+    if (obj.IsValid())
+        return obj.GetDouble();
+    else
+        return Default;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::GetText
+#
+#   Purpose....: Get text
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *TJsonSnapshotNode::GetText(const char *FieldName, const char *Default)
+{
+    TJsonSnapshotNode obj = GetObj(FieldName);
+
+    if (obj.IsValid())
+        return obj.GetText();
+    else
+        return Default;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::Materialize
+#
+#   Purpose....: Build object tree from node
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonObject *TJsonSnapshotNode::Materialize(TJsonAlloc *Alloc)
+{
+    return Materialize(Alloc, 0);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshotNode::Materialize
+#
+#   Purpose....: Build object tree from node
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonObject *TJsonSnapshotNode::Materialize(TJsonAlloc *Alloc, int Depth)
+{
+    const TJsonSnapshotEntry *e = Entry();
+    const char *name;
+    int a;
+    int i;
+    int size;
+    int count;
+    int CurrInd;
+    TJsonObject *obj = 0;
+    TJsonObject *child;
+    TJsonBooleanArray *BoolArr;
+    TJsonIntArray *IntArr;
+    TJsonDoubleArray *DoubleArr;
+    TJsonStringArray *StrArr;
+    TJsonSingleCollection *sc;
+    TJsonArrayCollection *ac;
+
+    if (!e || Depth >= MAX_JSON_DEPTH)
+        return 0;
+
+    name = GetFieldName();
+
+    switch (e->Type)
+    {
+        case JSON_NODE_STRING:
+            obj = new(Alloc) TJsonString(name, Alloc, GetText());
+            break;
+
+        case JSON_NODE_INT:
+            obj = new(Alloc) TJsonInt(name, Alloc, GetInt());
+            break;
+
+        case JSON_NODE_DOUBLE:
+            obj = new(Alloc) TJsonDouble(name, Alloc, GetDouble(), GetText());
+            break;
+
+        case JSON_NODE_BOOLEAN:
+            obj = new(Alloc) TJsonBoolean(name, Alloc, GetBoolean());
+            break;
+
+        case JSON_NODE_BOOLEAN_ARRAY:
+            BoolArr = new(Alloc) TJsonBooleanArray(name, Alloc);
+            size = Count();
+            for (i = 0; i < size; i++)
+                BoolArr->Add(GetArrayBoolean(i));
+            obj = BoolArr;
+            break;
+
+        case JSON_NODE_INT_ARRAY:
+            IntArr = new(Alloc) TJsonIntArray(name, Alloc);
+            size = Count();
+            for (i = 0; i < size; i++)
+                IntArr->Add(GetArrayInt(i));
+            obj = IntArr;
+            break;
+
+        case JSON_NODE_DOUBLE_ARRAY:
+            DoubleArr = new(Alloc) TJsonDoubleArray(name, Alloc, e->Decimals);
+            size = Count();
+            for (i = 0; i < size; i++)
+                DoubleArr->Add(GetArrayDouble(i));
+            obj = DoubleArr;
+            break;
+
+        case JSON_NODE_STRING_ARRAY:
+            StrArr = new(Alloc) TJsonStringArray(name, Alloc);
+            size = Count();
+            for (i = 0; i < size; i++)
+                StrArr->Add(GetArrayText(i));
+            obj = StrArr;
+            break;
+
+        case JSON_NODE_COLLECTION:
+            sc = new(Alloc) TJsonSingleCollection(name, Alloc);
+            size = GetObjCount();
+            for (i = 0; i < size; i++)
+            {
+                child = GetObj(i).Materialize(Alloc, Depth + 1);
+                if (child)
+                {
+                    sc->Insert(child);
+                    if (child->IsCollection())
+                        ((TJsonCollection *)child)->FParent = sc;
+                }
+            }
+            obj = sc;
+            break;
+
+        case JSON_NODE_ARRAY_COLLECTION:
+            ac = new(Alloc) TJsonArrayCollection(name, Alloc);
+            CurrInd = FCurrInd;
+            count = GetArrayCount();
+            for (a = 0; a < count; a++)
+            {
+                SelectArray(a);
+                ac->DoAdd();
+                size = GetObjCount();
+                for (i = 0; i < size; i++)
+                {
+                    child = GetObj(i).Materialize(Alloc, Depth + 1);
+                    if (child)
+                    {
+                        ac->Insert(child);
+                        if (child->IsCollection())
+                            ((TJsonCollection *)child)->FParent = ac;
+                    }
+                }
+            }
+            FCurrInd = CurrInd;
+            obj = ac;
+            break;
+    }
+
+    return obj;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::TJsonSnapshot
+#
+#   Purpose....: Constructor for empty snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshot::TJsonSnapshot()
+{
+    FMap = 0;
+    FData = 0;
+    FSize = 0;
+    FDoc = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::TJsonSnapshot
+#
+#   Purpose....: Constructor for snapshot file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshot::TJsonSnapshot(const char *FileName)
+{
+    FMap = 0;
+    FData = 0;
+    FSize = 0;
+    FDoc = 0;
+
+    Open(FileName);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::TJsonSnapshot
+#
+#   Purpose....: Constructor for snapshot in memory
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshot::TJsonSnapshot(const char *Data, int Size)
+{
+    FMap = 0;
+    FData = 0;
+    FSize = 0;
+    FDoc = 0;
+
+    Attach(Data, Size);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::~TJsonSnapshot
+#
+#   Purpose....: Destructor for snapshot
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshot::~TJsonSnapshot()
+{
+    Close();
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::Open
+#
+#   Purpose....: Map snapshot file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshot::Open(const char *FileName)
+{
+    TMappedFile *map = new TMappedFile(FileName);
+
+    if (map->IsOpen() && Attach(map->GetData(), map->GetSize()))
+    {
+        FMap = map;
+        return true;
+    }
+
+    delete map;
+    return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::Attach
+#
+#   Purpose....: Use snapshot in memory. Data must stay valid while in use
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshot::Attach(const char *Data, int Size)
+{
+    TJsonSnapshotHeader header;
+
+    Close();
+
+    if (!Data || Size < (int)sizeof(header))
+        return false;
+
+    memcpy(&header, Data, sizeof(header));
+
+    if (header.Magic != JSON_SNAPSHOT_MAGIC || header.Version != JSON_SNAPSHOT_VERSION)
+        return false;
+
+    if (header.Size < (int)sizeof(header) || header.Size > Size)
+        return false;
+
+    FData = Data;
+    FSize = header.Size;
+    return true;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::Close
+#
+#   Purpose....: Close snapshot and materialized document
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TJsonSnapshot::Close()
+{
+    if (FDoc)
+        delete FDoc;
+
+    if (FMap)
+        delete FMap;
+
+    FDoc = 0;
+    FMap = 0;
+    FData = 0;
+    FSize = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::IsValid
+#
+#   Purpose....: Check if snapshot is valid
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshot::IsValid()
+{
+    if (FData)
+        return true;
+    else
+        return false;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::GetData
+#
+#   Purpose....: Get snapshot data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *TJsonSnapshot::GetData()
+{
+    return FData;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::GetSize
+#
+#   Purpose....: Get snapshot size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TJsonSnapshot::GetSize()
+{
+    return FSize;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::GetRoot
+#
+#   Purpose....: Get root node
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonSnapshotNode TJsonSnapshot::GetRoot()
+{
+    TJsonSnapshotHeader header;
+
+    if (!FData)
+        return TJsonSnapshotNode();
+
+    memcpy(&header, FData, sizeof(header));
+    return TJsonSnapshotNode(FData, FSize, header.Root);
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::GetDocument
+#
+#   Purpose....: Get document for modification. It is built on first use
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TJsonDocument *TJsonSnapshot::GetDocument()
+{
+    if (!FDoc && FData)
+    {
+        FDoc = new TJsonDocument;
+        FDoc->ImportSnapshot(this);
+    }
+
+    return FDoc;
+}
+
+/*##########################################################################
+#
+#   Name       : TJsonSnapshot::IsMaterialized
+#
+#   Purpose....: Check if document is built
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+bool TJsonSnapshot::IsMaterialized()
+{
+    if (FDoc)
+        return true;
+    else
+        return false;
+}
+
 /*##########################################################################
 #
 #   Name       : TJsonHttpClient::TJsonHttpClient
@@ -38,7 +38,50 @@
 
 #define MAX_JSON_DEPTH  100
 
+// Snapshot format, a relocatable binary form of a document that is used in place.
+// All offsets are from the start of the snapshot and all records are 4-byte aligned.
+// Strings are stored once as length, characters and a terminating zero.
+// The string offset is to the characters. Offset 0 is no string.
+// Nodes are written after their contents, so every offset in a node is lower than the node.
+// Int and double values are 8 bytes at Data. Doubles are stored as double.
+// Collections have Count node offsets at Data.
+// Array collections have Count pairs of object count and node offset list at Data.
+
+#define JSON_SNAPSHOT_MAGIC         0x504E534A
+#define JSON_SNAPSHOT_VERSION       1
+
+#define JSON_NODE_STRING            1
+#define JSON_NODE_INT               2
+#define JSON_NODE_DOUBLE            3
+#define JSON_NODE_BOOLEAN           4
+#define JSON_NODE_BOOLEAN_ARRAY     5
+#define JSON_NODE_INT_ARRAY         6
+#define JSON_NODE_DOUBLE_ARRAY      7
+#define JSON_NODE_STRING_ARRAY      8
+#define JSON_NODE_COLLECTION        9
+#define JSON_NODE_ARRAY_COLLECTION  10
+
+struct TJsonSnapshotHeader
+{
+    int Magic;
+    int Version;
+    int Size;
+    int Root;
+};
+
+struct TJsonSnapshotEntry
+{
+    int Type;
+    int Decimals;
+    int Name;
+    int Text;
+    int Count;
+    int Data;
+};
+
 class TJsonDocument;
+class TJsonSnapshotWriter;
+class TMappedFile;
 
 class TJsonMem
 {
@@ -118,6 +161,7 @@ public:
     void SetString(const char *Str);
 
     virtual void Write(TJsonDocument *doc, int indent, TString &str);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     virtual TJsonObject *CloneObj(TJsonAlloc *Alloc) = 0;
@@ -190,6 +234,7 @@ public:
     void Add(bool val);
     TJsonBooleanArray *Clone(TJsonAlloc *Alloc);
     virtual void Write(TJsonDocument *doc, int indent, TString &str);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     virtual TJsonObject *CloneObj(TJsonAlloc *Alloc);
@@ -213,6 +258,7 @@ public:
     void Add(long long val);
     TJsonIntArray *Clone(TJsonAlloc *Alloc);
     virtual void Write(TJsonDocument *doc, int indent, TString &str);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     virtual TJsonObject *CloneObj(TJsonAlloc *Alloc);
@@ -237,6 +283,7 @@ public:
     void AddNone();
     TJsonDoubleArray *Clone(TJsonAlloc *Alloc);
     virtual void Write(TJsonDocument *doc, int indent, TString &str);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     virtual TJsonObject *CloneObj(TJsonAlloc *Alloc);
@@ -262,6 +309,7 @@ public:
     void Add(const char *str);
     TJsonStringArray *Clone(TJsonAlloc *Alloc);
     virtual void Write(TJsonDocument *doc, int indent, TString &str);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     virtual TJsonObject *CloneObj(TJsonAlloc *Alloc);
@@ -369,6 +417,7 @@ public:
     virtual int GetObjCount();
     virtual TJsonObject *GetObj(int n);
     virtual void Write(TJsonDocument *doc, int indent, TString &str);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
     virtual TJsonObject *GetObj(const char *FieldName);
     virtual TJsonCollection *GetCollection(const char *FieldName);
@@ -381,6 +430,8 @@ protected:
 
 class TJsonArrayCollection : public TJsonCollection
 {
+friend class TJsonSnapshotNode;
+
 public:
     TJsonArrayCollection(const char *FieldName, TJsonAlloc *Alloc);
     TJsonArrayCollection(const TJsonArrayCollection &src, TJsonAlloc *Alloc);
@@ -396,6 +447,7 @@ public:
     virtual int GetObjCount();
     virtual TJsonObject *GetObj(int n);
     virtual void Write(TJsonDocument *doc, int indent, TString &str);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
     virtual TJsonObject *GetObj(const char *FieldName);
     virtual TJsonCollection *GetCollection(const char *FieldName);
@@ -428,6 +480,7 @@ public:
     virtual ~TJsonDouble();
 
     TJsonDouble *Clone(TJsonAlloc *Alloc);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     void SetValue(long double v, int decimals);
@@ -456,6 +509,7 @@ public:
     virtual ~TJsonBoolean();
 
     TJsonBoolean *Clone(TJsonAlloc *Alloc);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     void SetValue(bool val);
@@ -484,6 +538,7 @@ public:
     virtual ~TJsonInt();
 
     TJsonInt *Clone(TJsonAlloc *Alloc);
+    virtual int WriteSnapshot(TJsonSnapshotWriter *w);
 
 protected:
     void SetValue(long long val);
@@ -530,6 +585,7 @@ protected:
 };
 
 class TJsonDocument;
+class TJsonSnapshot;
 
 class TJsonStackEntry
 {
@@ -603,6 +659,11 @@ public:
     TJsonCollection *CreateRoot();
     TJsonAlloc *GetAlloc();
 
+    void WriteSnapshot(TJsonSnapshotWriter *w);
+    bool SaveSnapshot(const char *FileName);
+    bool LoadSnapshot(const char *FileName);
+    bool ImportSnapshot(TJsonSnapshot *snap);
+
 protected:
     void AddIndent(int indent, TString &str);
     void NewLine(TString &str);
@@ -641,6 +702,115 @@ private:
     TJsonAlloc FAlloc;
 };
 
+class TJsonSnapshotWriter
+{
+public:
+    TJsonSnapshotWriter();
+    ~TJsonSnapshotWriter();
+
+    int Add(const void *Data, int Size);
+    int AddString(const char *Str);
+    int AddNode(int Type, const char *FieldName, const char *Text, int Count, int Data, int Decimals);
+    void SetRoot(int Root);
+
+    const char *GetData();
+    int GetSize();
+
+protected:
+    char *Take(int Size, int *Offset);
+    void GrowStrings();
+
+    char *FData;
+    int FSize;
+    int FAllocSize;
+
+    int *FStrArr;
+    int FStrSize;
+    int FStrCount;
+};
+
+class TJsonSnapshotNode
+{
+public:
+    TJsonSnapshotNode();
+    TJsonSnapshotNode(const char *Data, int Size, int Offset);
+
+    bool IsValid();
+    int GetType();
+    bool IsCollection();
+    bool IsArray();
+    bool IsArrayObject();
+
+    const char *GetFieldName();
+    const char *GetText();
+    bool GetBoolean();
+    long long GetInt();
+    long double GetDouble();
+
+    int Count();
+    bool GetArrayBoolean(int Pos);
+    long long GetArrayInt(int Pos);
+    long double GetArrayDouble(int Pos);
+    const char *GetArrayText(int Pos);
+
+    int GetArrayCount();
+    void SelectArray(int n);
+    int GetObjCount();
+    TJsonSnapshotNode GetObj(int n);
+    TJsonSnapshotNode GetObj(const char *FieldName);
+    TJsonSnapshotNode GetCollection(const char *FieldName);
+
+    bool GetBoolean(const char *FieldName, bool Default);
+    long long GetInt(const char *FieldName, long long Default);
+    long double GetDouble(const char *FieldName, long double Default);
+    const char *GetText(const char *FieldName, const char *Default);
+
+    TJsonObject *Materialize(TJsonAlloc *Alloc);
+
+protected:
+    const TJsonSnapshotEntry *Entry();
+    const char *String(int Offset);
+    const void *List(int Offset, int Count, int Size, int Limit);
+    const int *ObjList(int *Count);
+    TJsonObject *Materialize(TJsonAlloc *Alloc, int Depth);
+
+    const char *FData;
+    int FSize;
+    int FOffset;
+    int FCurrInd;
+};
+
+class TJsonSnapshot
+{
+public:
+    TJsonSnapshot();
+    TJsonSnapshot(const char *FileName);
+    TJsonSnapshot(const char *Data, int Size);
+    ~TJsonSnapshot();
+
+    bool Open(const char *FileName);
+    bool Attach(const char *Data, int Size);
+    void Close();
+    bool IsValid();
+
+    const char *GetData();
+    int GetSize();
+
+    TJsonSnapshotNode GetRoot();
+    TJsonDocument *GetDocument();
+    bool IsMaterialized();
+
+protected:
+    TMappedFile *FMap;
+    const char *FData;
+    int FSize;
+    TJsonDocument *FDoc;
+
+private:
+    TJsonSnapshot(const TJsonSnapshot &src);
+    const TJsonSnapshot &operator=(const TJsonSnapshot &src);
+};
+
 class TJsonHttpClient
 {
 public:
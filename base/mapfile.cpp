@@ -0,0 +1,226 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# mapfile.cpp
+# Read-only mapped file class
+#
+########################################################################*/
+
+#include <string.h>
+#include "mapfile.h"
+
+#ifdef __RDOS__
+#include "file.h"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : TMappedFile::TMappedFile
+#
+#   Purpose....: Constructor for TMappedFile
+#
+#   In params..: Filename to map
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TMappedFile::TMappedFile(const char *FileName)
+{
+    FData = 0;
+    FSize = 0;
+
+#ifdef __RDOS__
+    TFile file(FileName);
+    long long size;
+
+    if (file.IsOpen())
+    {
+        size = file.GetSize();
+        if (size > 0 && size < 0x7FFFFFFF)
+        {
+            FData = new char[(int)size];
+            if (file.Read(FData, (int)size) == (int)size)
+                FSize = (int)size;
+            else
+            {
+                delete[] FData;
+                FData = 0;
+            }
+        }
+    }
+#else
+    int handle;
+    struct stat st;
+    void *ptr;
+
+    handle = open(FileName, O_RDONLY);
+    if (handle >= 0)
+    {
+        if (fstat(handle, &st) == 0 && st.st_size > 0 && st.st_size < 0x7FFFFFFF)
+        {
+            ptr = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+            if (ptr != MAP_FAILED)
+            {
+                FData = (char *)ptr;
+                FSize = (int)st.st_size;
+            }
+        }
+        close(handle);
+    }
+#endif
+}
+
+/*##########################################################################
+#
+#   Name       : TMappedFile::~TMappedFile
+#
+#   Purpose....: Destructor for TMappedFile
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TMappedFile::~TMappedFile()
+{
+    if (FData)
+    {
+#ifdef __RDOS__
+        delete[] FData;
+#else
+        munmap(FData, FSize);
+#endif
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TMappedFile::IsOpen
+#
+#   Purpose....: Check if file is mapped
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: TRUE if mapped
+#
+##########################################################################*/
+int TMappedFile::IsOpen()
+{
+    if (FData)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TMappedFile::GetData
+#
+#   Purpose....: Get file contents
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Start of file data
+#
+##########################################################################*/
+const char *TMappedFile::GetData()
+{
+    return FData;
+}
+
+/*##########################################################################
+#
+#   Name       : TMappedFile::GetSize
+#
+#   Purpose....: Get file size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Size of file data
+#
+##########################################################################*/
+int TMappedFile::GetSize()
+{
+    return FSize;
+}
+
+/*##########################################################################
+#
+#   Name       : TMappedFile::Create
+#
+#   Purpose....: Create or replace a file with data
+#
+#   In params..: Filename, data, size
+#   Out params.: *
+#   Returns....: TRUE if all data was written
+#
+##########################################################################*/
+int TMappedFile::Create(const char *FileName, const void *Data, int Size)
+{
+#ifdef __RDOS__
+    TFile file(FileName, 0);
+
+    if (!file.IsOpen())
+        return FALSE;
+
+    file.SetSize(0);
+    if (file.Write(Data, Size) == Size)
+        return TRUE;
+    else
+        return FALSE;
+#else
+    int handle;
+    int count;
+    int done = 0;
+    const char *ptr = (const char *)Data;
+
+    handle = open(FileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (handle < 0)
+        return FALSE;
+
+    while (done < Size)
+    {
+        count = (int)write(handle, ptr + done, Size - done);
+        if (count <= 0)
+            break;
+        done += count;
+    }
+    close(handle);
+
+    if (done == Size)
+        return TRUE;
+    else
+        return FALSE;
+#endif
+}
@@ -0,0 +1,56 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# mapfile.h
+# Read-only mapped file class
+#
+########################################################################*/
+
+#ifndef _MAPFILE_H
+#define _MAPFILE_H
+
+// Read-only view of a whole file in one contiguous block
+// On POSIX the file is mmapped, so pages are only read when they are touched.
+// On RDOS the VFS file map is not contiguous, so the file is read into one buffer.
+
+class TMappedFile
+{
+public:
+    TMappedFile(const char *FileName);
+    ~TMappedFile();
+
+    int IsOpen();
+    const char *GetData();
+    int GetSize();
+
+    static int Create(const char *FileName, const void *Data, int Size);
+
+protected:
+    char *FData;
+    int FSize;
+};
+
+#endif
@@ -72,8 +72,13 @@
 #define DEVICE_DATA_BYTEARRAY       20
 #define DEVICE_DATA_SHORTSTRING     128
 
+#define DEVICE_VIEW_MAX_DEPTH       32
+
 #if !defined(MSVC) && defined(__RDOS__)
 int CrcHandle = RdosCreateCrc(0x8005);
+#else
+static unsigned short int CrcTable[256];
+static int CrcTableDone = FALSE;
 #endif
 
 /*##################  TDeviceAlloc:TDeviceAlloc  ###############
@@ -244,6 +249,7 @@ void TDeviceVar::Init(const char *data, int size, int *count)
     int overhead;
         int terminate;
 
+    FType = DEVICE_DATA_NONE;
     FSize = 0;
     FData = 0;
     FStr = 0;
@@ -318,7 +324,12 @@ void TDeviceVar::Init(const char *data, int size, int *count)
             break;
 
         default:
-            return;
+            if ((unsigned char)FType < DEVICE_DATA_SHORTSTRING)
+                return;
+
+            FSize = (unsigned char)FType - DEVICE_DATA_SHORTSTRING;
+            terminate = TRUE;
+            break;
     }
 
         if (FSize <= size)
@@ -1789,6 +1800,16 @@ const char *TDeviceVar::GetString()
             strcpy(FStr, tempstr);
             return FStr;
 
+        default:
+            if ((unsigned char)FType >= DEVICE_DATA_SHORTSTRING)
+            {
+                FStr = Allocate(FSize + 1);
+                if (FSize)
+                    memcpy(FStr, FData, FSize);
+                *(FStr + FSize) = 0;
+                return FStr;
+            }
+            break;
     }
     return 0;
 }
@@ -1990,6 +2011,7 @@ TDeviceTag::TDeviceTag(unsigned short int ID)
         FAlloc = 0;
         FID = ID;
         FHead = 0;
+        FTail = 0;
         FCurrVar = 0;
         FCurrTag = 0;
 }
@@ -2006,6 +2028,7 @@ TDeviceTag::TDeviceTag(TDeviceAlloc *alloc, unsigned short int ID)
         FAlloc = alloc;
         FID = ID;
         FHead = 0;
+        FTail = 0;
         FCurrVar = 0;
         FCurrTag = 0;
 }
@@ -2051,6 +2074,7 @@ void TDeviceTag::Init(const char *data, int size, int *count)
         int ElemSize = 1;
 
         FHead = 0;
+        FTail = 0;
         FCurrVar = 0;
         FCurrTag = 0;
         *count = 0;
@@ -2218,21 +2242,14 @@ int TDeviceTag::IsEmptyTag()
 *##########################################################################*/
 void TDeviceTag::Add(TDeviceData *data)
 {
-    TDeviceData *elem;
-
     if (data)
     {
-        if (FHead)
-        {
-            elem = FHead;
-            while (elem->FNext)
-                elem = elem->FNext;
-                        elem->FNext = data;
-        
-        }
+        if (FTail)
+            FTail->FNext = data;
         else
-                    FHead = data;
+            FHead = data;
 
+        FTail = data;
         data->FNext = 0;
     }
 }
@@ -4674,6 +4691,7 @@ TDeviceMsg::TDeviceMsg()
 {
     FDeleteOnSend = FALSE;
     FHead = 0;
+    FTail = 0;
     FCurrTag = 0;
     FAlloc = 0;
 }
@@ -4689,6 +4707,7 @@ TDeviceMsg::TDeviceMsg(int MaxSize)
 {
     FDeleteOnSend = FALSE;
     FHead = 0;
+    FTail = 0;
     FCurrTag = 0;
     FAlloc = new TDeviceAlloc(MaxSize);
 }
@@ -4746,6 +4765,7 @@ void TDeviceMsg::Free()
 
     FCurrTag = 0;
     FHead = 0;
+    FTail = 0;
 }
 
 /*##################  TDeviceMsg::Add  ###############
@@ -4757,21 +4777,14 @@ void TDeviceMsg::Free()
 *##########################################################################*/
 void TDeviceMsg::Add(TDeviceTag *data)
 {
-        TDeviceData *elem;
-
     if (data)
     {
-        if (FHead)
-        {
-            elem = FHead;
-            while (elem->FNext)
-                elem = elem->FNext;
-            elem->FNext = data;
-        
-        }
+        if (FTail)
+            FTail->FNext = data;
         else
-                    FHead = data;
+            FHead = data;
 
+        FTail = data;
         data->FNext = 0;
     }
 }
@@ -4861,7 +4874,7 @@ int TDeviceMsg::GetSize()
 *   Returns....: *                                                          #
 *   Created....: 96-11-20 le                                                #
 *##########################################################################*/
-unsigned short int TDeviceMsg::Crc(const char *Data, int Size) const
+unsigned short int TDeviceMsg::Crc(const char *Data, int Size)
 {
 #if !defined(MSVC) && defined(__RDOS__)
         return RdosCalcCrc(CrcHandle, 0, Data, Size);
@@ -4869,21 +4882,29 @@ unsigned short int TDeviceMsg::Crc(const char *Data, int Size) const
 
         unsigned short int Crc = 0;
         int i;
-        unsigned short int Temp1, Temp2;
-        char ch;
+        int j;
 
-        while (Size)
+        if (!CrcTableDone)
         {
-                ch = *Data;
-                for (i = 0; i != 8; i++)
+                for (i = 0; i < 256; i++)
                 {
-                        Temp1 = (ch & 0x80) << 8;
-                        Temp2 = Crc & 0x8000;
-                        Crc = Crc << 1;
-                        if ((Temp1 ^ Temp2) != 0)
-                                Crc = Crc ^ 0x8005;
-                        ch = ch << 1;
+                        Crc = (unsigned short int)(i << 8);
+                        for (j = 0; j != 8; j++)
+                        {
+                                if (Crc & 0x8000)
+                                        Crc = (Crc << 1) ^ 0x8005;
+                                else
+                                        Crc = Crc << 1;
+                        }
+                        CrcTable[i] = Crc;
                 }
+                CrcTableDone = TRUE;
+                Crc = 0;
+        }
+
+        while (Size)
+        {
+                Crc = (Crc << 8) ^ CrcTable[((Crc >> 8) ^ (unsigned char)*Data) & 0xFF];
                 Size--;
                 Data++;
         }
@@ -5024,3 +5045,1932 @@ TDeviceTag *TDeviceMsg::GetTag(unsigned short int ID)
         }
         return 0;
 }
+
+/*##################  TDeviceVarView::TDeviceVarView  ###############
+*   Purpose....: Constructor for var view                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceVarView::TDeviceVarView()
+{
+    FRaw = 0;
+    FRawSize = 0;
+    FData = 0;
+    FSize = 0;
+    FID = 0;
+    FType = DEVICE_DATA_NONE;
+}
+
+/*##################  TDeviceVarView::IsValid  ###############
+*   Purpose....: Check if view refers to a variable                         #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceVarView::IsValid() const
+{
+    if (FRaw)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##################  TDeviceVarView::IsEmptyVar  ###############
+*   Purpose....: Is this an empty var?                                      #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceVarView::IsEmptyVar() const
+{
+    if (FType == DEVICE_DATA_NONE)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##################  TDeviceVarView::GetID  ###############
+*   Purpose....: Get ID                                                     #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceVarView::GetID() const
+{
+    return FID;
+}
+
+/*##################  TDeviceVarView::GetType  ###############
+*   Purpose....: Return type                                                #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+char TDeviceVarView::GetType() const
+{
+    return FType;
+}
+
+/*##################  TDeviceVarView::GetUnsignedInt  ###############
+*   Purpose....: Get unsigned int                                           #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+unsigned int TDeviceVarView::GetUnsignedInt() const
+{
+    return (unsigned int)GetUnsignedLong();
+}
+
+/*##################  TDeviceVarView::GetUnsignedShort  ###############
+*   Purpose....: Get unsigned short, converting like TDeviceVar             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+unsigned short int TDeviceVarView::GetUnsignedShort() const
+{
+    unsigned short int val = 0;
+    int count;
+
+    switch (FType)
+    {
+        case DEVICE_DATA_UNSIGNED8:
+            memcpy(&val, FData, 1);
+            return val;
+
+        case DEVICE_DATA_UNSIGNED16:
+            memcpy(&val, FData, 2);
+            return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetUnsignedShort();
+}
+
+/*##################  TDeviceVarView::GetUnsignedLong  ###############
+*   Purpose....: Get unsigned long, converting like TDeviceVar              #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+unsigned long TDeviceVarView::GetUnsignedLong() const
+{
+    unsigned long val = 0;
+    int count;
+
+    switch (FType)
+    {
+        case DEVICE_DATA_UNSIGNED8:
+            memcpy(&val, FData, 1);
+            return val;
+
+        case DEVICE_DATA_UNSIGNED16:
+            memcpy(&val, FData, 2);
+            return val;
+
+        case DEVICE_DATA_UNSIGNED32:
+            memcpy(&val, FData, 4);
+            return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetUnsignedLong();
+}
+
+/*##################  TDeviceVarView::GetSignedInt  ###############
+*   Purpose....: Get signed int                                             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceVarView::GetSignedInt() const
+{
+    return (int)GetSignedLong();
+}
+
+/*##################  TDeviceVarView::GetSignedShort  ###############
+*   Purpose....: Get signed short, converting like TDeviceVar               #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+short int TDeviceVarView::GetSignedShort() const
+{
+    short int val;
+    char ch;
+    unsigned char uch;
+    int count;
+
+    switch (FType)
+    {
+        case DEVICE_DATA_SIGNED8:
+            memcpy(&ch, FData, 1);
+            return ch;
+
+        case DEVICE_DATA_UNSIGNED8:
+            memcpy(&uch, FData, 1);
+            return uch;
+
+        case DEVICE_DATA_SIGNED16:
+            memcpy(&val, FData, 2);
+            return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetSignedShort();
+}
+
+/*##################  TDeviceVarView::GetSignedLong  ###############
+*   Purpose....: Get signed long, converting like TDeviceVar                #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceVarView::GetSignedLong() const
+{
+    long val = 0;
+    short int sval;
+    unsigned short int usval;
+    char ch;
+    unsigned char uch;
+    int count;
+
+    switch (FType)
+    {
+        case DEVICE_DATA_SIGNED8:
+            memcpy(&ch, FData, 1);
+            return ch;
+
+        case DEVICE_DATA_UNSIGNED8:
+            memcpy(&uch, FData, 1);
+            return uch;
+
+        case DEVICE_DATA_SIGNED16:
+            memcpy(&sval, FData, 2);
+            return sval;
+
+        case DEVICE_DATA_UNSIGNED16:
+            memcpy(&usval, FData, 2);
+            return usval;
+
+        case DEVICE_DATA_SIGNED32:
+            memcpy(&val, FData, 4);
+            return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetSignedLong();
+}
+
+/*##################  TDeviceVarView::GetChar  ###############
+*   Purpose....: Get char, converting like TDeviceVar                       #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+char TDeviceVarView::GetChar() const
+{
+    char val;
+    int count;
+
+    switch (FType)
+    {
+        case DEVICE_DATA_CHAR:
+        case DEVICE_DATA_UNSIGNED8:
+        case DEVICE_DATA_SIGNED8:
+            memcpy(&val, FData, 1);
+            return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetChar();
+}
+
+/*##################  TDeviceVarView::GetFloat1  ###############
+*   Purpose....: Get float with 1 decimal                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceVarView::GetFloat1() const
+{
+    long val = 0;
+    int count;
+
+    if (FType == DEVICE_DATA_FLOAT1)
+    {
+        memcpy(&val, FData, 4);
+        return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetFloat1();
+}
+
+/*##################  TDeviceVarView::GetFloat2  ###############
+*   Purpose....: Get float with 2 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceVarView::GetFloat2() const
+{
+    long val = 0;
+    int count;
+
+    if (FType == DEVICE_DATA_FLOAT2)
+    {
+        memcpy(&val, FData, 4);
+        return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetFloat2();
+}
+
+/*##################  TDeviceVarView::GetFloat3  ###############
+*   Purpose....: Get float with 3 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceVarView::GetFloat3() const
+{
+    long val = 0;
+    int count;
+
+    if (FType == DEVICE_DATA_FLOAT3)
+    {
+        memcpy(&val, FData, 4);
+        return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetFloat3();
+}
+
+/*##################  TDeviceVarView::GetFloat4  ###############
+*   Purpose....: Get float with 4 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceVarView::GetFloat4() const
+{
+    long val = 0;
+    int count;
+
+    if (FType == DEVICE_DATA_FLOAT4)
+    {
+        memcpy(&val, FData, 4);
+        return val;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetFloat4();
+}
+
+/*##################  TDeviceVarView::GetJulian  ###############
+*   Purpose....: Get julian date                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceVarView::GetJulian() const
+{
+    long val = 0;
+
+    if (FType == DEVICE_DATA_JULIANDATE)
+        memcpy(&val, FData, 4);
+
+    return val;
+}
+
+/*##################  TDeviceVarView::GetBinary  ###############
+*   Purpose....: Get raw data, pointing into the parsed buffer              #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+const void *TDeviceVarView::GetBinary(int *size) const
+{
+    *size = FSize;
+    return FData;
+}
+
+/*##################  TDeviceVarView::GetString  ###############
+*   Purpose....: Copy string representation into buffer                     #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceVarView::GetString(char *str, int maxsize) const
+{
+    const char *src;
+    int size;
+    int count;
+
+    if (maxsize <= 0)
+        return FALSE;
+
+    switch (FType)
+    {
+        case DEVICE_DATA_STRING8:
+        case DEVICE_DATA_STRING16:
+            src = FData;
+            size = FSize;
+            break;
+
+        default:
+            if ((unsigned char)FType >= DEVICE_DATA_SHORTSTRING)
+            {
+                src = FData;
+                size = FSize;
+            }
+            else
+            {
+                TDeviceVar var(FRaw, FRawSize, &count);
+
+                src = var.GetString();
+                if (src == 0)
+                {
+                    *str = 0;
+                    return FALSE;
+                }
+
+                size = strlen(src);
+                if (size >= maxsize)
+                    size = maxsize - 1;
+
+                memcpy(str, src, size);
+                *(str + size) = 0;
+                return TRUE;
+            }
+            break;
+    }
+
+    if (size >= maxsize)
+        size = maxsize - 1;
+
+    if (size)
+        memcpy(str, src, size);
+    *(str + size) = 0;
+    return TRUE;
+}
+
+/*##################  TDeviceVarView::GetBoolean  ###############
+*   Purpose....: Get boolean, converting like TDeviceVar                    #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceVarView::GetBoolean() const
+{
+    int count;
+
+    if (FType == DEVICE_DATA_BOOLEAN)
+    {
+        if (*FData)
+            return TRUE;
+        else
+            return FALSE;
+    }
+
+    TDeviceVar var(FRaw, FRawSize, &count);
+    return var.GetBoolean();
+}
+
+/*##################  TDeviceVarView::GetBoolArray  ###############
+*   Purpose....: Get packed bool array                                      #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+const char *TDeviceVarView::GetBoolArray(int *size) const
+{
+    if (FType == DEVICE_DATA_BOOLARRAY)
+    {
+        *size = FSize;
+        return FData;
+    }
+
+    *size = 0;
+    return 0;
+}
+
+/*##################  TDeviceVarView::GetByteArray  ###############
+*   Purpose....: Get byte array                                             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+const void *TDeviceVarView::GetByteArray(int *size) const
+{
+    if (FType == DEVICE_DATA_BYTEARRAY)
+    {
+        *size = FSize;
+        return FData;
+    }
+
+    *size = 0;
+    return 0;
+}
+
+/*##################  TDeviceTagView::TDeviceTagView  ###############
+*   Purpose....: Constructor for tag view                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceTagView::TDeviceTagView()
+{
+    FMsg = 0;
+    FEntry = 0;
+}
+
+/*##################  TDeviceTagView::TDeviceTagView  ###############
+*   Purpose....: Constructor for tag view                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceTagView::TDeviceTagView(const TDeviceMsgView *msg, int entry)
+{
+    FMsg = msg;
+    FEntry = entry;
+}
+
+/*##################  TDeviceTagView::IsValid  ###############
+*   Purpose....: Check if view refers to a tag                              #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::IsValid() const
+{
+    if (FMsg)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##################  TDeviceTagView::IsEmptyTag  ###############
+*   Purpose....: Check if tag is empty                                      #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::IsEmptyTag() const
+{
+    if (FMsg == 0 || FMsg->FEntryArr[FEntry].First < 0)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##################  TDeviceTagView::GetID  ###############
+*   Purpose....: Get ID                                                     #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::GetID() const
+{
+    if (FMsg)
+        return FMsg->FEntryArr[FEntry].ID;
+    else
+        return 0;
+}
+
+/*##################  TDeviceTagView::GetVarCount  ###############
+*   Purpose....: Get number of vars                                         #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::GetVarCount() const
+{
+    if (FMsg)
+        return FMsg->FEntryArr[FEntry].VarCount;
+    else
+        return 0;
+}
+
+/*##################  TDeviceTagView::GetVarAt  ###############
+*   Purpose....: Get var by position in ID order                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceVarView TDeviceTagView::GetVarAt(int n) const
+{
+    const TDeviceViewEntry *e;
+
+    if (FMsg)
+    {
+        e = FMsg->FEntryArr + FEntry;
+        if (n >= 0 && n < e->VarCount)
+            return MakeVar(FMsg->FKeyArr[e->KeyStart + n].Entry);
+    }
+    return TDeviceVarView();
+}
+
+/*##################  TDeviceTagView::GetTagCount  ###############
+*   Purpose....: Get number of tags                                         #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::GetTagCount() const
+{
+    if (FMsg)
+        return FMsg->FEntryArr[FEntry].TagCount;
+    else
+        return 0;
+}
+
+/*##################  TDeviceTagView::GetTagAt  ###############
+*   Purpose....: Get tag by position in ID order                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceTagView TDeviceTagView::GetTagAt(int n) const
+{
+    const TDeviceViewEntry *e;
+
+    if (FMsg)
+    {
+        e = FMsg->FEntryArr + FEntry;
+        if (n >= 0 && n < e->TagCount)
+            return TDeviceTagView(FMsg, FMsg->FKeyArr[e->KeyStart + e->VarCount + n].Entry);
+    }
+    return TDeviceTagView();
+}
+
+/*##################  TDeviceTagView::Find  ###############
+*   Purpose....: Binary search for first key with ID                        #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::Find(int start, int count, unsigned short int ID) const
+{
+    const TDeviceViewKey *key = FMsg->FKeyArr;
+    int low = start;
+    int high = start + count;
+    int mid;
+
+    while (low < high)
+    {
+        mid = (low + high) / 2;
+        if (key[mid].ID < ID)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low < start + count && key[low].ID == ID)
+        return key[low].Entry;
+    else
+        return -1;
+}
+
+/*##################  TDeviceTagView::MakeVar  ###############
+*   Purpose....: Create var view from entry                                 #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceVarView TDeviceTagView::MakeVar(int entry) const
+{
+    TDeviceVarView var;
+    const TDeviceViewEntry *e = FMsg->FEntryArr + entry;
+
+    var.FRaw = e->Raw;
+    var.FRawSize = e->RawSize;
+    var.FData = e->Data;
+    var.FSize = e->Size;
+    var.FID = e->ID;
+    var.FType = e->Type;
+    return var;
+}
+
+/*##################  TDeviceTagView::GetTag  ###############
+*   Purpose....: Get tag by number                                          #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceTagView TDeviceTagView::GetTag(unsigned short int ID) const
+{
+    const TDeviceViewEntry *e;
+    int entry;
+
+    if (FMsg)
+    {
+        e = FMsg->FEntryArr + FEntry;
+        entry = Find(e->KeyStart + e->VarCount, e->TagCount, ID);
+        if (entry >= 0)
+            return TDeviceTagView(FMsg, entry);
+    }
+    return TDeviceTagView();
+}
+
+/*##################  TDeviceTagView::GetVar  ###############
+*   Purpose....: Get var by number                                          #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceVarView TDeviceTagView::GetVar(unsigned short int ID) const
+{
+    const TDeviceViewEntry *e;
+    int entry;
+
+    if (FMsg)
+    {
+        e = FMsg->FEntryArr + FEntry;
+        entry = Find(e->KeyStart, e->VarCount, ID);
+        if (entry >= 0)
+            return MakeVar(entry);
+    }
+    return TDeviceVarView();
+}
+
+/*##################  TDeviceTagView::HasEmptyVar  ###############
+*   Purpose....: Check if empty var exists                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::HasEmptyVar(unsigned short int ID) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid() && var.IsEmptyVar())
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##################  TDeviceTagView::HasEmptyTag  ###############
+*   Purpose....: Check if empty tag exists                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::HasEmptyTag(unsigned short int ID) const
+{
+    TDeviceTagView tag = GetTag(ID);
+
+    if (tag.IsValid() && tag.IsEmptyTag())
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##################  TDeviceTagView::GetUnsignedShort  ###############
+*   Purpose....: Get unsigned short                                         #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+unsigned short int TDeviceTagView::GetUnsignedShort(unsigned short int ID, unsigned short int Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetUnsignedShort();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetUnsignedLong  ###############
+*   Purpose....: Get unsigned long                                          #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+unsigned long TDeviceTagView::GetUnsignedLong(unsigned short int ID, unsigned long Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetUnsignedLong();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetUnsignedInt  ###############
+*   Purpose....: Get unsigned int                                           #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+unsigned int TDeviceTagView::GetUnsignedInt(unsigned short int ID, unsigned int Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetUnsignedInt();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetSignedShort  ###############
+*   Purpose....: Get signed short                                           #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+short int TDeviceTagView::GetSignedShort(unsigned short int ID, short int Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetSignedShort();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetSignedLong  ###############
+*   Purpose....: Get signed long                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceTagView::GetSignedLong(unsigned short int ID, long Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetSignedLong();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetSignedInt  ###############
+*   Purpose....: Get signed int                                             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::GetSignedInt(unsigned short int ID, int Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetSignedInt();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetChar  ###############
+*   Purpose....: Get char                                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+char TDeviceTagView::GetChar(unsigned short int ID, char Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetChar();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetFloat1  ###############
+*   Purpose....: Get float with 1 decimal                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceTagView::GetFloat1(unsigned short int ID, long Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetFloat1();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetFloat2  ###############
+*   Purpose....: Get float with 2 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceTagView::GetFloat2(unsigned short int ID, long Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetFloat2();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetFloat3  ###############
+*   Purpose....: Get float with 3 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceTagView::GetFloat3(unsigned short int ID, long Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetFloat3();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetFloat4  ###############
+*   Purpose....: Get float with 4 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceTagView::GetFloat4(unsigned short int ID, long Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetFloat4();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetJulian  ###############
+*   Purpose....: Get julian date                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+long TDeviceTagView::GetJulian(unsigned short int ID, long Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetJulian();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetBinary  ###############
+*   Purpose....: Get binary data                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+const void *TDeviceTagView::GetBinary(unsigned short int ID, int *size) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    return var.GetBinary(size);
+}
+
+/*##################  TDeviceTagView::GetString  ###############
+*   Purpose....: Copy string into buffer                                    #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::GetString(unsigned short int ID, char *str, int maxsize) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetString(str, maxsize);
+    else
+        return FALSE;
+}
+
+/*##################  TDeviceTagView::GetBoolean  ###############
+*   Purpose....: Get boolean                                                #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceTagView::GetBoolean(unsigned short int ID, int Default) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    if (var.IsValid())
+        return var.GetBoolean();
+    else
+        return Default;
+}
+
+/*##################  TDeviceTagView::GetBoolArray  ###############
+*   Purpose....: Get packed bool array                                      #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+const char *TDeviceTagView::GetBoolArray(unsigned short int ID, int *size) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    return var.GetBoolArray(size);
+}
+
+/*##################  TDeviceTagView::GetByteArray  ###############
+*   Purpose....: Get byte array                                             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+const void *TDeviceTagView::GetByteArray(unsigned short int ID, int *size) const
+{
+    TDeviceVarView var = GetVar(ID);
+
+    return var.GetByteArray(size);
+}
+
+/*##################  TDeviceMsgView::TDeviceMsgView  ###############
+*   Purpose....: Constructor for msg view                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceMsgView::TDeviceMsgView()
+{
+    FEntryArr = 0;
+    FEntryCount = 0;
+    FEntrySize = 0;
+    FKeyArr = 0;
+    FKeySize = 0;
+}
+
+/*##################  TDeviceMsgView::~TDeviceMsgView  ###############
+*   Purpose....: Destructor for msg view                                    #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceMsgView::~TDeviceMsgView()
+{
+    if (FEntryArr)
+        delete[] FEntryArr;
+
+    if (FKeyArr)
+        delete[] FKeyArr;
+}
+
+/*##################  TDeviceMsgView::AddEntry  ###############
+*   Purpose....: Add entry and link it to parent                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgView::AddEntry(int parent)
+{
+    TDeviceViewEntry *arr;
+    TDeviceViewEntry *e;
+    int entry;
+
+    if (FEntryCount == FEntrySize)
+    {
+        if (FEntrySize)
+            FEntrySize = 2 * FEntrySize;
+        else
+            FEntrySize = 64;
+
+        arr = new TDeviceViewEntry[FEntrySize];
+        if (FEntryCount)
+            memcpy(arr, FEntryArr, FEntryCount * sizeof(TDeviceViewEntry));
+
+        if (FEntryArr)
+            delete[] FEntryArr;
+        FEntryArr = arr;
+    }
+
+    entry = FEntryCount++;
+    e = FEntryArr + entry;
+    e->Raw = 0;
+    e->Data = 0;
+    e->RawSize = 0;
+    e->Size = 0;
+    e->ID = 0;
+    e->IsTag = TRUE;
+    e->Type = DEVICE_DATA_UNKNOWN;
+    e->First = -1;
+    e->Last = -1;
+    e->Next = -1;
+    e->KeyStart = 0;
+    e->VarCount = 0;
+    e->TagCount = 0;
+
+    if (parent >= 0)
+    {
+        e = FEntryArr + parent;
+        if (e->Last >= 0)
+            FEntryArr[e->Last].Next = entry;
+        else
+            e->First = entry;
+        e->Last = entry;
+    }
+    return entry;
+}
+
+/*##################  TDeviceMsgView::ParseVar  ###############
+*   Purpose....: Index a var without copying                                #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgView::ParseVar(int entry, const char *data, int size)
+{
+    TDeviceViewEntry *e;
+    unsigned short int Id;
+    char Type;
+    int len = 0;
+    int overhead = 3;
+
+    if (size < 3)
+        return 0;
+
+    memcpy(&Id, data, 2);
+    if (Id < DEVICE_VARIABLERANGE_LOW || Id > DEVICE_VARIABLERANGE_HIGH)
+        return 0;
+
+    Type = *(data + 2);
+
+    switch (Type)
+    {
+        case DEVICE_DATA_NONE:
+            len = 0;
+            break;
+
+        case DEVICE_DATA_UNSIGNED8:
+        case DEVICE_DATA_SIGNED8:
+        case DEVICE_DATA_CHAR:
+        case DEVICE_DATA_BOOLEAN:
+            len = 1;
+            break;
+
+        case DEVICE_DATA_UNSIGNED16:
+        case DEVICE_DATA_SIGNED16:
+            len = 2;
+            break;
+
+        case DEVICE_DATA_UNSIGNED32:
+        case DEVICE_DATA_SIGNED32:
+        case DEVICE_DATA_FLOAT1:
+        case DEVICE_DATA_FLOAT2:
+        case DEVICE_DATA_FLOAT3:
+        case DEVICE_DATA_FLOAT4:
+        case DEVICE_DATA_JULIANDATE:
+            len = 4;
+            break;
+
+        case DEVICE_DATA_STRING8:
+        case DEVICE_DATA_BINARY8:
+        case DEVICE_DATA_BOOLARRAY:
+        case DEVICE_DATA_BYTEARRAY:
+            if (size < 4)
+                return 0;
+            memcpy(&len, data + 3, 1);
+            overhead++;
+            break;
+
+        case DEVICE_DATA_STRING16:
+        case DEVICE_DATA_BINARY16:
+            if (size < 5)
+                return 0;
+            memcpy(&len, data + 3, 2);
+            overhead += 2;
+            break;
+
+        default:
+            if ((unsigned char)Type < DEVICE_DATA_SHORTSTRING)
+                return 0;
+
+            len = (unsigned char)Type - DEVICE_DATA_SHORTSTRING;
+            break;
+    }
+
+    if (overhead + len > size)
+        return 0;
+
+    e = FEntryArr + entry;
+    e->Raw = data;
+    e->RawSize = overhead + len;
+    e->Data = data + overhead;
+    e->Size = len;
+    e->ID = Id - DEVICE_VARIABLERANGE_LOW;
+    e->IsTag = FALSE;
+    e->Type = Type;
+
+    return overhead + len;
+}
+
+/*##################  TDeviceMsgView::ParseTag  ###############
+*   Purpose....: Index a tag and its elements without copying               #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgView::ParseTag(int entry, const char *data, int size, int depth)
+{
+    TDeviceViewEntry *e;
+    unsigned short int Id;
+    int used;
+    int count;
+    int child;
+
+    if (depth > DEVICE_VIEW_MAX_DEPTH || size < 2)
+        return 0;
+
+    memcpy(&Id, data, 2);
+    if (Id < DEVICE_TAGRANGE_LOW || Id > DEVICE_TAGRANGE_HIGH)
+        return 0;
+
+    e = FEntryArr + entry;
+    e->Raw = data;
+    e->ID = Id - DEVICE_TAGRANGE_LOW;
+
+    used = 2;
+
+    while (used < size)
+    {
+        if (size - used < 2)
+            return 0;
+
+        memcpy(&Id, data + used, 2);
+        if (Id == DEVICE_TAGEND)
+        {
+            used += 2;
+            break;
+        }
+
+        child = AddEntry(entry);
+
+        if (Id >= DEVICE_TAGRANGE_LOW && Id <= DEVICE_TAGRANGE_HIGH)
+            count = ParseTag(child, data + used, size - used, depth + 1);
+        else
+            count = ParseVar(child, data + used, size - used);
+
+        if (count == 0)
+            return 0;
+
+        used += count;
+    }
+
+    e = FEntryArr + entry;
+    e->RawSize = used;
+    e->Data = data + 2;
+    e->Size = used - 2;
+
+    return used;
+}
+
+/*##################  CompareViewKey  ###############
+*   Purpose....: Compare keys by ID and wire order                          #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+static int CompareViewKey(const void *a, const void *b)
+{
+    const TDeviceViewKey *ka = (const TDeviceViewKey *)a;
+    const TDeviceViewKey *kb = (const TDeviceViewKey *)b;
+
+    if (ka->ID != kb->ID)
+        return (int)ka->ID - (int)kb->ID;
+    else
+        return ka->Entry - kb->Entry;
+}
+
+/*##################  TDeviceMsgView::SortKeys  ###############
+*   Purpose....: Sort keys of a tag unless already ordered                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgView::SortKeys(int start, int count)
+{
+    int i;
+
+    for (i = start + 1; i < start + count; i++)
+        if (FKeyArr[i - 1].ID > FKeyArr[i].ID)
+            break;
+
+    if (i < start + count)
+        qsort(FKeyArr + start, count, sizeof(TDeviceViewKey), CompareViewKey);
+}
+
+/*##################  TDeviceMsgView::BuildKeys  ###############
+*   Purpose....: Build sorted ID keys for all tags                          #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgView::BuildKeys()
+{
+    TDeviceViewEntry *e;
+    int pos = 0;
+    int i;
+    int child;
+
+    if (FKeySize < FEntrySize)
+    {
+        if (FKeyArr)
+            delete[] FKeyArr;
+
+        FKeySize = FEntrySize;
+        FKeyArr = new TDeviceViewKey[FKeySize];
+    }
+
+    for (i = 0; i < FEntryCount; i++)
+    {
+        e = FEntryArr + i;
+        if (e->IsTag)
+        {
+            e->KeyStart = pos;
+
+            for (child = e->First; child >= 0; child = FEntryArr[child].Next)
+            {
+                if (!FEntryArr[child].IsTag)
+                {
+                    FKeyArr[pos].ID = FEntryArr[child].ID;
+                    FKeyArr[pos].Entry = child;
+                    pos++;
+                }
+            }
+            e->VarCount = pos - e->KeyStart;
+
+            for (child = e->First; child >= 0; child = FEntryArr[child].Next)
+            {
+                if (FEntryArr[child].IsTag)
+                {
+                    FKeyArr[pos].ID = FEntryArr[child].ID;
+                    FKeyArr[pos].Entry = child;
+                    pos++;
+                }
+            }
+            e->TagCount = pos - e->KeyStart - e->VarCount;
+
+            SortKeys(e->KeyStart, e->VarCount);
+            SortKeys(e->KeyStart + e->VarCount, e->TagCount);
+        }
+    }
+}
+
+/*##################  TDeviceMsgView::Parse  ###############
+*   Purpose....: Parse data into an index, data must outlive the view       #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgView::Parse(long signature, const char *data, int size)
+{
+    unsigned short int CrcVal;
+    unsigned short int Id;
+    int MsgSize = 0;
+    int count;
+    int entry;
+    long sign = 0;
+
+    FEntryCount = 0;
+
+    if (size < 8)
+        return FALSE;
+
+    memcpy(&sign, data, 4);
+    if (sign != signature)
+        return FALSE;
+
+    memcpy(&MsgSize, data + 4, 2);
+
+    if (MsgSize < size - 8)
+        size = MsgSize + 8;
+    else
+        if (MsgSize != size - 8)
+            return FALSE;
+
+    memcpy(&CrcVal, data + MsgSize + 6, 2);
+    if (CrcVal != TDeviceMsg::Crc(data + 6, MsgSize))
+        return FALSE;
+
+    entry = AddEntry(-1);
+    FEntryArr[entry].Raw = data;
+    FEntryArr[entry].RawSize = size;
+    FEntryArr[entry].Data = data + 6;
+    FEntryArr[entry].Size = MsgSize;
+
+    data += 6;
+    size -= 8;
+
+    while (size)
+    {
+        count = 0;
+
+        if (size >= 2)
+        {
+            memcpy(&Id, data, 2);
+            if (Id >= DEVICE_TAGRANGE_LOW && Id <= DEVICE_TAGRANGE_HIGH)
+            {
+                entry = AddEntry(0);
+                count = ParseTag(entry, data, size, 1);
+            }
+        }
+
+        if (count == 0)
+        {
+            FEntryCount = 0;
+            return FALSE;
+        }
+
+        data += count;
+        size -= count;
+    }
+
+    BuildKeys();
+    return TRUE;
+}
+
+/*##################  TDeviceMsgView::GetTagCount  ###############
+*   Purpose....: Get number of top-level tags                               #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgView::GetTagCount() const
+{
+    if (FEntryCount)
+        return FEntryArr->TagCount;
+    else
+        return 0;
+}
+
+/*##################  TDeviceMsgView::GetTagAt  ###############
+*   Purpose....: Get top-level tag by position in ID order                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceTagView TDeviceMsgView::GetTagAt(int n) const
+{
+    if (FEntryCount)
+        return TDeviceTagView(this, 0).GetTagAt(n);
+    else
+        return TDeviceTagView();
+}
+
+/*##################  TDeviceMsgView::GetTag  ###############
+*   Purpose....: Get a tag                                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceTagView TDeviceMsgView::GetTag(unsigned short int ID) const
+{
+    if (FEntryCount)
+        return TDeviceTagView(this, 0).GetTag(ID);
+    else
+        return TDeviceTagView();
+}
+
+/*##################  TDeviceMsgWriter::TDeviceMsgWriter  ###############
+*   Purpose....: Constructor for msg writer, Data = 0 only sizes            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+TDeviceMsgWriter::TDeviceMsgWriter(long Signature, char *Data, int MaxSize)
+{
+    FData = Data;
+    FMaxSize = MaxSize;
+    FPos = 6;
+    FLevel = 0;
+    FOverflow = FALSE;
+
+    if (FData)
+    {
+        if (FMaxSize < 8)
+            FOverflow = TRUE;
+        else
+            memcpy(FData, &Signature, 4);
+    }
+}
+
+/*##################  TDeviceMsgWriter::GetSize  ###############
+*   Purpose....: Get size of message, including open tags                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgWriter::GetSize() const
+{
+    return FPos + 2 * FLevel + 2;
+}
+
+/*##################  TDeviceMsgWriter::IsOverflow  ###############
+*   Purpose....: Check if buffer was too small                              #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgWriter::IsOverflow() const
+{
+    return FOverflow;
+}
+
+/*##################  TDeviceMsgWriter::Finish  ###############
+*   Purpose....: Write size and CRC, return message size                    #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+int TDeviceMsgWriter::Finish()
+{
+    unsigned short int CrcVal;
+    int size;
+
+    size = FPos - 6;
+
+    if (FLevel || FOverflow || size > 0xFFFF)
+        return 0;
+
+    if (FData)
+    {
+        memcpy(FData + 4, &size, 2);
+        CrcVal = TDeviceMsg::Crc(FData + 6, size);
+        memcpy(FData + FPos, &CrcVal, 2);
+    }
+    return FPos + 2;
+}
+
+/*##################  TDeviceMsgWriter::Reserve  ###############
+*   Purpose....: Reserve space in buffer                                    #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+char *TDeviceMsgWriter::Reserve(int size)
+{
+    char *ptr = 0;
+
+    if (FData && !FOverflow)
+    {
+        if (FPos + size + 2 > FMaxSize)
+            FOverflow = TRUE;
+        else
+            ptr = FData + FPos;
+    }
+
+    FPos += size;
+    return ptr;
+}
+
+/*##################  TDeviceMsgWriter::AddVar  ###############
+*   Purpose....: Write var header, return data position                     #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+char *TDeviceMsgWriter::AddVar(unsigned short int ID, char Type, int LenSize, int Size)
+{
+    unsigned short int RealId = ID + DEVICE_VARIABLERANGE_LOW;
+    char *ptr;
+
+    ptr = Reserve(3 + LenSize + Size);
+    if (ptr)
+    {
+        memcpy(ptr, &RealId, 2);
+        *(ptr + 2) = Type;
+        ptr += 3;
+
+        if (LenSize)
+        {
+            memcpy(ptr, &Size, LenSize);
+            ptr += LenSize;
+        }
+    }
+    return ptr;
+}
+
+/*##################  TDeviceMsgWriter::AddFixed  ###############
+*   Purpose....: Write fixed size var                                       #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddFixed(unsigned short int ID, char Type, const void *data, int size)
+{
+    char *ptr;
+
+    ptr = AddVar(ID, Type, 0, size);
+    if (ptr)
+        memcpy(ptr, data, size);
+}
+
+/*##################  TDeviceMsgWriter::AddTag  ###############
+*   Purpose....: Start a tag                                                #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddTag(unsigned short int ID)
+{
+    unsigned short int RealId = ID + DEVICE_TAGRANGE_LOW;
+    char *ptr;
+
+    ptr = Reserve(2);
+    if (ptr)
+        memcpy(ptr, &RealId, 2);
+
+    FLevel++;
+}
+
+/*##################  TDeviceMsgWriter::EndTag  ###############
+*   Purpose....: End current tag                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::EndTag()
+{
+    unsigned short int Id = DEVICE_TAGEND;
+    char *ptr;
+
+    if (FLevel)
+    {
+        ptr = Reserve(2);
+        if (ptr)
+            memcpy(ptr, &Id, 2);
+
+        FLevel--;
+    }
+}
+
+/*##################  TDeviceMsgWriter::AddNone  ###############
+*   Purpose....: Add empty var                                              #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddNone(unsigned short int ID)
+{
+    AddVar(ID, DEVICE_DATA_NONE, 0, 0);
+}
+
+/*##################  TDeviceMsgWriter::AddUnsignedShort  ###############
+*   Purpose....: Add unsigned short                                         #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddUnsignedShort(unsigned short int ID, unsigned short int data)
+{
+    unsigned char val;
+
+    if (data >= 255)
+        AddFixed(ID, DEVICE_DATA_UNSIGNED16, &data, 2);
+    else
+    {
+        val = (unsigned char)data;
+        AddFixed(ID, DEVICE_DATA_UNSIGNED8, &val, 1);
+    }
+}
+
+/*##################  TDeviceMsgWriter::AddUnsignedLong  ###############
+*   Purpose....: Add unsigned long                                          #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddUnsignedLong(unsigned short int ID, unsigned long data)
+{
+    unsigned short int sval;
+    unsigned char val;
+
+    if (data > 65535)
+        AddFixed(ID, DEVICE_DATA_UNSIGNED32, &data, 4);
+    else
+    {
+        if (data > 255)
+        {
+            sval = (unsigned short int)data;
+            AddFixed(ID, DEVICE_DATA_UNSIGNED16, &sval, 2);
+        }
+        else
+        {
+            val = (unsigned char)data;
+            AddFixed(ID, DEVICE_DATA_UNSIGNED8, &val, 1);
+        }
+    }
+}
+
+/*##################  TDeviceMsgWriter::AddUnsignedInt  ###############
+*   Purpose....: Add unsigned int                                           #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddUnsignedInt(unsigned short int ID, unsigned int data)
+{
+    AddUnsignedLong(ID, data);
+}
+
+/*##################  TDeviceMsgWriter::AddSignedShort  ###############
+*   Purpose....: Add signed short                                           #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddSignedShort(unsigned short int ID, short int data)
+{
+    char val;
+
+    if (data > 255 || data < -128)
+        AddFixed(ID, DEVICE_DATA_SIGNED16, &data, 2);
+    else
+    {
+        val = (char)data;
+        if (data > 127)
+            AddFixed(ID, DEVICE_DATA_UNSIGNED8, &val, 1);
+        else
+            AddFixed(ID, DEVICE_DATA_SIGNED8, &val, 1);
+    }
+}
+
+/*##################  TDeviceMsgWriter::AddSignedLong  ###############
+*   Purpose....: Add signed long                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddSignedLong(unsigned short int ID, long data)
+{
+    short int sval;
+    char val;
+
+    if (data > 65535 || data < -32768)
+        AddFixed(ID, DEVICE_DATA_SIGNED32, &data, 4);
+    else
+    {
+        if (data > 255 || data < -128)
+        {
+            sval = (short int)data;
+            if (data > 32767)
+                AddFixed(ID, DEVICE_DATA_UNSIGNED16, &sval, 2);
+            else
+                AddFixed(ID, DEVICE_DATA_SIGNED16, &sval, 2);
+        }
+        else
+        {
+            val = (char)data;
+            if (data > 127)
+                AddFixed(ID, DEVICE_DATA_UNSIGNED8, &val, 1);
+            else
+                AddFixed(ID, DEVICE_DATA_SIGNED8, &val, 1);
+        }
+    }
+}
+
+/*##################  TDeviceMsgWriter::AddSignedInt  ###############
+*   Purpose....: Add signed int                                             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddSignedInt(unsigned short int ID, int data)
+{
+    AddSignedLong(ID, data);
+}
+
+/*##################  TDeviceMsgWriter::AddChar  ###############
+*   Purpose....: Add char                                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddChar(unsigned short int ID, char ch)
+{
+    AddFixed(ID, DEVICE_DATA_CHAR, &ch, 1);
+}
+
+/*##################  TDeviceMsgWriter::AddFloat1  ###############
+*   Purpose....: Add float with 1 decimal                                   #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddFloat1(unsigned short int ID, long data)
+{
+    AddFixed(ID, DEVICE_DATA_FLOAT1, &data, 4);
+}
+
+/*##################  TDeviceMsgWriter::AddFloat2  ###############
+*   Purpose....: Add float with 2 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddFloat2(unsigned short int ID, long data)
+{
+    AddFixed(ID, DEVICE_DATA_FLOAT2, &data, 4);
+}
+
+/*##################  TDeviceMsgWriter::AddFloat3  ###############
+*   Purpose....: Add float with 3 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddFloat3(unsigned short int ID, long data)
+{
+    AddFixed(ID, DEVICE_DATA_FLOAT3, &data, 4);
+}
+
+/*##################  TDeviceMsgWriter::AddFloat4  ###############
+*   Purpose....: Add float with 4 decimals                                  #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddFloat4(unsigned short int ID, long data)
+{
+    AddFixed(ID, DEVICE_DATA_FLOAT4, &data, 4);
+}
+
+/*##################  TDeviceMsgWriter::AddJulian  ###############
+*   Purpose....: Add julian date                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddJulian(unsigned short int ID, long data)
+{
+    AddFixed(ID, DEVICE_DATA_JULIANDATE, &data, 4);
+}
+
+/*##################  TDeviceMsgWriter::AddBinary  ###############
+*   Purpose....: Add binary data                                            #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddBinary(unsigned short int ID, int size, const void *data)
+{
+    char *ptr;
+
+    if (size < 0)
+        ptr = AddVar(ID, DEVICE_DATA_NONE, 0, 0);
+    else
+    {
+        if (size < 256)
+            ptr = AddVar(ID, DEVICE_DATA_BINARY8, 1, size);
+        else
+            ptr = AddVar(ID, DEVICE_DATA_BINARY16, 2, size);
+
+        if (ptr && size)
+            memcpy(ptr, data, size);
+    }
+}
+
+/*##################  TDeviceMsgWriter::AddString  ###############
+*   Purpose....: Add string                                                 #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddString(unsigned short int ID, const char *str)
+{
+    int size = strlen(str);
+    char *ptr;
+
+    if (size < 128)
+        ptr = AddVar(ID, (char)(DEVICE_DATA_SHORTSTRING + size), 0, size);
+    else
+    {
+        if (size < 256)
+            ptr = AddVar(ID, DEVICE_DATA_STRING8, 1, size);
+        else
+            ptr = AddVar(ID, DEVICE_DATA_STRING16, 2, size);
+    }
+
+    if (ptr && size)
+        memcpy(ptr, str, size);
+}
+
+/*##################  TDeviceMsgWriter::AddBoolean  ###############
+*   Purpose....: Add boolean                                                #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddBoolean(unsigned short int ID, int data)
+{
+    char val;
+
+    if (data)
+        val = 1;
+    else
+        val = 0;
+
+    AddFixed(ID, DEVICE_DATA_BOOLEAN, &val, 1);
+}
+
+/*##################  TDeviceMsgWriter::AddBoolArray  ###############
+*   Purpose....: Add bool array, packed as bits                             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddBoolArray(unsigned short int ID, int size, const char *data)
+{
+    int len;
+    int i;
+    char *ptr;
+
+    if (size < 0 || size >= 2040)
+    {
+        AddVar(ID, DEVICE_DATA_NONE, 0, 0);
+        return;
+    }
+
+    len = (size + 7) / 8;
+
+    ptr = AddVar(ID, DEVICE_DATA_BOOLARRAY, 1, len);
+    if (ptr)
+    {
+        for (i = 0; i < len; i++)
+            *(ptr + i) = 0;
+
+        for (i = 0; i < size; i++)
+            if (*(data + i))
+                *(ptr + i / 8) |= 1 << (i % 8);
+    }
+}
+
+/*##################  TDeviceMsgWriter::AddByteArray  ###############
+*   Purpose....: Add byte array                                             #
+*   In params..: *                                                          #
+*   Out params.: *                                                          #
+*   Returns....: *                                                          #
+*##########################################################################*/
+void TDeviceMsgWriter::AddByteArray(unsigned short int ID, int size, const void *data)
+{
+    char *ptr;
+
+    if (size < 0 || size >= 256)
+    {
+        AddVar(ID, DEVICE_DATA_NONE, 0, 0);
+        return;
+    }
+
+    ptr = AddVar(ID, DEVICE_DATA_BYTEARRAY, 1, size);
+    if (ptr && size)
+        memcpy(ptr, data, size);
+}
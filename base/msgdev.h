@@ -320,11 +320,15 @@ protected:
     TDeviceData *FHead;
     TDeviceTag *FCurrTag;
     TDeviceVar *FCurrVar;
+    TDeviceData *FTail;
         TDeviceAlloc *FAlloc;
 };
 
 class TDeviceMsg
 {
+friend class TDeviceMsgView;
+friend class TDeviceMsgWriter;
+
 public:
     TDeviceMsg();
     TDeviceMsg(int MaxSize);
@@ -351,14 +355,198 @@ public:
     int FDeleteOnSend;
 
 protected:
-        unsigned short int Crc(const char *Data, int Size) const;
+        static unsigned short int Crc(const char *Data, int Size);
 
         TDeviceTag *FHead;
+        TDeviceTag *FTail;
         TDeviceTag *FCurrTag;
         TDeviceAlloc *FAlloc;
 
 private:
 };
 
+struct TDeviceViewEntry
+{
+    const char *Raw;
+    const char *Data;
+    int RawSize;
+    int Size;
+    unsigned short int ID;
+    char IsTag;
+    char Type;
+    int First;
+    int Last;
+    int Next;
+    int KeyStart;
+    int VarCount;
+    int TagCount;
+};
+
+struct TDeviceViewKey
+{
+    unsigned short int ID;
+    int Entry;
+};
+
+class TDeviceMsgView;
+
+class TDeviceVarView
+{
+friend class TDeviceTagView;
+
+public:
+    TDeviceVarView();
+
+    int IsValid() const;
+    int IsEmptyVar() const;
+    int GetID() const;
+    char GetType() const;
+
+    unsigned int GetUnsignedInt() const;
+    unsigned short int GetUnsignedShort() const;
+    unsigned long GetUnsignedLong() const;
+    int GetSignedInt() const;
+    short int GetSignedShort() const;
+    long GetSignedLong() const;
+    char GetChar() const;
+    long GetFloat1() const;
+    long GetFloat2() const;
+    long GetFloat3() const;
+    long GetFloat4() const;
+    long GetJulian() const;
+    const void *GetBinary(int *size) const;
+    int GetString(char *str, int maxsize) const;
+    int GetBoolean() const;
+    const char *GetBoolArray(int *size) const;
+    const void *GetByteArray(int *size) const;
+
+protected:
+    const char *FRaw;
+    int FRawSize;
+    const char *FData;
+    int FSize;
+    unsigned short int FID;
+    char FType;
+};
+
+class TDeviceTagView
+{
+friend class TDeviceMsgView;
+
+public:
+    TDeviceTagView();
+
+    int IsValid() const;
+    int IsEmptyTag() const;
+    int GetID() const;
+
+    int GetVarCount() const;
+    TDeviceVarView GetVarAt(int n) const;
+    int GetTagCount() const;
+    TDeviceTagView GetTagAt(int n) const;
+
+    TDeviceTagView GetTag(unsigned short int ID) const;
+    TDeviceVarView GetVar(unsigned short int ID) const;
+    int HasEmptyVar(unsigned short int ID) const;
+    int HasEmptyTag(unsigned short int ID) const;
+
+    unsigned short int GetUnsignedShort(unsigned short int ID, unsigned short int Default) const;
+    unsigned long GetUnsignedLong(unsigned short int ID, unsigned long Default) const;
+    unsigned int GetUnsignedInt(unsigned short int ID, unsigned int Default) const;
+    short int GetSignedShort(unsigned short int ID, short int Default) const;
+    long GetSignedLong(unsigned short int ID, long Default) const;
+    int GetSignedInt(unsigned short int ID, int Default) const;
+    char GetChar(unsigned short int ID, char Default) const;
+    long GetFloat1(unsigned short int ID, long Default) const;
+    long GetFloat2(unsigned short int ID, long Default) const;
+    long GetFloat3(unsigned short int ID, long Default) const;
+    long GetFloat4(unsigned short int ID, long Default) const;
+    long GetJulian(unsigned short int ID, long Default) const;
+    const void *GetBinary(unsigned short int ID, int *size) const;
+    int GetString(unsigned short int ID, char *str, int maxsize) const;
+    int GetBoolean(unsigned short int ID, int Default) const;
+    const char *GetBoolArray(unsigned short int ID, int *size) const;
+    const void *GetByteArray(unsigned short int ID, int *size) const;
+
+protected:
+    TDeviceTagView(const TDeviceMsgView *msg, int entry);
+    int Find(int start, int count, unsigned short int ID) const;
+    TDeviceVarView MakeVar(int entry) const;
+
+    const TDeviceMsgView *FMsg;
+    int FEntry;
+};
+
+class TDeviceMsgView
+{
+friend class TDeviceTagView;
+
+public:
+    TDeviceMsgView();
+    ~TDeviceMsgView();
+
+    int Parse(long signature, const char *data, int size);
+
+    int GetTagCount() const;
+    TDeviceTagView GetTagAt(int n) const;
+    TDeviceTagView GetTag(unsigned short int ID) const;
+
+protected:
+    int AddEntry(int parent);
+    int ParseTag(int entry, const char *data, int size, int depth);
+    int ParseVar(int entry, const char *data, int size);
+    void BuildKeys();
+    void SortKeys(int start, int count);
+
+    TDeviceViewEntry *FEntryArr;
+    int FEntryCount;
+    int FEntrySize;
+    TDeviceViewKey *FKeyArr;
+    int FKeySize;
+};
+
+class TDeviceMsgWriter
+{
+public:
+    TDeviceMsgWriter(long Signature, char *Data, int MaxSize);
+
+    int GetSize() const;
+    int IsOverflow() const;
+    int Finish();
+
+    void AddTag(unsigned short int ID);
+    void EndTag();
+    void AddNone(unsigned short int ID);
+
+    void AddUnsignedShort(unsigned short int ID, unsigned short int data);
+    void AddUnsignedLong(unsigned short int ID, unsigned long data);
+    void AddUnsignedInt(unsigned short int ID, unsigned int data);
+    void AddSignedShort(unsigned short int ID, short int data);
+    void AddSignedLong(unsigned short int ID, long data);
+    void AddSignedInt(unsigned short int ID, int data);
+    void AddChar(unsigned short int ID, char ch);
+    void AddFloat1(unsigned short int ID, long data);
+    void AddFloat2(unsigned short int ID, long data);
+    void AddFloat3(unsigned short int ID, long data);
+    void AddFloat4(unsigned short int ID, long data);
+    void AddJulian(unsigned short int ID, long data);
+    void AddBinary(unsigned short int ID, int size, const void *data);
+    void AddString(unsigned short int ID, const char *str);
+    void AddBoolean(unsigned short int ID, int data);
+    void AddBoolArray(unsigned short int ID, int size, const char *data);
+    void AddByteArray(unsigned short int ID, int size, const void *data);
+
+protected:
+    char *Reserve(int size);
+    char *AddVar(unsigned short int ID, char Type, int LenSize, int Size);
+    void AddFixed(unsigned short int ID, char Type, const void *data, int size);
+
+    char *FData;
+    int FMaxSize;
+    int FPos;
+    int FLevel;
+    int FOverflow;
+};
+
 #endif
 
@@ -47,3 +47,127 @@ long Random(int Range)
 {
     return RdosGetRandom(Range);
 }
+
+/*##########################################################################
+#
+#   Name       : TRandom::TRandom
+#
+#   Purpose....: Constructor for TRandom, seeded from Random
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TRandom::TRandom()
+{
+    Seed(((unsigned int)Random(0x10000) << 16) | (unsigned int)Random(0x10000));
+}
+
+/*##########################################################################
+#
+#   Name       : TRandom::TRandom
+#
+#   Purpose....: Constructor for TRandom
+#
+#   In params..: Seed
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TRandom::TRandom(unsigned int Seed)
+{
+    this->Seed(Seed);
+}
+
+/*##########################################################################
+#
+#   Name       : TRandom::Seed
+#
+#   Purpose....: Seed the generator state
+#
+#   In params..: Seed
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRandom::Seed(unsigned int Seed)
+{
+    int i;
+    unsigned int z;
+
+    for (i = 0; i < 4; i++)
+    {
+        Seed += 0x9E3779B9;
+        z = Seed;
+        z = (z ^ (z >> 16)) * 0x85EBCA6B;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35;
+        FState[i] = z ^ (z >> 16);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TRandom::Next
+#
+#   Purpose....: Generate 32 random bits (xoshiro128**)
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Random number
+#
+##########################################################################*/
+unsigned int TRandom::Next()
+{
+    unsigned int result;
+    unsigned int t;
+
+    result = FState[1] * 5;
+    result = ((result << 7) | (result >> 25)) * 9;
+
+    t = FState[1] << 9;
+
+    FState[2] ^= FState[0];
+    FState[3] ^= FState[1];
+    FState[1] ^= FState[2];
+    FState[0] ^= FState[3];
+    FState[2] ^= t;
+    FState[3] = (FState[3] << 11) | (FState[3] >> 21);
+
+    return result;
+}
+
+/*##########################################################################
+#
+#   Name       : TRandom::Get
+#
+#   Purpose....: Generate a random number
+#
+#   In params..: Range
+#   Out params.: *
+#   Returns....: 0 .. Range - 1
+#
+##########################################################################*/
+long TRandom::Get(int Range)
+{
+    if (Range <= 1)
+        return 0;
+
+    return (long)(Next() % (unsigned int)Range);
+}
+
+/*##########################################################################
+#
+#   Name       : TRandom::GetUniform
+#
+#   Purpose....: Generate a uniform random number
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Number in ]0, 1]
+#
+##########################################################################*/
+double TRandom::GetUniform()
+{
+    return ((double)Next() + 1.0) / 4294967296.0;
+}
@@ -36,5 +36,21 @@
 
 long Random(int Range);
 
+class TRandom
+{
+public:
+    TRandom();
+    TRandom(unsigned int Seed);
+
+    void Seed(unsigned int Seed);
+
+    unsigned int Next();
+    long Get(int Range);
+    double GetUniform();
+
+protected:
+    unsigned int FState[4];
+};
+
 #endif
 
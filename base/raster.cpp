@@ -0,0 +1,1301 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# raster.cpp
+# Software rasterizer for linear bitmaps
+#
+########################################################################*/
+
+#include <string.h>
+#include <math.h>
+#include "rdos.h"
+#include "raster.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define FALSE   0
+#define TRUE    !FALSE
+
+#define INVERT_MASK     0xFFFFFF
+#define OPAQUE_MASK     0xFF000000
+
+/*##########################################################################
+#
+#   Name       : ReadPixel
+#
+#   Purpose....: Read a pixel and convert it to 0xAARRGGBB
+#
+#   In params..: p              pixel position
+#                bpp            bits per pixel
+#   Out params.: *
+#   Returns....: pixel value
+#
+##########################################################################*/
+static unsigned int ReadPixel(const char *p, int bpp)
+{
+    unsigned int val;
+    unsigned int r, g, b;
+
+    switch (bpp)
+    {
+        case 16:
+            val = *(const unsigned short *)p;
+            r = (val >> 11) & 0x1F;
+            g = (val >> 5) & 0x3F;
+            b = val & 0x1F;
+            r = (r << 3) | (r >> 2);
+            g = (g << 2) | (g >> 4);
+            b = (b << 3) | (b >> 2);
+            return OPAQUE_MASK | (r << 16) | (g << 8) | b;
+
+        case 24:
+            b = (unsigned char)p[0];
+            g = (unsigned char)p[1];
+            r = (unsigned char)p[2];
+            return OPAQUE_MASK | (r << 16) | (g << 8) | b;
+
+        case 32:
+            return *(const unsigned int *)p;
+    }
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : WritePixel
+#
+#   Purpose....: Convert a 0xAARRGGBB value and write it as a pixel
+#
+#   In params..: p              pixel position
+#                bpp            bits per pixel
+#                val            pixel value
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static void WritePixel(char *p, int bpp, unsigned int val)
+{
+    switch (bpp)
+    {
+        case 16:
+            *(unsigned short *)p = (unsigned short)(((val >> 8) & 0xF800) | ((val >> 5) & 0x7E0) | ((val >> 3) & 0x1F));
+            break;
+
+        case 24:
+            p[0] = (char)val;
+            p[1] = (char)(val >> 8);
+            p[2] = (char)(val >> 16);
+            break;
+
+        case 32:
+            *(unsigned int *)p = val;
+            break;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : ApplyLgop
+#
+#   Purpose....: Combine a source pixel with a destination pixel
+#
+#   In params..: dst            destination pixel
+#                src            source pixel or color
+#                lgop           logical operation
+#   Out params.: *
+#   Returns....: new destination pixel
+#
+##########################################################################*/
+static unsigned int ApplyLgop(unsigned int dst, unsigned int src, int lgop)
+{
+    unsigned int res;
+    unsigned int t;
+    int d, s;
+    int i;
+
+    switch (lgop)
+    {
+        case LGOP_NONE:
+            return src;
+
+        case LGOP_OR:
+            return dst | src;
+
+        case LGOP_AND:
+            return dst & src;
+
+        case LGOP_XOR:
+            return dst ^ src;
+
+        case LGOP_INVERT:
+            return src ^ INVERT_MASK;
+
+        case LGOP_INVERT_OR:
+            return dst | (src ^ INVERT_MASK);
+
+        case LGOP_INVERT_AND:
+            return dst & (src ^ INVERT_MASK);
+
+        case LGOP_INVERT_XOR:
+            return dst ^ (src ^ INVERT_MASK);
+
+        case LGOP_ADD:
+        case LGOP_SUBTRACT:
+        case LGOP_MULTIPLY:
+            res = 0;
+            for (i = 0; i < 32; i += 8)
+            {
+                d = (dst >> i) & 0xFF;
+                s = (src >> i) & 0xFF;
+
+                if (lgop == LGOP_ADD)
+                {
+                    d += s;
+                    if (d > 0xFF)
+                        d = 0xFF;
+                }
+                else if (lgop == LGOP_SUBTRACT)
+                {
+                    d -= s;
+                    if (d < 0)
+                        d = 0;
+                }
+                else
+                {
+                    t = (unsigned int)(d * s + 128);
+                    d = (int)((t + (t >> 8)) >> 8);
+                }
+                res |= (unsigned int)d << i;
+            }
+            return res;
+    }
+    return dst;
+}
+
+/*##########################################################################
+#
+#   Name       : BlendPixel
+#
+#   Purpose....: Alpha-blend a source pixel over a destination pixel
+#
+#   In params..: dst            destination pixel
+#                src            source pixel with alpha in upper byte
+#   Out params.: *
+#   Returns....: new destination pixel
+#
+##########################################################################*/
+static unsigned int BlendPixel(unsigned int dst, unsigned int src)
+{
+    unsigned int res;
+    unsigned int a;
+    unsigned int t;
+    int i;
+
+    a = src >> 24;
+    res = OPAQUE_MASK;
+
+    for (i = 0; i < 24; i += 8)
+    {
+        t = ((src >> i) & 0xFF) * a + ((dst >> i) & 0xFF) * (255 - a) + 128;
+        res |= ((t + (t >> 8)) >> 8) << i;
+    }
+    return res;
+}
+
+#ifdef __SSE2__
+/*##########################################################################
+#
+#   Name       : MulVec
+#
+#   Purpose....: Multiply four pixels per channel, scaled to 0..255
+#
+#   In params..: d              destination pixels
+#                s              source pixels
+#   Out params.: *
+#   Returns....: product
+#
+##########################################################################*/
+static __m128i MulVec(__m128i d, __m128i s)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i round = _mm_set1_epi16(128);
+    __m128i lo;
+    __m128i hi;
+
+    lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+    hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+
+    lo = _mm_add_epi16(lo, round);
+    hi = _mm_add_epi16(hi, round);
+
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+    return _mm_packus_epi16(lo, hi);
+}
+
+/*##########################################################################
+#
+#   Name       : BlendVec
+#
+#   Purpose....: Alpha-blend four source pixels over four destination pixels
+#
+#   In params..: d              destination pixels
+#                s              source pixels with alpha in upper byte
+#   Out params.: *
+#   Returns....: blended pixels
+#
+##########################################################################*/
+static __m128i BlendVec(__m128i d, __m128i s)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i round = _mm_set1_epi16(128);
+    __m128i full = _mm_set1_epi16(255);
+    __m128i opaque = _mm_set1_epi32((int)OPAQUE_MASK);
+    __m128i sl, sh;
+    __m128i dl, dh;
+    __m128i al, ah;
+    __m128i lo, hi;
+
+    sl = _mm_unpacklo_epi8(s, zero);
+    sh = _mm_unpackhi_epi8(s, zero);
+    dl = _mm_unpacklo_epi8(d, zero);
+    dh = _mm_unpackhi_epi8(d, zero);
+
+    al = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sl, 0xFF), 0xFF);
+    ah = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sh, 0xFF), 0xFF);
+
+    lo = _mm_add_epi16(_mm_mullo_epi16(sl, al), _mm_mullo_epi16(dl, _mm_sub_epi16(full, al)));
+    hi = _mm_add_epi16(_mm_mullo_epi16(sh, ah), _mm_mullo_epi16(dh, _mm_sub_epi16(full, ah)));
+
+    lo = _mm_add_epi16(lo, round);
+    hi = _mm_add_epi16(hi, round);
+
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+    return _mm_or_si128(_mm_packus_epi16(lo, hi), opaque);
+}
+#endif
+
+/*##########################################################################
+#
+#   Name       : Span32
+#
+#   Purpose....: Apply an operation to a 32-bit span
+#
+#   In params..: dst            destination pixels
+#                src            source pixels, or 0 to use color
+#                color          color when there is no source
+#                count          number of pixels
+#                lgop           logical operation
+#                blend          alpha-blend source
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static void Span32(unsigned int *dst, const unsigned int *src, unsigned int color, int count, int lgop, int blend)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    __m128i c = _mm_set1_epi32((int)color);
+    __m128i inv = _mm_set1_epi32(INVERT_MASK);
+    __m128i s;
+    __m128i d;
+
+    if (lgop == LGOP_NONE && !blend)
+    {
+        if (src)
+        {
+            memcpy(dst, src, count * 4);
+            return;
+        }
+
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_si128((__m128i *)(dst + i), c);
+    }
+    else
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            if (src)
+                s = _mm_loadu_si128((const __m128i *)(src + i));
+            else
+                s = c;
+
+            d = _mm_loadu_si128((const __m128i *)(dst + i));
+
+            if (blend)
+                d = BlendVec(d, s);
+            else
+            {
+                switch (lgop)
+                {
+                    case LGOP_NONE:
+                        d = s;
+                        break;
+
+                    case LGOP_OR:
+                        d = _mm_or_si128(d, s);
+                        break;
+
+                    case LGOP_AND:
+                        d = _mm_and_si128(d, s);
+                        break;
+
+                    case LGOP_XOR:
+                        d = _mm_xor_si128(d, s);
+                        break;
+
+                    case LGOP_INVERT:
+                        d = _mm_xor_si128(s, inv);
+                        break;
+
+                    case LGOP_INVERT_OR:
+                        d = _mm_or_si128(d, _mm_xor_si128(s, inv));
+                        break;
+
+                    case LGOP_INVERT_AND:
+                        d = _mm_and_si128(d, _mm_xor_si128(s, inv));
+                        break;
+
+                    case LGOP_INVERT_XOR:
+                        d = _mm_xor_si128(d, _mm_xor_si128(s, inv));
+                        break;
+
+                    case LGOP_ADD:
+                        d = _mm_adds_epu8(d, s);
+                        break;
+
+                    case LGOP_SUBTRACT:
+                        d = _mm_subs_epu8(d, s);
+                        break;
+
+                    case LGOP_MULTIPLY:
+                        d = MulVec(d, s);
+                        break;
+                }
+            }
+            _mm_storeu_si128((__m128i *)(dst + i), d);
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (src)
+            color = src[i];
+
+        if (blend)
+            dst[i] = BlendPixel(dst[i], color);
+        else
+            dst[i] = ApplyLgop(dst[i], color, lgop);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterBuffer::TRasterBuffer
+#
+#   Purpose....: Constructor for TRasterBuffer
+#
+#   In params..: bpp            bits per pixel
+#                width
+#                height
+#                alpha          bitmap has alpha channel
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TRasterBuffer::TRasterBuffer(int bpp, int width, int height, int alpha)
+{
+    int size;
+
+    FBpp = bpp;
+    FWidth = width;
+    FHeight = height;
+    FAlpha = alpha;
+    FRefCount = 1;
+
+    FRowSize = (width * bpp / 8 + 3) & ~3;
+    size = FRowSize * height;
+    if (size <= 0)
+        size = 4;
+
+    FLinear = new char[size];
+    memset(FLinear, 0, size);
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterBuffer::~TRasterBuffer
+#
+#   Purpose....: Destructor for TRasterBuffer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TRasterBuffer::~TRasterBuffer()
+{
+    delete[] FLinear;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterBuffer::AddRef
+#
+#   Purpose....: Add a reference to the buffer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterBuffer::AddRef()
+{
+    FRefCount++;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterBuffer::Release
+#
+#   Purpose....: Remove a reference to the buffer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: remaining references
+#
+##########################################################################*/
+int TRasterBuffer::Release()
+{
+    FRefCount--;
+    return FRefCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::TRasterDevice
+#
+#   Purpose....: Constructor for TRasterDevice
+#
+#   In params..: bpp            bits per pixel (16, 24 or 32)
+#                width
+#                height
+#                alpha          bitmap has alpha channel
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TRasterDevice::TRasterDevice(int bpp, int width, int height, int alpha)
+{
+    if ((bpp == 16 || bpp == 24 || bpp == 32) && width >= 0 && height >= 0)
+        FBuffer = new TRasterBuffer(bpp, width, height, alpha);
+    else
+        FBuffer = 0;
+
+    FColor = OPAQUE_MASK;
+    FLgop = LGOP_NONE;
+    FFilledStyle = FALSE;
+
+    ClearClipRect();
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::TRasterDevice
+#
+#   Purpose....: Constructor that shares the pixels of another device
+#
+#   In params..: dev            device to share pixels with
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TRasterDevice::TRasterDevice(TRasterDevice *dev)
+{
+    FBuffer = dev->FBuffer;
+    if (FBuffer)
+        FBuffer->AddRef();
+
+    FColor = OPAQUE_MASK;
+    FLgop = LGOP_NONE;
+    FFilledStyle = FALSE;
+
+    ClearClipRect();
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::~TRasterDevice
+#
+#   Purpose....: Destructor for TRasterDevice
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TRasterDevice::~TRasterDevice()
+{
+    if (FBuffer)
+        if (FBuffer->Release() == 0)
+            delete FBuffer;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::GetBpp
+#
+#   Purpose....: Get bits per pixel
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: bits per pixel
+#
+##########################################################################*/
+int TRasterDevice::GetBpp()
+{
+    if (FBuffer)
+        return FBuffer->FBpp;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::GetWidth
+#
+#   Purpose....: Get width
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: width
+#
+##########################################################################*/
+int TRasterDevice::GetWidth()
+{
+    if (FBuffer)
+        return FBuffer->FWidth;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::GetHeight
+#
+#   Purpose....: Get height
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: height
+#
+##########################################################################*/
+int TRasterDevice::GetHeight()
+{
+    if (FBuffer)
+        return FBuffer->FHeight;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::GetLineSize
+#
+#   Purpose....: Get bytes per row
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: bytes per row
+#
+##########################################################################*/
+int TRasterDevice::GetLineSize()
+{
+    if (FBuffer)
+        return FBuffer->FRowSize;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::GetLinear
+#
+#   Purpose....: Get linear pixel buffer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: pixel buffer
+#
+##########################################################################*/
+void *TRasterDevice::GetLinear()
+{
+    if (FBuffer)
+        return FBuffer->FLinear;
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::IsValid
+#
+#   Purpose....: Check if device has a pixel buffer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: TRUE if valid
+#
+##########################################################################*/
+int TRasterDevice::IsValid()
+{
+    return FBuffer != 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::ClearClipRect
+#
+#   Purpose....: Clip to the whole bitmap
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::ClearClipRect()
+{
+    FClipXMin = 0;
+    FClipYMin = 0;
+
+    if (FBuffer)
+    {
+        FClipXMax = FBuffer->FWidth - 1;
+        FClipYMax = FBuffer->FHeight - 1;
+    }
+    else
+    {
+        FClipXMax = -1;
+        FClipYMax = -1;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::SetClipRect
+#
+#   Purpose....: Set clip rectangle (inclusive)
+#
+#   In params..: xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::SetClipRect(int xmin, int ymin, int xmax, int ymax)
+{
+    ClearClipRect();
+
+    if (xmin > FClipXMin)
+        FClipXMin = xmin;
+
+    if (ymin > FClipYMin)
+        FClipYMin = ymin;
+
+    if (xmax < FClipXMax)
+        FClipXMax = xmax;
+
+    if (ymax < FClipYMax)
+        FClipYMax = ymax;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::SetDrawColor
+#
+#   Purpose....: Set draw color
+#
+#   In params..: color          0xRRGGBB
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::SetDrawColor(int color)
+{
+    FColor = OPAQUE_MASK | (color & INVERT_MASK);
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::SetLgop
+#
+#   Purpose....: Set logical operation
+#
+#   In params..: lgop           LGOP_xxx
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::SetLgop(int lgop)
+{
+    FLgop = lgop;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::SetHollowStyle
+#
+#   Purpose....: Draw outlines of rectangles & ellipses
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::SetHollowStyle()
+{
+    FFilledStyle = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::SetFilledStyle
+#
+#   Purpose....: Fill rectangles & ellipses
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::SetFilledStyle()
+{
+    FFilledStyle = TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::GetPos
+#
+#   Purpose....: Get address of a pixel
+#
+#   In params..: x, y           position
+#   Out params.: *
+#   Returns....: pixel address
+#
+##########################################################################*/
+char *TRasterDevice::GetPos(int x, int y)
+{
+    return FBuffer->FLinear + y * FBuffer->FRowSize + x * (FBuffer->FBpp / 8);
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::GetPixel
+#
+#   Purpose....: Get pixel color
+#
+#   In params..: x, y           position
+#   Out params.: *
+#   Returns....: 0xRRGGBB, or 0 if outside
+#
+##########################################################################*/
+int TRasterDevice::GetPixel(int x, int y)
+{
+    if (!FBuffer)
+        return 0;
+
+    if (x < 0 || y < 0 || x >= FBuffer->FWidth || y >= FBuffer->FHeight)
+        return 0;
+
+    return (int)(ReadPixel(GetPos(x, y), FBuffer->FBpp) & INVERT_MASK);
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::PlotPixel
+#
+#   Purpose....: Draw a single pixel if inside clip rectangle
+#
+#   In params..: x, y           position
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::PlotPixel(int x, int y)
+{
+    char *p;
+
+    if (x < FClipXMin || x > FClipXMax || y < FClipYMin || y > FClipYMax)
+        return;
+
+    p = GetPos(x, y);
+    WritePixel(p, FBuffer->FBpp, ApplyLgop(ReadPixel(p, FBuffer->FBpp), FColor, FLgop));
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::SetPixel
+#
+#   Purpose....: Draw a pixel using current color
+#
+#   In params..: x, y           position
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::SetPixel(int x, int y)
+{
+    if (FBuffer && FLgop != LGOP_NULL)
+        PlotPixel(x, y);
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::FillSpan
+#
+#   Purpose....: Draw a horizontal span, clipped
+#
+#   In params..: x1, x2         start and end column (inclusive)
+#                y              row
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::FillSpan(int x1, int x2, int y)
+{
+    char *p;
+    int bpp;
+    int count;
+
+    if (y < FClipYMin || y > FClipYMax)
+        return;
+
+    if (x1 < FClipXMin)
+        x1 = FClipXMin;
+
+    if (x2 > FClipXMax)
+        x2 = FClipXMax;
+
+    if (x1 > x2)
+        return;
+
+    p = GetPos(x1, y);
+    bpp = FBuffer->FBpp;
+    count = x2 - x1 + 1;
+
+    if (bpp == 32)
+        Span32((unsigned int *)p, 0, FColor, count, FLgop, FALSE);
+    else
+    {
+        while (count)
+        {
+            WritePixel(p, bpp, ApplyLgop(ReadPixel(p, bpp), FColor, FLgop));
+            p += bpp / 8;
+            count--;
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::FillArea
+#
+#   Purpose....: Fill a rectangle, clipped
+#
+#   In params..: x1, y1         upper left corner (inclusive)
+#                x2, y2         lower right corner (inclusive)
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::FillArea(int x1, int y1, int x2, int y2)
+{
+    int y;
+
+    if (y1 < FClipYMin)
+        y1 = FClipYMin;
+
+    if (y2 > FClipYMax)
+        y2 = FClipYMax;
+
+    for (y = y1; y <= y2; y++)
+        FillSpan(x1, x2, y);
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::Blit
+#
+#   Purpose....: Copy from another device to this
+#
+#   In params..: src            source device
+#                srcx, srcy     start point of source
+#                x, y           start point to blit to
+#                width          width of pixels to copy
+#                height         height of pixels to copy
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::Blit(TRasterDevice *src, int srcx, int srcy, int x, int y, int width, int height)
+{
+    TRasterBuffer *sb;
+    TRasterBuffer *db;
+    char *sp;
+    char *dp;
+    char *temp;
+    unsigned int val;
+    int blend;
+    int bytes;
+    int row;
+    int step;
+    int i;
+
+    sb = src->FBuffer;
+    db = FBuffer;
+
+    if (!sb || !db || FLgop == LGOP_NULL)
+        return;
+
+    if (srcx < 0)
+    {
+        x -= srcx;
+        width += srcx;
+        srcx = 0;
+    }
+
+    if (srcy < 0)
+    {
+        y -= srcy;
+        height += srcy;
+        srcy = 0;
+    }
+
+    if (srcx + width > sb->FWidth)
+        width = sb->FWidth - srcx;
+
+    if (srcy + height > sb->FHeight)
+        height = sb->FHeight - srcy;
+
+    if (x < FClipXMin)
+    {
+        srcx += FClipXMin - x;
+        width -= FClipXMin - x;
+        x = FClipXMin;
+    }
+
+    if (y < FClipYMin)
+    {
+        srcy += FClipYMin - y;
+        height -= FClipYMin - y;
+        y = FClipYMin;
+    }
+
+    if (x + width - 1 > FClipXMax)
+        width = FClipXMax - x + 1;
+
+    if (y + height - 1 > FClipYMax)
+        height = FClipYMax - y + 1;
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    blend = sb->FAlpha && FLgop == LGOP_NONE;
+    bytes = width * (sb->FBpp / 8);
+
+    if (sb->FLinear == db->FLinear)
+        temp = new char[bytes];
+    else
+        temp = 0;
+
+    if (temp && y > srcy)
+    {
+        row = height - 1;
+        step = -1;
+    }
+    else
+    {
+        row = 0;
+        step = 1;
+    }
+
+    for (; row >= 0 && row < height; row += step)
+    {
+        sp = src->GetPos(srcx, srcy + row);
+        dp = GetPos(x, y + row);
+
+        if (temp)
+        {
+            memcpy(temp, sp, bytes);
+            sp = temp;
+        }
+
+        if (sb->FBpp == 32 && db->FBpp == 32)
+            Span32((unsigned int *)dp, (const unsigned int *)sp, 0, width, FLgop, blend);
+        else if (sb->FBpp == db->FBpp && FLgop == LGOP_NONE)
+            memcpy(dp, sp, bytes);
+        else
+        {
+            for (i = 0; i < width; i++)
+            {
+                val = ReadPixel(sp, sb->FBpp);
+
+                if (blend)
+                    val = BlendPixel(ReadPixel(dp, db->FBpp), val);
+                else if (FLgop != LGOP_NONE)
+                    val = ApplyLgop(ReadPixel(dp, db->FBpp), val, FLgop);
+
+                WritePixel(dp, db->FBpp, val);
+                sp += sb->FBpp / 8;
+                dp += db->FBpp / 8;
+            }
+        }
+    }
+
+    if (temp)
+        delete[] temp;
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::DrawLine
+#
+#   Purpose....: Draw a line using current color
+#
+#   In params..: x1, y1         one end-point
+#                x2, y2         the other end-point
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::DrawLine(int x1, int y1, int x2, int y2)
+{
+    int dx, dy;
+    int sx, sy;
+    int err;
+    int e2;
+
+    if (!FBuffer || FLgop == LGOP_NULL)
+        return;
+
+    if (y1 == y2)
+    {
+        if (x1 <= x2)
+            FillSpan(x1, x2, y1);
+        else
+            FillSpan(x2, x1, y1);
+        return;
+    }
+
+    if (x1 == x2)
+    {
+        if (y1 <= y2)
+            FillArea(x1, y1, x1, y2);
+        else
+            FillArea(x1, y2, x1, y1);
+        return;
+    }
+
+    dx = x2 - x1;
+    if (dx < 0)
+    {
+        dx = -dx;
+        sx = -1;
+    }
+    else
+        sx = 1;
+
+    dy = y2 - y1;
+    if (dy < 0)
+    {
+        dy = -dy;
+        sy = -1;
+    }
+    else
+        sy = 1;
+
+    err = dx - dy;
+
+    for (;;)
+    {
+        PlotPixel(x1, y1);
+
+        if (x1 == x2 && y1 == y2)
+            break;
+
+        e2 = 2 * err;
+        if (e2 > -dy)
+        {
+            err -= dy;
+            x1 += sx;
+        }
+        if (e2 < dx)
+        {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::DrawRect
+#
+#   Purpose....: Draw a rectangle using current fill-style and color
+#
+#   In params..: x, y           upper left corner
+#                width, height  size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::DrawRect(int x, int y, int width, int height)
+{
+    int x2, y2;
+
+    if (!FBuffer || FLgop == LGOP_NULL || width <= 0 || height <= 0)
+        return;
+
+    x2 = x + width - 1;
+    y2 = y + height - 1;
+
+    if (FFilledStyle)
+        FillArea(x, y, x2, y2);
+    else
+    {
+        FillSpan(x, x2, y);
+
+        if (y2 > y)
+            FillSpan(x, x2, y2);
+
+        if (y2 > y + 1)
+        {
+            FillArea(x, y + 1, x, y2 - 1);
+
+            if (x2 > x)
+                FillArea(x2, y + 1, x2, y2 - 1);
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : HalfWidth
+#
+#   Purpose....: Get half width of an ellipse row
+#
+#   In params..: rx, ry         radius
+#                dy             row offset from center
+#   Out params.: *
+#   Returns....: half width, or -1 outside ellipse
+#
+##########################################################################*/
+static int HalfWidth(int rx, int ry, int dy)
+{
+    double f;
+
+    if (dy < -ry || dy > ry)
+        return -1;
+
+    f = 1.0 - (double)dy * (double)dy / ((double)ry * (double)ry);
+    return (int)((double)rx * sqrt(f) + 0.5);
+}
+
+/*##########################################################################
+#
+#   Name       : TRasterDevice::DrawEllipse
+#
+#   Purpose....: Draw an ellipse using current fill-style and color
+#
+#   In params..: x, y           upper left corner of bounding box
+#                width, height  size of bounding box
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TRasterDevice::DrawEllipse(int x, int y, int width, int height)
+{
+    int cx, cy;
+    int rx, ry;
+    int dy;
+    int h;
+    int k;
+    int e;
+
+    if (!FBuffer || FLgop == LGOP_NULL || width <= 0 || height <= 0)
+        return;
+
+    rx = (width - 1) / 2;
+    ry = (height - 1) / 2;
+    cx = x + rx;
+    cy = y + ry;
+
+    if (ry == 0)
+    {
+        FillSpan(cx - rx, cx + rx, cy);
+        return;
+    }
+
+    for (dy = -ry; dy <= ry; dy++)
+    {
+        h = HalfWidth(rx, ry, dy);
+
+        if (FFilledStyle)
+            FillSpan(cx - h, cx + h, cy + dy);
+        else
+        {
+            k = HalfWidth(rx, ry, dy - 1);
+            e = HalfWidth(rx, ry, dy + 1);
+            if (e < k)
+                k = e;
+
+            if (k < 0)
+                FillSpan(cx - h, cx + h, cy + dy);
+            else
+            {
+                e = k + 1;
+                if (e > h)
+                    e = h;
+
+                if (e == 0)
+                    FillSpan(cx - h, cx + h, cy + dy);
+                else
+                {
+                    FillSpan(cx - h, cx - e, cy + dy);
+                    FillSpan(cx + e, cx + h, cy + dy);
+                }
+            }
+        }
+    }
+}
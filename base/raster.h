@@ -0,0 +1,101 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# raster.h
+# Software rasterizer for linear bitmaps
+#
+########################################################################*/
+
+#ifndef _RASTER_H
+#define _RASTER_H
+
+class TRasterBuffer
+{
+public:
+    TRasterBuffer(int bpp, int width, int height, int alpha);
+    ~TRasterBuffer();
+
+    void AddRef();
+    int Release();
+
+    int FBpp;
+    int FWidth;
+    int FHeight;
+    int FRowSize;
+    int FAlpha;
+    char *FLinear;
+
+protected:
+    int FRefCount;
+};
+
+class TRasterDevice
+{
+public:
+    TRasterDevice(int bpp, int width, int height, int alpha);
+    TRasterDevice(TRasterDevice *dev);
+    ~TRasterDevice();
+
+    int GetBpp();
+    int GetWidth();
+    int GetHeight();
+    int GetLineSize();
+    void *GetLinear();
+    int IsValid();
+
+    void ClearClipRect();
+    void SetClipRect(int xmin, int ymin, int xmax, int ymax);
+    void SetDrawColor(int color);
+    void SetLgop(int lgop);
+    void SetHollowStyle();
+    void SetFilledStyle();
+
+    int GetPixel(int x, int y);
+    void SetPixel(int x, int y);
+    void Blit(TRasterDevice *src, int srcx, int srcy, int x, int y, int width, int height);
+    void DrawLine(int x1, int y1, int x2, int y2);
+    void DrawRect(int x, int y, int width, int height);
+    void DrawEllipse(int x, int y, int width, int height);
+
+protected:
+    char *GetPos(int x, int y);
+    void FillSpan(int x1, int x2, int y);
+    void FillArea(int x1, int y1, int x2, int y2);
+    void PlotPixel(int x, int y);
+
+    TRasterBuffer *FBuffer;
+
+    int FClipXMin;
+    int FClipYMin;
+    int FClipXMax;
+    int FClipYMax;
+
+    int FColor;
+    int FLgop;
+    int FFilledStyle;
+};
+
+#endif
@@ -0,0 +1,737 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# rasterapi.cpp
+# User-space bitmap API on top of TRasterDevice
+#
+########################################################################*/
+
+#ifndef __RDOS__
+
+#include <string.h>
+#include "rdos.h"
+#include "section.h"
+#include "raster.h"
+
+#define FALSE   0
+#define TRUE    !FALSE
+
+static TSection RasterSection("Raster.Handle");
+static TRasterDevice **RasterArr = 0;
+static int RasterSize = 0;
+
+/*##########################################################################
+#
+#   Name       : AllocateHandle
+#
+#   Purpose....: Allocate a bitmap handle for a device
+#
+#   In params..: dev            raster device
+#   Out params.: *
+#   Returns....: handle, or 0 on failure
+#
+##########################################################################*/
+static int AllocateHandle(TRasterDevice *dev)
+{
+    TRasterDevice **arr;
+    int handle;
+    int size;
+    int i;
+
+    if (!dev->IsValid())
+    {
+        delete dev;
+        return 0;
+    }
+
+    RasterSection.Enter();
+
+    for (i = 0; i < RasterSize; i++)
+        if (!RasterArr[i])
+            break;
+
+    if (i == RasterSize)
+    {
+        size = 2 * RasterSize;
+        if (size < 16)
+            size = 16;
+
+        arr = new TRasterDevice *[size];
+        memset(arr, 0, size * sizeof(TRasterDevice *));
+
+        if (RasterArr)
+        {
+            memcpy(arr, RasterArr, RasterSize * sizeof(TRasterDevice *));
+            delete[] RasterArr;
+        }
+
+        RasterArr = arr;
+        RasterSize = size;
+    }
+
+    RasterArr[i] = dev;
+    handle = i + 1;
+
+    RasterSection.Leave();
+
+    return handle;
+}
+
+/*##########################################################################
+#
+#   Name       : GetDevice
+#
+#   Purpose....: Get device from a bitmap handle
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: device, or 0 if invalid
+#
+##########################################################################*/
+static TRasterDevice *GetDevice(int handle)
+{
+    TRasterDevice *dev = 0;
+
+    RasterSection.Enter();
+
+    if (handle > 0 && handle <= RasterSize)
+        dev = RasterArr[handle - 1];
+
+    RasterSection.Leave();
+
+    return dev;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosCreateBitmap
+#
+#   Purpose....: Create a bitmap
+#
+#   In params..: BitsPerPixel   16, 24 or 32
+#                width
+#                height
+#   Out params.: *
+#   Returns....: handle
+#
+##########################################################################*/
+int RdosCreateBitmap(int BitsPerPixel, int width, int height)
+{
+    return AllocateHandle(new TRasterDevice(BitsPerPixel, width, height, FALSE));
+}
+
+/*##########################################################################
+#
+#   Name       : RdosCreateAlphaBitmap
+#
+#   Purpose....: Create a 32-bit bitmap with alpha channel
+#
+#   In params..: width
+#                height
+#   Out params.: *
+#   Returns....: handle
+#
+##########################################################################*/
+int RdosCreateAlphaBitmap(int width, int height)
+{
+    return AllocateHandle(new TRasterDevice(32, width, height, TRUE));
+}
+
+/*##########################################################################
+#
+#   Name       : RdosExtractValidBitmapMask
+#
+#   Purpose....: Extract mask of an alpha bitmap. Not supported
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: 0
+#
+##########################################################################*/
+int RdosExtractValidBitmapMask(int handle)
+{
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosExtractInvalidBitmapMask
+#
+#   Purpose....: Extract inverted mask of an alpha bitmap. Not supported
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: 0
+#
+##########################################################################*/
+int RdosExtractInvalidBitmapMask(int handle)
+{
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosExtractAlphaBitmap
+#
+#   Purpose....: Extract alpha channel. Not supported
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: 0
+#
+##########################################################################*/
+int RdosExtractAlphaBitmap(int handle)
+{
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosCreateStringBitmap
+#
+#   Purpose....: Create bitmap from string. Not supported without fonts
+#
+#   In params..: font           font handle
+#                str            string
+#   Out params.: *
+#   Returns....: 0
+#
+##########################################################################*/
+int RdosCreateStringBitmap(int font, const char *str)
+{
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosDuplicateBitmapHandle
+#
+#   Purpose....: Create a new handle that shares the pixels of a bitmap
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: new handle
+#
+##########################################################################*/
+int RdosDuplicateBitmapHandle(int handle)
+{
+    TRasterDevice *dup = 0;
+
+    RasterSection.Enter();
+
+    if (handle > 0 && handle <= RasterSize && RasterArr[handle - 1])
+        dup = new TRasterDevice(RasterArr[handle - 1]);
+
+    RasterSection.Leave();
+
+    if (dup)
+        return AllocateHandle(dup);
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosCloseBitmap
+#
+#   Purpose....: Close a bitmap handle
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosCloseBitmap(int handle)
+{
+    TRasterDevice *dev = 0;
+
+    RasterSection.Enter();
+
+    if (handle > 0 && handle <= RasterSize)
+    {
+        dev = RasterArr[handle - 1];
+        RasterArr[handle - 1] = 0;
+    }
+
+    if (dev)
+        delete dev;
+
+    RasterSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : RdosGetBitmapInfo
+#
+#   Purpose....: Get bitmap info
+#
+#   In params..: handle         bitmap handle
+#   Out params.: BitPerPixel
+#                width
+#                height
+#                linesize       bytes per row
+#                buffer         linear pixel buffer
+#   Returns....: *
+#
+##########################################################################*/
+void RdosGetBitmapInfo(int handle, int *BitPerPixel, int *width, int *height, int *linesize, void **buffer)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+    {
+        *BitPerPixel = dev->GetBpp();
+        *width = dev->GetWidth();
+        *height = dev->GetHeight();
+        *linesize = dev->GetLineSize();
+        *buffer = dev->GetLinear();
+    }
+    else
+    {
+        *BitPerPixel = 0;
+        *width = 0;
+        *height = 0;
+        *linesize = 0;
+        *buffer = 0;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : RdosSetClipRect
+#
+#   Purpose....: Set clip rectangle
+#
+#   In params..: handle         bitmap handle
+#                xmin, ymin     upper left corner
+#                xmax, ymax     lower right corner
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosSetClipRect(int handle, int xmin, int ymin, int xmax, int ymax)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->SetClipRect(xmin, ymin, xmax, ymax);
+}
+
+/*##########################################################################
+#
+#   Name       : RdosClearClipRect
+#
+#   Purpose....: Remove clip rectangle
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosClearClipRect(int handle)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->ClearClipRect();
+}
+
+/*##########################################################################
+#
+#   Name       : RdosSetDrawColor
+#
+#   Purpose....: Set draw color
+#
+#   In params..: handle         bitmap handle
+#                color          0xRRGGBB
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosSetDrawColor(int handle, int color)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->SetDrawColor(color);
+}
+
+/*##########################################################################
+#
+#   Name       : RdosSetLGOP
+#
+#   Purpose....: Set logical operation
+#
+#   In params..: handle         bitmap handle
+#                lgop           LGOP_xxx
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosSetLGOP(int handle, int lgop)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->SetLgop(lgop);
+}
+
+/*##########################################################################
+#
+#   Name       : RdosSetHollowStyle
+#
+#   Purpose....: Draw outlines of rectangles & ellipses
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosSetHollowStyle(int handle)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->SetHollowStyle();
+}
+
+/*##########################################################################
+#
+#   Name       : RdosSetFilledStyle
+#
+#   Purpose....: Fill rectangles & ellipses
+#
+#   In params..: handle         bitmap handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosSetFilledStyle(int handle)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->SetFilledStyle();
+}
+
+/*##########################################################################
+#
+#   Name       : RdosSetFont
+#
+#   Purpose....: Set font. Ignored, since there are no fonts
+#
+#   In params..: handle         bitmap handle
+#                font           font handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosSetFont(int handle, int font)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : RdosGetPixel
+#
+#   Purpose....: Get pixel color
+#
+#   In params..: handle         bitmap handle
+#                x, y           position
+#   Out params.: *
+#   Returns....: 0xRRGGBB
+#
+##########################################################################*/
+int RdosGetPixel(int handle, int x, int y)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        return dev->GetPixel(x, y);
+    else
+        return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosSetPixel
+#
+#   Purpose....: Draw a pixel
+#
+#   In params..: handle         bitmap handle
+#                x, y           position
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosSetPixel(int handle, int x, int y)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->SetPixel(x, y);
+}
+
+/*##########################################################################
+#
+#   Name       : RdosBlit
+#
+#   Purpose....: Copy between bitmaps
+#
+#   In params..: SrcHandle      source bitmap handle
+#                DestHandle     destination bitmap handle
+#                width, height  size
+#                SrcX, SrcY     source position
+#                DestX, DestY   destination position
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosBlit(int SrcHandle, int DestHandle, int width, int height, int SrcX, int SrcY, int DestX, int DestY)
+{
+    TRasterDevice *src = GetDevice(SrcHandle);
+    TRasterDevice *dest = GetDevice(DestHandle);
+
+    if (src && dest)
+        dest->Blit(src, SrcX, SrcY, DestX, DestY, width, height);
+}
+
+/*##########################################################################
+#
+#   Name       : RdosDrawLine
+#
+#   Purpose....: Draw a line
+#
+#   In params..: handle         bitmap handle
+#                x1, y1         one end-point
+#                x2, y2         the other end-point
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosDrawLine(int handle, int x1, int y1, int x2, int y2)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->DrawLine(x1, y1, x2, y2);
+}
+
+/*##########################################################################
+#
+#   Name       : RdosDrawString
+#
+#   Purpose....: Draw a string. Ignored, since there are no fonts
+#
+#   In params..: handle         bitmap handle
+#                x, y           position
+#                str            string
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosDrawString(int handle, int x, int y, const char *str)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : RdosOpenFont
+#
+#   Purpose....: Open a font. There are no font files, so the handle only
+#                records the height
+#
+#   In params..: id             font ID
+#                height         font height
+#   Out params.: *
+#   Returns....: font handle
+#
+##########################################################################*/
+int RdosOpenFont(int id, int height)
+{
+    if (height > 0)
+        return height;
+    else
+        return 1;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosCloseFont
+#
+#   Purpose....: Close a font
+#
+#   In params..: font           font handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosCloseFont(int font)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : RdosGetStringMetrics
+#
+#   Purpose....: Get size of a string, using a fixed cell of half the font height
+#
+#   In params..: font           font handle
+#                str            string
+#   Out params.: width
+#                height
+#   Returns....: *
+#
+##########################################################################*/
+void RdosGetStringMetrics(int font, const char *str, int *width, int *height)
+{
+    *width = (int)strlen(str) * ((font + 1) / 2);
+    *height = font;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosCreateSprite
+#
+#   Purpose....: Create a sprite. Not supported
+#
+#   In params..: DestHandle     destination bitmap
+#                BitmapHandle   sprite bitmap
+#                MaskHandle     sprite mask
+#                lgop           logical operation
+#   Out params.: *
+#   Returns....: 0
+#
+##########################################################################*/
+int RdosCreateSprite(int DestHandle, int BitmapHandle, int MaskHandle, int lgop)
+{
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : RdosCloseSprite
+#
+#   Purpose....: Close a sprite. Not supported
+#
+#   In params..: handle         sprite handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosCloseSprite(int handle)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : RdosShowSprite
+#
+#   Purpose....: Show a sprite. Not supported
+#
+#   In params..: handle         sprite handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosShowSprite(int handle)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : RdosHideSprite
+#
+#   Purpose....: Hide a sprite. Not supported
+#
+#   In params..: handle         sprite handle
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosHideSprite(int handle)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : RdosMoveSprite
+#
+#   Purpose....: Move a sprite. Not supported
+#
+#   In params..: handle         sprite handle
+#                x, y           position
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosMoveSprite(int handle, int x, int y)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : RdosDrawRect
+#
+#   Purpose....: Draw a rectangle
+#
+#   In params..: handle         bitmap handle
+#                x, y           upper left corner
+#                width, height  size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosDrawRect(int handle, int x, int y, int width, int height)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->DrawRect(x, y, width, height);
+}
+
+/*##########################################################################
+#
+#   Name       : RdosDrawEllipse
+#
+#   Purpose....: Draw an ellipse
+#
+#   In params..: handle         bitmap handle
+#                x, y           upper left corner of bounding box
+#                width, height  size of bounding box
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void RdosDrawEllipse(int handle, int x, int y, int width, int height)
+{
+    TRasterDevice *dev = GetDevice(handle);
+
+    if (dev)
+        dev->DrawEllipse(x, y, width, height);
+}
+
+#endif
@@ -263,6 +263,17 @@ char TSerialCommand::Read()
         return FSerial->Read();
 }
 
+/*##################  TSerialCommand::Read ###########################
+*   Purpose....: Read available chars from serial device                    #
+*   In params..: buf, size                                                  #
+*   Out params.: *                                                          #
+*   Returns....: number of chars read                                       #
+*##########################################################################*/
+int TSerialCommand::Read(char *buf, int size)
+{
+        return FSerial->Read(buf, size);
+}
+
 /*##################  TSerialCommand::WaitForChar ###########################
 *   Purpose....: Wait for char with timeout from serial device              #
 *   In params..: *                                                          #
@@ -288,6 +299,7 @@ int TSerialCommand::WaitForChar(long MaxWait)
 void TSerialDevice::Init()
 {
     OnChar = 0;    
+    OnData = 0;
 
     FPort = 0;
     FHandle = 0;
@@ -300,9 +312,18 @@ void TSerialDevice::Init()
     FCurrId = 0;
     FNextPos = 0;
     FEntryCount = 0;
+    FEntryArr = 0;
+    FRunArr = 0;
+    FRunHalfSize = 0;
+    FRunCurr = 0;
+    FRunPos[0] = 0;
+    FRunPos[1] = 0;
+    FNewData = false;
     FFileCount = 0;
+    FLogExt = ".sdd";
     FUseCts = FALSE;
-    FBufferSize = 0x4000;
+    FSendBufferSize = 0x4000;
+    FRecBufferSize = 0x4000;
 }
 
 /*##########################################################################
@@ -429,6 +450,12 @@ TSerialDevice::~TSerialDevice()
 
     if (FHandle)
         RdosCloseCom(FHandle);
+
+    if (FEntryArr)
+        delete FEntryArr;
+
+    if (FRunArr)
+        delete FRunArr;
 }
 
 /*##########################################################################
@@ -525,7 +552,27 @@ int TSerialDevice::GetHandle()
 ##########################################################################*/
 void TSerialDevice::SetBufferSize(int Size)
 {
-    FBufferSize = Size;
+    FSendBufferSize = Size;
+    FRecBufferSize = Size;
+}
+
+/*##########################################################################
+#
+#   Name       : TSerialDevice::SetBufferSize
+#
+#   Purpose....: Set send and receive buffer size. Takes effect next
+#                time port is opened
+#
+#   In params..: SendSize       send buffer size
+#                RecSize        receive buffer size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TSerialDevice::SetBufferSize(int SendSize, int RecSize)
+{
+    FSendBufferSize = SendSize;
+    FRecBufferSize = RecSize;
 }
 
 /*##########################################################################
@@ -596,7 +643,7 @@ void TSerialDevice::CheckFileCount()
         entry = FileList.Get();
         basename = entry.GetEntryName();
         strcpy(file, basename.GetData());
-        if (strstr(file, ".sdd"))
+        if (strstr(file, FLogExt))
         {
             if (entry.GetFileSize() == 0)
             {
@@ -662,7 +709,7 @@ void TSerialDevice::InitFiles()
         entry = FileList.Get();
         basename = entry.GetEntryName();
         strcpy(file, basename.GetData());
-        if (strstr(file, ".sdd"))
+        if (strstr(file, FLogExt))
         {
             ptr = strchr(file, '.');
             if (ptr)
@@ -680,7 +727,7 @@ void TSerialDevice::InitFiles()
     delete file;
 
     FCurrId++;
-    str.printf("%s/%d.sdd", FLogPath.GetData(), FCurrId);
+    str.printf("%s/%d%s", FLogPath.GetData(), FCurrId, FLogExt);
     FCurrFile = new TFile(str.GetData(), 0);
 }
 
@@ -710,6 +757,19 @@ int TSerialDevice::DefineEventDebug(const char *LogPath, int DumpFiles, int Entr
     {        
         CheckFileCount();
 
+        FEventSection.Enter();
+
+        if (FEntryArr)
+            delete FEntryArr;
+
+        if (FRunArr)
+        {
+            delete FRunArr;
+            FRunArr = 0;
+        }
+
+        FLogExt = ".sdd";
+        FNextPos = 0;
         FEntryCount = EntryCount;
         FEntryArr = new struct TSerialDebug[EntryCount];
 
@@ -721,6 +781,70 @@ int TSerialDevice::DefineEventDebug(const char *LogPath, int DumpFiles, int Entr
             FEntryArr[i].ch = 0;
         }
 
+        FEventSection.Leave();
+
+        return TRUE;
+    }
+    else
+    {
+        FFileCount = 0;
+        return FALSE;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TSerialDevice::DefineEventRunDebug
+#
+#   Purpose....: Define event debug that records runs of chars with a
+#                single timestamp. The buffer is split in two halves,
+#                and the oldest half is reused when the current is full
+#
+#   In params..: LogPath        directory for dump files
+#                DumpFiles      number of dump files to keep
+#                BufferSize     size of event buffer
+#                InChannel      channel for received data
+#                OutChannel     channel for sent data
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TSerialDevice::DefineEventRunDebug(const char *LogPath, int DumpFiles, int BufferSize, int InChannel, int OutChannel)
+{
+    FLogPath = LogPath;
+    FInChannel = InChannel;
+    FOutChannel = OutChannel;
+    FFileCount = DumpFiles;
+
+    TPathName path(FLogPath);
+
+    if (BufferSize < 0x400)
+        BufferSize = 0x400;
+
+    if (path.MakeDir())
+    {        
+        FEventSection.Enter();
+
+        if (FEntryArr)
+        {
+            delete FEntryArr;
+            FEntryArr = 0;
+        }
+        FEntryCount = 0;
+
+        if (FRunArr)
+            delete FRunArr;
+
+        FLogExt = ".sdr";
+        FRunHalfSize = BufferSize / 2;
+        FRunArr = new char[2 * FRunHalfSize];
+        FRunCurr = 0;
+        FRunPos[0] = 0;
+        FRunPos[1] = 0;
+
+        FEventSection.Leave();
+
+        CheckFileCount();
         return TRUE;
     }
     else
@@ -764,8 +888,6 @@ int TSerialDevice::DumpEvents()
 *##########################################################################*/
 void TSerialDevice::Execute()
 {
-    int pos;
-    struct TSerialDebug *DumpArr;
     TPathName path(FLogPath);
 
     RdosWaitMilli(100);
@@ -774,31 +896,94 @@ void TSerialDevice::Execute()
     {        
         InitFiles();
 
-        DumpArr = new struct TSerialDebug[FEntryCount];
+        if (FRunArr)
+            DumpRuns();
+        else
+            DumpEntries();
 
-        FEventSection.Enter();
+        delete FCurrFile;
+        FCurrFile = 0;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TSerialDevice::DumpEntries
+#
+#   Purpose....: Dump per-char event buffer to current file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TSerialDevice::DumpEntries()
+{
+    int pos;
+    struct TSerialDebug *DumpArr;
 
-        pos = FNextPos;
+    DumpArr = new struct TSerialDebug[FEntryCount];
 
-        for (int i = 0; i < FEntryCount; i++)
-            DumpArr[i] = FEntryArr[i];
+    FEventSection.Enter();
 
-        FNewData = false;
+    pos = FNextPos;
+
+    for (int i = 0; i < FEntryCount; i++)
+        DumpArr[i] = FEntryArr[i];
+
+    FNewData = false;
         
-        FEventSection.Leave();
+    FEventSection.Leave();
         
-        for (int i = pos; i < FEntryCount; i++) 
-            if (DumpArr[i].Time)
-                FCurrFile->Write(&DumpArr[i], sizeof(struct TSerialDebug));
+    for (int i = pos; i < FEntryCount; i++) 
+        if (DumpArr[i].Time)
+            FCurrFile->Write(&DumpArr[i], sizeof(struct TSerialDebug));
 
-        for (int i = 0; i < pos; i++)
-            if (DumpArr[i].Time)
-                FCurrFile->Write(&DumpArr[i], sizeof(struct TSerialDebug));
+    for (int i = 0; i < pos; i++)
+        if (DumpArr[i].Time)
+            FCurrFile->Write(&DumpArr[i], sizeof(struct TSerialDebug));
 
-        delete DumpArr;
-        delete FCurrFile;
-        FCurrFile = 0;
-    }
+    delete DumpArr;
+}
+
+/*##########################################################################
+#
+#   Name       : TSerialDevice::DumpRuns
+#
+#   Purpose....: Dump run event buffer to current file. Each run is a
+#                TSerialDebugRun header followed by the chars
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TSerialDevice::DumpRuns()
+{
+    char *DumpArr;
+    int size;
+    int old;
+
+    DumpArr = new char[2 * FRunHalfSize];
+
+    FEventSection.Enter();
+
+    old = FRunCurr ^ 1;
+
+    memcpy(DumpArr, FRunArr + old * FRunHalfSize, FRunPos[old]);
+    size = FRunPos[old];
+
+    memcpy(DumpArr + size, FRunArr + FRunCurr * FRunHalfSize, FRunPos[FRunCurr]);
+    size += FRunPos[FRunCurr];
+
+    FNewData = false;
+        
+    FEventSection.Leave();
+
+    if (size)
+        FCurrFile->Write(DumpArr, size);
+
+    delete DumpArr;
 }
 
 /*##################  TSerialDevice::OpenPort  #######################
@@ -811,7 +996,7 @@ void TSerialDevice::Execute()
 void TSerialDevice::OpenPort()
 {
     if (FPort)
-        FHandle = RdosOpenCom(FPort - 1, FBaudrate, FParity, FDataBits, FStopBits, FBufferSize, FBufferSize);
+        FHandle = RdosOpenCom(FPort - 1, FBaudrate, FParity, FDataBits, FStopBits, FSendBufferSize, FRecBufferSize);
     else
         FHandle = 0;
         
@@ -1315,36 +1500,12 @@ void TSerialDevice::SendBreak(char CharCount)
 ##########################################################################*/
 void TSerialDevice::Write(char ch)
 {
-    TSerialDebug Debug;
-
     if (FHandle)
     {
         RdosWriteCom(FHandle, ch);
 
-        if (FDebugFile && FOutChannel)
-        {
-            Debug.Time = RdosGetLongTime();
-            Debug.Channel = FOutChannel;
-            Debug.ch = ch;
-            FDebugFile->Write(&Debug, sizeof(Debug));
-        }
-
-        if (FFileCount && FEntryCount && FOutChannel)
-        {
-            FEventSection.Enter();
-
-            FEntryArr[FNextPos].Time = RdosGetLongTime();
-            FEntryArr[FNextPos].Channel = FOutChannel;
-            FEntryArr[FNextPos].ch = ch;
-
-            FNextPos++;
-            if (FNextPos >= FEntryCount)
-                FNextPos = 0;
-
-            FNewData = true;
-
-            FEventSection.Leave();
-        }        
+        if (FOutChannel)
+            LogData(FOutChannel, &ch, 1);
     }       
 }
 
@@ -1362,12 +1523,16 @@ void TSerialDevice::Write(char ch)
 ##########################################################################*/
 void TSerialDevice::Write(const char *buf, int count)
 {
-        int i;
+    int i;
+
+    if (FHandle && count > 0)
+    {
         for (i = 0; i < count; i++)
-        {
-                Write(*buf);
-                buf++;
-        }
+            RdosWriteCom(FHandle, buf[i]);
+
+        if (FOutChannel)
+            LogData(FOutChannel, buf, count);
+    }
 }
 
 /*##########################################################################
@@ -1383,11 +1548,7 @@ void TSerialDevice::Write(const char *buf, int count)
 ##########################################################################*/
 void TSerialDevice::Write(const char *str)
 {
-        while (*str != 0)
-        {
-                Write(*str);
-                str++;
-        }
+    Write(str, strlen(str));
 }
 
 /*##########################################################################
@@ -1471,39 +1632,174 @@ int TSerialDevice::Poll()
 char TSerialDevice::Read()
 {
     char ch = 0;
-    TSerialDebug Debug;
 
     if (FHandle)
     {
         ch = RdosReadCom(FHandle);
 
-        if (FDebugFile && FInChannel)
-        {
-            Debug.Time = RdosGetLongTime();
-            Debug.Channel = FInChannel;
-            Debug.ch = ch;
-            FDebugFile->Write(&Debug, sizeof(Debug));
-        }   
+        if (FInChannel)
+            LogData(FInChannel, &ch, 1);
+    }
+    
+    return ch;
+}
+
+/*##########################################################################
+#
+#   Name       : TSerialDevice::Read
+#
+#   Purpose....: Read available chars without waiting
+#
+#   In params..: buf            buffer
+#                size           size of buffer
+#   Out params.: *
+#   Returns....: number of chars read
+#
+##########################################################################*/
+int TSerialDevice::Read(char *buf, int size)
+{
+    int count;
+    int i;
 
-        if (FFileCount && FEntryCount && FInChannel)
+    if (!FHandle)
+        return 0;
+
+    count = RdosGetComRecCount(FHandle);
+    if (count > size)
+        count = size;
+
+    for (i = 0; i < count; i++)
+        buf[i] = RdosReadCom(FHandle);
+
+    if (count > 0 && FInChannel)
+        LogData(FInChannel, buf, count);
+
+    return count;
+}
+
+/*##########################################################################
+#
+#   Name       : TSerialDevice::LogData
+#
+#   Purpose....: Log a block of chars to debug file and event buffer
+#                with a single timestamp
+#
+#   In params..: Channel        debug channel
+#                buf            chars
+#                count          number of chars
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TSerialDevice::LogData(int Channel, const char *buf, int count)
+{
+    TSerialDebug Debug[32];
+    long long Time;
+    int size;
+    int i;
+
+    if (!FDebugFile && !FFileCount)
+        return;
+
+    Time = RdosGetLongTime();
+
+    if (FDebugFile)
+    {
+        for (i = 0; i < count; i += size)
         {
-            FEventSection.Enter();
+            size = count - i;
+            if (size > 32)
+                size = 32;
 
-            FEntryArr[FNextPos].Time = RdosGetLongTime();
-            FEntryArr[FNextPos].Channel = FInChannel;
-            FEntryArr[FNextPos].ch = ch;
+            for (int j = 0; j < size; j++)
+            {
+                Debug[j].Time = Time;
+                Debug[j].Channel = Channel;
+                Debug[j].ch = buf[i + j];
+            }
+            FDebugFile->Write(Debug, size * sizeof(TSerialDebug));
+        }
+    }
+
+    if (FFileCount && FEntryCount)
+    {
+        FEventSection.Enter();
+
+        for (i = 0; i < count; i++)
+        {
+            FEntryArr[FNextPos].Time = Time;
+            FEntryArr[FNextPos].Channel = Channel;
+            FEntryArr[FNextPos].ch = buf[i];
 
             FNextPos++;
             if (FNextPos >= FEntryCount)
                 FNextPos = 0;
+        }
+
+        FNewData = true;
+
+        FEventSection.Leave();
+    }
+
+    if (FFileCount && FRunArr)
+        LogRun(Channel, Time, buf, count);
+}
+
+/*##########################################################################
+#
+#   Name       : TSerialDevice::LogRun
+#
+#   Purpose....: Add runs of chars to event buffer. Switches to the
+#                oldest half of the buffer when the current is full
+#
+#   In params..: Channel        debug channel
+#                Time           timestamp
+#                buf            chars
+#                count          number of chars
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TSerialDevice::LogRun(int Channel, long long Time, const char *buf, int count)
+{
+    TSerialDebugRun Run;
+    char *ptr;
+    int size;
 
-            FNewData = true;
+    FEventSection.Enter();
 
-            FEventSection.Leave();
+    while (count > 0)
+    {
+        size = FRunHalfSize - FRunPos[FRunCurr] - sizeof(TSerialDebugRun);
+        if (size <= 0)
+        {
+            FRunCurr ^= 1;
+            FRunPos[FRunCurr] = 0;
+            continue;
         }
+
+        if (size > count)
+            size = count;
+
+        if (size > 0x7FFF)
+            size = 0x7FFF;
+
+        Run.Channel = Channel;
+        Run.Count = size;
+        Run.Time = Time;
+
+        ptr = FRunArr + FRunCurr * FRunHalfSize + FRunPos[FRunCurr];
+        memcpy(ptr, &Run, sizeof(TSerialDebugRun));
+        memcpy(ptr + sizeof(TSerialDebugRun), buf, size);
+
+        FRunPos[FRunCurr] += sizeof(TSerialDebugRun) + size;
+        buf += size;
+        count -= size;
     }
-    
-    return ch;
+
+    FNewData = true;
+
+    FEventSection.Leave();
 }
 
 /*##########################################################################
@@ -1519,6 +1815,22 @@ char TSerialDevice::Read()
 ##########################################################################*/
 void TSerialDevice::SignalNewData()
 {
-    if (OnChar)
-        (*OnChar)(this, Read());
+    char buf[256];
+    int count;
+
+    if (OnData)
+    {
+        do
+        {
+            count = Read(buf, sizeof(buf));
+            if (count)
+                (*OnData)(this, buf, count);
+        }
+        while (count == sizeof(buf));
+    }
+    else
+    {
+        if (OnChar)
+            (*OnChar)(this, Read());
+    }
 }
@@ -45,6 +45,14 @@ public:
     char ch;
 };
 
+struct TSerialDebugRun
+{
+public:
+    short int Channel;
+    short int Count;
+    long long Time;
+};
+
 class TSerialDevice : public TWaitDevice
 {
 public:
@@ -55,6 +63,7 @@ public:
     ~TSerialDevice();
 
     void SetBufferSize(int size);
+    void SetBufferSize(int SendSize, int RecSize);
 
     virtual void DeviceName(char *Name, int MaxLen) const;
 
@@ -62,6 +71,7 @@ public:
     void StopDebug();
 
     int DefineEventDebug(const char *LogPath, int DumpFiles, int EntryCount, int InChannel, int OutChannel);
+    int DefineEventRunDebug(const char *LogPath, int DumpFiles, int BufferSize, int InChannel, int OutChannel);
     int DumpEvents();
     
     virtual int IsOpen();
@@ -105,6 +115,7 @@ public:
     void WaitForSendCompleted();
     int Poll();
     char Read();
+    int Read(char *buf, int size);
     int WaitForChar(long Timeout);
     int SupportsFullDuplex();
 
@@ -112,6 +123,7 @@ public:
     void DisableCts();
 
     void (*OnChar)(TSerialDevice *Serial, char ch);
+    void (*OnData)(TSerialDevice *Serial, const char *buf, int count);
 
 protected:
     virtual void SignalNewData();
@@ -125,10 +137,15 @@ private:
     void OpenPort();
     void CheckFileCount();
     void InitFiles();
+    void LogData(int Channel, const char *buf, int count);
+    void LogRun(int Channel, long long Time, const char *buf, int count);
+    void DumpEntries();
+    void DumpRuns();
 
     TSection FSection;
     int FHandle;
-    int FBufferSize;
+    int FSendBufferSize;
+    int FRecBufferSize;
 
     int FPort;
     long FBaudrate;
@@ -147,6 +164,11 @@ private:
     int FEntryCount;
     struct TSerialDebug *FEntryArr;
 
+    char *FRunArr;
+    int FRunHalfSize;
+    int FRunCurr;
+    int FRunPos[2];
+
     TSection FEventSection;
     int FCurrId;
     TFile *FCurrFile;
@@ -154,6 +176,7 @@ private:
     int FNextPos;
     bool FNewData;
     TString FLogPath;
+    const char *FLogExt;
 };
 
 class TSerialCommand
@@ -180,6 +203,7 @@ protected:
     void Write(const char *buf, int count);
     void Write(const char *str);
     char Read();
+    int Read(char *buf, int size);
     int WaitForChar(long MaxWait);
 
     TSerialDevice *FSerial;
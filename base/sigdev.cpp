@@ -37,7 +37,10 @@
 #include <rdos.h>
 #else
 #include <pthread.h>
+#include <stdint.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #endif
 
 /**
@@ -76,6 +79,9 @@ TSignalDevice::~TSignalDevice()
 {
 #ifdef __RDOS__
     RdosFreeSignal(FHandle);
+#else
+    if (FWaitHandle != -1)
+        close(FWaitHandle);
 #endif
 }
 
@@ -104,6 +110,7 @@ void TSignalDevice::Init()
     FMutex = PTHREAD_MUTEX_INITIALIZER;
     FCond = PTHREAD_COND_INITIALIZER;
     FSignalled = false;
+    FWaitHandle = -1;
 #endif
 }
 
@@ -132,16 +139,68 @@ void TSignalDevice::DeviceName(char *Name, int MaxLen) const
  * when the signal device's state changes. It ensures that the specified wait object
  * (TWait) is linked with the signal handling mechanism provided by the device.
  *
- * The implementation is platform-dependent and specific to RDOS systems, utilizing
- * low-level system calls to manage the wait object.
+ * On RDOS the kernel signal is added to the wait handle. On Linux an eventfd
+ * is created on first use and kept in step with FSignalled, so epoll sees
+ * the device as readable while it is signalled.
  *
  * @param Wait A pointer to a TWait object to be added to the signal device.
  */
-#ifdef __RDOS__
 void TSignalDevice::Add(TWait *Wait)
 {
+#ifdef __RDOS__
     if (FHandle)
         RdosAddWaitForSignal(Wait->GetHandle(), FHandle, (int)this);
+#else
+    uint64_t val = 1;
+
+    pthread_mutex_lock(&FMutex);
+    if (FWaitHandle == -1)
+    {
+        FWaitHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (FSignalled && FWaitHandle != -1)
+            write(FWaitHandle, &val, sizeof(val));
+    }
+    pthread_mutex_unlock(&FMutex);
+
+    if (FWaitHandle != -1)
+        Wait->AddHandle(FWaitHandle, this);
+#endif
+}
+
+#ifndef __RDOS__
+/**
+ * @brief Drains the eventfd used by TWait. Must be called with FMutex held.
+ */
+void TSignalDevice::ClearWaitHandle()
+{
+    uint64_t val;
+
+    if (FWaitHandle != -1)
+        read(FWaitHandle, &val, sizeof(val));
+}
+#endif
+
+#ifndef __RDOS__
+/**
+ * @brief Consumes the signal after TWait found the eventfd readable.
+ *
+ * The signal is auto-reset, like RDOS signals in a wait. A wakeup for a
+ * signal that has already been cleared or consumed by a direct wait is
+ * reported as stale.
+ *
+ * @return true if the device was signalled.
+ */
+bool TSignalDevice::ConsumeWait()
+{
+    bool signalled;
+
+    pthread_mutex_lock(&FMutex);
+    signalled = FSignalled;
+    FSignalled = false;
+    ClearWaitHandle();
+    pthread_mutex_unlock(&FMutex);
+
+    return signalled;
 }
 #endif
 
@@ -164,7 +223,10 @@ void TSignalDevice::Clear()
 #ifdef __RDOS__
     RdosResetSignal(FHandle);
 #else
+    pthread_mutex_lock(&FMutex);
     FSignalled = false;
+    ClearWaitHandle();
+    pthread_mutex_unlock(&FMutex);
 #endif
 }
 
@@ -207,7 +269,11 @@ void TSignalDevice::Signal()
 #ifdef __RDOS__
     RdosSetSignal(FHandle);
 #else
+    uint64_t val = 1;
+
     pthread_mutex_lock(&FMutex);
+    if (!FSignalled && FWaitHandle != -1)
+        write(FWaitHandle, &val, sizeof(val));
     FSignalled = true;
     pthread_cond_signal(&FCond);
     pthread_mutex_unlock(&FMutex);
@@ -237,8 +303,9 @@ bool TSignalDevice::WaitForever()
     pthread_mutex_lock(&FMutex);
     while (!FSignalled)
         pthread_cond_wait(&FCond, &FMutex);
-    pthread_mutex_unlock(&FMutex);
     FSignalled = false;
+    ClearWaitHandle();
+    pthread_mutex_unlock(&FMutex);
     SignalNewData();
     return true;
 }
@@ -269,17 +336,23 @@ bool TSignalDevice::WaitTimeout(int MilliSec)
 
     ts.tv_sec += MilliSec / 1000;
     ts.tv_nsec += 1000000 * (MilliSec % 1000);
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
 
     pthread_mutex_lock(&FMutex);
-    pthread_cond_timedwait(&FCond, &FMutex, &ts);
+    while (!FSignalled)
+        if (pthread_cond_timedwait(&FCond, &FMutex, &ts))
+            break;
     signalled = FSignalled;
+    FSignalled = false;
+    ClearWaitHandle();
     pthread_mutex_unlock(&FMutex);
 
     if (signalled)
-    {
-        FSignalled = false;
         SignalNewData();
-    }
 
     return signalled;
 }
@@ -300,30 +373,23 @@ bool TSignalDevice::WaitTimeout(int MilliSec)
  *
  * @param time A reference to a TDateTime object representing the time
  *             until which the thread should wait. The method converts
- *             this to a real timestamp for timing purposes.
+ *             this to a timeout relative to the current local time.
  * @return True if the device was signaled within the specified time,
  *         false if the timeout expired without a signal.
  */
 #ifndef __RDOS__
 bool TSignalDevice::WaitUntil(TDateTime &time)
 {
-    struct timespec ts;
-    bool signalled;
-
-    time.GetRealTimestamp(&ts);
-
-    pthread_mutex_lock(&FMutex);
-    pthread_cond_timedwait(&FCond, &FMutex, &ts);
-    signalled = FSignalled;
-    pthread_mutex_unlock(&FMutex);
+    TDateTime now;
+    long long diff;
 
-    if (signalled)
-    {
-        FSignalled = false;
-        SignalNewData();
-    }
+    diff = time.GetLinuxMilliTimestamp() - now.GetLinuxMilliTimestamp();
+    if (diff < 0)
+        diff = 0;
+    if (diff > 0x7FFFFFFF)
+        diff = 0x7FFFFFFF;
 
-    return signalled;
+    return WaitTimeout((int)diff);
 }
 #endif
 
@@ -80,9 +80,11 @@ protected:
      */
 	virtual void SignalNewData();
 
-#ifdef __RDOS__
     virtual void Add(TWait *Wait);
-#else
+
+#ifndef __RDOS__
+    virtual bool ConsumeWait();
+
     /**
      * @var FMutex
      * @brief A POSIX threading mutex used for synchronization within the TSignalDevice class.
@@ -120,6 +122,14 @@ protected:
      * and waiting operations.
      */
     bool FSignalled;
+    /**
+     * @var FWaitHandle
+     * @brief eventfd mirroring the signal state for TWait, or -1.
+     *
+     * Created the first time the device is added to a TWait, so devices that
+     * are only waited on directly never allocate a descriptor.
+     */
+    int FWaitHandle;
 #endif
 
 private:
@@ -127,6 +137,8 @@ private:
 
 #ifdef __RDOS__
     int FHandle;
+#else
+    void ClearWaitHandle();
 #endif
 };
 
@@ -30,7 +30,6 @@
 ########################################################################*/
 
 #include <string.h>
-
 #include "strarr.h"
 
 #define FALSE 0
@@ -40,208 +39,179 @@ static TString EmptyStr;
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::TStringArrayNode
+#   Name       : TStringArray::TStringArray
 #
-#   Purpose....: Constructor for array-node
+#   Purpose....: Constructor for string array
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TStringArrayNode::TStringArrayNode()
-{
-    FStr = 0;
-}
 
-/*##########################################################################
-#
-#   Name       : TStringArrayNode::TStringArrayNode
-#
-#   Purpose....: Constructor for array-node
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TStringArrayNode::TStringArrayNode(const TString &str)
+TStringArray::TStringArray()
+  : FSection("String Array")
 {
-    FStr = new TString(str);
-    FData = FStr;
-    FValid = TRUE;
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::TStringArrayNode
+#   Name       : TStringArray::TStringArray
 #
-#   Purpose....: Copy constructor for list-node
+#   Purpose....: Copy constructor for string array
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TStringArrayNode::TStringArrayNode(const TStringArrayNode &src)
+
+TStringArray::TStringArray(const TStringArray &source)
+  : FSection("String Array")
 {
-    FStr = new TString(*src.FStr);
-    FData = FStr;
-    FValid = TRUE;
+    Load(source);
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::~TStringArrayNode
+#   Name       : TStringArray::~TStringArray
 #
-#   Purpose....: Destructor for array-node
+#   Purpose....: Destructor for string array
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TStringArrayNode::~TStringArrayNode()
+
+TStringArray::~TStringArray()
 {
+    Free();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::Compare
+#   Name       : TStringArray::operator=
 #
-#   Purpose....: Compare nodes
+#   Purpose....: Assignment operator
 #
-#   In params..: *
+#   In params..: src
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TStringArrayNode::Compare(const TStringArrayNode &n2) const
+
+TStringArray &TStringArray::operator=(const TStringArray &src)
 {
-    if (FStr && n2.FStr)
-        return FStr->Compare(*n2.FStr);
-    else
+    if (this != &src)
     {
-        if (FStr || n2.FStr)
-        {
-            if (FStr)
-                return 1;
-            else
-                return -1;
-        }
-        else
-            return 0;
+        FSection.Enter();
+        Free();
+        Load(src);
+        FSection.Leave();
     }
+    return *this;
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::Compare
+#   Name       : TStringArray::operator+=
 #
-#   Purpose....: Compare nodes
+#   Purpose....: Append array
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TStringArrayNode::Compare(const TArrayBaseNode &n2) const
-{
-    TStringArrayNode *p = (TStringArrayNode *)&n2;
-    return Compare(*p);    
-}
 
-/*##########################################################################
-#
-#   Name       : TStringArrayNode::Load
-#
-#   Purpose....: Load new node
-#
-#   In params..: src
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-void TStringArrayNode::Load(const TStringArrayNode &src)
+TStringArray &TStringArray::operator+=(const TStringArray &l)
 {
-    if (FStr)
-        *FStr = *src.FStr;
-    else
-    {
-        if (src.FData)
-            FStr = new TString(*src.FStr);
-    }
-    FData = FStr;
-    FValid = src.FValid;
+    FSection.Enter();
+    Load(l);
+    FSection.Leave();
+    return *this;
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::Load
+#   Name       : TStringArray::operator[]
 #
-#   Purpose....: Load new node
+#   Purpose....: Get element
 #
-#   In params..: src
+#   In params..: pos
 #   Out params.: *
-#   Returns....: *
+#   Returns....: Reference to string, or empty string if pos is out of range
 #
 ##########################################################################*/
-void TStringArrayNode::Load(const TArrayBaseNode &src)
+
+TString &TStringArray::operator[](int pos)
 {
-    TStringArrayNode *p = (TStringArrayNode *)&src;
-    Load(*p);
+    return Get(pos);
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::operator=
+#   Name       : TStringArray::Get
 #
-#   Purpose....: Assignment operator
+#   Purpose....: Get element
 #
-#   In params..: src
+#   In params..: pos
 #   Out params.: *
-#   Returns....: *
+#   Returns....: Reference to string, or empty string if pos is out of range
 #
 ##########################################################################*/
-const TStringArrayNode &TStringArrayNode::operator=(const TStringArrayNode &src)
+
+TString &TStringArray::Get(int pos)
 {
-    Load(src);
-    return *this;
+    TString *p;
+
+    FSection.Enter();
+
+    if (pos >= 0 && pos < FArr.GetSize())
+        p = FArr[pos].FStr;
+    else
+        p = &EmptyStr;
+
+    FSection.Leave();
+
+    return *p;
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::operator==
+#   Name       : TStringArray::Clear
 #
-#   Purpose....: Compare list nodes
+#   Purpose....: Remove all elements
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TStringArrayNode::operator==(const TStringArrayNode &ln) const
+
+void TStringArray::Clear()
 {
-    if (Compare(ln) == 0)
-        return TRUE;
-    else
-        return FALSE;
+    FSection.Enter();
+    Free();
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::operator!=
+#   Name       : TStringArray::IsEmpty
 #
-#   Purpose....: Compare list nodes
+#   Purpose....: Check if empty
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TStringArrayNode::operator!=(const TStringArrayNode &ln) const
+
+int TStringArray::IsEmpty()
 {
-    if (Compare(ln) == 0)
+    if (FArr.GetSize())
         return FALSE;
     else
         return TRUE;
@@ -249,338 +219,253 @@ int TStringArrayNode::operator!=(const TStringArrayNode &ln) const
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::operator>
+#   Name       : TStringArray::GetSize
 #
-#   Purpose....: Compare array nodes
+#   Purpose....: Get number of elements
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TStringArrayNode::operator>(const TStringArrayNode &dest) const
-{
-    if (Compare(dest) > 0)
-        return TRUE;
-    else
-        return FALSE;
-}
 
-/*##########################################################################
-#
-#   Name       : TStringArrayNode::operator<
-#
-#   Purpose....: Compare list nodes
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-int TStringArrayNode::operator<(const TStringArrayNode &dest) const
+int TStringArray::GetSize()
 {
-    if (Compare(dest) < 0)
-        return TRUE;
-    else
-        return FALSE;
+    return FArr.GetSize();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::operator>=
+#   Name       : TStringArray::Add
 #
-#   Purpose....: Compare list nodes
+#   Purpose....: Add element last
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TStringArrayNode::operator>=(const TStringArrayNode &dest) const
+
+void TStringArray::Add(const TString &str)
 {
-    if (Compare(dest) >= 0)
-        return TRUE;
-    else
-        return FALSE;
+    TStringArrayEntry entry;
+
+    entry.FStr = new TString(str);
+
+    FSection.Enter();
+    FArr.Add(entry);
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::operator<=
+#   Name       : TStringArray::Add
 #
-#   Purpose....: Compare list nodes
+#   Purpose....: Insert element at position
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int TStringArrayNode::operator<=(const TStringArrayNode &dest) const
+
+void TStringArray::Add(int pos, const TString &str)
 {
-    if (Compare(dest) <= 0)
-        return TRUE;
-    else
-        return FALSE;
+    TStringArrayEntry entry;
+
+    if (pos < 0)
+        return;
+
+    entry.FStr = new TString(str);
+
+    FSection.Enter();
+    FArr.Add(pos, entry);
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::Get
+#   Name       : TStringArray::Replace
 #
-#   Purpose....: Get data
+#   Purpose....: Replace element
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TString &TStringArrayNode::Get() const
+
+void TStringArray::Replace(int pos, const TString &str)
 {
-    return *FStr;
+    FSection.Enter();
+
+    if (pos >= 0 && pos < FArr.GetSize())
+        *FArr[pos].FStr = str;
+
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArrayNode::Set
+#   Name       : TStringArray::Remove
 #
-#   Purpose....: Set data
+#   Purpose....: Remove last element
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TStringArrayNode::Set(TString &str)
+
+void TStringArray::Remove()
 {
-    if (FStr)
-        *FStr = str;
-    else
+    int size;
+
+    FSection.Enter();
+
+    size = FArr.GetSize();
+    if (size)
     {
-        FStr = new TString(str);
-        FData = FStr;
-    } 
-    FValid = TRUE;
-}
+        delete FArr[size - 1].FStr;
+        FArr.Remove();
+    }
 
-/*##########################################################################
-#
-#   Name       : TStringArray::TStringArray
-#
-#   Purpose....: Constructor for array
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TStringArray::TStringArray()
-{
-}
+    if (FArr.GetSize() == 0)
+        FArr.Clear();
 
-/*##########################################################################
-#
-#   Name       : TStringArray::TStringArray
-#
-#   Purpose....: Copy constructor for array
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TStringArray::TStringArray(const TStringArray &source)
-  : TArrayBase(source)
-{
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArray::~TStringArray
+#   Name       : TStringArray::Remove
 #
-#   Purpose....: Destructor for array
+#   Purpose....: Remove element at position
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TStringArray::~TStringArray()
-{
-}
 
-/*##########################################################################
-#
-#   Name       : TStringArray::operator=
-#
-#   Purpose....: Assignment operator
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TStringArray &TStringArray::operator=(const TStringArray &src)
+void TStringArray::Remove(int pos)
 {
-    Load(src);
-    return *this;
+    FSection.Enter();
+
+    if (pos >= 0 && pos < FArr.GetSize())
+    {
+        delete FArr[pos].FStr;
+        FArr.Remove(pos);
+    }
+
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArray::operator+=
+#   Name       : TStringArray::Concat
 #
-#   Purpose....: Concat operator
+#   Purpose....: Concat in this array
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TStringArray &TStringArray::operator+=(const TStringArray &l)
+
+void TStringArray::Concat(const TStringArray &src1, const TStringArray &src2)
 {
     TStringArray arr;
-    arr.Concat(*this, l);
-    *this = arr;
-    return *this;
-}
 
-/*##########################################################################
-#
-#   Name       : TStringArray::operator[]
-#
-#   Purpose....: Vector operator
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TString &TStringArray::operator[](int pos)
-{
-    TStringArrayNode *p = (TStringArrayNode *)TArrayBase::Get(pos);
+    arr.Load(src1);
+    arr.Load(src2);
 
-    if (p && p->IsValid())
-        return p->Get();
-    else
-        return EmptyStr;
+    FSection.Enter();
+    Free();
+    FArr.Swap(arr.FArr);
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArray::Clone
+#   Name       : TStringArray::Sort
 #
-#   Purpose....: Clone entry
+#   Purpose....: Sort elements in ascending order
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TStringArrayNode *TStringArray::Clone(const TStringArrayNode *ln) const
-{
-    return new TStringArrayNode(*ln);
-}
 
-/*##########################################################################
-#
-#   Name       : TStringArray::Clone
-#
-#   Purpose....: Clone entry
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-TArrayBaseNode *TStringArray::Clone(const TArrayBaseNode *ln) const
+void TStringArray::Sort()
 {
-    TStringArrayNode *p = (TStringArrayNode *)ln;
-    return new TStringArrayNode(*p);
+    FSection.Enter();
+    FArr.Sort();
+    FSection.Leave();
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArray::Get
+#   Name       : TStringArray::Load
 #
-#   Purpose....: Get data at position
+#   Purpose....: Append copies of the strings in src
 #
-#   In params..: *
+#   In params..: src
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-TString &TStringArray::Get(int pos)
+
+void TStringArray::Load(const TStringArray &src)
 {
-    TStringArrayNode *p = (TStringArrayNode *)TArrayBase::Get(pos);
+    int i;
+    int count = src.FArr.GetSize();
+    TStringArrayEntry entry;
 
-    if (p && p->IsValid())
-        return p->Get();
-    else
-        return EmptyStr;
-}
+    FArr.Reserve(FArr.GetSize() + count);
 
-/*##########################################################################
-#
-#   Name       : TStringArray::Add
-#
-#   Purpose....: Add entry last
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-void TStringArray::Add(const TString &str)
-{
-    TStringArrayNode *p = new TStringArrayNode(str);
-    TArrayBase::Add(p);
+    for (i = 0; i < count; i++)
+    {
+        entry.FStr = new TString(*src.FArr[i].FStr);
+        FArr.Add(entry);
+    }
 }
 
 /*##########################################################################
 #
-#   Name       : TStringArray::Add
+#   Name       : TStringArray::Free
 #
-#   Purpose....: Add entry at specified position, if possible.
+#   Purpose....: Delete all strings and release the array
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TStringArray::Add(int pos, const TString &str)
-{
-    TStringArrayNode *p = new TStringArrayNode(str);
-    TArrayBase::Add(pos, p);
-}
 
-/*##########################################################################
-#
-#   Name       : TStringArray::Replace
-#
-#   Purpose....: Replace specified entry
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-void TStringArray::Replace(int pos, const TString &str)
+void TStringArray::Free()
 {
-    TStringArrayNode n = TStringArrayNode(str);
-    TArrayBase::Replace(pos, &n);
+    int i;
+
+    for (i = 0; i < FArr.GetSize(); i++)
+        delete FArr[i].FStr;
+
+    FArr.Clear();
 }
 
 /*##########################################################################
 #
 #   Name       : operator+
 #
-#   Purpose....: Concatenation operator
+#   Purpose....: Concat two arrays
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
+
 TStringArray operator+(const TStringArray &arr1, const TStringArray& arr2)
 {
     TStringArray arr;
@@ -32,38 +32,29 @@
 #ifndef _STRARR_H
 #define _STRARR_H
 
-#include "arrbase.h"
+#include "typearr.h"
+#include "section.h"
 #include "str.h"
 
-class TStringArrayNode : public TArrayBaseNode
+/**
+ * @class TStringArrayEntry
+ * @brief Owned string pointer stored by TStringArray.
+ *
+ * Copying an entry copies the pointer only, so inserting, removing and
+ * sorting shift plain pointers instead of reference counted strings.
+ */
+class TStringArrayEntry
 {
 public:
-	TStringArrayNode();
-	TStringArrayNode(const TString &str);
-	TStringArrayNode(const TStringArrayNode &source);
-	virtual ~TStringArrayNode();
+    int operator<(const TStringArrayEntry &dest) const
+    {
+        return *FStr < *dest.FStr;
+    }
 
-	const TStringArrayNode &operator=(const TStringArrayNode &src);
-	int operator==(const TStringArrayNode &dest) const;
-	int operator!=(const TStringArrayNode &dest) const;
-	int operator>(const TStringArrayNode &dest) const;
-	int operator>=(const TStringArrayNode &dest) const;
-	int operator<(const TStringArrayNode &dest) const;
-	int operator<=(const TStringArrayNode &dest) const;
-
-	TString &Get() const;
-	void Set(TString &str);
-
-protected:
-	virtual int Compare(const TStringArrayNode &n2) const;
-	virtual int Compare(const TArrayBaseNode &n2) const;
-	virtual void Load(const TStringArrayNode &src);
-	virtual void Load(const TArrayBaseNode &src);
-	
-	TString *FStr;
+    TString *FStr;
 };
 
-class TStringArray : public TArrayBase
+class TStringArray
 {
 public:
 	TStringArray();
@@ -76,14 +67,26 @@ public:
 
 	TString &Get(int pos);
 	
+	void Clear();
+	int IsEmpty();
+	int GetSize();
+
 	void Add(const TString &str);
 	void Add(int pos, const TString &str);
     void Replace(int pos, const TString &str);
 
+	void Remove();
+	void Remove(int pos);
+
+    void Concat(const TStringArray &src1, const TStringArray &src2); 
+    void Sort();
+
 protected:
-	virtual TStringArrayNode *Clone(const TStringArrayNode *ln) const;
-	virtual TArrayBaseNode *Clone(const TArrayBaseNode *ln) const;
+    void Load(const TStringArray &src);
+    void Free();
 
+	TArray<TStringArrayEntry> FArr;
+    TSection FSection;
 };
 
 TStringArray operator+(const TStringArray& arr1, const TStringArray& arr2);
@@ -36,6 +36,11 @@
 #include <rdos.h>
 #else
 #include <pthread.h>
+#include <sched.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #endif
 
 #include "sigdev.h"
@@ -106,10 +111,15 @@ public:
      *
      * Calls the function pointer `FStartup` with the argument `FPtr`.
      * This method serves as the primary execution routine for the thread
-     * encapsulated by the `TStartThread` class. Once execution is complete,
-     * the current instance of `TStartThread` is deleted to free resources.
+     * encapsulated by the `TStartThread` class.
      */
     void Execute();
+
+    /**
+     * @brief Runs the thread and deletes the thread object once the base
+     *        Run no longer uses it.
+     */
+    virtual void Run();
 };
 
 /**
@@ -142,19 +152,25 @@ TStartThread::~TStartThread()
 }
 
 /**
- * @brief Executes the thread's main function and self-destroys the thread object.
+ * @brief Executes the thread's main function.
  *
  * Invokes the function pointer provided during the thread's initialization,
- * passing the associated pointer as an argument. Once the function execution
- * is complete, the thread object deletes itself to free associated resources.
- *
- * @note This method is responsible for calling the specified startup function
- * and managing the object's lifecycle. Ensure that the object is not accessed
- * after the `Execute` method is called.
+ * passing the associated pointer as an argument.
  */
 void TStartThread::Execute()
 {
     (*(FStartup))(FPtr);
+}
+
+/**
+ * @brief Runs the thread and self-destroys the thread object.
+ *
+ * TThread::Run still updates the running state after Execute returns, so
+ * the object is deleted here, after it has returned.
+ */
+void TStartThread::Run()
+{
+    TThread::Run();
     delete this;
 }
 
@@ -225,6 +241,8 @@ TThread::TThread()
     Owner = 0;
     FThreadName = 0;
     FStopSignal = 0;
+    FPrio = -1;
+    FCore = -1;
 
 #ifndef __RDOS__
     ThreadId = 0;
@@ -250,6 +268,8 @@ TThread::TThread(const char *ThreadName, int StackSize)
     Owner = 0;
     FThreadName = 0;
     FStopSignal = 0;
+    FPrio = -1;
+    FCore = -1;
 
 #ifndef __RDOS__
     ThreadId = 0;
@@ -280,6 +300,8 @@ TThread::TThread(const char *ThreadName, int StackSize, bool Run)
     Owner = 0;
     FThreadName = 0;
     FStopSignal = 0;
+    FPrio = -1;
+    FCore = -1;
 
 #ifndef __RDOS__
     ThreadId = 0;
@@ -343,12 +365,12 @@ void TThread::Terminated()
  */
 void TThread::Stop()
 {
+    FStopSection.Enter();
+
     if (FThreadRunning)
     {
         TSignalDevice FSignal;
 
-        FStopSection.Enter();
-
         FStopSignal = &FSignal;
         FInstalled = false;
 
@@ -360,9 +382,9 @@ void TThread::Stop()
         }
 
         FStopSignal = 0;
-
-        FStopSection.Leave();
     }
+
+    FStopSection.Leave();
 }
 
 /**
@@ -412,7 +434,20 @@ void TThread::Start(const char *ThreadName, int StackSize)
 #ifdef __RDOS__
     RdosCreateThread(ThreadStartup, ThreadName, this, StackSize);
 #else
-    FRet = pthread_create(&ThreadId, NULL, ThreadStartup, this);
+    pthread_attr_t attr;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    if (StackSize)
+    {
+        if (StackSize < PTHREAD_STACK_MIN)
+            StackSize = PTHREAD_STACK_MIN;
+        pthread_attr_setstacksize(&attr, StackSize);
+    }
+
+    FRet = pthread_create(&ThreadId, &attr, ThreadStartup, this);
+    pthread_attr_destroy(&attr);
 #endif
 }
 
@@ -427,12 +462,12 @@ void TThread::Start(const char *ThreadName, int StackSize)
  *                   does not need to persist after the call.
  * @param Prio The priority for the thread. The valid range and behavior depend on the underlying
  *             threading system.
- * @param StackSize The stack size for the thread in bytes. This value may be ignored or adjusted
- *                  based on the platform's threading implementation.
+ * @param StackSize The stack size for the thread in bytes. On POSIX it is raised to
+ *                  PTHREAD_STACK_MIN when smaller.
  *
  * @note On RDOS systems, the thread is created using the RdosCreatePrioThread function, which
  *       directly incorporates the priority and stack size arguments into the thread creation.
- *       On non-RDOS systems, the thread is created using the pthread_create function.
+ *       On non-RDOS systems, the priority is applied as a nice value when the thread starts.
  *
  * @warning Ensure that the provided ThreadName is not null. Additionally, resources such as
  *          the allocated FThreadName must be properly managed to avoid memory leaks.
@@ -443,10 +478,25 @@ void TThread::Start(const char *ThreadName, int Prio, int StackSize)
     FThreadName = new char[size];
     strcpy(FThreadName, ThreadName);
 
+    FPrio = Prio;
+
 #ifdef __RDOS__
     RdosCreatePrioThread(ThreadStartup, Prio, ThreadName, this, StackSize);
 #else
-    FRet = pthread_create(&ThreadId, NULL, ThreadStartup, this);
+    pthread_attr_t attr;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    if (StackSize)
+    {
+        if (StackSize < PTHREAD_STACK_MIN)
+            StackSize = PTHREAD_STACK_MIN;
+        pthread_attr_setstacksize(&attr, StackSize);
+    }
+
+    FRet = pthread_create(&ThreadId, &attr, ThreadStartup, this);
+    pthread_attr_destroy(&attr);
 #endif
 }
 
@@ -461,8 +511,10 @@ void TThread::Start(const char *ThreadName, int Prio, int StackSize)
  * - It invokes the Execute function, which contains the thread's core logic.
  * - Ensures synchronization by entering and leaving the stop section while updating
  *   the thread's running state.
- * - On supported platforms, a stop signal is optionally sent to signal thread shutdown.
  * - After execution, the Terminated method is called for cleanup or additional processing.
+ * - On supported platforms, a stop signal is optionally sent to signal thread shutdown.
+ *   The object may be deleted by Stop as soon as the stop section is left, so
+ *   nothing is accessed after that.
  *
  * @note This method should not be called directly unless managing the
  *       thread's lifecycle explicitly.
@@ -473,7 +525,9 @@ void TThread::Run()
     if (!FThreadRunning)
     {
         FThreadRunning = true;
+        Setup();
         Execute();
+        Terminated();
 
         FStopSection.Enter();
         FThreadRunning = false;
@@ -482,9 +536,81 @@ void TThread::Run()
             FStopSignal->Signal();
 
         FStopSection.Leave();
+    }
+}
 
-        Terminated();
+/**
+ * @brief Applies core affinity and priority in the new thread.
+ *
+ * Called from Run in the context of the new thread. RDOS sets the priority
+ * at creation, so only the core is applied there. On POSIX the RDOS priority
+ * is mapped to nice 1 - Prio, so priority 1 is normal and higher priorities
+ * need privileges; failures are ignored.
+ */
+void TThread::Setup()
+{
+#ifdef __RDOS__
+    if (FCore >= 0)
+        RdosMoveToCore(FCore);
+#else
+    int nice;
+
+    if (FCore >= 0)
+    {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        CPU_SET(FCore, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
     }
+
+    if (FPrio >= 0)
+    {
+        nice = 1 - FPrio;
+
+        if (nice < -20)
+            nice = -20;
+
+        if (nice > 19)
+            nice = 19;
+
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice);
+    }
+#endif
+}
+
+/**
+ * @brief Sets the core the thread should run on.
+ *
+ * Must be called before the thread is started. A negative core lets the
+ * scheduler pick any core.
+ *
+ * @param Core Zero-based core number.
+ */
+void TThread::SetCore(int Core)
+{
+    FCore = Core;
+}
+
+/**
+ * @brief Returns the number of active cores.
+ *
+ * @return Number of cores, at least 1.
+ */
+int TThread::GetCoreCount()
+{
+    int count;
+
+#ifdef __RDOS__
+    count = RdosGetActiveCores();
+#else
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    if (count < 1)
+        count = 1;
+
+    return count;
 }
 
 /**
@@ -71,6 +71,8 @@ public:
     virtual void Terminated();
     virtual void Stop();
     bool IsRunning() const;
+    void SetCore(int Core);
+    static int GetCoreCount();
     void *Owner;
 
 protected:
@@ -136,6 +138,21 @@ protected:
   */
  virtual void Execute();
 
+ /**
+  * @var FPrio
+  * @brief Requested priority, or -1 for default.
+  *
+  * RDOS applies the priority when the thread is created. On POSIX it is
+  * mapped to a nice value when the thread starts.
+  */
+ int FPrio;
+
+ /**
+  * @var FCore
+  * @brief Core the thread should run on, or -1 for any core.
+  */
+ int FCore;
+
  /**
   * @var FInstalled
   * @brief Indicates whether the thread object is currently installed and operational.
@@ -223,6 +240,8 @@ protected:
   */
 private:
     bool FThreadRunning;
+
+    void Setup();
 };
 
 #endif
@@ -0,0 +1,961 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# thrpool.cpp
+# Thread pool with work-stealing task queues
+#
+########################################################################*/
+
+#include <string.h>
+#include <stdio.h>
+
+#ifdef __RDOS__
+#include <rdos.h>
+#endif
+
+#include "thrpool.h"
+
+static TSection TaskSection("Task");
+static TSection DefaultSection("ThreadPool.Default");
+static TThreadPool *DefaultPool = 0;
+
+/**
+ * @brief Shared state of a ParallelFor call.
+ *
+ * Workers grab chunks of Grain indexes until the range is exhausted, so
+ * uneven iterations are balanced without creating one task per chunk.
+ */
+class TParallelFor
+{
+public:
+    TParallelFor(int Start, int End, int Grain, void (*Func)(void *ptr, int Index), void *ptr);
+
+    void Process();
+
+private:
+    bool Grab(int *Start, int *End);
+
+    TSection FSection;
+    int FNext;
+    int FEnd;
+    int FGrain;
+    void (*FFunc)(void *ptr, int Index);
+    void *FPtr;
+};
+
+/**
+ * @brief Task that runs part of a ParallelFor.
+ */
+class TParallelForTask : public TTask
+{
+public:
+    TParallelForTask(TParallelFor *pf);
+
+protected:
+    virtual void Execute();
+
+    TParallelFor *FFor;
+};
+
+/**
+ * @brief Constructs a task that is not yet submitted.
+ */
+TTask::TTask()
+{
+    FPool = 0;
+    FThen = 0;
+    FThenNext = 0;
+    FWaitList = 0;
+    FDone = false;
+    FAutoDelete = false;
+}
+
+/**
+ * @brief Destructor. A submitted task must be done before it is deleted.
+ */
+TTask::~TTask()
+{
+}
+
+/**
+ * @brief Checks if the task has been executed.
+ *
+ * @return true if done.
+ */
+bool TTask::IsDone()
+{
+    bool done;
+
+    TaskSection.Enter();
+    done = FDone;
+    TaskSection.Leave();
+
+    return done;
+}
+
+/**
+ * @brief Waits until the task is done.
+ *
+ * If the calling thread is a worker of the pool, it executes other tasks
+ * while waiting.
+ */
+void TTask::Wait()
+{
+    TThreadPool *pool;
+
+    TaskSection.Enter();
+    pool = FPool;
+    TaskSection.Leave();
+
+    if (pool)
+        pool->Wait(this);
+    else
+    {
+        TSignalDevice Signal;
+        TTaskWaiter waiter;
+
+        waiter.Signal = &Signal;
+
+        TaskSection.Enter();
+
+        while (!FDone)
+        {
+            AddWaiter(&waiter);
+            TaskSection.Leave();
+            Signal.WaitForever();
+            TaskSection.Enter();
+            RemoveWaiter(&waiter);
+        }
+
+        TaskSection.Leave();
+    }
+}
+
+/**
+ * @brief Adds a waiter to be signalled when the task is done. Called with
+ *        TaskSection taken.
+ *
+ * @param waiter Waiter to add.
+ */
+void TTask::AddWaiter(TTaskWaiter *waiter)
+{
+    waiter->Next = FWaitList;
+    FWaitList = waiter;
+}
+
+/**
+ * @brief Removes a waiter if it is still in the list. Called with
+ *        TaskSection taken.
+ *
+ * @param waiter Waiter to remove.
+ */
+void TTask::RemoveWaiter(TTaskWaiter *waiter)
+{
+    TTaskWaiter **link = &FWaitList;
+
+    while (*link)
+    {
+        if (*link == waiter)
+        {
+            *link = waiter->Next;
+            break;
+        }
+        link = &(*link)->Next;
+    }
+}
+
+/**
+ * @brief Adds a continuation.
+ *
+ * The continuation is submitted to the same pool when this task is done, or
+ * immediately if it already is done.
+ *
+ * @param task Continuation task.
+ */
+void TTask::Then(TTask *task)
+{
+    bool done;
+
+    TaskSection.Enter();
+
+    done = FDone;
+    if (!done)
+    {
+        task->FThenNext = FThen;
+        FThen = task;
+    }
+
+    TaskSection.Leave();
+
+    if (done)
+    {
+        if (FPool)
+            FPool->Submit(task);
+        else
+            TThreadPool::GetDefault()->Submit(task);
+    }
+}
+
+/**
+ * @brief Executes the task, then signals all waiters and submits continuations.
+ *
+ * The task may be deleted by its waiter as soon as it is marked done, so
+ * everything needed afterwards is copied first.
+ */
+void TTask::Run()
+{
+    TThreadPool *pool = FPool;
+    TTask *then;
+    TTask *next;
+    TTaskWaiter *waiter;
+    bool autodelete = FAutoDelete;
+
+    Execute();
+
+    TaskSection.Enter();
+
+    then = FThen;
+    FThen = 0;
+    FDone = true;
+
+    for (waiter = FWaitList; waiter; waiter = waiter->Next)
+        waiter->Signal->Signal();
+
+    FWaitList = 0;
+
+    TaskSection.Leave();
+
+    while (then)
+    {
+        next = then->FThenNext;
+        then->FThenNext = 0;
+        pool->Submit(then);
+        then = next;
+    }
+
+    if (autodelete)
+        delete this;
+}
+
+/**
+ * @brief Constructs a function task.
+ *
+ * @param Func Function to call.
+ * @param ptr  Pointer passed to the function.
+ */
+TFuncTask::TFuncTask(void (*Func)(void *ptr), void *ptr)
+{
+    FFunc = Func;
+    FPtr = ptr;
+}
+
+/**
+ * @brief Destructor for function task.
+ */
+TFuncTask::~TFuncTask()
+{
+}
+
+/**
+ * @brief Calls the function.
+ */
+void TFuncTask::Execute()
+{
+    (*FFunc)(FPtr);
+}
+
+/**
+ * @brief Constructs an empty task queue.
+ */
+TTaskDeque::TTaskDeque()
+  : FSection("Task.Queue")
+{
+    FSize = 64;
+    FArr = new TTask *[FSize];
+    FHead = 0;
+    FCount = 0;
+}
+
+/**
+ * @brief Destructor for task queue.
+ */
+TTaskDeque::~TTaskDeque()
+{
+    delete[] FArr;
+}
+
+/**
+ * @brief Doubles the size of the ring buffer. Called with the section taken.
+ */
+void TTaskDeque::Grow()
+{
+    TTask **arr;
+    int i;
+
+    arr = new TTask *[2 * FSize];
+
+    for (i = 0; i < FCount; i++)
+        arr[i] = FArr[(FHead + i) % FSize];
+
+    delete[] FArr;
+
+    FArr = arr;
+    FSize *= 2;
+    FHead = 0;
+}
+
+/**
+ * @brief Pushes a task at the bottom of the queue.
+ *
+ * @param task Task to add.
+ */
+void TTaskDeque::Push(TTask *task)
+{
+    FSection.Enter();
+
+    if (FCount == FSize)
+        Grow();
+
+    FArr[(FHead + FCount) % FSize] = task;
+    FCount++;
+
+    FSection.Leave();
+}
+
+/**
+ * @brief Pops the most recently pushed task.
+ *
+ * @return Task, or 0 if queue is empty.
+ */
+TTask *TTaskDeque::Pop()
+{
+    TTask *task = 0;
+
+    FSection.Enter();
+
+    if (FCount)
+    {
+        FCount--;
+        task = FArr[(FHead + FCount) % FSize];
+    }
+
+    FSection.Leave();
+
+    return task;
+}
+
+/**
+ * @brief Steals the oldest task.
+ *
+ * @return Task, or 0 if queue is empty.
+ */
+TTask *TTaskDeque::Steal()
+{
+    TTask *task = 0;
+
+    FSection.Enter();
+
+    if (FCount)
+    {
+        task = FArr[FHead];
+        FHead = (FHead + 1) % FSize;
+        FCount--;
+    }
+
+    FSection.Leave();
+
+    return task;
+}
+
+/**
+ * @brief Gets number of queued tasks.
+ *
+ * @return Task count.
+ */
+int TTaskDeque::GetCount()
+{
+    int count;
+
+    FSection.Enter();
+    count = FCount;
+    FSection.Leave();
+
+    return count;
+}
+
+/**
+ * @brief Constructs a worker thread. The thread is started with Begin once
+ *        all workers of the pool exist.
+ *
+ * @param pool      Owning pool.
+ * @param index     Worker number.
+ * @param Name      Base name of thread.
+ * @param Prio      Priority, or -1 for default.
+ * @param StackSize Stack size.
+ * @param Core      Core to run on, or -1 for any.
+ */
+TThreadPoolWorker::TThreadPoolWorker(TThreadPool *pool, int index, const char *Name, int Prio, int StackSize, int Core)
+{
+    FPool = pool;
+    FIndex = index;
+    FIdle = false;
+    FPrioReq = Prio;
+    FStackSize = StackSize;
+
+#ifdef __RDOS__
+    FHandle = 0;
+#else
+    FSelf = 0;
+#endif
+
+    snprintf(FName, sizeof(FName), "%.30s %d", Name, index);
+
+    SetCore(Core);
+}
+
+/**
+ * @brief Starts the worker thread. Returns when the thread runs, so it can
+ *        be stopped and identified safely.
+ */
+void TThreadPoolWorker::Begin()
+{
+    if (FPrioReq >= 0)
+        Start(FName, FPrioReq, FStackSize);
+    else
+        Start(FName, FStackSize);
+
+    FStarted.WaitForever();
+}
+
+/**
+ * @brief Destructor for worker. The pool must be shut down first.
+ */
+TThreadPoolWorker::~TThreadPoolWorker()
+{
+    FSignal.Signal();
+    Stop();
+}
+
+/**
+ * @brief Checks if the calling thread is this worker.
+ *
+ * @return true if called from the worker thread.
+ */
+bool TThreadPoolWorker::IsCurrent()
+{
+#ifdef __RDOS__
+    return FHandle == RdosGetThreadHandle();
+#else
+    return FSelf && pthread_equal(FSelf, pthread_self());
+#endif
+}
+
+/**
+ * @brief Worker loop. Runs own tasks first, then steals. Queued tasks are
+ *        drained before the worker exits at shutdown.
+ */
+void TThreadPoolWorker::Execute()
+{
+    TTask *task;
+
+#ifdef __RDOS__
+    FHandle = RdosGetThreadHandle();
+#else
+    FSelf = pthread_self();
+#endif
+
+    FStarted.Signal();
+
+    for (;;)
+    {
+        task = FPool->FindWork(this);
+
+        if (task)
+        {
+            task->Run();
+            continue;
+        }
+
+        FIdle = true;
+
+        task = FPool->FindWork(this);
+        if (task)
+        {
+            FIdle = false;
+            task->Run();
+            continue;
+        }
+
+        if (FPool->FShutdown)
+            break;
+
+        FSignal.WaitForever();
+        FIdle = false;
+    }
+}
+
+/**
+ * @brief Constructs a pool with one worker per core.
+ */
+TThreadPool::TThreadPool()
+  : FSection("ThreadPool")
+{
+    Init("Pool", 0, -1, 0x10000, false);
+}
+
+/**
+ * @brief Constructs a pool with a number of workers.
+ *
+ * @param Threads Number of workers, 0 for one per core.
+ */
+TThreadPool::TThreadPool(int Threads)
+  : FSection("ThreadPool")
+{
+    Init("Pool", Threads, -1, 0x10000, false);
+}
+
+/**
+ * @brief Constructs a pool.
+ *
+ * @param Name      Base name for worker threads.
+ * @param Threads   Number of workers, 0 for one per core.
+ * @param Prio      Worker priority, or -1 for default.
+ * @param StackSize Worker stack size.
+ * @param PinCores  Pin worker n to core n modulo core count.
+ */
+TThreadPool::TThreadPool(const char *Name, int Threads, int Prio, int StackSize, bool PinCores)
+  : FSection("ThreadPool")
+{
+    Init(Name, Threads, Prio, StackSize, PinCores);
+}
+
+/**
+ * @brief Stops the workers after all queued tasks are done. All workers
+ *        are stopped before any is deleted, since idle workers steal from
+ *        the other queues until they exit.
+ */
+TThreadPool::~TThreadPool()
+{
+    int i;
+
+    FShutdown = true;
+
+    for (i = 0; i < FWorkerCount; i++)
+        FWorkerArr[i]->FSignal.Signal();
+
+    for (i = 0; i < FWorkerCount; i++)
+        FWorkerArr[i]->Stop();
+
+    for (i = 0; i < FWorkerCount; i++)
+        delete FWorkerArr[i];
+
+    delete[] FWorkerArr;
+}
+
+/**
+ * @brief Creates and starts the workers.
+ */
+void TThreadPool::Init(const char *Name, int Threads, int Prio, int StackSize, bool PinCores)
+{
+    int cores = TThread::GetCoreCount();
+    int i;
+
+    if (Threads <= 0)
+        Threads = cores;
+
+    FWorkerCount = Threads;
+    FNextWorker = 0;
+    FShutdown = false;
+    FWorkerArr = new TThreadPoolWorker *[Threads];
+
+    for (i = 0; i < Threads; i++)
+    {
+        if (PinCores)
+            FWorkerArr[i] = new TThreadPoolWorker(this, i, Name, Prio, StackSize, i % cores);
+        else
+            FWorkerArr[i] = new TThreadPoolWorker(this, i, Name, Prio, StackSize, -1);
+    }
+
+    for (i = 0; i < Threads; i++)
+        FWorkerArr[i]->Begin();
+}
+
+/**
+ * @brief Gets the process-wide pool, created on first use with one worker
+ *        per core.
+ *
+ * @return Default pool.
+ */
+TThreadPool *TThreadPool::GetDefault()
+{
+    DefaultSection.Enter();
+
+    if (!DefaultPool)
+        DefaultPool = new TThreadPool("Pool", 0, -1, 0x10000, false);
+
+    DefaultSection.Leave();
+
+    return DefaultPool;
+}
+
+/**
+ * @brief Gets number of workers.
+ *
+ * @return Worker count.
+ */
+int TThreadPool::GetThreadCount() const
+{
+    return FWorkerCount;
+}
+
+/**
+ * @brief Finds the worker of the calling thread.
+ *
+ * @return Worker, or 0 if called from outside the pool.
+ */
+TThreadPoolWorker *TThreadPool::FindWorker()
+{
+    int i;
+
+    for (i = 0; i < FWorkerCount; i++)
+        if (FWorkerArr[i]->IsCurrent())
+            return FWorkerArr[i];
+
+    return 0;
+}
+
+/**
+ * @brief Finds a task to run. Own queue first, then steal from the others
+ *        starting with the next worker.
+ *
+ * @param worker Worker looking for work, or 0 for a non-worker thread.
+ *
+ * @return Task, or 0 if all queues are empty.
+ */
+TTask *TThreadPool::FindWork(TThreadPoolWorker *worker)
+{
+    TTask *task;
+    int start;
+    int i;
+
+    if (worker)
+    {
+        task = worker->FQueue.Pop();
+        if (task)
+            return task;
+
+        start = worker->FIndex + 1;
+    }
+    else
+        start = 0;
+
+    for (i = 0; i < FWorkerCount; i++)
+    {
+        TThreadPoolWorker *victim = FWorkerArr[(start + i) % FWorkerCount];
+
+        if (victim != worker)
+        {
+            task = victim->FQueue.Steal();
+            if (task)
+                return task;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Wakes one idle worker so it can steal queued work.
+ *
+ * @param except Worker that should not be woken.
+ */
+void TThreadPool::WakeIdle(TThreadPoolWorker *except)
+{
+    TThreadPoolWorker *worker;
+    int i;
+
+    for (i = 0; i < FWorkerCount; i++)
+    {
+        worker = FWorkerArr[i];
+        if (worker != except && worker->FIdle)
+        {
+            worker->FSignal.Signal();
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Submits a task.
+ *
+ * Tasks submitted from a worker are queued on that worker, other tasks are
+ * distributed round robin.
+ *
+ * @param task Task to run.
+ */
+void TThreadPool::Submit(TTask *task)
+{
+    TThreadPoolWorker *worker;
+    int index;
+
+    TaskSection.Enter();
+    task->FPool = this;
+    task->FDone = false;
+    TaskSection.Leave();
+
+    worker = FindWorker();
+
+    if (worker)
+    {
+        worker->FQueue.Push(task);
+        WakeIdle(worker);
+    }
+    else
+    {
+        FSection.Enter();
+        index = FNextWorker;
+        FNextWorker = (FNextWorker + 1) % FWorkerCount;
+        FSection.Leave();
+
+        worker = FWorkerArr[index];
+        worker->FQueue.Push(task);
+        worker->FSignal.Signal();
+    }
+}
+
+/**
+ * @brief Runs a function in the pool without waiting for the result.
+ *
+ * @param Func Function to call.
+ * @param ptr  Pointer passed to the function.
+ */
+void TThreadPool::Run(void (*Func)(void *ptr), void *ptr)
+{
+    TFuncTask *task = new TFuncTask(Func, ptr);
+
+    task->FAutoDelete = true;
+    Submit(task);
+}
+
+/**
+ * @brief Waits for a task. Workers run other tasks while waiting.
+ *
+ * @param task Task to wait for.
+ */
+void TThreadPool::Wait(TTask *task)
+{
+    TThreadPoolWorker *worker;
+    TSignalDevice *local = 0;
+    TTaskWaiter waiter;
+    TTask *other;
+
+    worker = FindWorker();
+
+    if (worker)
+        waiter.Signal = &worker->FSignal;
+    else
+        waiter.Signal = 0;
+
+    TaskSection.Enter();
+
+    while (!task->FDone)
+    {
+        TaskSection.Leave();
+
+        if (worker)
+        {
+            other = FindWork(worker);
+            if (other)
+            {
+                other->Run();
+                TaskSection.Enter();
+                continue;
+            }
+        }
+
+        TaskSection.Enter();
+
+        if (!task->FDone)
+        {
+            if (!waiter.Signal)
+            {
+                TaskSection.Leave();
+                local = new TSignalDevice;
+                waiter.Signal = local;
+                TaskSection.Enter();
+                continue;
+            }
+
+            task->AddWaiter(&waiter);
+            TaskSection.Leave();
+            waiter.Signal->WaitForever();
+            TaskSection.Enter();
+            task->RemoveWaiter(&waiter);
+        }
+    }
+
+    TaskSection.Leave();
+
+    if (local)
+        delete local;
+}
+
+/**
+ * @brief Calls Func for every index in [Start, End).
+ *
+ * The calling thread takes part in the work. Grain is the number of indexes
+ * grabbed at a time, 0 selects about four chunks per worker.
+ *
+ * @param Start First index.
+ * @param End   End index, not included.
+ * @param Grain Chunk size.
+ * @param Func  Function to call.
+ * @param ptr   Pointer passed to the function.
+ */
+void TThreadPool::ParallelFor(int Start, int End, int Grain, void (*Func)(void *ptr, int Index), void *ptr)
+{
+    TParallelForTask **arr;
+    int chunks;
+    int count;
+    int i;
+
+    if (End <= Start)
+        return;
+
+    if (Grain <= 0)
+    {
+        Grain = (End - Start) / (4 * FWorkerCount);
+        if (Grain < 1)
+            Grain = 1;
+    }
+
+    TParallelFor pf(Start, End, Grain, Func, ptr);
+
+    chunks = (End - Start + Grain - 1) / Grain;
+
+    count = chunks - 1;
+    if (count > FWorkerCount)
+        count = FWorkerCount;
+
+    arr = 0;
+
+    if (count > 0)
+    {
+        arr = new TParallelForTask *[count];
+
+        for (i = 0; i < count; i++)
+        {
+            arr[i] = new TParallelForTask(&pf);
+            Submit(arr[i]);
+        }
+    }
+
+    pf.Process();
+
+    for (i = 0; i < count; i++)
+    {
+        Wait(arr[i]);
+        delete arr[i];
+    }
+
+    if (arr)
+        delete[] arr;
+}
+
+/**
+ * @brief Constructs ParallelFor state.
+ */
+TParallelFor::TParallelFor(int Start, int End, int Grain, void (*Func)(void *ptr, int Index), void *ptr)
+  : FSection("ParallelFor")
+{
+    FNext = Start;
+    FEnd = End;
+    FGrain = Grain;
+    FFunc = Func;
+    FPtr = ptr;
+}
+
+/**
+ * @brief Grabs the next chunk.
+ *
+ * @param Start First index of chunk.
+ * @param End   End index of chunk.
+ *
+ * @return false when the range is exhausted.
+ */
+bool TParallelFor::Grab(int *Start, int *End)
+{
+    bool ok = false;
+
+    FSection.Enter();
+
+    if (FNext < FEnd)
+    {
+        *Start = FNext;
+
+        if (FEnd - FNext > FGrain)
+            FNext += FGrain;
+        else
+            FNext = FEnd;
+
+        *End = FNext;
+        ok = true;
+    }
+
+    FSection.Leave();
+
+    return ok;
+}
+
+/**
+ * @brief Processes chunks until the range is exhausted.
+ */
+void TParallelFor::Process()
+{
+    int start;
+    int end;
+    int i;
+
+    while (Grab(&start, &end))
+        for (i = start; i < end; i++)
+            (*FFunc)(FPtr, i);
+}
+
+/**
+ * @brief Constructs a ParallelFor task.
+ */
+TParallelForTask::TParallelForTask(TParallelFor *pf)
+{
+    FFor = pf;
+}
+
+/**
+ * @brief Processes chunks.
+ */
+void TParallelForTask::Execute()
+{
+    FFor->Process();
+}
@@ -0,0 +1,210 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# thrpool.h
+# Thread pool with work-stealing task queues
+#
+########################################################################*/
+
+#ifndef _THRPOOL_H
+#define _THRPOOL_H
+
+#include "section.h"
+#include "sigdev.h"
+#include "thread.h"
+
+class TThreadPool;
+class TThreadPoolWorker;
+
+/**
+ * @brief A thread waiting for a TTask. Lives on the stack of the waiter.
+ */
+struct TTaskWaiter
+{
+    TSignalDevice *Signal;
+    TTaskWaiter *Next;
+};
+
+/**
+ * @class TTask
+ * @brief A unit of work that can be submitted to a TThreadPool.
+ *
+ * Derived classes implement Execute and keep their own result members, so a
+ * submitted task also acts as the future for its result. Any number of
+ * threads can wait for a task, and continuations added with Then are
+ * submitted to the same pool when the task is done.
+ */
+class TTask
+{
+friend class TThreadPool;
+friend class TThreadPoolWorker;
+public:
+    TTask();
+    virtual ~TTask();
+
+    bool IsDone();
+    void Wait();
+    void Then(TTask *task);
+
+protected:
+    virtual void Execute() = 0;
+
+private:
+    void Run();
+    void AddWaiter(TTaskWaiter *waiter);
+    void RemoveWaiter(TTaskWaiter *waiter);
+
+    TThreadPool *FPool;
+    TTask *FThen;
+    TTask *FThenNext;
+    TTaskWaiter *FWaitList;
+    bool FDone;
+    bool FAutoDelete;
+};
+
+/**
+ * @class TFuncTask
+ * @brief A task that calls a function with a user pointer.
+ */
+class TFuncTask : public TTask
+{
+public:
+    TFuncTask(void (*Func)(void *ptr), void *ptr);
+    virtual ~TFuncTask();
+
+protected:
+    virtual void Execute();
+
+    void (*FFunc)(void *ptr);
+    void *FPtr;
+};
+
+/**
+ * @class TTaskDeque
+ * @brief Per-worker task queue.
+ *
+ * The owning worker pushes and pops at the bottom (LIFO, cache friendly),
+ * while other workers steal from the top (FIFO, oldest and usually largest
+ * work first).
+ */
+class TTaskDeque
+{
+public:
+    TTaskDeque();
+    ~TTaskDeque();
+
+    void Push(TTask *task);
+    TTask *Pop();
+    TTask *Steal();
+    int GetCount();
+
+private:
+    void Grow();
+
+    TSection FSection;
+    TTask **FArr;
+    int FSize;
+    int FHead;
+    int FCount;
+};
+
+/**
+ * @class TThreadPoolWorker
+ * @brief Worker thread of a TThreadPool.
+ */
+class TThreadPoolWorker : public TThread
+{
+friend class TThreadPool;
+public:
+    TThreadPoolWorker(TThreadPool *pool, int index, const char *Name, int Prio, int StackSize, int Core);
+    virtual ~TThreadPoolWorker();
+
+    void Begin();
+    bool IsCurrent();
+
+protected:
+    virtual void Execute();
+
+    TThreadPool *FPool;
+    int FIndex;
+    TTaskDeque FQueue;
+    TSignalDevice FSignal;
+    TSignalDevice FStarted;
+    bool FIdle;
+
+    char FName[40];
+    int FPrioReq;
+    int FStackSize;
+
+#ifdef __RDOS__
+    int FHandle;
+#else
+    pthread_t FSelf;
+#endif
+};
+
+/**
+ * @class TThreadPool
+ * @brief A fixed set of worker threads executing tasks with work stealing.
+ *
+ * Tasks submitted from a worker go to that worker's own queue, other tasks
+ * are spread over the workers. Idle workers steal from the other queues.
+ * Waiting for a task from inside a worker executes other tasks meanwhile,
+ * so nested parallel work cannot deadlock the pool.
+ */
+class TThreadPool
+{
+friend class TThreadPoolWorker;
+public:
+    TThreadPool();
+    TThreadPool(int Threads);
+    TThreadPool(const char *Name, int Threads, int Prio, int StackSize, bool PinCores);
+    ~TThreadPool();
+
+    static TThreadPool *GetDefault();
+
+    int GetThreadCount() const;
+
+    void Submit(TTask *task);
+    void Run(void (*Func)(void *ptr), void *ptr);
+    void Wait(TTask *task);
+
+    void ParallelFor(int Start, int End, int Grain, void (*Func)(void *ptr, int Index), void *ptr);
+
+protected:
+    void Init(const char *Name, int Threads, int Prio, int StackSize, bool PinCores);
+    TThreadPoolWorker *FindWorker();
+    TTask *FindWork(TThreadPoolWorker *worker);
+    void WakeIdle(TThreadPoolWorker *except);
+
+    TSection FSection;
+    TThreadPoolWorker **FWorkerArr;
+    int FWorkerCount;
+    int FNextWorker;
+    bool FShutdown;
+};
+
+#endif
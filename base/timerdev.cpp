@@ -0,0 +1,322 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# timerdev.cpp
+# Timer device class
+#
+########################################################################*/
+
+#include <string.h>
+#include "timerdev.h"
+
+#ifdef __RDOS__
+#include <rdos.h>
+#else
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#endif
+
+#ifdef __RDOS__
+static TSection TimerSection("Timer.Device");
+#endif
+
+/**
+ * @brief Constructor for the TTimerDevice class.
+ *
+ * Creates the timer in the stopped state. Use Set or SetPeriodic to start it.
+ */
+TTimerDevice::TTimerDevice()
+{
+    Init();
+}
+
+/**
+ * @brief Destructor for the TTimerDevice class.
+ *
+ * Stops the timer and releases the signal or timerfd used for waiting.
+ */
+TTimerDevice::~TTimerDevice()
+{
+    Cancel();
+
+#ifdef __RDOS__
+    RdosFreeSignal(FSignal);
+#else
+    if (FHandle != -1)
+        close(FHandle);
+#endif
+}
+
+/**
+ * @brief Allocates the platform resources of the timer.
+ */
+void TTimerDevice::Init()
+{
+#ifdef __RDOS__
+    FSignal = RdosCreateSignal();
+    FTimer = 0;
+    FPeriod = 0;
+    FActive = false;
+#else
+    FHandle = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#endif
+}
+
+/**
+ * @brief Retrieves the name of the device.
+ *
+ * @param Name Buffer that receives the device name.
+ * @param MaxLen Size of the buffer.
+ */
+void TTimerDevice::DeviceName(char *Name, int MaxLen) const
+{
+    strncpy(Name, "TIMER", MaxLen);
+}
+
+#ifdef __RDOS__
+/**
+ * @brief Application timer callback. Sets the signal and reloads periodic timers.
+ *
+ * @param Param The TTimerDevice that started the timer.
+ */
+void TTimerDevice::TimerExpired(void *Param)
+{
+    TTimerDevice *dev = (TTimerDevice *)Param;
+
+    TimerSection.Enter();
+
+    if (dev->FActive)
+    {
+        RdosSetSignal(dev->FSignal);
+
+        if (dev->FPeriod)
+            RdosRestartCurrentAppTimer(dev->FPeriod);
+        else
+            dev->FActive = false;
+    }
+
+    TimerSection.Leave();
+}
+#endif
+
+/**
+ * @brief Starts the timer, replacing any earlier setting.
+ *
+ * A pending expiry from the earlier setting is discarded.
+ *
+ * @param MilliSec Time to first expiry in milliseconds.
+ * @param Period Reload interval in milliseconds, or 0 for a one-shot timer.
+ */
+void TTimerDevice::Arm(int MilliSec, int Period)
+{
+    Cancel();
+
+    if (MilliSec < 1)
+        MilliSec = 1;
+
+#ifdef __RDOS__
+    TimerSection.Enter();
+    FPeriod = Period;
+    FActive = true;
+    FTimer = RdosStartAppTimer(TimerExpired, this, MilliSec);
+    TimerSection.Leave();
+#else
+    struct itimerspec spec;
+
+    spec.it_value.tv_sec = MilliSec / 1000;
+    spec.it_value.tv_nsec = 1000000 * (MilliSec % 1000);
+    spec.it_interval.tv_sec = Period / 1000;
+    spec.it_interval.tv_nsec = 1000000 * (Period % 1000);
+
+    if (FHandle != -1)
+        timerfd_settime(FHandle, 0, &spec, 0);
+#endif
+}
+
+/**
+ * @brief Starts a one-shot timer.
+ *
+ * @param MilliSec Time to expiry in milliseconds.
+ */
+void TTimerDevice::Set(int MilliSec)
+{
+    Arm(MilliSec, 0);
+}
+
+/**
+ * @brief Starts a periodic timer that expires every MilliSec milliseconds.
+ *
+ * @param MilliSec Interval in milliseconds.
+ */
+void TTimerDevice::SetPeriodic(int MilliSec)
+{
+    if (MilliSec < 1)
+        MilliSec = 1;
+
+    Arm(MilliSec, MilliSec);
+}
+
+/**
+ * @brief Stops the timer and discards any expiry that has not been waited for.
+ */
+void TTimerDevice::Cancel()
+{
+#ifdef __RDOS__
+    TimerSection.Enter();
+    if (FActive)
+    {
+        RdosStopAppTimer(FTimer);
+        FActive = false;
+    }
+    RdosResetSignal(FSignal);
+    TimerSection.Leave();
+#else
+    struct itimerspec spec;
+
+    if (FHandle != -1)
+    {
+        memset(&spec, 0, sizeof(spec));
+        timerfd_settime(FHandle, 0, &spec, 0);
+        ConsumeWait();
+    }
+#endif
+}
+
+/**
+ * @brief Adds the timer to a multi-object wait.
+ *
+ * @param Wait The wait object.
+ */
+void TTimerDevice::Add(TWait *Wait)
+{
+#ifdef __RDOS__
+    RdosAddWaitForSignal(Wait->GetHandle(), FSignal, (int)this);
+#else
+    if (FHandle != -1)
+        Wait->AddHandle(FHandle, this);
+#endif
+}
+
+#ifndef __RDOS__
+/**
+ * @brief Reads the expiration count from the timerfd.
+ *
+ * Several expirations of a periodic timer that happened before the read are
+ * merged into one wakeup.
+ *
+ * @return true if the timer had expired.
+ */
+bool TTimerDevice::ConsumeWait()
+{
+    uint64_t count;
+
+    if (read(FHandle, &count, sizeof(count)) == sizeof(count))
+        return count != 0;
+    else
+        return false;
+}
+#endif
+
+#ifndef __RDOS__
+/**
+ * @brief Waits for the timer to expire for at most MilliSec milliseconds.
+ *
+ * @param MilliSec Timeout in milliseconds, or -1 to wait forever.
+ * @return true if the timer expired, false on timeout.
+ */
+bool TTimerDevice::WaitTimeout(int MilliSec)
+{
+    struct pollfd pfd;
+    int count;
+
+    pfd.fd = FHandle;
+    pfd.events = POLLIN;
+
+    for (;;)
+    {
+        count = poll(&pfd, 1, MilliSec);
+
+        if (count < 0 && errno == EINTR)
+            continue;
+
+        if (count <= 0)
+            return false;
+
+        if (ConsumeWait())
+        {
+            SignalNewData();
+            return true;
+        }
+
+        if (MilliSec == 0)
+            return false;
+    }
+}
+#endif
+
+#ifndef __RDOS__
+/**
+ * @brief Waits until the timer expires.
+ *
+ * @return true when the timer has expired.
+ */
+bool TTimerDevice::WaitForever()
+{
+    return WaitTimeout(-1);
+}
+#endif
+
+#ifndef __RDOS__
+/**
+ * @brief Waits for the timer to expire, but not beyond the given time.
+ *
+ * @param time Local time when the wait gives up.
+ * @return true if the timer expired, false if the time was reached first.
+ */
+bool TTimerDevice::WaitUntil(TDateTime &time)
+{
+    TDateTime now;
+    long long diff;
+
+    diff = time.GetLinuxMilliTimestamp() - now.GetLinuxMilliTimestamp();
+    if (diff < 0)
+        diff = 0;
+    if (diff > 0x7FFFFFFF)
+        diff = 0x7FFFFFFF;
+
+    return WaitTimeout((int)diff);
+}
+#endif
+
+/**
+ * @brief Notifies that the timer has expired. Does nothing by default.
+ */
+void TTimerDevice::SignalNewData()
+{
+}
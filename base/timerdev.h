@@ -0,0 +1,114 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# timerdev.h
+# Timer device class
+#
+########################################################################*/
+
+#ifndef _TIMERDEV_H
+#define _TIMERDEV_H
+
+#include "waitdev.h"
+
+/**
+ * @class TTimerDevice
+ * @brief A one-shot or periodic timer that can be waited on, derived from TWaitDevice.
+ *
+ * The timer becomes ready when it expires, so it can be combined with signals
+ * and other devices in a single TWait instead of polling with timeouts. On RDOS
+ * it is built on an application timer that sets a kernel signal. On Linux it
+ * is a timerfd, so expiry is reported by epoll without a helper thread.
+ */
+class TTimerDevice : public TWaitDevice
+{
+public:
+    TTimerDevice();
+    virtual ~TTimerDevice();
+
+    virtual void DeviceName(char *Name, int MaxLen) const;
+
+    void Set(int MilliSec);
+    void SetPeriodic(int MilliSec);
+    void Cancel();
+
+#ifndef __RDOS__
+    virtual bool WaitForever();
+    virtual bool WaitTimeout(int MilliSec);
+    virtual bool WaitUntil(TDateTime &time);
+#endif
+
+protected:
+    /**
+     * @brief Called from the waiting thread each time the timer has expired.
+     *
+     * Derived classes override this to run the periodic work.
+     */
+    virtual void SignalNewData();
+
+    virtual void Add(TWait *Wait);
+
+#ifndef __RDOS__
+    virtual bool ConsumeWait();
+#endif
+
+private:
+    void Init();
+    void Arm(int MilliSec, int Period);
+
+#ifdef __RDOS__
+    static void TimerExpired(void *Param);
+
+    /**
+     * @var FSignal
+     * @brief Kernel signal set when the timer expires.
+     */
+    int FSignal;
+    /**
+     * @var FTimer
+     * @brief Index of the running application timer.
+     */
+    int FTimer;
+    /**
+     * @var FPeriod
+     * @brief Reload interval in milliseconds, or 0 for a one-shot timer.
+     */
+    int FPeriod;
+    /**
+     * @var FActive
+     * @brief True while an application timer is running.
+     */
+    bool FActive;
+#else
+    /**
+     * @var FHandle
+     * @brief timerfd descriptor, readable while expirations are pending.
+     */
+    int FHandle;
+#endif
+};
+
+#endif
@@ -0,0 +1,649 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# typearr.h
+# Contiguous typed array templates
+#
+########################################################################*/
+
+#ifndef _TYPEARR_H
+#define _TYPEARR_H
+
+#include <new>
+
+/**
+ * @class TArray
+ * @brief Growable array that stores elements of type T contiguously.
+ *
+ * Unlike TArrayBase there is no node object per element and no virtual
+ * Compare/Load, so iteration walks plain memory. T needs a copy constructor,
+ * an assignment operator and, for Sort and the sorted variants, operator<.
+ * The array does not lock; the owner serializes access when it is shared
+ * between threads. References returned by Get are invalidated when the
+ * array grows.
+ *
+ * Without rvalue references, elements are relocated by copy construction
+ * followed by destruction, and Add(pos) and Remove(pos) shift elements by
+ * assignment. For TString every copy takes the string's lock, so arrays
+ * that insert in the middle should hold pointers, as TStringArray does.
+ * Swap transfers a whole array in constant time.
+ */
+template <class T> class TArray
+{
+public:
+    TArray()
+    {
+        Init();
+    }
+
+    TArray(const TArray<T> &src)
+    {
+        Init();
+        Load(src);
+    }
+
+    ~TArray()
+    {
+        Clear();
+    }
+
+    TArray<T> &operator=(const TArray<T> &src)
+    {
+        if (this != &src)
+        {
+            Clear();
+            Load(src);
+        }
+        return *this;
+    }
+
+    T &operator[](int pos)
+    {
+        return FArr[pos];
+    }
+
+    const T &operator[](int pos) const
+    {
+        return FArr[pos];
+    }
+
+    T &Get(int pos)
+    {
+        return FArr[pos];
+    }
+
+    const T &Get(int pos) const
+    {
+        return FArr[pos];
+    }
+
+    T *GetData()
+    {
+        return FArr;
+    }
+
+    const T *GetData() const
+    {
+        return FArr;
+    }
+
+    int GetSize() const
+    {
+        return FCount;
+    }
+
+    int IsEmpty() const
+    {
+        return FCount == 0;
+    }
+
+    // Destroy all elements and release the storage
+    void Clear()
+    {
+        int i;
+
+        for (i = 0; i < FCount; i++)
+            FArr[i].~T();
+
+        if (FArr)
+            delete[] (char *)FArr;
+
+        Init();
+    }
+
+    // Make room for at least size elements without further allocation
+    void Reserve(int size)
+    {
+        if (size > FAllocSize)
+            Realloc(size);
+    }
+
+    // Append an element
+    void Add(const T &x)
+    {
+        if (FCount == FAllocSize)
+        {
+            T tmp(x);
+
+            Grow();
+            new (FArr + FCount) T(tmp);
+        }
+        else
+            new (FArr + FCount) T(x);
+
+        FCount++;
+    }
+
+    // Insert an element before pos. Positions past the end append
+    void Add(int pos, const T &x)
+    {
+        int i;
+
+        if (pos < 0)
+            return;
+
+        if (pos >= FCount)
+            Add(x);
+        else
+        {
+            T tmp(x);
+
+            if (FCount == FAllocSize)
+                Grow();
+
+            new (FArr + FCount) T(FArr[FCount - 1]);
+
+            for (i = FCount - 1; i > pos; i--)
+                FArr[i] = FArr[i - 1];
+
+            FArr[pos] = tmp;
+            FCount++;
+        }
+    }
+
+    void Replace(int pos, const T &x)
+    {
+        if (pos >= 0 && pos < FCount)
+            FArr[pos] = x;
+    }
+
+    // Remove the last element
+    void Remove()
+    {
+        if (FCount)
+        {
+            FCount--;
+            FArr[FCount].~T();
+        }
+    }
+
+    void Remove(int pos)
+    {
+        int i;
+
+        if (pos < 0 || pos >= FCount)
+            return;
+
+        for (i = pos + 1; i < FCount; i++)
+            FArr[i - 1] = FArr[i];
+
+        FCount--;
+        FArr[FCount].~T();
+    }
+
+    // Linear search using operator==, returns -1 when not found
+    int Find(const T &x) const
+    {
+        int i;
+
+        for (i = 0; i < FCount; i++)
+            if (FArr[i] == x)
+                return i;
+
+        return -1;
+    }
+
+    // Sort in ascending order using operator<
+    void Sort()
+    {
+        if (FCount > 1)
+            QuickSort(0, FCount - 1);
+    }
+
+    // Exchange contents with another array without copying elements
+    void Swap(TArray<T> &src)
+    {
+        T *arr = FArr;
+        int count = FCount;
+        int alloc = FAllocSize;
+
+        FArr = src.FArr;
+        FCount = src.FCount;
+        FAllocSize = src.FAllocSize;
+
+        src.FArr = arr;
+        src.FCount = count;
+        src.FAllocSize = alloc;
+    }
+
+    void Concat(const TArray<T> &src1, const TArray<T> &src2)
+    {
+        TArray<T> arr;
+        int i;
+
+        arr.Reserve(src1.FCount + src2.FCount);
+
+        for (i = 0; i < src1.FCount; i++)
+            arr.Add(src1.FArr[i]);
+
+        for (i = 0; i < src2.FCount; i++)
+            arr.Add(src2.FArr[i]);
+
+        Swap(arr);
+    }
+
+protected:
+    void Init()
+    {
+        FArr = 0;
+        FCount = 0;
+        FAllocSize = 0;
+    }
+
+    void Load(const TArray<T> &src)
+    {
+        int i;
+
+        Reserve(src.FCount);
+
+        for (i = 0; i < src.FCount; i++)
+            new (FArr + i) T(src.FArr[i]);
+
+        FCount = src.FCount;
+    }
+
+    void Grow()
+    {
+        if (FAllocSize)
+            Realloc(2 * FAllocSize);
+        else
+            Realloc(16);
+    }
+
+    void Realloc(int size)
+    {
+        T *arr = (T *)new char[size * sizeof(T)];
+        int i;
+
+        for (i = 0; i < FCount; i++)
+        {
+            new (arr + i) T(FArr[i]);
+            FArr[i].~T();
+        }
+
+        if (FArr)
+            delete[] (char *)FArr;
+
+        FArr = arr;
+        FAllocSize = size;
+    }
+
+    static void SwapElem(T &a, T &b)
+    {
+        T tmp(a);
+
+        a = b;
+        b = tmp;
+    }
+
+    void InsertSort(int first, int last)
+    {
+        int i;
+        int j;
+
+        for (i = first + 1; i <= last; i++)
+            for (j = i; j > first && FArr[j] < FArr[j - 1]; j--)
+                SwapElem(FArr[j], FArr[j - 1]);
+    }
+
+    // Median of three quicksort. Recurses on the smaller part only
+    void QuickSort(int first, int last)
+    {
+        int mid;
+        int i;
+        int j;
+
+        while (last - first > 16)
+        {
+            mid = first + (last - first) / 2;
+
+            if (FArr[mid] < FArr[first])
+                SwapElem(FArr[mid], FArr[first]);
+            if (FArr[last] < FArr[first])
+                SwapElem(FArr[last], FArr[first]);
+            if (FArr[last] < FArr[mid])
+                SwapElem(FArr[last], FArr[mid]);
+
+            SwapElem(FArr[mid], FArr[last - 1]);
+
+            i = first;
+            j = last - 1;
+
+            for (;;)
+            {
+                while (FArr[++i] < FArr[last - 1])
+                    ;
+                while (FArr[last - 1] < FArr[--j])
+                    ;
+                if (i >= j)
+                    break;
+                SwapElem(FArr[i], FArr[j]);
+            }
+
+            SwapElem(FArr[i], FArr[last - 1]);
+
+            if (i - first < last - i)
+            {
+                QuickSort(first, i - 1);
+                first = i + 1;
+            }
+            else
+            {
+                QuickSort(i + 1, last);
+                last = i - 1;
+            }
+        }
+
+        InsertSort(first, last);
+    }
+
+    T *FArr;
+    int FCount;
+    int FAllocSize;
+};
+
+/**
+ * @class TSortedArray
+ * @brief Contiguous array kept in ascending order for binary search.
+ *
+ * Add inserts after any equal elements, so insertion order is kept among
+ * duplicates. Only operator< is used for ordering and lookup.
+ */
+template <class T> class TSortedArray
+{
+public:
+    T &operator[](int pos)
+    {
+        return FArr[pos];
+    }
+
+    const T &operator[](int pos) const
+    {
+        return FArr[pos];
+    }
+
+    const T &Get(int pos) const
+    {
+        return FArr[pos];
+    }
+
+    const T *GetData() const
+    {
+        return FArr.GetData();
+    }
+
+    int GetSize() const
+    {
+        return FArr.GetSize();
+    }
+
+    int IsEmpty() const
+    {
+        return FArr.IsEmpty();
+    }
+
+    void Clear()
+    {
+        FArr.Clear();
+    }
+
+    void Reserve(int size)
+    {
+        FArr.Reserve(size);
+    }
+
+    void Remove(int pos)
+    {
+        FArr.Remove(pos);
+    }
+
+    // Insert an element at its sorted position and return the position
+    int Add(const T &x)
+    {
+        int pos = UpperBound(x);
+
+        FArr.Add(pos, x);
+        return pos;
+    }
+
+    // Position of an element equal to x, or -1
+    int Find(const T &x) const
+    {
+        int pos = LowerBound(x);
+
+        if (pos < FArr.GetSize() && !(x < FArr[pos]))
+            return pos;
+        else
+            return -1;
+    }
+
+    // First position whose element is not less than x
+    int LowerBound(const T &x) const
+    {
+        int low = 0;
+        int high = FArr.GetSize();
+        int mid;
+
+        while (low < high)
+        {
+            mid = low + (high - low) / 2;
+            if (FArr[mid] < x)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+
+    // First position whose element is greater than x
+    int UpperBound(const T &x) const
+    {
+        int low = 0;
+        int high = FArr.GetSize();
+        int mid;
+
+        while (low < high)
+        {
+            mid = low + (high - low) / 2;
+            if (x < FArr[mid])
+                high = mid;
+            else
+                low = mid + 1;
+        }
+        return low;
+    }
+
+    // Take over the contents of an unsorted array and sort it
+    void Load(TArray<T> &src)
+    {
+        FArr.Swap(src);
+        FArr.Sort();
+    }
+
+protected:
+    TArray<T> FArr;
+};
+
+/**
+ * @class TFlatMapEntry
+ * @brief Key/value pair stored by TFlatMap.
+ */
+template <class K, class V> class TFlatMapEntry
+{
+public:
+    TFlatMapEntry()
+    {
+    }
+
+    TFlatMapEntry(const K &key, const V &value)
+      : Key(key),
+        Value(value)
+    {
+    }
+
+    K Key;
+    V Value;
+};
+
+/**
+ * @class TFlatMap
+ * @brief Map from K to V stored as one contiguous array sorted by key.
+ *
+ * Lookup is a binary search over the keys. Inserting and removing shift
+ * the entries after the position, which is cheap for the small and
+ * read-mostly tables this is intended for.
+ */
+template <class K, class V> class TFlatMap
+{
+public:
+    int GetSize() const
+    {
+        return FArr.GetSize();
+    }
+
+    int IsEmpty() const
+    {
+        return FArr.IsEmpty();
+    }
+
+    void Clear()
+    {
+        FArr.Clear();
+    }
+
+    void Reserve(int size)
+    {
+        FArr.Reserve(size);
+    }
+
+    const K &GetKey(int pos) const
+    {
+        return FArr[pos].Key;
+    }
+
+    V &GetValue(int pos)
+    {
+        return FArr[pos].Value;
+    }
+
+    const V &GetValue(int pos) const
+    {
+        return FArr[pos].Value;
+    }
+
+    // Position of key, or -1
+    int Find(const K &key) const
+    {
+        int pos = LowerBound(key);
+
+        if (pos < FArr.GetSize() && !(key < FArr[pos].Key))
+            return pos;
+        else
+            return -1;
+    }
+
+    // Pointer to the value for key, or 0
+    V *Get(const K &key)
+    {
+        int pos = Find(key);
+
+        if (pos >= 0)
+            return &FArr[pos].Value;
+        else
+            return 0;
+    }
+
+    const V *Get(const K &key) const
+    {
+        int pos = Find(key);
+
+        if (pos >= 0)
+            return &FArr[pos].Value;
+        else
+            return 0;
+    }
+
+    // Insert or replace the value for key
+    void Set(const K &key, const V &value)
+    {
+        int pos = LowerBound(key);
+
+        if (pos < FArr.GetSize() && !(key < FArr[pos].Key))
+            FArr[pos].Value = value;
+        else
+            FArr.Add(pos, TFlatMapEntry<K, V>(key, value));
+    }
+
+    void Remove(const K &key)
+    {
+        int pos = Find(key);
+
+        if (pos >= 0)
+            FArr.Remove(pos);
+    }
+
+protected:
+    int LowerBound(const K &key) const
+    {
+        int low = 0;
+        int high = FArr.GetSize();
+        int mid;
+
+        while (low < high)
+        {
+            mid = low + (high - low) / 2;
+            if (FArr[mid].Key < key)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+
+    TArray<TFlatMapEntry<K, V> > FArr;
+};
+
+#endif
@@ -33,6 +33,14 @@
 
 #ifdef __RDOS__
 #include <rdos.h>
+#else
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #endif
 
 /*##########################################################################
@@ -57,6 +65,12 @@ static void ThreadStartup(void *ptr)
 {
     ((TWait *)ptr)->Execute();
 }
+#else
+static void *ThreadStartup(void *ptr)
+{
+    ((TWait *)ptr)->Execute();
+    return 0;
+}
 #endif
 
 /**
@@ -152,6 +166,22 @@ void TWaitDevice::Remove(TWait *Wait)
 }
 #endif
 
+/**
+ * @brief Consumes the wakeup that made the device ready in a TWait.
+ *
+ * The default implementation is used by devices whose handle stays readable
+ * for as long as they have data, such as sockets, and always reports the
+ * device as ready.
+ *
+ * @return Always true.
+ */
+#ifndef __RDOS__
+bool TWaitDevice::ConsumeWait()
+{
+    return true;
+}
+#endif
+
 /**
  * @brief Waits indefinitely until an external condition or signal is fulfilled.
  *
@@ -268,21 +298,31 @@ void TWaitDevice::Execute()
 }
 #endif
 
-#ifdef __RDOS__
-
 /**
  * @brief Constructs a TWait object and initializes the wait mechanism.
  *
  * This constructor initializes the internal handle using RdosCreateWait
  * and sets the initial states for the installed flag, thread running status,
- * and wait list pointer.
+ * and wait list pointer. On Linux the handle is an epoll instance, and an
+ * eventfd is registered with it so that Abort can interrupt a wait.
  *
  * @return A newly constructed TWait object with initialized properties.
  */
 TWait::TWait()
  : FListSection("Wait.List")
 {
+#ifdef __RDOS__
     FHandle = RdosCreateWait();
+#else
+    struct epoll_event ev;
+
+    FHandle = epoll_create1(EPOLL_CLOEXEC);
+    FAbortHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = 0;
+    epoll_ctl(FHandle, EPOLL_CTL_ADD, FAbortHandle, &ev);
+#endif
 
     FInstalled = true;
     FThreadRunning = false;
@@ -304,21 +344,38 @@ TWait::~TWait()
 
     FInstalled = false;
 
+#ifdef __RDOS__
     if (FThreadRunning)
         RdosStopWait(FHandle);
 
     while (FThreadRunning)
         RdosWaitMilli(25);
+#else
+    if (FThreadRunning)
+        Abort();
+
+    while (FThreadRunning)
+        usleep(25000);
+#endif
 
     while (FWaitList)
     {
         ptr = FWaitList->List;
+#ifdef __RDOS__
                 FWaitList->WaitDev->Remove(this);
+#else
+        RemoveHandle(FWaitList);
+#endif
         delete FWaitList;
         FWaitList = ptr;
     }
 
+#ifdef __RDOS__
     RdosCloseWait(FHandle);
+#else
+    close(FAbortHandle);
+    close(FHandle);
+#endif
 }
 
 /**
@@ -337,6 +394,8 @@ int TWait::GetHandle()
  * This method creates a new entry in the wait list and associates the provided
  * `TWaitDevice` instance with this `TWait` object. It ensures thread-safety by
  * entering and leaving a critical section while modifying the wait list.
+ * On Linux the entry is linked before the device registers its handle, so
+ * that AddHandle can record the descriptor in it.
  *
  * @param dev A pointer to the `TWaitDevice` instance to be added to the wait list.
  *            This device will be monitored or interacted with by the `TWait` instance.
@@ -345,6 +404,7 @@ void TWait::Add(TWaitDevice *dev)
 {
     TWaitList *entry = new TWaitList;
     
+#ifdef __RDOS__
     dev->Add(this);
 
     FListSection.Enter();
@@ -352,6 +412,16 @@ void TWait::Add(TWaitDevice *dev)
     entry->List = FWaitList;
     FWaitList = entry;
     FListSection.Leave();
+#else
+    FListSection.Enter();
+    entry->WaitDev = dev;
+    entry->Handle = -1;
+    entry->List = FWaitList;
+    FWaitList = entry;
+    FListSection.Leave();
+
+    dev->Add(this);
+#endif
 }
 
 /**
@@ -378,9 +448,13 @@ void TWait::Remove(TWaitDevice *dev)
         ptr = ptr->List;
     }
 
-    if (ptr->WaitDev == dev)
+    if (ptr)
     {
+#ifdef __RDOS__
         dev->Remove(this);
+#else
+        RemoveHandle(ptr);
+#endif
 
         if (prev == 0)
             FWaitList = FWaitList->List;
@@ -393,6 +467,58 @@ void TWait::Remove(TWaitDevice *dev)
     FListSection.Leave();
 }
 
+#ifndef __RDOS__
+/**
+ * @brief Registers a pollable file descriptor for a device in the wait.
+ *
+ * Called by a device from its Add(TWait *) method. The descriptor is watched
+ * for readability, and the device is returned from the wait methods when it
+ * becomes readable and the device confirms it through ConsumeWait.
+ *
+ * @param Handle File descriptor to watch.
+ * @param dev The device that owns the descriptor.
+ */
+void TWait::AddHandle(int Handle, TWaitDevice *dev)
+{
+    TWaitList *ptr;
+    struct epoll_event ev;
+
+    FListSection.Enter();
+
+    ptr = FWaitList;
+    while (ptr && ptr->WaitDev != dev)
+        ptr = ptr->List;
+
+    if (ptr && ptr->Handle == -1)
+    {
+        ev.events = EPOLLIN;
+        ev.data.ptr = dev;
+        if (epoll_ctl(FHandle, EPOLL_CTL_ADD, Handle, &ev) == 0)
+            ptr->Handle = Handle;
+    }
+
+    FListSection.Leave();
+}
+#endif
+
+#ifndef __RDOS__
+/**
+ * @brief Unregisters the file descriptor of a wait list entry from epoll.
+ *
+ * @param entry The wait list entry. Its handle is reset to -1.
+ */
+void TWait::RemoveHandle(TWaitList *entry)
+{
+    struct epoll_event ev;
+
+    if (entry->Handle != -1)
+    {
+        epoll_ctl(FHandle, EPOLL_CTL_DEL, entry->Handle, &ev);
+        entry->Handle = -1;
+    }
+}
+#endif
+
 /**
  * @brief Starts a new thread with the specified name and stack size.
  *
@@ -406,14 +532,114 @@ void TWait::Remove(TWaitDevice *dev)
  */
 void TWait::StartThreadHandler(const char *ThreadName, int StackSize)
 {
+#ifdef __RDOS__
     RdosCreateThread(ThreadStartup, ThreadName, this, StackSize);
+#else
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    if (StackSize < PTHREAD_STACK_MIN)
+        StackSize = PTHREAD_STACK_MIN;
+
+    FThreadRunning = true;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&attr, StackSize);
+
+    if (pthread_create(&thread, &attr, ThreadStartup, this))
+        FThreadRunning = false;
+
+    pthread_attr_destroy(&attr);
+#endif
 }
 
+#ifndef __RDOS__
+/**
+ * @brief Waits on the epoll handle until a device is ready or a deadline passes.
+ *
+ * Wakeups from the abort eventfd drain it and end the wait. Wakeups from a
+ * device are confirmed through ConsumeWait, and stale ones are ignored
+ * while the remaining time is recalculated.
+ *
+ * @param Deadline Absolute CLOCK_MONOTONIC time in milliseconds, or -1 to wait forever.
+ * @return The ready device, or 0 on timeout or abort.
+ */
+TWaitDevice *TWait::Poll(long long Deadline)
+{
+    struct epoll_event ev;
+    struct timespec ts;
+    TWaitDevice *dev;
+    long long now;
+    uint64_t val;
+    int timeout;
+    int count;
+
+    for (;;)
+    {
+        if (Deadline == -1)
+            timeout = -1;
+        else
+        {
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            now = (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+            if (now >= Deadline)
+                timeout = 0;
+            else if (Deadline - now > 0x7FFFFFFF)
+                timeout = 0x7FFFFFFF;
+            else
+                timeout = (int)(Deadline - now);
+        }
+
+        count = epoll_wait(FHandle, &ev, 1, timeout);
+
+        if (count < 0 && errno == EINTR)
+            continue;
+
+        if (count <= 0)
+            return 0;
+
+        dev = (TWaitDevice *)ev.data.ptr;
+        if (!dev)
+        {
+            read(FAbortHandle, &val, sizeof(val));
+            return 0;
+        }
+
+        if (dev->ConsumeWait())
+            return dev;
+
+        if (timeout == 0)
+            return 0;
+    }
+}
+#endif
+
+#ifndef __RDOS__
+/**
+ * @brief Converts a relative timeout to an absolute deadline for Poll.
+ *
+ * @param MilliSec Timeout in milliseconds.
+ * @return Absolute CLOCK_MONOTONIC time in milliseconds.
+ */
+static long long GetDeadline(long long MilliSec)
+{
+    struct timespec ts;
+
+    if (MilliSec < 0)
+        MilliSec = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000 + MilliSec;
+}
+#endif
+
 /**
  * @brief Checks the current wait state and retrieves the associated device.
  *
  * This method calls `RdosCheckWait` internally using the current handle (`FHandle`)
  * and returns a pointer to the corresponding `TWaitDevice` instance, if available.
+ * On Linux it polls the epoll handle without blocking.
  *
  * @return A pointer to a `TWaitDevice` object representing the device associated
  * with the current wait state. Returns `nullptr` if no device is associated or
@@ -421,7 +647,11 @@ void TWait::StartThreadHandler(const char *ThreadName, int StackSize)
  */
 TWaitDevice *TWait::Check()
 {
+#ifdef __RDOS__
     return (TWaitDevice *)RdosCheckWait(FHandle);
+#else
+    return Poll(GetDeadline(0));
+#endif
 }
 
 /**
@@ -436,7 +666,11 @@ TWaitDevice *TWait::WaitForever()
 {
     TWaitDevice *Wait;
 
+#ifdef __RDOS__
     Wait = (TWaitDevice *)RdosWaitForever(FHandle);
+#else
+    Wait = Poll(-1);
+#endif
     if (Wait)
         Wait->SignalNewData();
 
@@ -459,7 +693,11 @@ TWaitDevice *TWait::WaitTimeout(int MilliSec)
 {
     TWaitDevice *Wait;
 
+#ifdef __RDOS__
     Wait = (TWaitDevice *)RdosWaitTimeout(FHandle, MilliSec);
+#else
+    Wait = Poll(GetDeadline(MilliSec));
+#endif
     if (Wait)
         Wait->SignalNewData();
 
@@ -476,7 +714,8 @@ TWaitDevice *TWait::WaitTimeout(int MilliSec)
  * @param time Reference to a TDateTime object representing the target time
  *             for the wait operation. The time is internally converted to
  *             high and low components (MSB and LSB) as required by the
- *             underlying implementation.
+ *             underlying implementation. On Linux it is converted to a
+ *             monotonic deadline so that clock adjustments do not stretch the wait.
  *
  * @return A pointer to a TWaitDevice object if the wait operation is successful
  *         and a relevant device is available. Returns nullptr if the wait fails
@@ -486,7 +725,13 @@ TWaitDevice *TWait::WaitUntil(TDateTime &time)
 {
     TWaitDevice *Wait;
 
+#ifdef __RDOS__
     Wait = (TWaitDevice *)RdosWaitUntilTimeout(FHandle, time.GetMsb(), time.GetLsb());
+#else
+    TDateTime now;
+
+    Wait = Poll(GetDeadline(time.GetLinuxMilliTimestamp() - now.GetLinuxMilliTimestamp()));
+#endif
     if (Wait)
         Wait->SignalNewData();
 
@@ -499,11 +744,17 @@ TWaitDevice *TWait::WaitUntil(TDateTime &time)
  * This method stops any ongoing wait operation associated with the current
  * instance by calling the underlying system function RdosStopWait.
  * It uses the handle stored in the instance to specify the wait operation
- * to be aborted.
+ * to be aborted. On Linux the abort eventfd is written instead.
  */
 void TWait::Abort()
 {
+#ifdef __RDOS__
     RdosStopWait(FHandle);
+#else
+    uint64_t val = 1;
+
+    write(FAbortHandle, &val, sizeof(val));
+#endif
 }
 
 /**
@@ -523,9 +774,16 @@ void TWait::Execute()
 
     while (FInstalled)
     {
+#ifdef __RDOS__
         Wait = (TWaitDevice *)RdosWaitForever(FHandle);
+#else
+        Wait = Poll(-1);
+#endif
         if (Wait)
             Wait->SignalNewData();
     }
-}
+
+#ifndef __RDOS__
+    FThreadRunning = false;
 #endif
+}
@@ -35,9 +35,7 @@
 #include "device.h"
 #include "datetime.h"
 
-#ifdef __RDOS__
 class TWait;
-#endif
 
 /**
  * @class TWaitDevice
@@ -50,9 +48,7 @@ class TWait;
  */
 class TWaitDevice : public TDevice
 {
-#ifdef __RDOS__
 friend class TWait;
-#endif
 
 public:
 	TWaitDevice();
@@ -114,9 +110,29 @@ protected:
 #ifdef __RDOS__
     void CreateWait();
 	void Remove(TWait *Wait);
-	virtual void Add(TWait *Wait) = 0;
+#else
+/**
+ * @brief Consumes the wakeup that made the device ready in a TWait.
+ *
+ * Called by TWait after epoll has reported the device's handle as readable,
+ * before SignalNewData. Devices backed by an eventfd or timerfd drain it here
+ * so that the level-triggered handle is quiet again.
+ *
+ * @return true if the device really was ready, false for a stale wakeup.
+ */
+    virtual bool ConsumeWait();
 #endif
 
+/**
+ * @brief Registers the device with a multi-object wait.
+ *
+ * On RDOS the device adds its kernel handle to the wait handle. On Linux
+ * the device passes a pollable file descriptor to TWait::AddHandle.
+ *
+ * @param Wait The wait object the device is added to.
+ */
+	virtual void Add(TWait *Wait) = 0;
+
 /**
  * @brief Abstract method to signal the availability of new data in a device.
  *
@@ -141,7 +157,6 @@ private:
     void Init();
 };
 
-#ifdef __RDOS__
 /**
  * @class TWaitList
  * @brief Represents a linked list of waitable devices, with each node containing a reference to a TWaitDevice and the next TWaitList node.
@@ -179,6 +194,14 @@ public:
      * enabling traversal and management of linked device wait states.
      */
     TWaitList *List;
+
+#ifndef __RDOS__
+    /**
+     * @var int Handle
+     * @brief File descriptor registered with epoll for the device, or -1.
+     */
+    int Handle;
+#endif
 };
 
 class TWait
@@ -202,7 +225,22 @@ public:
 
 	int GetHandle();
 
+#ifndef __RDOS__
+	void AddHandle(int Handle, TWaitDevice *dev);
+#endif
+
 private:
+#ifndef __RDOS__
+    TWaitDevice *Poll(long long Deadline);
+    void RemoveHandle(TWaitList *entry);
+
+    /**
+     * @var int FAbortHandle
+     * @brief eventfd written by Abort to wake up a blocked epoll_wait.
+     */
+    int FAbortHandle;
+#endif
+
 
     /**
      * @var TWaitList *FWaitList
@@ -235,7 +273,7 @@ private:
      *
      * FHandle is a platform-dependent integer value that serves as a unique identifier
      * or reference for performing synchronization and wait-related functionality in
-     * the context of TWait.
+     * the context of TWait. On Linux it is the epoll file descriptor.
      */
     int FHandle;
     /**
@@ -256,7 +294,6 @@ private:
      */
     int FInstalled;
 };
-#endif
 
 #endif
 
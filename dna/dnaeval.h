@@ -37,6 +37,9 @@ public:
 	TDnaEvaluator(TDnaSequence *seq);
 	virtual ~TDnaEvaluator();
 
+	// Called from several pool threads at once by
+	// TDnaPopulation::CreateChildren, so overrides must be thread-safe.
+	// The default only reads FRefSeq and the individual.
 	virtual int Score(TDnaIndividual *ind);
 
 	TDnaSequence *GetSeq();
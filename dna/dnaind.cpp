@@ -51,6 +51,24 @@ TDnaIndividual::TDnaIndividual(int size)
 {
 }
 
+/*##########################################################################
+#
+#   Name       : TDnaIndividual::TDnaIndividual
+#
+#   Purpose....: Constructor for TDnaIndividual
+#
+#   In params..: Initial size
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDnaIndividual::TDnaIndividual(int size, TRandom *Rand)
+ : FMotherSeq(size, Rand),
+	FFatherSeq(size, Rand)
+{
+}
+
 /*##########################################################################
 #
 #   Name       : TDnaIndividual::TDnaIndividual
@@ -86,6 +104,25 @@ TDnaIndividual::TDnaIndividual(TDnaIndividual &Mother, TDnaIndividual &Father, T
 {
 }
 
+/*##########################################################################
+#
+#   Name       : TDnaIndividual::TDnaIndividual
+#
+#   Purpose....: Constructor for TDnaIndividual
+#
+#   In params..: Mother
+#                Father
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDnaIndividual::TDnaIndividual(TDnaIndividual &Mother, TDnaIndividual &Father, TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand)
+ : FMotherSeq(Mother.FMotherSeq, Mother.FFatherSeq, Mutator, CrossOverRate, Rand),
+	FFatherSeq(Father.FMotherSeq, Father.FFatherSeq, Mutator, CrossOverRate, Rand)
+{
+}
+
 /*##########################################################################
 #
 #   Name       : TDnaIndividual::~TDnaIndividual
@@ -35,8 +35,10 @@ class TDnaIndividual
 {
 public:
 	TDnaIndividual(int size);
+	TDnaIndividual(int size, TRandom *Rand);
 	TDnaIndividual(TDnaSequence *seq);
 	 TDnaIndividual(TDnaIndividual &Mother, TDnaIndividual &Father, TDnaMutator *Mutator, int CrossOverRate);
+	TDnaIndividual(TDnaIndividual &Mother, TDnaIndividual &Father, TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand);
 	~TDnaIndividual();
 
 	void Write();
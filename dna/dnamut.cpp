@@ -26,8 +26,10 @@
 ########################################################################*/
 
 #include <string.h>
+#include <math.h>
 
 #include "dnamut.h"
+#include "dnaseq.h"
 #include "rand.h"
 
 #define FALSE 0
@@ -52,7 +54,13 @@ TDnaMutator::TDnaMutator(int size, long double rate)
 	if (rate < 0.0)
 		rate = 0.0;
 
+	FSize = size;
 	FRate = (long)(1000000 * rate) + 1;
+
+	if (FRate < 1000000)
+		FLogKeep = log(1.0 - (double)FRate / 1000000.0);
+	else
+		FLogKeep = 0;
 }
 
 /*##########################################################################
@@ -74,32 +82,44 @@ TDnaMutator::~TDnaMutator()
 #
 #   Name       : TDnaMutator::Mutate
 #
-#   Purpose....: Mutate sequence
+#   Purpose....: Mutate sequence. The distance to the next mutated
+#                base is drawn as a geometric skip instead of one draw per base
 #
-#   In params..: *
+#   In params..: Sequence
+#                Random stream
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TDnaMutator::Mutate(char *seq, int size)
+void TDnaMutator::Mutate(TDnaSequence *seq, TRandom *Rand)
 {
 	int len;
 	int i;
-	char *baseptr;
+	double skip;
 
-	baseptr = seq;
-
-	if (size > FSize)
+	len = seq->GetSize();
+	if (len > FSize)
 		len = FSize;
-	else
-		len = size;
 
-	for (i = 0; i < len; i++)
+	i = -1;
+
+	for (;;)
 	{
-		if (Random(1000000) < FRate)
-			*baseptr = MutateBase(i, *baseptr);
+		i++;
+
+		if (FLogKeep < 0)
+		{
+			skip = log(Rand->GetUniform()) / FLogKeep;
+			if (skip >= (double)(len - i))
+				break;
+
+			i += (int)skip;
+		}
+
+		if (i >= len)
+			break;
 
-		baseptr++;
+		seq->SetBase(i, MutateBase(i, seq->GetBase(i), Rand));
 	}
 }
 
@@ -114,9 +134,9 @@ void TDnaMutator::Mutate(char *seq, int size)
 #   Returns....: *
 #
 ##########################################################################*/
-char TDnaMutator::MutateBase(int index, char base)
+char TDnaMutator::MutateBase(int index, char base, TRandom *Rand)
 {
-	base += (char)Random(3);
+	base += (char)Rand->Get(3);
 	if (base >= 4)
 		base -= 4;
 
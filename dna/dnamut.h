@@ -28,19 +28,23 @@
 #ifndef _DNAMUT_H
 #define _DNAMUT_H
 
+class TRandom;
+class TDnaSequence;
+
 class TDnaMutator
 {
 public:
 	TDnaMutator(int size, long double rate);
 	virtual ~TDnaMutator();
 
-	 virtual void Mutate(char *seq, int size);
+	 virtual void Mutate(TDnaSequence *seq, TRandom *Rand);
 
 protected:
-	virtual char MutateBase(int index, char base);
+	virtual char MutateBase(int index, char base, TRandom *Rand);
 
 	int FSize;
 	long FRate;
+	double FLogKeep;
 };
 
 #endif
@@ -82,3 +82,21 @@ TDnaIndividual *TDnaPair::CreateChild(TDnaMutator *Mutator, int CrossOverRate)
 {
     return new TDnaIndividual(*Mate1, *Mate2, Mutator, CrossOverRate);
 }
+
+/*##########################################################################
+#
+#   Name       : TDnaPair::CreateChild
+#
+#   Purpose....: Create a child
+#
+#   In params..: Mutator
+#                CrossOverRate
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDnaIndividual *TDnaPair::CreateChild(TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand)
+{
+    return new TDnaIndividual(*Mate1, *Mate2, Mutator, CrossOverRate, Rand);
+}
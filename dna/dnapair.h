@@ -37,6 +37,7 @@ public:
     ~TDnaPair();
 
     TDnaIndividual *CreateChild(TDnaMutator *Mutator, int CrossOverRate);
+    TDnaIndividual *CreateChild(TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand);
     
     TDnaIndividual *Mate1;
     TDnaIndividual *Mate2;
@@ -35,6 +35,17 @@
 #define FALSE 0
 #define TRUE !FALSE
 
+struct TDnaWork
+{
+    TDnaPopulation *Pop;
+    TDnaIndividual **IndArr;
+    TDnaEvaluator *Eval;
+    unsigned int *SeedArr;
+    int *SelArr;
+    int *ScoreArr;
+    int Ind;
+};
+
 /*##########################################################################
 #
 #   Name       : TDnaPopulation::TDnaPopulation
@@ -57,6 +68,8 @@ TDnaPopulation::TDnaPopulation(TDnaMutator *Mutator, int CrossOverRate, int SeqS
 
     FPairs = 0;
     FPairArr = 0;
+
+    FPool = 0;
 }
 
 /*##########################################################################
@@ -75,13 +88,13 @@ TDnaPopulation::~TDnaPopulation()
     if (FIndArr)
     {
         FreeIndArr(FIndArr, FSize);
-        delete FIndArr;
+        delete[] FIndArr;
     }
 
     if (FPairArr)
     {
         FreePairArr(FPairArr, FPairs);
-        delete FPairArr;
+        delete[] FPairArr;
     }
 
 }
@@ -107,7 +120,7 @@ TDnaPopulation *TDnaPopulation::Split(int size)
     if (FPairArr)
     {
         FreePairArr(FPairArr, FPairs);
-        delete FPairArr;
+        delete[] FPairArr;
     }
 
     if (size > FSize)
@@ -116,6 +129,7 @@ TDnaPopulation *TDnaPopulation::Split(int size)
     base = FSize - size;
 
     pop = new TDnaPopulation(FMutator, FCrossOverRate, FSeqSize);
+    pop->FPool = FPool;
     
     pop->FSize = size;
     pop->FIndArr = new TDnaIndividual* [size];
@@ -128,7 +142,7 @@ TDnaPopulation *TDnaPopulation::Split(int size)
     for (i = 0; i < size; i++)
         pop->FIndArr[i] = FIndArr[base + i];
 
-    delete FIndArr;
+    delete[] FIndArr;
     FIndArr = NewIndArr;        
     FSize = base;
 
@@ -155,7 +169,7 @@ void TDnaPopulation::Merge(TDnaPopulation *pop)
     if (FPairArr)
     {
         FreePairArr(FPairArr, FPairs);
-        delete FPairArr;
+        delete[] FPairArr;
     }
 
     size = FSize + pop->FSize;
@@ -168,11 +182,11 @@ void TDnaPopulation::Merge(TDnaPopulation *pop)
     for (i = 0; i < pop->FSize; i++)
         NewIndArr[FSize + i] = pop->FIndArr[i];
 
-    delete FIndArr;
+    delete[] FIndArr;
     FIndArr = NewIndArr;        
     FSize = size;
 
-    delete pop->FIndArr;
+    delete[] pop->FIndArr;
     pop->FIndArr = 0;
 
     delete pop;
@@ -240,18 +254,46 @@ void TDnaPopulation::FreePairArr(TDnaPair **PairArr, int Size)
 void TDnaPopulation::CreateRandom(int size)
 {
      int i;
+     TDnaWork work;
 
      if (FIndArr)
      {
           FreeIndArr(FIndArr, FSize);
-          delete FIndArr;
+          delete[] FIndArr;
      }
 
      FSize = size;
      FIndArr = new TDnaIndividual* [FSize];
 
+     work.Pop = this;
+     work.IndArr = FIndArr;
+     work.SeedArr = new unsigned int[size];
+
      for (i = 0; i < size; i++)
-          FIndArr[i] = new TDnaIndividual(FSeqSize);
+          work.SeedArr[i] = FRandom.Next();
+
+     GetPool()->ParallelFor(0, size, 1, CreateRandomProc, &work);
+
+     delete[] work.SeedArr;
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaPopulation::CreateRandomProc
+#
+#   Purpose....: Create a random individual, thread pool callback
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaPopulation::CreateRandomProc(void *ptr, int Index)
+{
+    TDnaWork *work = (TDnaWork *)ptr;
+    TRandom rand(work->SeedArr[Index]);
+
+    work->IndArr[Index] = new TDnaIndividual(work->Pop->FSeqSize, &rand);
 }
 
 /*##########################################################################
@@ -272,7 +314,7 @@ void TDnaPopulation::CreateUniform(TDnaSequence *seq, int size)
      if (FIndArr)
      {
           FreeIndArr(FIndArr, FSize);
-          delete FIndArr;
+          delete[] FIndArr;
      }
 
      FSize = size;
@@ -299,6 +341,41 @@ void TDnaPopulation::Set(TDnaMutator *Mutator)
     FMutator = Mutator;
 }
 
+/*##########################################################################
+#
+#   Name       : TDnaPopulation::Set
+#
+#   Purpose....: Set thread pool, 0 selects the default pool
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaPopulation::Set(TThreadPool *Pool)
+{
+    FPool = Pool;
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaPopulation::GetPool
+#
+#   Purpose....: Get thread pool to use
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TThreadPool *TDnaPopulation::GetPool()
+{
+    if (FPool)
+        return FPool;
+    else
+        return TThreadPool::GetDefault();
+}
+
 /*##########################################################################
 #
 #   Name       : TDnaPopulation::GetMatchScore
@@ -362,17 +439,22 @@ int TDnaPopulation::GetMatchScore(TDnaIndividual *ind1, TDnaIndividual *ind2)
 void TDnaPopulation::Pairbond(int tries)
 {
     int *Paired;
+    int *CandArr;
+    int *ScoreArr;
+    int *NewArr;
+    int CandSize;
+    int count;
     int i;
     int j;
     int k;
     int max;
     int p;
-    int score;
+    TDnaWork work;
 
     if (FPairArr)
     {
         FreePairArr(FPairArr, FPairs);
-        delete FPairArr;
+        delete[] FPairArr;
     }
 
     Paired = new int[FSize];
@@ -383,6 +465,13 @@ void TDnaPopulation::Pairbond(int tries)
     FPairs = FSize * 80 / 100 / 2;
     FPairArr = new TDnaPair* [FPairs];
 
+    CandSize = 16;
+    CandArr = new int[CandSize];
+    ScoreArr = new int[CandSize];
+
+    work.Pop = this;
+    work.IndArr = FIndArr;
+
     for (p = 0; p < FPairs; p++)
     {
         for (i = p; i < FSize; i++)
@@ -391,24 +480,47 @@ void TDnaPopulation::Pairbond(int tries)
 
         Paired[i] = TRUE; 
 
-        max = 0;
-        j = p;
+        count = 0;
 
-        for (;;)
+        do
         {
-            k = Random(FSize);
+            do
+                k = FRandom.Get(FSize);
+            while (Paired[k]);
 
-            if (!Paired[k])
+            if (count == CandSize)
             {
-                score = GetMatchScore(FIndArr[i], FIndArr[k]);
-                if (score > max)
-                {
-                    score = max;
-                    j = k;
+                NewArr = new int[2 * CandSize];
+                for (j = 0; j < count; j++)
+                    NewArr[j] = CandArr[j];
+                delete[] CandArr;
+                CandArr = NewArr;
+
+                delete[] ScoreArr;
+                CandSize = 2 * CandSize;
+                ScoreArr = new int[CandSize];
+            }
 
-                    if (Random(tries) == 0)
-                        break;
-                }
+            CandArr[count] = k;
+            count++;
+        }
+        while (FRandom.Get(tries) != 0);
+
+        work.Ind = i;
+        work.SelArr = CandArr;
+        work.ScoreArr = ScoreArr;
+
+        GetPool()->ParallelFor(0, count, 1, ScoreCandidateProc, &work);
+
+        max = 0;
+        j = CandArr[0];
+
+        for (k = 0; k < count; k++)
+        {
+            if (ScoreArr[k] > max)
+            {
+                max = ScoreArr[k];
+                j = CandArr[k];
             }
         }
 
@@ -416,21 +528,42 @@ void TDnaPopulation::Pairbond(int tries)
         FPairArr[p] = new TDnaPair(FIndArr[i], FIndArr[j]);
     }
 
-    delete Paired;            
+    delete[] ScoreArr;
+    delete[] CandArr;
+    delete[] Paired;            
 }
 
 /*##########################################################################
 #
-#   Name       : TDnaPopulation::CreateChildren
+#   Name       : TDnaPopulation::ScoreCandidateProc
 #
-#   Purpose....: Create children
+#   Purpose....: Score a pair-bond candidate, thread pool callback
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TDnaPopulation::CreateChildren()
+void TDnaPopulation::ScoreCandidateProc(void *ptr, int Index)
+{
+    TDnaWork *work = (TDnaWork *)ptr;
+    TDnaIndividual **IndArr = work->IndArr;
+
+    work->ScoreArr[Index] = work->Pop->GetMatchScore(IndArr[work->Ind], IndArr[work->SelArr[Index]]);
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaPopulation::Breed
+#
+#   Purpose....: Select pairs and create children
+#
+#   In params..: ScoreArr      Pair scores, or 0 for random selection
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaPopulation::Breed(int *ScoreArr)
 {
     TDnaIndividual **ChildArr;
     int NewSize;
@@ -438,54 +571,69 @@ void TDnaPopulation::CreateChildren()
     int p;
     int *IndArr;
     int pc;
+    int choose;
+    TDnaWork work;
 
     NewSize = FSize;
     ChildArr = new TDnaIndividual* [NewSize];
 
+    work.Pop = this;
+    work.IndArr = ChildArr;
+    work.SelArr = new int[NewSize];
+    work.SeedArr = new unsigned int[NewSize];
+
     c = 0;
     pc = FPairs;
 
-     IndArr = new int[FPairs];
+    IndArr = new int[FPairs];
 
-     for (p = 0; p < FPairs; p++)
-          IndArr[p] = p;
+    for (p = 0; p < FPairs; p++)
+        IndArr[p] = p;
 
-     while (c < NewSize)
-     {
-        ChildArr[c] = FPairArr[IndArr[0]]->CreateChild(FMutator, FCrossOverRate);
+    while (c < NewSize)
+    {
+        work.SelArr[c] = IndArr[0];
         c++;
 
         for (p = 0; p < pc / 2 && c < NewSize; p++)
         {
-            
-            if (Random(2))
-            {
+            if (ScoreArr)
+                choose = ScoreArr[IndArr[2 * p]] > ScoreArr[IndArr[2 * p + 1]];
+            else
+                choose = FRandom.Get(2);
+
+            if (choose)
                 IndArr[p] = IndArr[2 * p];
-                ChildArr[c] = FPairArr[IndArr[p]]->CreateChild(FMutator, FCrossOverRate);
-            }
-            else                
-            {
+            else
                 IndArr[p] = IndArr[2 * p + 1];
-                ChildArr[c] = FPairArr[IndArr[p]]->CreateChild(FMutator, FCrossOverRate);
-            }
+
+            work.SelArr[c] = IndArr[p];
             c++;
         }
 
         pc = pc / 2;
     }        
 
-    delete IndArr;
+    delete[] IndArr;
+
+    for (c = 0; c < NewSize; c++)
+        work.SeedArr[c] = FRandom.Next();
+
+    GetPool()->ParallelFor(0, NewSize, 1, CreateChildProc, &work);
+
+    delete[] work.SeedArr;
+    delete[] work.SelArr;
 
     if (FIndArr)
     {
         FreeIndArr(FIndArr, FSize);
-        delete FIndArr;
+        delete[] FIndArr;
     }
 
     if (FPairArr)
     {
         FreePairArr(FPairArr, FPairs);
-        delete FPairArr;
+        delete[] FPairArr;
     }
 
     FSize = NewSize;
@@ -495,93 +643,91 @@ void TDnaPopulation::CreateChildren()
 
 /*##########################################################################
 #
-#   Name       : TDnaPopulation::CreateChildren
+#   Name       : TDnaPopulation::CreateChildProc
 #
-#   Purpose....: Create children
+#   Purpose....: Create a child, thread pool callback
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TDnaPopulation::CreateChildren(TDnaEvaluator *eval)
+void TDnaPopulation::CreateChildProc(void *ptr, int Index)
 {
-    TDnaIndividual **ChildArr;
-    int NewSize;
-    int c;
-    int p;
-    int score1;
-    int score2;
-    int val;
-    int *IndArr;
-    int pc;
-    int ind;
+    TDnaWork *work = (TDnaWork *)ptr;
+    TDnaPopulation *pop = work->Pop;
+    TRandom rand(work->SeedArr[Index]);
 
-    NewSize = FSize;
-    ChildArr = new TDnaIndividual* [NewSize];
-
-    c = 0;
-    pc = FPairs;
+    work->IndArr[Index] = pop->FPairArr[work->SelArr[Index]]->CreateChild(pop->FMutator, pop->FCrossOverRate, &rand);
+}
 
-     IndArr = new int[FPairs];
+/*##########################################################################
+#
+#   Name       : TDnaPopulation::CreateChildren
+#
+#   Purpose....: Create children
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaPopulation::CreateChildren()
+{
+    Breed(0);
+}
 
-     for (p = 0; p < FPairs; p++)
-          IndArr[p] = p;
+/*##########################################################################
+#
+#   Name       : TDnaPopulation::ScorePairProc
+#
+#   Purpose....: Score a pair, thread pool callback
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaPopulation::ScorePairProc(void *ptr, int Index)
+{
+    TDnaWork *work = (TDnaWork *)ptr;
+    TDnaPair *pair = work->Pop->FPairArr[Index];
+    int score;
+    int val;
 
-     while (c < NewSize)
-     {
-        ChildArr[c] = FPairArr[IndArr[0]]->CreateChild(FMutator, FCrossOverRate);
-        c++;
+    val = work->Eval->Score(pair->Mate1);
+    score = val * val;
+    val = work->Eval->Score(pair->Mate2);
+    score += val * val;
 
-          for (p = 0; p < pc / 2 && c < NewSize; p++)
-        {
-            ind = IndArr[2 * p];
-            score1 = 0;
-                val = eval->Score(FPairArr[ind]->Mate1);
-                score1 = val * val;
-                val = eval->Score(FPairArr[ind]->Mate2);
-                score1 += val * val;
-
-                ind = IndArr[2 * p + 1];
-                score2 = 0;
-                val = eval->Score(FPairArr[ind]->Mate1);
-                score2 = val * val;
-            val = eval->Score(FPairArr[ind]->Mate2);
-            score2 += val * val;
-            
-            if (score1 > score2)
-            {
-                IndArr[p] = IndArr[2 * p];
-                ChildArr[c] = FPairArr[IndArr[p]]->CreateChild(FMutator, FCrossOverRate);
-            }
-            else                
-            {
-                IndArr[p] = IndArr[2 * p + 1];
-                ChildArr[c] = FPairArr[IndArr[p]]->CreateChild(FMutator, FCrossOverRate);
-            }
-            c++;
-        }
+    work->ScoreArr[Index] = score;
+}
 
-        pc = pc / 2;
-    }        
+/*##########################################################################
+#
+#   Name       : TDnaPopulation::CreateChildren
+#
+#   Purpose....: Create children. Pairs are scored on the thread pool,
+#                so eval->Score must be thread-safe
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaPopulation::CreateChildren(TDnaEvaluator *eval)
+{
+    TDnaWork work;
 
-    delete IndArr;
+    work.Pop = this;
+    work.Eval = eval;
+    work.ScoreArr = new int[FPairs];
 
-    if (FIndArr)
-    {
-        FreeIndArr(FIndArr, FSize);
-        delete FIndArr;
-    }
+    GetPool()->ParallelFor(0, FPairs, 1, ScorePairProc, &work);
 
-    if (FPairArr)
-    {
-        FreePairArr(FPairArr, FPairs);
-        delete FPairArr;
-    }
+    Breed(work.ScoreArr);
 
-    FSize = NewSize;
-    FIndArr = ChildArr;
-    FPairArr = 0;
+    delete[] work.ScoreArr;
 }
 
 /*##########################################################################
@@ -639,11 +785,8 @@ void TDnaPopulation::ExportQuiz(const char *filename, TDnaSequence *ref, TDnaSeq
     int j;
     int k;
     char str[40];
-    char *fseq;
-    char *mseq;
-     char *rseq;
-     char *rseq1;
-     char *rseq2;
+    TDnaSequence *fseq;
+    TDnaSequence *mseq;
      int score;
      int score1;
     int score2;
@@ -668,8 +811,8 @@ void TDnaPopulation::ExportQuiz(const char *filename, TDnaSequence *ref, TDnaSeq
             ind = FIndArr[j];
             if (ind)
             {
-                sum += ind->FFatherSeq.FSeq[i];
-                sum += ind->FMotherSeq.FSeq[i];
+                sum += ind->FFatherSeq.GetBase(i);
+                sum += ind->FMotherSeq.GetBase(i);
                 count++;
             }
         }
@@ -683,10 +826,10 @@ void TDnaPopulation::ExportQuiz(const char *filename, TDnaSequence *ref, TDnaSeq
             ind = FIndArr[j];
             if (ind)
             {
-                val = (long double)ind->FFatherSeq.FSeq[i] - mean;
+                val = (long double)ind->FFatherSeq.GetBase(i) - mean;
                 rsum += val * val;
                 
-                val = (long double)ind->FMotherSeq.FSeq[i] - mean;
+                val = (long double)ind->FMotherSeq.GetBase(i) - mean;
                 rsum += val * val;
             }
         }
@@ -730,11 +873,8 @@ void TDnaPopulation::ExportQuiz(const char *filename, TDnaSequence *ref, TDnaSeq
             file.Write(str);
             file.Write(str);
 
-            rseq = ref->FSeq;
-            rseq1 = ref1->FSeq;
-            rseq2 = ref2->FSeq;
-            fseq = ind->FFatherSeq.FSeq;
-            mseq = ind->FMotherSeq.FSeq;
+            fseq = &ind->FFatherSeq;
+            mseq = &ind->FMotherSeq;
 
             for (j = 0; j < 150; j++)
             {
@@ -743,25 +883,25 @@ void TDnaPopulation::ExportQuiz(const char *filename, TDnaSequence *ref, TDnaSeq
                 score1 = 0;
                 score2 = 0;
 
-                if (fseq[k] == rseq1[k])
+                if (fseq->GetBase(k) == ref1->GetBase(k))
                     score1++;
                 
-                if (mseq[k] == rseq1[k])
+                if (mseq->GetBase(k) == ref1->GetBase(k))
                     score1++;
 
-                if (fseq[k] == rseq2[k])
+                if (fseq->GetBase(k) == ref2->GetBase(k))
                     score2++;                
                 
-                if (mseq[k] == rseq2[k])
+                if (mseq->GetBase(k) == ref2->GetBase(k))
                     score2++;                
 
                 if (score1 && score2)
                 {
-                    if (rseq1[k] == rseq2[k])
+                    if (ref1->GetBase(k) == ref2->GetBase(k))
                         score = score1;
                     else
                     {
-                        if (rseq2[k] == rseq[k])
+                        if (ref2->GetBase(k) == ref->GetBase(k))
                             score = 2 - score2;
                         else
                             score = score2;                        
@@ -770,7 +910,7 @@ void TDnaPopulation::ExportQuiz(const char *filename, TDnaSequence *ref, TDnaSeq
                 else
                     score = score1 + score2;
 
-                score = fseq[k] + mseq[k];
+                score = fseq->GetBase(k) + mseq->GetBase(k);
                 
                 sprintf(str, "\"%d\"", score); 
                 file.Write(str);
@@ -783,7 +923,7 @@ void TDnaPopulation::ExportQuiz(const char *filename, TDnaSequence *ref, TDnaSeq
         }
     }
 
-    delete SdArr;
+    delete[] SdArr;
 }
 
 /*##########################################################################
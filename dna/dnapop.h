@@ -28,6 +28,8 @@
 #ifndef _DNAPOP_H
 #define _DNAPOP_H
 
+#include "rand.h"
+#include "thrpool.h"
 #include "dnamut.h"
 #include "dnaind.h"
 #include "dnaeval.h"
@@ -43,6 +45,7 @@ public:
 	void Merge(TDnaPopulation *pop);
 
 	void Set(TDnaMutator *Mutator);
+	void Set(TThreadPool *Pool);
 
     void CreateRandom(int Size);
 	void CreateUniform(TDnaSequence *seq, int size);
@@ -61,6 +64,13 @@ protected:
     void FreeIndArr(TDnaIndividual **IndArr, int Size);
     void FreePairArr(TDnaPair **PairArr, int Size);
     int GetMatchScore(TDnaIndividual *ind1, TDnaIndividual *ind2);
+    TThreadPool *GetPool();
+    void Breed(int *ScoreArr);
+
+    static void CreateRandomProc(void *ptr, int Index);
+    static void ScoreCandidateProc(void *ptr, int Index);
+    static void ScorePairProc(void *ptr, int Index);
+    static void CreateChildProc(void *ptr, int Index);
 
     TDnaMutator *FMutator;
     int FCrossOverRate;   
@@ -72,6 +82,9 @@ protected:
 	int FPairs;
 	TDnaPair **FPairArr;
 
+    TThreadPool *FPool;
+    TRandom FRandom;
+
 };
 
 #endif
@@ -27,6 +27,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 
 #include "rand.h"
 #include "dnaseq.h"
@@ -34,6 +35,50 @@
 #define FALSE 0
 #define TRUE !FALSE
 
+#define DNA_WORDS(size)     (((size) + DNA_BASES_PER_WORD - 1) / DNA_BASES_PER_WORD)
+#define DNA_LOW_BITS        0x55555555
+
+/*##########################################################################
+#
+#   Name       : PopCount
+#
+#   Purpose....: Count set bits in a word
+#
+#   In params..: Word
+#   Out params.: *
+#   Returns....: Number of set bits
+#
+##########################################################################*/
+static int PopCount(unsigned int x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (int)((x * 0x01010101) >> 24);
+#endif
+}
+
+/*##########################################################################
+#
+#   Name       : DiffMask
+#
+#   Purpose....: Get mask with low bit set for every base that differs
+#
+#   In params..: Packed words
+#   Out params.: *
+#   Returns....: Mask
+#
+##########################################################################*/
+static unsigned int DiffMask(unsigned int a, unsigned int b)
+{
+    unsigned int x = a ^ b;
+
+    return (x | (x >> 1)) & DNA_LOW_BITS;
+}
+
 /*##########################################################################
 #
 #   Name       : TDnaSequence::TDnaSequence
@@ -47,13 +92,26 @@
 ##########################################################################*/
 TDnaSequence::TDnaSequence(int size)
 {
-	 int i;
+    TRandom rand;
 
-	 FSeq = new char[size];
-	 FSize = size;
+    Init(size, &rand);
+}
 
-	 for (i = 0; i < size; i++)
-		FSeq[i] = (char)Random(4);
+/*##########################################################################
+#
+#   Name       : TDnaSequence::TDnaSequence
+#
+#   Purpose....: Constructor for TDnaSequence
+#
+#   In params..: Initial size
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDnaSequence::TDnaSequence(int size, TRandom *Rand)
+{
+    Init(size, Rand);
 }
 
 /*##########################################################################
@@ -73,8 +131,8 @@ TDnaSequence::TDnaSequence(const TDnaSequence &src)
 
     if (src.FSeq)
     {
-        FSeq = new char[FSize];
-        memcpy(FSeq, src.FSeq, FSize);
+        FSeq = new unsigned int[DNA_WORDS(FSize)];
+        memcpy(FSeq, src.FSeq, DNA_WORDS(FSize) * sizeof(unsigned int));
     }
     else
         FSeq = 0;
@@ -94,40 +152,182 @@ TDnaSequence::TDnaSequence(const TDnaSequence &src)
 #
 ##########################################################################*/
 TDnaSequence::TDnaSequence(TDnaSequence &Mother, TDnaSequence &Father, TDnaMutator *Mutator, int CrossOverRate)
+{
+    TRandom rand;
+
+    Init(Mother, Father, Mutator, CrossOverRate, &rand);
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaSequence::TDnaSequence
+#
+#   Purpose....: Constructor for TDnaSequence using meosis
+#
+#   In params..: Mother 
+#                Father
+#                CrossOverRate
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDnaSequence::TDnaSequence(TDnaSequence &Mother, TDnaSequence &Father, TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand)
+{
+    Init(Mother, Father, Mutator, CrossOverRate, Rand);
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaSequence::Init
+#
+#   Purpose....: Create random sequence
+#
+#   In params..: Initial size
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaSequence::Init(int size, TRandom *Rand)
+{
+    int i;
+    int words;
+
+    words = DNA_WORDS(size);
+
+    FSeq = new unsigned int[words];
+    FSize = size;
+
+    for (i = 0; i < words; i++)
+        FSeq[i] = Rand->Next();
+
+    if (size % DNA_BASES_PER_WORD)
+        FSeq[words - 1] &= ((unsigned int)1 << (2 * (size % DNA_BASES_PER_WORD))) - 1;
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaSequence::Init
+#
+#   Purpose....: Create sequence using meosis. Crossover points are
+#                drawn as geometric skips instead of one draw per base
+#
+#   In params..: Mother 
+#                Father
+#                CrossOverRate
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaSequence::Init(TDnaSequence &Mother, TDnaSequence &Father, TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand)
 {
     int size;
     TDnaSequence *seq;
-	int i;
+    int pos;
+    int run;
+    double skip;
+    double LogKeep;
 
     if (Father.FSize > Mother.FSize)
         size = Father.FSize;
     else
         size = Mother.FSize;
         
-	FSeq = new char[size];
+    FSeq = new unsigned int[DNA_WORDS(size)];
+    memset(FSeq, 0, DNA_WORDS(size) * sizeof(unsigned int));
+
+    if (Rand->Get(2))
+        seq = &Mother;
+    else
+        seq = &Father;
 
-	if (Random(2))
-	    seq = &Mother;
-	else
-	    seq = &Father;
+    if (CrossOverRate > 1)
+        LogKeep = log(1.0 - 1.0 / (double)CrossOverRate);
+    else
+        LogKeep = 0;
 
-	for (i = 0; i < seq->FSize; i++)
-	{
-	    FSeq[i] = seq->FSeq[i];
+    pos = 0;
 
-	    if (Random(CrossOverRate) == 0)
-	    {
-	        if (seq == &Mother)
-	            seq = &Father;
-	        else
-	            seq = &Mother;
-	    }
-	}
+    while (pos < seq->FSize)
+    {
+        run = 1;
 
-	FSize = seq->FSize;
+        if (LogKeep < 0)
+        {
+            skip = log(Rand->GetUniform()) / LogKeep;
+            if (skip < (double)(seq->FSize - pos))
+                run += (int)skip;
+            else
+                run += seq->FSize - pos;
+        }
+
+        if (run > seq->FSize - pos)
+        {
+            CopyRange(*seq, pos, seq->FSize);
+            pos = seq->FSize;
+        }
+        else
+        {
+            CopyRange(*seq, pos, pos + run);
+            pos += run;
+
+            if (seq == &Mother)
+                seq = &Father;
+            else
+                seq = &Mother;
+        }
+    }
+
+    FSize = seq->FSize;
 
     if (Mutator)
-        Mutator->Mutate(FSeq, FSize);	
+        Mutator->Mutate(this, Rand);
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaSequence::CopyRange
+#
+#   Purpose....: Copy bases at the same positions from another sequence
+#
+#   In params..: Source
+#                Start position
+#                End position
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaSequence::CopyRange(const TDnaSequence &src, int start, int end)
+{
+    int sw;
+    int ew;
+    unsigned int smask;
+    unsigned int emask;
+
+    if (start >= end)
+        return;
+
+    sw = start / DNA_BASES_PER_WORD;
+    ew = end / DNA_BASES_PER_WORD;
+    smask = ~(((unsigned int)1 << (2 * (start % DNA_BASES_PER_WORD))) - 1);
+    emask = ((unsigned int)1 << (2 * (end % DNA_BASES_PER_WORD))) - 1;
+
+    if (sw == ew)
+    {
+        smask &= emask;
+        FSeq[sw] = (FSeq[sw] & ~smask) | (src.FSeq[sw] & smask);
+        return;
+    }
+
+    FSeq[sw] = (FSeq[sw] & ~smask) | (src.FSeq[sw] & smask);
+
+    if (ew > sw + 1)
+        memcpy(FSeq + sw + 1, src.FSeq + sw + 1, (ew - sw - 1) * sizeof(unsigned int));
+
+    if (emask)
+        FSeq[ew] = (FSeq[ew] & ~emask) | (src.FSeq[ew] & emask);
 }
 
 /*##########################################################################
@@ -144,7 +344,7 @@ TDnaSequence::TDnaSequence(TDnaSequence &Mother, TDnaSequence &Father, TDnaMutat
 TDnaSequence::~TDnaSequence()
 {
     if (FSeq)
-        delete FSeq;
+        delete[] FSeq;
 }
 
 /*##########################################################################
@@ -160,15 +360,18 @@ TDnaSequence::~TDnaSequence()
 ##########################################################################*/
 const TDnaSequence &TDnaSequence::operator=(const TDnaSequence &src)
 {
+    if (this == &src)
+        return *this;
+
     if (FSeq)
-        delete FSeq;
+        delete[] FSeq;
 
     FSize = src.FSize;
 
     if (src.FSeq)
     {
-        FSeq = new char[FSize];
-        memcpy(FSeq, src.FSeq, FSize);
+        FSeq = new unsigned int[DNA_WORDS(FSize)];
+        memcpy(FSeq, src.FSeq, DNA_WORDS(FSize) * sizeof(unsigned int));
     }
     else
         FSeq = 0;
@@ -192,6 +395,45 @@ int TDnaSequence::GetSize() const
     return FSize;
 }
 
+/*##########################################################################
+#
+#   Name       : TDnaSequence::GetBase
+#
+#   Purpose....: Get base at position
+#
+#   In params..: Position
+#   Out params.: *
+#   Returns....: DNA_A, DNA_C, DNA_G or DNA_T
+#
+##########################################################################*/
+char TDnaSequence::GetBase(int pos) const
+{
+    return (char)((FSeq[pos / DNA_BASES_PER_WORD] >> (2 * (pos % DNA_BASES_PER_WORD))) & 3);
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaSequence::SetBase
+#
+#   Purpose....: Set base at position
+#
+#   In params..: Position
+#                Base
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaSequence::SetBase(int pos, char base)
+{
+    unsigned int *ptr;
+    int shift;
+
+    ptr = FSeq + pos / DNA_BASES_PER_WORD;
+    shift = 2 * (pos % DNA_BASES_PER_WORD);
+
+    *ptr = (*ptr & ~((unsigned int)3 << shift)) | ((unsigned int)(base & 3) << shift);
+}
+
 /*##########################################################################
 #
 #   Name       : TDnaSequence::Mutate
@@ -204,9 +446,29 @@ int TDnaSequence::GetSize() const
 #
 ##########################################################################*/
 void TDnaSequence::Mutate(TDnaMutator *Mutator)
+{
+    TRandom rand;
+
+    if (Mutator)
+        Mutator->Mutate(this, &rand);
+}
+
+/*##########################################################################
+#
+#   Name       : TDnaSequence::Mutate
+#
+#   Purpose....: Mutate sequence
+#
+#   In params..: Mutator
+#                Random stream
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TDnaSequence::Mutate(TDnaMutator *Mutator, TRandom *Rand)
 {
     if (Mutator)
-        Mutator->Mutate(FSeq, FSize);	
+        Mutator->Mutate(this, Rand);
 }
 
 /*##########################################################################
@@ -222,29 +484,16 @@ void TDnaSequence::Mutate(TDnaMutator *Mutator)
 ##########################################################################*/
 int TDnaSequence::GetSimilarity(TDnaSequence &other)
 {
-    int i;
-    int size;
-    int count;
-
-    if (FSize < other.FSize)
-        size = FSize;
-    else
-        size = other.FSize;
-
-    count = 0;
-
-    for (i = 0; i < size; i++)
-        if (FSeq[i] == other.FSeq[i])
-            count++;
-
-    return count; 
+    return GetSimilarity(other, FSize);
 }
 
 /*##########################################################################
 #
 #   Name       : TDnaSequence::GetSimilarity
 #
-#   Purpose....: Get similarity count between sequences using score weighting
+#   Purpose....: Get similarity count between sequences using score weighting.
+#                Differences of two words are merged into one mask, since
+#                DiffMask only uses the low bit of each base
 #
 #   In params..: *
 #   Out params.: *
@@ -255,7 +504,11 @@ int TDnaSequence::GetSimilarity(TDnaSequence &other, int size)
 {
     int i;
     int csize;
-    int score;
+    int words;
+    int rest;
+    int diff;
+    unsigned int *a;
+    unsigned int *b;
 
     if (FSize < other.FSize)
         csize = FSize;
@@ -265,13 +518,25 @@ int TDnaSequence::GetSimilarity(TDnaSequence &other, int size)
     if (csize > size)
         csize = size;
 
-    score = 0;
+    if (csize <= 0)
+        return 0;
 
-    for (i = 0; i < csize; i++)
-        if (FSeq[i] == other.FSeq[i])
-            score++;
+    a = FSeq;
+    b = other.FSeq;
+    words = csize / DNA_BASES_PER_WORD;
+    rest = csize % DNA_BASES_PER_WORD;
+    diff = 0;
 
-    return score; 
+    for (i = 0; i + 1 < words; i += 2)
+        diff += PopCount(DiffMask(a[i], b[i]) | (DiffMask(a[i + 1], b[i + 1]) << 1));
+
+    if (i < words)
+        diff += PopCount(DiffMask(a[i], b[i]));
+
+    if (rest)
+        diff += PopCount(DiffMask(a[words], b[words]) & (((unsigned int)1 << (2 * rest)) - 1));
+
+    return csize - diff; 
 }
 
 /*##########################################################################
@@ -289,17 +554,15 @@ char *TDnaSequence::GetSeqText()
 {
     int i;
     char *text;
-    char *inptr;
     char *outptr;
 
     text = new char[FSize + 1];
 
-    inptr = FSeq;
     outptr = text;
     
     for (i = 0; i < FSize; i++)
     {
-        switch (*inptr)
+        switch (GetBase(i))
         {
             case DNA_A:
                 *outptr = 'A';
@@ -316,13 +579,8 @@ char *TDnaSequence::GetSeqText()
             case DNA_T:
                 *outptr = 'T';
                 break;
-
-            default:
-                *outptr = ' ';
-                break;
         }
 
-        inptr++;
         outptr++;
     } 
     *outptr = 0;
@@ -348,7 +606,7 @@ void TDnaSequence::Write()
     text = GetSeqText();
 	 printf(text);
 	 printf("\r\n");
-	 delete text;
+	 delete[] text;
 }
 
 /*##########################################################################
@@ -368,5 +626,5 @@ void TDnaSequence::Write(TFile &File)
 
     text = GetSeqText();
     File.Write(text, strlen(text));
-    delete text;
+    delete[] text;
 }
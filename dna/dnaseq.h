@@ -29,6 +29,7 @@
 #define _DNASEQ_H
 
 #include "file.h"
+#include "rand.h"
 #include "dnamut.h"
 
 #define DNA_A   0
@@ -36,30 +37,40 @@
 #define DNA_G   2
 #define DNA_T   3
 
+#define DNA_BASES_PER_WORD  16
+
 class TDnaSequence
 {
 friend class TDnaPopulation;
 public:
 	TDnaSequence(int size);
+	TDnaSequence(int size, TRandom *Rand);
 	TDnaSequence(const TDnaSequence &source);
 	TDnaSequence(TDnaSequence &Mother, TDnaSequence &Father, TDnaMutator *Mutator, int CrossOverRate);
+	TDnaSequence(TDnaSequence &Mother, TDnaSequence &Father, TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand);
 	~TDnaSequence();
 
 	const TDnaSequence &operator=(const TDnaSequence &src);
 
     void Mutate(TDnaMutator *Mutator);
+    void Mutate(TDnaMutator *Mutator, TRandom *Rand);
 	int GetSimilarity(TDnaSequence &other);
 	int GetSimilarity(TDnaSequence &other, int Count);
 
 	int GetSize() const;
+	char GetBase(int pos) const;
+	void SetBase(int pos, char base);
 
 	void Write();
 	void Write(TFile &File);
 
 protected:
+    void Init(int size, TRandom *Rand);
+    void Init(TDnaSequence &Mother, TDnaSequence &Father, TDnaMutator *Mutator, int CrossOverRate, TRandom *Rand);
+    void CopyRange(const TDnaSequence &src, int start, int end);
     char *GetSeqText();
     
-    char *FSeq;
+    unsigned int *FSeq;
     int FSize;
 };
 
@@ -148,7 +148,7 @@ int TFtpDirEntry::IsDir()
 #   Returns....: *
 #
 ##########################################################################*/
-TFtpFileEntry::TFtpFileEntry(int year, int month, int day, int hour, int min, const char *ename, int esize)
+TFtpFileEntry::TFtpFileEntry(int year, int month, int day, int hour, int min, const char *ename, long long esize)
   : TFtpEntry(year, month, day, hour, min, ename)
 {
     size = esize;
@@ -207,7 +207,7 @@ TFtp::TFtp(long IP, int port, const char *user, const char *passw)
     FSocket = 0;
     FDataSocket = 0;
     OnMsg = 0;
-    FLastCode = -1;
+    FMultiCode = -1;
     FDirList = 0;
     FFileList = 0;
 
@@ -226,6 +226,10 @@ TFtp::TFtp(long IP, int port, const char *user, const char *passw)
     FReady = FALSE;
     FSuccess = FALSE;
     FFile = 0;
+    FRestPos = 0;
+    FGetRemain = -1;
+    FRetrOpen = FALSE;
+    FAbortSent = FALSE;
     FEnabled = FALSE;
     
     Start("FTP", STACK_SIZE);
@@ -423,6 +427,25 @@ void TFtp::SetBinaryMode()
 #
 ##########################################################################*/
 int TFtp::GetFile(const char *remote, TFile *file)
+{
+    return GetFile(remote, file, 0, -1);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtp::GetFile
+#
+#   Purpose....: Get a single file, or a segment of it
+#
+#   In params..: remote        remote file name
+#                file          local file
+#                pos           remote offset, sent with REST when non-zero
+#                size          bytes to get, or -1 to end of file
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TFtp::GetFile(const char *remote, TFile *file, long long pos, long long size)
 {
     int ok = FALSE;
     int tries;
@@ -440,9 +463,14 @@ int TFtp::GetFile(const char *remote, TFile *file)
         FAborted = FALSE;
 
         FFile = file;
-        FFile->SetSize(0);
-        FFile->SetPos(0);
+        if (pos == 0 && size < 0)
+            FFile->SetSize(0);
+        FFile->SetPos(pos);
         FRemoteFile = TString(remote);
+        FRestPos = pos;
+        FGetRemain = size;
+        FRetrOpen = FALSE;
+        FAbortSent = FALSE;
 
         FReady = FALSE;
         FGetFile = TRUE;
@@ -469,12 +497,19 @@ int TFtp::GetFile(const char *remote, TFile *file)
         }
 
         if (FSuccess)
-            break;
+        {
+            while (FDataSocket)
+                RdosWaitMilli(50);
 
+            break;
+        }
     }
     ok = FSuccess;
 
     FGetFile = FALSE;
+    FRestPos = 0;
+    FGetRemain = -1;
+    FAbortSent = FALSE;
 
     FAppSection.Leave();
     return ok;
@@ -821,6 +856,34 @@ int TFtp::GetFile(TString &name, TDateTime &time, int *size)
         while (time.GetMicroSec() != 0)
             time.AddMicro(1);
             
+        *size = (int)FCurrFile->size;
+        return TRUE;
+    }
+    else
+        return FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtp::GetFile
+#
+#   Purpose....: Get info about current file, with 64-bit size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TFtp::GetFile(TString &name, TDateTime &time, long long *size)
+{
+    if (FCurrFile)
+    {
+        name = FCurrFile->name;
+        time = FCurrFile->time;
+
+        while (time.GetMicroSec() != 0)
+            time.AddMicro(1);
+
         *size = FCurrFile->size;
         return TRUE;
     }
@@ -1024,6 +1087,32 @@ void TFtp::SendType(char type)
     }
 }
 
+/*##########################################################################
+#
+#   Name       : TFtp::SendRest
+#
+#   Purpose....: Send rest
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtp::SendRest()
+{
+    char str[40];
+
+    sprintf(str, "REST %lld\r\n", FRestPos);
+
+    NotifyMsg(str);
+
+    if (FSocket)
+    {
+        FSocket->Write(str);
+        FSocket->Push();
+    }
+}
+
 /*##########################################################################
 #
 #   Name       : TFtp::SendRetr
@@ -1045,6 +1134,32 @@ void TFtp::SendRetr()
 
     NotifyMsg(str);
 
+    FRetrOpen = TRUE;
+
+    if (FSocket)
+    {
+        FSocket->Write(str);
+        FSocket->Push();
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TFtp::SendAbor
+#
+#   Purpose....: Send abort, used to end a ranged RETR early
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtp::SendAbor()
+{
+    const char *str = "ABOR\r\n";
+
+    NotifyMsg(str);
+
     if (FSocket)
     {
         FSocket->Write(str);
@@ -1242,6 +1357,23 @@ void TFtp::DecodePasv(const char *param)
 ##########################################################################*/
 void TFtp::HandleResponse(int code, const char *param)
 {
+    if (FAbortSent && code >= 200 && code != 421)
+    {
+        if (FRetrOpen)
+            FRetrOpen = FALSE;
+        else
+        {
+            FAbortSent = FALSE;
+            FSuccess = TRUE;
+            FReady = TRUE;
+            FAppSignal.Signal();
+        }
+        return;
+    }
+
+    if (code >= 200)
+        FRetrOpen = FALSE;
+
     switch (code)
     {
         case 125:
@@ -1276,7 +1408,12 @@ void TFtp::HandleResponse(int code, const char *param)
                 SendList();
 
             if (FGetFile)
-                SendRetr();
+            {
+                if (FRestPos)
+                    SendRest();
+                else
+                    SendRetr();
+            }
 
             if (FWriteFile)
             {
@@ -1313,6 +1450,12 @@ void TFtp::HandleResponse(int code, const char *param)
             SendPassword();
             break;
 
+        case 350:
+            FReady = FALSE;
+            if (FGetFile)
+                SendRetr();
+            break;
+
         case 421:
             FAborted = TRUE;
             FSuccess = FALSE;
@@ -1388,10 +1531,17 @@ void TFtp::HandleResponse(const char *msg)
         codestr[3] = 0;
         code = atoi(codestr);
 
-        if (code != FLastCode)
+        if (FMultiCode >= 0)
+        {
+            if (code == FMultiCode && ptr[3] != '-')
+                FMultiCode = -1;
+        }
+        else
         {
             HandleResponse(code, ptr + 3);
-            FLastCode = code;
+
+            if (ptr[3] == '-')
+                FMultiCode = code;
         }
 
         ptr = strchr(ptr, 0xd);
@@ -1566,7 +1716,7 @@ void TFtp::HandleDirEntry(char *data)
     char dir;
     char attrib[10];
     char *ptr;
-    int size;
+    long long size;
     TDateTime time;
     int year, month, day;
     int hour, min;
@@ -1604,7 +1754,7 @@ void TFtp::HandleDirEntry(char *data)
         if (*data)
         {
             *data = 0;
-            size = atoi(ptr);
+            sscanf(ptr, "%lld", &size);
             data++;
         }
         else
@@ -1815,6 +1965,8 @@ void TFtp::HandleDataSocket()
     char buf[512];
     int count;
     int tries = 0;
+    int cut = FALSE;
+    long long remain = FGetRemain;
 
     FDirData = 0;
     FDirCount = 0;
@@ -1866,7 +2018,24 @@ void TFtp::HandleDataSocket()
                     HandleDirData(buf, count + FDirCount);
 
                 if (FGetFile && FFile)
+                {
+                    if (remain >= 0 && count > remain)
+                        count = (int)remain;
+
                     FFile->Write(buf, count);
+
+                    if (remain >= 0)
+                    {
+                        remain -= count;
+                        if (remain == 0)
+                        {
+                            cut = TRUE;
+                            FAbortSent = TRUE;
+                            FDataSocket->Close();
+                            SendAbor();
+                        }
+                    }
+                }
             }
         }
     }
@@ -1884,7 +2053,7 @@ void TFtp::HandleDataSocket()
         FDataSocket = 0;
     }
 
-    if (!FAborted)
+    if (!FAborted && !cut)
     {
         FReady = TRUE;
             
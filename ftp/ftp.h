@@ -64,12 +64,12 @@ public:
 class TFtpFileEntry : public TFtpEntry
 {
 public:
-    TFtpFileEntry(int year, int month, int day, int hour, int min, const char *name, int size);
+    TFtpFileEntry(int year, int month, int day, int hour, int min, const char *name, long long size);
     virtual ~TFtpFileEntry();
 
     virtual int IsDir();
 
-    int size;
+    long long size;
 
     TFtpFileEntry *next;
 };    
@@ -90,6 +90,7 @@ public:
     void SetAsciiMode();
     void SetBinaryMode();
     int GetFile(const char *remote, TFile *file);
+    int GetFile(const char *remote, TFile *file, long long pos, long long size);
 
     int MkDir(const char *path);
     int CreateFile(const char *remote, TFile *file);
@@ -101,6 +102,7 @@ public:
     TString GetCurrDirName();
     int GetDir(TString &name, TDateTime &time);
     int GetFile(TString &name, TDateTime &time, int *size);
+    int GetFile(TString &name, TDateTime &time, long long *size);
 
     void HandleDataSocket();
 
@@ -113,7 +115,9 @@ protected:
     void SendMkd(const char *path);
     void DecodePwd(const char *param);
     void SendList();
+    void SendRest();
     void SendRetr();
+    void SendAbor();
     void SendStor();
     void SendPasv();
     void SendType(char type);
@@ -154,11 +158,15 @@ protected:
     int FSuccess;
     TFile *FFile;
     TString FRemoteFile;
+    long long FRestPos;
+    long long FGetRemain;
+    int FRetrOpen;
+    int FAbortSent;
 
     int FEnabled;
 
     int FCloseData;    
-    int FLastCode;
+    int FMultiCode;
     TString FCurrDirName;
 
     TSection FSection;
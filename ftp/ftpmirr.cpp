@@ -0,0 +1,755 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftpmirr.cpp
+# FTP mirror client class
+#
+########################################################################*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ftpmirr.h"
+#include "rdos.h"
+
+#define FALSE   0
+#define TRUE    !FALSE
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorFile::TFtpMirrorFile
+#
+#   Purpose....: Constructor for mirrored file
+#
+#   In params..: RemoteDir     remote directory
+#                Name          remote file name
+#                LocalName     local path
+#                Time          remote modify time
+#                Size          remote size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirrorFile::TFtpMirrorFile(const TString &RemoteDir, const TString &Name, const TPathName &LocalName, const TDateTime &Time, long long Size)
+  : FRemoteDir(RemoteDir),
+    FName(Name),
+    FLocalName(LocalName),
+    FTime(Time)
+{
+    FSize = Size;
+    FPending = 0;
+    FFailed = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorFile::~TFtpMirrorFile
+#
+#   Purpose....: Destructor for mirrored file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirrorFile::~TFtpMirrorFile()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorJob::TFtpMirrorJob
+#
+#   Purpose....: Constructor for download job
+#
+#   In params..: File
+#                Pos           remote offset
+#                Size          bytes to get, or -1 for whole file
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirrorJob::TFtpMirrorJob(TFtpMirrorFile *File, long long Pos, long long Size)
+{
+    FFile = File;
+    FPos = Pos;
+    FSize = Size;
+    FList = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorJob::~TFtpMirrorJob
+#
+#   Purpose....: Destructor for download job
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirrorJob::~TFtpMirrorJob()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorWorker::TFtpMirrorWorker
+#
+#   Purpose....: Constructor for mirror worker, owns one control connection
+#
+#   In params..: Mirror
+#                Nr            worker number
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirrorWorker::TFtpMirrorWorker(TFtpMirror *Mirror, int Nr)
+{
+    char name[40];
+
+    FMirror = Mirror;
+    FFtp = new TFtp(Mirror->FIp, Mirror->FPort, Mirror->FUser.GetData(), Mirror->FPassw.GetData());
+
+    sprintf(name, "FTP Mirror %d", Nr);
+    Start(name, 0x4000);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorWorker::~TFtpMirrorWorker
+#
+#   Purpose....: Destructor for mirror worker
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirrorWorker::~TFtpMirrorWorker()
+{
+    Stop();
+
+    FFtp->Disable();
+    delete FFtp;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorWorker::Get
+#
+#   Purpose....: Download one job
+#
+#   In params..: job
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TFtpMirrorWorker::Get(TFtpMirrorJob *job)
+{
+    TFtpMirrorFile *file = job->FFile;
+
+    if (FCurrDir != file->FRemoteDir)
+    {
+        FCurrDir = "";
+
+        if (!FFtp->SetDir(file->FRemoteDir.GetData()))
+            return FALSE;
+
+        FCurrDir = file->FRemoteDir;
+    }
+
+    TFile local = file->FLocalName.OpenFile();
+
+    if (!local.IsOpen())
+        return FALSE;
+
+    return FFtp->GetFile(file->FName.GetData(), &local, job->FPos, job->FSize);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirrorWorker::Execute
+#
+#   Purpose....: Run jobs until mirror stops
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMirrorWorker::Execute()
+{
+    TFtpMirrorJob *job;
+    int ok;
+
+    FFtp->Enable();
+    FFtp->SetBinaryMode();
+
+    for (;;)
+    {
+        job = FMirror->GetJob(this);
+        if (!job)
+            break;
+
+        ok = Get(job);
+        FMirror->JobDone(job, ok);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::TFtpMirror
+#
+#   Purpose....: Constructor for FTP mirror
+#
+#   In params..: IP
+#                Port
+#                User
+#                Passw
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirror::TFtpMirror(long IP, int Port, const char *User, const char *Passw)
+  : FUser(User),
+    FPassw(Passw),
+    FSection("FTP.Mirror")
+{
+    Init(IP, Port, User, Passw, FTP_MIRROR_CONNECTIONS);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::TFtpMirror
+#
+#   Purpose....: Constructor for FTP mirror
+#
+#   In params..: IP
+#                Port
+#                User
+#                Passw
+#                Connections   number of concurrent download connections
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirror::TFtpMirror(long IP, int Port, const char *User, const char *Passw, int Connections)
+  : FUser(User),
+    FPassw(Passw),
+    FSection("FTP.Mirror")
+{
+    Init(IP, Port, User, Passw, Connections);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::~TFtpMirror
+#
+#   Purpose....: Destructor for FTP mirror
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMirror::~TFtpMirror()
+{
+    int i;
+    TFtpMirrorJob *job;
+
+    FSection.Enter();
+    FStopping = TRUE;
+    FSection.Leave();
+
+    for (i = 0; i < FWorkerCount; i++)
+        FWorkerArr[i]->FSignal.Signal();
+
+    for (i = 0; i < FWorkerCount; i++)
+        delete FWorkerArr[i];
+
+    while (FJobList)
+    {
+        job = FJobList->FList;
+        delete FJobList;
+        FJobList = job;
+    }
+
+    FListFtp->Disable();
+    delete FListFtp;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::Init
+#
+#   Purpose....: Init FTP mirror
+#
+#   In params..: IP
+#                Port
+#                User
+#                Passw
+#                Connections   number of concurrent download connections
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMirror::Init(long IP, int Port, const char *User, const char *Passw, int Connections)
+{
+    int i;
+
+    FIp = IP;
+    FPort = Port;
+    OnFile = 0;
+
+    FSegmentSize = FTP_MIRROR_SEGMENT_SIZE;
+
+    FJobList = 0;
+    FJobLast = 0;
+    FJobCount = 0;
+    FStopping = FALSE;
+
+    FFileCount = 0;
+    FSkipCount = 0;
+    FFailCount = 0;
+
+    if (Connections < 1)
+        Connections = 1;
+
+    if (Connections > FTP_MIRROR_MAX_CONNECTIONS)
+        Connections = FTP_MIRROR_MAX_CONNECTIONS;
+
+    FListFtp = new TFtp(IP, Port, User, Passw);
+
+    FWorkerCount = Connections;
+    for (i = 0; i < FWorkerCount; i++)
+        FWorkerArr[i] = new TFtpMirrorWorker(this, i + 1);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::SetSegmentSize
+#
+#   Purpose....: Set size of parallel segments for large files
+#
+#   In params..: Size          segment size, 0 to always get whole files
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMirror::SetSegmentSize(long long Size)
+{
+    FSegmentSize = Size;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::GetFileCount
+#
+#   Purpose....: Get number of files downloaded by last Mirror
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TFtpMirror::GetFileCount() const
+{
+    return FFileCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::GetSkipCount
+#
+#   Purpose....: Get number of up-to-date files skipped by last Mirror
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TFtpMirror::GetSkipCount() const
+{
+    return FSkipCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::GetFailCount
+#
+#   Purpose....: Get number of failed files in last Mirror
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TFtpMirror::GetFailCount() const
+{
+    return FFailCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::IsCurrent
+#
+#   Purpose....: Check if local file matches remote listing
+#
+#   In params..: LocalName
+#                Time          remote modify time
+#                Size          remote size
+#   Out params.: *
+#   Returns....: TRUE if local copy is up to date
+#
+##########################################################################*/
+int TFtpMirror::IsCurrent(const TPathName &LocalName, const TDateTime &Time, long long Size)
+{
+    TDateTime local;
+
+    if (!LocalName.IsFile())
+        return FALSE;
+
+    TFile file = LocalName.OpenFile();
+
+    if (file.GetSize() != Size)
+        return FALSE;
+
+    local = file.GetTime();
+
+    return local.GetYear() == Time.GetYear() &&
+           local.GetMonth() == Time.GetMonth() &&
+           local.GetDay() == Time.GetDay() &&
+           local.GetHour() == Time.GetHour() &&
+           local.GetMin() == Time.GetMin();
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::QueueJob
+#
+#   Purpose....: Queue a download job for the workers
+#
+#   In params..: job
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMirror::QueueJob(TFtpMirrorJob *job)
+{
+    int i;
+
+    FSection.Enter();
+
+    job->FList = 0;
+    if (FJobLast)
+        FJobLast->FList = job;
+    else
+        FJobList = job;
+    FJobLast = job;
+
+    FSection.Leave();
+
+    for (i = 0; i < FWorkerCount; i++)
+        FWorkerArr[i]->FSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::GetJob
+#
+#   Purpose....: Wait for next job
+#
+#   In params..: Worker
+#   Out params.: *
+#   Returns....: Job, or 0 when stopping
+#
+##########################################################################*/
+TFtpMirrorJob *TFtpMirror::GetJob(TFtpMirrorWorker *Worker)
+{
+    TFtpMirrorJob *job;
+
+    for (;;)
+    {
+        FSection.Enter();
+
+        if (FStopping)
+        {
+            FSection.Leave();
+            return 0;
+        }
+
+        job = FJobList;
+        if (job)
+        {
+            FJobList = job->FList;
+            if (!FJobList)
+                FJobLast = 0;
+        }
+
+        FSection.Leave();
+
+        if (job)
+            return job;
+
+        Worker->FSignal.WaitForever();
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::JobDone
+#
+#   Purpose....: Job is finished. Completes file when its last segment is done
+#
+#   In params..: job
+#                ok            TRUE if download succeeded
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMirror::JobDone(TFtpMirrorJob *job, int ok)
+{
+    TFtpMirrorFile *file = job->FFile;
+    int done;
+
+    delete job;
+
+    FSection.Enter();
+
+    if (!ok)
+        file->FFailed = TRUE;
+
+    file->FPending--;
+    done = (file->FPending == 0);
+
+    if (done)
+    {
+        if (file->FFailed)
+            FFailCount++;
+        else
+            FFileCount++;
+    }
+
+    FSection.Leave();
+
+    if (done)
+    {
+        if (!file->FFailed)
+        {
+            TFile local = file->FLocalName.OpenFile();
+            local.SetTime(file->FTime);
+        }
+
+        if (OnFile)
+            (*OnFile)(this, file->FLocalName.Get().GetData(), !file->FFailed);
+
+        delete file;
+
+        FSection.Enter();
+        FJobCount--;
+        FSection.Leave();
+
+        FDoneSignal.Signal();
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::AddFile
+#
+#   Purpose....: Create local file and queue its download, split in segments if large
+#
+#   In params..: file
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMirror::AddFile(TFtpMirrorFile *file)
+{
+    long long pos;
+    long long size;
+    int count;
+
+    TFile local = file->FLocalName.CreateFile(0);
+
+    if (!local.IsOpen())
+    {
+        FSection.Enter();
+        FFailCount++;
+        FSection.Leave();
+
+        delete file;
+        return;
+    }
+
+    if (FSegmentSize > 0 && FWorkerCount > 1 && file->FSize > FSegmentSize)
+    {
+        local.SetSize(file->FSize);
+
+        count = (int)((file->FSize + FSegmentSize - 1) / FSegmentSize);
+    }
+    else
+    {
+        local.SetSize(0);
+        count = 1;
+    }
+
+    FSection.Enter();
+    file->FPending = count;
+    FJobCount++;
+    FSection.Leave();
+
+    if (count == 1)
+        QueueJob(new TFtpMirrorJob(file, 0, -1));
+    else
+    {
+        for (pos = 0; pos < file->FSize; pos += FSegmentSize)
+        {
+            size = file->FSize - pos;
+            if (size > FSegmentSize)
+                size = FSegmentSize;
+
+            QueueJob(new TFtpMirrorJob(file, pos, size));
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::MirrorDir
+#
+#   Purpose....: Queue changed files in a remote directory, then recurse into subdirectories
+#
+#   In params..: RemoteDir     absolute remote directory
+#                LocalDir      local directory
+#   Out params.: *
+#   Returns....: TRUE if directory could be listed
+#
+##########################################################################*/
+int TFtpMirror::MirrorDir(const TString &RemoteDir, const TPathName &LocalDir)
+{
+    TString name;
+    TString subdir;
+    TDateTime time;
+    long long size;
+    int ok;
+    TStringList dirlist;
+
+    if (!LocalDir.IsDir())
+        LocalDir.MakeDir();
+
+    if (!FListFtp->SetDir(RemoteDir.GetData()))
+        return FALSE;
+
+    ok = FListFtp->GotoFirstFile();
+    while (ok)
+    {
+        FListFtp->GetFile(name, time, &size);
+
+        TPathName local = LocalDir + name;
+
+        if (IsCurrent(local, time, size))
+            FSkipCount++;
+        else
+            AddFile(new TFtpMirrorFile(RemoteDir, name, local, time, size));
+
+        ok = FListFtp->GotoNextFile();
+    }
+
+    ok = FListFtp->GotoFirstDir();
+    while (ok)
+    {
+        FListFtp->GetDir(name, time);
+
+        if (name != TString(".") && name != TString(".."))
+            dirlist.AddLast(name);
+
+        ok = FListFtp->GotoNextDir();
+    }
+
+    ok = dirlist.GotoFirst();
+    while (ok)
+    {
+        name = dirlist.Get();
+
+        subdir = RemoteDir;
+        if (subdir.GetSize() == 0 || subdir[subdir.GetSize() - 1] != '/')
+            subdir += "/";
+        subdir += name;
+
+        if (!MirrorDir(subdir, LocalDir + name))
+        {
+            FSection.Enter();
+            FFailCount++;
+            FSection.Leave();
+        }
+
+        ok = dirlist.GotoNext();
+    }
+
+    return TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMirror::Mirror
+#
+#   Purpose....: Sync remote tree to local directory. Files whose size or
+#                modify time differ from the remote listing are downloaded
+#                concurrently over the worker connections
+#
+#   In params..: RemoteDir     absolute remote directory
+#                LocalDir      local directory
+#   Out params.: *
+#   Returns....: TRUE if all files are up to date
+#
+##########################################################################*/
+int TFtpMirror::Mirror(const char *RemoteDir, const TPathName &LocalDir)
+{
+    int ok;
+
+    FFileCount = 0;
+    FSkipCount = 0;
+    FFailCount = 0;
+
+    FListFtp->Enable();
+
+    ok = MirrorDir(TString(RemoteDir), LocalDir);
+
+    FSection.Enter();
+
+    while (FJobCount)
+    {
+        FSection.Leave();
+        FDoneSignal.WaitForever();
+        FSection.Enter();
+    }
+
+    FSection.Leave();
+
+    return ok && FFailCount == 0;
+}
@@ -0,0 +1,145 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftpmirr.h
+# FTP mirror client class
+#
+########################################################################*/
+
+#ifndef _FTPMIRR_H
+#define _FTPMIRR_H
+
+#include "ftp.h"
+#include "path.h"
+#include "strlist.h"
+#include "section.h"
+#include "sigdev.h"
+#include "thread.h"
+
+#define FTP_MIRROR_CONNECTIONS      4
+#define FTP_MIRROR_MAX_CONNECTIONS  16
+#define FTP_MIRROR_SEGMENT_SIZE     0x1000000
+
+class TFtpMirror;
+
+class TFtpMirrorFile
+{
+public:
+    TFtpMirrorFile(const TString &RemoteDir, const TString &Name, const TPathName &LocalName, const TDateTime &Time, long long Size);
+    ~TFtpMirrorFile();
+
+    TString FRemoteDir;
+    TString FName;
+    TPathName FLocalName;
+    TDateTime FTime;
+    long long FSize;
+
+    int FPending;
+    int FFailed;
+};
+
+class TFtpMirrorJob
+{
+public:
+    TFtpMirrorJob(TFtpMirrorFile *File, long long Pos, long long Size);
+    ~TFtpMirrorJob();
+
+    TFtpMirrorFile *FFile;
+    long long FPos;
+    long long FSize;
+
+    TFtpMirrorJob *FList;
+};
+
+class TFtpMirrorWorker : public TThread
+{
+public:
+    TFtpMirrorWorker(TFtpMirror *Mirror, int Nr);
+    virtual ~TFtpMirrorWorker();
+
+    TSignalDevice FSignal;
+
+protected:
+    int Get(TFtpMirrorJob *job);
+    virtual void Execute();
+
+    TFtpMirror *FMirror;
+    TFtp *FFtp;
+    TString FCurrDir;
+};
+
+class TFtpMirror
+{
+friend class TFtpMirrorWorker;
+public:
+    TFtpMirror(long IP, int Port, const char *User, const char *Passw);
+    TFtpMirror(long IP, int Port, const char *User, const char *Passw, int Connections);
+    ~TFtpMirror();
+
+    void SetSegmentSize(long long Size);
+
+    int Mirror(const char *RemoteDir, const TPathName &LocalDir);
+
+    int GetFileCount() const;
+    int GetSkipCount() const;
+    int GetFailCount() const;
+
+    void (*OnFile)(TFtpMirror *mirror, const char *LocalName, int ok);
+
+protected:
+    void Init(long IP, int Port, const char *User, const char *Passw, int Connections);
+    int MirrorDir(const TString &RemoteDir, const TPathName &LocalDir);
+    static int IsCurrent(const TPathName &LocalName, const TDateTime &Time, long long Size);
+    void AddFile(TFtpMirrorFile *file);
+    void QueueJob(TFtpMirrorJob *job);
+    TFtpMirrorJob *GetJob(TFtpMirrorWorker *Worker);
+    void JobDone(TFtpMirrorJob *job, int ok);
+
+    long FIp;
+    int FPort;
+    TString FUser;
+    TString FPassw;
+
+    TFtp *FListFtp;
+
+    TFtpMirrorWorker *FWorkerArr[FTP_MIRROR_MAX_CONNECTIONS];
+    int FWorkerCount;
+
+    long long FSegmentSize;
+
+    TSection FSection;
+    TSignalDevice FDoneSignal;
+    TFtpMirrorJob *FJobList;
+    TFtpMirrorJob *FJobLast;
+    int FJobCount;
+    int FStopping;
+
+    int FFileCount;
+    int FSkipCount;
+    int FFailCount;
+};
+
+#endif
@@ -54,6 +54,11 @@
 #include "ftpmkd.h"
 #include "ftprmd.h"
 #include "ftpquit.h"
+#include "ftpxfer.h"
+#include "ftpfeat.h"
+#include "ftpsize.h"
+#include "ftprest.h"
+#include "ftpmlsd.h"
 
 #include "path.h"
 
@@ -319,6 +324,11 @@ TFtpSocketServerFactory::~TFtpSocketServerFactory()
     delete type;
     delete retr;
     delete quit;
+    delete feat;
+    delete size;
+    delete rest;
+    delete mlsd;
+    delete mlst;
 
     if (stor)
         delete stor;
@@ -361,6 +371,11 @@ void TFtpSocketServerFactory::Init(bool ReadOnly)
     type = new TFtpTypeFactory;
     retr = new TFtpRetrFactory;
     quit = new TFtpQuitFactory;
+    feat = new TFtpFeatFactory;
+    size = new TFtpSizeFactory;
+    rest = new TFtpRestFactory;
+    mlsd = new TFtpMlsdFactory;
+    mlst = new TFtpMlstFactory;
 
     if (ReadOnly)
     {
@@ -382,6 +397,8 @@ void TFtpSocketServerFactory::Init(bool ReadOnly)
     FList = 0;
     FMyIp = 0;
     FLocalPort = 0;
+    FTransferSize = FTP_TRANSFER_SIZE;
+    FDataBufferSize = FTP_DATA_BUFFER_SIZE;
     OnCommand = 0;
 }
 
@@ -403,6 +420,8 @@ TSocketServer *TFtpSocketServerFactory::Create(TTcpSocket *Socket)
     server->FLocalPort = FLocalPort;
     server->OnCommand = OnCommand;
     server->FMyIp = FMyIp;
+    server->FTransferSize = FTransferSize;
+    server->FDataBufferSize = FDataBufferSize;
 
     return server;
 }
@@ -457,3 +476,37 @@ void TFtpSocketServerFactory::SetDataPort(int Port)
 {
     FLocalPort = Port;
 }
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServerFactory::SetTransferBufferSize
+#
+#   Purpose....: Set size of file transfer buffers
+#
+#   In params..: Size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServerFactory::SetTransferBufferSize(int Size)
+{
+    if (Size >= 0x1000)
+        FTransferSize = Size;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServerFactory::SetDataBufferSize
+#
+#   Purpose....: Set buffer size of data connections
+#
+#   In params..: Size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServerFactory::SetDataBufferSize(int Size)
+{
+    if (Size >= 0x1000)
+        FDataBufferSize = Size;
+}
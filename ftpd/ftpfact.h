@@ -70,6 +70,8 @@ public:
 
     void AddUser(const char *User, const char *Passw, const char *RootDir);
     void SetDataPort(int DataPort);
+    void SetTransferBufferSize(int Size);
+    void SetDataBufferSize(int Size);
 
     void SetMyIp(long Ip);
 
@@ -97,11 +99,18 @@ protected:
     TFtpCommandFactory *mkd;
     TFtpCommandFactory *rmd;
     TFtpCommandFactory *quit;
+    TFtpCommandFactory *feat;
+    TFtpCommandFactory *size;
+    TFtpCommandFactory *rest;
+    TFtpCommandFactory *mlsd;
+    TFtpCommandFactory *mlst;
 
     TFtpUser *FList;
 
     long FMyIp;
     int FLocalPort;
+    int FTransferSize;
+    int FDataBufferSize;
 };
 
 #endif
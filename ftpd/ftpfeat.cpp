@@ -0,0 +1,123 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftpfeat.cpp
+# Ftp Feat command class
+#
+########################################################################*/
+
+#include <string.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#include "ftpserv.h"
+#include "ftpfeat.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : TFtpFeatFactory::TFtpFeatFactory
+#
+#   Purpose....: Constructor for TFtpFeatFactory
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpFeatFactory::TFtpFeatFactory()
+  : TFtpCommandFactory("FEAT")
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpFeatFactory::Create
+#
+#   Purpose....: Create a command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpCommand *TFtpFeatFactory::Create(TFtpSocketServer *Server, const char *param)
+{
+    return new TFtpFeatCommand(Server, param);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpFeatCommand::TFtpFeatCommand
+#
+#   Purpose....: Constructor for TFtpFeatCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpFeatCommand::TFtpFeatCommand(TFtpSocketServer *Server, const char *param)
+  : TFtpCommand(Server, param)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpFeatCommand::~TFtpFeatCommand
+#
+#   Purpose....: Destructor for TFtpFeatCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpFeatCommand::~TFtpFeatCommand()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpFeatCommand::Execute
+#
+#   Purpose....: List supported extensions
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpFeatCommand::Execute(char *param)
+{
+    FServer->ReplyStart(211, "Extensions supported:");
+    FServer->ReplyLine("MLST type*;size*;modify*;");
+    FServer->ReplyLine("SIZE");
+    FServer->ReplyLine("REST STREAM");
+    FServer->Reply(211, "End");
+}
@@ -106,143 +106,187 @@ TFtpListCommand::~TFtpListCommand()
 
 /*##########################################################################
 #
-#   Name       : TFtpListCommand::WriteEntry
+#   Name       : TFtpListCommand::IsMatch
 #
-#   Purpose....: Write detailed listing entry
+#   Purpose....: Check if entry name matches a wildcard pattern
 #
-#   In params..: *
+#   In params..: Name
+#                Pattern       * and ? wildcards, case insensitive
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if match
 #
 ##########################################################################*/
-void TFtpListCommand::WriteEntry(const TDirEntryData &entry)
+int TFtpListCommand::IsMatch(const char *Name, const char *Pattern)
 {
-    TDateTime CurrTime;
-    char str[31];
-    long long size;
+    const char *StarName = 0;
+    const char *StarPattern = 0;
 
-        if (entry.Attribute & FILE_ATTRIBUTE_DIRECTORY)
-        {
-        FServer->Write("drw-rw-rw- ");
-                FDirCount++;
-                }
-        else
-        {
-        FServer->Write("-rw-rw-rw- ");
-                FFileCount++;
-                FTotalSize += (int)entry.FileSize;
+    if (!strcmp(Pattern, "*") || !strcmp(Pattern, "*.*"))
+        return TRUE;
 
+    while (*Name)
+    {
+        if (*Pattern == '*')
+        {
+            Pattern++;
+            StarPattern = Pattern;
+            StarName = Name;
         }
-
-        FServer->Write(" 0 pg92075 ");
-
-        if (entry.Attribute & FILE_ATTRIBUTE_DIRECTORY)
-                FServer->Write("4096");
-        else
+        else if (*Pattern == '?' || toupper(*Pattern) == toupper(*Name))
         {
-                sprintf(str, "%d", entry.FileSize);
-                FServer->Write(str);
+            Pattern++;
+            Name++;
         }
-
-        switch (entry.ModifyTime.GetMonth())
+        else if (StarPattern)
         {
-                case 1:
-                        FServer->Write(" Jan ");
-                        break;
-
-                case 2:
-                        FServer->Write(" Feb ");
-                        break;
-
-                case 3:
-                                                FServer->Write(" Mar ");
-                        break;
-
-                case 4:
-                        FServer->Write(" Apr ");
-                        break;
-
-                case 5:
-                        FServer->Write(" May ");
-                        break;
-
-                case 6:
-                        FServer->Write(" Jun ");
-                        break;
-
-                case 7:
-                        FServer->Write(" Jul ");
-                        break;
-
-                case 8:
-                        FServer->Write(" Aug ");
-                        break;
-
-                case 9:
-                        FServer->Write(" Sep ");
-                        break;
+            StarName++;
+            Name = StarName;
+            Pattern = StarPattern;
+        }
+        else
+            return FALSE;
+    }
 
-                case 10:
-                        FServer->Write(" Oct ");
-                        break;
+    while (*Pattern == '*')
+        Pattern++;
 
-                case 11:
-                        FServer->Write(" Nov ");
-            break;
+    return *Pattern == 0;
+}
 
-        case 12:
-            FServer->Write(" Dec ");
-            break;
+/*##########################################################################
+#
+#   Name       : TFtpListCommand::WriteEntry
+#
+#   Purpose....: Write detailed listing entry
+#
+#   In params..: Name
+#                Size
+#                Attrib
+#                Time          modify time
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpListCommand::WriteEntry(const char *Name, long long Size, int Attrib, const TDateTime &Time)
+{
+    static const char *MonthName[12] =
+    {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+    char buf[FTP_LIST_LINE_SIZE];
+    const char *mode;
+    int month;
+    int len;
+    int namelen;
+
+    if (Attrib & FILE_ATTRIBUTE_DIRECTORY)
+    {
+        mode = "drw-rw-rw-";
+        Size = 4096;
+        FDirCount++;
+    }
+    else
+    {
+        mode = "-rw-rw-rw-";
+        FFileCount++;
+        FTotalSize += Size;
     }
 
-    if (CurrTime.GetYear() == entry.ModifyTime.GetYear())
-        sprintf(str, "%02d %02d:%02d ",
-                                        entry.ModifyTime.GetDay(),
-                                        entry.ModifyTime.GetHour(),
-                                        entry.ModifyTime.GetMin());
-        else
-                sprintf(str, "%02d %04d ",
-                                        entry.ModifyTime.GetDay(),
-                                        entry.ModifyTime.GetYear());
-
-        FServer->Write(str);
+    month = Time.GetMonth();
+    if (month < 1 || month > 12)
+        month = 1;
 
-        size = entry.EntryName.GetSize();
-        strncpy(str, entry.EntryName.GetData(), 30);
+    if (FCurrTime.GetYear() == Time.GetYear())
+        len = sprintf(buf, "%s 1 ftp ftp %lld %s %02d %02d:%02d ",
+                        mode, Size, MonthName[month - 1],
+                        Time.GetDay(), Time.GetHour(), Time.GetMin());
+    else
+        len = sprintf(buf, "%s 1 ftp ftp %lld %s %02d %04d ",
+                        mode, Size, MonthName[month - 1],
+                        Time.GetDay(), Time.GetYear());
 
-        FServer->Write(str);
+    namelen = strlen(Name);
 
-        FServer->Write("\r\n");
+    if (len + namelen + 2 <= FTP_LIST_LINE_SIZE)
+    {
+        memcpy(buf + len, Name, namelen);
+        len += namelen;
+        buf[len++] = '\r';
+        buf[len++] = '\n';
+        FServer->Write(buf, len);
+    }
+    else
+    {
+        FServer->Write(buf, len);
+        FServer->Write(Name, namelen);
+        FServer->Write("\r\n", 2);
+    }
 }
 
 /*##########################################################################
 #
-#   Name       : TFtpListCommand::WriteEntry
+#   Name       : TFtpListCommand::ListPath
 #
-#   Purpose....: Write detailed listing
+#   Purpose....: Walk directory once and write matching entries as found
 #
-#   In params..: *
+#   In params..: Path          directory, or directory + wildcard pattern
 #   Out params.: *
-#   Returns....: *
+#   Returns....: Number of entries written
 #
 ##########################################################################*/
-void TFtpListCommand::WriteEntry()
+int TFtpListCommand::ListPath(const TPathName &Path)
 {
-        int ok;
-
-    ok = FDirList.GotoFirst();
-    while (ok)
+    TString base;
+    TString pattern;
+    struct RdosDirInfo info;
+    struct RdosDirEntry *entry;
+    char *ptr;
+    int DirHandle;
+    int count = 0;
+    int i;
+
+    if (Path.IsDir())
+    {
+        base = Path.Get();
+        pattern = "*";
+    }
+    else
     {
-        WriteEntry(FDirList.Get().Get());
-        ok = FDirList.GotoNext();
+        base = Path.GetBaseName();
+        pattern = Path.GetEntryName();
+
+        if (base.GetSize() == 0)
+            base = ".";
+
+        if (pattern.GetSize() == 0)
+            pattern = "*";
     }
 
-        ok = FFileList.GotoFirst();
-        while (ok)
+    DirHandle = RdosOpenDir(base.GetData(), &info);
+
+    ptr = (char *)info.Entry;
+
+    for (i = 0; i < info.Count; i++)
+    {
+        entry = (struct RdosDirEntry *)ptr;
+
+        if ((entry->Attrib & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM)) == 0)
         {
-                WriteEntry(FFileList.Get().Get());
-                ok = FFileList.GotoNext();
+            if (IsMatch(entry->PathName, pattern.GetData()))
+            {
+                WriteEntry(entry->PathName, entry->Size, entry->Attrib, TDateTime(entry->ModifyTime));
+                count++;
+            }
         }
+
+        ptr += info.HeaderSize;
+        ptr += entry->PathNameSize;
+    }
+
+    RdosCloseDir(DirHandle);
+
+    return count;
 }
 
 /*##########################################################################
@@ -258,73 +302,50 @@ void TFtpListCommand::WriteEntry()
 ##########################################################################*/
 void TFtpListCommand::Execute(char *param)
 {
-        TFtpArg *arg;
-        int ArgCount;
-        TFtpLangString msg;
-        int ok;
-        TPathName path(FServer->RootDir);
+    TFtpArg *arg;
+    TFtpLangString msg;
+    int ok;
+    int count;
+    TPathName path(FServer->RootDir);
 
-        path += FServer->CurrDir;
+    path += FServer->CurrDir;
 
-        if (FServer->VerifyUser())
+    if (FServer->VerifyUser())
+    {
+        ok = ScanCmdLine(param, 0);
+        if (ok)
         {
-                ok = ScanCmdLine(param, 0);
-                if (ok)
+            FFileCount = 0;
+            FDirCount = 0;
+            FTotalSize = 0;
+
+            msg.Load(150);
+            FServer->Reply(&msg);
+
+            count = 0;
+            arg = FArgList;
+            while (arg)
+            {
+                if (arg->FName.GetData()[0] != '-')
                 {
-                        ArgCount = 0;
-                        arg = FArgList;
-                        while (arg)
-                        {
-                                ArgCount++;
-                                arg = arg->FList;
-                        }
-
-                        FFileCount = 0;
-                        FDirCount = 0;
-                        FTotalSize = 0;
-
-                        arg = FArgList;
-
-                        FFileList.SetIgnoredAttributes(FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM | FILE_ATTRIBUTE_DIRECTORY);
-                        FDirList.SetRequiredAttributes(FILE_ATTRIBUTE_DIRECTORY);
-                        FDirList.SetIgnoredAttributes(FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM);
-
-                        if (arg)
-                        {
-                                while (arg)
-                                {
-                                        FFileList.Add(path + arg->FName);
-                                        FDirList.Add(path + arg->FName);
-                                        arg = arg->FList;
-                                }
-                        }
-                        else
-                        {
-                                FFileList.Add(path + "*");
-                                FDirList.Add(path + "*");
-                        }
-
-                        FFileList.RemoveDuplicates();
-                        FDirList.RemoveDuplicates();
-
-                        FFileList.Sort();
-                        FDirList.Sort();
-
-                        msg.Load(150);
-                        FServer->Reply(&msg);
-
-                        WriteEntry();
-
-                        FServer->Push();
-
-                        msg.Load(226);
+                    ListPath(path + arg->FName);
+                    count++;
                 }
-                else
-                        msg.Load(501);
+                arg = arg->FList;
+            }
+
+            if (count == 0)
+                ListPath(path);
+
+            FServer->Push();
+
+            msg.Load(226);
         }
         else
-                msg.Load(530);
-
-        FServer->Reply(&msg);
+            msg.Load(501);
+    }
+    else
+        msg.Load(530);
 
+    FServer->Reply(&msg);
 }
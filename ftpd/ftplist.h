@@ -34,7 +34,9 @@
 
 #include "ftpcmd.h"
 #include "ftpfact.h"
-#include "direntry.h"
+#include "datetime.h"
+
+#define FTP_LIST_LINE_SIZE  512
 
 class TFtpListFactory : public TFtpCommandFactory
 {
@@ -53,19 +55,17 @@ public:
 
 	virtual void Execute(char *param);
 
-protected:
-	void WriteHeader(TString &str);
-	void WriteFooter();
+	static int IsMatch(const char *Name, const char *Pattern);
 
-	void WriteEntry(const TDirEntryData &entry);
-	void WriteEntry();
+protected:
+	int ListPath(const TPathName &Path);
+	virtual void WriteEntry(const char *Name, long long Size, int Attrib, const TDateTime &Time);
 
-	TDirList FFileList;
-	TDirList FDirList;
+	TDateTime FCurrTime;
 
 	int FFileCount;
 	int FDirCount;
-	long FTotalSize;
+	long long FTotalSize;
 };
 
 #endif
@@ -0,0 +1,393 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftpmlsd.cpp
+# Ftp Mlsd & Mlst command classes
+#
+########################################################################*/
+
+#include <string.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#include "ftpserv.h"
+#include "ftpmlsd.h"
+#include "path.h"
+#include "file.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : TFtpMlsdFactory::TFtpMlsdFactory
+#
+#   Purpose....: Constructor for TFtpMlsdFactory
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMlsdFactory::TFtpMlsdFactory()
+  : TFtpCommandFactory("MLSD")
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlsdFactory::Create
+#
+#   Purpose....: Create a command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpCommand *TFtpMlsdFactory::Create(TFtpSocketServer *Server, const char *param)
+{
+    return new TFtpMlsdCommand(Server, param);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlsdCommand::TFtpMlsdCommand
+#
+#   Purpose....: Constructor for TFtpMlsdCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMlsdCommand::TFtpMlsdCommand(TFtpSocketServer *Server, const char *param)
+  : TFtpListCommand(Server, param)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlsdCommand::~TFtpMlsdCommand
+#
+#   Purpose....: Destructor for TFtpMlsdCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMlsdCommand::~TFtpMlsdCommand()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlsdCommand::FormatFacts
+#
+#   Purpose....: Format RFC 3659 facts for an entry
+#
+#   In params..: buf
+#                Type          entry type, or 0 to derive from Attrib
+#                Size
+#                Attrib
+#                Time          modify time, or 0 if unknown
+#   Out params.: buf
+#   Returns....: Length of facts
+#
+##########################################################################*/
+int TFtpMlsdCommand::FormatFacts(char *buf, const char *Type, long long Size, int Attrib, const TDateTime *Time)
+{
+    int len;
+
+    if (Attrib & FILE_ATTRIBUTE_DIRECTORY)
+    {
+        if (!Type)
+            Type = "dir";
+
+        len = sprintf(buf, "type=%s;", Type);
+    }
+    else
+        len = sprintf(buf, "type=file;size=%lld;", Size);
+
+    if (Time)
+        len += sprintf(buf + len, "modify=%04d%02d%02d%02d%02d%02d;",
+                        Time->GetYear(), Time->GetMonth(), Time->GetDay(),
+                        Time->GetHour(), Time->GetMin(), Time->GetSec());
+
+    buf[len++] = ' ';
+    buf[len] = 0;
+
+    return len;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlsdCommand::WriteEntry
+#
+#   Purpose....: Write machine readable listing entry
+#
+#   In params..: Name
+#                Size
+#                Attrib
+#                Time          modify time
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMlsdCommand::WriteEntry(const char *Name, long long Size, int Attrib, const TDateTime &Time)
+{
+    char buf[FTP_LIST_LINE_SIZE];
+    const char *type = 0;
+    int len;
+    int namelen;
+
+    if (!strcmp(Name, "."))
+        type = "cdir";
+    else if (!strcmp(Name, ".."))
+        type = "pdir";
+
+    if (Attrib & FILE_ATTRIBUTE_DIRECTORY)
+        FDirCount++;
+    else
+    {
+        FFileCount++;
+        FTotalSize += Size;
+    }
+
+    len = FormatFacts(buf, type, Size, Attrib, &Time);
+    namelen = strlen(Name);
+
+    if (len + namelen + 2 <= FTP_LIST_LINE_SIZE)
+    {
+        memcpy(buf + len, Name, namelen);
+        len += namelen;
+        buf[len++] = '\r';
+        buf[len++] = '\n';
+        FServer->Write(buf, len);
+    }
+    else
+    {
+        FServer->Write(buf, len);
+        FServer->Write(Name, namelen);
+        FServer->Write("\r\n", 2);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlsdCommand::Execute
+#
+#   Purpose....: Run command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMlsdCommand::Execute(char *param)
+{
+    TFtpLangString msg;
+    int ok;
+    TPathName path(FServer->RootDir);
+
+    path += FServer->CurrDir;
+
+    if (FServer->VerifyUser())
+    {
+        ok = ScanCmdLine(param, 0);
+        if (ok)
+            ok = (FArgCount <= 1);
+
+        if (ok && FArgCount == 1)
+            path += FArgList->FName;
+
+        if (ok)
+        {
+            if (path.IsDir())
+            {
+                FFileCount = 0;
+                FDirCount = 0;
+                FTotalSize = 0;
+
+                msg.Load(150);
+                FServer->Reply(&msg);
+
+                ListPath(path);
+
+                FServer->Push();
+
+                msg.Load(226);
+            }
+            else
+                msg.Load(550);
+        }
+        else
+            msg.Load(501);
+    }
+    else
+        msg.Load(530);
+
+    FServer->Reply(&msg);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlstFactory::TFtpMlstFactory
+#
+#   Purpose....: Constructor for TFtpMlstFactory
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMlstFactory::TFtpMlstFactory()
+  : TFtpCommandFactory("MLST")
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlstFactory::Create
+#
+#   Purpose....: Create a command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpCommand *TFtpMlstFactory::Create(TFtpSocketServer *Server, const char *param)
+{
+    return new TFtpMlstCommand(Server, param);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlstCommand::TFtpMlstCommand
+#
+#   Purpose....: Constructor for TFtpMlstCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMlstCommand::TFtpMlstCommand(TFtpSocketServer *Server, const char *param)
+  : TFtpCommand(Server, param)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlstCommand::~TFtpMlstCommand
+#
+#   Purpose....: Destructor for TFtpMlstCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpMlstCommand::~TFtpMlstCommand()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpMlstCommand::Execute
+#
+#   Purpose....: Run command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpMlstCommand::Execute(char *param)
+{
+    TFtpLangString msg;
+    TPathName relpath;
+    TPathName abspath;
+    char buf[FTP_LIST_LINE_SIZE];
+    const char *name;
+    int len;
+    int ok;
+
+    if (FServer->VerifyUser())
+    {
+        ok = ScanCmdLine(param, 0);
+        if (ok)
+            ok = (FArgCount <= 1);
+
+        if (ok)
+        {
+            if (FArgCount == 1)
+            {
+                name = FArgList->FName.GetData();
+                relpath = TPathName(FServer->CurrDir) + TString(name);
+            }
+            else
+            {
+                name = FServer->CurrDir.GetData();
+                relpath = TPathName(FServer->CurrDir);
+            }
+
+            abspath = TPathName(FServer->RootDir) + relpath.Get();
+
+            len = 0;
+
+            if (abspath.IsFile())
+            {
+                TFile file = abspath.OpenFile();
+                TDateTime time = file.GetTime();
+                len = TFtpMlsdCommand::FormatFacts(buf, 0, file.GetSize(), 0, &time);
+            }
+            else if (abspath.IsDir())
+                len = TFtpMlsdCommand::FormatFacts(buf, 0, 0, FILE_ATTRIBUTE_DIRECTORY, 0);
+
+            if (len)
+            {
+                strncpy(buf + len, name, FTP_LIST_LINE_SIZE - len - 1);
+                buf[FTP_LIST_LINE_SIZE - 1] = 0;
+
+                FServer->ReplyStart(250, "Listing");
+                FServer->ReplyLine(buf);
+                FServer->Reply(250, "End");
+                return;
+            }
+            else
+                msg.Load(550);
+        }
+        else
+            msg.Load(501);
+    }
+    else
+        msg.Load(530);
+
+    FServer->Reply(&msg);
+}
@@ -0,0 +1,161 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftprest.cpp
+# Ftp Rest command class
+#
+########################################################################*/
+
+#include <string.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#include "ftpserv.h"
+#include "ftprest.h"
+#include "path.h"
+#include "file.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : TFtpRestFactory::TFtpRestFactory
+#
+#   Purpose....: Constructor for TFtpRestFactory
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpRestFactory::TFtpRestFactory()
+  : TFtpCommandFactory("REST")
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpRestFactory::Create
+#
+#   Purpose....: Create a command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpCommand *TFtpRestFactory::Create(TFtpSocketServer *Server, const char *param)
+{
+    return new TFtpRestCommand(Server, param);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpRestCommand::TFtpRestCommand
+#
+#   Purpose....: Constructor for TFtpRestCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpRestCommand::TFtpRestCommand(TFtpSocketServer *Server, const char *param)
+  : TFtpCommand(Server, param)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpRestCommand::~TFtpRestCommand
+#
+#   Purpose....: Destructor for TFtpRestCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpRestCommand::~TFtpRestCommand()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpRestCommand::Execute
+#
+#   Purpose....: Set restart position for next RETR or STOR
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpRestCommand::Execute(char *param)
+{
+    TFtpLangString msg;
+    const char *ptr;
+    long long pos;
+    int ok;
+
+    if (FServer->VerifyUser())
+    {
+        ok = ScanCmdLine(param, 0);
+        if (ok)
+            ok = (FArgCount == 1);
+
+        if (ok)
+        {
+            pos = 0;
+            ptr = FArgList->FName.GetData();
+
+            if (*ptr == 0)
+                ok = FALSE;
+
+            while (*ptr && ok)
+            {
+                if (isdigit(*ptr))
+                    pos = 10 * pos + (*ptr - '0');
+                else
+                    ok = FALSE;
+                ptr++;
+            }
+        }
+
+        if (ok)
+        {
+            FServer->FRestartPos = pos;
+            msg.Load(350);
+        }
+        else
+            msg.Load(501);
+    }
+    else
+        msg.Load(530);
+
+    FServer->Reply(&msg);
+}
@@ -37,6 +37,7 @@
 #include "ftpretr.h"
 #include "path.h"
 #include "file.h"
+#include "ftpxfer.h"
 
 #define FALSE 0
 #define TRUE !FALSE
@@ -104,6 +105,65 @@ TFtpRetrCommand::~TFtpRetrCommand()
 {
 }
 
+/*##########################################################################
+#
+#   Name       : TFtpRetrCommand::SendFile
+#
+#   Purpose....: Send file from current position on data connection.
+#                Larger files are read ahead by a transfer thread so disc
+#                reads overlap socket writes.
+#
+#   In params..: File
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpRetrCommand::SendFile(TFile &File)
+{
+        char *buf;
+        int len;
+        long long remain = File.GetSize() - File.GetPos();
+
+        FServer->StartTransfer();
+
+        if (remain > FServer->FTransferSize)
+        {
+                TFtpTransfer transfer(&File, FServer->FTransferSize, FALSE);
+
+                buf = transfer.GetFull(&len);
+                while (buf)
+                {
+                        FServer->Write(buf, len);
+                        FServer->TransferData(len, FALSE);
+                        transfer.PutFree();
+
+                        if (!FServer->IsOpen())
+                                break;
+
+                        buf = transfer.GetFull(&len);
+                }
+        }
+        else
+        {
+                if (remain > 0)
+                {
+                        buf = new char[(int)remain];
+                        len = File.Read(buf, (int)remain);
+
+                        if (len > 0)
+                        {
+                                FServer->Write(buf, len);
+                                FServer->TransferData(len, FALSE);
+                        }
+
+                        delete[] buf;
+                }
+        }
+
+        FServer->Push();
+        FServer->EndTransfer();
+}
+
 /*##########################################################################
 #
 #   Name       : TFtpRetrCommand::Execute
@@ -121,6 +181,9 @@ void TFtpRetrCommand::Execute(char *param)
         int ArgCount;
         TFtpLangString msg;
         int ok;
+        long long pos = FServer->FRestartPos;
+
+        FServer->FRestartPos = 0;
 
         if (FServer->VerifyUser())
         {
@@ -148,20 +211,15 @@ void TFtpRetrCommand::Execute(char *param)
                                 FServer->Reply(&msg);
 
                                 TFile file = abspath.OpenFile();
-                                char *buf = new char[0x1000];
-                                int len = file.Read(buf, 0x1000);
+                                if (pos)
+                                        file.SetPos(pos);
 
-                                while (len)
-                                {
-                                        FServer->Write(buf, len);
-                                        len = file.Read(buf, 0x1000);
-                                }
+                                SendFile(file);
 
-                                delete buf;
-                                FServer->Push();
+                                msg.Load(226);
                         }
-
-                        msg.Load(226);
+                        else
+                                msg.Load(550);
                 }
                 else
                         msg.Load(501);
@@ -53,6 +53,7 @@ public:
 	virtual void Execute(char *param);
 
 protected:
+	void SendFile(TFile &File);
 };
 
 #endif
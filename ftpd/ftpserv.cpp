@@ -41,6 +41,7 @@
 #include "ftplang.h"
 #include "ftpcmd.h"
 #include "ftpfact.h"
+#include "ftpxfer.h"
 
 #define FALSE 0
 #define TRUE !FALSE
@@ -260,6 +261,19 @@ TFtpSocketServer::TFtpSocketServer(TFtpUser *UserList, const char *Name, int Sta
         OnCommand = 0;
         FMyIp = 0;
         FLocalPort = 0;
+        FRestartPos = 0;
+        FTransferSize = FTP_TRANSFER_SIZE;
+        FDataBufferSize = FTP_DATA_BUFFER_SIZE;
+
+        FBytesSent = 0;
+        FBytesReceived = 0;
+        FTransferCount = 0;
+        FTransferStart = 0;
+        FTransferBytes = 0;
+        FTransferLatency = -1;
+        FLastTransferSize = 0;
+        FLastTransferTime = 0;
+        FLastTransferLatency = 0;
 }
 
 /*##########################################################################
@@ -279,6 +293,210 @@ TFtpSocketServer::~TFtpSocketServer()
         delete FDataSocket;
 }
 
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetElapsedMs
+#
+#   Purpose....: Convert system time difference to milliseconds
+#
+#   In params..: Start
+#                End
+#   Out params.: *
+#   Returns....: Milliseconds
+#
+##########################################################################*/
+int TFtpSocketServer::GetElapsedMs(long long Start, long long End)
+{
+    long long diff = End - Start;
+
+    if (diff < 0)
+        diff = 0;
+
+    return (int)((diff * 3600000) >> 32);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::StartTransfer
+#
+#   Purpose....: Start timing a data transfer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServer::StartTransfer()
+{
+    FTransferStart = RdosGetLongSysTime();
+    FTransferBytes = 0;
+    FTransferLatency = -1;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::TransferData
+#
+#   Purpose....: Account for transferred data
+#
+#   In params..: Size          bytes transferred
+#                Received      TRUE if received from client
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServer::TransferData(int Size, int Received)
+{
+    if (FTransferLatency < 0)
+        FTransferLatency = GetElapsedMs(FTransferStart, RdosGetLongSysTime());
+
+    FTransferBytes += Size;
+
+    if (Received)
+        FBytesReceived += Size;
+    else
+        FBytesSent += Size;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::EndTransfer
+#
+#   Purpose....: Finish timing a data transfer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServer::EndTransfer()
+{
+    FLastTransferTime = GetElapsedMs(FTransferStart, RdosGetLongSysTime());
+    FLastTransferSize = FTransferBytes;
+
+    if (FTransferLatency < 0)
+        FLastTransferLatency = FLastTransferTime;
+    else
+        FLastTransferLatency = FTransferLatency;
+
+    FTransferCount++;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetBytesSent
+#
+#   Purpose....: Get total bytes sent on data connections
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TFtpSocketServer::GetBytesSent() const
+{
+    return FBytesSent;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetBytesReceived
+#
+#   Purpose....: Get total bytes received on data connections
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TFtpSocketServer::GetBytesReceived() const
+{
+    return FBytesReceived;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetTransferCount
+#
+#   Purpose....: Get number of completed transfers
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TFtpSocketServer::GetTransferCount() const
+{
+    return FTransferCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetLastTransferSize
+#
+#   Purpose....: Get bytes in last transfer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TFtpSocketServer::GetLastTransferSize() const
+{
+    return FLastTransferSize;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetLastTransferTime
+#
+#   Purpose....: Get duration of last transfer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Milliseconds
+#
+##########################################################################*/
+int TFtpSocketServer::GetLastTransferTime() const
+{
+    return FLastTransferTime;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetLastTransferLatency
+#
+#   Purpose....: Get time from start of last transfer to first data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Milliseconds
+#
+##########################################################################*/
+int TFtpSocketServer::GetLastTransferLatency() const
+{
+    return FLastTransferLatency;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::GetLastTransferRate
+#
+#   Purpose....: Get rate of last transfer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Bytes per second
+#
+##########################################################################*/
+long long TFtpSocketServer::GetLastTransferRate() const
+{
+    if (FLastTransferTime > 0)
+        return 1000 * FLastTransferSize / FLastTransferTime;
+    else
+        return FLastTransferSize * 1000;
+}
+
 /*##########################################################################
 #
 #   Name       : TFtpSocketServer::Reply
@@ -295,6 +513,71 @@ void TFtpSocketServer::Reply(TFtpLangString *msg)
          msg->Write(FSocket);
 }
 
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::Reply
+#
+#   Purpose....: Reply with code and formatted text
+#
+#   In params..: Code
+#                Text
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServer::Reply(int Code, const char *Text)
+{
+    char str[5];
+
+    sprintf(str, "%03d ", Code);
+
+    FSocket->Write(str);
+    FSocket->Write(Text);
+    FSocket->Write("\r\n");
+    FSocket->Push();
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::ReplyStart
+#
+#   Purpose....: Start a multi-line reply
+#
+#   In params..: Code
+#                Text
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServer::ReplyStart(int Code, const char *Text)
+{
+    char str[5];
+
+    sprintf(str, "%03d-", Code);
+
+    FSocket->Write(str);
+    FSocket->Write(Text);
+    FSocket->Write("\r\n");
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSocketServer::ReplyLine
+#
+#   Purpose....: Write a continuation line of a multi-line reply
+#
+#   In params..: Text
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSocketServer::ReplyLine(const char *Text)
+{
+    FSocket->Write(" ");
+    FSocket->Write(Text);
+    FSocket->Write("\r\n");
+}
+
 /*##########################################################################
 #
 #   Name       : TFtpSocketServer::VerifyUser
@@ -342,7 +625,7 @@ int TFtpSocketServer::OpenDataConnection(long IP, int port)
                 if (FDataSocket)
                         delete FDataSocket;
 
-                FDataSocket = new TTcpSocket(IP, port, 6000, 0x2000);
+                FDataSocket = new TTcpSocket(IP, port, 6000, FDataBufferSize);
 
                 if (FDataSocket->WaitForConnection(6000))
                         return TRUE;
@@ -374,10 +657,10 @@ void TFtpSocketServer::ListenForDataConnection(long *IP, int *port)
         delete FDataSocket;
 
     if (FLocalPort)
-        FDataSocket = new TTcpSocket(FSocket->GetRemoteIP(), FLocalPort, 0, 6000, 0x2000);
+        FDataSocket = new TTcpSocket(FSocket->GetRemoteIP(), FLocalPort, 0, 6000, FDataBufferSize);
     else
     {
-        FDataSocket = new TTcpSocket(FSocket->GetRemoteIP(), 0, 6000, 0x2000);
+        FDataSocket = new TTcpSocket(FSocket->GetRemoteIP(), 0, 6000, FDataBufferSize);
         FLocalPort = FDataSocket->GetLocalPort();
     }
     *port = FLocalPort;
@@ -37,6 +37,8 @@
 #include "ftplang.h"
 #include "ftpacc.h"
 
+#define FTP_DATA_BUFFER_SIZE    0x2000
+
 enum InternalErrorCodes
 {
 	E_None = 0,
@@ -78,7 +80,22 @@ public:
 	void ListenForDataConnection(long *IP, int *port);
 	void Quit();
 
+	void StartTransfer();
+	void TransferData(int Size, int Received);
+	void EndTransfer();
+
+	long long GetBytesSent() const;
+	long long GetBytesReceived() const;
+	int GetTransferCount() const;
+	long long GetLastTransferSize() const;
+	int GetLastTransferTime() const;
+	int GetLastTransferLatency() const;
+	long long GetLastTransferRate() const;
+
 	void Reply(TFtpLangString *Msg);
+	void Reply(int Code, const char *Text);
+	void ReplyStart(int Code, const char *Text);
+	void ReplyLine(const char *Text);
 
 	void (*OnCommand)(TFtpSocketServer *server, const char *str);
 
@@ -96,11 +113,30 @@ public:
 	TString CurrDir;
 	TString RootDir;
 
+	long long FRestartPos;
+	int FTransferSize;
+	int FDataBufferSize;
+
     long FMyIp;
 	int FLocalPort;
 
 	TTcpSocket *FDataSocket;
 	TFtpUser *FUserList;
+
+protected:
+	static int GetElapsedMs(long long Start, long long End);
+
+	long long FBytesSent;
+	long long FBytesReceived;
+	int FTransferCount;
+
+	long long FTransferStart;
+	long long FTransferBytes;
+	int FTransferLatency;
+
+	long long FLastTransferSize;
+	int FLastTransferTime;
+	int FLastTransferLatency;
 };
 
 #endif
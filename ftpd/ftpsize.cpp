@@ -0,0 +1,152 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftpsize.cpp
+# Ftp Size command class
+#
+########################################################################*/
+
+#include <string.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#include "ftpserv.h"
+#include "ftpsize.h"
+#include "path.h"
+#include "file.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : TFtpSizeFactory::TFtpSizeFactory
+#
+#   Purpose....: Constructor for TFtpSizeFactory
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpSizeFactory::TFtpSizeFactory()
+  : TFtpCommandFactory("SIZE")
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSizeFactory::Create
+#
+#   Purpose....: Create a command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpCommand *TFtpSizeFactory::Create(TFtpSocketServer *Server, const char *param)
+{
+    return new TFtpSizeCommand(Server, param);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSizeCommand::TFtpSizeCommand
+#
+#   Purpose....: Constructor for TFtpSizeCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpSizeCommand::TFtpSizeCommand(TFtpSocketServer *Server, const char *param)
+  : TFtpCommand(Server, param)
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSizeCommand::~TFtpSizeCommand
+#
+#   Purpose....: Destructor for TFtpSizeCommand
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpSizeCommand::~TFtpSizeCommand()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpSizeCommand::Execute
+#
+#   Purpose....: Run command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpSizeCommand::Execute(char *param)
+{
+    TFtpLangString msg;
+    char str[40];
+    int ok;
+
+    if (FServer->VerifyUser())
+    {
+        ok = ScanCmdLine(param, 0);
+        if (ok)
+            ok = (FArgCount == 1);
+
+        if (ok)
+        {
+            TPathName relpath = TPathName(FServer->CurrDir) + TString(FArgList->FName);
+            TPathName abspath = TPathName(FServer->RootDir) + relpath.Get();
+
+            if (abspath.IsFile())
+            {
+                TFile file = abspath.OpenFile();
+                sprintf(str, "%lld", file.GetSize());
+                FServer->Reply(213, str);
+                return;
+            }
+            else
+                msg.Load(550);
+        }
+        else
+            msg.Load(501);
+    }
+    else
+        msg.Load(530);
+
+    FServer->Reply(&msg);
+}
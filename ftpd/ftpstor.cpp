@@ -37,6 +37,7 @@
 #include "ftpstor.h"
 #include "path.h"
 #include "file.h"
+#include "ftpxfer.h"
 
 #define FALSE 0
 #define TRUE !FALSE
@@ -119,42 +120,78 @@ int TFtpStorCommand::SaveFile(const char *name)
 {
     TFtpLangString msg;
     int size;
-    int totalsize = 0;
+    int len;
+    int bufsize = FServer->FTransferSize;
     int res;
-    char *buf = new char[512];
+    char *buf;
     TPathName relpath = TPathName(FServer->CurrDir) + TString(name);
     TPathName abspath = TPathName(FServer->RootDir) + relpath.Get();
-    TFile file = abspath.CreateFile(0);
+    long long pos = FServer->FRestartPos;
+
+    FServer->FRestartPos = 0;
+
+    TFile file = pos ? abspath.OpenFile() : abspath.CreateFile(0);
 
     if (file.IsOpen())
     {
-        msg.Load(150);
-        FServer->Reply(&msg);    
-
-        while (FServer->IsOpen())
+        if (pos)
         {
-            size = FServer->Read(buf, 512);
-            totalsize += size;
-            file.Write(buf, size);
+            if (pos < file.GetSize())
+                file.SetSize(pos);
+            file.SetPos(pos);
         }
 
-        size = FServer->Read(buf, 512);
-        while (size)
+        msg.Load(150);
+        FServer->Reply(&msg);
+
+        FServer->StartTransfer();
+
+        TFtpTransfer transfer(&file, bufsize, TRUE);
+
+        buf = transfer.GetFree();
+        while (buf)
         {
-            totalsize += size;
-            file.Write(buf, size);
-            size = FServer->Read(buf, 512);
+            len = 0;
+            while (len < bufsize)
+            {
+                size = FServer->Read(buf + len, bufsize - len);
+                if (size > 0)
+                {
+                    len += size;
+                    FServer->TransferData(size, TRUE);
+                }
+                else
+                {
+                    if (!FServer->IsOpen())
+                        break;
+                }
+            }
+
+            if (len)
+            {
+                transfer.PutFull(len);
+                buf = transfer.GetFree();
+            }
+
+            if (len < bufsize)
+            {
+                if (buf)
+                    transfer.PutFull(0);
+                break;
+            }
         }
 
-        FServer->Push();
+        transfer.WaitForDone();
+        FServer->EndTransfer();
 
-        res = 226;
+        if (transfer.IsOk())
+            res = 226;
+        else
+            res = 452;
     }
     else
         res = 450;
 
-    delete buf;
-
     return res;
 }
 
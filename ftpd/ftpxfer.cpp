@@ -0,0 +1,348 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftpxfer.cpp
+# Ftp double-buffered file transfer class
+#
+########################################################################*/
+
+#include <string.h>
+
+#include "ftpxfer.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::TFtpTransfer
+#
+#   Purpose....: Constructor for transfer thread
+#
+#   In params..: File          file to read or write
+#                BufferSize    size of each buffer
+#                Store         TRUE if thread writes file (STOR), FALSE if it reads (RETR)
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpTransfer::TFtpTransfer(TFile *File, int BufferSize, int Store)
+  : FSection("Ftp Transfer")
+{
+    int i;
+
+    FFile = File;
+    FStore = Store;
+    FBufferSize = BufferSize;
+
+    for (i = 0; i < FTP_TRANSFER_BUFFERS; i++)
+    {
+        FBufArr[i] = new char[BufferSize];
+        FSizeArr[i] = 0;
+        FFullArr[i] = FALSE;
+    }
+
+    FHead = 0;
+    FTail = 0;
+    FAbort = FALSE;
+    FError = FALSE;
+    FDone = FALSE;
+
+    if (Store)
+        Start("Ftp Store", 0x2000);
+    else
+        Start("Ftp Retrieve", 0x2000);
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::~TFtpTransfer
+#
+#   Purpose....: Destructor for transfer thread
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFtpTransfer::~TFtpTransfer()
+{
+    int i;
+
+    if (!FStore)
+        Abort();
+
+    WaitForDone();
+    Stop();
+
+    for (i = 0; i < FTP_TRANSFER_BUFFERS; i++)
+        delete[] FBufArr[i];
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::GetFree
+#
+#   Purpose....: Wait for an empty buffer to fill
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Buffer, or 0 if transfer was aborted
+#
+##########################################################################*/
+char *TFtpTransfer::GetFree()
+{
+    char *buf;
+
+    FSection.Enter();
+
+    while (!FAbort && FFullArr[FHead])
+    {
+        FSection.Leave();
+        FFreeSignal.WaitForever();
+        FSection.Enter();
+    }
+
+    if (FAbort)
+        buf = 0;
+    else
+        buf = FBufArr[FHead];
+
+    FSection.Leave();
+
+    return buf;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::PutFull
+#
+#   Purpose....: Hand over buffer from GetFree
+#
+#   In params..: Size          bytes in buffer, 0 for end of data
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpTransfer::PutFull(int Size)
+{
+    FSection.Enter();
+
+    FSizeArr[FHead] = Size;
+    FFullArr[FHead] = TRUE;
+    FHead = (FHead + 1) % FTP_TRANSFER_BUFFERS;
+
+    FSection.Leave();
+
+    FFullSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::GetFull
+#
+#   Purpose....: Wait for a filled buffer
+#
+#   In params..: *
+#   Out params.: Size          bytes in buffer, 0 at end of data
+#   Returns....: Buffer, or 0 at end of data or abort
+#
+##########################################################################*/
+char *TFtpTransfer::GetFull(int *Size)
+{
+    char *buf;
+
+    FSection.Enter();
+
+    while (!FAbort && !FFullArr[FTail])
+    {
+        FSection.Leave();
+        FFullSignal.WaitForever();
+        FSection.Enter();
+    }
+
+    if (FAbort || FSizeArr[FTail] == 0)
+    {
+        *Size = 0;
+        buf = 0;
+    }
+    else
+    {
+        *Size = FSizeArr[FTail];
+        buf = FBufArr[FTail];
+    }
+
+    FSection.Leave();
+
+    return buf;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::PutFree
+#
+#   Purpose....: Return buffer from GetFull
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpTransfer::PutFree()
+{
+    FSection.Enter();
+
+    FFullArr[FTail] = FALSE;
+    FTail = (FTail + 1) % FTP_TRANSFER_BUFFERS;
+
+    FSection.Leave();
+
+    FFreeSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::Abort
+#
+#   Purpose....: Abort transfer and wake up both sides
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpTransfer::Abort()
+{
+    FSection.Enter();
+    FAbort = TRUE;
+    FSection.Leave();
+
+    FFreeSignal.Signal();
+    FFullSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::WaitForDone
+#
+#   Purpose....: Wait until file side has finished
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpTransfer::WaitForDone()
+{
+    FSection.Enter();
+
+    while (!FDone)
+    {
+        FSection.Leave();
+        FDoneSignal.WaitForever();
+        FSection.Enter();
+    }
+
+    FSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::IsOk
+#
+#   Purpose....: Check if file side completed without error
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TFtpTransfer::IsOk()
+{
+    return !FError;
+}
+
+/*##########################################################################
+#
+#   Name       : TFtpTransfer::Execute
+#
+#   Purpose....: Read file into buffers (RETR), or write buffers to file (STOR)
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFtpTransfer::Execute()
+{
+    char *buf;
+    int size;
+    int count;
+
+    if (FStore)
+    {
+        for (;;)
+        {
+            buf = GetFull(&size);
+            if (!buf)
+                break;
+
+            count = FFile->Write(buf, size);
+            PutFree();
+
+            if (count != size)
+            {
+                FError = TRUE;
+                Abort();
+                break;
+            }
+        }
+    }
+    else
+    {
+        for (;;)
+        {
+            buf = GetFree();
+            if (!buf)
+                break;
+
+            size = FFile->Read(buf, FBufferSize);
+            if (size < 0)
+                size = 0;
+
+            PutFull(size);
+
+            if (size <= 0)
+                break;
+        }
+    }
+
+    FSection.Enter();
+    FDone = TRUE;
+    FSection.Leave();
+
+    FDoneSignal.Signal();
+}
@@ -0,0 +1,82 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# ftpxfer.h
+# Ftp double-buffered file transfer class
+#
+########################################################################*/
+
+#ifndef _FTPXFER_H
+#define _FTPXFER_H
+
+#include "file.h"
+#include "thread.h"
+#include "section.h"
+#include "sigdev.h"
+
+#define FTP_TRANSFER_SIZE       0x10000
+#define FTP_TRANSFER_BUFFERS    2
+
+class TFtpTransfer : public TThread
+{
+public:
+    TFtpTransfer(TFile *File, int BufferSize, int Store);
+    virtual ~TFtpTransfer();
+
+    char *GetFree();
+    void PutFull(int Size);
+
+    char *GetFull(int *Size);
+    void PutFree();
+
+    void Abort();
+    void WaitForDone();
+    int IsOk();
+
+protected:
+    virtual void Execute();
+
+    TFile *FFile;
+    int FStore;
+    int FBufferSize;
+
+    char *FBufArr[FTP_TRANSFER_BUFFERS];
+    int FSizeArr[FTP_TRANSFER_BUFFERS];
+    int FFullArr[FTP_TRANSFER_BUFFERS];
+    int FHead;
+    int FTail;
+
+    int FAbort;
+    int FError;
+    int FDone;
+
+    TSection FSection;
+    TSignalDevice FFullSignal;
+    TSignalDevice FFreeSignal;
+    TSignalDevice FDoneSignal;
+};
+
+#endif
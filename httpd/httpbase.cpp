@@ -62,6 +62,7 @@ THttpServerFactory::THttpServerFactory()
     KeepAlive = 15;
     FPageList = 0;
     FDirList = 0;
+    FCompressor = 0;
 }
 
 /*##########################################################################
@@ -77,6 +78,8 @@ THttpServerFactory::THttpServerFactory()
 ##########################################################################*/
 THttpServerFactory::~THttpServerFactory()
 {
+    if (FCompressor)
+        delete FCompressor;
 }
 
 /*##########################################################################
@@ -93,6 +96,14 @@ THttpServerFactory::~THttpServerFactory()
 void THttpServerFactory::AddCustomPage(THttpCustomPageFactory *page)
 {
     THttpCustomPageFactory *curr;
+    int i;
+    int count;
+
+    page->FRoutes = &FRoutes;
+    count = page->FReqNameList.GetSize();
+
+    for (i = 0; i < count; i++)
+        FRoutes.AddPage(page->FReqNameList[i].GetData(), page);
 
     page->FList = 0;
     curr = FPageList;
@@ -122,6 +133,14 @@ void THttpServerFactory::AddCustomPage(THttpCustomPageFactory *page)
 void THttpServerFactory::AddCustomDir(THttpCustomDirFactory *dir)
 {
     THttpCustomDirFactory *curr;
+    int i;
+    int count;
+
+    dir->FRoutes = &FRoutes;
+    count = dir->FReqNameList.GetSize();
+
+    for (i = 0; i < count; i++)
+        FRoutes.AddDir(dir->FReqNameList[i].GetData(), dir);
 
     dir->FList = 0;
     curr = FDirList;
@@ -137,6 +156,26 @@ void THttpServerFactory::AddCustomDir(THttpCustomDirFactory *dir)
         FDirList = dir;    
 }
 
+/*##########################################################################
+#
+#   Name       : THttpServerFactory::EnableCompression
+#
+#   Purpose....: Enable gzip / deflate content encoding. Returns compressor
+#                so thresholds and cache size can be adjusted
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCompressor *THttpServerFactory::EnableCompression()
+{
+    if (!FCompressor)
+        FCompressor = new THttpCompressor;
+
+    return FCompressor;
+}
+
 /*##########################################################################
 #
 #   Name       : THttpServerFactory::LinkServer
@@ -156,4 +195,6 @@ void THttpServerFactory::LinkServer(THttpSocketServer *server)
     server->KeepAlive = KeepAlive;
     server->FPageList = FPageList;
     server->FDirList = FDirList;
+    server->FCompressor = FCompressor;
+    server->FRoutes = &FRoutes;
 }
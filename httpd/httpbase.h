@@ -33,6 +33,7 @@
 #define _HTTPBASE_H
 
 #include "httpcmd.h"
+#include "httproute.h"
 
 class THttpServerFactory
 {
@@ -43,6 +44,8 @@ public:
     void AddCustomPage(THttpCustomPageFactory *page);
     void AddCustomDir(THttpCustomDirFactory *dir);
 
+    THttpCompressor *EnableCompression();
+
     void (*OnCommand)(THttpSocketServer *server, const char *str);
     int (*OnAuthorize)(THttpSocketServer *server, const char *user, const char *passw);
 
@@ -54,6 +57,8 @@ protected:
 
     THttpCustomPageFactory *FPageList;
     THttpCustomDirFactory *FDirList;
+    THttpCompressor *FCompressor;
+    THttpRouteTable FRoutes;
 };
 
 #endif
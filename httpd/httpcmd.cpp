@@ -142,25 +142,22 @@ THttpArg::~THttpArg()
 #
 #   Name       : THttpCommand::THttpCommand
 #
-#   Purpose....: Constructor for command
+#   Purpose....: Constructor for command. A command object is reused for all
+#                requests on a connection
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-THttpCommand::THttpCommand(THttpSocketServer *Server, TString Method, TString Param)
-  : FMethod(Method),
-        FCmdLine(Param)
+THttpCommand::THttpCommand(THttpSocketServer *Server)
 {
     FServer = Server;
-    FArgList = 0;
     FParamList = 0;
-    FOptCount = 0;
     FOptList = 0;
     FContentData = 0;
-    FContentSize = 0;
-    FAuthOk = FALSE;
+
+    Reset();
 }
 
 /*##########################################################################
@@ -175,19 +172,26 @@ THttpCommand::THttpCommand(THttpSocketServer *Server, TString Method, TString Pa
 #
 ##########################################################################*/
 THttpCommand::~THttpCommand()
+{
+    Reset();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCommand::Reset
+#
+#   Purpose....: Release per-request data before next request
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCommand::Reset()
 {
     THttpParam *param;
-    THttpArg *arg;
     THttpOption *opt;
 
-    arg = FArgList;
-    while (arg)
-    {
-        FArgList = arg->FList;
-        delete arg;
-        arg = FArgList;
-    }
-
     param = FParamList;
     while (param)
     {
@@ -206,45 +210,18 @@ THttpCommand::~THttpCommand()
 
     if (FContentData)
         delete FContentData;
-}
-
-/*##########################################################################
-#
-#   Name       : THttpParser::SkipOptDelim
-#
-#   Purpose....: Skip to next option delimiter
-#
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
-#
-##########################################################################*/
-char *THttpCommand::SkipOptDelim(char *p)
-{
-    int ch, quote;
-    int more;
 
-    quote = 0;
-    for (;;)
-    {
-        ch = *p;
-
-        if (!ch)
-            break;
-
-        more = !(iscntrl(ch) || ch == ':');
-
-        if (!quote && !more)
-            break;
-
-        if (quote == ch)
-            quote = 0;
-        else
-            if (strchr("\"", ch))
-                quote = ch;
-        p++;
-    }
-    return p;
+    FContentData = 0;
+    FContentSize = 0;
+    FHeaderCount = 0;
+    FAuthOk = FALSE;
+    FKeepAlive = FALSE;
+    FMajor = 0;
+    FMinor = 0;
+    FMethod = "";
+    FPath = "";
+    FUserAgent = "";
+    FUser = "";
 }
 
 /*##########################################################################
@@ -253,12 +230,12 @@ char *THttpCommand::SkipOptDelim(char *p)
 #
 #   Purpose....: Decode a time option
 #
-#   In params..: *
-#   Out params.: *
-#   Returns....: *
+#   In params..: opt
+#   Out params.: time
+#   Returns....: TRUE if option is a valid time
 #
 ##########################################################################*/
-TDateTime THttpCommand::DecodeTime(THttpOption *opt)
+int THttpCommand::DecodeTime(THttpOption *opt, TDateTime &time)
 {
     char str[40];
     const char *ptr;
@@ -301,353 +278,370 @@ TDateTime THttpCommand::DecodeTime(THttpOption *opt)
         ok = FALSE;
 
     if (ok)
-        return TDateTime(year, month, day, hour, min, sec, 0, 0);
-    else
-        return TDateTime();
+        time = TDateTime(year, month, day, hour, min, sec, 0, 0);
+
+    return ok;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::FindOption
+#   Name       : THttpCommand::IsName
 #
-#   Purpose....: Find an option
+#   Purpose....: Case-insensitive compare of header names
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-THttpOption *THttpCommand::FindOption(const char *name)
+int THttpCommand::IsName(const char *Name, const char *Match)
 {
-    THttpOption *curr;
-    TString Name(name);
-
-    curr = FOptList;
-
-    while (curr)
+    while (*Name && toupper(*Name) == toupper(*Match))
     {
-        if (curr->FName == Name)
-            return curr;
-        else
-            curr = curr->FList;
+        Name++;
+        Match++;
     }
 
-    return 0;
+    return *Name == 0 && *Match == 0;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::GetModifedSince
+#   Name       : THttpCommand::HasToken
 #
-#   Purpose....: Get modified since date
+#   Purpose....: Case-insensitive search for a token in a comma separated
+#                header value
 #
-#   In params..: *
+#   In params..: List           header value
+#                Token
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if token is in list
 #
 ##########################################################################*/
-TDateTime THttpCommand::GetModifiedSince()
+int THttpCommand::HasToken(const char *List, const char *Token)
 {
-    THttpOption *opt = FindOption("If-Modified-Since");
+    const char *match;
 
-    if (opt)
-        return DecodeTime(opt);
-    else
-        return TDateTime();
+    while (*List)
+    {
+        while (*List == ' ' || *List == 0x9 || *List == ',')
+            List++;
+
+        match = Token;
+        while (*List && *match && toupper(*List) == toupper(*match))
+        {
+            List++;
+            match++;
+        }
+
+        if (*match == 0)
+        {
+            while (*List == ' ' || *List == 0x9)
+                List++;
+
+            if (*List == 0 || *List == ',')
+                return TRUE;
+        }
+
+        while (*List && *List != ',')
+            List++;
+    }
+
+    return FALSE;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::CheckAuthorization
+#   Name       : THttpCommand::GetHeader
 #
-#   Purpose....: Check authorization
+#   Purpose....: Get raw header value
 #
-#   In params..: *
+#   In params..: Header name
 #   Out params.: *
-#   Returns....: *
+#   Returns....: Value in receive buffer, or 0
 #
 ##########################################################################*/
-void THttpCommand::CheckAuthorization(const char *param)
+const char *THttpCommand::GetHeader(const char *name)
 {
-    int len;
-    char *str;
-    char *passw;
+    int i;
 
-    if (strstr(param, "Basic"))
-    {
-        len = strlen(param);
-        str = new char[len];
-        
-        DecodeBase64(param + 6, str);
-        passw = strchr(str, ':');
-        if (passw)
-        {
-            *passw = 0;
-            passw++;
-            
-            if (FServer->OnAuthorize)
-            {
-                FUser = TString(str);
-                FAuthOk = (*FServer->OnAuthorize)(FServer, str, passw);
-            }
-        }
-                    
-        delete str;
-    }
+    for (i = 0; i < FHeaderCount; i++)
+        if (IsName(FHeaderArr[i].Name, name))
+            return FHeaderArr[i].Value;
+
+    return 0;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::AddArg
+#   Name       : THttpCommand::FindOption
 #
-#   Purpose....: Add an argument
+#   Purpose....: Find an option. Options are only split into arguments
+#                when asked for, and are then kept until the request is done
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void THttpCommand::AddArg(const char *name)
+THttpOption *THttpCommand::FindOption(const char *name)
 {
-    THttpArg *arg = new THttpArg(name);
-    THttpArg *curr;
+    THttpOption *curr;
+    int i;
 
-    arg->FList = 0;
-    curr = FArgList;
-   
-    if (curr)
+    curr = FOptList;
+
+    while (curr)
     {
-        while (curr->FList)
+        if (IsName(curr->FName.GetData(), name))
+            return curr;
+        else
             curr = curr->FList;
+    }
 
-        curr->FList = arg;
+    for (i = 0; i < FHeaderCount; i++)
+    {
+        if (IsName(FHeaderArr[i].Name, name))
+        {
+            curr = new THttpOption(FHeaderArr[i].Name, (char *)FHeaderArr[i].Value);
+            curr->FList = FOptList;
+            FOptList = curr;
+            return curr;
+        }
     }
-    else
-        FArgList = arg;    
+
+    return 0;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::AddArg
+#   Name       : THttpCommand::GetModifedSince
 #
-#   Purpose....: Add an argument
+#   Purpose....: Get modified since date
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void THttpCommand::AddArg(char *sBeg, char **sEnd)
-{ 
-    char *arg;
-
-    *sEnd = SkipWord(sBeg);
-    arg = THttpSocketServer::Unquote(sBeg, *sEnd);
-    AddArg(arg);
-    delete arg;
+TDateTime THttpCommand::GetModifiedSince()
+{
+    THttpOption *opt = FindOption("If-Modified-Since");
+    TDateTime time;
+
+    if (opt)
+        DecodeTime(opt, time);
+
+    return time;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::AddOpt
+#   Name       : THttpCommand::IsNotModified
 #
-#   Purpose....: Add an option
+#   Purpose....: Check If-Modified-Since at second granularity, since
+#                HTTP dates have no fractions
 #
-#   In params..: *
+#   In params..: time           last modification time of resource
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if resource is not newer than requested date
 #
 ##########################################################################*/
-void THttpCommand::AddOpt(char *name, char *param)
+int THttpCommand::IsNotModified(const TDateTime &time)
 {
-    THttpOption *opt = new THttpOption(name, param);
-    THttpOption *curr;
-
-    if (!strcmp(name, "User-Agent"))
-        FUserAgent = param;
-
-    if (!strcmp(name, "Content-Length"))
-        sscanf(param, "%d", &FContentSize);
-
-    if (!strcmp(name, "Authorization"))
-        CheckAuthorization(param);
-            
-    opt->FList = 0;
-    curr = FOptList;
-   
-    if (curr)
-    {
-        while (curr->FList)
-            curr = curr->FList;
+    THttpOption *opt = FindOption("If-Modified-Since");
+    TDateTime since;
 
-        curr->FList = opt;
-    }
+    if (opt && DecodeTime(opt, since))
+        return time.GetLinuxTimestamp() <= since.GetLinuxTimestamp();
     else
-        FOptList = opt;    
+        return FALSE;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::AddParam
+#   Name       : THttpCommand::AcceptEncoding
 #
-#   Purpose....: Add a parameter
+#   Purpose....: Check if client accepts a content encoding
 #
-#   In params..: *
+#   In params..: Encoding name, like "gzip"
 #   Out params.: *
-#   Returns....: *
+#   Returns....: TRUE if listed in Accept-Encoding with non-zero quality
 #
 ##########################################################################*/
-char *THttpCommand::AddParam(char *p)
+int THttpCommand::AcceptEncoding(const char *encoding)
 {
-    THttpParam *param;
-    THttpParam *curr;
-    char *pstr = p;
-    char *vstr = 0;
-    char ch;
+    const char *ptr = GetHeader("Accept-Encoding");
+    const char *q;
+    int len = strlen(encoding);
 
-    while (*p)
-    {
-        if (*p == '=')
-        {
-            *p = 0;
-            vstr = p + 1;
-            break;
-        }
-        else
-            p++;
-    }
+    if (!ptr)
+        return FALSE;
 
-    if (vstr)
+    while (*ptr)
     {
-        p = vstr;
-        while (*p)
+        while (*ptr == ' ' || *ptr == ',')
+            ptr++;
+
+        if (!strncmp(ptr, encoding, len) || (ptr[0] == '*' && !isalnum(ptr[1])))
         {
-            if (isalnum(*p))
-                p++;
+            if (*ptr == '*')
+                ptr++;
             else
-            {
-                ch = *p;
-                *p = 0;
+                ptr += len;
 
-                param = new THttpParam(pstr, vstr);
-                param->FList = 0;
-                curr = FParamList;
-   
-                if (curr)
-                {
-                    while (curr->FList)
-                        curr = curr->FList;
+            while (*ptr == ' ')
+                ptr++;
 
-                    curr->FList = param;
-                }
-                else
-                    FParamList = param;    
+            if (*ptr == 0 || *ptr == ',')
+                return TRUE;
 
-                *p = ch;
-                return p;
+            if (*ptr == ';')
+            {
+                q = strstr(ptr, "q=");
+                if (!q)
+                    return TRUE;
+
+                q += 2;
+                while (*q == '0' || *q == '.')
+                    q++;
+
+                return isdigit(*q) != 0;
             }
-        }        
-    }                           
-    return p;
+        }
+
+        while (*ptr && *ptr != ',')
+            ptr++;
+    }
+
+    return FALSE;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::Split
+#   Name       : THttpCommand::GetEncoding
 #
-#   Purpose....: Split line into arguments
+#   Purpose....: Select content encoding for a response
 #
-#   In params..: *
+#   In params..: ContentType
 #   Out params.: *
-#   Returns....: *
+#   Returns....: HTTP_ENCODING_xxx
 #
 ##########################################################################*/
-void THttpCommand::Split(char *s)
+int THttpCommand::GetEncoding(const char *ContentType)
 {
-    char *start;
-    char *pstart;
+    if (!FServer->FCompressor)
+        return HTTP_ENCODING_NONE;
 
-    if (s)
-    {
-        start = strchr(s, '?');
-        if (start)
-        {
-            *start = 0;
-            pstart = start + 1;
-        
-            start = SkipDelim(s);
-            while (*start)
-            {
-                AddArg(start, &s);
-                start = SkipDelim(s);
-            }
+    if (!THttpCompressor::IsCompressible(ContentType))
+        return HTTP_ENCODING_NONE;
 
-            start = pstart;
-                    
-            while (start)
-            {
-                s = AddParam(pstart);
-                start = strchr(s, '&');
-                if (start)
-                    pstart = start + 1;
-            }               
-        } 
-        
-        start = SkipDelim(s);
-        while (*start)
-        {
-            AddArg(start, &s);
-            start = SkipDelim(s);
-        }
-    }
+    if (AcceptEncoding("gzip"))
+        return HTTP_ENCODING_GZIP;
+
+    if (AcceptEncoding("deflate"))
+        return HTTP_ENCODING_DEFLATE;
+
+    return HTTP_ENCODING_NONE;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::Parse
+#   Name       : THttpCommand::CheckAuthorization
 #
-#   Purpose....: Parse arguments
+#   Purpose....: Check authorization
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int THttpCommand::Parse(void *arg)
+void THttpCommand::CheckAuthorization(const char *param)
 {
-    THttpArg *argv;
-
-    FArgCount = 0;
+    int len;
+    char *str;
+    char *passw;
 
-    argv = FArgList;    
-    while (argv)
+    if (strstr(param, "Basic"))
     {
-        FArgCount++;    
-        argv = argv->FList;
+        len = strlen(param);
+        str = new char[len];
+        
+        DecodeBase64(param + 6, str);
+        passw = strchr(str, ':');
+        if (passw)
+        {
+            *passw = 0;
+            passw++;
+            
+            if (FServer->OnAuthorize)
+            {
+                FUser = TString(str);
+                FAuthOk = (*FServer->OnAuthorize)(FServer, str, passw);
+            }
+        }
+                    
+        delete str;
     }
-
-    return E_None;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::ScanCmdLine
+#   Name       : THttpCommand::AddParam
 #
-#   Purpose....: Scan cmd line
+#   Purpose....: Add a parameter
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-int THttpCommand::ScanCmdLine(char *line, void *arg)
+char *THttpCommand::AddParam(char *p)
 {
-    Split(line);
+    THttpParam *param;
+    THttpParam *curr;
+    char *pstr = p;
+    char *vstr = 0;
+    char ch;
 
-    if (Parse(arg) != E_None)
-        return FALSE;
-    else
-        return TRUE;
+    while (*p)
+    {
+        if (*p == '=')
+        {
+            *p = 0;
+            vstr = p + 1;
+            break;
+        }
+        else
+            p++;
+    }
+
+    if (vstr)
+    {
+        p = vstr;
+        while (isalnum(*p))
+            p++;
+
+        ch = *p;
+        *p = 0;
+
+        param = new THttpParam(pstr, vstr);
+        param->FList = 0;
+        curr = FParamList;
+   
+        if (curr)
+        {
+            while (curr->FList)
+                curr = curr->FList;
+
+            curr->FList = param;
+        }
+        else
+            FParamList = param;    
+
+        *p = ch;
+    }                           
+    return p;
 }
 
 /*##########################################################################
@@ -696,7 +690,7 @@ int THttpCommand::IsEmpty()
 ##########################################################################*/
 int THttpCommand::IsMSIE()
 {
-    const char *ptr = FUserAgent.GetData();
+    const char *ptr = FUserAgent;
 
     if (strstr(ptr, "Opera"))
         return FALSE;
@@ -837,12 +831,24 @@ const char *THttpCommand::GetErrorText(int ErrorCode)
         case 304:
             return "NOT MODIFIED";
 
+        case 400:
+            return "BAD REQUEST";
+
         case 401:
             return "UNATHORIZED";
                 
         case 404:
             return "NOT FOUND";
+
+        case 413:
+            return "PAYLOAD TOO LARGE";
+
+        case 501:
+            return "NOT IMPLEMENTED";
             
+        case 505:
+            return "HTTP VERSION NOT SUPPORTED";
+
         default:
             return "UNKNOWN ERROR";
     }
@@ -875,6 +881,12 @@ void THttpCommand::WriteStartHeader(int ErrorCode)
         {
             WriteTimeOption("Date", CurrTime);
             WriteOption("Server", "RDOS");
+
+            if (FMinor == 0 && FKeepAlive)
+                WriteOption("Connection", "keep-alive");
+
+            if (FMinor != 0 && !FKeepAlive)
+                WriteOption("Connection", "close");
         }
     }
 }
@@ -938,6 +950,8 @@ void THttpCommand::WriteError(int ErrorCode)
 void THttpCommand::WriteFile(TPathName &path, const char *ContentType)
 {
     int count;
+    int Encoding;
+    THttpCompressEntry *entry = 0;
 
     TFile file = path.OpenFile();
     TDateTime time(file.GetTime());
@@ -949,22 +963,46 @@ void THttpCommand::WriteFile(TPathName &path, const char *ContentType)
     }
     else
     {
-        char *Buf = new char[512];
+        Encoding = GetEncoding(ContentType);
+
+        if (Encoding != HTTP_ENCODING_NONE)
+            entry = FServer->FCompressor->GetFile(file, path.Get().GetData(), time, Encoding);
 
         WriteStartHeader(200);
         WriteTimeOption("Last-Modified", time);
-        WriteOption("Accept-Ranges", "bytes");
+
+        if (FServer->FCompressor && THttpCompressor::IsCompressible(ContentType))
+            WriteOption("Vary", "Accept-Encoding");
+
         WriteOption("Content-Type", ContentType);
-        WriteLongOption("Content-Length", (int)file.GetSize());
-        WriteEndHeader();
 
-        count = file.Read(Buf, 512);
-        while (count)
+        if (entry && entry->GetData())
+        {
+            WriteOption("Content-Encoding", THttpCompressor::GetEncodingName(entry->GetEncoding()));
+            WriteLongOption("Content-Length", entry->GetSize());
+            WriteEndHeader();
+
+            FServer->Write(entry->GetData(), entry->GetSize());
+        }
+        else
         {
-            FServer->Write(Buf, count);
+            char *Buf = new char[512];
+
+            WriteOption("Accept-Ranges", "bytes");
+            WriteLongOption("Content-Length", (int)file.GetSize());
+            WriteEndHeader();
+
             count = file.Read(Buf, 512);
+            while (count)
+            {
+                FServer->Write(Buf, count);
+                count = file.Read(Buf, 512);
+            }
+            delete[] Buf;
         }
-        delete Buf;
+
+        if (entry)
+            FServer->FCompressor->Release(entry);
 
         FServer->Push();
 
@@ -985,14 +1023,37 @@ void THttpCommand::WriteFile(TPathName &path, const char *ContentType)
 void THttpCommand::SendData(const char *Data, const char *ContentType)
 {
     int Size = strlen(Data);
+    int Encoding = GetEncoding(ContentType);
+    char *CompData = 0;
+    int CompSize;
+
+    if (Encoding != HTTP_ENCODING_NONE)
+        CompData = FServer->FCompressor->Compress(Data, Size, Encoding, &CompSize);
     
     WriteStartHeader(200);
-    WriteOption("Accept-Ranges", "bytes");
+
+    if (FServer->FCompressor && THttpCompressor::IsCompressible(ContentType))
+        WriteOption("Vary", "Accept-Encoding");
+
     WriteOption("Content-Type", ContentType);
-    WriteLongOption("Content-Length", Size);
-    WriteEndHeader();
 
-    FServer->Write(Data, Size);
+    if (CompData)
+    {
+        WriteOption("Content-Encoding", THttpCompressor::GetEncodingName(Encoding));
+        WriteLongOption("Content-Length", CompSize);
+        WriteEndHeader();
+
+        FServer->Write(CompData, CompSize);
+        delete[] CompData;
+    }
+    else
+    {
+        WriteOption("Accept-Ranges", "bytes");
+        WriteLongOption("Content-Length", Size);
+        WriteEndHeader();
+
+        FServer->Write(Data, Size);
+    }
     FServer->Push();
 }
 
@@ -1011,6 +1072,8 @@ void THttpCommand::StartPush()
 {
     int MSIE = IsMSIE();
 
+    FKeepAlive = FALSE;
+
     WriteStartHeader(200);
 
     if (!MSIE)
@@ -1249,11 +1312,12 @@ void THttpCommand::Execute(const char *Name)
     THttpOption *opt;
     TString param;
 
-    if (FMethod == "GET")
+    if (!strcmp(FMethod, "GET"))
     {
         opt = FindOption("Upgrade");
         if (opt)
         {
+            FKeepAlive = FALSE;
             param = opt->GetArg(0);
             FServer->HandleUpgrade(Name, this, param.GetData());
         }
@@ -1262,12 +1326,16 @@ void THttpCommand::Execute(const char *Name)
     }
     else
     {
-        if (FMethod == "POST")
+        if (!strcmp(FMethod, "POST"))
             Post(Name);
+        else
+        {
+            FKeepAlive = FALSE;
+            WriteError(501);
+        }
     }
 }
 
-
 /*##########################################################################
 #
 #   Name       : THttpCommand::IsOptDelim
@@ -1333,92 +1401,344 @@ void THttpCommand::RTrim(char *str)
 
 /*##########################################################################
 #
-#   Name       : THttpCommand::Run
+#   Name       : THttpCommand::IsKeepAlive
 #
-#   Purpose....: Run command
+#   Purpose....: Check if connection should be kept open after request
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void THttpCommand::Run()
+int THttpCommand::IsKeepAlive()
 {
-    char *param;
-    char *ptr;
-    int size;
-    THttpArg *arg;
-    int ArgCount;
-    char *start;    
+    return FKeepAlive;
+}
 
-    ptr = FServer->ReadLine();
-    while (ptr && *ptr != 0)
+/*##########################################################################
+#
+#   Name       : THttpCommand::ParseContentSize
+#
+#   Purpose....: Parse Content-Length value
+#
+#   In params..: value
+#   Out params.: *
+#   Returns....: size, -1 if not a valid number, or
+#                HTTP_MAX_CONTENT_SIZE + 1 if too large
+#
+##########################################################################*/
+int THttpCommand::ParseContentSize(const char *value)
+{
+    int size = 0;
+
+    value = LTrim(value);
+
+    if (*value < '0' || *value > '9')
+        return -1;
+
+    while (*value >= '0' && *value <= '9')
     {
-        start = SkipOptDelim(ptr);
-        if (*start == ':')
-        {
-            *start = 0;
-            start++;
-            start = (char *)LTrim(start);
-            RTrim(start);
+        if (size <= HTTP_MAX_CONTENT_SIZE)
+            size = 10 * size + *value - '0';
+        value++;
+    }
 
-            ptr = (char *)LTrim(ptr);
-            RTrim(ptr);
+    if (*LTrim(value))
+        return -1;
 
-            AddOpt(ptr, start);
-        }
+    if (size > HTTP_MAX_CONTENT_SIZE)
+        return HTTP_MAX_CONTENT_SIZE + 1;
+
+    return size;
+}
 
-        ptr = FServer->ReadLine();
+/*##########################################################################
+#
+#   Name       : THttpCommand::CheckHeader
+#
+#   Purpose....: Handle headers that are needed by every request
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCommand::CheckHeader(const char *name, char *value)
+{
+    switch (toupper(*name))
+    {
+        case 'A':
+            if (IsName(name, "Authorization"))
+                CheckAuthorization(value);
+            break;
+
+        case 'C':
+            if (IsName(name, "Content-Length"))
+                FContentSize = ParseContentSize(value);
+
+            if (IsName(name, "Connection"))
+            {
+                if (HasToken(value, "close"))
+                    FKeepAlive = FALSE;
+                else
+                    if (HasToken(value, "keep-alive"))
+                        FKeepAlive = TRUE;
+            }
+            break;
+
+        case 'U':
+            if (IsName(name, "User-Agent"))
+                FUserAgent = value;
+            break;
     }
+}
 
-    if (FContentSize)
+/*##########################################################################
+#
+#   Name       : THttpCommand::ParseHeader
+#
+#   Purpose....: Index a header line in place
+#
+#   In params..: Start of line
+#   Out params.: *
+#   Returns....: Start of next line
+#
+##########################################################################*/
+char *THttpCommand::ParseHeader(char *p)
+{
+    char *name = p;
+    char *value;
+    char *end;
+
+    while (*p && *p != ':' && *p != 0xd && *p != 0xa)
+        p++;
+
+    if (*p == ':')
     {
-        FContentData = new char[FContentSize + 1];
-        size = FServer->Read(FContentData, FContentSize);
-        *(FContentData + FContentSize) = 0;
+        end = p;
+        while (end > name && (end[-1] == ' ' || end[-1] == 0x9))
+            end--;
+        *end = 0;
+
+        p++;
+        while (*p == ' ' || *p == 0x9)
+            p++;
+
+        value = p;
+
+        while (*p && *p != 0xd && *p != 0xa)
+            p++;
+
+        end = p;
+        while (end > value && (end[-1] == ' ' || end[-1] == 0x9))
+            end--;
+    }
+    else
+    {
+        name = 0;
+        value = 0;
+        end = p;
     }
 
-    size = FCmdLine.GetSize();
-    param = new char[size + 1];
-    memcpy(param, FCmdLine.GetData(), size + 1);
+    if (*p == 0xd)
+        p++;
+
+    if (*p == 0xa)
+        p++;
 
-    if (ScanCmdLine(param, 0))
+    *end = 0;
+
+    if (name && *name)
     {
-        ArgCount = 0;
-        arg = FArgList;
-        while (arg)
+        if (FHeaderCount < HTTP_MAX_HEADERS)
         {
-            ArgCount++;
-            arg = arg->FList;
+            FHeaderArr[FHeaderCount].Name = name;
+            FHeaderArr[FHeaderCount].Value = value;
+            FHeaderCount++;
         }
+        CheckHeader(name, value);
+    }
+
+    return p;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCommand::Reject
+#
+#   Purpose....: Reply to a request line that cannot be handled. The
+#                reply is sent as HTTP/1.1 with Connection: close
+#
+#   In params..: ErrorCode
+#   Out params.: *
+#   Returns....: FALSE
+#
+##########################################################################*/
+int THttpCommand::Reject(int ErrorCode)
+{
+    FMajor = 1;
+    FMinor = 1;
+    FKeepAlive = FALSE;
+
+    WriteError(ErrorCode);
+    FServer->Push();
+
+    return FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCommand::ParseRequest
+#
+#   Purpose....: Parse request line & headers in a single pass. Strings are
+#                terminated in place in the server receive buffer and only
+#                referenced by pointer, so no per-header allocation is done
+#
+#   In params..: Request header block, terminated by empty line
+#   Out params.: *
+#   Returns....: TRUE if request line is valid, else an error reply
+#                is sent and the connection should be closed
+#
+##########################################################################*/
+int THttpCommand::ParseRequest(char *Data)
+{
+    char *p = Data;
+    char *method;
+    char *target;
+    char *version;
+    char *query;
+    char *start;
+
+    Reset();
+
+    method = p;
+    while (*p && *p != ' ' && *p != 0xd && *p != 0xa)
+    {
+        *p = toupper(*p);
+        p++;
+    }
+
+    if (*p != ' ' || p == method)
+        return Reject(400);
+
+    *p = 0;
+    p++;
+
+    while (*p == ' ')
+        p++;
 
-        if (ArgCount == 2)
+    target = p;
+    while (*p && *p != ' ' && *p != 0xd && *p != 0xa)
+        p++;
+
+    if (p == target)
+        return Reject(400);
+
+    if (*p != ' ')
+        return Reject(505);
+
+    *p = 0;
+    p++;
+
+    version = p;
+    while (*p && *p != 0xd && *p != 0xa)
+        p++;
+
+    if (*p == 0xd)
+    {
+        *p = 0;
+        p++;
+    }
+
+    if (*p == 0xa)
+    {
+        *p = 0;
+        p++;
+    }
+
+    if (!strcmp(version, "HTTP/1.0"))
+    {
+        FMajor = 1;
+        FMinor = 0;
+        FKeepAlive = FALSE;
+    }
+    else
+    {
+        if (!strcmp(version, "HTTP/1.1"))
         {
-            ptr = (char *)FArgList->FList->FName.GetData();
+            FMajor = 1;
+            FMinor = 1;
+            FKeepAlive = TRUE;
+        }
+        else
+        {
+            if (strncmp(version, "HTTP/", 5))
+                return Reject(400);
+            else
+                return Reject(505);
+        }
+    }
 
-            FMajor = 0;
-            FMinor = 0;
+    while (*p && *p != 0xd && *p != 0xa)
+        p = ParseHeader(p);
 
-            if (!strcmp(ptr, "HTTP/1.0"))
-            {
-                FMajor = 1;
-                FMinor = 0;
-            }
+    if (FContentSize < 0)
+        return Reject(400);
 
-            if (!strcmp(ptr, "HTTP/1.1"))
-            {
-                FMajor = 1;
-                FMinor = 1;
-            }
+    if (FContentSize > HTTP_MAX_CONTENT_SIZE)
+        return Reject(413);
 
-            ptr = (char *)FArgList->FName.GetData();
-            while (*ptr == '/')
-                ptr++;
+    if (FServer->KeepAlive == 0)
+        FKeepAlive = FALSE;
 
-            Execute(ptr);
+    query = strchr(target, '?');
+    if (query)
+    {
+        *query = 0;
+        start = query + 1;
+
+        while (start)
+        {
+            p = AddParam(start);
+            start = strchr(p, '&');
+            if (start)
+                start++;
         }
     }
 
-    delete param;
+    while (*target == '/')
+        target++;
+
+    FMethod = method;
+    FPath = target;
+
+    return TRUE;
 }
 
+/*##########################################################################
+#
+#   Name       : THttpCommand::Run
+#
+#   Purpose....: Run command
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCommand::Run()
+{
+    int size;
+
+    if (FContentSize)
+    {
+        FContentData = new char[FContentSize + 1];
+        size = FServer->Read(FContentData, FContentSize);
+        *(FContentData + FContentSize) = 0;
+
+        if (size != FContentSize)
+            FKeepAlive = FALSE;
+    }
+
+    Execute(FPath);
+}
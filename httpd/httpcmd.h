@@ -63,6 +63,15 @@ public:
     THttpParam *FList;
 };
 
+#define HTTP_MAX_HEADERS        64
+#define HTTP_MAX_CONTENT_SIZE   0x100000
+
+struct THttpHeader
+{
+    const char *Name;
+    const char *Value;
+};
+
 class THttpCommand : public THttpParser
 {
 friend class THttpCustomPage;
@@ -70,15 +79,21 @@ friend class THttpCustomPageFactory;
 friend class THttpCustomDirFactory;
 
 public:
-    THttpCommand(THttpSocketServer *Server, TString Method, TString Param);
+    THttpCommand(THttpSocketServer *Server);
     virtual ~THttpCommand();
 
+    int ParseRequest(char *Data);
     void Run();
+    void Reset();
+
     int IsOpen();
     int IsEmpty();
     int IsMSIE();
+    int IsKeepAlive();
 
+    const char *GetHeader(const char *name);
     THttpOption *FindOption(const char *name);
+    int AcceptEncoding(const char *encoding);
     void WriteError(int ErrorCode);
 
     void WriteStartHeader(int ErrorCode);
@@ -90,6 +105,8 @@ public:
     static int IsOptDelim(char ch);
     static const char *LTrim(const char *str);
     static void RTrim(char *str);
+    static int IsName(const char *Name, const char *Match);
+    static int HasToken(const char *List, const char *Token);
 
     static int ErrorLevel;
 
@@ -100,19 +117,20 @@ protected:
     void Post(const char *Name);
     void Execute(const char *Name);
 
+    int Reject(int ErrorCode);
+    char *ParseHeader(char *p);
+    void CheckHeader(const char *name, char *value);
+    int ParseContentSize(const char *value);
     void CheckAuthorization(const char *param);
-    void AddArg(const char *name);
-    void AddArg(char *sBeg, char **sEnd);
-    void Split(char *s);
-    int Parse(void *arg);
-    int ScanCmdLine(char *line, void *arg);
-
 
-    TDateTime DecodeTime(THttpOption *opt);
+    int DecodeTime(THttpOption *opt, TDateTime &time);
     TDateTime GetModifiedSince();
+    int IsNotModified(const TDateTime &time);
 
     const char *GetErrorText(int ErrorCode);
 
+    int GetEncoding(const char *ContentType);
+
     void WriteFile(TPathName &path, const char *ContentType);
 
     void SendData(const char *Data, const char *ContentType);
@@ -120,30 +138,28 @@ protected:
     void StartPush();
     int PushFile(TPathName &path, const char *ContentType, int ReloadTimeout);
 
-    char *SkipOptDelim(char *p);
-    void AddOpt(char *name, char *param);
     char *AddParam(char *p);
 
     THttpCommand *FList;
     THttpParam *FParamList;
 
-    THttpArg *FArgList;
-    int FArgCount;
+    THttpHeader FHeaderArr[HTTP_MAX_HEADERS];
+    int FHeaderCount;
 
     THttpOption *FOptList;
-    int FOptCount;
 
     int FAuthOk;
+    int FKeepAlive;
 
     int FMajor;
     int FMinor;
 
-    TString FUserAgent;
+    const char *FMethod;
+    const char *FPath;
+    const char *FUserAgent;
     int FContentSize;
     char *FContentData;
 
-    TString FMethod;
-    TString FCmdLine;
     TString FUser;
     THttpSocketServer *FServer;
 };
@@ -0,0 +1,604 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# httpcomp.cpp
+# Http response compression & precompressed file cache
+#
+########################################################################*/
+
+#include <string.h>
+
+#include "httpcomp.h"
+#include "zlib.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : THttpCompressEntry::THttpCompressEntry
+#
+#   Purpose....: Constructor for cache entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCompressEntry::THttpCompressEntry(const char *FileName, TDateTime &Time, int Encoding)
+  : FFileName(FileName),
+    FTime(Time)
+{
+    FEncoding = Encoding;
+    FData = 0;
+    FSize = 0;
+    FRefCount = 0;
+    FCached = FALSE;
+    FList = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressEntry::~THttpCompressEntry
+#
+#   Purpose....: Destructor for cache entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCompressEntry::~THttpCompressEntry()
+{
+    if (FData)
+        delete[] FData;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressEntry::GetData
+#
+#   Purpose....: Get compressed data. Null if the file didn't compress
+#                well enough and should be sent as is.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *THttpCompressEntry::GetData()
+{
+    return FData;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressEntry::GetSize
+#
+#   Purpose....: Get compressed size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int THttpCompressEntry::GetSize()
+{
+    return FSize;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressEntry::GetEncoding
+#
+#   Purpose....: Get content encoding
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int THttpCompressEntry::GetEncoding()
+{
+    return FEncoding;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::THttpCompressor
+#
+#   Purpose....: Constructor for compressor
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCompressor::THttpCompressor()
+  : FSection("Http.Compress")
+{
+    FLevel = Z_DEFAULT_COMPRESSION;
+    FMinSize = HTTP_COMP_MIN_SIZE;
+    FMinRatio = HTTP_COMP_MIN_RATIO;
+    FMaxFileSize = HTTP_COMP_MAX_FILE_SIZE;
+    FCacheSize = HTTP_COMP_CACHE_SIZE;
+    FCacheUsed = 0;
+    FCacheList = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::~THttpCompressor
+#
+#   Purpose....: Destructor for compressor
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCompressor::~THttpCompressor()
+{
+    Flush();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::SetLevel
+#
+#   Purpose....: Set zlib compression level
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::SetLevel(int Level)
+{
+    FLevel = Level;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::SetMinSize
+#
+#   Purpose....: Set smallest payload that is compressed
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::SetMinSize(int Size)
+{
+    FMinSize = Size;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::SetMinRatio
+#
+#   Purpose....: Set required saving in percent
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::SetMinRatio(int Percent)
+{
+    FMinRatio = Percent;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::SetMaxFileSize
+#
+#   Purpose....: Set largest file that is compressed & cached
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::SetMaxFileSize(int Size)
+{
+    FMaxFileSize = Size;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::SetCacheSize
+#
+#   Purpose....: Set memory limit of file cache
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::SetCacheSize(int Size)
+{
+    FSection.Enter();
+
+    FCacheSize = Size;
+
+    while (FCacheList && FCacheUsed > FCacheSize)
+    {
+        THttpCompressEntry *entry = FCacheList;
+
+        while (entry->FList)
+            entry = entry->FList;
+
+        Remove(entry);
+    }
+
+    FSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::IsCompressible
+#
+#   Purpose....: Check if content type is worth compressing
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int THttpCompressor::IsCompressible(const char *ContentType)
+{
+    if (!strncmp(ContentType, "text/", 5))
+        return TRUE;
+
+    if (strstr(ContentType, "javascript"))
+        return TRUE;
+
+    if (strstr(ContentType, "json"))
+        return TRUE;
+
+    if (strstr(ContentType, "xml"))
+        return TRUE;
+
+    return FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::GetEncodingName
+#
+#   Purpose....: Get Content-Encoding value
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *THttpCompressor::GetEncodingName(int Encoding)
+{
+    switch (Encoding)
+    {
+        case HTTP_ENCODING_GZIP:
+            return "gzip";
+
+        case HTTP_ENCODING_DEFLATE:
+            return "deflate";
+
+        default:
+            return "identity";
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::GetMaxOutSize
+#
+#   Purpose....: Get largest acceptable compressed size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int THttpCompressor::GetMaxOutSize(int Size)
+{
+    return Size - (int)((long long)Size * FMinRatio / 100);
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::Compress
+#
+#   Purpose....: Compress payload. The output buffer is limited by the
+#                ratio threshold, so zlib stops as soon as the payload
+#                turns out not to be worth compressing.
+#
+#   In params..: Data, Size     Payload
+#                Encoding       HTTP_ENCODING_GZIP or HTTP_ENCODING_DEFLATE
+#   Out params.: OutSize        Compressed size
+#   Returns....: Compressed data, or 0 if below thresholds
+#
+##########################################################################*/
+char *THttpCompressor::Compress(const char *Data, int Size, int Encoding, int *OutSize)
+{
+    z_stream stream;
+    char *outbuf;
+    int maxout;
+    int wbits;
+    int err;
+
+    *OutSize = 0;
+
+    if (Encoding == HTTP_ENCODING_NONE || Size < FMinSize)
+        return 0;
+
+    maxout = GetMaxOutSize(Size);
+    if (maxout <= 0)
+        return 0;
+
+    if (Encoding == HTTP_ENCODING_GZIP)
+        wbits = MAX_WBITS + 16;
+    else
+        wbits = MAX_WBITS;
+
+    memset(&stream, 0, sizeof(stream));
+
+    if (deflateInit2(&stream, FLevel, Z_DEFLATED, wbits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return 0;
+
+    outbuf = new char[maxout];
+
+    stream.next_in = (Bytef *)Data;
+    stream.avail_in = Size;
+    stream.next_out = (Bytef *)outbuf;
+    stream.avail_out = maxout;
+
+    err = deflate(&stream, Z_FINISH);
+
+    if (err == Z_STREAM_END)
+        *OutSize = (int)stream.total_out;
+    else
+    {
+        delete[] outbuf;
+        outbuf = 0;
+    }
+
+    deflateEnd(&stream);
+
+    return outbuf;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::Insert
+#
+#   Purpose....: Insert entry first in cache, evict least recently used
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::Insert(THttpCompressEntry *entry)
+{
+    THttpCompressEntry *curr;
+    int cost = entry->FSize + entry->FFileName.GetSize() + sizeof(THttpCompressEntry);
+
+    if (cost > FCacheSize)
+        return;
+
+    curr = FCacheList;
+    while (curr)
+    {
+        if (curr->FEncoding == entry->FEncoding && curr->FFileName == entry->FFileName)
+        {
+            Remove(curr);
+            break;
+        }
+        curr = curr->FList;
+    }
+
+    while (FCacheList && FCacheUsed + cost > FCacheSize)
+    {
+        curr = FCacheList;
+        while (curr->FList)
+            curr = curr->FList;
+
+        Remove(curr);
+    }
+
+    entry->FList = FCacheList;
+    FCacheList = entry;
+    entry->FCached = TRUE;
+    FCacheUsed += cost;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::Remove
+#
+#   Purpose....: Remove entry from cache. Entries still being sent are
+#                deleted on last Release.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::Remove(THttpCompressEntry *entry)
+{
+    THttpCompressEntry *prev;
+
+    if (FCacheList == entry)
+        FCacheList = entry->FList;
+    else
+    {
+        prev = FCacheList;
+        while (prev && prev->FList != entry)
+            prev = prev->FList;
+
+        if (prev)
+            prev->FList = entry->FList;
+    }
+
+    entry->FList = 0;
+    entry->FCached = FALSE;
+    FCacheUsed -= entry->FSize + entry->FFileName.GetSize() + sizeof(THttpCompressEntry);
+
+    if (entry->FRefCount == 0)
+        delete entry;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::GetFile
+#
+#   Purpose....: Get precompressed variant of file. The cache is keyed by
+#                name, encoding and modify time, and also remembers files
+#                that don't compress well so they are not retried.
+#
+#   In params..: file           Opened file, position is restored to start
+#                FileName       Cache key
+#                Time           Modify time of file
+#                Encoding       Content encoding
+#   Out params.: *
+#   Returns....: Entry that must be released, or 0 if not applicable
+#
+##########################################################################*/
+THttpCompressEntry *THttpCompressor::GetFile(TFile &file, const char *FileName, TDateTime &Time, int Encoding)
+{
+    THttpCompressEntry *entry;
+    THttpCompressEntry *prev;
+    TString Name(FileName);
+    char *buf;
+    int size;
+
+    if (Encoding == HTTP_ENCODING_NONE)
+        return 0;
+
+    size = (int)file.GetSize();
+    if (size < FMinSize || size > FMaxFileSize)
+        return 0;
+
+    FSection.Enter();
+
+    prev = 0;
+    entry = FCacheList;
+    while (entry)
+    {
+        if (entry->FEncoding == Encoding && entry->FFileName == Name)
+            break;
+
+        prev = entry;
+        entry = entry->FList;
+    }
+
+    if (entry)
+    {
+        if (entry->FTime == Time)
+        {
+            if (prev)
+            {
+                prev->FList = entry->FList;
+                entry->FList = FCacheList;
+                FCacheList = entry;
+            }
+            entry->FRefCount++;
+            FSection.Leave();
+            return entry;
+        }
+        else
+            Remove(entry);
+    }
+
+    FSection.Leave();
+
+    buf = new char[size];
+    if (file.Read(buf, size) != size)
+    {
+        delete[] buf;
+        file.SetPos(0);
+        return 0;
+    }
+
+    entry = new THttpCompressEntry(FileName, Time, Encoding);
+    entry->FData = Compress(buf, size, Encoding, &entry->FSize);
+    entry->FRefCount = 1;
+
+    delete[] buf;
+    file.SetPos(0);
+
+    FSection.Enter();
+    Insert(entry);
+    FSection.Leave();
+
+    return entry;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::Release
+#
+#   Purpose....: Release entry returned by GetFile
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::Release(THttpCompressEntry *entry)
+{
+    FSection.Enter();
+
+    entry->FRefCount--;
+
+    if (entry->FRefCount == 0 && !entry->FCached)
+        delete entry;
+
+    FSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCompressor::Flush
+#
+#   Purpose....: Remove all cached files
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCompressor::Flush()
+{
+    FSection.Enter();
+
+    while (FCacheList)
+        Remove(FCacheList);
+
+    FSection.Leave();
+}
@@ -0,0 +1,113 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# httpcomp.h
+# Http response compression & precompressed file cache
+#
+########################################################################*/
+
+#ifndef _HTTPCOMP_H
+#define _HTTPCOMP_H
+
+#include "str.h"
+#include "file.h"
+#include "datetime.h"
+#include "section.h"
+
+#define HTTP_ENCODING_NONE          0
+#define HTTP_ENCODING_GZIP          1
+#define HTTP_ENCODING_DEFLATE       2
+
+#define HTTP_COMP_MIN_SIZE          512
+#define HTTP_COMP_MIN_RATIO         10
+#define HTTP_COMP_MAX_FILE_SIZE     0x100000
+#define HTTP_COMP_CACHE_SIZE        0x400000
+
+class THttpCompressor;
+
+class THttpCompressEntry
+{
+friend class THttpCompressor;
+public:
+    THttpCompressEntry(const char *FileName, TDateTime &Time, int Encoding);
+    ~THttpCompressEntry();
+
+    const char *GetData();
+    int GetSize();
+    int GetEncoding();
+
+protected:
+    TString FFileName;
+    TDateTime FTime;
+    int FEncoding;
+
+    char *FData;
+    int FSize;
+
+    int FRefCount;
+    int FCached;
+
+    THttpCompressEntry *FList;
+};
+
+class THttpCompressor
+{
+public:
+    THttpCompressor();
+    ~THttpCompressor();
+
+    void SetLevel(int Level);
+    void SetMinSize(int Size);
+    void SetMinRatio(int Percent);
+    void SetMaxFileSize(int Size);
+    void SetCacheSize(int Size);
+
+    static int IsCompressible(const char *ContentType);
+    static const char *GetEncodingName(int Encoding);
+
+    char *Compress(const char *Data, int Size, int Encoding, int *OutSize);
+
+    THttpCompressEntry *GetFile(TFile &file, const char *FileName, TDateTime &Time, int Encoding);
+    void Release(THttpCompressEntry *entry);
+    void Flush();
+
+protected:
+    int GetMaxOutSize(int Size);
+    void Insert(THttpCompressEntry *entry);
+    void Remove(THttpCompressEntry *entry);
+
+    int FLevel;
+    int FMinSize;
+    int FMinRatio;
+    int FMaxFileSize;
+    int FCacheSize;
+    int FCacheUsed;
+
+    TSection FSection;
+    THttpCompressEntry *FCacheList;
+};
+
+#endif
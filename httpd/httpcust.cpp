@@ -36,6 +36,7 @@
 #include "rdos.h"
 #include "httpcust.h"
 #include "httpcmd.h"
+#include "httproute.h"
 
 #define FALSE 0
 #define TRUE !FALSE
@@ -187,6 +188,71 @@ void THttpCustomPage::SendData(const char *ContentType)
     FData = "";
 }
 
+/*##########################################################################
+#
+#   Name       : THttpCustomPage::IsNotModified
+#
+#   Purpose....: Check If-Modified-Since of request
+#
+#   In params..: time           last modification time of page
+#   Out params.: *
+#   Returns....: TRUE if 304 can be sent
+#
+##########################################################################*/
+int THttpCustomPage::IsNotModified(const TDateTime &time)
+{
+    return FCmd->IsNotModified(time);
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCustomPage::WriteData
+#
+#   Purpose....: Write raw body data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCustomPage::WriteData(const char *Buf, int Size)
+{
+    FCmd->FServer->Write(Buf, Size);
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCustomPage::Push
+#
+#   Purpose....: Push written data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCustomPage::Push()
+{
+    FCmd->FServer->Push();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpCustomPage::CloseConnection
+#
+#   Purpose....: Close connection after this reply. Used when the body
+#                cannot match the declared Content-Length
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpCustomPage::CloseConnection()
+{
+    FCmd->FKeepAlive = FALSE;
+}
+
 /*##########################################################################
 #
 #   Name       : THttpCustomPage::Get
@@ -247,6 +313,7 @@ void THttpCustomPage::Post(const char *Var, const char *Val)
 ##########################################################################*/
 THttpCustomPageFactory::THttpCustomPageFactory(const char *ReqName)
 {
+    FRoutes = 0;
     FReqNameList.AddLast(TString(ReqName));
 }
 
@@ -295,6 +362,9 @@ THttpCustomPage *THttpCustomPageFactory::Create(THttpCommand *Cmd)
 void THttpCustomPageFactory::AddName(const char *ReqName)
 {
     FReqNameList.AddLast(TString(ReqName));
+
+    if (FRoutes)
+        FRoutes->AddPage(ReqName, this);
 }
 
 /*##########################################################################
@@ -310,6 +380,7 @@ void THttpCustomPageFactory::AddName(const char *ReqName)
 ##########################################################################*/
 THttpCustomDirFactory::THttpCustomDirFactory(const char *ReqName)
 {
+    FRoutes = 0;
     FReqNameList.AddLast(TString(ReqName));
 }
 
@@ -358,4 +429,7 @@ THttpCustomPage *THttpCustomDirFactory::Create(THttpCommand *Cmd)
 void THttpCustomDirFactory::AddName(const char *ReqName)
 {
     FReqNameList.AddLast(TString(ReqName));
+
+    if (FRoutes)
+        FRoutes->AddDir(ReqName, this);
 }
@@ -40,6 +40,7 @@ class THttpParam;
 class THttpCommand;
 class THttpSocketServer;
 class THttpSocketServerFactory;
+class THttpRouteTable;
 
 class THttpCustomPage
 {
@@ -66,6 +67,11 @@ protected:
     void Write(const char *str);
     void SendData(const char *ContentType);
 
+    int IsNotModified(const TDateTime &time);
+    void WriteData(const char *Buf, int Size);
+    void Push();
+    void CloseConnection();
+
 	THttpCommand *FCmd;
 
 	TString FData;
@@ -89,6 +95,7 @@ public:
 protected:
 	THttpCustomPageFactory *FList;
 	THttpCommand *FCmd;
+	THttpRouteTable *FRoutes;
 };
 
 class THttpCustomDirFactory
@@ -109,6 +116,7 @@ public:
 protected:
 	THttpCustomDirFactory *FList;
 	THttpCommand *FCmd;
+	THttpRouteTable *FRoutes;
 };
 
 #endif
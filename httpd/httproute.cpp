@@ -0,0 +1,491 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# httproute.cpp
+# Http route table for custom pages & dirs
+#
+########################################################################*/
+
+#include <string.h>
+#include "httproute.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+/*##########################################################################
+#
+#   Name       : THttpRouteNode::THttpRouteNode
+#
+#   Purpose....: Constructor for route node
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpRouteNode::THttpRouteNode(char ch)
+{
+    FChar = ch;
+    FChild = 0;
+    FNext = 0;
+    FWild = 0;
+    FPage = 0;
+    FDir = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteNode::~THttpRouteNode
+#
+#   Purpose....: Destructor for route node
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpRouteNode::~THttpRouteNode()
+{
+    THttpRouteNode *node;
+
+    while (FChild)
+    {
+        node = FChild->FNext;
+        delete FChild;
+        FChild = node;
+    }
+
+    if (FWild)
+        delete FWild;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteStack::THttpRouteStack
+#
+#   Purpose....: Constructor for wildcard backtrack stack. Starts out in
+#                a fixed buffer and moves to the heap if it grows
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpRouteStack::THttpRouteStack()
+{
+    FNodeArr = FNodeBuf;
+    FPosArr = FPosBuf;
+    FSize = HTTP_ROUTE_MAX_WILD;
+    FCount = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteStack::~THttpRouteStack
+#
+#   Purpose....: Destructor for wildcard backtrack stack
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpRouteStack::~THttpRouteStack()
+{
+    if (FNodeArr != FNodeBuf)
+    {
+        delete [] FNodeArr;
+        delete [] FPosArr;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteStack::Push
+#
+#   Purpose....: Push a wildcard alternative
+#
+#   In params..: node           wildcard node
+#                pos            path position after wildcard segment
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpRouteStack::Push(THttpRouteNode *node, const char *pos)
+{
+    THttpRouteNode **NodeArr;
+    const char **PosArr;
+
+    if (FCount == FSize)
+    {
+        NodeArr = new THttpRouteNode *[2 * FSize];
+        PosArr = new const char *[2 * FSize];
+
+        memcpy(NodeArr, FNodeArr, FCount * sizeof(THttpRouteNode *));
+        memcpy(PosArr, FPosArr, FCount * sizeof(const char *));
+
+        if (FNodeArr != FNodeBuf)
+        {
+            delete [] FNodeArr;
+            delete [] FPosArr;
+        }
+
+        FNodeArr = NodeArr;
+        FPosArr = PosArr;
+        FSize = 2 * FSize;
+    }
+
+    FNodeArr[FCount] = node;
+    FPosArr[FCount] = pos;
+    FCount++;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteStack::Pop
+#
+#   Purpose....: Pop latest wildcard alternative
+#
+#   In params..: *
+#   Out params.: node           wildcard node
+#                pos            path position after wildcard segment
+#   Returns....: TRUE if stack was not empty
+#
+##########################################################################*/
+int THttpRouteStack::Pop(THttpRouteNode **node, const char **pos)
+{
+    if (FCount == 0)
+        return FALSE;
+
+    FCount--;
+    *node = FNodeArr[FCount];
+    *pos = FPosArr[FCount];
+    return TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::THttpRouteTable
+#
+#   Purpose....: Constructor for route table
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpRouteTable::THttpRouteTable()
+  : FRoot(0),
+    FSection("Http.Route")
+{
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::~THttpRouteTable
+#
+#   Purpose....: Destructor for route table
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpRouteTable::~THttpRouteTable()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::GetChild
+#
+#   Purpose....: Get child node for character
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpRouteNode *THttpRouteTable::GetChild(THttpRouteNode *node, char ch)
+{
+    THttpRouteNode *child = node->FChild;
+
+    while (child && child->FChar != ch)
+        child = child->FNext;
+
+    return child;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::SkipSegment
+#
+#   Purpose....: Skip to end of path segment
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *THttpRouteTable::SkipSegment(const char *p)
+{
+    while (*p && *p != '/')
+        p++;
+
+    return p;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::Insert
+#
+#   Purpose....: Insert route. A "*" that makes up a whole path segment
+#                matches any single segment.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Node for end of route
+#
+##########################################################################*/
+THttpRouteNode *THttpRouteTable::Insert(const char *Name)
+{
+    THttpRouteNode *node = &FRoot;
+    THttpRouteNode *child;
+    const char *p = Name;
+
+    while (*p)
+    {
+        if (*p == '*' && (p == Name || p[-1] == '/') && (p[1] == 0 || p[1] == '/'))
+        {
+            if (!node->FWild)
+                node->FWild = new THttpRouteNode('*');
+
+            node = node->FWild;
+        }
+        else
+        {
+            child = GetChild(node, *p);
+            if (!child)
+            {
+                child = new THttpRouteNode(*p);
+                child->FNext = node->FChild;
+                node->FChild = child;
+            }
+            node = child;
+        }
+        p++;
+    }
+
+    return node;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::AddPage
+#
+#   Purpose....: Add page route. The first page registered for a name is
+#                used, like the old list search. Routes may be added
+#                while the server runs.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpRouteTable::AddPage(const char *Name, THttpCustomPageFactory *Page)
+{
+    THttpRouteNode *node;
+
+    FSection.Enter();
+
+    node = Insert(Name);
+    if (!node->FPage)
+        node->FPage = Page;
+
+    FSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::AddDir
+#
+#   Purpose....: Add dir route
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpRouteTable::AddDir(const char *Name, THttpCustomDirFactory *Dir)
+{
+    THttpRouteNode *node;
+
+    FSection.Enter();
+
+    node = Insert(Name);
+    if (!node->FDir)
+        node->FDir = Dir;
+
+    FSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::FindPage
+#
+#   Purpose....: Find page with exact route
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCustomPageFactory *THttpRouteTable::FindPage(const char *Name)
+{
+    THttpCustomPageFactory *page;
+
+    FSection.Enter();
+    page = LookupPage(Name);
+    FSection.Leave();
+
+    return page;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::FindDir
+#
+#   Purpose....: Find dir that is the longest prefix of path
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCustomDirFactory *THttpRouteTable::FindDir(const char *Name)
+{
+    THttpCustomDirFactory *dir;
+
+    FSection.Enter();
+    dir = LookupDir(Name);
+    FSection.Leave();
+
+    return dir;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::LookupPage
+#
+#   Purpose....: Find page with exact route. Literal characters are tried
+#                before wildcard segments, and the wildcard alternatives
+#                are kept on a stack instead of recursing.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCustomPageFactory *THttpRouteTable::LookupPage(const char *Name)
+{
+    THttpRouteStack stack;
+    THttpRouteNode *node = &FRoot;
+    const char *p = Name;
+
+    for (;;)
+    {
+        if (node)
+        {
+            if (node->FWild && (p == Name || p[-1] == '/'))
+                stack.Push(node->FWild, SkipSegment(p));
+
+            if (*p)
+            {
+                node = GetChild(node, *p);
+                p++;
+            }
+            else
+            {
+                if (node->FPage)
+                    return node->FPage;
+
+                node = 0;
+            }
+        }
+
+        if (!node)
+            if (!stack.Pop(&node, &p))
+                return 0;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : THttpRouteTable::LookupDir
+#
+#   Purpose....: Find dir that is the longest prefix of path
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCustomDirFactory *THttpRouteTable::LookupDir(const char *Name)
+{
+    THttpRouteStack stack;
+    THttpRouteNode *node = &FRoot;
+    THttpCustomDirFactory *best = 0;
+    const char *p = Name;
+
+    for (;;)
+    {
+        if (node)
+        {
+            if (node->FDir)
+                best = node->FDir;
+
+            if (node->FWild && (p == Name || p[-1] == '/'))
+                stack.Push(node->FWild, SkipSegment(p));
+
+            if (*p)
+            {
+                node = GetChild(node, *p);
+                p++;
+            }
+            else
+                node = 0;
+        }
+
+        if (!node)
+        {
+            if (best)
+                return best;
+
+            if (!stack.Pop(&node, &p))
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# httproute.h
+# Http route table for custom pages & dirs
+#
+########################################################################*/
+
+#ifndef _HTTPROUTE_H
+#define _HTTPROUTE_H
+
+#include "section.h"
+
+#define HTTP_ROUTE_MAX_WILD     16
+
+class THttpCustomPageFactory;
+class THttpCustomDirFactory;
+
+class THttpRouteNode
+{
+friend class THttpRouteTable;
+public:
+    THttpRouteNode(char ch);
+    ~THttpRouteNode();
+
+protected:
+    char FChar;
+    THttpRouteNode *FChild;
+    THttpRouteNode *FNext;
+    THttpRouteNode *FWild;
+
+    THttpCustomPageFactory *FPage;
+    THttpCustomDirFactory *FDir;
+};
+
+class THttpRouteStack
+{
+public:
+    THttpRouteStack();
+    ~THttpRouteStack();
+
+    void Push(THttpRouteNode *node, const char *pos);
+    int Pop(THttpRouteNode **node, const char **pos);
+
+protected:
+    THttpRouteNode *FNodeBuf[HTTP_ROUTE_MAX_WILD];
+    const char *FPosBuf[HTTP_ROUTE_MAX_WILD];
+
+    THttpRouteNode **FNodeArr;
+    const char **FPosArr;
+    int FSize;
+    int FCount;
+};
+
+class THttpRouteTable
+{
+public:
+    THttpRouteTable();
+    ~THttpRouteTable();
+
+    void AddPage(const char *Name, THttpCustomPageFactory *Page);
+    void AddDir(const char *Name, THttpCustomDirFactory *Dir);
+
+    THttpCustomPageFactory *FindPage(const char *Name);
+    THttpCustomDirFactory *FindDir(const char *Name);
+
+protected:
+    THttpRouteNode *Insert(const char *Name);
+    THttpCustomPageFactory *LookupPage(const char *Name);
+    THttpCustomDirFactory *LookupDir(const char *Name);
+    static THttpRouteNode *GetChild(THttpRouteNode *node, char ch);
+    static const char *SkipSegment(const char *p);
+
+    THttpRouteNode FRoot;
+    TSection FSection;
+};
+
+#endif
@@ -257,9 +257,16 @@ THttpSocketServer::THttpSocketServer(const char *Name, int StackSize, TTcpSocket
 {
     OnCommand = 0;
     OnAuthorize = 0;
+    FCmd = 0;
     FSocketBuf = 0;
+    FBufSize = 0;
+    FBufCount = 0;
+    FBufPos = 0;
+    FScanPos = 0;
     FPageList = 0;
     FDirList = 0;
+    FCompressor = 0;
+    FRoutes = 0;
     KeepAlive = 15;
 }
 
@@ -276,6 +283,9 @@ THttpSocketServer::THttpSocketServer(const char *Name, int StackSize, TTcpSocket
 ##########################################################################*/
 THttpSocketServer::~THttpSocketServer()
 {
+    if (FCmd)
+        delete FCmd;
+
     if (FSocketBuf)
         delete FSocketBuf;
 }
@@ -405,6 +415,9 @@ int THttpSocketServer::IsMatch(const char *Search, const char *FileName)
 ##########################################################################*/
 THttpCustomPageFactory *THttpSocketServer::FindPage(const char *FileName)
 {
+    if (FRoutes)
+        return FRoutes->FindPage(FileName);
+
     TString Name(FileName);
     THttpCustomPageFactory *page = FPageList;
        
@@ -438,6 +451,9 @@ THttpCustomDirFactory *THttpSocketServer::FindDir(const char *FileName)
     const char *ptr;
     THttpCustomDirFactory *dir = FDirList;
 
+    if (FRoutes)
+        return FRoutes->FindDir(FileName);
+
     while (dir)
     {
         count = dir->FReqNameList.GetSize();
@@ -591,222 +607,238 @@ int THttpSocketServer::IsEmpty()
 
 /*##########################################################################
 #
-#   Name       : THttpSocketServer::Read
+#   Name       : THttpSocketServer::Fill
 #
-#   Purpose....: Read a number of data-bytes
+#   Purpose....: Read more data into receive buffer. Consumed data is
+#                discarded and the buffer grows up to max header size,
+#                so a request header always is contiguous
 #
-#   In params..: *
+#   In params..: Timeout in ms
 #   Out params.: *
-#   Returns....: *
+#   Returns....: Number of bytes read, 0 on timeout or full buffer
 #
 ##########################################################################*/
-int THttpSocketServer::Read(char *buf, int size)
+int THttpSocketServer::Fill(int Timeout)
 {
-    int pos;
     int count;
+    int size;
+    char *buf;
 
     if (FSocketBuf == 0)
     {
-        FSocketBuf = new char[BUF_SIZE + 1];
+        FBufSize = HTTP_RECV_SIZE;
+        FSocketBuf = new char[FBufSize + 1];
         FBufCount = 0;
         FBufPos = 0;
+        FScanPos = 0;
     }
 
-    if (FBufCount <= FBufPos)
+    if (FBufPos)
     {
-        FBufPos -= FBufCount;
+        FBufCount -= FBufPos;
+        FScanPos -= FBufPos;
+        if (FScanPos < 0)
+            FScanPos = 0;
 
-        if (FSocket->WaitForData(5000))
-        {
-            FBufCount = FSocket->Read(FSocketBuf, BUF_SIZE);
-            FSocketBuf[FBufCount] = 0;
+        if (FBufCount)
+            memmove(FSocketBuf, &FSocketBuf[FBufPos], FBufCount);
 
-            if (OnCommand)
-                (*OnCommand)(this, FSocketBuf);
-        }
-        else
-            return 0;
+        FBufPos = 0;
     }
 
-    while (FBufCount - FBufPos < size)
+    if (FBufCount == FBufSize)
     {
-        if (FBufPos == 0)
-        {
-            FBufCount = 0;
+        if (FBufSize >= HTTP_MAX_HEADER_SIZE)
             return 0;
-        }
 
-        if (!FSocket->WaitForData(5000))
-        {
-            count = FBufCount - FBufPos;
-            memcpy(buf, &FSocketBuf[FBufPos], count);
-            FBufPos = 0;
-            FBufCount = 0;
-            return count;
-        }
+        size = 2 * FBufSize;
+        buf = new char[size + 1];
+        memcpy(buf, FSocketBuf, FBufCount);
+        delete FSocketBuf;
+        FSocketBuf = buf;
+        FBufSize = size;
+    }
 
-        memcpy(FSocketBuf, &FSocketBuf[FBufPos], FBufCount - FBufPos);
-        FBufCount -= FBufPos;
-        FBufPos = 0;
-        pos = FBufCount;
-        FBufCount += FSocket->Read(&FSocketBuf[pos], BUF_SIZE - FBufCount);
-        FSocketBuf[FBufCount] = 0;
+    if (!FSocket->WaitForData(Timeout))
+        return 0;
 
-        if (OnCommand)
-            (*OnCommand)(this, &FSocketBuf[pos]);
-    }
+    count = FSocket->Read(&FSocketBuf[FBufCount], FBufSize - FBufCount);
+    if (count <= 0)
+        return 0;
+
+    FSocketBuf[FBufCount + count] = 0;
+
+    if (OnCommand)
+        (*OnCommand)(this, &FSocketBuf[FBufCount]);
 
-    memcpy(buf, &FSocketBuf[FBufPos], size);
-    FBufPos += size;
-    return size;
+    FBufCount += count;
+    return count;
 }
 
 /*##########################################################################
 #
-#   Name       : THttpSocketServer::ReadLine
+#   Name       : THttpSocketServer::Read
 #
-#   Purpose....: Read a single line from socket
+#   Purpose....: Read a number of data-bytes. Buffered data is used first,
+#                the rest is read directly from the socket so the current
+#                request header is left in place
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-char *THttpSocketServer::ReadLine()
+int THttpSocketServer::Read(char *buf, int size)
 {
-#define BUF_SIZE        513
-    char *ptr;
-    char *result;
-    int pos;
+    int count;
+    int done;
 
-    if (FSocketBuf == 0)
+    count = FBufCount - FBufPos;
+    if (count > size)
+        count = size;
+
+    if (count > 0)
     {
-        FSocketBuf = new char[BUF_SIZE + 1];
-        FBufCount = 0;
-        FBufPos = 0;
+        memcpy(buf, &FSocketBuf[FBufPos], count);
+        FBufPos += count;
     }
+    else
+        count = 0;
+
+    done = count;
 
-    if (FBufCount <= FBufPos)
+    while (done < size)
     {
-        FBufPos -= FBufCount;
+        if (!FSocket->WaitForData(5000))
+            break;
 
-        if (FSocket->WaitForData(5000))
-        {
-            FBufCount = FSocket->Read(FSocketBuf, BUF_SIZE);
-            FSocketBuf[FBufCount] = 0;
+        count = FSocket->Read(buf + done, size - done);
+        if (count <= 0)
+            break;
 
-            if (OnCommand)
-                (*OnCommand)(this, FSocketBuf);
-        }
-        else
-            return 0;
+        done += count;
     }
 
-    ptr = strchr(&FSocketBuf[FBufPos], 0xd);
+    return done;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpSocketServer::ReadLine
+#
+#   Purpose....: Read a single line from socket
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+char *THttpSocketServer::ReadLine()
+{
+    char *ptr;
+    char *result;
 
-    while (!ptr)
+    for (;;)
     {
-        if (FBufPos == 0)
+        if (FSocketBuf && FBufPos < FBufCount)
         {
-            FBufCount = 0;
-            return 0;
+            FSocketBuf[FBufCount] = 0;
+            ptr = strchr(&FSocketBuf[FBufPos], 0xd);
+            if (ptr)
+                break;
         }
 
-        if (!FSocket->WaitForData(5000))
+        if (!Fill(5000))
         {
-            result = &FSocketBuf[FBufPos];
-            FBufPos = 0;
-            FBufCount = 0;
-            return result;
+            if (FSocketBuf && FBufPos < FBufCount)
+            {
+                result = &FSocketBuf[FBufPos];
+                FBufPos = FBufCount;
+                return result;
+            }
+            return 0;
         }
-
-        memcpy(FSocketBuf, &FSocketBuf[FBufPos], FBufCount - FBufPos);
-        FBufCount -= FBufPos;
-        FBufPos = 0;
-        pos = FBufCount;
-        FBufCount += FSocket->Read(&FSocketBuf[pos], BUF_SIZE - FBufCount);
-        FSocketBuf[FBufCount] = 0;
-
-        if (OnCommand)
-            (*OnCommand)(this, &FSocketBuf[pos]);
-
-        ptr = strchr(&FSocketBuf[pos], 0xd);
     }
 
     *ptr = 0;
     result = &FSocketBuf[FBufPos];
-    FBufPos = ptr - FSocketBuf + 2;
+    FBufPos = ptr - FSocketBuf + 1;
+
+    if (FBufPos < FBufCount && FSocketBuf[FBufPos] == 0xa)
+        FBufPos++;
 
     return result;
 }
 
-/*##################  THttpSocketServer::Parse  ##########################
-*   Purpose....: Parse a command line and return a command class                #
-*   In params..: *                                                          #
-*   Out params.: *                                                          #
-*   Returns....: *                                                          #
-*   Created....: 96-09-02 le                                                #
-*##########################################################################*/
-THttpCommand *THttpSocketServer::Parse(const char *line)
+/*##########################################################################
+#
+#   Name       : THttpSocketServer::ReadRequest
+#
+#   Purpose....: Get next complete request header from receive buffer.
+#                Pipelined requests already received are returned without
+#                waiting for the socket. The header stays valid until the
+#                next call.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Header block, or 0 if none received
+#
+##########################################################################*/
+char *THttpSocketServer::ReadRequest()
 {
-    const char *rest;
-    int size;
-    int i;
-    char *com;
     char *ptr;
-    int done;
-    TString Line;
-    TString Method;
-
-    Line = TString(LTrim(line));
-
-    rest = Line.GetData();
-
-    Method = TString("");
+    char *end;
+    char *next;
+    char *result;
 
-    if (*rest)
+    for (;;)
     {
-        size = 0;
-        while (*rest && IsFileNameChar(*rest) && !strchr("\"", *rest))
+        if (FSocketBuf)
         {
-            size++;
-            rest++;
-        }
+            while (FBufPos < FBufCount && (FSocketBuf[FBufPos] == 0xd || FSocketBuf[FBufPos] == 0xa))
+                FBufPos++;
 
-        if (*rest && strchr("\"", *rest))
-            size = 0;
+            if (FScanPos < FBufPos)
+                FScanPos = FBufPos;
 
-        if (size)
-        {
-            com = new char[size + 1];
+            end = &FSocketBuf[FBufCount];
+            next = 0;
 
-            rest = Line.GetData();
-            ptr = com;
+            for (ptr = &FSocketBuf[FScanPos]; ptr < end; ptr++)
+            {
+                if (*ptr == 0xa)
+                {
+                    if (ptr + 1 < end && ptr[1] == 0xa)
+                    {
+                        next = ptr + 2;
+                        break;
+                    }
+
+                    if (ptr + 2 < end && ptr[1] == 0xd && ptr[2] == 0xa)
+                    {
+                        next = ptr + 3;
+                        break;
+                    }
+                }
+            }
 
-            for (i = 0; i < size; i++)
+            if (next)
             {
-                *ptr = toupper(*rest);
-                ptr++;
-                rest++;
+                ptr[1] = 0;
+                result = &FSocketBuf[FBufPos];
+                FBufPos = next - FSocketBuf;
+                FScanPos = FBufPos;
+                return result;
             }
-            *ptr = 0;
 
-            Method = TString(com);
-            delete com;
+            FScanPos = FBufCount - 2;
+            if (FScanPos < FBufPos)
+                FScanPos = FBufPos;
         }
-    }
 
-    if (Method.GetSize())
-    {
-        done = *rest == 0 || *rest == '/' || *rest == '.' || *rest == ':';
-        if (!done)
-            if (IsArgDelim(*rest))
-                rest = LTrim(rest);
-
-        return new THttpCommand(this, Method, TString(rest));
+        if (!Fill(5000))
+            return 0;
     }
-    else
-        return 0;
 }
 
 /*##########################################################################
@@ -822,23 +854,35 @@ THttpCommand *THttpSocketServer::Parse(const char *line)
 ##########################################################################*/
 void THttpSocketServer::HandleSocket()
 {
-    THttpCommand *cmd;
     char *ptr;
+    int keep;
+
+    if (!FCmd)
+        FCmd = new THttpCommand(this);
 
     while (FSocket->IsOpen() || !IsEmpty())
     {
-        ptr = ReadLine();
+        ptr = ReadRequest();
         if (ptr)
         {
-            cmd = Parse(ptr);
-            if (cmd)
+            if (FCmd->ParseRequest(ptr))
             {
-                cmd->Run();
-                delete cmd;
+                FCmd->Run();
+                keep = FCmd->IsKeepAlive();
             }
+            else
+                keep = FALSE;
+
+            FCmd->Reset();
+
+            if (!keep)
+                break;
         }
         else
         {
+            if (FBufPos < FBufCount)
+                break;
+
             if (KeepAlive == 0 || !FSocket->WaitForData(KeepAlive * 1000))
                 break;
         }
@@ -35,6 +35,13 @@
 #include "str.h"
 #include "sockobj.h"
 #include "httpcust.h"
+#include "httpcomp.h"
+#include "httproute.h"
+
+#define HTTP_RECV_SIZE          0x1000
+#define HTTP_MAX_HEADER_SIZE    0x4000
+
+class THttpCommand;
 
 enum InternalErrorCodes
 {
@@ -73,6 +80,7 @@ public:
         
     int Read(char *buf, int size);
     char *ReadLine();
+    char *ReadRequest();
 
     THttpCustomPageFactory *FindPage(const char *FileName);
     THttpCustomDirFactory *FindDir(const char *FileName);
@@ -96,16 +104,20 @@ public:
     int KeepAlive;
     THttpCustomPageFactory *FPageList;
     THttpCustomDirFactory *FDirList;
+    THttpCompressor *FCompressor;
+    THttpRouteTable *FRoutes;
 
 protected:
     int IsMatch(const char *Search, const char *FileName);
-    THttpCommand *Parse(const char *line);
+    int Fill(int Timeout);
 
-    TString FMethod;
+    THttpCommand *FCmd;
     char *FSocketBuf;
+    int FBufSize;
     int FBufCount;
     int FBufPos;
-    
+    int FScanPos;
+
 };
 
 #endif
@@ -0,0 +1,670 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# httpzip.cpp
+# Http custom dir serving files from a zip archive
+#
+########################################################################*/
+
+#include <ctype.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "rdos.h"
+#include "httpzip.h"
+#include "httpcmd.h"
+#include "zipextr.h"
+#include "zlib.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+#ifdef __GNUC__
+#define QSORTAPI
+#else
+#define QSORTAPI __cdecl
+#endif
+
+struct THttpZipContentType
+{
+    const char *Ext;
+    const char *ContentType;
+};
+
+static THttpZipContentType ContentTypeTab[] =
+{
+    {"htm", "text/html"},
+    {"html", "text/html"},
+    {"css", "text/css"},
+    {"js", "application/javascript"},
+    {"json", "application/json"},
+    {"xml", "text/xml"},
+    {"txt", "text/plain"},
+    {"png", "image/png"},
+    {"gif", "image/gif"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"ico", "image/x-icon"},
+    {"svg", "image/svg+xml"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {0, 0}
+};
+
+/*##########################################################################
+#
+#   Name       : CompareName
+#
+#   Purpose....: Compare entry names, case-insensitive, '\' equals '/'
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static int CompareName(const char *n1, const char *n2)
+{
+    int c1, c2;
+
+    for (;;)
+    {
+        c1 = toupper(*n1);
+        c2 = toupper(*n2);
+
+        if (c1 == '\\')
+            c1 = '/';
+
+        if (c2 == '\\')
+            c2 = '/';
+
+        if (c1 != c2)
+            return c1 - c2;
+
+        if (c1 == 0)
+            return 0;
+
+        n1++;
+        n2++;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : IndexCompare
+#
+#   Purpose....: Compare function for qsort
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+static int QSORTAPI IndexCompare(const void *e1, const void *e2)
+{
+    TUnzipFile *f1 = *(TUnzipFile **)e1;
+    TUnzipFile *f2 = *(TUnzipFile **)e2;
+
+    return CompareName(f1->GetFileName(), f2->GetFileName());
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipPage::THttpZipPage
+#
+#   Purpose....: Constructor for THttpZipPage
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpZipPage::THttpZipPage(THttpCommand *Cmd, THttpZipDirFactory *Factory)
+  : THttpCustomPage(Cmd)
+{
+    FFactory = Factory;
+    FBuf = new char[HTTP_ZIP_BUF_SIZE];
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipPage::~THttpZipPage
+#
+#   Purpose....: Destructor for THttpZipPage
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpZipPage::~THttpZipPage()
+{
+    delete FBuf;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipPage::Get
+#
+#   Purpose....: Get page from archive
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpZipPage::Get(const char *MatchName, const char *UrlName, THttpParam *Param)
+{
+    TUnzipFile *entry = FFactory->Find(UrlName);
+
+    if (entry)
+        WriteEntry(entry);
+    else
+        WriteError(404);
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipPage::WriteEntry
+#
+#   Purpose....: Write header & archive entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpZipPage::WriteEntry(TUnzipFile *entry)
+{
+    TFile file(FFactory->FZipName.GetData());
+    TDateTime time = entry->GetTime();
+
+    if (!file.IsOpen())
+        WriteError(404);
+    else
+    {
+        if (IsNotModified(time))
+        {
+            FCmd->WriteStartHeader(304);
+            FCmd->WriteEndHeader();
+        }
+        else
+        {
+            FCmd->WriteStartHeader(200);
+            FCmd->WriteTimeOption("Last-Modified", time);
+            FCmd->WriteOption("Content-Type", THttpZipDirFactory::GetContentType(entry->GetFileName()));
+
+            file.SetPos(entry->GetDataOffset());
+
+            if (entry->GetMethod() == DEFLATED)
+            {
+                FCmd->WriteOption("Vary", "Accept-Encoding");
+
+                if (FCmd->AcceptEncoding("gzip"))
+                    SendGzip(file, entry);
+                else
+                    SendInflated(file, entry);
+            }
+            else
+                SendStored(file, entry);
+        }
+        Push();
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipPage::SendStored
+#
+#   Purpose....: Send entry data as is
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpZipPage::SendStored(TFile &file, TUnzipFile *entry)
+{
+    unsigned long size = entry->GetCompressedSize();
+    int count;
+
+    FCmd->WriteOption("Accept-Ranges", "bytes");
+    FCmd->WriteLongOption("Content-Length", size);
+    FCmd->WriteEndHeader();
+
+    while (size)
+    {
+        if (size > HTTP_ZIP_BUF_SIZE)
+            count = HTTP_ZIP_BUF_SIZE;
+        else
+            count = (int)size;
+
+        count = file.Read(FBuf, count);
+        if (count <= 0)
+            break;
+
+        WriteData(FBuf, count);
+        size -= count;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipPage::SendGzip
+#
+#   Purpose....: Send deflated entry data wrapped as a gzip member.
+#                The raw deflate stream, crc and size from the central
+#                directory are exactly what gzip needs, so only a fixed
+#                header and trailer are added.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpZipPage::SendGzip(TFile &file, TUnzipFile *entry)
+{
+    static const char GzipHeader[10] = {0x1F, (char)0x8B, 8, 0, 0, 0, 0, 0, 0, (char)0xFF};
+    unsigned long size = entry->GetCompressedSize();
+    unsigned long val;
+    char trailer[8];
+    int count;
+    int i;
+
+    FCmd->WriteOption("Content-Encoding", "gzip");
+    FCmd->WriteLongOption("Content-Length", size + sizeof(GzipHeader) + sizeof(trailer));
+    FCmd->WriteEndHeader();
+
+    WriteData(GzipHeader, sizeof(GzipHeader));
+
+    while (size)
+    {
+        if (size > HTTP_ZIP_BUF_SIZE)
+            count = HTTP_ZIP_BUF_SIZE;
+        else
+            count = (int)size;
+
+        count = file.Read(FBuf, count);
+        if (count <= 0)
+            break;
+
+        WriteData(FBuf, count);
+        size -= count;
+    }
+
+    val = entry->GetCrc();
+    for (i = 0; i < 4; i++)
+    {
+        trailer[i] = (char)val;
+        val = val >> 8;
+    }
+
+    val = entry->GetSize();
+    for (i = 4; i < 8; i++)
+    {
+        trailer[i] = (char)val;
+        val = val >> 8;
+    }
+
+    WriteData(trailer, sizeof(trailer));
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipPage::SendInflated
+#
+#   Purpose....: Inflate entry for clients not accepting gzip. The
+#                length is declared before inflating, so the connection
+#                is closed if the entry turns out to be corrupt.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpZipPage::SendInflated(TFile &file, TUnzipFile *entry)
+{
+    unsigned long size = entry->GetCompressedSize();
+    unsigned long left = entry->GetSize();
+    char *outbuf;
+    z_stream stream;
+    int count;
+    int err;
+
+    FCmd->WriteOption("Accept-Ranges", "bytes");
+    FCmd->WriteLongOption("Content-Length", left);
+    FCmd->WriteEndHeader();
+
+    memset(&stream, 0, sizeof(stream));
+
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    {
+        CloseConnection();
+        return;
+    }
+
+    outbuf = new char[HTTP_ZIP_BUF_SIZE];
+    err = Z_OK;
+
+    while (err == Z_OK)
+    {
+        if (stream.avail_in == 0 && size)
+        {
+            if (size > HTTP_ZIP_BUF_SIZE)
+                count = HTTP_ZIP_BUF_SIZE;
+            else
+                count = (int)size;
+
+            count = file.Read(FBuf, count);
+            if (count <= 0)
+                break;
+
+            size -= count;
+            stream.next_in = (Bytef *)FBuf;
+            stream.avail_in = count;
+        }
+
+        stream.next_out = (Bytef *)outbuf;
+        stream.avail_out = HTTP_ZIP_BUF_SIZE;
+
+        err = inflate(&stream, Z_NO_FLUSH);
+
+        count = HTTP_ZIP_BUF_SIZE - stream.avail_out;
+        if ((unsigned long)count > left)
+        {
+            count = (int)left;
+            err = Z_DATA_ERROR;
+        }
+
+        if (count)
+        {
+            WriteData(outbuf, count);
+            left -= count;
+        }
+
+        if (err == Z_BUF_ERROR && (stream.avail_in || size))
+            err = Z_OK;
+    }
+
+    if (err != Z_STREAM_END || left)
+        CloseConnection();
+
+    inflateEnd(&stream);
+    delete outbuf;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::THttpZipDirFactory
+#
+#   Purpose....: Constructor. Reads the central directory once and keeps
+#                a sorted index of servable entries.
+#
+#   In params..: ReqName        Url prefix
+#                ZipName        Archive file
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpZipDirFactory::THttpZipDirFactory(const char *ReqName, const char *ZipName)
+  : THttpCustomDirFactory(ReqName),
+    FZipName(ZipName)
+{
+    FIndex = 0;
+    FCount = 0;
+
+    FOk = FUnzip.OpenNoHeader(ZipName);
+
+    if (FOk)
+        BuildIndex();
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::~THttpZipDirFactory
+#
+#   Purpose....: Destructor
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpZipDirFactory::~THttpZipDirFactory()
+{
+    if (FIndex)
+        delete FIndex;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::IsOk
+#
+#   Purpose....: Check if archive was opened
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int THttpZipDirFactory::IsOk()
+{
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::GetFileCount
+#
+#   Purpose....: Get number of servable entries
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int THttpZipDirFactory::GetFileCount()
+{
+    return FCount;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::Create
+#
+#   Purpose....: Create custom page instance
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+THttpCustomPage *THttpZipDirFactory::Create(THttpCommand *Cmd)
+{
+    return new THttpZipPage(Cmd, this);
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::BuildIndex
+#
+#   Purpose....: Build sorted index of stored / deflated file entries
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void THttpZipDirFactory::BuildIndex()
+{
+    int i;
+    int count = FUnzip.GetFileCount();
+    int size;
+    const char *name;
+    TUnzipFile *entry;
+
+    if (count)
+        FIndex = new TUnzipFile *[count];
+
+    for (i = 0; i < count; i++)
+    {
+        entry = FUnzip.GetFile(i);
+
+        if (entry && entry->IsOk() && !entry->IsEncrypted())
+        {
+            if (entry->GetMethod() == STORED || entry->GetMethod() == DEFLATED)
+            {
+                name = entry->GetFileName();
+                size = strlen(name);
+
+                if (size && name[size - 1] != '/')
+                {
+                    FIndex[FCount] = entry;
+                    FCount++;
+                }
+            }
+        }
+    }
+
+    if (FCount > 1)
+        qsort(FIndex, FCount, sizeof(TUnzipFile *), IndexCompare);
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::Lookup
+#
+#   Purpose....: Binary search for entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TUnzipFile *THttpZipDirFactory::Lookup(const char *Name)
+{
+    int low = 0;
+    int high = FCount - 1;
+    int mid;
+    int rv;
+
+    while (low <= high)
+    {
+        mid = (low + high) / 2;
+        rv = CompareName(Name, FIndex[mid]->GetFileName());
+
+        if (rv == 0)
+            return FIndex[mid];
+
+        if (rv < 0)
+            high = mid - 1;
+        else
+            low = mid + 1;
+    }
+
+    return 0;
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::Find
+#
+#   Purpose....: Find entry for request name. The matching url prefix is
+#                removed, and directories map to index.htm.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TUnzipFile *THttpZipDirFactory::Find(const char *ReqName)
+{
+    int i;
+    int count;
+    int size;
+    const char *str;
+    const char *ptr = ReqName;
+    TUnzipFile *entry;
+
+    count = FReqNameList.GetSize();
+
+    for (i = 0; i < count; i++)
+    {
+        str = FReqNameList[i].GetData();
+        if (strstr(ReqName, str) == ReqName)
+        {
+            ptr = ReqName + strlen(str);
+            break;
+        }
+    }
+
+    while (*ptr == '/')
+        ptr++;
+
+    if (*ptr)
+    {
+        entry = Lookup(ptr);
+        if (entry)
+            return entry;
+    }
+
+    TString Name(ptr);
+
+    size = Name.GetSize();
+    if (size && ptr[size - 1] != '/')
+        Name += "/";
+
+    Name += "index.htm";
+
+    return Lookup(Name.GetData());
+}
+
+/*##########################################################################
+#
+#   Name       : THttpZipDirFactory::GetContentType
+#
+#   Purpose....: Get content type from file extension
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+const char *THttpZipDirFactory::GetContentType(const char *FileName)
+{
+    const char *ext = strrchr(FileName, '.');
+    THttpZipContentType *curr;
+
+    if (ext && !strchr(ext, '/'))
+    {
+        ext++;
+
+        for (curr = ContentTypeTab; curr->Ext; curr++)
+            if (CompareName(ext, curr->Ext) == 0)
+                return curr->ContentType;
+    }
+
+    return "application/octet-stream";
+}
@@ -0,0 +1,88 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# httpzip.h
+# Http custom dir serving files from a zip archive
+#
+########################################################################*/
+
+#ifndef _HTTPZIP_H
+#define _HTTPZIP_H
+
+#include "httpcust.h"
+#include "unzip.h"
+
+#define HTTP_ZIP_BUF_SIZE    0x4000
+
+class THttpZipDirFactory;
+
+class THttpZipPage : public THttpCustomPage
+{
+public:
+    THttpZipPage(THttpCommand *Cmd, THttpZipDirFactory *Factory);
+    virtual ~THttpZipPage();
+
+protected:
+    virtual void Get(const char *MatchName, const char *UrlName, THttpParam *Param);
+
+    void WriteEntry(TUnzipFile *entry);
+    void SendStored(TFile &file, TUnzipFile *entry);
+    void SendGzip(TFile &file, TUnzipFile *entry);
+    void SendInflated(TFile &file, TUnzipFile *entry);
+
+    THttpZipDirFactory *FFactory;
+    char *FBuf;
+};
+
+class THttpZipDirFactory : public THttpCustomDirFactory
+{
+friend class THttpZipPage;
+public:
+    THttpZipDirFactory(const char *ReqName, const char *ZipName);
+    virtual ~THttpZipDirFactory();
+
+    int IsOk();
+    int GetFileCount();
+
+    virtual THttpCustomPage *Create(THttpCommand *cmd);
+
+    TUnzipFile *Find(const char *ReqName);
+
+    static const char *GetContentType(const char *FileName);
+
+protected:
+    void BuildIndex();
+    TUnzipFile *Lookup(const char *Name);
+
+    TString FZipName;
+    TUnzip FUnzip;
+    int FOk;
+
+    TUnzipFile **FIndex;
+    int FCount;
+};
+
+#endif
@@ -338,6 +338,349 @@ TFileViewControl *TFileViewFactory::CreateFileView(TControl *control, int xstart
     return Create(control, xstart, ystart, xsize, ysize);
 }
     
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::TFileViewIndexer
+#
+#   Purpose....: Indexer thread constructor
+#
+#   In params..: control        file-view control
+#                FileName       file to index
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFileViewIndexer::TFileViewIndexer(TFileViewControl *control, const char *FileName)
+{
+    FControl = control;
+    FFile = new TFile(FileName);
+    FBuf = new char[FILEVIEW_BLOCK_SIZE];
+    FAborted = FALSE;
+
+    Reset();
+
+    Start("FileView index", 0x4000);
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::~TFileViewIndexer
+#
+#   Purpose....: Indexer thread destructor
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TFileViewIndexer::~TFileViewIndexer()
+{
+    FAborted = TRUE;
+    FSignal.Signal();
+    Stop();
+
+    delete FBuf;
+    delete FFile;
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::Wake
+#
+#   Purpose....: Wake up indexer to check for new data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewIndexer::Wake()
+{
+    FSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::Reset
+#
+#   Purpose....: Restart indexing from start of file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewIndexer::Reset()
+{
+    FPos = 0;
+    FPublishPos = 0;
+    FLineStart = 0;
+    FLines = 0;
+    FLineLen = 0;
+    FLineBegun = FALSE;
+    FPendCr = FALSE;
+    FMaxLen = 0;
+    FMaxPos = 0;
+    FAnchorCount = 0;
+    FDone = FALSE;
+
+    FControl->FIndexSection.Enter();
+
+    FControl->FIndexCount = 0;
+    FControl->FLineCount = 0;
+    FControl->FMaxLen = 0;
+    FControl->FMaxPos = 0;
+    FControl->FIndexDone = FALSE;
+    FControl->FIndexReset = TRUE;
+    FControl->FIndexChanged = TRUE;
+
+    FControl->FIndexSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::AddAnchor
+#
+#   Purpose....: Add start position of every FILEVIEW_INDEX_STEP line
+#
+#   In params..: pos            file position of line
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewIndexer::AddAnchor(long long pos)
+{
+    if (FAnchorCount == FILEVIEW_ANCHOR_BATCH)
+        Publish(FALSE);
+
+    FAnchorArr[FAnchorCount] = pos;
+    FAnchorCount++;
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::EndLine
+#
+#   Purpose....: Terminate current line
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewIndexer::EndLine()
+{
+    if (FLineLen > FMaxLen)
+    {
+        FMaxLen = FLineLen;
+        FMaxPos = FLineStart;
+    }
+
+    FLines++;
+    FLineLen = 0;
+    FLineBegun = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::Publish
+#
+#   Purpose....: Move new anchors and line count to control
+#
+#   In params..: done           reached end of file
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewIndexer::Publish(int done)
+{
+    long long *arr;
+    int size;
+
+    FControl->FIndexSection.Enter();
+
+    size = FControl->FIndexCount + FAnchorCount;
+    if (size > FControl->FIndexSize)
+    {
+        if (FControl->FIndexSize)
+            size = 2 * FControl->FIndexSize;
+        else
+            size = 1024;
+
+        while (size < FControl->FIndexCount + FAnchorCount)
+            size *= 2;
+
+        arr = new long long[size];
+
+        if (FControl->FIndexArr)
+        {
+            memcpy(arr, FControl->FIndexArr, FControl->FIndexCount * sizeof(long long));
+            delete FControl->FIndexArr;
+        }
+
+        FControl->FIndexArr = arr;
+        FControl->FIndexSize = size;
+    }
+
+    memcpy(FControl->FIndexArr + FControl->FIndexCount, FAnchorArr, FAnchorCount * sizeof(long long));
+    FControl->FIndexCount += FAnchorCount;
+    FAnchorCount = 0;
+
+    FControl->FLineCount = FLines;
+    FControl->FMaxLen = FMaxLen;
+    FControl->FMaxPos = FMaxPos;
+
+    if (FLineBegun)
+    {
+        FControl->FLineCount++;
+
+        if (FLineLen > FMaxLen)
+        {
+            FControl->FMaxLen = FLineLen;
+            FControl->FMaxPos = FLineStart;
+        }
+    }
+
+    if (done)
+        FControl->FIndexDone = TRUE;
+
+    FControl->FIndexChanged = TRUE;
+
+    FControl->FIndexSection.Leave();
+
+    FPublishPos = FPos;
+    FDone = done;
+
+    FControl->Redraw();
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::Scan
+#
+#   Purpose....: Index next block of file
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: TRUE if more data might be available
+#
+##########################################################################*/
+int TFileViewIndexer::Scan()
+{
+    long long size;
+    int count;
+    int i;
+    char ch;
+
+    size = FFile->GetSize();
+
+    if (size < FPos)
+    {
+        Reset();
+        FControl->Redraw();
+        return TRUE;
+    }
+
+    if (size == FPos)
+    {
+        if (!FDone)
+            Publish(TRUE);
+        return FALSE;
+    }
+
+    count = FILEVIEW_BLOCK_SIZE;
+    if (size - FPos < count)
+        count = (int)(size - FPos);
+
+    FFile->SetPos(FPos);
+    count = FFile->Read(FBuf, count);
+
+    if (count <= 0)
+    {
+        if (!FDone)
+            Publish(TRUE);
+        return FALSE;
+    }
+
+    FDone = FALSE;
+
+    for (i = 0; i < count; i++)
+    {
+        ch = FBuf[i];
+
+        if (FPendCr)
+        {
+            FPendCr = FALSE;
+            if (ch == 0xa)
+            {
+                FLineStart++;
+                continue;
+            }
+        }
+
+        if (!FLineBegun)
+        {
+            FLineBegun = TRUE;
+            if (FLines % FILEVIEW_INDEX_STEP == 0)
+                AddAnchor(FLineStart);
+        }
+
+        switch (ch)
+        {
+            case 0xd:
+                FPendCr = TRUE;
+                EndLine();
+                FLineStart = FPos + i + 1;
+                break;
+
+            case 0xa:
+                EndLine();
+                FLineStart = FPos + i + 1;
+                break;
+
+            case 0x9:
+                FLineLen += 4 - FLineLen % 4;
+                break;
+
+            default:
+                FLineLen++;
+                break;
+        }
+    }
+
+    FPos += count;
+
+    if (FPos == size || FPos - FPublishPos >= FILEVIEW_PUBLISH_SIZE)
+        Publish(FPos == size);
+
+    return TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewIndexer::Execute
+#
+#   Purpose....: Index file in background
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewIndexer::Execute()
+{
+    while (FInstalled && !FAborted)
+    {
+        if (!Scan())
+        {
+            if (FControl->FFollow)
+                FSignal.WaitTimeout(FILEVIEW_FOLLOW_TIMEOUT);
+            else
+                FSignal.WaitForever();
+        }
+    }
+}
+
 /*##########################################################################
 #
 #   Name       : TFileViewControl::TFileViewControl
@@ -350,7 +693,8 @@ TFileViewControl *TFileViewFactory::CreateFileView(TControl *control, int xstart
 #
 ##########################################################################*/
 TFileViewControl::TFileViewControl(TControlThread *dev, int xstart, int ystart, int xsize, int ysize)
- : TPanelControl(dev)
+ : TPanelControl(dev),
+   FIndexSection("FileView.Index")
 {
     Init();
 
@@ -370,7 +714,8 @@ TFileViewControl::TFileViewControl(TControlThread *dev, int xstart, int ystart,
 #
 ##########################################################################*/
 TFileViewControl::TFileViewControl(TControl *control, int xstart, int ystart, int xsize, int ysize)
- : TPanelControl(control)
+ : TPanelControl(control),
+   FIndexSection("FileView.Index")
 {
     Init();
 
@@ -390,7 +735,8 @@ TFileViewControl::TFileViewControl(TControl *control, int xstart, int ystart, in
 #
 ##########################################################################*/
 TFileViewControl::TFileViewControl(TControlThread *dev)
- : TPanelControl(dev)
+ : TPanelControl(dev),
+   FIndexSection("FileView.Index")
 {
     Init();
 }
@@ -407,7 +753,8 @@ TFileViewControl::TFileViewControl(TControlThread *dev)
 #
 ##########################################################################*/
 TFileViewControl::TFileViewControl(TControl *control)
- : TPanelControl(control)
+ : TPanelControl(control),
+   FIndexSection("FileView.Index")
 {
     Init();
 }
@@ -425,11 +772,19 @@ TFileViewControl::TFileViewControl(TControl *control)
 ##########################################################################*/
 TFileViewControl::~TFileViewControl()
 {
+    Close();
+
     if (FFont)
         delete FFont;
 
-    if (FFile)
-        delete FFile;
+    if (FIndexArr)
+        delete FIndexArr;
+
+    if (FTailArr)
+        delete FTailArr;
+
+    delete FCacheBuf;
+    delete FLineBuf;
 }
 
 /*##########################################################################
@@ -447,6 +802,32 @@ void TFileViewControl::Init()
 {
     FFont = 0;
     FFile = 0;
+    FIndexer = 0;
+
+    FIndexArr = 0;
+    FIndexCount = 0;
+    FIndexSize = 0;
+    FLineCount = 0;
+    FMaxLen = 0;
+    FMaxPos = 0;
+    FIndexDone = FALSE;
+    FIndexChanged = FALSE;
+    FIndexReset = FALSE;
+
+    FViewRows = 0;
+    FViewMaxLen = 0;
+    FViewMaxPos = 0;
+    FFollow = FALSE;
+
+    FCacheBuf = new char[FILEVIEW_BLOCK_SIZE];
+    FCachePos = 0;
+    FCacheSize = 0;
+    FLineBuf = new char[4 * FILEVIEW_MAX_LINE + 1];
+
+    FTailArr = 0;
+    FTailCount = 0;
+    FTailSize = 0;
+    FTailMode = FALSE;
     
     FStartX = 0;
     FStartY = 0;
@@ -455,6 +836,7 @@ void TFileViewControl::Init()
     FDrawG = 0;
     FDrawB = 0;
 
+    FRowHeight = 0;
     FRows = 0;
     FStartRow = 0;
     FStartCol = 0;
@@ -643,110 +1025,325 @@ void TFileViewControl::SetDrawColor(int r, int g, int b)
 #
 #   Name       : TFileViewControl::Load
 #
-#   Purpose....: Load file
+#   Purpose....: Load a new file. The file is indexed in the
+#                background and only visible rows are read
+#
+#   In params..: FileName       file to view
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewControl::Load(const char *FileName)
+{
+    Close();
+
+    FFile = new TFile(FileName);
+    FIndexer = new TFileViewIndexer(this, FileName);
+
+    UpdateList();
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::Load
+#
+#   Purpose....: Load a new file
+#
+#   In params..: FileName       file to view
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewControl::Load(TString &FileName)
+{
+    Load(FileName.GetData());
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::Close
+#
+#   Purpose....: Close file and stop indexer
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TFileViewControl::Load(int pos)
+void TFileViewControl::Close()
 {
-    char *buf;
-    char *dbuf;
-    long fsize;
-    int bsize;
-    int dsize;
-    int done;
-    int src;
-        int dest;
-        char ch;
-    int size;
+    if (FIndexer)
+    {
+        delete FIndexer;
+        FIndexer = 0;
+    }
 
     if (FFile)
     {
-        buf = new char[4097];
-        dbuf = new char[17000];
+        delete FFile;
+        FFile = 0;
+    }
 
-        fsize = (int)FFile->GetSize();
-        if (fsize < pos)
-            pos = fsize;
+    FIndexSection.Enter();
 
-        while (fsize)
-        {            
+    FIndexCount = 0;
+    FLineCount = 0;
+    FMaxLen = 0;
+    FMaxPos = 0;
+    FIndexDone = FALSE;
+    FIndexChanged = FALSE;
+    FIndexReset = FALSE;
 
-            FFile->SetPos(pos);
-            bsize = FFile->Read(buf, 4096);
+    FIndexSection.Leave();
 
-            for (dsize = 0; dsize < bsize; dsize++)
-                if (buf[dsize] == 0xd)
-                    break;
+    FViewRows = 0;
+    FViewMaxLen = 0;
+    FViewMaxPos = 0;
+    FCacheSize = 0;
+    FTailCount = 0;
+    FTailMode = FALSE;
+    FStartRow = 0;
+    FStartCol = 0;
+}
 
-            fsize = dsize;            
+/*##########################################################################
+#
+#   Name       : TFileViewControl::SetFollow
+#
+#   Purpose....: Follow appended data and keep view at end of file
+#
+#   In params..: follow         TRUE to follow
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewControl::SetFollow(int follow)
+{
+    FFollow = follow;
 
-            if (dsize && buf[dsize] == 0xd)
-                dsize--;
-                
-            done = FALSE;
-            while (dsize && !done)
-            {
-                switch (buf[dsize])
-                {
-                    case 0xa:
-                    case ' ':
-                                case 0x9:
-                        dsize--;
-                        break;
-
-                    case 0xd:
-                        dsize--;
-                        done = TRUE;
-                        break;
-
-                    default:
-                        done = TRUE;
-                        break;
-                }
-            }
-    
-            if (fsize)
-                dsize++;
+    if (FIndexer)
+        FIndexer->Wake();
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::IsFollowing
+#
+#   Purpose....: Check if follow mode is on
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TFileViewControl::IsFollowing()
+{
+    return FFollow;
+}
 
-            if (bsize && buf[fsize] == 0xd)
-                fsize++;
+/*##########################################################################
+#
+#   Name       : TFileViewControl::IsIndexDone
+#
+#   Purpose....: Check if whole file is indexed
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TFileViewControl::IsIndexDone()
+{
+    int done;
 
-            done = FALSE;
-            while (fsize < bsize && !done)
-            {
-                switch (buf[fsize])
-                {
-                    case 0xa:
-                        fsize++;
-                        break;
+    FIndexSection.Enter();
+    done = FIndexDone;
+    FIndexSection.Leave();
 
-                    default:
-                        done = TRUE;
-                        break;
-                }
-            }
+    return done;
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::GetRowCount
+#
+#   Purpose....: Get number of rows currently viewable
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: row count
+#
+##########################################################################*/
+int TFileViewControl::GetRowCount()
+{
+    if (FTailMode)
+        return FTailCount;
+    else
+        return FViewRows;
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::SyncIndex
+#
+#   Purpose....: Pick up new index data from indexer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewControl::SyncIndex()
+{
+    int changed;
+    int reset;
+    int done;
+    int rows;
+
+    FIndexSection.Enter();
+
+    changed = FIndexChanged;
+    reset = FIndexReset;
+    done = FIndexDone;
+    rows = FLineCount;
+
+    FViewMaxLen = FMaxLen;
+    FViewMaxPos = FMaxPos;
+
+    FIndexChanged = FALSE;
+    FIndexReset = FALSE;
+
+    FIndexSection.Leave();
+
+    if (!changed)
+        return;
+
+    if (reset)
+    {
+        FCacheSize = 0;
+        FTailMode = FALSE;
+        FStartRow = 0;
+    }
+
+    if (FTailMode)
+    {
+        if (done)
+        {
+            FStartRow += rows - FTailCount;
+            FTailMode = FALSE;
+        }
+    }
+    else
+    {
+        if (FFollow && FStartRow + FRows >= FViewRows)
+            FStartRow = rows - FRows;
+    }
+
+    FViewRows = rows;
+
+    if (FStartRow > GetRowCount() - FRows)
+        FStartRow = GetRowCount() - FRows;
+
+    if (FStartRow < 0)
+        FStartRow = 0;
+
+    UpdateScroll();
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::CacheData
+#
+#   Purpose....: Get file data from block cache
+#
+#   In params..: pos            file position
+#   Out params.: avail          bytes available at position
+#   Returns....: data pointer
+#
+##########################################################################*/
+char *TFileViewControl::CacheData(long long pos, int *avail)
+{
+    if (!FFile)
+    {
+        *avail = 0;
+        return FCacheBuf;
+    }
+
+    if (pos < FCachePos || pos >= FCachePos + FCacheSize)
+    {
+        FCachePos = pos;
+        FFile->SetPos(pos);
+        FCacheSize = FFile->Read(FCacheBuf, FILEVIEW_BLOCK_SIZE);
+        if (FCacheSize < 0)
+            FCacheSize = 0;
+    }
+
+    *avail = (int)(FCachePos + FCacheSize - pos);
+    if (*avail < 0)
+        *avail = 0;
+
+    return FCacheBuf + (int)(pos - FCachePos);
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::ReadRow
+#
+#   Purpose....: Read a row, expand tabs and strip trailing spaces
+#
+#   In params..: pos            file position of row
+#                dbuf           text buffer or 0 to skip row
+#   Out params.: next           file position of next row
+#   Returns....: TRUE if row exists
+#
+##########################################################################*/
+int TFileViewControl::ReadRow(long long pos, char *dbuf, long long *next)
+{
+    char *ptr;
+    int avail;
+    int found = FALSE;
+    int cr = FALSE;
+    int src = 0;
+    int dest = 0;
+    int i;
+    char ch;
 
-            FFile->SetPos(pos);
-            size = FFile->Read(buf, dsize);
+    ptr = CacheData(pos, &avail);
 
-            dest = 0;
-            for (src = 0; src < size; src++)
+    if (!avail)
+    {
+        if (dbuf)
+            *dbuf = 0;
+        *next = pos;
+        return FALSE;
+    }
+
+    while (avail && !found)
+    {
+        for (i = 0; i < avail; i++)
+        {
+            ch = ptr[i];
+
+            if (ch == 0xd || ch == 0xa)
+            {
+                found = TRUE;
+                cr = (ch == 0xd);
+                i++;
+                break;
+            }
+
+            if (dbuf && src < FILEVIEW_MAX_LINE)
             {
-                ch = buf[src];
                 if (ch == 0x9)
                 {
                     dbuf[dest] = ' ';
                     dest++;
-                            
+
                     while ((dest % 4) != 0)
                     {
                         dbuf[dest] = ' ';
                         dest++;
-                    }                         
+                    }
                 }
                 else
                 {
@@ -754,63 +1351,157 @@ void TFileViewControl::Load(int pos)
                     dest++;
                 }
             }
-            dbuf[dest] = 0;
+            src++;
+        }
 
-            FList.Add(TString(dbuf));
+        pos += i;
 
-            pos += fsize;
-        }
+        if (!found)
+            ptr = CacheData(pos, &avail);
+    }
 
-        delete buf;
-        delete dbuf;                
+    if (cr)
+    {
+        ptr = CacheData(pos, &avail);
+        if (avail && *ptr == 0xa)
+            pos++;
     }
-    UpdateList();
+
+    if (dbuf)
+    {
+        while (dest && dbuf[dest - 1] == ' ')
+            dest--;
+
+        dbuf[dest] = 0;
+    }
+
+    *next = pos;
+    return TRUE;
 }
 
 /*##########################################################################
 #
-#   Name       : TFileViewControl::Load
+#   Name       : TFileViewControl::FindRow
 #
-#   Purpose....: Load a new file
+#   Purpose....: Find file position of row from sparse index
 #
-#   In params..: *
+#   In params..: row            row number
 #   Out params.: *
-#   Returns....: *
+#   Returns....: file position, or -1 if not indexed
 #
 ##########################################################################*/
-void TFileViewControl::Load(const char *FileName)
+long long TFileViewControl::FindRow(int row)
 {
-    FList.Clear();
+    long long pos;
+    int index;
+    int i;
 
-    if (FFile)
-        delete FFile;
+    if (FTailMode)
+    {
+        if (row >= 0 && row < FTailCount)
+            return FTailArr[row];
+        else
+            return -1;
+    }
 
-    FFile = new TFile(FileName);
+    if (row < 0 || row >= FViewRows)
+        return -1;
+
+    index = row / FILEVIEW_INDEX_STEP;
 
-         Load(0);
+    FIndexSection.Enter();
+
+    if (index < FIndexCount)
+        pos = FIndexArr[index];
+    else
+        pos = -1;
+
+    FIndexSection.Leave();
+
+    if (pos >= 0)
+        for (i = index * FILEVIEW_INDEX_STEP; i < row; i++)
+            if (!ReadRow(pos, 0, &pos))
+                return -1;
+
+    return pos;
 }
 
 /*##########################################################################
 #
-#   Name       : TFileViewControl::Load
+#   Name       : TFileViewControl::BuildTail
 #
-#   Purpose....: Load a new file
+#   Purpose....: Find rows at end of file without waiting for the
+#                index to complete
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TFileViewControl::Load(TString &FileName)
+void TFileViewControl::BuildTail()
 {
-    FList.Clear();
+    long long size;
+    long long pos;
+    long long next;
+    long long *arr;
 
-    if (FFile)
-        delete FFile;
+    FTailCount = 0;
+
+    if (!FFile)
+        return;
+
+    size = FFile->GetSize();
+    pos = size - FILEVIEW_BLOCK_SIZE;
+
+    if (pos > 0)
+        ReadRow(pos, 0, &pos);
+    else
+        pos = 0;
 
-    FFile = new TFile(FileName.GetData());
+    while (ReadRow(pos, 0, &next))
+    {
+        if (FTailCount == FTailSize)
+        {
+            if (FTailSize)
+                FTailSize *= 2;
+            else
+                FTailSize = 256;
+
+            arr = new long long[FTailSize];
+
+            if (FTailArr)
+            {
+                memcpy(arr, FTailArr, FTailCount * sizeof(long long));
+                delete FTailArr;
+            }
+            FTailArr = arr;
+        }
 
-    Load(0);
+        FTailArr[FTailCount] = pos;
+        FTailCount++;
+        pos = next;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TFileViewControl::LeaveTail
+#
+#   Purpose....: Leave end-of-file view before index is complete
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewControl::LeaveTail()
+{
+    if (FTailMode)
+    {
+        FTailMode = FALSE;
+        FStartRow = 0;
+        UpdateScroll();
+    }
 }
 
 /*##########################################################################
@@ -835,20 +1526,19 @@ void TFileViewControl::RedrawTrans()
 
 /*##########################################################################
 #
-#   Name       : TFileViewControl::UpdateList
+#   Name       : TFileViewControl::UpdateScroll
 #
-#   Purpose....: Update list
+#   Purpose....: Update rows and scrollbars
 #
 #   In params..: *
 #   Out params.: *
 #   Returns....: *
 #
 ##########################################################################*/
-void TFileViewControl::UpdateList()
+void TFileViewControl::UpdateScroll()
 {
-    TString str;
-    int i;
-    int size = FList.GetSize();
+    int size = GetRowCount();
+    long long next;
     int xstart, ystart;
     int xsize, ysize;
     int xdiff, ydiff;
@@ -860,13 +1550,12 @@ void TFileViewControl::UpdateList()
 
     if (FFont)
     {
-        for (i = 0; i < size; i++)
-        {
-            str = FList[i];
-            FFont->GetStringMetrics(str.GetData(), &xsize, &ysize);
+        FFont->GetStringMetrics(" ", &xsize, &ysize);
 
-            if (xsize > maxwidth)
-                maxwidth = xsize;
+        if (FViewMaxLen && ReadRow(FViewMaxPos, FLineBuf, &next))
+        {
+            FFont->GetStringMetrics(FLineBuf, &xsize, &ysize);
+            maxwidth = xsize;
         }
     }
 
@@ -931,7 +1620,22 @@ void TFileViewControl::UpdateList()
     }    
     else
         DisableVerScroll();    
+}
 
+/*##########################################################################
+#
+#   Name       : TFileViewControl::UpdateList
+#
+#   Purpose....: Update list
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TFileViewControl::UpdateList()
+{
+    UpdateScroll();
     Redraw();
 }
 
@@ -951,7 +1655,7 @@ void TFileViewControl::UpdateVerPos()
     int size;
     long double pos;
 
-    size = FList.GetSize();
+    size = GetRowCount();
     
     if (size > FRows)
     {
@@ -995,7 +1699,7 @@ void TFileViewControl::UpdateHorPos()
 ##########################################################################*/
 void TFileViewControl::SetVerPos(int pos)
 {
-    int size = FList.GetSize();
+    int size = GetRowCount();
 
     if (pos > size - FRows)
         pos = size - FRows;
@@ -1055,6 +1759,7 @@ void TFileViewControl::SetHorPos(int pos)
 ##########################################################################*/
 void TFileViewControl::GotoStart()
 {
+    LeaveTail();
     SetVerPos(0);
 }
 
@@ -1071,7 +1776,17 @@ void TFileViewControl::GotoStart()
 ##########################################################################*/
 void TFileViewControl::GotoEnd()
 {
-    SetVerPos(FList.GetSize() - 1);
+    SyncIndex();
+
+    if (!FTailMode && !IsIndexDone())
+    {
+        BuildTail();
+        FTailMode = TRUE;
+        FStartRow = -1;
+        UpdateScroll();
+    }
+
+    SetVerPos(GetRowCount());
 }
 
 /*##########################################################################
@@ -1087,6 +1802,7 @@ void TFileViewControl::GotoEnd()
 ##########################################################################*/
 void TFileViewControl::Goto(int row)
 {
+    LeaveTail();
     SetVerPos(row);
 }
 
@@ -1170,7 +1886,9 @@ void TFileViewControl::VerMove(long double pos)
     int size;
     int row;
 
-    size = FList.GetSize();
+    LeaveTail();
+
+    size = GetRowCount();
     
     if (size > FRows)
     {
@@ -1414,7 +2132,9 @@ void TFileViewControl::Paint(TGraphicDevice *dev, int xmin, int ymin, int width,
     int xoffs, yoffs;
     int xdiff, ydiff;
     int redraw;
-    TString str;
+    long long pos;
+
+    SyncIndex();
 
     TPanelControl::Paint(dev, xmin, ymin, width, height);
     GetInner(&xoffs, &yoffs, &xdiff, &ydiff);
@@ -1446,16 +2166,23 @@ void TFileViewControl::Paint(TGraphicDevice *dev, int xmin, int ymin, int width,
 
         dev->SetFont(FFont);
 
+        pos = FindRow(FStartRow);
+
         for (row = 0; row < FRows; row++)
         {
             curr = FStartRow + row;
 
-            str = FList[curr];            
+            if (pos < 0 || curr >= GetRowCount() || !ReadRow(pos, FLineBuf, &pos))
+            {
+                FLineBuf[0] = 0;
+                pos = -1;
+            }
+
                                 SetBackColor(dev);
                                 dev->DrawRect(xmin, ystart, xmax, ystart + FRowHeight - 1);
 
             dev->SetDrawColor(FDrawR, FDrawG, FDrawB);
-                        dev->DrawString(xstart - FStartCol, ystart, str.GetData());
+                        dev->DrawString(xstart - FStartCol, ystart, FLineBuf);
 
             ystart += FRowHeight;
         }
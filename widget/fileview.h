@@ -36,11 +36,58 @@
 #include "panel.h"
 #include "str.h"
 #include "file.h"
-#include "strarr.h"
 #include "appini.h"
+#include "section.h"
+#include "thread.h"
+#include "sigdev.h"
+
+#define FILEVIEW_INDEX_STEP         64
+#define FILEVIEW_ANCHOR_BATCH       256
+#define FILEVIEW_BLOCK_SIZE         0x10000
+#define FILEVIEW_PUBLISH_SIZE       0x400000
+#define FILEVIEW_MAX_LINE           4096
+#define FILEVIEW_FOLLOW_TIMEOUT     500
 
 class TFileViewControl;
 
+class TFileViewIndexer : public TThread
+{
+public:
+    TFileViewIndexer(TFileViewControl *control, const char *FileName);
+    virtual ~TFileViewIndexer();
+
+    void Wake();
+
+protected:
+    virtual void Execute();
+
+    int Scan();
+    void Reset();
+    void AddAnchor(long long pos);
+    void EndLine();
+    void Publish(int done);
+
+    TFileViewControl *FControl;
+    TFile *FFile;
+    TSignalDevice FSignal;
+    char *FBuf;
+    int FAborted;
+    int FDone;
+
+    long long FPos;
+    long long FPublishPos;
+    long long FLineStart;
+    int FLines;
+    int FLineLen;
+    int FLineBegun;
+    int FPendCr;
+    int FMaxLen;
+    long long FMaxPos;
+
+    long long FAnchorArr[FILEVIEW_ANCHOR_BATCH];
+    int FAnchorCount;
+};
+
 class TFileViewFactory : public TPanelFactory
 {
 public:
@@ -80,6 +127,7 @@ protected:
 
 class TFileViewControl : public TPanelControl
 {
+friend class TFileViewIndexer;
 public:
     TFileViewControl(TControlThread *dev, int xstart, int ystart, int xsize, int ysize);
     TFileViewControl(TControl *control, int xstart, int ystart, int xsize, int ysize);
@@ -100,6 +148,12 @@ public:
 
     void Load(const char *FileName);
     void Load(TString &FileName);
+    void Close();
+
+    void SetFollow(int follow);
+    int IsFollowing();
+    int IsIndexDone();
+    int GetRowCount();
 
     void GotoStart();
     void GotoEnd();
@@ -120,7 +174,6 @@ public:
 protected:
     void SetVerPos(int pos);
     void SetHorPos(int pos);
-    void Load(int pos);
     
         virtual int OnKeyPressed(int ExtKey, int KeyState, int VirtualKey, int ScanCode);
         virtual int OnKeyReleased(int ExtKey, int KeyState, int VirtualKey, int ScanCode);
@@ -129,11 +182,17 @@ protected:
     virtual void NotifyResize();        
 
     void UpdateList();
+    void UpdateScroll();
     void UpdateVerPos();
     void UpdateHorPos();
     int AdjustHor();
 
-    TStringArray FList;
+    void SyncIndex();
+    void BuildTail();
+    void LeaveTail();
+    long long FindRow(int row);
+    char *CacheData(long long pos, int *avail);
+    int ReadRow(long long pos, char *dbuf, long long *next);
 
 private:
     void Init();
@@ -148,6 +207,33 @@ private:
 
     TFont *FFont;
     TFile *FFile;
+    TFileViewIndexer *FIndexer;
+
+    TSection FIndexSection;
+    long long *FIndexArr;
+    int FIndexCount;
+    int FIndexSize;
+    int FLineCount;
+    int FMaxLen;
+    long long FMaxPos;
+    int FIndexDone;
+    int FIndexChanged;
+    int FIndexReset;
+
+    int FViewRows;
+    int FViewMaxLen;
+    long long FViewMaxPos;
+    int FFollow;
+
+    char *FCacheBuf;
+    long long FCachePos;
+    int FCacheSize;
+    char *FLineBuf;
+
+    long long *FTailArr;
+    int FTailCount;
+    int FTailSize;
+    int FTailMode;
 
     int FRowHeight;
     int FRows;
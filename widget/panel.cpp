@@ -1766,7 +1766,7 @@ void TPanelControl::GetInner(int *xstart, int *ystart, int *xdiff, int *ydiff) c
 void TPanelControl::UpdateChild(TControl *control, int level)
 {
     if (IsTransparent() && !FBackground && HasParent() && level == 1)
-        RedrawParent();
+        control->Invalidate();
     else
         TControl::UpdateChild(control, level);
 }
@@ -1785,7 +1785,7 @@ void TPanelControl::UpdateChild(TControl *control, int level)
 void TPanelControl::RedrawChild(TControl *control, int level)
 {
     if (IsTransparent() && !FBackground && HasParent() && level == 1)
-        RedrawParent();
+        control->Invalidate();
     else
         TControl::RedrawChild(control, level);
 }
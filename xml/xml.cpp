@@ -34,6 +34,7 @@
 
 #include "xml.h"
 #include "rdos.h"
+#include "mapfile.h"
 
 #define _atoi64(x) atoll(x)
 
@@ -740,6 +741,196 @@ namespace XMLPP
 
 
 
+        // XMLArena class
+
+#define XML_ARENA_ALIGN(x) (((x) + 7) & ~(size_t)7)
+#define XML_ARENA_MAX_BLOCK 0x100000
+
+        XMLArena::XMLArena(size_t BlockSize)
+        {
+                blocks = 0;
+                blocksize = BlockSize;
+                total = 0;
+                itab = 0;
+                isize = 0;
+                icount = 0;
+        }
+
+        XMLArena :: ~XMLArena()
+        {
+                XMLARENABLOCK* b;
+
+                while (blocks)
+                {
+                        b = blocks->next;
+                        delete[] (char*)blocks;
+                        blocks = b;
+                }
+
+                if (itab)
+                        delete[] itab;
+        }
+
+        char* XMLArena::Take(size_t s)
+        {
+                size_t hs = XML_ARENA_ALIGN(sizeof(XMLARENABLOCK));
+                XMLARENABLOCK* b;
+                char* p;
+
+                s = XML_ARENA_ALIGN(s);
+
+                if (!blocks || blocks->used + s > blocks->size)
+                {
+                        // Blocks double in size up to a limit, so large documents need few of them
+                        size_t bs = blocksize;
+                        if (blocksize < XML_ARENA_MAX_BLOCK)
+                                blocksize *= 2;
+                        if (bs < s)
+                                bs = s;
+
+                        b = (XMLARENABLOCK*)new char[hs + bs];
+                        b->size = bs;
+                        b->used = 0;
+                        b->next = blocks;
+                        blocks = b;
+                        total += hs + bs;
+                }
+
+                p = (char*)blocks + hs + blocks->used;
+                blocks->used += s;
+                return p;
+        }
+
+        void* XMLArena::Alloc(XMLArena* a, size_t s)
+        {
+                size_t hs = XML_ARENA_ALIGN(sizeof(XMLARENAHEADER));
+                XMLARENAHEADER* h;
+
+                if (a)
+                        h = (XMLARENAHEADER*)a->Take(hs + s);
+                else
+                        h = (XMLARENAHEADER*)new char[hs + s];
+
+                h->a = a;
+                h->s = s;
+                return (char*)h + hs;
+        }
+
+        void XMLArena::Free(void* p)
+        {
+                XMLARENAHEADER* h;
+
+                if (!p)
+                        return;
+
+                h = (XMLARENAHEADER*)((char*)p - XML_ARENA_ALIGN(sizeof(XMLARENAHEADER)));
+                if (!h->a)
+                        delete[] (char*)h;
+        }
+
+        void XMLArena::Release(void* p)
+        {
+                // Give back the most recent allocation, used when an interned copy already existed
+                size_t hs = XML_ARENA_ALIGN(sizeof(XMLARENAHEADER));
+                XMLARENAHEADER* h = (XMLARENAHEADER*)((char*)p - hs);
+                char* top;
+
+                if (!blocks || h->a != this)
+                        return;
+
+                top = (char*)blocks + XML_ARENA_ALIGN(sizeof(XMLARENABLOCK)) + blocks->used;
+                if ((char*)p + XML_ARENA_ALIGN(h->s) == top)
+                        blocks->used -= hs + XML_ARENA_ALIGN(h->s);
+        }
+
+        static unsigned int XMLArenaHash(const char* s)
+        {
+                unsigned int h = 2166136261u;
+
+                while (*s)
+                {
+                        h ^= (unsigned char)*s++;
+                        h *= 16777619u;
+                }
+                return h;
+        }
+
+        void XMLArena::GrowInternTable()
+        {
+                unsigned int newsize = isize ? isize * 2 : 256;
+                char** newtab = new char*[newsize];
+                unsigned int i;
+                unsigned int j;
+
+                memset(newtab, 0, newsize * sizeof(char*));
+
+                for (i = 0; i < isize; i++)
+                {
+                        if (itab[i])
+                        {
+                                j = XMLArenaHash(itab[i]) & (newsize - 1);
+                                while (newtab[j])
+                                        j = (j + 1) & (newsize - 1);
+                                newtab[j] = itab[i];
+                        }
+                }
+
+                if (itab)
+                        delete[] itab;
+                itab = newtab;
+                isize = newsize;
+        }
+
+        char* XMLArena::Intern(char* s)
+        {
+                // s must be allocated from this arena. If an equal string is already
+                // interned, s is released and the existing copy is returned.
+                unsigned int i;
+
+                if (2 * (icount + 1) > isize)
+                        GrowInternTable();
+
+                i = XMLArenaHash(s) & (isize - 1);
+                while (itab[i])
+                {
+                        if (strcmp(itab[i], s) == 0)
+                        {
+                                Release(s);
+                                return itab[i];
+                        }
+                        i = (i + 1) & (isize - 1);
+                }
+
+                itab[i] = s;
+                icount++;
+                return s;
+        }
+
+        size_t XMLArena::MemoryUsage()
+        {
+                return total + isize * sizeof(char*);
+        }
+
+        // Grow a pointer array geometrically, keeping the used entries
+        static void** XMLGrowArray(XMLArena* a, void** arr, unsigned int num, int& total, unsigned int need, int init)
+        {
+                int newtotal = total * 2;
+                void** newarr;
+
+                if (newtotal < init)
+                        newtotal = init;
+                if ((unsigned int)newtotal - num < need)
+                        newtotal = num + need;
+
+                newarr = (void**)XMLArena::Alloc(a, newtotal * sizeof(void*));
+                if (num)
+                        memcpy(newarr, arr, num * sizeof(void*));
+                XMLArena::Free(arr);
+
+                total = newtotal;
+                return newarr;
+        }
+
         // XML class
 
         void XML::Version(XML_VERSION_INFO* x)
@@ -765,9 +956,68 @@ namespace XMLPP
                 return Load(txt, XML_LOAD_MODE_MEMORY_BUFFER, 0, 0);
         }
 
+        XMLElement* XML::PartialElement(const char* file, const char* map)
+        {
+                // Stream the file and build only the element at map, a backslash separated
+                // section below the root as in GetElementInSection. Everything else is
+                // skipped without being built or kept in memory.
+                XMLFileInput in(file);
+                if (!in.IsOpen())
+                        return 0;
+
+                XMLReader r(&in);
+                XML_READER_EVENT e;
+
+                for (;;)
+                {
+                        e = r.Next();
+                        if (e == XML_READER_START)
+                                break;
+                        if (e == XML_READER_EOF || e == XML_READER_ERROR)
+                                return 0;
+                }
+
+                if (!map || *map == 0)
+                        return r.ReadElement();
+
+                const char* a1 = map;
+                int matched = 0;
+
+                for (;;)
+                {
+                        e = r.Next();
+                        if (e == XML_READER_EOF || e == XML_READER_ERROR)
+                                return 0;
+
+                        if (e == XML_READER_END && r.GetDepth() == matched)
+                                return 0; // section not found in the first matching parent
+
+                        if (e != XML_READER_START)
+                                continue;
+
+                        const char* a2 = strchr(a1, '\\');
+                        size_t l = a2 ? (size_t)(a2 - a1) : strlen(a1);
+                        XMLSLICE n = r.GetName();
+
+                        if (n.n != l || memcmp(n.p, a1, l) != 0)
+                        {
+                                r.Skip();
+                                continue;
+                        }
+
+                        if (!a2)
+                                return r.ReadElement();
+
+                        matched++;
+                        a1 = a2 + 1;
+                }
+        }
+
         void XML::Init()
         {
                 SOnClose = 0;
+                ArenaMode = false;
+                arena = 0;
                 hdr = 0;
                 root = 0;
                 f = 0;
@@ -791,6 +1041,19 @@ namespace XMLPP
                 if (f)
                         delete[] f;
                 f = 0;
+                // arena, after all nodes that may use it
+                if (arena)
+                        delete arena;
+                arena = 0;
+        }
+
+        void XML::SetArenaMode(bool x)
+        {
+                // Takes effect at the next Load. In arena mode elements, variables, names and
+                // child arrays of the parsed document are allocated from one arena that is freed
+                // with the document, and element and variable names are interned. Elements
+                // from the document must not be kept after it is cleared or deleted.
+                ArenaMode = x;
         }
 
 
@@ -1256,10 +1519,10 @@ namespace XMLPP
                                 continue;
                         }
 
-                        if ((*(a1 + 1) == '!' && strlen(a1) > 2 && *(a1 + 2) == '-' && *(a1 + 3) == '-') || *(a1 + 1) == '?')
+                        if ((*(a1 + 1) == '!' && *(a1 + 2) == '-' && *(a1 + 3) == '-') || *(a1 + 1) == '?')
                                 IsComment = true;
 
-                        if (*(a1 + 1) == '!' && strlen(a1) > 8 && strncmp(a1 + 1, "![CDATA[", 8) == 0)
+                        if (*(a1 + 1) == '!' && strncmp(a1 + 1, "![CDATA[", 8) == 0)
                                 IsCData = true;
 
                         bool Nest = 0;
@@ -1383,12 +1646,13 @@ namespace XMLPP
                 a1[PZ] = CC;
         }
 
-        XMLElement* XMLHelper::ParseElementTree(XMLHeader* hdr, XMLElement* parent, char* tree, char**, XML_PARSE_STATUS& iParseStatus)
+        XMLElement* XMLHelper::ParseElementTree(XMLHeader* hdr, XMLElement* parent, char* tree, char**, XML_PARSE_STATUS& iParseStatus, XMLArena* arena)
         {
                 char *a1, *a2, *a3, *a4, *a5;//,*a6;
                 char c1, c2;//,c3,c4,c5,c6;
 
                 XMLElement* root = 0;
+                bool RootAdded = false; // avoids a linear FindElement for every closing tag
 
                 bool IsRootCommentSecond = false;
 
@@ -1434,7 +1698,7 @@ namespace XMLPP
                         if (IsComment)
                                 a4 += 2; // move to '>'
 
-                        if ((*(a3 + 1) == '!' && strlen(a3 + 1) > 2 && *(a3 + 2) == '-' && *(a3 + 3) == '-') || *(a3 + 1) == '?') // comment/markup
+                        if ((*(a3 + 1) == '!' && *(a3 + 2) == '-' && *(a3 + 3) == '-') || *(a3 + 1) == '?') // comment/markup
                         {
                                 c2 = *a4;
                                 *a4 = 0;
@@ -1462,7 +1726,7 @@ namespace XMLPP
                                 continue;
                         }
 
-                        if ((*(a3 + 1) == '!' && strlen(a3 + 1) > 8 && strncmp(a3 + 1, "![CDATA[", 8) == 0)) // cdata
+                        if (*(a3 + 1) == '!' && strncmp(a3 + 1, "![CDATA[", 8) == 0) // cdata
                         {
                                 c2 = *a4;
                                 *a4 = 0;
@@ -1481,9 +1745,10 @@ namespace XMLPP
 
                         if (*(a3 + 1) == '/') // bye bye from this element
                         {
-                                if (parent && root && parent->FindElement(root) == -1)
+                                if (parent && root && !RootAdded)
                                 {
                                         parent->AddElement(root);
+                                        RootAdded = true;
                                 }
                                 a2 = a4 + 1;
                                 continue;
@@ -1502,14 +1767,17 @@ namespace XMLPP
                                 *a4 = 0;
                                 if (parent)
                                 {
-                                        XMLElement* c = new XMLElement(parent, a3 + 1, 0);
+                                        XMLElement* c = new (arena) XMLElement(parent, a3 + 1, 0, false, arena);
                                         parent->AddElement(c);
                                         if (!root)
+                                        {
                                                 root = c;
+                                                RootAdded = true;
+                                        }
                                 }
                                 else
                                 {
-                                        XMLElement* c = new XMLElement(0, a3 + 1);
+                                        XMLElement* c = new (arena) XMLElement(0, a3 + 1, 0, false, arena);
                                         if (!root)
                                                 root = c;
                                 }
@@ -1541,10 +1809,11 @@ namespace XMLPP
                         // Create element a3
                         c2 = *(a4 + 1);
                         *(a4 + 1) = 0;
-                        root = new XMLElement(parent, a3, 0);
+                        root = new (arena) XMLElement(parent, a3, 0, false, arena);
+                        RootAdded = false;
                         *(a4 + 1) = c2;
                         char* eV = 0;
-                        XMLHelper::ParseElementTree(hdr, root, a4 + 1, &eV, iParseStatus);
+                        XMLHelper::ParseElementTree(hdr, root, a4 + 1, &eV, iParseStatus, arena);
 
 
 
@@ -1589,6 +1858,7 @@ namespace XMLPP
                         children[i] = 0;
                 }
                 childrennum = 0;
+                ResetIndex(false);
                 return 0;
         }
 
@@ -1700,10 +1970,11 @@ namespace XMLPP
 
                 children[i] = 0;
 
-                for (unsigned int k = i; k < childrennum; k++)
+                for (unsigned int k = i; k + 1 < childrennum; k++)
                         children[k] = children[k + 1];
 
                 children[childrennum - 1] = 0;
+                ResetIndex(false);
                 return --childrennum;
         }
 
@@ -1723,10 +1994,11 @@ namespace XMLPP
                         *el = children[i];
                 children[i] = 0;
 
-                for (unsigned int k = i; k < childrennum; k++)
+                for (unsigned int k = i; k + 1 < childrennum; k++)
                         children[k] = children[k + 1];
 
                 children[childrennum - 1] = 0;
+                ResetIndex(false);
                 return --childrennum;
         }
 
@@ -1775,6 +2047,7 @@ namespace XMLPP
                 // Delete this element, but do not remove it.
                 delete children[i];
                 children[i] = 0;
+                ResetIndex(false);
 
                 return 1;
         }
@@ -1815,6 +2088,7 @@ namespace XMLPP
                 // Reload element
                 children[i] = r;
                 r->SetParent(this);
+                ResetIndex(false);
 
                 RdosDeleteFile(us);
                 return 1;
@@ -1839,10 +2113,11 @@ namespace XMLPP
                 XMLElement* x = children[i];
 
                 children[i] = 0;
-                for (unsigned int k = i; k < childrennum; k++)
+                for (unsigned int k = i; k + 1 < childrennum; k++)
                         children[k] = children[k + 1];
 
                 childrennum--;
+                ResetIndex(false);
                 return InsertElement(y, x);
         }
 
@@ -1861,6 +2136,7 @@ namespace XMLPP
                 children[y] = x;
                 x->SetParent(this);
                 childrennum++;
+                ResetIndex(false);
                 return x;
         }
 
@@ -1880,12 +2156,14 @@ namespace XMLPP
                 if (y >= childrennum)
                 {
                         children[childrennum++] = x;
+                        IndexAppend(false);
                         return childrennum;
                 }
 
                 memmove((void*)(children + y + 1), (void*)(children + y), (childrennum - y)*sizeof(XMLElement*));
                 children[y] = x;
                 childrennum++;
+                ResetIndex(false);
 
                 return y;
         }
@@ -2030,6 +2308,7 @@ namespace XMLPP
                         variables[i] = 0;
                 }
                 variablesnum = 0;
+                ResetIndex(true);
                 return 0;
         }
 
@@ -2056,10 +2335,11 @@ namespace XMLPP
                 delete variables[i];
                 variables[i] = 0;
 
-                for (unsigned int k = i; k < variablesnum; k++)
+                for (unsigned int k = i; k + 1 < variablesnum; k++)
                         variables[k] = variables[k + 1];
 
                 variables[variablesnum - 1] = 0;
+                ResetIndex(true);
                 return --variablesnum;
         }
 
@@ -2079,10 +2359,11 @@ namespace XMLPP
                 }
                 variables[i] = 0;
 
-                for (unsigned int k = i; k < variablesnum; k++)
+                for (unsigned int k = i; k + 1 < variablesnum; k++)
                         variables[k] = variables[k + 1];
 
                 variables[variablesnum - 1] = 0;
+                ResetIndex(true);
                 return --variablesnum;
         }
 
@@ -2628,6 +2909,7 @@ namespace XMLPP
                         qsort(x, y, sizeof(XMLElement*), XMLElementfcmp);
                 else
                         qsort(x, y, sizeof(XMLElement*), fcmp);
+                ResetIndex(false);
         }
 
         void XMLElement::SortVariables(int(*fcmp)(const void *, const void *))
@@ -2639,6 +2921,7 @@ namespace XMLPP
                         qsort(x, y, sizeof(XMLVariable*), XMLVariablefcmp);
                 else
                         qsort(x, y, sizeof(XMLVariable*), fcmp);
+                ResetIndex(true);
         }
 
         // Memory usage funcs
@@ -3010,12 +3293,12 @@ namespace XMLPP
                         if (PC == 0)
                                 PC = 1;
 
-                        XMLComment** oldpc = new XMLComment*[PC];
+                        XMLComment** oldpc = (XMLComment**)XMLArena::Alloc(arena, PC*sizeof(XMLComment*));
                         if (commentsnum)
                                 memcpy(oldpc, comments, commentsnum*sizeof(XMLComment*));
 
                         TotalCommentPointersAvailable = PC;
-                        delete[] comments;
+                        XMLArena::Free(comments);
                         comments = oldpc;
                 }
 
@@ -3025,12 +3308,12 @@ namespace XMLPP
                         if (PV == 0)
                                 PV = 1;
 
-                        XMLVariable** oldpv = new XMLVariable*[PV];
+                        XMLVariable** oldpv = (XMLVariable**)XMLArena::Alloc(arena, PV*sizeof(XMLVariable*));
                         if (variablesnum)
                                 memcpy(oldpv, variables, variablesnum*sizeof(XMLVariable*));
 
                         TotalVariablePointersAvailable = PV;
-                        delete[] variables;
+                        XMLArena::Free(variables);
                         variables = oldpv;
                 }
 
@@ -3040,12 +3323,12 @@ namespace XMLPP
                         if (PE == 0)
                                 PE = 1;
 
-                        XMLElement** oldpv = new XMLElement*[PE];
+                        XMLElement** oldpv = (XMLElement**)XMLArena::Alloc(arena, PE*sizeof(XMLElement*));
                         if (childrennum)
                                 memcpy(oldpv, children, childrennum*sizeof(XMLElement*));
 
                         TotalChildPointersAvailable = PE;
-                        delete[] children;
+                        XMLArena::Free(children);
                         children = oldpv;
                 }
 
@@ -3362,13 +3645,16 @@ namespace XMLPP
         void XMLElement::SetElementName(const char* x)
         {
 
-                if (el)
-                        delete[] el;
+                XMLArena::Free(el);
                 el = 0;
+                if (parent)
+                        parent->ResetIndex(false);
                 size_t Sug = XML::XMLEncode(x, 0);
-                el = new char[Sug + 10];
+                el = (char*)XMLArena::Alloc(arena, Sug + 10);
                 memset(el, 0, Sug + 10);
                 XML::XMLEncode(x, el);
+                if (arena)
+                        el = arena->Intern(el);
         }
 
         size_t XMLElement::GetElementName(char* x, int NoDecode)
@@ -3441,46 +3727,172 @@ namespace XMLPP
                 return type;
         }
 
-        int XMLElement::FindElement(XMLElement* x)
+        // Name lookups
+        // Names are stored encoded, so they are only decoded for comparison when they hold an entity
+
+#define XML_INDEX_MIN 16
+
+        static bool XMLNameIs(const char* raw, const char* n)
         {
-                for (unsigned int i = 0; i < childrennum; i++)
+                const char* a = raw;
+                const char* b = n;
+
+                while (*a && *a != '&')
                 {
-                        if (children[i] == x)
+                        if (*a != *b)
+                                return false;
+                        a++;
+                        b++;
+                }
+                if (*a == 0)
+                        return *b == 0;
+
+                Z<char> d(strlen(raw) + 1);
+                XML::XMLDecode(raw, d);
+                return strcmp(d, n) == 0;
+        }
+
+        static bool XMLSameName(const char* a, const char* b)
+        {
+                if (!strchr(a, '&'))
+                        return XMLNameIs(b, a);
+
+                Z<char> d(strlen(a) + 1);
+                XML::XMLDecode(a, d);
+                return XMLNameIs(b, d);
+        }
+
+        static unsigned int XMLNameHash(const char* raw)
+        {
+                // Hash of the decoded name
+                if (!strchr(raw, '&'))
+                        return XMLArenaHash(raw);
+
+                Z<char> d(strlen(raw) + 1);
+                XML::XMLDecode(raw, d);
+                return XMLArenaHash(d);
+        }
+
+        const char* XMLElement::IndexName(bool Variables, unsigned int i)
+        {
+                if (Variables)
+                        return variables[i] ? variables[i]->vn : 0;
+                return children[i] ? children[i]->el : 0;
+        }
+
+        void XMLElement::IndexInsert(XMLNAMEINDEX* x, bool Variables, unsigned int i)
+        {
+                // Keep the first position of each name, as the linear search finds
+                const char* n = IndexName(Variables, i);
+                if (!n)
+                        return;
+
+                unsigned int m = x->size - 1;
+                unsigned int h = XMLNameHash(n) & m;
+                while (x->slots[h])
+                {
+                        if (XMLSameName(IndexName(Variables, x->slots[h] - 1), n))
+                                return;
+                        h = (h + 1) & m;
+                }
+                x->slots[h] = i + 1;
+                x->count++;
+        }
+
+        void XMLElement::IndexAppend(bool Variables)
+        {
+                // The last child or variable was appended
+                XMLNAMEINDEX* x = Variables ? varindex : childindex;
+                if (!x)
+                        return;
+
+                if (2 * (x->count + 1) > x->size)
+                        ResetIndex(Variables); // rebuilt larger on the next lookup
+                else
+                        IndexInsert(x, Variables, (Variables ? variablesnum : childrennum) - 1);
+        }
+
+        int XMLElement::IndexFind(bool Variables, const char* n)
+        {
+                unsigned int num = Variables ? variablesnum : childrennum;
+                XMLNAMEINDEX* x = Variables ? varindex : childindex;
+                const char* c;
+                unsigned int i;
+
+                if (num < XML_INDEX_MIN)
+                {
+                        for (i = 0; i < num; i++)
+                        {
+                                c = IndexName(Variables, i);
+                                if (c && XMLNameIs(c, n))
+                                        return i;
+                        }
+                        return -1;
+                }
+
+                if (!x)
+                {
+                        x = new XMLNAMEINDEX;
+                        x->size = 32;
+                        while (x->size < 4 * num)
+                                x->size *= 2;
+                        x->slots = new unsigned int[x->size];
+                        memset(x->slots, 0, x->size * sizeof(unsigned int));
+                        x->count = 0;
+                        for (i = 0; i < num; i++)
+                                IndexInsert(x, Variables, i);
+
+                        if (Variables)
+                                varindex = x;
+                        else
+                                childindex = x;
+                }
+
+                unsigned int m = x->size - 1;
+                unsigned int h = XMLArenaHash(n) & m;
+                while (x->slots[h])
+                {
+                        i = x->slots[h] - 1;
+                        c = i < num ? IndexName(Variables, i) : 0;
+                        if (c && XMLNameIs(c, n))
                                 return i;
+                        h = (h + 1) & m;
                 }
                 return -1;
         }
 
-        int XMLElement::FindElement(const char* n)
+        void XMLElement::ResetIndex(bool Variables)
+        {
+                XMLNAMEINDEX*& x = Variables ? varindex : childindex;
+                if (x)
+                {
+                        delete[] x->slots;
+                        delete x;
+                }
+                x = 0;
+        }
+
+        int XMLElement::FindElement(XMLElement* x)
         {
                 for (unsigned int i = 0; i < childrennum; i++)
                 {
-                        if (!children[i])
-                                continue;
-                        XMLElement* cc = children[i];
-                        size_t Sug = cc->GetElementName(0);
-                        Z<char> Name(Sug + 10);
-                        cc->GetElementName(Name);
-                        if (strcmp(Name, n) == 0)
+                        if (children[i] == x)
                                 return i;
                 }
                 return -1;
         }
 
+        int XMLElement::FindElement(const char* n)
+        {
+                return IndexFind(false, n);
+        }
+
         XMLElement *XMLElement::GetElement(const char* n)
         {
-                for (unsigned int i = 0; i < childrennum; i++)
-                {
-                        if (!children[i])
-                                continue;
-                        XMLElement* cc = children[i];
-                        size_t Sug = cc->GetElementName(0);
-                        Z<char> Name(Sug + 10);
-                        cc->GetElementName(Name);
-                        if (strcmp(Name, n) == 0)
-                                return cc;
-                }
-                return 0;
+                int i = IndexFind(false, n);
+                if (i == -1)
+                        return 0;
+                return children[i];
         }
 
         XMLElement* XMLElement::FindElementZ(XMLElement* x)
@@ -3495,17 +3907,9 @@ namespace XMLPP
 
         XMLElement* XMLElement::FindElementZ(const char* n, bool ForceCreate, char* el, bool Temp)
         {
-                for (unsigned int i = 0; i < childrennum; i++)
-                {
-                        if (!children[i])
-                                continue;
-                        XMLElement* cc = children[i];
-                        size_t Sug = cc->GetElementName(0);
-                        Z<char> Name(Sug + 10);
-                        cc->GetElementName(Name);
-                        if (strcmp(Name, n) == 0)
-                                return cc;
-                }
+                int i = IndexFind(false, n);
+                if (i != -1)
+                        return children[i];
                 if (ForceCreate == 0)
                         return 0;
 
@@ -3538,32 +3942,15 @@ namespace XMLPP
 
         int XMLElement::FindVariable(const char*  x)
         {
-                for (unsigned int i = 0; i < variablesnum; i++)
-                {
-                        XMLVariable* V = variables[i];
-
-                        size_t Sug = V->GetName(0);
-                        Z<char> Name(Sug + 10);
-                        V->GetName(Name);
-                        if (strcmp(Name, x) == 0)
-                                return i;
-                }
-                return -1;
+                return IndexFind(true, x);
         }
 
         XMLVariable* XMLElement::GetVariable(const char*  x)
         {
-                for (unsigned int i = 0; i < variablesnum; i++)
-                {
-                        XMLVariable* V = variables[i];
-
-                        size_t Sug = V->GetName(0);
-                        Z<char> Name(Sug + 10);
-                        V->GetName(Name);
-                        if (strcmp(Name, x) == 0)
-                                return V;
-                }
-                return 0;
+                int i = IndexFind(true, x);
+                if (i == -1)
+                        return 0;
+                return variables[i];
         }
 
         int XMLElement::GetVariableInt(const char*  x, int def)
@@ -3639,15 +4026,9 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
 
         XMLVariable* XMLElement::FindVariableZ(const char*  x, bool ForceCreate, char* defnew, bool Temp)
         {
-                for (unsigned int i = 0; i < variablesnum; i++)
-                {
-                        XMLVariable* V = variables[i];
-                        size_t Sug = V->GetName(0);
-                        Z<char> Name(Sug + 10);
-                        V->GetName(Name);
-                        if (strcmp(Name, x) == 0)
-                                return V;
-                }
+                int i = IndexFind(true, x);
+                if (i != -1)
+                        return variables[i];
                 if (ForceCreate == 0)
                         return 0;
 
@@ -3761,7 +4142,11 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 a1 = strchr(a2, '<');
 
                 if (a1)
-                        root = XMLHelper::ParseElementTree(hdr, 0, a1, 0, iParseStatus);
+                {
+                        if (ArenaMode)
+                                arena = new XMLArena;
+                        root = XMLHelper::ParseElementTree(hdr, 0, a1, 0, iParseStatus, arena);
+                }
                 else
                 {
                         if (f)
@@ -3790,7 +4175,6 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
 
         XML::XML(XML& xml)
         {
-                Clear();
                 Init();
                 operator =(xml);
         }
@@ -3820,9 +4204,14 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 Z<char> elm(strlen(elm2) + 1);
                 strcpy(elm, elm2);
 
+                XMLArena::Free(el);
+                el = 0;
+                if (parent)
+                        parent->ResetIndex(false);
+
                 if (Type == 1)
                 {
-                        el = new char[strlen(elm) + 1];
+                        el = (char*)XMLArena::Alloc(arena, strlen(elm) + 1);
                         strcpy(el, elm);
                         return;
                 }
@@ -3848,11 +4237,13 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 }
 
                 size_t Sug = XML::XMLEncode(xel, 0);
-                char* ael = new char[Sug + 10];
+                char* ael = (char*)XMLArena::Alloc(arena, Sug + 10);
                 memset(ael, 0, Sug + 10);
                 XML::XMLEncode(xel, ael);
 
                 delete[] xel;
+                if (arena)
+                        ael = arena->Intern(ael);
                 el = ael;
 
                 // must be variable ?
@@ -3904,7 +4295,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                                 return;
                         *a3 = 0;
 
-                        XMLVariable* v = new XMLVariable(vvn, a1, true);
+                        XMLVariable* v = new (arena) XMLVariable(vvn, a1, true, false, arena);
                         *a2 = '=';
                         *a3 = VF;
                         AddVariable(v);
@@ -3924,47 +4315,47 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 return d;
         }
 
-        XMLElement::XMLElement(XMLElement* par, const char* elm, int Type, bool Temp)
+        XMLElement::XMLElement(XMLElement* par, const char* elm, int Type, bool Temp, XMLArena* Arena)
         {
 
                 // parent
                 parent = par;
 
+                // arena, inherited so that children added later share the document arena
+                arena = Arena;
+                if (!arena && par)
+                        arena = par->arena;
+
                 // Temp
                 Temporal = Temp;
 
                 // type
                 type = Type;
 
-                // children
-                children = new XMLElement*[XML_MAX_INIT_CHILDREN];
-                memset(children, 0, sizeof(XMLElement*)*XML_MAX_INIT_CHILDREN);
-                TotalChildPointersAvailable = XML_MAX_INIT_CHILDREN;
-                childrennum = 0;
+                // element
+                el = 0;
 
+                // pointer arrays are allocated on first use and grow geometrically
+                childindex = 0;
+                varindex = 0;
+                children = 0;
+                TotalChildPointersAvailable = 0;
+                childrennum = 0;
 
-                // variables
-                variables = new XMLVariable*[XML_MAX_INIT_VARIABLES];
-                memset(variables, 0, sizeof(XMLVariable*)*XML_MAX_INIT_VARIABLES);
-                TotalVariablePointersAvailable = XML_MAX_INIT_VARIABLES;
+                variables = 0;
+                TotalVariablePointersAvailable = 0;
                 variablesnum = 0;
 
-                // contents
-                contents = new XMLContent*[XML_MAX_INIT_CONTENTS];
-                memset(contents, 0, sizeof(XMLContent*)*XML_MAX_INIT_CONTENTS);
-                TotalContentPointersAvailable = XML_MAX_INIT_CONTENTS;
+                contents = 0;
+                TotalContentPointersAvailable = 0;
                 contentsnum = 0;
 
-                // comments
-                comments = new XMLComment*[XML_MAX_INIT_COMMENTS];
-                memset(comments, 0, sizeof(XMLComment*)*XML_MAX_INIT_COMMENTS);
-                TotalCommentPointersAvailable = XML_MAX_INIT_COMMENTS;
+                comments = 0;
+                TotalCommentPointersAvailable = 0;
                 commentsnum = 0;
 
-                // cdatas
-                cdatas = new XMLCData*[XML_MAX_INIT_CDATAS];
-                memset(cdatas, 0, sizeof(XMLCData*)*XML_MAX_INIT_CDATAS);
-                TotalCDataPointersAvailable = XML_MAX_INIT_CDATAS;
+                cdatas = 0;
+                TotalCDataPointersAvailable = 0;
                 cdatasnum = 0;
 
                 // Borrowed Elements
@@ -3974,6 +4365,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 xfformat.nId = 1;
                 xfformat.UseSpace = false;
                 xfformat.ElementsNoBreak = false;
+                xfformat.ContentsNoBreak = false;
 
                 // param 0
                 param = 0;
@@ -3984,6 +4376,26 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                         Reparse("<root />", Type);
         }
 
+        void* XMLElement :: operator new(size_t s)
+        {
+                return XMLArena::Alloc(0, s);
+        }
+
+        void* XMLElement :: operator new(size_t s, XMLArena* a)
+        {
+                return XMLArena::Alloc(a, s);
+        }
+
+        void XMLElement :: operator delete(void* p)
+        {
+                XMLArena::Free(p);
+        }
+
+        void XMLElement :: operator delete(void* p, XMLArena*)
+        {
+                XMLArena::Free(p);
+        }
+
 
         void XMLElement::SetTemporal(bool x)
         {
@@ -4003,8 +4415,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 RemoveAllContents();
                 RemoveAllCDatas();
                 // element
-                if (el)
-                        delete[] el;
+                XMLArena::Free(el);
                 el = 0;
         }
 
@@ -4012,28 +4423,23 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
         {
                 Clear();
 
-                if (variables)
-                        delete[] variables;
+                XMLArena::Free(variables);
                 variables = 0;
                 variablesnum = 0;
 
-                if (children)
-                        delete[] children;
+                XMLArena::Free(children);
                 children = 0;
                 childrennum = 0;
 
-                if (comments)
-                        delete[] comments;
+                XMLArena::Free(comments);
                 comments = 0;
                 commentsnum = 0;
 
-                if (contents)
-                        delete[] contents;
+                XMLArena::Free(contents);
                 contents = 0;
                 contentsnum = 0;
 
-                if (cdatas)
-                        delete[] cdatas;
+                XMLArena::Free(cdatas);
                 cdatas = 0;
                 cdatasnum = 0;
         }
@@ -4087,17 +4493,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 if ((TotalChildPointersAvailable - childrennum) >= i)
                         return (TotalChildPointersAvailable - childrennum);
 
-                // make more space
-                Z<XMLElement*> oldp(childrennum);
-                memcpy(oldp, children, childrennum*sizeof(XMLElement*));
-
-                TotalChildPointersAvailable += XML_MAX_INIT_CHILDREN;
-                if ((TotalChildPointersAvailable - childrennum) < i)
-                        TotalChildPointersAvailable = childrennum + i + 10;
-
-                delete[] children;
-                children = new XMLElement*[TotalChildPointersAvailable];
-                memcpy(children, oldp, childrennum*sizeof(XMLElement*));
+                children = (XMLElement**)XMLGrowArray(arena, (void**)children, childrennum, TotalChildPointersAvailable, i, XML_MAX_INIT_CHILDREN);
                 return (TotalChildPointersAvailable - childrennum);
         }
 
@@ -4107,14 +4503,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 if ((TotalVariablePointersAvailable - variablesnum) >= i)
                         return (TotalVariablePointersAvailable - variablesnum);
 
-                Z<XMLVariable*> oldp(variablesnum);
-                memcpy(oldp, variables, variablesnum*sizeof(XMLVariable*));
-
-                TotalVariablePointersAvailable += XML_MAX_INIT_VARIABLES;
-
-                delete[] variables;
-                variables = new XMLVariable*[TotalVariablePointersAvailable];
-                memcpy(variables, oldp, variablesnum*sizeof(XMLVariable*));
+                variables = (XMLVariable**)XMLGrowArray(arena, (void**)variables, variablesnum, TotalVariablePointersAvailable, i, XML_MAX_INIT_VARIABLES);
                 return (TotalVariablePointersAvailable - variablesnum);
         }
 
@@ -4123,14 +4512,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 if ((TotalCommentPointersAvailable - commentsnum) >= i)
                         return (TotalCommentPointersAvailable - commentsnum);
 
-                Z<XMLComment*> oldp(commentsnum);
-                memcpy(oldp, comments, commentsnum*sizeof(XMLComment*));
-
-                TotalCommentPointersAvailable += XML_MAX_INIT_COMMENTS;
-
-                delete[] comments;
-                comments = new XMLComment*[TotalCommentPointersAvailable];
-                memcpy(comments, oldp, commentsnum*sizeof(XMLComment*));
+                comments = (XMLComment**)XMLGrowArray(arena, (void**)comments, commentsnum, TotalCommentPointersAvailable, i, XML_MAX_INIT_COMMENTS);
                 return (TotalCommentPointersAvailable - commentsnum);
         }
         int XMLHeader::SpaceForComment(unsigned int i)
@@ -4138,30 +4520,26 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 if ((TotalCommentPointersAvailable - commentsnum) >= i)
                         return (TotalCommentPointersAvailable - commentsnum);
 
-                Z<XMLComment*> oldp(commentsnum);
-                memcpy(oldp, comments, commentsnum*sizeof(XMLComment*));
-
-                TotalCommentPointersAvailable += XML_MAX_INIT_COMMENTS;
+                int newtotal = TotalCommentPointersAvailable * 2;
+                if (newtotal < XML_MAX_INIT_COMMENTS)
+                        newtotal = XML_MAX_INIT_COMMENTS;
+                if ((unsigned int)newtotal - commentsnum < i)
+                        newtotal = commentsnum + i;
 
+                XMLComment** newp = new XMLComment*[newtotal];
+                memcpy(newp, comments, commentsnum*sizeof(XMLComment*));
                 delete[] comments;
-                comments = new XMLComment*[TotalCommentPointersAvailable];
-                memcpy(comments, oldp, commentsnum*sizeof(XMLComment*));
+                comments = newp;
+                TotalCommentPointersAvailable = newtotal;
                 return (TotalCommentPointersAvailable - commentsnum);
         }
 
         int XMLElement::SpaceForCData(unsigned int i)
         {
                 if ((TotalCDataPointersAvailable - cdatasnum) >= i)
-                        return (TotalCDataPointersAvailable - commentsnum);
+                        return (TotalCDataPointersAvailable - cdatasnum);
 
-                Z<XMLCData*> oldp(cdatasnum);
-                memcpy(oldp, cdatas, cdatasnum*sizeof(XMLCData*));
-
-                TotalCDataPointersAvailable += XML_MAX_INIT_CDATAS;
-
-                delete[] cdatas;
-                cdatas = new XMLCData*[TotalCDataPointersAvailable];
-                memcpy(cdatas, oldp, cdatasnum*sizeof(XMLCData*));
+                cdatas = (XMLCData**)XMLGrowArray(arena, (void**)cdatas, cdatasnum, TotalCDataPointersAvailable, i, XML_MAX_INIT_CDATAS);
                 return (TotalCDataPointersAvailable - cdatasnum);
         }
 
@@ -4171,14 +4549,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 if ((TotalContentPointersAvailable - contentsnum) >= i)
                         return (TotalContentPointersAvailable - contentsnum);
 
-                Z<char*> oldp(contentsnum);
-                memcpy(oldp, contents, contentsnum*sizeof(char*));
-
-                TotalContentPointersAvailable += XML_MAX_INIT_CONTENTS;
-
-                delete[] contents;
-                contents = new XMLContent*[TotalContentPointersAvailable];
-                memcpy(contents, oldp, contentsnum*sizeof(XMLContent*));
+                contents = (XMLContent**)XMLGrowArray(arena, (void**)contents, contentsnum, TotalContentPointersAvailable, i, XML_MAX_INIT_CONTENTS);
                 return (TotalContentPointersAvailable - contentsnum);
         }
 
@@ -4188,11 +4559,12 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 SpaceForElement(1);
                 children[childrennum++] = child;
                 child->SetParent(this);
+                IndexAppend(false);
                 return child;
         }
         XMLElement* XMLElement::AddElement(const char* t)
         {
-                XMLElement* x = new XMLElement(this, t, 0, 0);
+                XMLElement* x = new (arena) XMLElement(this, t, 0, 0);
                 return AddElement(x);
         }
 
@@ -4201,6 +4573,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 SpaceForVariable(1);
                 variables[variablesnum++] = v;
                 v->SetOwnerElement(this);
+                IndexAppend(true);
                 return variablesnum;
         }
         int XMLElement::AddVariable(const char* vn, const char* vv)
@@ -4298,7 +4671,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 delete comments[i];
                 comments[i] = 0;
 
-                for (unsigned int k = i; k < commentsnum; k++)
+                for (unsigned int k = i; k + 1 < commentsnum; k++)
                         comments[k] = comments[k + 1];
 
                 comments[commentsnum - 1] = 0;
@@ -4344,7 +4717,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 delete cdatas[i];
                 cdatas[i] = 0;
 
-                for (unsigned int k = i; k < cdatasnum; k++)
+                for (unsigned int k = i; k + 1 < cdatasnum; k++)
                         cdatas[k] = cdatas[k + 1];
 
                 cdatas[cdatasnum - 1] = 0;
@@ -4375,7 +4748,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 delete contents[i];
                 contents[i] = 0;
 
-                for (unsigned int k = i; k < contentsnum; k++)
+                for (unsigned int k = i; k + 1 < contentsnum; k++)
                         contents[k] = contents[k + 1];
 
                 contents[contentsnum - 1] = 0;
@@ -5264,7 +5637,7 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                 delete comments[i];
                 comments[i] = 0;
 
-                for (unsigned int k = i; k < commentsnum; k++)
+                for (unsigned int k = i; k + 1 < commentsnum; k++)
                         comments[k] = comments[k + 1];
 
                 comments[commentsnum - 1] = 0;
@@ -5309,10 +5682,11 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
         // XMLVariable class
         void XMLVariable::SetName(const char* VN, int NoDecode)
         {
-                if (vn)
-                        delete[] vn;
+                if (owner)
+                        owner->ResetIndex(true);
+                XMLArena::Free(vn);
                 size_t Sug = XML::XMLEncode(VN, 0);
-                vn = new char[Sug + 10];
+                vn = (char*)XMLArena::Alloc(arena, Sug + 10);
                 memset(vn, 0, Sug + 10);
                 if (NoDecode)
                         strcpy(vn, VN);
@@ -5320,16 +5694,19 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                         XML::XMLEncode(VN, vn);
 
                 // 0x132 fix for white space at the end of the variable
-                while (vn[strlen(vn) - 1] == ' ')
-                        vn[strlen(vn) - 1] = 0;
+                size_t len = strlen(vn);
+                while (len && vn[len - 1] == ' ')
+                        vn[--len] = 0;
+
+                if (arena)
+                        vn = arena->Intern(vn);
         }
 
         void XMLVariable::SetValue(const char* VV, int NoDecode)
         {
-                if (vv)
-                        delete[] vv;
+                XMLArena::Free(vv);
                 size_t Sug = XML::XMLEncode(VV, 0);
-                vv = new char[Sug + 10];
+                vv = (char*)XMLArena::Alloc(arena, Sug + 10);
                 memset(vv, 0, Sug + 10);
                 if (NoDecode)
                         strcpy(vv, VV);
@@ -5337,11 +5714,12 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
                         XML::XMLEncode(VV, vv);
         }
 
-        XMLVariable::XMLVariable(const char* VN, const char* VV, int NoDecode, bool Temp)
+        XMLVariable::XMLVariable(const char* VN, const char* VV, int NoDecode, bool Temp, XMLArena* Arena)
         {
                 vn = 0;
                 vv = 0;
                 owner = 0;
+                arena = Arena;
                 Temporal = Temp;
                 SetName(VN, NoDecode);
                 SetValue(VV, NoDecode);
@@ -5371,22 +5749,43 @@ bool XMLElement::GetVariableBoolean(const char*  x, bool def)
 
         void XMLVariable::Clear()
         {
-                if (vn)
-                        delete[] vn;
+                XMLArena::Free(vn);
                 vn = 0;
 
-                if (vv)
-                        delete[] vv;
+                XMLArena::Free(vv);
                 vv = 0;
         }
 
-        XMLVariable :: ~XMLVariable()
+        void* XMLVariable :: operator new(size_t s)
         {
-                Clear();
+                return XMLArena::Alloc(0, s);
         }
 
-        XMLVariable::XMLVariable(const XMLVariable& h)
+        void* XMLVariable :: operator new(size_t s, XMLArena* a)
         {
+                return XMLArena::Alloc(a, s);
+        }
+
+        void XMLVariable :: operator delete(void* p)
+        {
+                XMLArena::Free(p);
+        }
+
+        void XMLVariable :: operator delete(void* p, XMLArena*)
+        {
+                XMLArena::Free(p);
+        }
+
+        XMLVariable :: ~XMLVariable()
+        {
+                Clear();
+        }
+
+        XMLVariable::XMLVariable(const XMLVariable& h)
+        {
+                vn = 0;
+                vv = 0;
+                arena = 0;
                 operator =(h);
         }
 
@@ -5825,10 +6224,16 @@ TString XMLVariable :: GetValueString()
                 return r->XMLQuery(expression, rv, deep);
         }
 
-        int XMLElement::XMLQuery(const char* expression2, XMLElement** rv, unsigned int deep)
+        int XML::XMLQuery(const char* rootsection, XMLCompiledQuery& q, XMLElement** rv, unsigned int deep)
+        {
+                XMLElement* r = root->GetElementInSection(rootsection);
+                if (!r)
+                        return 0;
+                return q.Execute(r, rv, deep);
+        }
+
+        int XMLElement::XMLQuery(const char* expression, XMLElement** rv, unsigned int deep)
         {
-                Z<char> expression(strlen(expression2) + 1);
-                strcpy(expression, expression2);
                 // Executes query based on expression of variables
                 /*
 
@@ -5858,40 +6263,76 @@ TString XMLVariable :: GetValueString()
 
                 */
 
-                XMLElement* r = this;
+                XMLCompiledQuery q(expression);
+                return q.Execute(this, rv, deep);
+        }
+
+        int XMLElement::XMLQuery(XMLCompiledQuery& q, XMLElement** rv, unsigned int deep)
+        {
+                return q.Execute(this, rv, deep);
+        }
+
+        // XMLCompiledQuery class
+
+        XMLCompiledQuery::XMLCompiledQuery(const char* expression)
+        {
+                terms = 0;
+                termsnum = 0;
+                termstotal = 0;
+                buf = 0;
+                bufsize = 0;
+                if (expression)
+                        Compile(expression);
+        }
+
+        XMLCompiledQuery :: ~XMLCompiledQuery()
+        {
+                Clear();
+                if (buf)
+                        delete[] buf;
+        }
+
+        void XMLCompiledQuery::Clear()
+        {
+                for (unsigned int i = 0; i < termsnum; i++)
+                {
+                        if (terms[i].name)
+                                delete[] terms[i].name;
+                        if (terms[i].pattern)
+                                delete[] terms[i].pattern;
+                }
+                if (terms)
+                        delete[] terms;
+                terms = 0;
+                termsnum = 0;
+                termstotal = 0;
+        }
+
+        void XMLCompiledQuery::Compile(const char* expression2)
+        {
+                // Split the expression in the same way XMLQuery always did
+                Clear();
 
-                // r is the base section
-                // get all its elements
-                int C = r->GetAllChildrenNum(deep);
-                Z<XMLElement*> allelements(C + 10);
-                r->GetAllChildren(allelements, deep);
-                Z<int> positives(C + 10);
-                for (int i = 0; i < C; i++)
-                        positives[i] = 1;
+                Z<char> expression(strlen(expression2) + 1);
+                strcpy(expression, expression2);
 
                 char* a = expression.operator char *();
                 for (;; )
                 {
-                        // Parse the expression
-
                         // Get item 1
                         char* a1 = strchr(a, ' ');
                         if (!a1)
                                 break;
-                        Z<char> item1(300);
+                        char* item1 = a;
                         *a1 = 0;
-                        strcpy(item1, a);
-                        *a1 = ' ';
                         a = a1 + 1;
 
                         // Get comparator
                         a1 = strchr(a, ' ');
                         if (!a1)
                                 break;
-                        Z<char> comp(100);
+                        char* comp = a;
                         *a1 = 0;
-                        strcpy(comp, a);
-                        *a1 = ' ';
                         a = a1 + 1;
 
                         // Get item 2
@@ -5903,81 +6344,230 @@ TString XMLVariable :: GetValueString()
                         }
                         else
                                 a1 = strchr(a, ' ');
-                        Z<char> item2(300);
-                        if (a1)
-                                *a1 = 0;
-                        strcpy(item2, a);
+                        char* item2 = a;
                         if (a1)
                         {
-                                *a1 = ' ';
-                                a = a1 + 1;
+                                if (*a1)
+                                        a = a1 + 1;
+                                else
+                                        a = a1;
+                                *a1 = 0;
                         }
 
+                        AddTerm(item1, comp, item2);
 
-                        // Test this expression against all elements
-                        for (int y = 0; y < C; y++)
-                        {
-                                Z<char> ItemToMatch(1000);
+                        if (!a1)
+                                break;
+                }
+        }
 
-                                if (allelements[y] == 0)
-                                        continue;
+        void XMLCompiledQuery::AddTerm(const char* item1, const char* comp, const char* item2)
+        {
+                if (termsnum == termstotal)
+                {
+                        unsigned int nt = termstotal ? termstotal * 2 : 4;
+                        XMLQUERYTERM* n = new XMLQUERYTERM[nt];
+                        if (termsnum)
+                                memcpy(n, terms, termsnum * sizeof(XMLQUERYTERM));
+                        if (terms)
+                                delete[] terms;
+                        terms = n;
+                        termstotal = nt;
+                }
 
+                XMLQUERYTERM* t = &terms[termsnum++];
+                memset(t, 0, sizeof(XMLQUERYTERM));
 
-                                if (strcmp(item1, "?") == 0)
+                if (strcmp(item1, "?") == 0)
+                        t->item = XML_QUERY_NAME;
+                else
+                        if (strcmp(item1, "!") == 0)
+                                t->item = XML_QUERY_FULLNAME;
+                        else
+                                if (item1[0] == '~')
                                 {
-                                        allelements[y]->GetElementName(ItemToMatch, 0);
-                                        if (XML::TestMatch(ItemToMatch, comp, item2) == 0)
-                                                positives[y] = 0;
+                                        t->item = XML_QUERY_CONTENT;
+                                        t->content = atoi(item1 + 1);
                                 }
                                 else
-                                        if (strcmp(item1, "!") == 0)
-                                        {
-                                                allelements[y]->GetElementFullName(ItemToMatch, 0);
-                                                if (XML::TestMatch(ItemToMatch, comp, item2) == 0)
-                                                        positives[y] = 0;
-                                        }
-                                        else
-                                                if (strncmp(item1, "~", 1) == 0)
-                                                {
-                                                        unsigned int iC = atoi(item1.operator char*() + 1);
-                                                        if (allelements[y]->GetContentsNum() > iC)
-                                                                allelements[y]->GetContents()[iC]->GetValue(ItemToMatch);
+                                {
+                                        t->item = XML_QUERY_VARIABLE;
+                                        t->name = new char[strlen(item1) + 1];
+                                        strcpy(t->name, item1);
+                                }
 
-                                                        if (XML::TestMatch(ItemToMatch, comp, item2) == 0)
-                                                                positives[y] = 0;
-                                                }
+                if (strcmp(comp, "==") == 0)
+                        t->comp = XML_QUERY_EQ;
+                else
+                        if (strcmp(comp, "!=") == 0)
+                                t->comp = XML_QUERY_NE;
+                        else
+                                if (strcmp(comp, ">=") == 0)
+                                        t->comp = XML_QUERY_GE;
+                                else
+                                        if (strcmp(comp, "<=") == 0)
+                                                t->comp = XML_QUERY_LE;
+                                        else
+                                                if (strcmp(comp, "<") == 0)
+                                                        t->comp = XML_QUERY_LT;
                                                 else
-                                                {
-                                                        int V = allelements[y]->FindVariable(item1);
-                                                        if (V == -1)
-                                                                strcpy(ItemToMatch, "");
+                                                        if (strcmp(comp, ">") == 0)
+                                                                t->comp = XML_QUERY_GT;
                                                         else
-                                                                allelements[y]->GetVariables()[V]->GetValue(ItemToMatch, 0);
-                                                        if (XML::TestMatch(ItemToMatch, comp, item2) == 0)
-                                                                positives[y] = 0;
-                                                }
-                        }
+                                                                t->comp = XML_QUERY_OTHER;
 
-                        // Testing finished.
-                        if (!a1)
+                if (item2[0] == '\"')
+                {
+                        size_t l = strlen(item2 + 1);
+                        t->pattern = new char[l + 1];
+                        strcpy(t->pattern, item2 + 1);
+                        if (l)
+                                t->pattern[l - 1] = 0;
+                        t->literal = (strchr(t->pattern, '*') == 0 && strchr(t->pattern, '?') == 0);
+                }
+                else
+                {
+                        t->numeric = !(atoi(item2) == 0 && item2[0] != '0');
+                        t->value = atoi(item2);
+                }
+        }
+
+        unsigned int XMLCompiledQuery::GetTermNum()
+        {
+                return termsnum;
+        }
+
+        char* XMLCompiledQuery::Space(size_t s)
+        {
+                if (s > bufsize)
+                {
+                        if (buf)
+                                delete[] buf;
+                        bufsize = s > 256 ? s : 256;
+                        buf = new char[bufsize];
+                }
+                buf[0] = 0;
+                return buf;
+        }
+
+        bool XMLCompiledQuery::TestTerm(XMLQUERYTERM* t, XMLElement* e)
+        {
+                // Same result as XML::TestMatch on the item XMLQuery would extract
+                char* v = 0;
+
+                if (t->pattern && t->comp != XML_QUERY_EQ && t->comp != XML_QUERY_NE)
+                        return true;
+
+                switch (t->item)
+                {
+                        case XML_QUERY_NAME:
+                                v = Space(e->GetElementName(0, 0) + 1);
+                                e->GetElementName(v, 0);
+                                break;
+
+                        case XML_QUERY_FULLNAME:
+                                v = Space(e->GetElementFullName(0, 0) + 1);
+                                e->GetElementFullName(v, 0);
+                                break;
+
+                        case XML_QUERY_CONTENT:
+                                if (e->GetContentsNum() > t->content)
+                                {
+                                        XMLContent* c = e->GetContents()[t->content];
+                                        v = Space(c->GetValue(0) + 1);
+                                        c->GetValue(v);
+                                }
+                                else
+                                        v = Space(1);
+                                break;
+
+                        default:
+                                {
+                                        int V = e->FindVariable(t->name);
+                                        if (V == -1)
+                                                v = Space(1);
+                                        else
+                                        {
+                                                XMLVariable* x = e->GetVariables()[V];
+                                                v = Space(x->GetValue(0, 0) + 1);
+                                                x->GetValue(v, 0);
+                                        }
+                                }
                                 break;
+                }
+
+                if (t->pattern)
+                {
+                        bool m;
+                        if (t->literal)
+                                m = (strcmpi(v, t->pattern) == 0);
+                        else
+                                m = XML::VMatching(v, t->pattern);
+                        return t->comp == XML_QUERY_EQ ? m : !m;
+                }
 
+                int i = atoi(v);
+                if (i == 0 && v[0] != '0')
+                        return false;
+                if (!t->numeric)
+                        return false;
 
+                switch (t->comp)
+                {
+                        case XML_QUERY_EQ:
+                                return i == t->value;
+                        case XML_QUERY_NE:
+                                return i != t->value;
+                        case XML_QUERY_GE:
+                                return i >= t->value;
+                        case XML_QUERY_LE:
+                                return i <= t->value;
+                        case XML_QUERY_LT:
+                                return i < t->value;
+                        case XML_QUERY_GT:
+                                return i > t->value;
+                        default:
+                                return true;
                 }
+        }
+
+        bool XMLCompiledQuery::Match(XMLElement* e)
+        {
+                for (unsigned int i = 0; i < termsnum; i++)
+                        if (!TestTerm(&terms[i], e))
+                                return false;
+                return true;
+        }
+
+        int XMLCompiledQuery::Walk(XMLElement* r, XMLElement** rv, unsigned int deep, int N)
+        {
+                // Children before their parent, in the order of GetAllChildren
+                XMLElement** ch = r->GetChildren();
+                unsigned int num = r->GetChildrenNum();
 
-                int N = 0;
-                for (int i = 0; i < C; i++)
+                for (unsigned int i = 0; i < num && deep != 0; i++)
                 {
-                        if (positives[i])
+                        XMLElement* e = ch[i];
+                        if (!e)
+                                continue;
+                        N = Walk(e, rv, deep == 0xFFFFFFFF ? deep : (deep - 1), N);
+                        if (Match(e))
                         {
                                 if (rv)
-                                        rv[N] = allelements[i];
+                                        rv[N] = e;
                                 N++;
                         }
                 }
                 return N;
         }
 
+        int XMLCompiledQuery::Execute(XMLElement* r, XMLElement** rv, unsigned int deep)
+        {
+                if (!r)
+                        return 0;
+                return Walk(r, rv, deep, 0);
+        }
+
 
 
         // Global functions
@@ -6866,243 +7456,1984 @@ TString XMLVariable :: GetValueString()
         }
 
 
-        size_t XMLGetString(const char* section, const char* Tattr, const char* defv, char*out, const size_t maxlen, const char* xml, XML* af)
-        {
-                size_t Z = 0;
-                if (!af)
-                {
-                        XML f(xml);
-                        Z = f.XMLGetValue((char*)section, (char*)Tattr, out, maxlen);
-                }
-                else
-                {
-                        Z = af->XMLGetValue((char*)section, (char*)Tattr, out, maxlen);
-                }
+        // Snapshot Functions
 
-                if (Z)
-                        return Z;
-                strcpy(out, defv);
-                return strlen(defv);
+        XMLSnapshotWriter::XMLSnapshotWriter()
+        {
+                d = 0;
+                ss = 0;
+                total = 0;
+                stab = 0;
+                ssize = 0;
+                scount = 0;
         }
 
-        int XMLSetString(const char* section, const char* Tattr, char*out, const char* xml, XML* af)
+        XMLSnapshotWriter :: ~XMLSnapshotWriter()
         {
-                if (!af)
-                {
-                        XML f(xml);
-                        f.XMLSetValue((char*)section, (char*)Tattr, out);
-                        f.Save();
-                }
-                else
-                {
-                        af->XMLSetValue((char*)section, (char*)Tattr, out);
-                }
-                return 1;
+                if (d)
+                        delete[] d;
+                d = 0;
+                if (stab)
+                        delete[] stab;
+                stab = 0;
         }
 
-
-        int XMLRenameElement(const char* section, const char* newname, const char* xml, XML* af)
+        char* XMLSnapshotWriter::Take(size_t s, unsigned int* o)
         {
-                bool C = false;
-                if (!af)
-                {
-                        C = true;
-                        af = new XML(xml);
-                }
-
-                XMLElement* r = af->GetRootElement();
-                XMLElement* e = r->GetElementInSection(section);
-                if (!e)
-                        return 0; // no items under this one
-
-                e->SetElementName(newname);
+                // Records are 4 byte aligned and zero filled
+                size_t as = (s + 3) & ~(size_t)3;
 
-                if (C)
+                if (ss + as > total)
                 {
-                        delete af;
-                        af = 0;
+                        size_t newtotal = total ? total * 2 : 0x10000;
+                        while (newtotal < ss + as)
+                                newtotal *= 2;
+
+                        char* newd = new char[newtotal];
+                        if (ss)
+                                memcpy(newd, d, ss);
+                        if (d)
+                                delete[] d;
+                        d = newd;
+                        total = newtotal;
                 }
-                return 1;
-        }
 
+                char* p = d + ss;
+                memset(p, 0, as);
+                *o = (unsigned int)ss;
+                ss += as;
+                return p;
+        }
 
-        unsigned int XMLGetUInt(const char* item, const char* attr, const unsigned int defv, const char* xml, XML* af)
+        unsigned int XMLSnapshotWriter::Add(const void* p, size_t s)
         {
-                Z<char> i(100);
-                Z<char> id(100);
-                sprintf(id, "%u", defv);
-                XMLGetString(item, attr, id, i, 100, xml, af);
-                unsigned int x = 0;
-                sscanf(i, "%u", &x);
-                return x;
+                unsigned int o;
+                char* t = Take(s, &o);
+
+                if (p)
+                        memcpy(t, p, s);
+                return o;
         }
 
-        int XMLGetInt(const char* item, const char* attr, const int defv, const char* xml, XML* af)
+        void XMLSnapshotWriter::Set(unsigned int o, const void* p, size_t s)
         {
-                Z<char> i(100);
-                Z<char> id(100);
-                sprintf(id, "%i", defv);
-                XMLGetString(item, attr, id, i, 100, xml, af);
-                return atoi(i);
+                memcpy(d + o, p, s);
         }
 
-
-        float XMLGetFloat(const char* item, const char* attr, const float defv, const char* xml, XML* af)
+        static unsigned int XMLSnapshotHash(const char* s, size_t n)
         {
-                Z<char> a1(30);
-                sprintf(a1, "%f", defv);
-
-                Z<char> a2(30);
-                XMLGetString(item, attr, a1, a2, 30, xml, af);
+                unsigned int h = 2166136261u;
 
-                return (float)atof(a2);
+                while (n--)
+                {
+                        h ^= (unsigned char)*s++;
+                        h *= 16777619u;
+                }
+                return h;
         }
 
-        size_t XMLGetBinaryData(const char* item, const char* attr, const char* defv, char*out, const size_t maxlen, const char* xml, XML* af)
+        void XMLSnapshotWriter::GrowStringTable()
         {
-                Z<char> bdata(maxlen * 5 + 5000);
-                size_t len = XMLGetString(item, attr, defv, bdata, maxlen * 5 + 5000, xml, af);
-                if (!len)
-                        return 0;
+                unsigned int newsize = ssize ? ssize * 2 : 1024;
+                unsigned int* newtab = new unsigned int[newsize];
+                unsigned int len;
+                unsigned int i;
+                unsigned int j;
 
-                for (unsigned int i = 0; i < (strlen(bdata) - 1); i++)
+                memset(newtab, 0, newsize * sizeof(unsigned int));
+
+                for (i = 0; i < ssize; i++)
                 {
-                        if (bdata[i] == '_' && bdata[i + 1] == '_')
+                        if (stab[i])
                         {
-                                bdata[i] = '\r';
-                                bdata[i + 1] = '\n';
+                                memcpy(&len, d + stab[i] - 4, 4);
+                                j = XMLSnapshotHash(d + stab[i], len) & (newsize - 1);
+                                while (newtab[j])
+                                        j = (j + 1) & (newsize - 1);
+                                newtab[j] = stab[i];
                         }
                 }
 
+                if (stab)
+                        delete[] stab;
+                stab = newtab;
+                ssize = newsize;
+        }
 
+        unsigned int XMLSnapshotWriter::AddString(const char* s)
+        {
+                if (!s)
+                        return 0;
+                return AddString(s, strlen(s));
+        }
 
-                Z<char> oout(maxlen * 5 + 5000);
-
-                char *oo;
-                MimeCoder<char*, char*>* e;
-                e = new Base64Decoder<char*, char*>;
-                oo = e->Filter(oout, bdata.operator char*(), bdata.operator char*() + len);
-                oo = e->Finish(oo);
-                *oo = 0;                  // Put a zero to the end
-                delete e;
+        unsigned int XMLSnapshotWriter::AddString(const char* s, size_t n)
+        {
+                // Equal strings are stored once. The offset is to the characters, after the length.
+                unsigned int len;
+                unsigned int o;
+                unsigned int i;
 
+                if (2 * (scount + 1) > ssize)
+                        GrowStringTable();
 
-                size_t S = oo - oout.operator char*();
-                if (S > maxlen)
-                {
-                        memcpy(out, oout, maxlen);
-                        return maxlen;
-                }
-                else
+                i = XMLSnapshotHash(s, n) & (ssize - 1);
+                while (stab[i])
                 {
-                        memcpy(out, oout, S);
-                        return S;
+                        memcpy(&len, d + stab[i] - 4, 4);
+                        if (len == n && memcmp(d + stab[i], s, n) == 0)
+                                return stab[i];
+                        i = (i + 1) & (ssize - 1);
                 }
+
+                len = (unsigned int)n;
+                char* t = Take(n + 5, &o);
+                memcpy(t, &len, 4);
+                if (n)
+                        memcpy(t + 4, s, n);
+
+                stab[i] = o + 4;
+                scount++;
+                return o + 4;
         }
 
-        int XMLSetUInt(const char* section, const char* attr, unsigned int v, const char* xml, XML* af)
+        BDC XMLSnapshotWriter::Finish()
         {
-                char a[20] = { 0 };
+                BDC b;
+
+                b.Resize(ss);
+                if (ss)
+                        memcpy(b.p(), d, ss);
+                return b;
+        }
+
+        XMLSnapshotElement::XMLSnapshotElement()
+        {
+                d = 0;
+                ss = 0;
+                o = 0;
+        }
+
+        XMLSnapshotElement::XMLSnapshotElement(const char* dd, size_t s, unsigned int oo)
+        {
+                d = dd;
+                ss = s;
+                o = oo;
+        }
+
+        const char* XMLSnapshotElement::String(const char* d, size_t ss, unsigned int o)
+        {
+                // Bounds checked string at o, 0 for none or an invalid offset
+                unsigned int len;
+
+                if (!d || o < sizeof(XMLSNAPSHOTHEADER) + 4 || (o & 3) || o >= ss)
+                        return 0;
+
+                memcpy(&len, d + o - 4, 4);
+                if (len >= ss - o || d[o + len] != 0)
+                        return 0;
+                return d + o;
+        }
+
+        const void* XMLSnapshotElement::Record(const char* d, size_t ss, unsigned int o, size_t s, unsigned int n)
+        {
+                // Bounds checked array of n records of size s at o
+                if (!d || o < sizeof(XMLSNAPSHOTHEADER) || (o & 3) || o > ss)
+                        return 0;
+                if (n > (ss - o) / s)
+                        return 0;
+                return d + o;
+        }
+
+        const XMLSNAPSHOTELEMENT* XMLSnapshotElement::Element() const
+        {
+                return (const XMLSNAPSHOTELEMENT*)Record(d, ss, o, sizeof(XMLSNAPSHOTELEMENT));
+        }
+
+        const XMLSNAPSHOTITEM* XMLSnapshotElement::Item(unsigned int n, unsigned int io, unsigned int i) const
+        {
+                if (i >= n)
+                        return 0;
+
+                // Item lists are written before the element record
+                const XMLSNAPSHOTITEM* it = (const XMLSNAPSHOTITEM*)Record(d, ss, io, sizeof(XMLSNAPSHOTITEM), n);
+                if (!it || io + n * sizeof(XMLSNAPSHOTITEM) > o)
+                        return 0;
+                return it + i;
+        }
+
+        bool XMLSnapshotElement::IsValid() const
+        {
+                return Element() != 0;
+        }
+
+        int XMLSnapshotElement::GetType() const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+
+                if (!e)
+                        return 0;
+                return e->type;
+        }
+
+        const char* XMLSnapshotElement::GetName() const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+
+                if (!e)
+                        return 0;
+                return String(d, ss, e->name);
+        }
+
+        size_t XMLSnapshotElement::GetElementName(char* x, int NoDecode) const
+        {
+                const char* n = GetName();
+
+                if (!n)
+                        n = "";
+
+                if (!x)
+                {
+                        if (NoDecode)
+                                return strlen(n);
+                        else
+                                return XML::XMLDecode(n, 0);
+                }
+
+                if (NoDecode)
+                        strcpy(x, n);
+                else
+                        XML::XMLDecode(n, x);
+                return strlen(x);
+        }
+
+        unsigned int XMLSnapshotElement::GetChildrenNum() const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+
+                if (!e || !e->childrennum)
+                        return 0;
+                if (!Record(d, ss, e->children, sizeof(unsigned int), e->childrennum))
+                        return 0;
+                if (e->children + e->childrennum * sizeof(unsigned int) > o)
+                        return 0;
+                return e->childrennum;
+        }
+
+        XMLSnapshotElement XMLSnapshotElement::GetChild(unsigned int i) const
+        {
+                if (i >= GetChildrenNum())
+                        return XMLSnapshotElement();
+
+                // Children are written before the list of them, and the list before the element,
+                // so a valid child is always at a lower offset. This keeps a damaged snapshot
+                // from looping.
+                unsigned int lo = Element()->children;
+                const unsigned int* co = (const unsigned int*)(d + lo);
+                if (co[i] + sizeof(XMLSNAPSHOTELEMENT) > lo)
+                        return XMLSnapshotElement();
+                return XMLSnapshotElement(d, ss, co[i]);
+        }
+
+        XMLSnapshotElement XMLSnapshotElement::GetElement(const char* n) const
+        {
+                unsigned int num = GetChildrenNum();
+                unsigned int i;
+
+                for (i = 0; i < num; i++)
+                {
+                        XMLSnapshotElement c = GetChild(i);
+                        const char* cn = c.GetName();
+                        if (cn && XMLSameName(n, cn))
+                                return c;
+                }
+                return XMLSnapshotElement();
+        }
+
+        XMLSnapshotElement XMLSnapshotElement::GetElementInSection(const char* section2) const
+        {
+                // Backslash separated path of element names, as XMLElement::GetElementInSection
+                XMLSnapshotElement r = *this;
+                if (strcmp(section2, "") == 0)
+                        return r;
+
+                Z<char> section(strlen(section2) + 1);
+                strcpy(section, section2);
+
+                char* a2 = section.operator char *();
+
+                for (;;)
+                {
+                        char* a1 = strchr(a2, '\\');
+                        if (a1)
+                                *a1 = 0;
+
+                        r = r.GetElement(a2);
+                        if (!r.IsValid() || !a1)
+                                break;
+
+                        a2 = a1 + 1;
+                }
+                return r;
+        }
+
+        unsigned int XMLSnapshotElement::GetVariableNum() const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+
+                if (!e || !e->variablesnum)
+                        return 0;
+                if (!Record(d, ss, e->variables, sizeof(XMLSNAPSHOTVARIABLE), e->variablesnum))
+                        return 0;
+                if (e->variables + e->variablesnum * sizeof(XMLSNAPSHOTVARIABLE) > o)
+                        return 0;
+                return e->variablesnum;
+        }
+
+        const char* XMLSnapshotElement::GetVariableName(unsigned int i) const
+        {
+                if (i >= GetVariableNum())
+                        return 0;
+
+                const XMLSNAPSHOTVARIABLE* v = (const XMLSNAPSHOTVARIABLE*)(d + Element()->variables);
+                return String(d, ss, v[i].n);
+        }
+
+        const char* XMLSnapshotElement::GetVariableValue(unsigned int i) const
+        {
+                if (i >= GetVariableNum())
+                        return 0;
+
+                const XMLSNAPSHOTVARIABLE* v = (const XMLSNAPSHOTVARIABLE*)(d + Element()->variables);
+                return String(d, ss, v[i].v);
+        }
+
+        const char* XMLSnapshotElement::FindVariable(const char* n) const
+        {
+                unsigned int num = GetVariableNum();
+                unsigned int i;
+
+                for (i = 0; i < num; i++)
+                {
+                        const char* vn = GetVariableName(i);
+                        if (vn && XMLSameName(n, vn))
+                        {
+                                const char* vv = GetVariableValue(i);
+                                return vv ? vv : "";
+                        }
+                }
+                return 0;
+        }
+
+        size_t XMLSnapshotElement::GetVariable(const char* n, char* x, int NoDecode) const
+        {
+                const char* vv = FindVariable(n);
+
+                if (!vv)
+                {
+                        if (x)
+                                *x = 0;
+                        return 0;
+                }
+
+                if (!x)
+                {
+                        if (NoDecode)
+                                return strlen(vv);
+                        else
+                                return XML::XMLDecode(vv, 0);
+                }
+
+                if (NoDecode)
+                        strcpy(x, vv);
+                else
+                        XML::XMLDecode(vv, x);
+                return strlen(x);
+        }
+
+        TString XMLSnapshotElement::GetVariableString(const char* x, const char* def) const
+        {
+                if (!FindVariable(x))
+                        return TString(def);
+
+                Z<char> str(GetVariable(x, 0) + 1);
+                GetVariable(x, str);
+                return TString(str.operator char *());
+        }
+
+        int XMLSnapshotElement::GetVariableInt(const char* x, int def) const
+        {
+                if (!FindVariable(x))
+                        return def;
+
+                Z<char> str(GetVariable(x, 0) + 1);
+                GetVariable(x, str);
+                return atoi(str);
+        }
+
+        unsigned int XMLSnapshotElement::GetContentsNum() const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+
+                if (!e || !Item(e->contentsnum, e->contents, 0))
+                        return 0;
+                return e->contentsnum;
+        }
+
+        const char* XMLSnapshotElement::GetContent(unsigned int i) const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+                const XMLSNAPSHOTITEM* it = e ? Item(e->contentsnum, e->contents, i) : 0;
+
+                if (!it)
+                        return 0;
+                return String(d, ss, it->t);
+        }
+
+        int XMLSnapshotElement::GetContentEP(unsigned int i) const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+                const XMLSNAPSHOTITEM* it = e ? Item(e->contentsnum, e->contents, i) : 0;
+
+                if (!it)
+                        return -1;
+                return it->ep;
+        }
+
+        bool XMLSnapshotElement::IsBinaryContent(unsigned int i) const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+                const XMLSNAPSHOTITEM* it = e ? Item(e->contentsnum, e->contents, i) : 0;
+
+                if (!it)
+                        return false;
+                return it->bin != 0;
+        }
+
+        size_t XMLSnapshotElement::GetContentSize(unsigned int i) const
+        {
+                unsigned int len;
+                const char* t = GetContent(i);
+
+                if (!t)
+                        return 0;
+                memcpy(&len, t - 4, 4);
+                return len;
+        }
+
+        TString XMLSnapshotElement::GetContentString(const char* def) const
+        {
+                const char* t = GetContent(0);
+
+                if (!t || IsBinaryContent(0))
+                        return TString(def);
+
+                Z<char> str(XML::XMLDecode(t, 0) + 1);
+                XML::XMLDecode(t, str);
+                return TString(str.operator char *());
+        }
+
+        unsigned int XMLSnapshotElement::GetCommentsNum() const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+
+                if (!e || !Item(e->commentsnum, e->comments, 0))
+                        return 0;
+                return e->commentsnum;
+        }
+
+        const char* XMLSnapshotElement::GetComment(unsigned int i) const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+                const XMLSNAPSHOTITEM* it = e ? Item(e->commentsnum, e->comments, i) : 0;
+
+                if (!it)
+                        return 0;
+                return String(d, ss, it->t);
+        }
+
+        int XMLSnapshotElement::GetCommentEP(unsigned int i) const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+                const XMLSNAPSHOTITEM* it = e ? Item(e->commentsnum, e->comments, i) : 0;
+
+                if (!it)
+                        return -1;
+                return it->ep;
+        }
+
+        unsigned int XMLSnapshotElement::GetCDatasNum() const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+
+                if (!e || !Item(e->cdatasnum, e->cdatas, 0))
+                        return 0;
+                return e->cdatasnum;
+        }
+
+        const char* XMLSnapshotElement::GetCData(unsigned int i) const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+                const XMLSNAPSHOTITEM* it = e ? Item(e->cdatasnum, e->cdatas, i) : 0;
+
+                if (!it)
+                        return 0;
+                return String(d, ss, it->t);
+        }
+
+        int XMLSnapshotElement::GetCDataEP(unsigned int i) const
+        {
+                const XMLSNAPSHOTELEMENT* e = Element();
+                const XMLSNAPSHOTITEM* it = e ? Item(e->cdatasnum, e->cdatas, i) : 0;
+
+                if (!it)
+                        return -1;
+                return it->ep;
+        }
+
+        XMLElement* XMLSnapshotElement::Materialize(XMLArena* arena) const
+        {
+                if (!IsValid())
+                        return 0;
+
+                XMLElement* x = new (arena) XMLElement(0, "", 1, false, arena);
+                x->ImportFromSnapshot(*this);
+                return x;
+        }
+
+        XMLSnapshot::XMLSnapshot()
+        {
+                map = 0;
+                d = 0;
+                ss = 0;
+                doc = 0;
+        }
+
+        XMLSnapshot::XMLSnapshot(const char* file)
+        {
+                map = 0;
+                d = 0;
+                ss = 0;
+                doc = 0;
+                Open(file);
+        }
+
+        XMLSnapshot::XMLSnapshot(const char* data, size_t size)
+        {
+                map = 0;
+                d = 0;
+                ss = 0;
+                doc = 0;
+                Attach(data, size);
+        }
+
+        XMLSnapshot :: ~XMLSnapshot()
+        {
+                Close();
+        }
+
+        bool XMLSnapshot::Open(const char* file)
+        {
+                Close();
+
+                map = new TMappedFile(file);
+                if (!map->IsOpen())
+                {
+                        Close();
+                        return false;
+                }
+
+                d = map->GetData();
+                ss = map->GetSize();
+
+                const XMLSNAPSHOTHEADER* h = Header();
+                if (!h)
+                {
+                        Close();
+                        return false;
+                }
+                ss = h->s;
+                return true;
+        }
+
+        bool XMLSnapshot::Attach(const char* data, size_t size)
+        {
+                Close();
+
+                d = data;
+                ss = size;
+
+                const XMLSNAPSHOTHEADER* h = Header();
+                if (!h)
+                {
+                        Close();
+                        return false;
+                }
+                ss = h->s;
+                return true;
+        }
+
+        void XMLSnapshot::Close()
+        {
+                if (doc)
+                        delete doc;
+                doc = 0;
+                if (map)
+                        delete map;
+                map = 0;
+                d = 0;
+                ss = 0;
+        }
+
+        const XMLSNAPSHOTHEADER* XMLSnapshot::Header() const
+        {
+                const XMLSNAPSHOTHEADER* h;
+
+                if (!d || ss < sizeof(XMLSNAPSHOTHEADER))
+                        return 0;
+
+                h = (const XMLSNAPSHOTHEADER*)d;
+                if (h->magic != XML_SNAPSHOT_MAGIC || h->v != XML_SNAPSHOT_VERSION)
+                        return 0;
+                if (h->s < sizeof(XMLSNAPSHOTHEADER) || h->s > ss)
+                        return 0;
+                return h;
+        }
+
+        bool XMLSnapshot::IsValid() const
+        {
+                return Header() != 0;
+        }
+
+        const char* XMLSnapshot::GetData() const
+        {
+                return d;
+        }
+
+        size_t XMLSnapshot::GetSize() const
+        {
+                return ss;
+        }
+
+        const char* XMLSnapshot::GetHeader() const
+        {
+                const XMLSNAPSHOTHEADER* h = Header();
+
+                if (!h)
+                        return 0;
+                return XMLSnapshotElement::String(d, ss, h->hdr);
+        }
+
+        unsigned int XMLSnapshot::GetHeaderCommentsNum() const
+        {
+                const XMLSNAPSHOTHEADER* h = Header();
+
+                if (!h || !h->hdrcommentsnum)
+                        return 0;
+                if (!XMLSnapshotElement::Record(d, ss, h->hdrcomments, sizeof(XMLSNAPSHOTITEM), h->hdrcommentsnum))
+                        return 0;
+                return h->hdrcommentsnum;
+        }
+
+        const char* XMLSnapshot::GetHeaderComment(unsigned int i) const
+        {
+                if (i >= GetHeaderCommentsNum())
+                        return 0;
+
+                const XMLSNAPSHOTITEM* it = (const XMLSNAPSHOTITEM*)(d + Header()->hdrcomments);
+                return XMLSnapshotElement::String(d, ss, it[i].t);
+        }
+
+        int XMLSnapshot::GetHeaderCommentEP(unsigned int i) const
+        {
+                if (i >= GetHeaderCommentsNum())
+                        return -1;
+
+                const XMLSNAPSHOTITEM* it = (const XMLSNAPSHOTITEM*)(d + Header()->hdrcomments);
+                return it[i].ep;
+        }
+
+        XMLSnapshotElement XMLSnapshot::GetRootElement() const
+        {
+                const XMLSNAPSHOTHEADER* h = Header();
+
+                if (!h)
+                        return XMLSnapshotElement();
+                return XMLSnapshotElement(d, ss, h->root);
+        }
+
+        XMLSnapshotElement XMLSnapshot::GetElementInSection(const char* section) const
+        {
+                return GetRootElement().GetElementInSection(section);
+        }
+
+        XML* XMLSnapshot::GetDocument()
+        {
+                // The document is built on the first call and kept until the snapshot is closed
+                if (doc || !IsValid())
+                        return doc;
+
+                doc = new XML();
+                if (!doc->ImportFromSnapshot(*this))
+                {
+                        delete doc;
+                        doc = 0;
+                }
+                return doc;
+        }
+
+        bool XMLSnapshot::IsMaterialized() const
+        {
+                return doc != 0;
+        }
+
+        unsigned int XMLElement::ExportToSnapshot(XMLSnapshotWriter& w)
+        {
+                XMLSNAPSHOTELEMENT x;
+                unsigned int i;
+
+                ReloadAllElements();
+                memset(&x, 0, sizeof(x));
+
+                x.name = w.AddString(el);
+                x.type = type;
+
+                // Children first, so that this record can refer to them
+                if (childrennum)
+                {
+                        Z<unsigned int> co(childrennum);
+                        for (i = 0; i < childrennum; i++)
+                                co[i] = children[i]->ExportToSnapshot(w);
+                        x.childrennum = childrennum;
+                        x.children = w.Add(co, childrennum * sizeof(unsigned int));
+                }
+
+                if (variablesnum)
+                {
+                        Z<XMLSNAPSHOTVARIABLE> vo(variablesnum);
+                        for (i = 0; i < variablesnum; i++)
+                        {
+                                vo[i].n = w.AddString(variables[i]->vn);
+                                vo[i].v = w.AddString(variables[i]->vv);
+                        }
+                        x.variablesnum = variablesnum;
+                        x.variables = w.Add(vo, variablesnum * sizeof(XMLSNAPSHOTVARIABLE));
+                }
+
+                if (contentsnum)
+                {
+                        Z<XMLSNAPSHOTITEM> it(contentsnum);
+                        for (i = 0; i < contentsnum; i++)
+                        {
+                                XMLContent* c = contents[i];
+                                it[i].ep = c->GetEP();
+                                if (c->BinaryMode)
+                                {
+                                        it[i].t = w.AddString(c->bdc.p(), (size_t)c->bdc.size());
+                                        it[i].bin = 1;
+                                }
+                                else
+                                        it[i].t = w.AddString(c->c);
+                        }
+                        x.contentsnum = contentsnum;
+                        x.contents = w.Add(it, contentsnum * sizeof(XMLSNAPSHOTITEM));
+                }
+
+                if (commentsnum)
+                {
+                        Z<XMLSNAPSHOTITEM> it(commentsnum);
+                        for (i = 0; i < commentsnum; i++)
+                        {
+                                it[i].ep = comments[i]->GetEP();
+                                it[i].t = w.AddString(comments[i]->operator const char*());
+                        }
+                        x.commentsnum = commentsnum;
+                        x.comments = w.Add(it, commentsnum * sizeof(XMLSNAPSHOTITEM));
+                }
+
+                if (cdatasnum)
+                {
+                        Z<XMLSNAPSHOTITEM> it(cdatasnum);
+                        for (i = 0; i < cdatasnum; i++)
+                        {
+                                it[i].ep = cdatas[i]->GetEP();
+                                it[i].t = w.AddString(cdatas[i]->operator const char*());
+                        }
+                        x.cdatasnum = cdatasnum;
+                        x.cdatas = w.Add(it, cdatasnum * sizeof(XMLSNAPSHOTITEM));
+                }
+
+                return w.Add(&x, sizeof(x));
+        }
+
+        bool XMLElement::ImportFromSnapshot(const XMLSnapshotElement& s)
+        {
+                if (!s.IsValid())
+                        return false;
+
+                // Remove all existing
+                Clear();
+
+                const char* n = s.GetName();
+                if (!n)
+                        n = "";
+                if (parent)
+                        parent->ResetIndex(false);
+                el = (char*)XMLArena::Alloc(arena, strlen(n) + 1);
+                strcpy(el, n);
+                if (arena)
+                        el = arena->Intern(el);
+                type = s.GetType();
+
+                ImportSnapshotItems(s);
+                return true;
+        }
+
+        void XMLElement::ImportSnapshotItems(const XMLSnapshotElement& s)
+        {
+                // Snapshot strings are already encoded, so they are copied as they are
+                unsigned int num;
+                unsigned int i;
+
+                num = s.GetVariableNum();
+                if (num)
+                        SpaceForVariable(num);
+                for (i = 0; i < num; i++)
+                {
+                        const char* vn = s.GetVariableName(i);
+                        const char* vv = s.GetVariableValue(i);
+                        XMLVariable* v = new (arena) XMLVariable(vn ? vn : "", vv ? vv : "", true, false, arena);
+                        AddVariable(v);
+                }
+
+                num = s.GetContentsNum();
+                if (num)
+                        SpaceForContent(num);
+                for (i = 0; i < num; i++)
+                {
+                        const char* t = s.GetContent(i);
+                        int ep = s.GetContentEP(i);
+                        XMLContent* c;
+
+                        if (s.IsBinaryContent(i))
+                        {
+                                c = new XMLContent(this, ep);
+                                c->SetBinaryMode(true);
+                                if (t)
+                                        c->SetValue(t, true, (int)s.GetContentSize(i));
+                        }
+                        else
+                                c = new XMLContent(this, ep, t ? t : "", true);
+                        AddContent(c, ep);
+                }
+
+                num = s.GetCommentsNum();
+                for (i = 0; i < num; i++)
+                {
+                        const char* t = s.GetComment(i);
+                        int ep = s.GetCommentEP(i);
+                        AddComment(new XMLComment(this, ep, t ? t : ""), ep);
+                }
+
+                num = s.GetCDatasNum();
+                for (i = 0; i < num; i++)
+                {
+                        const char* t = s.GetCData(i);
+                        int ep = s.GetCDataEP(i);
+                        AddCData(new XMLCData(this, ep, t ? t : ""), ep);
+                }
+
+                num = s.GetChildrenNum();
+                if (num)
+                        SpaceForElement(num);
+                for (i = 0; i < num; i++)
+                {
+                        XMLSnapshotElement cs = s.GetChild(i);
+                        if (!cs.IsValid())
+                                continue;
+
+                        const char* cn = cs.GetName();
+                        XMLElement* x = new (arena) XMLElement(this, cn ? cn : "", 1, false, arena);
+                        if (arena)
+                                x->el = arena->Intern(x->el);
+                        x->type = cs.GetType();
+                        x->ImportSnapshotItems(cs);
+                        AddElement(x);
+                }
+        }
+
+        BDC XML::ExportToSnapshot()
+        {
+                XMLSnapshotWriter w;
+                XMLSNAPSHOTHEADER h;
+                unsigned int i;
+
+                memset(&h, 0, sizeof(h));
+                w.Add(&h, sizeof(h));
+
+                h.magic = XML_SNAPSHOT_MAGIC;
+                h.v = XML_SNAPSHOT_VERSION;
+
+                if (hdr)
+                {
+                        h.hdr = w.AddString(hdr->operator const char*());
+
+                        unsigned int num = hdr->GetCommentsNum();
+                        if (num)
+                        {
+                                Z<XMLSNAPSHOTITEM> it(num);
+                                for (i = 0; i < num; i++)
+                                {
+                                        XMLComment* c = hdr->GetComments()[i];
+                                        it[i].ep = c->GetEP();
+                                        it[i].t = w.AddString(c->operator const char*());
+                                }
+                                h.hdrcommentsnum = num;
+                                h.hdrcomments = w.Add(it, num * sizeof(XMLSNAPSHOTITEM));
+                        }
+                }
+
+                if (root)
+                        h.root = root->ExportToSnapshot(w);
+
+                BDC b = w.Finish();
+                h.s = (unsigned int)b.size();
+                memcpy(b.p(), &h, sizeof(h));
+                return b;
+        }
+
+        int XML::SaveSnapshot(const char* file)
+        {
+                BDC b = ExportToSnapshot();
+
+                FILE* fp = fopen(file, "wb");
+                if (!fp)
+                        return 0;
+
+                size_t s = fwrite(b.p(), 1, (size_t)b.size(), fp);
+                fclose(fp);
+
+                if (s != b.size())
+                        return 0;
+                return 1;
+        }
+
+        bool XML::ImportFromSnapshot(const XMLSnapshot& s)
+        {
+                if (!s.IsValid())
+                        return false;
+
+                Clear();
+                iParseStatus = XML_PARSE_OK;
+                iParseStatusPos = 0;
+
+                hdr = new XMLHeader(s.GetHeader());
+                unsigned int num = s.GetHeaderCommentsNum();
+                for (unsigned int i = 0; i < num; i++)
+                {
+                        const char* t = s.GetHeaderComment(i);
+                        int ep = s.GetHeaderCommentEP(i);
+                        hdr->AddComment(new XMLComment(0, ep, t ? t : ""), ep);
+                }
+
+                XMLSnapshotElement r = s.GetRootElement();
+                if (!r.IsValid())
+                {
+                        root = new XMLElement(0, "<root>");
+                        return true;
+                }
+
+                if (ArenaMode)
+                        arena = new XMLArena;
+                root = new (arena) XMLElement(0, "", 1, false, arena);
+                root->ImportFromSnapshot(r);
+                return true;
+        }
+
+        int XML::LoadSnapshot(const char* file)
+        {
+                // The file is not kept as the document file, so Save() does not overwrite the snapshot
+                XMLSnapshot s;
+
+                if (!s.Open(file))
+                        return 0;
+                if (!ImportFromSnapshot(s))
+                        return 0;
+                return 1;
+        }
+
+
+        size_t XMLGetString(const char* section, const char* Tattr, const char* defv, char*out, const size_t maxlen, const char* xml, XML* af)
+        {
+                size_t Z = 0;
+                if (!af)
+                {
+                        XML f(xml);
+                        Z = f.XMLGetValue((char*)section, (char*)Tattr, out, maxlen);
+                }
+                else
+                {
+                        Z = af->XMLGetValue((char*)section, (char*)Tattr, out, maxlen);
+                }
+
+                if (Z)
+                        return Z;
+                strcpy(out, defv);
+                return strlen(defv);
+        }
+
+        int XMLSetString(const char* section, const char* Tattr, char*out, const char* xml, XML* af)
+        {
+                if (!af)
+                {
+                        XML f(xml);
+                        f.XMLSetValue((char*)section, (char*)Tattr, out);
+                        f.Save();
+                }
+                else
+                {
+                        af->XMLSetValue((char*)section, (char*)Tattr, out);
+                }
+                return 1;
+        }
+
+
+        int XMLRenameElement(const char* section, const char* newname, const char* xml, XML* af)
+        {
+                bool C = false;
+                if (!af)
+                {
+                        C = true;
+                        af = new XML(xml);
+                }
+
+                XMLElement* r = af->GetRootElement();
+                XMLElement* e = r->GetElementInSection(section);
+                if (!e)
+                        return 0; // no items under this one
+
+                e->SetElementName(newname);
+
+                if (C)
+                {
+                        delete af;
+                        af = 0;
+                }
+                return 1;
+        }
+
+
+        unsigned int XMLGetUInt(const char* item, const char* attr, const unsigned int defv, const char* xml, XML* af)
+        {
+                Z<char> i(100);
+                Z<char> id(100);
+                sprintf(id, "%u", defv);
+                XMLGetString(item, attr, id, i, 100, xml, af);
+                unsigned int x = 0;
+                sscanf(i, "%u", &x);
+                return x;
+        }
+
+        int XMLGetInt(const char* item, const char* attr, const int defv, const char* xml, XML* af)
+        {
+                Z<char> i(100);
+                Z<char> id(100);
+                sprintf(id, "%i", defv);
+                XMLGetString(item, attr, id, i, 100, xml, af);
+                return atoi(i);
+        }
+
+
+        float XMLGetFloat(const char* item, const char* attr, const float defv, const char* xml, XML* af)
+        {
+                Z<char> a1(30);
+                sprintf(a1, "%f", defv);
+
+                Z<char> a2(30);
+                XMLGetString(item, attr, a1, a2, 30, xml, af);
+
+                return (float)atof(a2);
+        }
+
+        size_t XMLGetBinaryData(const char* item, const char* attr, const char* defv, char*out, const size_t maxlen, const char* xml, XML* af)
+        {
+                Z<char> bdata(maxlen * 5 + 5000);
+                size_t len = XMLGetString(item, attr, defv, bdata, maxlen * 5 + 5000, xml, af);
+                if (!len)
+                        return 0;
+
+                for (unsigned int i = 0; i < (strlen(bdata) - 1); i++)
+                {
+                        if (bdata[i] == '_' && bdata[i + 1] == '_')
+                        {
+                                bdata[i] = '\r';
+                                bdata[i + 1] = '\n';
+                        }
+                }
+
+
+
+                Z<char> oout(maxlen * 5 + 5000);
+
+                char *oo;
+                MimeCoder<char*, char*>* e;
+                e = new Base64Decoder<char*, char*>;
+                oo = e->Filter(oout, bdata.operator char*(), bdata.operator char*() + len);
+                oo = e->Finish(oo);
+                *oo = 0;                  // Put a zero to the end
+                delete e;
+
+
+                size_t S = oo - oout.operator char*();
+                if (S > maxlen)
+                {
+                        memcpy(out, oout, maxlen);
+                        return maxlen;
+                }
+                else
+                {
+                        memcpy(out, oout, S);
+                        return S;
+                }
+        }
+
+        int XMLSetUInt(const char* section, const char* attr, unsigned int v, const char* xml, XML* af)
+        {
+                char a[20] = { 0 };
                 sprintf(a, "%u", v);
                 return XMLSetString(section, attr, a, xml, af);
         }
-        int XMLSetInt(const char* section, const char* attr, int v, const char* xml, XML* af)
+        int XMLSetInt(const char* section, const char* attr, int v, const char* xml, XML* af)
+        {
+                char a[20] = { 0 };
+                sprintf(a, "%i", v);
+                return XMLSetString(section, attr, a, xml, af);
+        }
+
+
+        int    XMLSetFloat(const char* section, const char* attr, float v, const char* xml, XML* af)
+        {
+                char a[20] = { 0 };
+                sprintf(a, "%f", v);
+                return XMLSetString(section, attr, a, xml, af);
+        }
+
+        int    XMLSetBinaryData(const char* section, const char* attr, char* data, int len, const char* xml, XML* af)
+        {
+                char* a = new char[len * 5 + 1000];
+                memset(a, 0, len * 5 + 1000);
+
+                char *oo;
+                MimeCoder<char*, char*>* e;
+                e = new Base64Encoder<char*, char*>;
+                oo = e->Filter(a, data, data + len);
+                oo = e->Finish(oo);
+                *oo = 0;                  // Put a zero to the end
+                delete e;
+
+
+                for (unsigned int i = 0; i < strlen(a) - 1; i++)
+                {
+                        if (a[i] == '\r' && a[i + 1] == '\n')
+                        {
+                                a[i] = '_';
+                                a[i + 1] = '_';
+                        }
+                }
+
+                int I = XMLSetString(section, attr, a, xml, af);
+                delete[] a;
+                return I;
+        }
+
+        // vector based things
+#ifndef __SYMBIAN32__
+
+
+        int XMLGetAllVariables(const char* section, char** vnames, char** vvalues, const char*xml)
+        {
+                XML f(xml);
+
+                XMLElement* r = f.GetRootElement();
+                XMLElement* e = r->GetElementInSection(section);
+                if (!e)
+                        return 0; // no items under this one
+
+                int Y = e->GetVariableNum();
+                for (int i = 0; i < Y; i++)
+                {
+                        size_t yS = e->GetVariables()[i]->GetName(0);
+                        char* d = new char[yS + 10];
+                        memset(d, 0, yS + 10);
+                        e->GetVariables()[i]->GetName(d);
+                        vnames[i] = d;
+
+                        yS = e->GetVariables()[i]->GetValue(0);
+                        char* d2 = new char[yS + 10];
+                        memset(d2, 0, yS + 10);
+                        e->GetVariables()[i]->GetValue(d2);
+                        vvalues[i] = d2;
+                }
+                return Y;
+        }
+
+        int XMLGetAllItems(const char* section, char** vnames, const char*xml)
+        {
+                XML f(xml);
+
+                XMLElement* r = f.GetRootElement();
+                XMLElement* e = r->GetElementInSection(section);
+                if (!e)
+                        return 0; // no items under this one
+
+                int Y = e->GetChildrenNum();
+                for (int i = 0; i < Y; i++)
+                {
+                        size_t yS = e->GetChildren()[i]->GetElementName(0);
+                        char* d = new char[yS + 10];
+                        memset(d, 0, yS + 10);
+                        e->GetChildren()[i]->GetElementName(d);
+                        vnames[i] = d;
+                }
+                return Y;
+        }
+
+
+#endif
+
+
+
+        // XMLInput classes
+
+        XMLFileInput::XMLFileInput(const char* file)
+        {
+                fp = fopen(file, "rb");
+                own = true;
+        }
+
+        XMLFileInput::XMLFileInput(FILE* f)
+        {
+                fp = f;
+                own = false;
+        }
+
+        XMLFileInput :: ~XMLFileInput()
+        {
+                if (fp && own)
+                        fclose(fp);
+                fp = 0;
+        }
+
+        bool XMLFileInput::IsOpen()
+        {
+                return fp != 0;
+        }
+
+        int XMLFileInput::Read(char* buf, int size)
+        {
+                if (!fp)
+                        return 0;
+                return (int)fread(buf, 1, size, fp);
+        }
+
+        XMLMemoryInput::XMLMemoryInput(const char* data, size_t size)
+        {
+                d = data;
+                s = size;
+                pos = 0;
+        }
+
+        int XMLMemoryInput::Read(char* buf, int size)
+        {
+                size_t n = s - pos;
+                if (n > (size_t)size)
+                        n = size;
+                memcpy(buf, d + pos, n);
+                pos += n;
+                return (int)n;
+        }
+
+        // XMLReader class
+
+        XMLReader::XMLReader(XMLInput* i, size_t ChunkSize)
+        {
+                in = i;
+                chunk = ChunkSize;
+                bufsize = 2 * chunk;
+                buf = new char[bufsize + 1];
+                buf[0] = 0;
+                len = 0;
+                pos = 0;
+                consumed = 0;
+                base = 0;
+                eof = false;
+                started = false;
+
+                event = XML_READER_NONE;
+                status = XML_PARSE_OK;
+                skipspace = true;
+                depth = 0;
+                level = 0;
+                empty = false;
+                pendingend = false;
+
+                name.p = text.p = raw.p = 0;
+                name.n = text.n = raw.n = 0;
+
+                attrparsed = false;
+                attr = 0;
+                attrnum = 0;
+                attrtotal = 0;
+
+                tmp = 0;
+                tmpsize = 0;
+        }
+
+        XMLReader :: ~XMLReader()
+        {
+                delete[] buf;
+                if (attr)
+                        delete[] attr;
+                if (tmp)
+                        delete[] tmp;
+        }
+
+        bool XMLReader::More()
+        {
+                // Drop the consumed part of the buffer and append the next chunk
+                if (eof)
+                        return false;
+
+                if (pos)
+                {
+                        memmove(buf, buf + pos, len - pos);
+                        len -= pos;
+                        base += pos;
+                        pos = 0;
+                }
+
+                if (len + chunk > bufsize)
+                {
+                        // A token larger than the buffer, grow it
+                        size_t ns = bufsize * 2;
+                        while (len + chunk > ns)
+                                ns *= 2;
+                        char* nb = new char[ns + 1];
+                        memcpy(nb, buf, len);
+                        delete[] buf;
+                        buf = nb;
+                        bufsize = ns;
+                }
+
+                int r = in->Read(buf + len, (int)chunk);
+                if (r <= 0)
+                {
+                        eof = true;
+                        buf[len] = 0;
+                        return false;
+                }
+                len += r;
+                buf[len] = 0;
+                return true;
+        }
+
+        bool XMLReader::Need(size_t n)
+        {
+                while (len - pos < n)
+                        if (!More())
+                                return false;
+                return true;
+        }
+
+        bool XMLReader::FindChar(size_t& off, char c)
+        {
+                // off is relative to pos, which stays valid when More() compacts the buffer
+                for (;;)
+                {
+                        char* p = (char*)memchr(buf + pos + off, c, len - pos - off);
+                        if (p)
+                        {
+                                off = p - (buf + pos);
+                                return true;
+                        }
+                        off = len - pos;
+                        if (!More())
+                                return false;
+                }
+        }
+
+        bool XMLReader::FindString(size_t& off, const char* str)
         {
-                char a[20] = { 0 };
-                sprintf(a, "%i", v);
-                return XMLSetString(section, attr, a, xml, af);
+                size_t n = strlen(str);
+
+                for (;;)
+                {
+                        if (!FindChar(off, str[0]))
+                                return false;
+                        if (!Need(off + n))
+                                return false;
+                        if (memcmp(buf + pos + off, str, n) == 0)
+                                return true;
+                        off++;
+                }
         }
 
+        bool XMLReader::FindTagEnd(size_t& off)
+        {
+                // Find the closing '>' of a tag, skipping quoted attribute values
+                char q = 0;
 
-        int    XMLSetFloat(const char* section, const char* attr, float v, const char* xml, XML* af)
+                for (;;)
+                {
+                        if (pos + off >= len && !More())
+                                return false;
+
+                        char c = buf[pos + off];
+                        if (q)
+                        {
+                                if (c == q)
+                                        q = 0;
+                        }
+                        else
+#ifdef ALLOW_SINGLE_QUOTE_VARIABLES
+                                if (c == '\"' || c == '\'')
+#else
+                                if (c == '\"')
+#endif
+                                        q = c;
+                                else
+                                        if (c == '>')
+                                                return true;
+                        off++;
+                }
+        }
+
+        XML_READER_EVENT XMLReader::Fail()
         {
-                char a[20] = { 0 };
-                sprintf(a, "%f", v);
-                return XMLSetString(section, attr, a, xml, af);
+                status = XML_PARSE_ERROR;
+                event = XML_READER_ERROR;
+                return event;
         }
 
-        int    XMLSetBinaryData(const char* section, const char* attr, char* data, int len, const char* xml, XML* af)
+        static bool XMLReaderIsSpace(char c)
         {
-                char* a = new char[len * 5 + 1000];
-                memset(a, 0, len * 5 + 1000);
+                return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
 
-                char *oo;
-                MimeCoder<char*, char*>* e;
-                e = new Base64Encoder<char*, char*>;
-                oo = e->Filter(a, data, data + len);
-                oo = e->Finish(oo);
-                *oo = 0;                  // Put a zero to the end
-                delete e;
+        XML_READER_EVENT XMLReader::Next()
+        {
+                if (event == XML_READER_EOF || event == XML_READER_ERROR)
+                        return event;
 
+                if (pendingend)
+                {
+                        // End of an empty element, name and raw still point to its start tag
+                        pendingend = false;
+                        depth--;
+                        level = depth;
+                        empty = false;
+                        attrparsed = false;
+                        attrnum = 0;
+                        event = XML_READER_END;
+                        return event;
+                }
 
-                for (unsigned int i = 0; i < strlen(a) - 1; i++)
+                pos += consumed;
+                consumed = 0;
+                empty = false;
+                attrparsed = false;
+                attrnum = 0;
+                text.p = 0;
+                text.n = 0;
+
+                if (!started)
                 {
-                        if (a[i] == '\r' && a[i + 1] == '\n')
+                        started = true;
+                        if (Need(3) && memcmp(buf + pos, "\xEF\xBB\xBF", 3) == 0)
+                                pos += 3;
+                }
+
+                for (;;)
+                {
+                        if (!Need(1))
                         {
-                                a[i] = '_';
-                                a[i + 1] = '_';
+                                if (depth)
+                                        return Fail();
+                                event = XML_READER_EOF;
+                                return event;
+                        }
+
+                        char* p = buf + pos;
+                        size_t off = 0;
+
+                        if (*p != '<')
+                        {
+                                if (!FindChar(off, '<'))
+                                        off = len - pos;
+                                p = buf + pos;
+
+                                if (skipspace)
+                                {
+                                        size_t i = 0;
+                                        while (i < off && XMLReaderIsSpace(p[i]))
+                                                i++;
+                                        if (i == off)
+                                        {
+                                                pos += off;
+                                                continue;
+                                        }
+                                }
+
+                                text.p = p;
+                                text.n = off;
+                                raw = text;
+                                consumed = off;
+                                level = depth;
+                                event = XML_READER_TEXT;
+                                return event;
+                        }
+
+                        if (!Need(2))
+                                return Fail();
+                        p = buf + pos;
+
+                        if (p[1] == '/')
+                        {
+                                off = 2;
+                                if (!FindChar(off, '>'))
+                                        return Fail();
+                                p = buf + pos;
+
+                                size_t i = 2;
+                                while (i < off && !XMLReaderIsSpace(p[i]))
+                                        i++;
+                                name.p = p + 2;
+                                name.n = i - 2;
+                                raw.p = p;
+                                raw.n = off + 1;
+                                consumed = off + 1;
+
+                                if (!depth)
+                                        return Fail();
+                                depth--;
+                                level = depth;
+                                event = XML_READER_END;
+                                return event;
+                        }
+
+                        if (p[1] == '?')
+                        {
+                                off = 2;
+                                if (!FindString(off, "?>"))
+                                        return Fail();
+                                p = buf + pos;
+
+                                size_t i = 2;
+                                while (i < off && !XMLReaderIsSpace(p[i]))
+                                        i++;
+                                name.p = p + 2;
+                                name.n = i - 2;
+                                text.p = p + 2;
+                                text.n = off - 2;
+                                raw.p = p;
+                                raw.n = off + 2;
+                                consumed = off + 2;
+                                level = depth;
+                                event = XML_READER_PI;
+                                return event;
+                        }
+
+                        if (p[1] == '!')
+                        {
+                                if (Need(4) && memcmp(buf + pos, "<!--", 4) == 0)
+                                {
+                                        off = 4;
+                                        if (!FindString(off, "-->"))
+                                                return Fail();
+                                        p = buf + pos;
+                                        text.p = p + 4;
+                                        text.n = off - 4;
+                                        raw.p = p;
+                                        raw.n = off + 3;
+                                        consumed = off + 3;
+                                        level = depth;
+                                        event = XML_READER_COMMENT;
+                                        return event;
+                                }
+
+                                if (Need(9) && memcmp(buf + pos, "<![CDATA[", 9) == 0)
+                                {
+                                        off = 9;
+                                        if (!FindString(off, "]]>"))
+                                                return Fail();
+                                        p = buf + pos;
+                                        text.p = p + 9;
+                                        text.n = off - 9;
+                                        raw.p = p;
+                                        raw.n = off + 3;
+                                        consumed = off + 3;
+                                        level = depth;
+                                        event = XML_READER_CDATA;
+                                        return event;
+                                }
+
+                                // <!DOCTYPE ...>, may hold an internal subset in []
+                                int br = 0;
+                                off = 2;
+                                for (;;)
+                                {
+                                        if (pos + off >= len && !More())
+                                                return Fail();
+                                        char c = buf[pos + off];
+                                        if (c == '[')
+                                                br++;
+                                        else
+                                                if (c == ']')
+                                                        br--;
+                                                else
+                                                        if (c == '>' && br <= 0)
+                                                                break;
+                                        off++;
+                                }
+                                p = buf + pos;
+                                text.p = p + 2;
+                                text.n = off - 2;
+                                raw.p = p;
+                                raw.n = off + 1;
+                                consumed = off + 1;
+                                level = depth;
+                                event = XML_READER_DECL;
+                                return event;
                         }
+
+                        // Start tag
+                        off = 1;
+                        if (!FindTagEnd(off))
+                                return Fail();
+                        p = buf + pos;
+
+                        size_t i = 1;
+                        while (i < off && !XMLReaderIsSpace(p[i]) && p[i] != '/')
+                                i++;
+                        name.p = p + 1;
+                        name.n = i - 1;
+                        raw.p = p;
+                        raw.n = off + 1;
+                        consumed = off + 1;
+
+                        empty = (p[off - 1] == '/');
+                        pendingend = empty;
+                        level = depth;
+                        depth++;
+                        event = XML_READER_START;
+                        return event;
                 }
+        }
 
-                int I = XMLSetString(section, attr, a, xml, af);
-                delete[] a;
-                return I;
+        XML_READER_EVENT XMLReader::GetEvent()
+        {
+                return event;
         }
 
-        // vector based things
-#ifndef __SYMBIAN32__
+        XML_PARSE_STATUS XMLReader::ParseStatus()
+        {
+                return status;
+        }
 
+        void XMLReader::SkipWhitespace(bool x)
+        {
+                skipspace = x;
+        }
 
-        int XMLGetAllVariables(const char* section, char** vnames, char** vvalues, const char*xml)
+        int XMLReader::GetDepth()
         {
-                XML f(xml);
+                return level;
+        }
 
-                XMLElement* r = f.GetRootElement();
-                XMLElement* e = r->GetElementInSection(section);
-                if (!e)
-                        return 0; // no items under this one
+        bool XMLReader::IsEmpty()
+        {
+                return event == XML_READER_START && empty;
+        }
 
-                int Y = e->GetVariableNum();
-                for (int i = 0; i < Y; i++)
+        unsigned long long XMLReader::GetPosition()
+        {
+                if (raw.p)
+                        return base + (raw.p - buf);
+                return base + pos;
+        }
+
+        XMLSLICE XMLReader::GetName()
+        {
+                return name;
+        }
+
+        XMLSLICE XMLReader::GetText()
+        {
+                return text;
+        }
+
+        XMLSLICE XMLReader::GetRaw()
+        {
+                return raw;
+        }
+
+        bool XMLReader::IsName(const char* n)
+        {
+                size_t l = strlen(n);
+                return l == name.n && memcmp(name.p, n, l) == 0;
+        }
+
+        void XMLReader::ParseAttributes()
+        {
+                // Split the start tag into name/value slices on first use
+                attrparsed = true;
+                attrnum = 0;
+                if (event != XML_READER_START)
+                        return;
+
+                const char* p = name.p + name.n;
+                const char* e = raw.p + raw.n - 1;
+                if (empty)
+                        e--;
+
+                for (;;)
                 {
-                        size_t yS = e->GetVariables()[i]->GetName(0);
-                        char* d = new char[yS + 10];
-                        memset(d, 0, yS + 10);
-                        e->GetVariables()[i]->GetName(d);
-                        vnames[i] = d;
+                        while (p < e && XMLReaderIsSpace(*p))
+                                p++;
+                        if (p >= e)
+                                break;
 
-                        yS = e->GetVariables()[i]->GetValue(0);
-                        char* d2 = new char[yS + 10];
-                        memset(d2, 0, yS + 10);
-                        e->GetVariables()[i]->GetValue(d2);
-                        vvalues[i] = d2;
+                        const char* n = p;
+                        while (p < e && *p != '=' && !XMLReaderIsSpace(*p))
+                                p++;
+                        size_t nl = p - n;
+                        while (p < e && XMLReaderIsSpace(*p))
+                                p++;
+
+                        const char* v = p;
+                        size_t vl = 0;
+                        if (p < e && *p == '=')
+                        {
+                                p++;
+                                while (p < e && XMLReaderIsSpace(*p))
+                                        p++;
+                                char q = *p;
+#ifdef ALLOW_SINGLE_QUOTE_VARIABLES
+                                if (p < e && (q == '\"' || q == '\''))
+#else
+                                if (p < e && q == '\"')
+#endif
+                                {
+                                        v = ++p;
+                                        while (p < e && *p != q)
+                                                p++;
+                                        vl = p - v;
+                                        if (p < e)
+                                                p++;
+                                }
+                                else
+                                {
+                                        v = p;
+                                        while (p < e && !XMLReaderIsSpace(*p))
+                                                p++;
+                                        vl = p - v;
+                                }
+                        }
+
+                        if (nl == 0)
+                        {
+                                p++;
+                                continue;
+                        }
+
+                        if (2 * (attrnum + 1) > attrtotal)
+                        {
+                                unsigned int nt = attrtotal ? attrtotal * 2 : 16;
+                                XMLSLICE* na = new XMLSLICE[nt];
+                                if (attrnum)
+                                        memcpy(na, attr, 2 * attrnum * sizeof(XMLSLICE));
+                                if (attr)
+                                        delete[] attr;
+                                attr = na;
+                                attrtotal = nt;
+                        }
+
+                        attr[2 * attrnum].p = n;
+                        attr[2 * attrnum].n = nl;
+                        attr[2 * attrnum + 1].p = v;
+                        attr[2 * attrnum + 1].n = vl;
+                        attrnum++;
                 }
-                return Y;
         }
 
-        int XMLGetAllItems(const char* section, char** vnames, const char*xml)
+        unsigned int XMLReader::GetAttributeNum()
         {
-                XML f(xml);
+                if (!attrparsed)
+                        ParseAttributes();
+                return attrnum;
+        }
 
-                XMLElement* r = f.GetRootElement();
-                XMLElement* e = r->GetElementInSection(section);
-                if (!e)
-                        return 0; // no items under this one
+        XMLSLICE XMLReader::GetAttributeName(unsigned int i)
+        {
+                if (!attrparsed)
+                        ParseAttributes();
+                if (i >= attrnum)
+                {
+                        XMLSLICE s = { 0, 0 };
+                        return s;
+                }
+                return attr[2 * i];
+        }
 
-                int Y = e->GetChildrenNum();
-                for (int i = 0; i < Y; i++)
+        XMLSLICE XMLReader::GetAttributeValue(unsigned int i)
+        {
+                if (!attrparsed)
+                        ParseAttributes();
+                if (i >= attrnum)
                 {
-                        size_t yS = e->GetChildren()[i]->GetElementName(0);
-                        char* d = new char[yS + 10];
-                        memset(d, 0, yS + 10);
-                        e->GetChildren()[i]->GetElementName(d);
-                        vnames[i] = d;
+                        XMLSLICE s = { 0, 0 };
+                        return s;
                 }
-                return Y;
+                return attr[2 * i + 1];
         }
 
+        bool XMLReader::FindAttribute(const char* n, XMLSLICE* v)
+        {
+                size_t l = strlen(n);
 
-#endif
+                if (!attrparsed)
+                        ParseAttributes();
+                for (unsigned int i = 0; i < attrnum; i++)
+                {
+                        if (attr[2 * i].n == l && memcmp(attr[2 * i].p, n, l) == 0)
+                        {
+                                if (v)
+                                        *v = attr[2 * i + 1];
+                                return true;
+                        }
+                }
+                return false;
+        }
+
+        size_t XMLReader::GetString(XMLSLICE s, char* trg, bool Decode)
+        {
+                // Copy a slice as a C string, decoding entities. Decoded text is never longer,
+                // so with trg = 0 the returned size is enough for the buffer.
+                if (!trg)
+                        return s.n + 1;
+
+                memcpy(trg, s.p, s.n);
+                trg[s.n] = 0;
+                if (Decode && memchr(trg, '&', s.n))
+                {
+                        Z<char> t(s.n + 1);
+                        strcpy(t, trg);
+                        XML::XMLDecode(t, trg);
+                }
+                return strlen(trg);
+        }
+
+        char* XMLReader::Terminate(const char* p, size_t n)
+        {
+                if (n + 1 > tmpsize)
+                {
+                        if (tmp)
+                                delete[] tmp;
+                        tmpsize = n + 1 > 256 ? n + 1 : 256;
+                        tmp = new char[tmpsize];
+                }
+                memcpy(tmp, p, n);
+                tmp[n] = 0;
+                return tmp;
+        }
+
+        void XMLReader::Skip()
+        {
+                // Skip the rest of the element started by the current START event
+                if (event != XML_READER_START)
+                        return;
+
+                int d = level;
+                for (;;)
+                {
+                        XML_READER_EVENT e = Next();
+                        if (e == XML_READER_EOF || e == XML_READER_ERROR)
+                                return;
+                        if (e == XML_READER_END && level == d)
+                                return;
+                }
+        }
+
+        XMLElement* XMLReader::ReadElement(XMLArena* arena)
+        {
+                // Build the element of the current START event and everything inside it, the
+                // same way Load would. Leaves the reader at the matching END event.
+                if (event != XML_READER_START)
+                        return 0;
+
+                int d = level;
+                XMLElement* r;
+                XMLElement* cur;
+
+                if (empty)
+                        r = new (arena) XMLElement(0, Terminate(raw.p + 1, raw.n - 2), 0, false, arena);
+                else
+                        r = new (arena) XMLElement(0, Terminate(raw.p, raw.n), 0, false, arena);
+                cur = r;
+
+                for (;;)
+                {
+                        XML_READER_EVENT e = Next();
+                        int Pos = cur->GetChildrenNum();
+
+                        if (e == XML_READER_EOF || e == XML_READER_ERROR)
+                                break;
+
+                        if (e == XML_READER_END)
+                        {
+                                if (level == d)
+                                        break;
+                                cur = cur->GetParent();
+                                continue;
+                        }
+
+                        if (e == XML_READER_START)
+                        {
+                                XMLElement* c;
+                                if (empty)
+                                        c = new (arena) XMLElement(cur, Terminate(raw.p + 1, raw.n - 2), 0, false, arena);
+                                else
+                                        c = new (arena) XMLElement(cur, Terminate(raw.p, raw.n), 0, false, arena);
+                                cur->AddElement(c);
+                                cur = c;
+                                continue;
+                        }
+
+                        if (e == XML_READER_TEXT)
+                        {
+                                XMLHelper::AddBlankVariable(cur, Terminate(text.p, text.n), Pos);
+                                continue;
+                        }
+
+                        if (e == XML_READER_COMMENT)
+                        {
+                                XMLComment* c = new XMLComment(cur, Pos, Terminate(text.p, text.n));
+                                cur->AddComment(c, Pos);
+                                continue;
+                        }
+
+                        if (e == XML_READER_CDATA)
+                        {
+                                XMLCData* c = new XMLCData(cur, Pos, Terminate(text.p, text.n));
+                                cur->AddCData(c, Pos);
+                                continue;
+                        }
+
+                        // PI and declarations inside elements are not kept
+                }
+
+                return r;
+        }
 
 
 
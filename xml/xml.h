@@ -59,6 +59,8 @@
 #include "str.h"
 #include "datetime.h"
 
+class TMappedFile;
+
 
 // Z template class
 template <class T>class Z
@@ -181,12 +183,77 @@ struct XMLBINARYHEADER
         };
 #pragma pack(pop)
 
+/*
+        Snapshot Format
+
+        A snapshot is one position independent block that is navigated in place, so it can be
+        mapped from a file and used without building the DOM. Every reference is a 32 bit offset
+        from the start of the block, 0 meaning none, and every record is 4 byte aligned.
+        Strings are stored once, in the same (encoded) form as in the DOM, as a 4 byte length
+        followed by the characters and a terminating zero. The offset points to the characters.
+
+        XMLSNAPSHOTHEADER       : at offset 0
+        element records         : children are written before their parent, the root last
+        lists                   : child offsets, variables and content/comment/cdata items
+        strings
+*/
+
+#define XML_SNAPSHOT_MAGIC 0x504E5358 // "XSNP"
+#define XML_SNAPSHOT_VERSION 1
+
+#pragma pack(push,4)
+struct XMLSNAPSHOTHEADER
+        {
+        unsigned int magic;
+        unsigned int v;
+        unsigned int s;                 // total size of the snapshot
+        unsigned int hdr;               // <?xml ?> header string
+        unsigned int hdrcommentsnum;
+        unsigned int hdrcomments;       // XMLSNAPSHOTITEM list
+        unsigned int root;              // root XMLSNAPSHOTELEMENT
+        };
+
+struct XMLSNAPSHOTELEMENT
+        {
+        unsigned int name;
+        int type;
+        unsigned int childrennum;
+        unsigned int children;          // element offsets
+        unsigned int variablesnum;
+        unsigned int variables;         // XMLSNAPSHOTVARIABLE list
+        unsigned int contentsnum;
+        unsigned int contents;          // XMLSNAPSHOTITEM list
+        unsigned int commentsnum;
+        unsigned int comments;
+        unsigned int cdatasnum;
+        unsigned int cdatas;
+        };
+
+struct XMLSNAPSHOTVARIABLE
+        {
+        unsigned int n;
+        unsigned int v;
+        };
+
+struct XMLSNAPSHOTITEM
+        {
+        int ep;                         // element position
+        unsigned int t;                 // text
+        unsigned int bin;               // 1 for binary content, t is then the raw data
+        };
+#pragma pack(pop)
+
 #ifdef XML_USE_NAMESPACE
 namespace XMLPP
         {
 #endif
 
 
+class XMLArena;
+class XMLCompiledQuery;
+class XMLSnapshot;
+class XMLSnapshotElement;
+class XMLSnapshotWriter;
 class XMLHeader;
 class XMLElement;
 class XMLVariable;
@@ -249,6 +316,63 @@ enum XML_TARGET_MODE
         XML_TARGET_MODE_UTF16FILE = 3,
         };
 
+// Arena allocator
+// All DOM memory is allocated through Alloc/Free. A small header in front of each block
+// records the arena it came from, so the same Free works for heap and arena memory.
+// Free is a no-op for arena memory, which is released in one shot when the arena is deleted.
+
+struct XMLARENAHEADER
+        {
+        XMLArena* a;
+        size_t s;
+        };
+
+struct XMLARENABLOCK
+        {
+        XMLARENABLOCK* next;
+        size_t size;
+        size_t used;
+        };
+
+// Name index
+// Hash of child or variable positions by name, built on the first lookup in an element with
+// many children or variables. Appends update it, any other change drops it.
+
+struct XMLNAMEINDEX
+        {
+        unsigned int* slots; // position + 1, 0 if empty
+        unsigned int size;   // power of 2
+        unsigned int count;
+        };
+
+class XMLArena
+        {
+        public:
+
+                XMLArena(size_t BlockSize = 0x10000);
+                ~XMLArena();
+
+                static void* Alloc(XMLArena* a,size_t s);
+                static void Free(void* p);
+
+                void Release(void* p);
+                char* Intern(char* s);
+                size_t MemoryUsage();
+
+        private:
+
+                char* Take(size_t s);
+                void GrowInternTable();
+
+                XMLARENABLOCK* blocks;
+                size_t blocksize;
+                size_t total;
+
+                char** itab;
+                unsigned int isize;
+                unsigned int icount;
+        };
+
 // Global functions
 
 class XMLHeader
@@ -306,7 +430,12 @@ class XMLElement
         public:
 
                 // constructors/destructor
-                XMLElement(XMLElement* par = 0,const char* el = 0,int Type = 0,bool Temp = false);
+                XMLElement(XMLElement* par = 0,const char* el = 0,int Type = 0,bool Temp = false,XMLArena* Arena = 0);
+
+                static void* operator new(size_t s);
+                static void* operator new(size_t s,XMLArena* a);
+                static void operator delete(void* p);
+                static void operator delete(void* p,XMLArena* a);
 
                 //XMLElement& operator =(XMLElement&);
                 ~XMLElement();
@@ -467,6 +596,7 @@ class XMLElement
 
                 XMLElement* GetElementInSection(const char*);
                 int XMLQuery(const char* expression,XMLElement** rv,unsigned int deep = 0xFFFFFFFF);
+                int XMLQuery(XMLCompiledQuery& q,XMLElement** rv,unsigned int deep = 0xFFFFFFFF);
                 XMLElement* GetParent();
                 void Export(FILE* fp,int ShowAll,XML_SAVE_MODE SaveMode,XML_TARGET_MODE TargetMode = XML_TARGET_MODE_FILE,XMLHeader* hdr = 0,class XMLTransform* eclass = 0,class XMLTransformData* edata = 0);
                 void SetExportFormatting(XMLEXPORTFORMAT* xf);
@@ -481,6 +611,8 @@ class XMLElement
 
                 BDC ExportToBinary();
                 bool ImportFromBinary(const BDC&);
+                unsigned int ExportToSnapshot(XMLSnapshotWriter&);
+                bool ImportFromSnapshot(const XMLSnapshotElement&);
 
 
         private:
@@ -488,6 +620,7 @@ class XMLElement
                 unsigned long long param;
                 int type; // type, 0 element
                 XMLElement* parent; // one
+                XMLArena* arena; // arena for names, arrays and new children, 0 for heap
 
                 char* el; // element name
                 XMLElement** children; // many
@@ -505,6 +638,17 @@ class XMLElement
                 int SpaceForComment(unsigned int);
                 int SpaceForContent(unsigned int);
                 int SpaceForCData(unsigned int);
+
+                const char* IndexName(bool Variables,unsigned int i);
+                void IndexInsert(XMLNAMEINDEX* x,bool Variables,unsigned int i);
+                void IndexAppend(bool Variables);
+                int IndexFind(bool Variables,const char* n);
+                void ResetIndex(bool Variables);
+                void ImportSnapshotItems(const XMLSnapshotElement&);
+                friend class XMLVariable;
+
+                XMLNAMEINDEX* childindex;
+                XMLNAMEINDEX* varindex;
                 int TotalChildPointersAvailable;
                 int TotalVariablePointersAvailable;
                 int TotalCommentPointersAvailable;
@@ -528,8 +672,13 @@ class XMLVariable
         {
         public:
 
-                XMLVariable(const char* = 0,const char* = 0,int NoDecode = 0,bool Temp = false);
+                XMLVariable(const char* = 0,const char* = 0,int NoDecode = 0,bool Temp = false,XMLArena* Arena = 0);
                 ~XMLVariable();
+
+                static void* operator new(size_t s);
+                static void* operator new(size_t s,XMLArena* a);
+                static void operator delete(void* p);
+                static void operator delete(void* p,XMLArena* a);
                 XMLVariable(const XMLVariable&);
                 XMLVariable& operator =(const XMLVariable&);
 
@@ -587,9 +736,11 @@ class XMLVariable
         private:
 
                 void Clear();
+                friend class XMLElement;
                 char* vn;
                 char* vv;
                 XMLElement* owner;
+                XMLArena* arena;
                 bool Temporal;
 
 
@@ -659,6 +810,7 @@ class XMLContent
 
         private:
 
+                friend class XMLElement;
                 XMLElement* parent;
                 BDC bdc; // Binary Data Container
                 bool BinaryMode;
@@ -727,6 +879,7 @@ class XML
 
                 XML_PARSE_STATUS ParseStatus(int* = 0);
                 void SaveOnClose(bool);
+                void SetArenaMode(bool);
                 int Load(const char* data,XML_LOAD_MODE LoadMode = XML_LOAD_MODE_LOCAL_FILE,class XMLTransform* eclass = 0,class XMLTransformData* edata = 0);
                 size_t LoadText(const char*);
                 static int PartialLoad(const char* file,const char* map);
@@ -752,8 +905,15 @@ class XML
                 BDC ExportToBinary();
                 bool ImportFromBinary(const BDC&);
 
+                // Snapshot functions
+                BDC ExportToSnapshot();
+                int SaveSnapshot(const char* file);
+                bool ImportFromSnapshot(const XMLSnapshot&);
+                int LoadSnapshot(const char* file);
+
                 // Query functions
                 int XMLQuery(const char* rootsection,const char* expression,XMLElement** rv,unsigned int deep = 0xFFFFFFFF);
+                int XMLQuery(const char* rootsection,XMLCompiledQuery& q,XMLElement** rv,unsigned int deep = 0xFFFFFFFF);
 
         private:
 
@@ -766,8 +926,10 @@ class XML
                 char* f;          // filename
                 XMLHeader* hdr;   // header (one)
                 XMLElement* root; // root element (one)
+                XMLArena* arena;  // owns the DOM memory in arena mode
 
                 bool SOnClose;
+                bool ArenaMode;
 
 
         };
@@ -820,7 +982,7 @@ class XMLHelper
 
                 // static functions
                 static char* FindXMLClose(char* s);
-                static XMLElement* ParseElementTree(XMLHeader* hdr,XMLElement* parent,char* tree,char** EndValue,XML_PARSE_STATUS& iParseStatus);
+                static XMLElement* ParseElementTree(XMLHeader* hdr,XMLElement* parent,char* tree,char** EndValue,XML_PARSE_STATUS& iParseStatus,XMLArena* arena = 0);
                 static void AddBlankVariable(XMLElement* parent,char *a2,int Pos);
                 static int pow(int P,int z);
 
@@ -828,6 +990,359 @@ class XMLHelper
 
         };
 
+// Compiled query
+// XMLQuery expression parsed once, so it can be run many times without re-parsing it.
+// Matches the same elements as XMLElement::XMLQuery, see there for the syntax.
+
+enum XML_QUERY_ITEM
+        {
+        XML_QUERY_VARIABLE = 0,
+        XML_QUERY_NAME = 1,      // ?
+        XML_QUERY_FULLNAME = 2,  // !
+        XML_QUERY_CONTENT = 3,   // ~n
+        };
+
+enum XML_QUERY_COMP
+        {
+        XML_QUERY_OTHER = 0,
+        XML_QUERY_EQ = 1,
+        XML_QUERY_NE = 2,
+        XML_QUERY_GE = 3,
+        XML_QUERY_LE = 4,
+        XML_QUERY_LT = 5,
+        XML_QUERY_GT = 6,
+        };
+
+struct XMLQUERYTERM
+        {
+        XML_QUERY_ITEM item;
+        XML_QUERY_COMP comp;
+        char* name;             // variable name
+        unsigned int content;   // content index for ~n
+        char* pattern;          // quoted item2 without quotes, 0 for integers
+        bool literal;           // pattern without wildcards
+        bool numeric;           // integer item2 is valid
+        int value;
+        };
+
+class XMLCompiledQuery
+        {
+        public:
+
+                XMLCompiledQuery(const char* expression = 0);
+                ~XMLCompiledQuery();
+
+                void Compile(const char* expression);
+                unsigned int GetTermNum();
+                bool Match(XMLElement* e);
+                int Execute(XMLElement* r,XMLElement** rv,unsigned int deep = 0xFFFFFFFF);
+
+        private:
+
+                XMLCompiledQuery(const XMLCompiledQuery&);
+                XMLCompiledQuery& operator =(const XMLCompiledQuery&);
+
+                void Clear();
+                void AddTerm(const char* item1,const char* comp,const char* item2);
+                bool TestTerm(XMLQUERYTERM* t,XMLElement* e);
+                char* Space(size_t s);
+                int Walk(XMLElement* r,XMLElement** rv,unsigned int deep,int N);
+
+                XMLQUERYTERM* terms;
+                unsigned int termsnum;
+                unsigned int termstotal;
+                char* buf;
+                size_t bufsize;
+        };
+
+// Pull reader
+// XMLReader walks a document from an XMLInput in fixed size chunks and returns one event per
+// Next() call. Names, attributes and text are returned as XMLSLICE pointers into the reader
+// buffer, valid until the next call to Next(). Only the current token is kept in memory,
+// so documents of any size can be scanned. ReadElement materializes the current element
+// as an XMLElement tree, so only the parts of interest need to be built.
+
+class XMLInput
+        {
+        public:
+
+                virtual ~XMLInput() {}
+                virtual int Read(char* buf,int size) = 0; // bytes read, 0 or less at end
+        };
+
+class XMLFileInput : public XMLInput
+        {
+        public:
+
+                XMLFileInput(const char* file);
+                XMLFileInput(FILE* fp);
+                virtual ~XMLFileInput();
+
+                bool IsOpen();
+                virtual int Read(char* buf,int size);
+
+        private:
+
+                FILE* fp;
+                bool own;
+        };
+
+class XMLMemoryInput : public XMLInput
+        {
+        public:
+
+                XMLMemoryInput(const char* data,size_t size);
+
+                virtual int Read(char* buf,int size);
+
+        private:
+
+                const char* d;
+                size_t s;
+                size_t pos;
+        };
+
+// Any object with int Read(char*,int), like TFile or TSocket
+template <class T> class XMLObjectInput : public XMLInput
+        {
+        public:
+
+                XMLObjectInput(T* Obj) { obj = Obj; }
+                virtual int Read(char* buf,int size) { return obj->Read(buf,size); }
+
+        private:
+
+                T* obj;
+        };
+
+enum XML_READER_EVENT
+        {
+        XML_READER_NONE = 0,
+        XML_READER_START = 1,   // <name ...> or <name .../>
+        XML_READER_END = 2,     // </name>, also sent after an empty element
+        XML_READER_TEXT = 3,
+        XML_READER_COMMENT = 4,
+        XML_READER_CDATA = 5,
+        XML_READER_PI = 6,      // <?...?>
+        XML_READER_DECL = 7,    // <!DOCTYPE ...> and other <! markup
+        XML_READER_EOF = 8,
+        XML_READER_ERROR = 9,
+        };
+
+struct XMLSLICE
+        {
+        const char* p;
+        size_t n;
+        };
+
+class XMLReader
+        {
+        public:
+
+                XMLReader(XMLInput* in,size_t ChunkSize = 0x10000);
+                ~XMLReader();
+
+                XML_READER_EVENT Next();
+                XML_READER_EVENT GetEvent();
+                XML_PARSE_STATUS ParseStatus();
+                void SkipWhitespace(bool);
+
+                int GetDepth();         // open elements around the current event, 0 for the root element
+                bool IsEmpty();         // START of an element written as <name/>
+                unsigned long long GetPosition(); // input offset of the current event
+
+                XMLSLICE GetName();     // element name, or PI target
+                XMLSLICE GetText();     // raw text, comment, cdata, PI or declaration body
+                XMLSLICE GetRaw();      // the whole current token
+                bool IsName(const char* n);
+
+                unsigned int GetAttributeNum();
+                XMLSLICE GetAttributeName(unsigned int i);
+                XMLSLICE GetAttributeValue(unsigned int i); // raw, not decoded
+                bool FindAttribute(const char* n,XMLSLICE* v = 0);
+
+                static size_t GetString(XMLSLICE s,char* trg = 0,bool Decode = true);
+
+                void Skip();
+                XMLElement* ReadElement(XMLArena* arena = 0);
+
+        private:
+
+                bool More();
+                bool Need(size_t n);
+                bool FindChar(size_t& off,char c);
+                bool FindString(size_t& off,const char* str);
+                bool FindTagEnd(size_t& off);
+                void ParseAttributes();
+                XML_READER_EVENT Fail();
+                char* Terminate(const char* p,size_t n);
+
+                XMLInput* in;
+                char* buf;
+                size_t bufsize;
+                size_t chunk;
+                size_t len;
+                size_t pos;
+                size_t consumed;
+                unsigned long long base;
+                bool eof;
+                bool started;
+
+                XML_READER_EVENT event;
+                XML_PARSE_STATUS status;
+                bool skipspace;
+                int depth;
+                int level;
+                bool empty;
+                bool pendingend;
+
+                XMLSLICE name;
+                XMLSLICE text;
+                XMLSLICE raw;
+
+                bool attrparsed;
+                XMLSLICE* attr; // name, value pairs
+                unsigned int attrnum;
+                unsigned int attrtotal;
+
+                char* tmp;
+                size_t tmpsize;
+        };
+
+// Snapshots
+// XMLSnapshot maps a snapshot made by XML::ExportToSnapshot or XML::SaveSnapshot and
+// XMLSnapshotElement is a read-only view of one element in it. Views are small values that
+// point into the snapshot, so loading is only a mapping and a header check, and nothing is
+// allocated while navigating. Names, values and texts are returned in their stored (encoded)
+// form, the size_t getters decode like the XMLElement ones. When the document must be changed,
+// GetDocument builds an ordinary XML from the snapshot, once, and Materialize builds one
+// element subtree.
+
+class XMLSnapshotWriter
+        {
+        public:
+
+                XMLSnapshotWriter();
+                ~XMLSnapshotWriter();
+
+                unsigned int Add(const void* p,size_t s);
+                unsigned int AddString(const char* s);
+                unsigned int AddString(const char* s,size_t n);
+                void Set(unsigned int o,const void* p,size_t s);
+                BDC Finish();
+
+        private:
+
+                XMLSnapshotWriter(const XMLSnapshotWriter&);
+                XMLSnapshotWriter& operator =(const XMLSnapshotWriter&);
+
+                char* Take(size_t s,unsigned int* o);
+                void GrowStringTable();
+
+                char* d;
+                size_t ss;
+                size_t total;
+
+                unsigned int* stab;
+                unsigned int ssize;
+                unsigned int scount;
+        };
+
+class XMLSnapshotElement
+        {
+        public:
+
+                XMLSnapshotElement();
+                XMLSnapshotElement(const char* d,size_t ss,unsigned int o);
+
+                bool IsValid() const;
+                int GetType() const;
+                const char* GetName() const;
+                size_t GetElementName(char*,int NoDecode = 0) const;
+
+                unsigned int GetChildrenNum() const;
+                XMLSnapshotElement GetChild(unsigned int i) const;
+                XMLSnapshotElement GetElement(const char* n) const;
+                XMLSnapshotElement GetElementInSection(const char*) const;
+
+                unsigned int GetVariableNum() const;
+                const char* GetVariableName(unsigned int i) const;
+                const char* GetVariableValue(unsigned int i) const;
+                const char* FindVariable(const char* n) const;
+                size_t GetVariable(const char* n,char*,int NoDecode = 0) const;
+                TString GetVariableString(const char* x,const char* def) const;
+                int GetVariableInt(const char* x,int def) const;
+
+                unsigned int GetContentsNum() const;
+                const char* GetContent(unsigned int i) const;
+                int GetContentEP(unsigned int i) const;
+                bool IsBinaryContent(unsigned int i) const;
+                size_t GetContentSize(unsigned int i) const;
+                TString GetContentString(const char* def) const;
+
+                unsigned int GetCommentsNum() const;
+                const char* GetComment(unsigned int i) const;
+                int GetCommentEP(unsigned int i) const;
+
+                unsigned int GetCDatasNum() const;
+                const char* GetCData(unsigned int i) const;
+                int GetCDataEP(unsigned int i) const;
+
+                XMLElement* Materialize(XMLArena* arena = 0) const;
+
+                static const char* String(const char* d,size_t ss,unsigned int o);
+                static const void* Record(const char* d,size_t ss,unsigned int o,size_t s,unsigned int n = 1);
+
+        private:
+
+                const XMLSNAPSHOTELEMENT* Element() const;
+                const XMLSNAPSHOTITEM* Item(unsigned int n,unsigned int o,unsigned int i) const;
+
+                const char* d;
+                size_t ss;
+                unsigned int o;
+        };
+
+class XMLSnapshot
+        {
+        public:
+
+                XMLSnapshot();
+                XMLSnapshot(const char* file);
+                XMLSnapshot(const char* data,size_t size);
+                ~XMLSnapshot();
+
+                bool Open(const char* file);
+                bool Attach(const char* data,size_t size); // data must stay valid while attached
+                void Close();
+
+                bool IsValid() const;
+                const char* GetData() const;
+                size_t GetSize() const;
+
+                const char* GetHeader() const;
+                unsigned int GetHeaderCommentsNum() const;
+                const char* GetHeaderComment(unsigned int i) const;
+                int GetHeaderCommentEP(unsigned int i) const;
+                XMLSnapshotElement GetRootElement() const;
+                XMLSnapshotElement GetElementInSection(const char*) const;
+
+                XML* GetDocument();
+                bool IsMaterialized() const;
+
+        private:
+
+                XMLSnapshot(const XMLSnapshot&);
+                XMLSnapshot& operator =(const XMLSnapshot&);
+
+                const XMLSNAPSHOTHEADER* Header() const;
+
+                TMappedFile* map;
+                const char* d;
+                size_t ss;
+                XML* doc;
+        };
+
 #ifdef XML_USE_NAMESPACE
 };
 #endif
@@ -870,6 +870,118 @@ const char *TUnzipFile::GetFileName()
     return cfilname;
 }
 
+/*##########################################################################
+#
+#   Name       : TUnzipFile::GetMethod
+#
+#   Purpose....: Get compression method
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TUnzipFile::GetMethod()
+{
+    return compression_method;
+}
+
+/*##########################################################################
+#
+#   Name       : TUnzipFile::IsEncrypted
+#
+#   Purpose....: Check if file is encrypted
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TUnzipFile::IsEncrypted()
+{
+    return encrypted;
+}
+
+/*##########################################################################
+#
+#   Name       : TUnzipFile::GetCompressedSize
+#
+#   Purpose....: Get compressed size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+unsigned long TUnzipFile::GetCompressedSize()
+{
+    return compr_size;
+}
+
+/*##########################################################################
+#
+#   Name       : TUnzipFile::GetSize
+#
+#   Purpose....: Get uncompressed size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+unsigned long TUnzipFile::GetSize()
+{
+    return uncompr_size;
+}
+
+/*##########################################################################
+#
+#   Name       : TUnzipFile::GetCrc
+#
+#   Purpose....: Get crc of uncompressed data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+unsigned long TUnzipFile::GetCrc()
+{
+    return crc;
+}
+
+/*##########################################################################
+#
+#   Name       : TUnzipFile::GetDataOffset
+#
+#   Purpose....: Get absolute offset of file data in zipfile
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+unsigned long TUnzipFile::GetDataOffset()
+{
+    return abs_data_offset;
+}
+
+/*##########################################################################
+#
+#   Name       : TUnzipFile::GetTime
+#
+#   Purpose....: Get modify time
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TDateTime TUnzipFile::GetTime()
+{
+    return TDateTime(rdos_msb_time, rdos_lsb_time);
+}
+
 /*##########################################################################
 #
 #   Name       : TUnzipFile::Skip
@@ -1718,6 +1830,8 @@ void TUnzip::Init()
     FFileSize = 0;
     FFileCount = 0;
 
+    FInputHandle = 0;
+
     FInBuf = new char[INBUFSIZ + 4];    /* 4 extra for hold[] (below) */
 }
 
@@ -1820,14 +1934,15 @@ void TUnzip::Close()
     }
 
     for (i = 0; i < FFileCount; i++)
-    {
         if (FFileArr[i])
-            delete FFileArr[0];
+            delete FFileArr[i];
 
+    if (FFileArr)
         delete FFileArr;
-        FFileCount = 0;
-        FFileSize = 0;
-    }
+
+    FFileArr = 0;
+    FFileCount = 0;
+    FFileSize = 0;
 }
     
 /*##########################################################################
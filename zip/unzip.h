@@ -39,6 +39,7 @@
 
 #include "str.h"
 #include "thread.h"
+#include "datetime.h"
 
 // these should be private!
 
@@ -96,6 +97,13 @@ public:
     void ShowCompact();
 
     const char *GetFileName();
+    int GetMethod();
+    int IsEncrypted();
+    unsigned long GetCompressedSize();
+    unsigned long GetSize();
+    unsigned long GetCrc();
+    unsigned long GetDataOffset();
+    TDateTime GetTime();
 
 protected:
     void CreateTimeStr(char *str);
@@ -0,0 +1,2218 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# zipwrite.cpp
+# Zip / gzip writer with parallel deflate
+#
+# Input is split into blocks that are deflated independently by a pool
+# of worker threads. Each block is primed with the last 32k of the
+# preceding block as dictionary and ends on a byte boundary (sync flush),
+# so the compressed blocks can be concatenated into a single deflate
+# stream in submission order. CRCs are computed per block and combined.
+#
+########################################################################*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rdos.h"
+#include "zipwrite.h"
+#include "zipextr.h"
+
+#define FALSE 0
+#define TRUE !FALSE
+
+#define PUT_BUF_SIZE    0x1000
+#define ZIP64_LIMIT     0xFFFFFFFFLL
+
+/*##########################################################################
+#
+#   Name       : ToDosTime
+#
+#   Purpose....: Convert to DOS date & time. Dates before 1980 use
+#                Jan 1, 1980.
+#
+#   In params..: time
+#   Out params.: DosTime
+#                DosDate
+#   Returns....: *
+#
+##########################################################################*/
+static void ToDosTime(const TDateTime &time, unsigned short *DosTime, unsigned short *DosDate)
+{
+    if (time.GetYear() < 1980)
+    {
+        *DosTime = 0;
+        *DosDate = (1 << 5) + 1;
+    }
+    else
+    {
+        *DosTime = (unsigned short)((time.GetHour() << 11) + (time.GetMin() << 5) + (time.GetSec() >> 1));
+        *DosDate = (unsigned short)(((time.GetYear() - 1980) << 9) + (time.GetMonth() << 5) + time.GetDay());
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipBlock::TZipBlock
+#
+#   Purpose....: Constructor for compression block
+#
+#   In params..: BlockSize      max input size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipBlock::TZipBlock(int BlockSize)
+{
+    FMaxOut = BlockSize + (BlockSize >> 3) + 64;
+
+    FInBuf = new char[BlockSize];
+    FDict = new char[ZIP_DICT_SIZE];
+    FOutBuf = new char[FMaxOut];
+
+    FInSize = 0;
+    FDictSize = 0;
+    FOutSize = 0;
+    FCrc = 0;
+    FFirst = FALSE;
+    FLast = FALSE;
+    FOk = FALSE;
+    FOwner = 0;
+    FDone = FALSE;
+    FNext = 0;
+    FJobNext = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipBlock::~TZipBlock
+#
+#   Purpose....: Destructor for compression block
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipBlock::~TZipBlock()
+{
+    delete[] FInBuf;
+    delete[] FDict;
+    delete[] FOutBuf;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflateWorker::TZipDeflateWorker
+#
+#   Purpose....: Constructor for deflate worker thread
+#
+#   In params..: Deflater
+#                Nr         worker number
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipDeflateWorker::TZipDeflateWorker(TZipDeflater *Deflater, int Nr)
+{
+    char name[40];
+
+    FDeflater = Deflater;
+    memset(&FStream, 0, sizeof(FStream));
+
+    sprintf(name, "Zip Deflate %d", Nr);
+    Start(name, 0x4000);
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflateWorker::~TZipDeflateWorker
+#
+#   Purpose....: Destructor for deflate worker thread
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipDeflateWorker::~TZipDeflateWorker()
+{
+    Stop();
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflateWorker::Execute
+#
+#   Purpose....: Compress blocks until deflater stops
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipDeflateWorker::Execute()
+{
+    TZipBlock *block;
+    int ok;
+
+    ok = FDeflater->InitStream(&FStream);
+
+    FDeflater->Started();
+
+    block = FDeflater->WaitJob(this);
+    while (block)
+    {
+        if (ok)
+            FDeflater->Compress(&FStream, block);
+        else
+            block->FOk = FALSE;
+
+        FDeflater->Done(block);
+        block = FDeflater->WaitJob(this);
+    }
+
+    if (ok)
+        deflateEnd(&FStream);
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::TZipDeflater
+#
+#   Purpose....: Constructor for parallel deflater
+#
+#   In params..: Level          zlib compression level
+#                ThreadCount    number of worker threads, 0 = compress inline
+#                BlockSize      input block size
+#                Store          copy input verbatim when level is 0
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipDeflater::TZipDeflater(int Level, int ThreadCount, int BlockSize, int Store)
+  : FSection("Zip.Deflate")
+{
+    int i;
+
+    if (BlockSize < ZIP_MIN_BLOCK_SIZE)
+        BlockSize = ZIP_MIN_BLOCK_SIZE;
+
+    if (ThreadCount < 0)
+        ThreadCount = 0;
+
+    FLevel = Level;
+    FStore = Store && Level == 0;
+    FBlockSize = BlockSize;
+    FThreadCount = ThreadCount;
+    FPending = 0;
+    FStarted = 0;
+    FStopping = FALSE;
+
+    FFreeList = 0;
+    FJobList = 0;
+    FJobLast = 0;
+    FOrderList = 0;
+    FOrderLast = 0;
+
+    memset(&FStream, 0, sizeof(FStream));
+
+    if (FThreadCount)
+    {
+        FStreamOk = FALSE;
+        FWorkerArr = new TZipDeflateWorker *[FThreadCount];
+
+        for (i = 0; i < FThreadCount; i++)
+            FWorkerArr[i] = new TZipDeflateWorker(this, i + 1);
+    }
+    else
+    {
+        FWorkerArr = 0;
+        FStreamOk = InitStream(&FStream);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::~TZipDeflater
+#
+#   Purpose....: Destructor for parallel deflater
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipDeflater::~TZipDeflater()
+{
+    TZipBlock *block;
+    int i;
+
+    if (FWorkerArr)
+    {
+        FSection.Enter();
+
+        while (FStarted < FThreadCount)
+        {
+            FSection.Leave();
+            FDoneSignal.WaitForever();
+            FSection.Enter();
+        }
+
+        FStopping = TRUE;
+        FSection.Leave();
+
+        for (i = 0; i < FThreadCount; i++)
+            FWorkerArr[i]->FSignal.Signal();
+
+        for (i = 0; i < FThreadCount; i++)
+            delete FWorkerArr[i];
+
+        delete[] FWorkerArr;
+    }
+
+    if (FStreamOk)
+        deflateEnd(&FStream);
+
+    while (FOrderList)
+    {
+        block = FOrderList;
+        FOrderList = block->FNext;
+        delete block;
+    }
+
+    while (FFreeList)
+    {
+        block = FFreeList;
+        FFreeList = block->FNext;
+        delete block;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::GetLevel
+#
+#   Purpose....: Get compression level
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TZipDeflater::GetLevel()
+{
+    return FLevel;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::GetBlockSize
+#
+#   Purpose....: Get input block size
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TZipDeflater::GetBlockSize()
+{
+    return FBlockSize;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::GetThreadCount
+#
+#   Purpose....: Get number of worker threads
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TZipDeflater::GetThreadCount()
+{
+    return FThreadCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::GetPending
+#
+#   Purpose....: Get number of submitted blocks not yet returned
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TZipDeflater::GetPending()
+{
+    return FPending;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::GetMaxPending
+#
+#   Purpose....: Get number of blocks to keep in flight. This bounds
+#                memory use to a few blocks per worker.
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TZipDeflater::GetMaxPending()
+{
+    if (FThreadCount)
+        return 2 * FThreadCount + 2;
+    else
+        return 1;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::Alloc
+#
+#   Purpose....: Allocate a block, reusing freed blocks
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: Block
+#
+##########################################################################*/
+TZipBlock *TZipDeflater::Alloc()
+{
+    TZipBlock *block;
+
+    FSection.Enter();
+
+    block = FFreeList;
+    if (block)
+        FFreeList = block->FNext;
+
+    FSection.Leave();
+
+    if (!block)
+        block = new TZipBlock(FBlockSize);
+
+    block->FInSize = 0;
+    block->FDictSize = 0;
+    block->FOutSize = 0;
+    block->FCrc = 0;
+    block->FFirst = FALSE;
+    block->FLast = FALSE;
+    block->FOk = FALSE;
+    block->FOwner = 0;
+    block->FDone = FALSE;
+    block->FNext = 0;
+    block->FJobNext = 0;
+
+    return block;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::Free
+#
+#   Purpose....: Return a block for reuse
+#
+#   In params..: block
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipDeflater::Free(TZipBlock *block)
+{
+    FSection.Enter();
+
+    block->FNext = FFreeList;
+    FFreeList = block;
+
+    FSection.Leave();
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::InitStream
+#
+#   Purpose....: Init raw deflate stream
+#
+#   In params..: strm
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TZipDeflater::InitStream(z_stream *strm)
+{
+    int level = FLevel;
+
+    memset(strm, 0, sizeof(z_stream));
+    strm->zalloc = (alloc_func)Z_NULL;
+    strm->zfree = (free_func)Z_NULL;
+
+    if (FStore)
+        return TRUE;
+
+    if (deflateInit2(strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::Compress
+#
+#   Purpose....: Compress a single block. Blocks that are not last end
+#                with a sync flush so output is byte aligned and can be
+#                appended to the output of the previous block.
+#
+#   In params..: strm       stream owned by calling thread
+#                block
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipDeflater::Compress(z_stream *strm, TZipBlock *block)
+{
+    int ret;
+
+    block->FCrc = crc32(0L, (const Bytef *)block->FInBuf, block->FInSize);
+
+    if (FStore)
+    {
+        memcpy(block->FOutBuf, block->FInBuf, block->FInSize);
+        block->FOutSize = block->FInSize;
+        block->FOk = TRUE;
+        return;
+    }
+
+    block->FOk = FALSE;
+    block->FOutSize = 0;
+
+    if (deflateReset(strm) != Z_OK)
+        return;
+
+    if (block->FDictSize)
+        if (deflateSetDictionary(strm, (const Bytef *)block->FDict, block->FDictSize) != Z_OK)
+            return;
+
+    strm->next_in = (Bytef *)block->FInBuf;
+    strm->avail_in = block->FInSize;
+    strm->next_out = (Bytef *)block->FOutBuf;
+    strm->avail_out = block->FMaxOut;
+
+    if (block->FLast)
+    {
+        ret = deflate(strm, Z_FINISH);
+        if (ret == Z_STREAM_END)
+            block->FOk = TRUE;
+    }
+    else
+    {
+        ret = deflate(strm, Z_SYNC_FLUSH);
+        if (ret == Z_OK && strm->avail_in == 0 && strm->avail_out)
+            block->FOk = TRUE;
+    }
+
+    block->FOutSize = block->FMaxOut - strm->avail_out;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::Submit
+#
+#   Purpose....: Queue a block for compression. Blocks are returned by
+#                GetCompleted in the order they were submitted.
+#
+#   In params..: block
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipDeflater::Submit(TZipBlock *block)
+{
+    int i;
+
+    block->FDone = FALSE;
+    block->FNext = 0;
+    block->FJobNext = 0;
+
+    if (!FWorkerArr)
+    {
+        if (FStreamOk)
+            Compress(&FStream, block);
+        else
+            block->FOk = FALSE;
+        block->FDone = TRUE;
+    }
+
+    FSection.Enter();
+
+    if (FOrderLast)
+        FOrderLast->FNext = block;
+    else
+        FOrderList = block;
+    FOrderLast = block;
+
+    if (FWorkerArr)
+    {
+        if (FJobLast)
+            FJobLast->FJobNext = block;
+        else
+            FJobList = block;
+        FJobLast = block;
+    }
+
+    FPending++;
+
+    FSection.Leave();
+
+    if (FWorkerArr)
+        for (i = 0; i < FThreadCount; i++)
+            FWorkerArr[i]->FSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::GetCompleted
+#
+#   Purpose....: Get oldest submitted block if it is compressed
+#
+#   In params..: wait       wait for oldest block to complete
+#   Out params.: *
+#   Returns....: Block or 0
+#
+##########################################################################*/
+TZipBlock *TZipDeflater::GetCompleted(int wait)
+{
+    TZipBlock *block;
+
+    for (;;)
+    {
+        FSection.Enter();
+
+        block = FOrderList;
+        if (block && block->FDone)
+        {
+            FOrderList = block->FNext;
+            if (!FOrderList)
+                FOrderLast = 0;
+            FPending--;
+            FSection.Leave();
+            return block;
+        }
+
+        FSection.Leave();
+
+        if (!block || !wait)
+            return 0;
+
+        FDoneSignal.WaitForever();
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::Started
+#
+#   Purpose....: Worker thread has started
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipDeflater::Started()
+{
+    FSection.Enter();
+    FStarted++;
+    FSection.Leave();
+
+    FDoneSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::WaitJob
+#
+#   Purpose....: Wait for next block to compress
+#
+#   In params..: worker
+#   Out params.: *
+#   Returns....: Block or 0 when stopping
+#
+##########################################################################*/
+TZipBlock *TZipDeflater::WaitJob(TZipDeflateWorker *worker)
+{
+    TZipBlock *block;
+
+    for (;;)
+    {
+        FSection.Enter();
+
+        if (FStopping)
+        {
+            FSection.Leave();
+            return 0;
+        }
+
+        block = FJobList;
+        if (block)
+        {
+            FJobList = block->FJobNext;
+            if (!FJobList)
+                FJobLast = 0;
+        }
+
+        FSection.Leave();
+
+        if (block)
+            return block;
+
+        worker->FSignal.WaitForever();
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipDeflater::Done
+#
+#   Purpose....: Block is compressed
+#
+#   In params..: block
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipDeflater::Done(TZipBlock *block)
+{
+    FSection.Enter();
+    block->FDone = TRUE;
+    FSection.Leave();
+
+    FDoneSignal.Signal();
+}
+
+/*##########################################################################
+#
+#   Name       : TZipEntry::TZipEntry
+#
+#   Purpose....: Constructor for zip entry
+#
+#   In params..: Name       name in archive
+#                Time       modification time
+#                Size       expected uncompressed size
+#                IsDir      entry is a directory
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipEntry::TZipEntry(const char *Name, const TDateTime &Time, long long Size, int IsDir)
+  : FName(Name)
+{
+    ToDosTime(Time, &FDosTime, &FDosDate);
+
+    FMethod = STORED;
+    FIsDir = IsDir;
+    FExpectSize = Size;
+    FOffset = 0;
+    FSize = 0;
+    FCompSize = 0;
+    FCrc = 0;
+    FNext = 0;
+
+    // compressed data may grow slightly beyond input size
+
+    if (Size + (Size >> 3) + 0x10000 >= ZIP64_LIMIT)
+        FZip64 = TRUE;
+    else
+        FZip64 = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipEntry::~TZipEntry
+#
+#   Purpose....: Destructor for zip entry
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipEntry::~TZipEntry()
+{
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::TZipWriter
+#
+#   Purpose....: Constructor for compressed writer
+#
+#   In params..: FileName       file to create
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipWriter::TZipWriter(const char *FileName)
+{
+    Init();
+
+    FFile = new TFile(FileName, 0);
+    FOwnFile = TRUE;
+
+    if (!FFile->IsOpen())
+        FOk = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::TZipWriter
+#
+#   Purpose....: Constructor for compressed writer
+#
+#   In params..: File       open output file
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipWriter::TZipWriter(TFile *File)
+{
+    Init();
+
+    FFile = File;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::TZipWriter
+#
+#   Purpose....: Constructor for compressed writer
+#
+#   In params..: Socket     connected socket
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipWriter::TZipWriter(TSocket *Socket)
+{
+    Init();
+
+    FSocket = Socket;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::~TZipWriter
+#
+#   Purpose....: Destructor for compressed writer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZipWriter::~TZipWriter()
+{
+    Flush();
+
+    if (FDeflater)
+        delete FDeflater;
+
+    if (FOwnFile)
+        delete FFile;
+
+    delete[] FWindow;
+    delete[] FPutBuf;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Init
+#
+#   Purpose....: Init writer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Init()
+{
+    FOk = TRUE;
+    FLevel = Z_DEFAULT_COMPRESSION;
+    FStore = TRUE;
+    FThreadCount = -1;
+    FBlockSize = ZIP_DEFAULT_BLOCK_SIZE;
+    FOffset = 0;
+    FInputSize = 0;
+
+    FDeflater = 0;
+    FWindow = new char[ZIP_DICT_SIZE];
+    FWindowSize = 0;
+
+    FPutBuf = new char[PUT_BUF_SIZE];
+    FPutCount = 0;
+
+    FFile = 0;
+    FSocket = 0;
+    FOwnFile = FALSE;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::IsOk
+#
+#   Purpose....: Check if all input was read and written
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TZipWriter::IsOk()
+{
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::SetLevel
+#
+#   Purpose....: Set compression level. Must be called before first entry.
+#
+#   In params..: Level      0 = store, 1..9, or Z_DEFAULT_COMPRESSION
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::SetLevel(int Level)
+{
+    if (!FDeflater)
+        FLevel = Level;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::SetThreadCount
+#
+#   Purpose....: Set number of deflate threads. Must be called before
+#                first entry.
+#
+#   In params..: Count      -1 = one per active core, 0 = single-threaded
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::SetThreadCount(int Count)
+{
+    if (!FDeflater)
+        FThreadCount = Count;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::SetBlockSize
+#
+#   Purpose....: Set input block size. Must be called before first entry.
+#
+#   In params..: Size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::SetBlockSize(int Size)
+{
+    if (!FDeflater)
+        FBlockSize = Size;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::GetInputSize
+#
+#   Purpose....: Get number of uncompressed bytes read
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TZipWriter::GetInputSize()
+{
+    return FInputSize;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::GetOutputSize
+#
+#   Purpose....: Get number of bytes written
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+long long TZipWriter::GetOutputSize()
+{
+    return FOffset;
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::StartDeflater
+#
+#   Purpose....: Create deflater on first use
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::StartDeflater()
+{
+    int count = FThreadCount;
+
+    if (!FDeflater)
+    {
+        if (count < 0)
+        {
+            count = RdosGetActiveCores();
+            if (count <= 1)
+                count = 0;
+        }
+
+        FDeflater = new TZipDeflater(FLevel, count, FBlockSize, FStore);
+        FBlockSize = FDeflater->GetBlockSize();
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Compress
+#
+#   Purpose....: Split file into blocks and queue them for compression.
+#                Completed blocks are written while reading continues.
+#
+#   In params..: File       input file
+#                Size       number of bytes to read
+#                Owner      owner of blocks (passed to WriteBlock)
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Compress(TFile &File, long long Size, void *Owner)
+{
+    TZipBlock *block;
+    long long left = Size;
+    int first = TRUE;
+    int last = FALSE;
+    int size;
+    int count;
+
+    StartDeflater();
+
+    FWindowSize = 0;
+
+    while (!last)
+    {
+        while (FDeflater->GetPending() >= FDeflater->GetMaxPending())
+            Drain(TRUE);
+
+        block = FDeflater->Alloc();
+
+        if (left > FBlockSize)
+            size = FBlockSize;
+        else
+            size = (int)left;
+
+        if (size)
+            count = File.Read(block->FInBuf, size);
+        else
+            count = 0;
+
+        if (count < size)
+        {
+            if (count < 0)
+                count = 0;
+            FOk = FALSE;
+            last = TRUE;
+        }
+
+        left -= count;
+        if (left <= 0)
+            last = TRUE;
+
+        block->FInSize = count;
+        block->FFirst = first;
+        block->FLast = last;
+        block->FOwner = Owner;
+
+        block->FDictSize = FWindowSize;
+        if (FWindowSize)
+            memcpy(block->FDict, FWindow, FWindowSize);
+
+        if (!last)
+        {
+            memcpy(FWindow, block->FInBuf + count - ZIP_DICT_SIZE, ZIP_DICT_SIZE);
+            FWindowSize = ZIP_DICT_SIZE;
+        }
+
+        FInputSize += count;
+        first = FALSE;
+
+        FDeflater->Submit(block);
+        Drain(FALSE);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Drain
+#
+#   Purpose....: Write blocks that are compressed, in order
+#
+#   In params..: wait       wait for at least one block
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Drain(int wait)
+{
+    TZipBlock *block;
+
+    if (!FDeflater)
+        return;
+
+    block = FDeflater->GetCompleted(wait);
+    while (block)
+    {
+        if (!block->FOk)
+            FOk = FALSE;
+
+        WriteBlock(block);
+        FDeflater->Free(block);
+        block = FDeflater->GetCompleted(FALSE);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::DrainAll
+#
+#   Purpose....: Write all pending blocks
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::DrainAll()
+{
+    if (FDeflater)
+        while (FDeflater->GetPending())
+            Drain(TRUE);
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Flush
+#
+#   Purpose....: Write buffered header data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Flush()
+{
+    if (FPutCount)
+    {
+        if (FFile)
+        {
+            if (FFile->Write(FPutBuf, FPutCount) != FPutCount)
+                FOk = FALSE;
+        }
+
+        if (FSocket)
+            FSocket->Write(FPutBuf, FPutCount);
+
+        FPutCount = 0;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Put
+#
+#   Purpose....: Write data. Small writes are buffered, large writes
+#                go directly to output.
+#
+#   In params..: buf
+#                size
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Put(const void *buf, int size)
+{
+    FOffset += size;
+
+    if (FPutCount + size <= PUT_BUF_SIZE)
+    {
+        memcpy(FPutBuf + FPutCount, buf, size);
+        FPutCount += size;
+    }
+    else
+    {
+        Flush();
+
+        if (size < PUT_BUF_SIZE)
+        {
+            memcpy(FPutBuf, buf, size);
+            FPutCount = size;
+        }
+        else
+        {
+            if (FFile)
+            {
+                if (FFile->Write(buf, size) != size)
+                    FOk = FALSE;
+            }
+
+            if (FSocket)
+                FSocket->Write((const char *)buf, size);
+        }
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Put2
+#
+#   Purpose....: Write 16-bit little-endian value
+#
+#   In params..: val
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Put2(unsigned int val)
+{
+    unsigned char buf[2];
+
+    buf[0] = (unsigned char)val;
+    buf[1] = (unsigned char)(val >> 8);
+    Put(buf, 2);
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Put4
+#
+#   Purpose....: Write 32-bit little-endian value
+#
+#   In params..: val
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Put4(unsigned long val)
+{
+    Put2((unsigned int)(val & 0xFFFF));
+    Put2((unsigned int)((val >> 16) & 0xFFFF));
+}
+
+/*##########################################################################
+#
+#   Name       : TZipWriter::Put8
+#
+#   Purpose....: Write 64-bit little-endian value
+#
+#   In params..: val
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZipWriter::Put8(long long val)
+{
+    Put4((unsigned long)(val & 0xFFFFFFFF));
+    Put4((unsigned long)((val >> 32) & 0xFFFFFFFF));
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::TZip
+#
+#   Purpose....: Constructor for zip writer
+#
+#   In params..: FileName       zip file to create
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZip::TZip(const char *FileName)
+  : TZipWriter(FileName)
+{
+    FClosed = FALSE;
+    FEntryCount = 0;
+    FEntryList = 0;
+    FEntryLast = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::TZip
+#
+#   Purpose....: Constructor for zip writer
+#
+#   In params..: File       open output file
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZip::TZip(TFile *File)
+  : TZipWriter(File)
+{
+    FClosed = FALSE;
+    FEntryCount = 0;
+    FEntryList = 0;
+    FEntryLast = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::TZip
+#
+#   Purpose....: Constructor for zip writer
+#
+#   In params..: Socket     connected socket, archive is streamed
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZip::TZip(TSocket *Socket)
+  : TZipWriter(Socket)
+{
+    FClosed = FALSE;
+    FEntryCount = 0;
+    FEntryList = 0;
+    FEntryLast = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::~TZip
+#
+#   Purpose....: Destructor for zip writer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TZip::~TZip()
+{
+    TZipEntry *entry;
+
+    Close();
+
+    while (FEntryList)
+    {
+        entry = FEntryList;
+        FEntryList = entry->FNext;
+        delete entry;
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::GetEntryCount
+#
+#   Purpose....: Get number of entries
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+int TZip::GetEntryCount()
+{
+    return FEntryCount;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::CreateEntry
+#
+#   Purpose....: Create and link new entry. Names use '/' as separator
+#                and have no leading separator.
+#
+#   In params..: EntryName
+#                Time
+#                Size
+#                IsDir
+#   Out params.: *
+#   Returns....: Entry
+#
+##########################################################################*/
+TZipEntry *TZip::CreateEntry(const char *EntryName, const TDateTime &Time, long long Size, int IsDir)
+{
+    TZipEntry *entry;
+    TString name;
+    const char *ptr = EntryName;
+
+    while (*ptr == '/' || *ptr == '\\')
+        ptr++;
+
+    while (*ptr)
+    {
+        if (*ptr == '\\')
+            name += '/';
+        else
+            name += *ptr;
+        ptr++;
+    }
+
+    if (IsDir)
+        if (name.GetSize() == 0 || name[name.GetSize() - 1] != '/')
+            name += '/';
+
+    entry = new TZipEntry(name.GetData(), Time, Size, IsDir);
+
+    if (FEntryLast)
+        FEntryLast->FNext = entry;
+    else
+        FEntryList = entry;
+    FEntryLast = entry;
+
+    FEntryCount++;
+
+    return entry;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::AddFile
+#
+#   Purpose....: Add file
+#
+#   In params..: FileName       file to add
+#                EntryName      name in archive, 0 = use FileName
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TZip::AddFile(const char *FileName, const char *EntryName)
+{
+    TFile File(FileName);
+
+    if (!File.IsOpen())
+        return FALSE;
+
+    if (EntryName)
+        return AddFile(File, EntryName);
+    else
+        return AddFile(File, FileName);
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::CalcCrc
+#
+#   Purpose....: Calculate CRC of file data and restore position. Stored
+#                entries put CRC in the local header, since some readers
+#                cannot handle a data descriptor after stored data.
+#
+#   In params..: File
+#                Size           number of bytes to check
+#   Out params.: *
+#   Returns....: CRC
+#
+##########################################################################*/
+unsigned long TZip::CalcCrc(TFile &File, long long Size)
+{
+    unsigned long crc = crc32(0L, Z_NULL, 0);
+    long long pos = File.GetPos();
+    long long left = Size;
+    char *buf = new char[FBlockSize];
+    int size;
+    int count;
+
+    while (left > 0)
+    {
+        if (left > FBlockSize)
+            size = FBlockSize;
+        else
+            size = (int)left;
+
+        count = File.Read(buf, size);
+        if (count <= 0)
+            break;
+
+        crc = crc32(crc, (const Bytef *)buf, count);
+        left -= count;
+    }
+
+    delete[] buf;
+
+    File.SetPos(pos);
+    return crc;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::AddFile
+#
+#   Purpose....: Add file from current position to end of file
+#
+#   In params..: File
+#                EntryName      name in archive
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TZip::AddFile(TFile &File, const char *EntryName)
+{
+    TZipEntry *entry;
+    long long size;
+
+    if (FClosed)
+        return FALSE;
+
+    size = File.GetSize() - File.GetPos();
+    if (size < 0)
+        size = 0;
+
+    entry = CreateEntry(EntryName, File.GetTime(), size, FALSE);
+
+    if (FLevel)
+        entry->FMethod = DEFLATED;
+    else
+    {
+        entry->FMethod = STORED;
+        entry->FCrc = CalcCrc(File, size);
+    }
+
+    Compress(File, size, entry);
+
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::AddDir
+#
+#   Purpose....: Add directory entry
+#
+#   In params..: EntryName      name in archive
+#                Time
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TZip::AddDir(const char *EntryName, const TDateTime &Time)
+{
+    TZipEntry *entry;
+
+    if (FClosed)
+        return FALSE;
+
+    entry = CreateEntry(EntryName, Time, 0, TRUE);
+
+    DrainAll();
+
+    entry->FOffset = FOffset;
+    WriteLocalHeader(entry);
+
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::Add
+#
+#   Purpose....: Add files & directories in list (not recursive)
+#
+#   In params..: List
+#                EntryPath      path in archive, or 0 for root
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TZip::Add(TDirList &List, const char *EntryPath)
+{
+    int ok;
+    TString name;
+
+    ok = List.GotoFirst();
+    while (ok)
+    {
+        const TDirEntryData &entry = List.Get().Get();
+
+        if (EntryPath && *EntryPath)
+        {
+            name = EntryPath;
+            name += "/";
+            name += entry.EntryName;
+        }
+        else
+            name = entry.EntryName;
+
+        if (entry.Attribute & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            if (strcmp(entry.EntryName.GetData(), ".") && strcmp(entry.EntryName.GetData(), ".."))
+                AddDir(name.GetData(), entry.ModifyTime);
+        }
+        else
+            AddFile(entry.PathName.Get().GetData(), name.GetData());
+
+        ok = List.GotoNext();
+    }
+
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::AddTree
+#
+#   Purpose....: Add directory tree recursively
+#
+#   In params..: Path           directory to add
+#                EntryPath      path in archive, or 0 for root
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TZip::AddTree(const TPathName &Path, const char *EntryPath)
+{
+    TDirList List(Path);
+    TString name;
+    int ok;
+
+    List.AddSortByName();
+    List.Sort();
+
+    ok = List.GotoFirst();
+    while (ok)
+    {
+        const TDirEntryData &entry = List.Get().Get();
+
+        if (EntryPath && *EntryPath)
+        {
+            name = EntryPath;
+            name += "/";
+            name += entry.EntryName;
+        }
+        else
+            name = entry.EntryName;
+
+        if (entry.Attribute & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            if (strcmp(entry.EntryName.GetData(), ".") && strcmp(entry.EntryName.GetData(), ".."))
+            {
+                AddDir(name.GetData(), entry.ModifyTime);
+                AddTree(entry.PathName, name.GetData());
+            }
+        }
+        else
+            AddFile(entry.PathName.Get().GetData(), name.GetData());
+
+        ok = List.GotoNext();
+    }
+
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::HasDescriptor
+#
+#   Purpose....: Check if entry is followed by a data descriptor
+#
+#   In params..: entry
+#   Out params.: *
+#   Returns....: TRUE if data descriptor is used
+#
+##########################################################################*/
+int TZip::HasDescriptor(TZipEntry *entry)
+{
+    if (entry->FIsDir || entry->FMethod == STORED)
+        return FALSE;
+    else
+        return TRUE;
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::WriteLocalHeader
+#
+#   Purpose....: Write local header. Deflated entries use a data
+#                descriptor since CRC and compressed size are not known
+#                in advance. Stored entries have both in the header.
+#
+#   In params..: entry
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZip::WriteLocalHeader(TZipEntry *entry)
+{
+    long long size = 0;
+
+    if (!HasDescriptor(entry))
+        size = entry->FExpectSize;
+
+    Put4(0x04034b50);
+
+    if (entry->FZip64)
+        Put2(45);
+    else
+        Put2(20);
+
+    if (HasDescriptor(entry))
+        Put2(0x0008);
+    else
+        Put2(0);
+
+    Put2(entry->FMethod);
+    Put2(entry->FDosTime);
+    Put2(entry->FDosDate);
+
+    if (HasDescriptor(entry))
+        Put4(0);
+    else
+        Put4(entry->FCrc);
+
+    if (entry->FZip64)
+    {
+        Put4(0xFFFFFFFF);
+        Put4(0xFFFFFFFF);
+    }
+    else
+    {
+        Put4((unsigned long)size);
+        Put4((unsigned long)size);
+    }
+
+    Put2(entry->FName.GetSize());
+
+    if (entry->FZip64)
+        Put2(20);
+    else
+        Put2(0);
+
+    Put(entry->FName.GetData(), entry->FName.GetSize());
+
+    if (entry->FZip64)
+    {
+        Put2(1);
+        Put2(16);
+        Put8(size);
+        Put8(size);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::WriteDescriptor
+#
+#   Purpose....: Write data descriptor after file data
+#
+#   In params..: entry
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZip::WriteDescriptor(TZipEntry *entry)
+{
+    Put4(0x08074b50);
+    Put4(entry->FCrc);
+
+    if (entry->FZip64)
+    {
+        Put8(entry->FCompSize);
+        Put8(entry->FSize);
+    }
+    else
+    {
+        Put4((unsigned long)entry->FCompSize);
+        Put4((unsigned long)entry->FSize);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::WriteCentralEntry
+#
+#   Purpose....: Write central directory entry
+#
+#   In params..: entry
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZip::WriteCentralEntry(TZipEntry *entry)
+{
+    int size64 = entry->FSize >= ZIP64_LIMIT;
+    int comp64 = entry->FCompSize >= ZIP64_LIMIT;
+    int offset64 = entry->FOffset >= ZIP64_LIMIT;
+    int extra = 0;
+    int version = 20;
+
+    if (size64)
+        extra += 8;
+
+    if (comp64)
+        extra += 8;
+
+    if (offset64)
+        extra += 8;
+
+    if (extra)
+        extra += 4;
+
+    if (extra || entry->FZip64)
+        version = 45;
+
+    Put4(0x02014b50);
+    Put2(version);
+    Put2(version);
+
+    if (HasDescriptor(entry))
+        Put2(0x0008);
+    else
+        Put2(0);
+
+    Put2(entry->FMethod);
+    Put2(entry->FDosTime);
+    Put2(entry->FDosDate);
+    Put4(entry->FCrc);
+
+    if (comp64)
+        Put4(0xFFFFFFFF);
+    else
+        Put4((unsigned long)entry->FCompSize);
+
+    if (size64)
+        Put4(0xFFFFFFFF);
+    else
+        Put4((unsigned long)entry->FSize);
+
+    Put2(entry->FName.GetSize());
+    Put2(extra);
+    Put2(0);
+    Put2(0);
+    Put2(0);
+
+    if (entry->FIsDir)
+        Put4(FILE_ATTRIBUTE_DIRECTORY);
+    else
+        Put4(FILE_ATTRIBUTE_ARCHIVE);
+
+    if (offset64)
+        Put4(0xFFFFFFFF);
+    else
+        Put4((unsigned long)entry->FOffset);
+
+    Put(entry->FName.GetData(), entry->FName.GetSize());
+
+    if (extra)
+    {
+        Put2(1);
+        Put2(extra - 4);
+
+        if (size64)
+            Put8(entry->FSize);
+
+        if (comp64)
+            Put8(entry->FCompSize);
+
+        if (offset64)
+            Put8(entry->FOffset);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::WriteCentralEnd
+#
+#   Purpose....: Write end of central directory, with zip64 records
+#                when counts or offsets overflow
+#
+#   In params..: CentralOffset
+#                CentralSize
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZip::WriteCentralEnd(long long CentralOffset, long long CentralSize)
+{
+    long long EndOffset;
+
+    if (FEntryCount >= 0xFFFF || CentralOffset >= ZIP64_LIMIT || CentralSize >= ZIP64_LIMIT)
+    {
+        EndOffset = FOffset;
+
+        Put4(0x06064b50);
+        Put8(44);
+        Put2(45);
+        Put2(45);
+        Put4(0);
+        Put4(0);
+        Put8(FEntryCount);
+        Put8(FEntryCount);
+        Put8(CentralSize);
+        Put8(CentralOffset);
+
+        Put4(0x07064b50);
+        Put4(0);
+        Put8(EndOffset);
+        Put4(1);
+    }
+
+    Put4(0x06054b50);
+    Put2(0);
+    Put2(0);
+
+    if (FEntryCount >= 0xFFFF)
+    {
+        Put2(0xFFFF);
+        Put2(0xFFFF);
+    }
+    else
+    {
+        Put2(FEntryCount);
+        Put2(FEntryCount);
+    }
+
+    if (CentralSize >= ZIP64_LIMIT)
+        Put4(0xFFFFFFFF);
+    else
+        Put4((unsigned long)CentralSize);
+
+    if (CentralOffset >= ZIP64_LIMIT)
+        Put4(0xFFFFFFFF);
+    else
+        Put4((unsigned long)CentralOffset);
+
+    Put2(0);
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::WriteBlock
+#
+#   Purpose....: Write compressed block of an entry
+#
+#   In params..: block
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TZip::WriteBlock(TZipBlock *block)
+{
+    TZipEntry *entry = (TZipEntry *)block->FOwner;
+
+    if (block->FFirst)
+    {
+        entry->FOffset = FOffset;
+        WriteLocalHeader(entry);
+    }
+
+    if (HasDescriptor(entry))
+    {
+        if (block->FFirst)
+            entry->FCrc = block->FCrc;
+        else
+            entry->FCrc = crc32_combine(entry->FCrc, block->FCrc, block->FInSize);
+    }
+
+    Put(block->FOutBuf, block->FOutSize);
+
+    entry->FSize += block->FInSize;
+    entry->FCompSize += block->FOutSize;
+
+    if (block->FLast && HasDescriptor(entry))
+        WriteDescriptor(entry);
+}
+
+/*##########################################################################
+#
+#   Name       : TZip::Close
+#
+#   Purpose....: Write remaining data and central directory
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TZip::Close()
+{
+    TZipEntry *entry;
+    long long CentralOffset;
+
+    if (!FClosed)
+    {
+        FClosed = TRUE;
+
+        DrainAll();
+
+        CentralOffset = FOffset;
+
+        entry = FEntryList;
+        while (entry)
+        {
+            WriteCentralEntry(entry);
+            entry = entry->FNext;
+        }
+
+        WriteCentralEnd(CentralOffset, FOffset - CentralOffset);
+        Flush();
+    }
+
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::TGzip
+#
+#   Purpose....: Constructor for gzip writer
+#
+#   In params..: FileName       gzip file to create
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TGzip::TGzip(const char *FileName)
+  : TZipWriter(FileName)
+{
+    FClosed = FALSE;
+    FStore = FALSE;
+    FCrc = 0;
+    FSize = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::TGzip
+#
+#   Purpose....: Constructor for gzip writer
+#
+#   In params..: File       open output file
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TGzip::TGzip(TFile *File)
+  : TZipWriter(File)
+{
+    FClosed = FALSE;
+    FStore = FALSE;
+    FCrc = 0;
+    FSize = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::TGzip
+#
+#   Purpose....: Constructor for gzip writer
+#
+#   In params..: Socket     connected socket
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TGzip::TGzip(TSocket *Socket)
+  : TZipWriter(Socket)
+{
+    FClosed = FALSE;
+    FStore = FALSE;
+    FCrc = 0;
+    FSize = 0;
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::~TGzip
+#
+#   Purpose....: Destructor for gzip writer
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+TGzip::~TGzip()
+{
+    Close();
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::Compress
+#
+#   Purpose....: Compress file as a gzip member
+#
+#   In params..: FileName
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TGzip::Compress(const char *FileName)
+{
+    TFile File(FileName);
+    TPathName Path(FileName);
+
+    if (!File.IsOpen())
+        return FALSE;
+
+    return Compress(File, Path.GetEntryName().GetData());
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::Compress
+#
+#   Purpose....: Compress from current position to end of file as a gzip
+#                member. Several members may be written to the same output.
+#
+#   In params..: File
+#                Name       original file name, or 0
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TGzip::Compress(TFile &File, const char *Name)
+{
+    unsigned char head[10];
+    long long size;
+    long long mtime;
+
+    if (FClosed)
+        return FALSE;
+
+    DrainAll();
+
+    size = File.GetSize() - File.GetPos();
+    if (size < 0)
+        size = 0;
+
+    mtime = File.GetTime().GetLinuxTimestamp();
+
+    head[0] = 0x1f;
+    head[1] = 0x8b;
+    head[2] = 8;
+
+    if (Name && *Name)
+        head[3] = 8;
+    else
+        head[3] = 0;
+
+    head[4] = (unsigned char)mtime;
+    head[5] = (unsigned char)(mtime >> 8);
+    head[6] = (unsigned char)(mtime >> 16);
+    head[7] = (unsigned char)(mtime >> 24);
+    head[8] = 0;
+    head[9] = 0xff;
+
+    Put(head, sizeof(head));
+
+    if (Name && *Name)
+        Put(Name, strlen(Name) + 1);
+
+    FCrc = 0;
+    FSize = 0;
+
+    TZipWriter::Compress(File, size, this);
+
+    return FOk;
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::WriteBlock
+#
+#   Purpose....: Write compressed block of current member
+#
+#   In params..: block
+#   Out params.: *
+#   Returns....: *
+#
+##########################################################################*/
+void TGzip::WriteBlock(TZipBlock *block)
+{
+    if (block->FFirst)
+        FCrc = block->FCrc;
+    else
+        FCrc = crc32_combine(FCrc, block->FCrc, block->FInSize);
+
+    Put(block->FOutBuf, block->FOutSize);
+
+    FSize += block->FInSize;
+
+    if (block->FLast)
+    {
+        Put4(FCrc);
+        Put4((unsigned long)FSize);
+    }
+}
+
+/*##########################################################################
+#
+#   Name       : TGzip::Close
+#
+#   Purpose....: Write remaining data
+#
+#   In params..: *
+#   Out params.: *
+#   Returns....: TRUE if ok
+#
+##########################################################################*/
+int TGzip::Close()
+{
+    if (!FClosed)
+    {
+        FClosed = TRUE;
+        DrainAll();
+        Flush();
+    }
+
+    return FOk;
+}
@@ -0,0 +1,274 @@
+/*#######################################################################
+# RDOS operating system
+# Copyright (C) 1988-2026, Leif Ekblad
+#
+# MIT License
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# The author of this program may be contacted at leif@rdos.net
+#
+# zipwrite.h
+# Zip / gzip writer with parallel deflate
+#
+########################################################################*/
+
+#ifndef _ZIPWRITE_H
+#define _ZIPWRITE_H
+
+#include "str.h"
+#include "file.h"
+#include "direntry.h"
+#include "thread.h"
+#include "section.h"
+#include "sigdev.h"
+#include "sockobj.h"
+#include "zlib.h"
+
+#define ZIP_DEFAULT_BLOCK_SIZE     0x20000
+#define ZIP_MIN_BLOCK_SIZE         0x10000
+#define ZIP_DICT_SIZE              0x8000
+
+class TZipDeflater;
+
+class TZipBlock
+{
+friend class TZipDeflater;
+public:
+    TZipBlock(int BlockSize);
+    ~TZipBlock();
+
+    char *FInBuf;
+    int FInSize;
+
+    char *FDict;
+    int FDictSize;
+
+    char *FOutBuf;
+    int FOutSize;
+
+    unsigned long FCrc;
+    int FFirst;
+    int FLast;
+    int FOk;
+    void *FOwner;
+
+protected:
+    int FDone;
+    int FMaxOut;
+    TZipBlock *FNext;
+    TZipBlock *FJobNext;
+};
+
+class TZipDeflateWorker : public TThread
+{
+public:
+    TZipDeflateWorker(TZipDeflater *Deflater, int Nr);
+    virtual ~TZipDeflateWorker();
+
+    TSignalDevice FSignal;
+
+protected:
+    virtual void Execute();
+
+    TZipDeflater *FDeflater;
+    z_stream FStream;
+};
+
+class TZipDeflater
+{
+friend class TZipDeflateWorker;
+public:
+    TZipDeflater(int Level, int ThreadCount, int BlockSize, int Store);
+    ~TZipDeflater();
+
+    int GetLevel();
+    int GetBlockSize();
+    int GetThreadCount();
+    int GetPending();
+    int GetMaxPending();
+
+    TZipBlock *Alloc();
+    void Free(TZipBlock *block);
+
+    void Submit(TZipBlock *block);
+    TZipBlock *GetCompleted(int wait);
+
+protected:
+    int InitStream(z_stream *strm);
+    void Compress(z_stream *strm, TZipBlock *block);
+    void Started();
+    TZipBlock *WaitJob(TZipDeflateWorker *worker);
+    void Done(TZipBlock *block);
+
+    int FLevel;
+    int FStore;
+    int FBlockSize;
+    int FThreadCount;
+    int FPending;
+    int FStarted;
+    int FStopping;
+
+    z_stream FStream;
+    int FStreamOk;
+
+    TZipDeflateWorker **FWorkerArr;
+
+    TZipBlock *FFreeList;
+    TZipBlock *FJobList;
+    TZipBlock *FJobLast;
+    TZipBlock *FOrderList;
+    TZipBlock *FOrderLast;
+
+    TSection FSection;
+    TSignalDevice FDoneSignal;
+};
+
+class TZipEntry
+{
+public:
+    TZipEntry(const char *Name, const TDateTime &Time, long long Size, int IsDir);
+    ~TZipEntry();
+
+    TString FName;
+    unsigned short FDosTime;
+    unsigned short FDosDate;
+    unsigned short FMethod;
+    int FIsDir;
+    int FZip64;
+    long long FExpectSize;
+    long long FOffset;
+    long long FSize;
+    long long FCompSize;
+    unsigned long FCrc;
+
+    TZipEntry *FNext;
+};
+
+class TZipWriter
+{
+public:
+    TZipWriter(const char *FileName);
+    TZipWriter(TFile *File);
+    TZipWriter(TSocket *Socket);
+    virtual ~TZipWriter();
+
+    int IsOk();
+
+    void SetLevel(int Level);
+    void SetThreadCount(int Count);
+    void SetBlockSize(int Size);
+
+    long long GetInputSize();
+    long long GetOutputSize();
+
+protected:
+    void StartDeflater();
+    void Compress(TFile &File, long long Size, void *Owner);
+    void Drain(int wait);
+    void DrainAll();
+
+    virtual void WriteBlock(TZipBlock *block) = 0;
+
+    void Flush();
+    void Put(const void *buf, int size);
+    void Put2(unsigned int val);
+    void Put4(unsigned long val);
+    void Put8(long long val);
+
+    int FOk;
+    int FLevel;
+    int FStore;
+    int FThreadCount;
+    int FBlockSize;
+    long long FOffset;
+    long long FInputSize;
+
+    TZipDeflater *FDeflater;
+    char *FWindow;
+    int FWindowSize;
+
+    char *FPutBuf;
+    int FPutCount;
+
+    TFile *FFile;
+    TSocket *FSocket;
+    int FOwnFile;
+
+private:
+    void Init();
+};
+
+class TZip : public TZipWriter
+{
+public:
+    TZip(const char *FileName);
+    TZip(TFile *File);
+    TZip(TSocket *Socket);
+    virtual ~TZip();
+
+    int AddFile(const char *FileName, const char *EntryName);
+    int AddFile(TFile &File, const char *EntryName);
+    int AddDir(const char *EntryName, const TDateTime &Time);
+    int Add(TDirList &List, const char *EntryPath);
+    int AddTree(const TPathName &Path, const char *EntryPath);
+
+    int GetEntryCount();
+    int Close();
+
+protected:
+    TZipEntry *CreateEntry(const char *EntryName, const TDateTime &Time, long long Size, int IsDir);
+
+    unsigned long CalcCrc(TFile &File, long long Size);
+    int HasDescriptor(TZipEntry *entry);
+
+    void WriteLocalHeader(TZipEntry *entry);
+    void WriteDescriptor(TZipEntry *entry);
+    void WriteCentralEntry(TZipEntry *entry);
+    void WriteCentralEnd(long long CentralOffset, long long CentralSize);
+
+    virtual void WriteBlock(TZipBlock *block);
+
+    int FClosed;
+    int FEntryCount;
+    TZipEntry *FEntryList;
+    TZipEntry *FEntryLast;
+};
+
+class TGzip : public TZipWriter
+{
+public:
+    TGzip(const char *FileName);
+    TGzip(TFile *File);
+    TGzip(TSocket *Socket);
+    virtual ~TGzip();
+
+    int Compress(const char *FileName);
+    int Compress(TFile &File, const char *Name);
+    int Close();
+
+protected:
+    virtual void WriteBlock(TZipBlock *block);
+
+    int FClosed;
+    unsigned long FCrc;
+    long long FSize;
+};
+
+#endif